@@ -20,9 +20,9 @@
 
 namespace Soro {
 
-AudioStreamer::AudioStreamer(GStreamerUtil::AudioProfile profile, quint16 bindPort, SocketAddress address, quint16 ipcPort, QObject *parent)
+AudioStreamer::AudioStreamer(GStreamerUtil::AudioProfile profile, quint16 bindPort, SocketAddress address, QString ipcAddress, QObject *parent)
         : MediaStreamer("AudioStreamer", parent) {
-    if (!connectToParent(ipcPort)) return;
+    if (!connectToParent(ipcAddress)) return;
 
     LOG_I(LOG_TAG, "Creating pipeline");
     _pipeline = createPipeline();
@@ -25,7 +25,7 @@ namespace Soro {
 class AudioStreamer : public MediaStreamer {
     Q_OBJECT
 public:
-    AudioStreamer(GStreamerUtil::AudioProfile profile, quint16 bindPort, SocketAddress address, quint16 ipcPort, QObject *parent = 0);
+    AudioStreamer(GStreamerUtil::AudioProfile profile, quint16 bindPort, SocketAddress address, QString ipcAddress, QObject *parent = 0);
 
 };
 
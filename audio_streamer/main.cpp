@@ -24,6 +24,7 @@
 #include "soro_core/gstreamerutil.h"
 #include "soro_core/constants.h"
 #include "soro_core/logger.h"
+#include "soro_core/channeltransport.h"
 
 #include "audiostreamer.h"
 
@@ -52,7 +53,7 @@ int main(int argc, char *argv[]) {
     QString device;
     SocketAddress address;
     quint16 bindPort;
-    quint16 ipcPort;
+    QString ipcAddress;
 
     /*
      * Parse audio profile
@@ -85,20 +86,20 @@ int main(int argc, char *argv[]) {
     LOG_I(LOG_TAG, "Bind port: " + QString::number(bindPort));
 
     /*
-     * Parse IPC port
+     * Parse IPC address
      */
-    ipcPort = QString(argv[5]).toInt(&ok);
-    if (!ok) {
-        // invalid IPC port
-        LOG_E(LOG_TAG, "Invalid IPC port '" + QString(argv[5]) + "'");
+    ipcAddress = QString(argv[5]);
+    if (!ChannelTransport::isLocalAddress(ipcAddress)) {
+        // invalid IPC address
+        LOG_E(LOG_TAG, "Invalid IPC address '" + ipcAddress + "'");
         return STREAMPROCESS_ERR_INVALID_ARGUMENT;
     }
-    LOG_I(LOG_TAG, "IPC Port: " + QString::number(ipcPort));
+    LOG_I(LOG_TAG, "IPC address: " + ipcAddress);
 
     a.setApplicationName("AudioStream for " + device + " to " + address.toString());
 
     LOG_I(LOG_TAG, "Creating stream object");
-    AudioStreamer stream(profile, bindPort, address, ipcPort, &a);
+    AudioStreamer stream(profile, bindPort, address, ipcAddress, &a);
     LOG_I(LOG_TAG, "Stream object created");
     return a.exec();
 }
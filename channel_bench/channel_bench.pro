@@ -0,0 +1,27 @@
+QT += core network
+
+CONFIG += c++11 no_keywords
+CONFIG += console
+CONFIG -= app_bundle
+TARGET = channel_bench
+TEMPLATE = app
+
+BUILD_DIR = ../build/channel_bench
+DESTDIR = ../bin
+OBJECTS_DIR = $$BUILD_DIR
+MOC_DIR = $$BUILD_DIR
+RCC_DIR = $$BUILD_DIR
+UI_DIR = $$BUILD_DIR
+PRECOMPILED_DIR = $$BUILD_DIR
+
+HEADERS += \
+    channelbenchmark.h
+
+SOURCES += \
+    main.cpp \
+    channelbenchmark.cpp
+
+# Include headers from other subprojects
+INCLUDEPATH += $$PWD/..
+
+LIBS += -L../lib -lsoro_core
@@ -0,0 +1,243 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "channelbenchmark.h"
+
+#include <algorithm>
+
+//time to wait for both ends to connect
+#define CONNECT_TIMEOUT 5000
+//time without a reply after which messages still in flight are counted as lost
+#define STALL_TIMEOUT 200
+//messages kept in flight during the throughput phase
+#define THROUGHPUT_WINDOW 64
+
+namespace Soro {
+
+ChannelBenchmark::ChannelBenchmark(QString backend, int messageSize, int count, quint16 port, QObject *parent) : QObject(parent)
+{
+    _backend = backend;
+    _messageSize = qBound((int)sizeof(quint32), messageSize, (int)Channel::MAX_MESSAGE_LENGTH);
+    _count = qMax(count, 1);
+    _port = port;
+    _message.fill('x', _messageSize);
+    // Latency and throughput messages get distinct sequence numbers, so a late echo can't be mistaken
+    _sendTimes.resize(_count * 2);
+    _result.backend = backend;
+
+    _stallTimer.setSingleShot(true);
+    _stallTimer.setInterval(STALL_TIMEOUT);
+    connect(&_stallTimer, &QTimer::timeout, this, &ChannelBenchmark::stalled);
+}
+
+QStringList ChannelBenchmark::backends()
+{
+    return QStringList() << "tcp" << "udp" << "unix" << "unixdgram" << "shm";
+}
+
+bool ChannelBenchmark::createChannels()
+{
+    QString name = "Soro_ChannelBenchmark";
+    if ((_backend == "tcp") || (_backend == "udp"))
+    {
+        Channel::Protocol protocol = _backend == "tcp" ? Channel::TcpProtocol : Channel::UdpProtocol;
+        _server = Channel::createServer(this, _port, name, protocol, QHostAddress::LocalHost);
+        _client = Channel::createClient(this, SocketAddress(QHostAddress::LocalHost, _port), name, protocol, QHostAddress::LocalHost);
+    }
+    else if (ChannelTransport::isLocalAddress(_backend + ":"))
+    {
+        QString address = _backend + ":" + (_backend == "shm" ? QString("soro_bench")
+                : QDir::tempPath() + "/soro_bench_" + QString::number(QCoreApplication::applicationPid()));
+        _server = Channel::createServer(this, address, name);
+        _client = Channel::createClient(this, address, name);
+    }
+    else
+    {
+        return false;
+    }
+    connect(_server, &Channel::stateChanged, this, &ChannelBenchmark::channelStateChanged);
+    connect(_client, &Channel::stateChanged, this, &ChannelBenchmark::channelStateChanged);
+    connect(_server, &Channel::messageReceived, this, &ChannelBenchmark::serverMessageReceived);
+    connect(_client, &Channel::messageReceived, this, &ChannelBenchmark::clientMessageReceived);
+    return true;
+}
+
+ChannelBenchmark::Result ChannelBenchmark::run()
+{
+    if (!createChannels())
+    {
+        _result.error = "Unknown backend";
+        return _result;
+    }
+    _server->open();
+    _client->open();
+    _elapsed.start();
+    _stallTimer.start(CONNECT_TIMEOUT);
+    _loop.exec();
+
+    _server->close();
+    _client->close();
+    return _result;
+}
+
+void ChannelBenchmark::channelStateChanged()
+{
+    if (_phase != ConnectingPhase) return;
+    if ((_server->getState() == Channel::ErrorState) || (_client->getState() == Channel::ErrorState))
+    {
+        finish("Channel error");
+        return;
+    }
+    if ((_server->getState() == Channel::ConnectedState) && (_client->getState() == Channel::ConnectedState))
+    {
+        _phase = LatencyPhase;
+        send();
+    }
+}
+
+void ChannelBenchmark::send()
+{
+    quint32 sequence = _sequenceBase + _sent++;
+    memcpy(_message.data(), &sequence, sizeof(sequence));
+    _sendTimes[sequence] = _elapsed.nsecsElapsed();
+    _client->sendMessage(_message);
+    _stallTimer.start(STALL_TIMEOUT);
+}
+
+void ChannelBenchmark::startThroughput()
+{
+    _phase = ThroughputPhase;
+    _sequenceBase = _count;
+    _sent = _received = 0;
+    _throughputStart = _elapsed.nsecsElapsed();
+    fillWindow();
+}
+
+void ChannelBenchmark::fillWindow()
+{
+    while ((_sent < _count) && (_sent - _received < THROUGHPUT_WINDOW))
+    {
+        send();
+    }
+}
+
+void ChannelBenchmark::serverMessageReceived(const char *message, Channel::MessageSize size)
+{
+    _server->sendMessage(message, size);
+}
+
+void ChannelBenchmark::clientMessageReceived(const char *message, Channel::MessageSize size)
+{
+    if (size < (int)sizeof(quint32)) return;
+    quint32 sequence;
+    memcpy(&sequence, message, sizeof(sequence));
+    // Anything not from the current phase, or already counted as lost, is ignored
+    if ((sequence < (quint32)_sequenceBase) || (sequence >= (quint32)(_sequenceBase + _sent))) return;
+    if (_sendTimes[sequence] < 0) return;
+    qint64 now = _elapsed.nsecsElapsed();
+    qint64 roundTrip = now - _sendTimes[sequence];
+    _sendTimes[sequence] = -1;
+
+    switch (_phase)
+    {
+    case LatencyPhase:
+        _roundTrips.append(roundTrip);
+        _received = _sent;
+        if (_sent < _count)
+        {
+            send();
+            return;
+        }
+        startThroughput();
+        break;
+    case ThroughputPhase:
+        _received++;
+        if (_received >= _count)
+        {
+            finish();
+            return;
+        }
+        fillWindow();
+        break;
+    default:
+        break;
+    }
+}
+
+void ChannelBenchmark::stalled()
+{
+    switch (_phase)
+    {
+    case ConnectingPhase:
+        finish("Did not connect within " + QString::number(CONNECT_TIMEOUT) + "ms");
+        break;
+    case LatencyPhase:
+        _result.lost++;
+        _sendTimes[_sequenceBase + _sent - 1] = -1;
+        _received = _sent;
+        if (_sent < _count)
+        {
+            send();
+        }
+        else
+        {
+            startThroughput();
+        }
+        break;
+    case ThroughputPhase:
+        for (int i = _sequenceBase; i < _sequenceBase + _sent; i++)
+        {
+            if (_sendTimes[i] >= 0)
+            {
+                _sendTimes[i] = -1;
+                _result.lost++;
+            }
+        }
+        _received = _sent;
+        if (_received >= _count)
+        {
+            finish();
+            return;
+        }
+        fillWindow();
+        break;
+    default:
+        break;
+    }
+}
+
+void ChannelBenchmark::finish(QString error)
+{
+    _phase = DonePhase;
+    _stallTimer.stop();
+    if (error.isEmpty() && !_roundTrips.isEmpty())
+    {
+        qint64 elapsed = _elapsed.nsecsElapsed() - _throughputStart;
+        std::sort(_roundTrips.begin(), _roundTrips.end());
+        _result.ok = true;
+        _result.latencyP50 = _roundTrips[_roundTrips.size() / 2] / 1000.0;
+        _result.latencyP99 = _roundTrips[qMin(_roundTrips.size() - 1, _roundTrips.size() * 99 / 100)] / 1000.0;
+        _result.latencyMax = _roundTrips.last() / 1000.0;
+        _result.messagesPerSecond = (_count - _result.lost) * 1e9 / qMax(elapsed, (qint64)1);
+    }
+    else
+    {
+        _result.error = error.isEmpty() ? "Every message was lost" : error;
+    }
+    _loop.quit();
+}
+
+} // namespace Soro
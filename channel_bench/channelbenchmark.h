@@ -0,0 +1,85 @@
+#ifndef SORO_CHANNELBENCHMARK_H
+#define SORO_CHANNELBENCHMARK_H
+
+#include <QtCore>
+
+#include "soro_core/channel.h"
+
+namespace Soro {
+
+/* Measures one Channel backend on this host, with a server and client in this process.
+ *
+ * The latency phase sends one message at a time and waits for the server to echo it back. The
+ * throughput phase keeps a window of messages in flight. Datagram backends can drop messages, a
+ * message that hasn't come back within a short time is counted as lost and the run moves on.
+ */
+class ChannelBenchmark : public QObject {
+    Q_OBJECT
+public:
+    struct Result
+    {
+        QString backend;
+        bool ok = false;
+        QString error;
+        /* Round trip times, in microseconds
+         */
+        double latencyP50 = 0;
+        double latencyP99 = 0;
+        double latencyMax = 0;
+        double messagesPerSecond = 0;
+        int lost = 0;
+    };
+
+    ChannelBenchmark(QString backend, int messageSize, int count, quint16 port, QObject *parent = nullptr);
+
+    /* Runs the benchmark and returns once it has finished
+     */
+    Result run();
+
+    /* Gets every backend that can be benchmarked
+     */
+    static QStringList backends();
+
+private Q_SLOTS:
+    void channelStateChanged();
+    void serverMessageReceived(const char *message, Channel::MessageSize size);
+    void clientMessageReceived(const char *message, Channel::MessageSize size);
+    void stalled();
+
+private:
+    enum Phase {
+        ConnectingPhase,
+        LatencyPhase,
+        ThroughputPhase,
+        DonePhase
+    };
+
+    QString _backend;
+    int _messageSize;
+    int _count;
+    quint16 _port;
+    Channel *_server = nullptr;
+    Channel *_client = nullptr;
+    Phase _phase = ConnectingPhase;
+    QEventLoop _loop;
+    QTimer _stallTimer;
+    QElapsedTimer _elapsed;
+    QByteArray _message;
+    QVector<qint64> _sendTimes;
+    QVector<qint64> _roundTrips;
+    int _sequenceBase = 0;
+    int _sent = 0;
+    int _received = 0;
+    qint64 _throughputStart = 0;
+    Result _result;
+
+    bool createChannels();
+    void send();
+    void startThroughput();
+    void fillWindow();
+    void finish(QString error = QString());
+};
+
+} // namespace Soro
+
+#endif // SORO_CHANNELBENCHMARK_H
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+
+#include "channelbenchmark.h"
+#include "soro_core/logger.h"
+
+using namespace Soro;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("channel_bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+            "Compares Channel backends on this machine, with both ends in this process. Each backend is given "
+            "a latency run, one message in flight at a time, then a throughput run with a window of messages in flight.\n\n"
+            "Backends: " + ChannelBenchmark::backends().join(", "));
+    parser.addHelpOption();
+    QCommandLineOption backendOption("backend", "Backend to run, can be given more than once. By default every backend is run.", "name");
+    QCommandLineOption sizeOption("size", "Message size in bytes.", "bytes", "64");
+    QCommandLineOption countOption("count", "Messages sent in each run.", "number", "10000");
+    QCommandLineOption portOption("port", "Loopback port for the tcp and udp backends.", "port", "5600");
+    parser.addOptions({ backendOption, sizeOption, countOption, portOption });
+    parser.process(a);
+
+    Logger::rootLogger()->setMaxStdoutLevel(Logger::LogLevelError);
+
+    QStringList backends = parser.values(backendOption);
+    if (backends.isEmpty())
+    {
+        backends = ChannelBenchmark::backends();
+    }
+    int size = parser.value(sizeOption).toInt();
+    int count = parser.value(countOption).toInt();
+    bool ok;
+    quint16 port = parser.value(portOption).toUShort(&ok);
+    if ((size <= 0) || (count <= 0) || !ok || (port == 0))
+    {
+        LOG_E("ChannelBench", "Invalid --size, --count or --port");
+        return 1;
+    }
+
+    QTextStream out(stdout);
+    out << QString("%1 %2 %3 %4 %5 %6").arg("backend", -10).arg("p50 us", 10).arg("p99 us", 10)
+           .arg("max us", 10).arg("msg/s", 12).arg("lost", 8) << endl;
+
+    bool failed = false;
+    for (const QString& backend : backends)
+    {
+        ChannelBenchmark benchmark(backend, size, count, port);
+        ChannelBenchmark::Result result = benchmark.run();
+        if (!result.ok)
+        {
+            out << QString("%1 %2").arg(backend, -10).arg(result.error) << endl;
+            failed = true;
+            continue;
+        }
+        out << QString("%1 %2 %3 %4 %5 %6").arg(backend, -10)
+               .arg(result.latencyP50, 10, 'f', 1)
+               .arg(result.latencyP99, 10, 'f', 1)
+               .arg(result.latencyMax, 10, 'f', 1)
+               .arg(result.messagesPerSecond, 12, 'f', 0)
+               .arg(result.lost, 8) << endl;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "impairmentprofile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Soro {
+
+ImpairmentProfile::ImpairmentProfile()
+{
+    _name = "unimpaired";
+    Keyframe start;
+    start.time = 0;
+    _keyframes.append(start);
+}
+
+bool ImpairmentProfile::load(QString path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        _error = "Cannot open " + path + ": " + file.errorString();
+        return false;
+    }
+    QList<Keyframe> keyframes;
+    double loopLength = 0;
+    bool ok = path.endsWith(".csv", Qt::CaseInsensitive) ? loadTrace(file, keyframes, loopLength)
+                                                         : loadScript(file, keyframes, loopLength);
+    if (!ok) return false;
+    if (keyframes.isEmpty())
+    {
+        _error = path + " has no conditions in it";
+        return false;
+    }
+    if (keyframes.first().time > 0)
+    {
+        // The link is unimpaired until the first line takes effect
+        Keyframe start;
+        start.time = 0;
+        keyframes.prepend(start);
+    }
+    if ((loopLength > 0) && (loopLength <= keyframes.last().time))
+    {
+        _error = path + " loops before its last line takes effect";
+        return false;
+    }
+    _keyframes = keyframes;
+    _loopLength = loopLength;
+    _name = QFileInfo(path).fileName();
+    return true;
+}
+
+bool ImpairmentProfile::loadScript(QFile& file, QList<Keyframe>& keyframes, double& loopLength)
+{
+    LinkConditions conditions;
+    int lineNumber = 0;
+    while (!file.atEnd())
+    {
+        lineNumber++;
+        QString line = QString::fromUtf8(file.readLine());
+        int comment = line.indexOf('#');
+        if (comment >= 0) line.truncate(comment);
+        QStringList words = line.split(QRegExp("\\s+"), QString::SkipEmptyParts);
+        if (words.isEmpty()) continue;
+
+        QString where = file.fileName() + " line " + QString::number(lineNumber);
+        bool ok = false;
+        if (words[0] == "loop")
+        {
+            loopLength = words.size() == 2 ? words[1].toDouble(&ok) : 0;
+            if (!ok || (loopLength <= 0))
+            {
+                _error = where + ": expected \"loop <seconds>\"";
+                return false;
+            }
+            continue;
+        }
+        Keyframe keyframe;
+        keyframe.time = words[0].toDouble(&ok);
+        if (!ok || (keyframe.time < 0) || (!keyframes.isEmpty() && (keyframe.time <= keyframes.last().time)))
+        {
+            _error = where + ": expected a time later than the line before it";
+            return false;
+        }
+        for (int i = 1; i < words.size(); i++)
+        {
+            int equals = words[i].indexOf('=');
+            if ((equals <= 0) || !applySetting(conditions, words[i].left(equals), words[i].mid(equals + 1)))
+            {
+                _error = where + ": invalid setting " + words[i];
+                return false;
+            }
+        }
+        keyframe.conditions = conditions;
+        keyframes.append(keyframe);
+    }
+    return true;
+}
+
+bool ImpairmentProfile::loadTrace(QFile& file, QList<Keyframe>& keyframes, double& loopLength)
+{
+    while (!file.atEnd())
+    {
+        QStringList columns = QString::fromUtf8(file.readLine()).trimmed().split(',');
+        if (columns.size() < 3) continue;
+        bool timeOk, delayOk, rateOk, lossOk = true;
+        Keyframe keyframe;
+        keyframe.time = columns[0].toDouble(&timeOk) / 1000;
+        keyframe.conditions.delay = columns[1].toDouble(&delayOk);
+        keyframe.conditions.rate = columns[2].toDouble(&rateOk);
+        if (columns.size() > 3)
+        {
+            keyframe.conditions.loss = columns[3].toDouble(&lossOk);
+        }
+        if (!timeOk || !delayOk || !rateOk || !lossOk) continue;
+        // Some radios report no throughput at all for a while, which is an outage rather than "unlimited"
+        keyframe.conditions.outage = keyframe.conditions.rate <= 0;
+        if (!keyframes.isEmpty() && (keyframe.time <= keyframes.last().time)) continue;
+        keyframes.append(keyframe);
+    }
+    if (keyframes.size() < 2)
+    {
+        _error = file.fileName() + " needs at least two rows of time_ms,delay_ms,rate_kbps[,loss]";
+        return false;
+    }
+    // Make traces start at zero and give the last row as long as the one before it
+    double offset = keyframes.first().time;
+    for (Keyframe& keyframe : keyframes)
+    {
+        keyframe.time -= offset;
+    }
+    int last = keyframes.size() - 1;
+    loopLength = 2 * keyframes[last].time - keyframes[last - 1].time;
+    return true;
+}
+
+bool ImpairmentProfile::applySetting(LinkConditions& conditions, QString key, QString value)
+{
+    bool ok;
+    double number = value.toDouble(&ok);
+    if (!ok || (number < 0)) return false;
+    bool probability = number <= 1;
+
+    if (key == "delay") conditions.delay = number;
+    else if (key == "jitter") conditions.jitter = number;
+    else if (key == "rate") conditions.rate = number;
+    else if (key == "queue") conditions.queue = number;
+    else if (key == "reorder_delay") conditions.reorderDelay = number;
+    else if (key == "outage") conditions.outage = number != 0;
+    else if (!probability) return false;
+    else if (key == "loss") conditions.loss = number;
+    else if (key == "burst_loss") conditions.burstLoss = number;
+    else if (key == "burst_enter") conditions.burstEnter = number;
+    else if (key == "burst_exit") conditions.burstExit = number;
+    else if (key == "reorder") conditions.reorder = number;
+    else return false;
+    return true;
+}
+
+double ImpairmentProfile::toLocalTime(double seconds) const
+{
+    return _loopLength > 0 ? fmod(seconds, _loopLength) : seconds;
+}
+
+int ImpairmentProfile::indexAt(double localTime) const
+{
+    // Keyframe times are strictly increasing, so the one in effect is just before the first later one
+    QList<Keyframe>::const_iterator later = std::upper_bound(_keyframes.constBegin(), _keyframes.constEnd(), localTime,
+                                                             [](double time, const Keyframe& keyframe) {
+        return time < keyframe.time;
+    });
+    return qMax(0, static_cast<int>(later - _keyframes.constBegin()) - 1);
+}
+
+LinkConditions ImpairmentProfile::conditionsAt(double seconds) const
+{
+    return _keyframes[indexAt(toLocalTime(seconds))].conditions;
+}
+
+double ImpairmentProfile::outageEnd(double seconds) const
+{
+    double localTime = toLocalTime(seconds);
+    double loopStart = seconds - localTime;
+    int index = indexAt(localTime);
+    if (!_keyframes[index].conditions.outage) return seconds;
+
+    // Look through at most one full pass of the profile for the outage to end
+    for (int step = 1; step <= _keyframes.size(); step++)
+    {
+        int next = index + step;
+        if (next >= _keyframes.size())
+        {
+            if (_loopLength <= 0) break;
+            next -= _keyframes.size();
+            if (next == 0) loopStart += _loopLength;
+        }
+        if (!_keyframes[next].conditions.outage)
+        {
+            return loopStart + _keyframes[next].time;
+        }
+    }
+    return std::numeric_limits<double>::infinity();
+}
+
+QString ImpairmentProfile::getName() const
+{
+    return _name;
+}
+
+QString ImpairmentProfile::getError() const
+{
+    return _error;
+}
+
+} // namespace Soro
@@ -0,0 +1,90 @@
+#ifndef SORO_IMPAIRMENTPROFILE_H
+#define SORO_IMPAIRMENTPROFILE_H
+
+#include <QtCore>
+
+namespace Soro {
+
+/* Conditions on one direction of a link at a point in time
+ */
+struct LinkConditions
+{
+    double delay = 0;           // One way delay in milliseconds
+    double jitter = 0;          // Standard deviation of the delay in milliseconds
+    double rate = 0;            // Link capacity in kbit/s, 0 for unlimited
+    double queue = 500;         // Milliseconds of traffic that can wait for the link before datagrams are dropped
+    double loss = 0;            // Chance of losing a packet while the link is good
+    double burstLoss = 0;       // Chance of losing a packet during a loss burst
+    double burstEnter = 0;      // Chance per packet of a good link starting a loss burst
+    double burstExit = 1;       // Chance per packet of a loss burst ending
+    double reorder = 0;         // Chance of holding a packet back so the ones after it overtake it
+    double reorderDelay = 20;   // How long a reordered packet is held back, in milliseconds
+    bool outage = false;        // Nothing gets through
+};
+
+/* A scripted, time-varying set of link conditions.
+ *
+ * Profiles are read from one of two kinds of file:
+ *
+ * - A script (any extension other than .csv). Each line is a time in seconds followed by
+ *   key=value pairs, which take effect at that time and stay in effect until changed.
+ *   Keys are delay, jitter, rate, queue, loss, burst_loss, burst_enter, burst_exit, reorder,
+ *   reorder_delay and outage. A line "loop <seconds>" makes the script repeat.
+ *
+ *       loop 120
+ *       0   delay=60 jitter=10 rate=4000
+ *       40  loss=0.01 burst_enter=0.02 burst_exit=0.3 burst_loss=0.5
+ *       90  outage=1
+ *       95  outage=0 loss=0
+ *
+ * - A recorded trace (.csv), one row per measurement of time_ms,delay_ms,rate_kbps and
+ *   optionally loss. Non-numeric rows (such as a header) are skipped. A trace always loops.
+ *
+ * Loss follows the Gilbert-Elliott model: the link moves between a good state and a bursty
+ * bad state, each with its own loss rate.
+ */
+class ImpairmentProfile {
+public:
+    /* Creates a profile that leaves the link alone
+     */
+    ImpairmentProfile();
+
+    /* Reads a script or trace, depending on the file's extension. Returns false and leaves
+     * the profile unchanged if the file can't be read or has a mistake in it.
+     */
+    bool load(QString path);
+
+    /* Gets the conditions in effect a number of seconds into the profile
+     */
+    LinkConditions conditionsAt(double seconds) const;
+
+    /* Gets the time an outage in effect at a point in the profile is over,
+     * or infinity if it never is
+     */
+    double outageEnd(double seconds) const;
+
+    QString getName() const;
+    QString getError() const;
+
+private:
+    struct Keyframe
+    {
+        double time;
+        LinkConditions conditions;
+    };
+
+    QString _name;
+    QString _error;
+    QList<Keyframe> _keyframes;
+    double _loopLength = 0;     // 0 if the profile doesn't loop
+
+    bool loadScript(QFile& file, QList<Keyframe>& keyframes, double& loopLength);
+    bool loadTrace(QFile& file, QList<Keyframe>& keyframes, double& loopLength);
+    bool applySetting(LinkConditions& conditions, QString key, QString value);
+    int indexAt(double localTime) const;
+    double toLocalTime(double seconds) const;
+};
+
+} // namespace Soro
+
+#endif // SORO_IMPAIRMENTPROFILE_H
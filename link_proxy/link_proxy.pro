@@ -0,0 +1,37 @@
+QT += core network
+
+CONFIG += c++11 no_keywords
+CONFIG += console
+CONFIG -= app_bundle
+TARGET = link_proxy
+TEMPLATE = app
+
+BUILD_DIR = ../build/link_proxy
+DESTDIR = ../bin
+OBJECTS_DIR = $$BUILD_DIR
+MOC_DIR = $$BUILD_DIR
+RCC_DIR = $$BUILD_DIR
+UI_DIR = $$BUILD_DIR
+PRECOMPILED_DIR = $$BUILD_DIR
+
+HEADERS += \
+    linkproxy.h \
+    linkemulator.h \
+    impairmentprofile.h \
+    udpforwarder.h \
+    tcpforwarder.h \
+    tcpproxyconnection.h
+
+SOURCES += \
+    main.cpp \
+    linkproxy.cpp \
+    linkemulator.cpp \
+    impairmentprofile.cpp \
+    udpforwarder.cpp \
+    tcpforwarder.cpp \
+    tcpproxyconnection.cpp
+
+# Include headers from other subprojects
+INCLUDEPATH += $$PWD/..
+
+LIBS += -L../lib -lsoro_core
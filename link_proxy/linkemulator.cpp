@@ -0,0 +1,201 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "linkemulator.h"
+
+#include <cmath>
+
+//shortest retransmission timeout Linux will use, in microseconds
+#define MIN_RTO 200000
+//give up retransmitting a reliable packet after this many losses in a row, as a real stack would have stalled anyway
+#define MAX_RETRANSMISSIONS 6
+
+namespace Soro {
+
+LinkEmulator::LinkEmulator(QString name, const ImpairmentProfile& profile, quint32 seed, const QElapsedTimer *clock, QObject *parent)
+    : QObject(parent), _uniform(0.0, 1.0), _normal(0.0, 1.0)
+{
+    _name = name;
+    _profile = profile;
+    _clock = clock;
+    _random.seed(seed);
+    _timer = new QTimer(this);
+    _timer->setSingleShot(true);
+    _timer->setTimerType(Qt::PreciseTimer);
+    connect(_timer, &QTimer::timeout, this, &LinkEmulator::deliverDue);
+}
+
+qint64 LinkEmulator::now() const
+{
+    return _clock->nsecsElapsed() / 1000;
+}
+
+bool LinkEmulator::roll(double probability)
+{
+    return (probability > 0) && (_uniform(_random) < probability);
+}
+
+bool LinkEmulator::lose(const LinkConditions& conditions)
+{
+    // Gilbert-Elliott: move between the good and bursty states, then lose the packet at that state's rate
+    if (_burst)
+    {
+        if (roll(conditions.burstExit)) _burst = false;
+    }
+    else if (roll(conditions.burstEnter))
+    {
+        _burst = true;
+    }
+    return roll(_burst ? conditions.burstLoss : conditions.loss);
+}
+
+qint64 LinkEmulator::transmit(int size, const LinkConditions& conditions, qint64 sendTime)
+{
+    _linkFreeAt = qMax(_linkFreeAt, sendTime);
+    if (conditions.rate > 0)
+    {
+        // kbit/s is the same as bits per millisecond
+        _linkFreeAt += (qint64)(size * 8 * 1000.0 / conditions.rate);
+    }
+    return _linkFreeAt;
+}
+
+qint64 LinkEmulator::travel(const LinkConditions& conditions)
+{
+    double delay = conditions.delay;
+    if (conditions.jitter > 0)
+    {
+        delay += _normal(_random) * conditions.jitter;
+    }
+    if (roll(conditions.reorder))
+    {
+        delay += conditions.reorderDelay;
+    }
+    return (qint64)(qMax(delay, 0.0) * 1000);
+}
+
+bool LinkEmulator::send(int size, Delivery delivery)
+{
+    qint64 time = now();
+    LinkConditions conditions = _profile.conditionsAt(time / 1000000.0);
+    if (conditions.outage)
+    {
+        _stats.outageDrops++;
+        return false;
+    }
+    if ((conditions.rate > 0) && (_linkFreeAt - time > conditions.queue * 1000))
+    {
+        _stats.queueDrops++;
+        return false;
+    }
+    // A lost packet still used up its share of the link
+    qint64 sent = transmit(size, conditions, time);
+    if (lose(conditions))
+    {
+        _stats.lost++;
+        return false;
+    }
+    _stats.packets++;
+    _stats.bytes += size;
+    schedule(sent + travel(conditions), delivery);
+    return true;
+}
+
+void LinkEmulator::sendReliable(int size, Delivery delivery, qint64 *order)
+{
+    qint64 time = now();
+    LinkConditions conditions = _profile.conditionsAt(time / 1000000.0);
+    qint64 sendTime = time;
+    for (int attempt = 0; attempt <= MAX_RETRANSMISSIONS; attempt++)
+    {
+        if (conditions.outage)
+        {
+            double end = _profile.outageEnd(sendTime / 1000000.0);
+            if (std::isinf(end))
+            {
+                // The link never comes back, so neither does this
+                _stats.outageDrops++;
+                return;
+            }
+            sendTime = (qint64)(end * 1000000);
+            conditions = _profile.conditionsAt(end);
+        }
+        qint64 sent = transmit(size, conditions, sendTime);
+        if ((attempt == MAX_RETRANSMISSIONS) || !lose(conditions))
+        {
+            _stats.packets++;
+            _stats.bytes += size;
+            *order = qMax(*order, sent + travel(conditions));
+            schedule(*order, delivery);
+            return;
+        }
+        // The sender notices after a timeout (about twice the round trip) and tries again
+        _stats.retransmissions++;
+        sendTime = sent + qMax((qint64)MIN_RTO, (qint64)(conditions.delay * 4000));
+        conditions = _profile.conditionsAt(sendTime / 1000000.0);
+    }
+}
+
+void LinkEmulator::schedule(qint64 time, Delivery delivery)
+{
+    bool earliest = _pending.empty() || (time < _pending.begin()->first);
+    // std::multimap keeps packets due at the same time in the order they were sent
+    _pending.insert(std::make_pair(time, delivery));
+    if (earliest)
+    {
+        _timer->start((int)qMax((qint64)0, (time - now() + 999) / 1000));
+    }
+}
+
+void LinkEmulator::deliverDue()
+{
+    qint64 time = now();
+    // Deliveries can queue more packets, so take each one off before calling it
+    while (!_pending.empty() && (_pending.begin()->first <= time))
+    {
+        Delivery delivery = _pending.begin()->second;
+        _pending.erase(_pending.begin());
+        delivery();
+    }
+    if (!_pending.empty())
+    {
+        _timer->start((int)qMax((qint64)0, (_pending.begin()->first - time + 999) / 1000));
+    }
+}
+
+LinkConditions LinkEmulator::getConditions() const
+{
+    return _profile.conditionsAt(now() / 1000000.0);
+}
+
+int LinkEmulator::getPendingCount() const
+{
+    return (int)_pending.size();
+}
+
+LinkEmulator::Stats LinkEmulator::takeStats()
+{
+    Stats stats = _stats;
+    _stats = Stats();
+    return stats;
+}
+
+QString LinkEmulator::getName() const
+{
+    return _name;
+}
+
+} // namespace Soro
@@ -0,0 +1,90 @@
+#ifndef SORO_LINKEMULATOR_H
+#define SORO_LINKEMULATOR_H
+
+#include <QtCore>
+#include <functional>
+#include <map>
+#include <random>
+
+#include "impairmentprofile.h"
+
+namespace Soro {
+
+/* Emulates one direction of a link, shared by every flow that crosses it in that direction.
+ *
+ * Each packet handed to send() is either dropped or delivered later, by calling the function
+ * given with it once it has made it across. Delivery times account for the time the packet
+ * waits for the link (its rate is shared by all flows), delay, jitter and reordering.
+ *
+ * Reliable packets (those of a TCP stream) are never dropped. A loss instead costs them a
+ * retransmission timeout, an outage holds them until it is over, and they are delivered in
+ * the order they were sent.
+ *
+ * Random decisions come from a seeded generator, so a run can be repeated exactly given
+ * the same seed and the same traffic.
+ */
+class LinkEmulator: public QObject {
+    Q_OBJECT
+public:
+    typedef std::function<void()> Delivery;
+
+    struct Stats
+    {
+        qint64 packets = 0;
+        qint64 bytes = 0;
+        qint64 lost = 0;            // Dropped by the loss model
+        qint64 outageDrops = 0;
+        qint64 queueDrops = 0;      // Dropped because too much was waiting for the link
+        qint64 retransmissions = 0; // Losses of reliable packets that were delayed instead
+    };
+
+    /* The clock is shared by every emulator, so both directions follow the same profile timeline
+     */
+    LinkEmulator(QString name, const ImpairmentProfile& profile, quint32 seed, const QElapsedTimer *clock, QObject *parent=nullptr);
+
+    /* Sends an unreliable packet (a datagram), returns false if it was dropped
+     */
+    bool send(int size, Delivery delivery);
+
+    /* Sends part of a reliable stream. It will not be delivered before anything sent earlier
+     * with the same order variable, which must start out at zero.
+     */
+    void sendReliable(int size, Delivery delivery, qint64 *order);
+
+    LinkConditions getConditions() const;
+
+    /* Gets the number of packets waiting to be delivered
+     */
+    int getPendingCount() const;
+
+    /* Gets the stats since the last call
+     */
+    Stats takeStats();
+
+    QString getName() const;
+
+private:
+    QString _name;
+    ImpairmentProfile _profile;
+    const QElapsedTimer *_clock;
+    std::mt19937 _random;
+    std::uniform_real_distribution<double> _uniform;
+    std::normal_distribution<double> _normal;
+    bool _burst = false;
+    qint64 _linkFreeAt = 0;         // Microseconds
+    std::multimap<qint64, Delivery> _pending;
+    QTimer *_timer;
+    Stats _stats;
+
+    qint64 now() const;
+    bool roll(double probability);
+    bool lose(const LinkConditions& conditions);
+    qint64 transmit(int size, const LinkConditions& conditions, qint64 sendTime);
+    qint64 travel(const LinkConditions& conditions);
+    void schedule(qint64 time, Delivery delivery);
+    void deliverDue();
+};
+
+} // namespace Soro
+
+#endif // SORO_LINKEMULATOR_H
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "linkproxy.h"
+#include "soro_core/logger.h"
+
+namespace Soro {
+
+LinkProxy::LinkProxy(const Options& options, QObject *parent) : QObject(parent)
+{
+    LOG_TAG = "LinkProxy";
+    _options = options;
+}
+
+bool LinkProxy::start()
+{
+    _clock.start();
+    // Each direction gets its own random sequence, so the uplink's traffic doesn't change the downlink's losses
+    _uplink = new LinkEmulator("uplink", _options.uplink, _options.seed, &_clock, this);
+    _downlink = new LinkEmulator("downlink", _options.downlink, _options.seed + 1, &_clock, this);
+    LOG_I(LOG_TAG, "Uplink profile is " + _options.uplink.getName() + ", downlink profile is "
+          + _options.downlink.getName() + ", random seed is " + QString::number(_options.seed));
+
+    for (const Forward& forward : _options.forwards)
+    {
+        SocketAddress listen(_options.listenAddress, forward.port);
+        SocketAddress target(_options.roverAddress, forward.port);
+        if (forward.tcp)
+        {
+            TcpForwarder *forwarder = new TcpForwarder(listen, target, _uplink, _downlink, this);
+            if (!forwarder->isListening()) return false;
+            LOG_I(LOG_TAG, "Forwarding " + forwarder->getDescription());
+        }
+        else
+        {
+            UdpForwarder *forwarder = new UdpForwarder(listen, target, _uplink, _downlink, this);
+            if (!forwarder->isListening()) return false;
+            LOG_I(LOG_TAG, "Forwarding " + forwarder->getDescription());
+        }
+    }
+    START_TIMER(_statsTimerId, _options.statsInterval * 1000);
+    return true;
+}
+
+QString LinkProxy::describe(const LinkConditions& conditions)
+{
+    if (conditions.outage) return "OUTAGE";
+    QString description = QString("delay=%1ms jitter=%2ms").arg(conditions.delay).arg(conditions.jitter);
+    description += conditions.rate > 0 ? QString(" rate=%1kbps").arg(conditions.rate) : QString(" rate=unlimited");
+    if ((conditions.loss > 0) || (conditions.burstEnter > 0))
+    {
+        description += QString(" loss=%1/%2").arg(conditions.loss).arg(conditions.burstLoss);
+    }
+    if (conditions.reorder > 0)
+    {
+        description += QString(" reorder=%1").arg(conditions.reorder);
+    }
+    return description;
+}
+
+void LinkProxy::logStats(LinkEmulator *link)
+{
+    LinkEmulator::Stats stats = link->takeStats();
+    LOG_I(LOG_TAG, QString("%1 [%2] %3 packets, %4 kbps, lost %5, outage drops %6, queue drops %7, retransmitted %8, %9 in flight")
+          .arg(link->getName(), describe(link->getConditions()))
+          .arg(stats.packets)
+          .arg(stats.bytes * 8 / 1000 / _options.statsInterval)
+          .arg(stats.lost)
+          .arg(stats.outageDrops)
+          .arg(stats.queueDrops)
+          .arg(stats.retransmissions)
+          .arg(link->getPendingCount()));
+}
+
+void LinkProxy::timerEvent(QTimerEvent *e)
+{
+    QObject::timerEvent(e);
+    if (e->timerId() == _statsTimerId)
+    {
+        logStats(_uplink);
+        logStats(_downlink);
+    }
+}
+
+} // namespace Soro
@@ -0,0 +1,63 @@
+#ifndef SORO_LINKPROXY_H
+#define SORO_LINKPROXY_H
+
+#include <QtCore>
+
+#include "soro_core/constants.h"
+#include "impairmentprofile.h"
+#include "linkemulator.h"
+#include "udpforwarder.h"
+#include "tcpforwarder.h"
+
+namespace Soro {
+
+/* Stands in for the radio link between mission control and the rover.
+ *
+ * Every forwarded port crosses the same pair of link emulators (one toward the rover, one toward
+ * mission control), so the drive, main, audio and video flows all compete for the same emulated
+ * capacity and see the same outages, as they would on a real link.
+ */
+class LinkProxy: public QObject {
+    Q_OBJECT
+public:
+    struct Forward
+    {
+        quint16 port;
+        bool tcp;
+    };
+
+    struct Options
+    {
+        QHostAddress listenAddress;
+        QHostAddress roverAddress;
+        QList<Forward> forwards;
+        ImpairmentProfile uplink;       // Toward the rover
+        ImpairmentProfile downlink;     // Toward mission control
+        quint32 seed = 0;
+        int statsInterval = 5;          // Seconds
+    };
+
+    LinkProxy(const Options& options, QObject *parent=nullptr);
+
+    /* Opens every forwarded port, returns false if any of them can't be opened
+     */
+    bool start();
+
+protected:
+    void timerEvent(QTimerEvent *e);
+
+private:
+    QString LOG_TAG;
+    Options _options;
+    QElapsedTimer _clock;
+    LinkEmulator *_uplink = nullptr;
+    LinkEmulator *_downlink = nullptr;
+    int _statsTimerId = TIMER_INACTIVE;
+
+    void logStats(LinkEmulator *link);
+    static QString describe(const LinkConditions& conditions);
+};
+
+} // namespace Soro
+
+#endif // SORO_LINKPROXY_H
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+
+#include "linkproxy.h"
+#include "soro_core/logger.h"
+
+using namespace Soro;
+
+static bool loadProfile(QString path, ImpairmentProfile *profile)
+{
+    if (path.isEmpty()) return true;
+    if (!profile->load(path))
+    {
+        LOG_E("LinkProxy", profile->getError());
+        return false;
+    }
+    return true;
+}
+
+static bool parsePorts(QStringList values, bool tcp, QList<LinkProxy::Forward> *forwards)
+{
+    for (const QString& value : values)
+    {
+        bool ok;
+        LinkProxy::Forward forward;
+        forward.port = value.toUShort(&ok);
+        forward.tcp = tcp;
+        if (!ok || (forward.port == 0))
+        {
+            LOG_E("LinkProxy", "Invalid port " + value);
+            return false;
+        }
+        forwards->append(forward);
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("link_proxy");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+            "Sits between mission control and the rover and puts every flow through the same emulated link, "
+            "with delay, jitter, bursty loss, a capacity limit, reordering and outages following a profile.\n\n"
+            "To run everything on one machine, set bind_address=127.0.0.1 in the rover's research_rover.conf "
+            "and rover_address=127.0.0.2 in research_control.conf.");
+    parser.addHelpOption();
+    QCommandLineOption listenOption("listen", "Address mission control connects to.", "address", "127.0.0.2");
+    QCommandLineOption roverOption("rover", "Address the rover is listening on.", "address", "127.0.0.1");
+    QCommandLineOption profileOption("profile", "Profile script or .csv trace for both directions.", "path");
+    QCommandLineOption uplinkOption("uplink", "Profile toward the rover, in place of --profile.", "path");
+    QCommandLineOption downlinkOption("downlink", "Profile toward mission control, in place of --profile.", "path");
+    QCommandLineOption seedOption("seed", "Random seed, runs with the same seed and traffic make the same decisions.", "number", "1");
+    QCommandLineOption tcpOption("tcp", "Forward a TCP port, can be given more than once. By default every rover port is forwarded.", "port");
+    QCommandLineOption udpOption("udp", "Forward a UDP port, can be given more than once.", "port");
+    QCommandLineOption statsOption("stats-interval", "Seconds between link statistics in the log.", "seconds", "5");
+    parser.addOptions({ listenOption, roverOption, profileOption, uplinkOption, downlinkOption,
+                        seedOption, tcpOption, udpOption, statsOption });
+    parser.process(a);
+
+    Logger::rootLogger()->setMaxStdoutLevel(Logger::LogLevelInformation);
+
+    LinkProxy::Options options;
+    if (!options.listenAddress.setAddress(parser.value(listenOption))
+            || !options.roverAddress.setAddress(parser.value(roverOption)))
+    {
+        LOG_E("LinkProxy", "Invalid --listen or --rover address");
+        return 1;
+    }
+    if (!loadProfile(parser.value(profileOption), &options.uplink)) return 1;
+    options.downlink = options.uplink;
+    if (!loadProfile(parser.value(uplinkOption), &options.uplink)) return 1;
+    if (!loadProfile(parser.value(downlinkOption), &options.downlink)) return 1;
+    options.seed = parser.value(seedOption).toUInt();
+    options.statsInterval = qMax(parser.value(statsOption).toInt(), 1);
+
+    if (!parsePorts(parser.values(tcpOption), true, &options.forwards)) return 1;
+    if (!parsePorts(parser.values(udpOption), false, &options.forwards)) return 1;
+    if (options.forwards.isEmpty())
+    {
+        // Media servers use the same port for their TCP control channel and UDP stream
+        parsePorts(QStringList() << QString::number(NETWORK_ALL_MAIN_CHANNEL_PORT)
+                   << QString::number(NETWORK_ALL_AUDIO_PORT)
+                   << QString::number(NETWORK_ALL_MAIN_CAMERA_PORT)
+                   << QString::number(NETWORK_ALL_AUX1_CAMERA_PORT), true, &options.forwards);
+        parsePorts(QStringList() << QString::number(NETWORK_ALL_DRIVE_CHANNEL_PORT)
+                   << QString::number(NETWORK_ALL_AUDIO_PORT)
+                   << QString::number(NETWORK_ALL_MAIN_CAMERA_PORT)
+                   << QString::number(NETWORK_ALL_AUX1_CAMERA_PORT), false, &options.forwards);
+    }
+
+    LinkProxy proxy(options);
+    if (!proxy.start())
+    {
+        return 1;
+    }
+    return a.exec();
+}
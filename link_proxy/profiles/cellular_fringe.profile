@@ -0,0 +1,10 @@
+# A cellular link at the edge of coverage: usable most of the time, with loss bursts,
+# a drop in capacity while the modem changes cells, and a short outage once a cycle.
+loop 180
+
+0    delay=45 jitter=8 rate=6000 queue=400 loss=0.002 burst_enter=0.005 burst_exit=0.3 burst_loss=0.4
+60   delay=70 jitter=20 rate=1500 reorder=0.01
+90   delay=45 jitter=8 rate=6000 reorder=0
+140  outage=1
+143  outage=0 delay=120 jitter=40 rate=800
+150  delay=45 jitter=8 rate=6000
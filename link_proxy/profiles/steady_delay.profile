@@ -0,0 +1,2 @@
+# A fixed one way delay and nothing else, the same as the old simulated drive delay but on every flow
+0    delay=250
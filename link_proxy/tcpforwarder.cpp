@@ -0,0 +1,61 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tcpforwarder.h"
+#include "tcpproxyconnection.h"
+#include "soro_core/logger.h"
+
+namespace Soro {
+
+TcpForwarder::TcpForwarder(SocketAddress listen, SocketAddress target, LinkEmulator *toTarget, LinkEmulator *fromTarget, QObject *parent)
+    : QObject(parent)
+{
+    LOG_TAG = "TCP " + QString::number(listen.port);
+    _listen = listen;
+    _target = target;
+    _toTarget = toTarget;
+    _fromTarget = fromTarget;
+
+    _server = new QTcpServer(this);
+    if (!_server->listen(listen.host, listen.port))
+    {
+        LOG_E(LOG_TAG, "Cannot listen on " + listen.toString() + ": " + _server->errorString());
+        return;
+    }
+    connect(_server, &QTcpServer::newConnection, this, &TcpForwarder::newConnection);
+}
+
+bool TcpForwarder::isListening() const
+{
+    return _server->isListening();
+}
+
+QString TcpForwarder::getDescription() const
+{
+    return "TCP " + _listen.toString() + " -> " + _target.toString();
+}
+
+void TcpForwarder::newConnection()
+{
+    while (_server->hasPendingConnections())
+    {
+        QTcpSocket *client = _server->nextPendingConnection();
+        TcpProxyConnection *connection = new TcpProxyConnection(client, _target, _toTarget, _fromTarget, this);
+        LOG_I(LOG_TAG, "Accepted " + connection->getDescription());
+    }
+}
+
+} // namespace Soro
@@ -0,0 +1,37 @@
+#ifndef SORO_TCPFORWARDER_H
+#define SORO_TCPFORWARDER_H
+
+#include <QtCore>
+#include <QTcpServer>
+
+#include "soro_core/socketaddress.h"
+#include "linkemulator.h"
+
+namespace Soro {
+
+/* Accepts TCP connections on a port and forwards each one to a target through a pair of link
+ * emulators (see TcpProxyConnection)
+ */
+class TcpForwarder: public QObject {
+    Q_OBJECT
+public:
+    TcpForwarder(SocketAddress listen, SocketAddress target, LinkEmulator *toTarget, LinkEmulator *fromTarget, QObject *parent=nullptr);
+
+    bool isListening() const;
+    QString getDescription() const;
+
+private:
+    QString LOG_TAG;
+    SocketAddress _listen;
+    SocketAddress _target;
+    LinkEmulator *_toTarget;
+    LinkEmulator *_fromTarget;
+    QTcpServer *_server;
+
+private Q_SLOTS:
+    void newConnection();
+};
+
+} // namespace Soro
+
+#endif // SORO_TCPFORWARDER_H
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tcpproxyconnection.h"
+#include "soro_core/logger.h"
+
+//size of the pieces data is sent across the link in, about the same as a TCP segment
+#define SEGMENT_SIZE 1400
+//most data let onto the link in each direction before reading more, like a TCP window
+#define WINDOW_SIZE (64 * 1024)
+
+namespace Soro {
+
+TcpProxyConnection::TcpProxyConnection(QTcpSocket *client, SocketAddress target, LinkEmulator *toTarget, LinkEmulator *fromTarget, QObject *parent)
+    : QObject(parent)
+{
+    LOG_TAG = "TCP " + client->peerAddress().toString() + ":" + QString::number(client->peerPort());
+    _client = client;
+    _client->setParent(this);
+    _target = new QTcpSocket(this);
+
+    _toTarget.from = _client;
+    _toTarget.to = _target;
+    _toTarget.link = toTarget;
+    _fromTarget.from = _target;
+    _fromTarget.to = _client;
+    _fromTarget.link = fromTarget;
+
+    connect(_target, &QTcpSocket::connected, this, &TcpProxyConnection::targetConnected);
+    connect(_target, static_cast<void (QTcpSocket::*)(QAbstractSocket::SocketError)>(&QTcpSocket::error),
+            this, &TcpProxyConnection::targetError);
+
+    // Nothing is read from the client until there is somewhere to put it
+    _target->connectToHost(target.host, target.port);
+}
+
+QString TcpProxyConnection::getDescription() const
+{
+    return LOG_TAG;
+}
+
+void TcpProxyConnection::targetConnected()
+{
+    LOG_I(LOG_TAG, "Connected through to " + _target->peerAddress().toString() + ":" + QString::number(_target->peerPort()));
+    connect(_client, &QTcpSocket::readyRead, this, [this]() { pump(&_toTarget); });
+    connect(_target, &QTcpSocket::readyRead, this, [this]() { pump(&_fromTarget); });
+    connect(_client, &QTcpSocket::disconnected, this, [this]() { sourceClosed(&_toTarget); });
+    connect(_target, &QTcpSocket::disconnected, this, [this]() { sourceClosed(&_fromTarget); });
+    pump(&_toTarget);
+    if (_client->state() == QAbstractSocket::UnconnectedState)
+    {
+        // The client gave up while we were connecting
+        sourceClosed(&_toTarget);
+    }
+}
+
+void TcpProxyConnection::targetError(QAbstractSocket::SocketError error)
+{
+    Q_UNUSED(error);
+    if (_target->state() != QAbstractSocket::ConnectedState)
+    {
+        LOG_W(LOG_TAG, "Cannot connect through to the target: " + _target->errorString());
+        _client->abort();
+        deleteLater();
+    }
+}
+
+void TcpProxyConnection::pump(Pipe *pipe)
+{
+    QPointer<TcpProxyConnection> self = this;
+    while ((pipe->inFlight < WINDOW_SIZE) && (pipe->from->bytesAvailable() > 0))
+    {
+        QByteArray segment = pipe->from->read(SEGMENT_SIZE);
+        pipe->inFlight += segment.size();
+        pipe->link->sendReliable(segment.size(), [self, pipe, segment]()
+        {
+            if (!self) return;
+            pipe->inFlight -= segment.size();
+            pipe->to->write(segment);
+            // Delivering data opens the window back up
+            self->pump(pipe);
+        }, &pipe->order);
+    }
+    if (pipe->closing && (pipe->from->bytesAvailable() == 0))
+    {
+        // Send the close behind the rest of the data, it only needs to be sent once
+        pipe->closing = false;
+        pipe->link->sendReliable(0, [self, pipe]()
+        {
+            if (self) self->close(pipe->to);
+        }, &pipe->order);
+    }
+}
+
+void TcpProxyConnection::sourceClosed(Pipe *pipe)
+{
+    pipe->closing = true;
+    pump(pipe);
+}
+
+void TcpProxyConnection::close(QTcpSocket *socket)
+{
+    socket->disconnectFromHost();
+    if (++_closedCount == 2)
+    {
+        LOG_I(LOG_TAG, "Closed");
+        deleteLater();
+    }
+}
+
+} // namespace Soro
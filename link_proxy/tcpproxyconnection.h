@@ -0,0 +1,59 @@
+#ifndef SORO_TCPPROXYCONNECTION_H
+#define SORO_TCPPROXYCONNECTION_H
+
+#include <QtCore>
+#include <QTcpSocket>
+
+#include "soro_core/socketaddress.h"
+#include "linkemulator.h"
+
+namespace Soro {
+
+/* One connection through a TcpForwarder, made up of the client's socket and a socket to the target.
+ *
+ * Data is read in segment sized pieces and sent across the link emulators as a reliable stream.
+ * Only so much data is let onto the emulated link at a time, so a slow or interrupted link pushes
+ * back on the sender the way a real TCP window would, instead of buffering without limit.
+ *
+ * When either side closes, the close is sent across the link behind any data still on it.
+ * The connection deletes itself once both sides are closed.
+ */
+class TcpProxyConnection: public QObject {
+    Q_OBJECT
+public:
+    TcpProxyConnection(QTcpSocket *client, SocketAddress target, LinkEmulator *toTarget, LinkEmulator *fromTarget, QObject *parent=nullptr);
+
+    QString getDescription() const;
+
+private:
+    /* One direction of the connection
+     */
+    struct Pipe
+    {
+        QTcpSocket *from;
+        QTcpSocket *to;
+        LinkEmulator *link;
+        qint64 order = 0;
+        qint64 inFlight = 0;    // Bytes sent onto the link but not delivered yet
+        bool closing = false;
+    };
+
+    QString LOG_TAG;
+    QTcpSocket *_client;
+    QTcpSocket *_target;
+    Pipe _toTarget;
+    Pipe _fromTarget;
+    int _closedCount = 0;
+
+    void pump(Pipe *pipe);
+    void sourceClosed(Pipe *pipe);
+    void close(QTcpSocket *socket);
+
+private Q_SLOTS:
+    void targetConnected();
+    void targetError(QAbstractSocket::SocketError error);
+};
+
+} // namespace Soro
+
+#endif // SORO_TCPPROXYCONNECTION_H
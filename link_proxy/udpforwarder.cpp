@@ -0,0 +1,148 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "udpforwarder.h"
+#include "soro_core/logger.h"
+
+//time a client can go without sending or receiving anything before its session is dropped
+#define SESSION_TIMEOUT 60000
+//interval between checks for idle sessions
+#define CLEANUP_INTERVAL 10000
+//largest datagram that can be forwarded
+#define MAX_DATAGRAM_SIZE 65536
+
+namespace Soro {
+
+UdpForwarder::UdpForwarder(SocketAddress listen, SocketAddress target, LinkEmulator *toTarget, LinkEmulator *fromTarget, QObject *parent)
+    : QObject(parent)
+{
+    LOG_TAG = "UDP " + QString::number(listen.port);
+    _listen = listen;
+    _target = target;
+    _toTarget = toTarget;
+    _fromTarget = fromTarget;
+    _clock.start();
+
+    _socket = new QUdpSocket(this);
+    // Share the port with a rover bound to the wildcard address, datagrams to our address still come to us
+    _listening = _socket->bind(listen.host, listen.port, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint);
+    if (!_listening)
+    {
+        LOG_E(LOG_TAG, "Cannot bind to " + listen.toString() + ": " + _socket->errorString());
+        return;
+    }
+    connect(_socket, &QUdpSocket::readyRead, this, &UdpForwarder::listenReadyRead);
+    START_TIMER(_cleanupTimerId, CLEANUP_INTERVAL);
+}
+
+bool UdpForwarder::isListening() const
+{
+    return _listening;
+}
+
+QString UdpForwarder::getDescription() const
+{
+    return "UDP " + _listen.toString() + " -> " + _target.toString();
+}
+
+UdpForwarder::Session& UdpForwarder::sessionFor(const SocketAddress& client)
+{
+    QString key = client.toString();
+    QHash<QString, Session>::iterator session = _sessions.find(key);
+    if (session != _sessions.end()) return session.value();
+
+    LOG_I(LOG_TAG, "New client " + key);
+    Session newSession;
+    newSession.client = client;
+    newSession.socket = new QUdpSocket(this);
+    newSession.socket->bind(QHostAddress::Any, 0);
+    newSession.lastActive = _clock.elapsed();
+    QUdpSocket *socket = newSession.socket;
+    connect(socket, &QUdpSocket::readyRead, this, [this, socket, client]()
+    {
+        targetReadyRead(socket, client);
+    });
+    return _sessions.insert(key, newSession).value();
+}
+
+void UdpForwarder::listenReadyRead()
+{
+    char buffer[MAX_DATAGRAM_SIZE];
+    while (_socket->hasPendingDatagrams())
+    {
+        SocketAddress client;
+        qint64 size = _socket->readDatagram(buffer, sizeof(buffer), &client.host, &client.port);
+        if (size < 0) continue;
+
+        Session& session = sessionFor(client);
+        session.lastActive = _clock.elapsed();
+        QPointer<QUdpSocket> socket = session.socket;
+        QByteArray datagram(buffer, (int)size);
+        SocketAddress target = _target;
+        _toTarget->send((int)size, [socket, datagram, target]()
+        {
+            if (socket) socket->writeDatagram(datagram, target.host, target.port);
+        });
+    }
+}
+
+void UdpForwarder::targetReadyRead(QUdpSocket *socket, SocketAddress client)
+{
+    char buffer[MAX_DATAGRAM_SIZE];
+    QHash<QString, Session>::iterator session = _sessions.find(client.toString());
+    if (session != _sessions.end())
+    {
+        session->lastActive = _clock.elapsed();
+    }
+    while (socket->hasPendingDatagrams())
+    {
+        qint64 size = socket->readDatagram(buffer, sizeof(buffer));
+        if (size < 0) continue;
+
+        QPointer<QUdpSocket> listenSocket = _socket;
+        QByteArray datagram(buffer, (int)size);
+        _fromTarget->send((int)size, [listenSocket, datagram, client]()
+        {
+            if (listenSocket) listenSocket->writeDatagram(datagram, client.host, client.port);
+        });
+    }
+}
+
+void UdpForwarder::timerEvent(QTimerEvent *e)
+{
+    QObject::timerEvent(e);
+    if (e->timerId() == _cleanupTimerId)
+    {
+        qint64 now = _clock.elapsed();
+        QHash<QString, Session>::iterator session = _sessions.begin();
+        while (session != _sessions.end())
+        {
+            if (now - session->lastActive > SESSION_TIMEOUT)
+            {
+                LOG_I(LOG_TAG, "Client " + session.key() + " went quiet, forgetting it");
+                // Packets still crossing the link hold a QPointer to the socket
+                session->socket->deleteLater();
+                session = _sessions.erase(session);
+            }
+            else
+            {
+                session++;
+            }
+        }
+    }
+}
+
+} // namespace Soro
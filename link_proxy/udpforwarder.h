@@ -0,0 +1,58 @@
+#ifndef SORO_UDPFORWARDER_H
+#define SORO_UDPFORWARDER_H
+
+#include <QtCore>
+#include <QUdpSocket>
+
+#include "soro_core/socketaddress.h"
+#include "soro_core/constants.h"
+#include "linkemulator.h"
+
+namespace Soro {
+
+/* Forwards datagrams between clients of a UDP port and a target, through a pair of link emulators.
+ *
+ * Each client gets its own socket toward the target, so replies (and media streams, which are
+ * sent back to wherever the handshake came from) find their way back to the right client.
+ * Clients that go quiet for a while are forgotten.
+ */
+class UdpForwarder: public QObject {
+    Q_OBJECT
+public:
+    UdpForwarder(SocketAddress listen, SocketAddress target, LinkEmulator *toTarget, LinkEmulator *fromTarget, QObject *parent=nullptr);
+
+    bool isListening() const;
+    QString getDescription() const;
+
+protected:
+    void timerEvent(QTimerEvent *e);
+
+private:
+    struct Session
+    {
+        SocketAddress client;
+        QUdpSocket *socket;
+        qint64 lastActive;
+    };
+
+    QString LOG_TAG;
+    SocketAddress _listen;
+    SocketAddress _target;
+    LinkEmulator *_toTarget;
+    LinkEmulator *_fromTarget;
+    QUdpSocket *_socket;
+    bool _listening;
+    QHash<QString, Session> _sessions;
+    QElapsedTimer _clock;
+    int _cleanupTimerId = TIMER_INACTIVE;
+
+    Session& sessionFor(const SocketAddress& client);
+    void targetReadyRead(QUdpSocket *socket, SocketAddress client);
+
+private Q_SLOTS:
+    void listenReadyRead();
+};
+
+} // namespace Soro
+
+#endif // SORO_UDPFORWARDER_H
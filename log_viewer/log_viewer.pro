@@ -0,0 +1,32 @@
+QT += core gui widgets
+
+CONFIG += c++11 no_keywords
+CONFIG -= app_bundle
+TARGET = log_viewer
+TEMPLATE = app
+
+BUILD_DIR = ../build/log_viewer
+DESTDIR = ../bin
+OBJECTS_DIR = $$BUILD_DIR
+MOC_DIR = $$BUILD_DIR
+RCC_DIR = $$BUILD_DIR
+UI_DIR = $$BUILD_DIR
+PRECOMPILED_DIR = $$BUILD_DIR
+
+HEADERS += \
+    logfile.h \
+    logsession.h \
+    logtablemodel.h \
+    logviewerwindow.h
+
+SOURCES += \
+    main.cpp \
+    logfile.cpp \
+    logsession.cpp \
+    logtablemodel.cpp \
+    logviewerwindow.cpp
+
+# Include headers from other subprojects
+INCLUDEPATH += $$PWD/..
+
+LIBS += -L../lib -lsoro_core
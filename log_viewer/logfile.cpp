@@ -0,0 +1,389 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "logfile.h"
+
+#include <algorithm>
+#include <cstring>
+
+//records in each block of the index
+#define BLOCK_RECORDS 512
+#define DAY_MSECS (24 * 60 * 60 * 1000)
+//a time this far before the one logged before it has wrapped past midnight
+#define DAY_WRAP_MSECS (12 * 60 * 60 * 1000)
+//a first line this far before the time in the file name was logged the day after it
+#define START_SLACK_MSECS (60 * 60 * 1000)
+
+namespace Soro {
+
+static const char CLOCK_OFFSET_PREFIX[] = "Rover clock offset ";
+
+/* Programs running on the rover, by the name they give their logs
+ */
+static const char *ROVER_LOG_PREFIXES[] = { "ResearchRover_", "Video_", "Audio_" };
+
+static bool looksLikeHeader(const char *p, const char *end)
+{
+    return (end - p >= 4) && (p[0] == '[') && (p[2] == ']') && (p[3] == '\t');
+}
+
+/* Parses hh:mm:ss or hh:mm:ss.zzz, or returns -1
+ */
+static int parseTimeOfDay(const char *p, const char *end)
+{
+    if (end - p < 8) return -1;
+    int fields[3];
+    for (int i = 0; i < 3; i++)
+    {
+        const char *field = p + i * 3;
+        if ((field[0] < '0') || (field[0] > '9') || (field[1] < '0') || (field[1] > '9')) return -1;
+        if ((i < 2) && (field[2] != ':')) return -1;
+        fields[i] = (field[0] - '0') * 10 + (field[1] - '0');
+    }
+    int msecs = 0;
+    if ((end - p >= 12) && (p[8] == '.'))
+    {
+        for (int i = 9; i < 12; i++)
+        {
+            if ((p[i] < '0') || (p[i] > '9')) return -1;
+            msecs = msecs * 10 + (p[i] - '0');
+        }
+    }
+    return ((fields[0] * 60 + fields[1]) * 60 + fields[2]) * 1000 + msecs;
+}
+
+static int levelBit(char level)
+{
+    switch (level)
+    {
+    case 'E': return LogFile::ErrorLevel;
+    case 'W': return LogFile::WarningLevel;
+    case 'D': return LogFile::DebugLevel;
+    default: return LogFile::InformationLevel;
+    }
+}
+
+LogFile::LogFile(QString path) : _path(path) { }
+
+LogFile::~LogFile()
+{
+    if (_data)
+    {
+        _file.unmap(reinterpret_cast<uchar*>(const_cast<char*>(_data)));
+    }
+}
+
+bool LogFile::open()
+{
+    _file.setFileName(_path);
+    if (!_file.open(QIODevice::ReadOnly))
+    {
+        _error = _file.errorString();
+        return false;
+    }
+    _size = _file.size();
+    if (_size > 0)
+    {
+        _data = reinterpret_cast<const char*>(_file.map(0, _size));
+        if (!_data)
+        {
+            _error = "Cannot map file: " + _file.errorString();
+            return false;
+        }
+    }
+    // Logs are named like ResearchRover_7-31_2.05.33_PM.log, the name has everything but the year
+    QFileInfo info(_path);
+    QDate date = info.lastModified().date();
+    static const QRegularExpression pattern("_(\\d+-\\d+_\\d+\\.\\d+(\\.\\d+)?_[AP]M)\\.log");
+    QRegularExpressionMatch match = pattern.match(info.fileName());
+    if (match.hasMatch())
+    {
+        QDateTime started = QDateTime::fromString(match.captured(1), match.captured(2).isEmpty() ? "M-dd_h.mm_AP" : "M-dd_h.mm.ss_AP");
+        if (started.isValid())
+        {
+            date = QDate(date.year(), started.date().month(), started.date().day());
+            // A log started in December and last written in January
+            if (date > info.lastModified().date()) date = date.addYears(-1);
+            _nameTimeOfDay = started.time().msecsSinceStartOfDay();
+        }
+    }
+    _baseTime = QDateTime(date, QTime(0, 0)).toMSecsSinceEpoch();
+    return true;
+}
+
+void LogFile::buildIndex()
+{
+    int day = 0;
+    int lastTimeOfDay = -1;
+    qint64 offset = 0;
+    Header header;
+    int prefixLength = sizeof(CLOCK_OFFSET_PREFIX) - 1;
+    while (nextRecord(_data + offset, &header))
+    {
+        if (_recordCount % BLOCK_RECORDS == 0)
+        {
+            Block block;
+            block.offset = offset;
+            block.day = day;
+            block.lastTimeOfDay = lastTimeOfDay;
+            block.levels = 0;
+            block.tags = 0;
+            _blocks.append(block);
+        }
+        qint64 time = advanceTime(header.timeOfDay, &day, &lastTimeOfDay);
+        Block& block = _blocks.last();
+        // A clock changed while logging can put times out of order
+        block.firstTime = _recordCount % BLOCK_RECORDS == 0 ? time : qMin(block.firstTime, time);
+        block.lastTime = _recordCount % BLOCK_RECORDS == 0 ? time : qMax(block.lastTime, time);
+        block.levels |= header.level;
+
+        QByteArray tag(header.tag, header.tagLength);
+        auto id = _tagIds.constFind(tag);
+        if (id == _tagIds.constEnd())
+        {
+            id = _tagIds.insert(tag, _tagIds.size());
+        }
+        block.tags |= tagBit(id.value());
+
+        if ((header.end - header.message > prefixLength) && (memcmp(header.message, CLOCK_OFFSET_PREFIX, prefixLength) == 0))
+        {
+            const char *number = header.message + prefixLength;
+            const char *numberEnd = number;
+            while ((numberEnd < header.end) && (*numberEnd != 'm')) numberEnd++;
+            bool ok;
+            qint64 clockOffset = QByteArray(number, numberEnd - number).toLongLong(&ok);
+            if (ok) _clockOffsets << clockOffset;
+        }
+
+        _startTime = _recordCount == 0 ? time : qMin(_startTime, time);
+        _endTime = _recordCount == 0 ? time : qMax(_endTime, time);
+        _recordCount++;
+        offset = header.end - _data;
+    }
+}
+
+bool LogFile::nextRecord(const char *p, Header *header) const
+{
+    const char *end = _data + _size;
+    if (!_data || (p >= end)) return false;
+
+    header->begin = p;
+    header->level = InformationLevel;
+    header->timeOfDay = -1;
+    header->tag = p;
+    header->tagLength = 0;
+    header->message = p;
+
+    const char *newline = reinterpret_cast<const char*>(memchr(p, '\n', end - p));
+    const char *lineEnd = newline ? newline : end;
+    if (looksLikeHeader(p, lineEnd))
+    {
+        // [L]<tab>time<tab>tag:<tab>message
+        header->level = levelBit(p[1]);
+        const char *time = p + 4;
+        const char *tab = reinterpret_cast<const char*>(memchr(time, '\t', lineEnd - time));
+        if (tab)
+        {
+            header->timeOfDay = parseTimeOfDay(time, tab);
+            header->tag = tab + 1;
+            const char *q = header->tag;
+            while ((q + 1 < lineEnd) && !((q[0] == ':') && (q[1] == '\t'))) q++;
+            if (q + 1 < lineEnd)
+            {
+                header->tagLength = q - header->tag;
+                header->message = q + 2;
+            }
+            else
+            {
+                header->tagLength = lineEnd - header->tag;
+                header->message = lineEnd;
+            }
+        }
+        else
+        {
+            header->message = time;
+        }
+    }
+
+    // Messages with newlines in them carry on until the next line that starts a record
+    const char *next = newline ? newline + 1 : end;
+    while ((next < end) && !looksLikeHeader(next, end))
+    {
+        newline = reinterpret_cast<const char*>(memchr(next, '\n', end - next));
+        next = newline ? newline + 1 : end;
+    }
+    header->end = next;
+    return true;
+}
+
+qint64 LogFile::advanceTime(int timeOfDay, int *day, int *lastTimeOfDay) const
+{
+    if (timeOfDay >= 0)
+    {
+        if ((*lastTimeOfDay < 0) && (_nameTimeOfDay >= 0) && (timeOfDay < _nameTimeOfDay - START_SLACK_MSECS))
+        {
+            *day = 1;
+        }
+        else if ((*lastTimeOfDay >= 0) && (timeOfDay < *lastTimeOfDay - DAY_WRAP_MSECS))
+        {
+            (*day)++;
+        }
+        *lastTimeOfDay = timeOfDay;
+    }
+    // Lines without a time are put with the last line that had one
+    return _baseTime + (qint64)*day * DAY_MSECS + qMax(*lastTimeOfDay, 0);
+}
+
+quint64 LogFile::tagBit(int id)
+{
+    return Q_UINT64_C(1) << (id & 63);
+}
+
+void LogFile::query(const LogFilter& filter, int fileIndex, QVector<LogLineRef> *lines) const
+{
+    // Filter times are on the common timeline, this log's are on its own clock
+    qint64 from = filter.from == LLONG_MIN ? LLONG_MIN : filter.from + _clockOffset;
+    qint64 to = filter.to == LLONG_MAX ? LLONG_MAX : filter.to + _clockOffset;
+
+    QSet<int> tagIds;
+    quint64 tagMask = ~Q_UINT64_C(0);
+    if (!filter.tags.isEmpty())
+    {
+        tagMask = 0;
+        for (const QString& tag : filter.tags)
+        {
+            int id = _tagIds.value(tag.toUtf8(), -1);
+            if (id < 0) continue;
+            tagIds.insert(id);
+            tagMask |= tagBit(id);
+        }
+        if (tagIds.isEmpty()) return;
+    }
+    QByteArrayMatcher matcher(filter.text);
+
+    for (int i = 0; i < _blocks.size(); i++)
+    {
+        const Block& block = _blocks[i];
+        if (!(block.levels & filter.levels) || !(block.tags & tagMask)
+                || (block.lastTime < from) || (block.firstTime > to)) continue;
+
+        const char *end = _data + (i + 1 < _blocks.size() ? _blocks[i + 1].offset : _size);
+        const char *p = _data + block.offset;
+        int day = block.day;
+        int lastTimeOfDay = block.lastTimeOfDay;
+        Header header;
+        while ((p < end) && nextRecord(p, &header))
+        {
+            p = header.end;
+            qint64 time = advanceTime(header.timeOfDay, &day, &lastTimeOfDay);
+            if (!(header.level & filter.levels) || (time < from) || (time > to)) continue;
+            if (!tagIds.isEmpty() && !tagIds.contains(_tagIds.value(QByteArray::fromRawData(header.tag, header.tagLength), -1))) continue;
+            if (!filter.text.isEmpty() && (matcher.indexIn(header.begin, header.end - header.begin) < 0)) continue;
+
+            LogLineRef line;
+            line.time = time - _clockOffset;
+            line.offset = header.begin - _data;
+            line.file = fileIndex;
+            lines->append(line);
+        }
+    }
+}
+
+LogRecord LogFile::recordAt(qint64 offset) const
+{
+    LogRecord record;
+    record.level = ' ';
+    Header header;
+    if (!nextRecord(_data + offset, &header)) return record;
+    if (looksLikeHeader(header.begin, header.end)) record.level = header.begin[1];
+    record.tag = QString::fromUtf8(header.tag, header.tagLength);
+    const char *end = header.end;
+    while ((end > header.message) && ((end[-1] == '\n') || (end[-1] == '\r'))) end--;
+    record.message = QString::fromUtf8(header.message, end - header.message);
+    return record;
+}
+
+QString LogFile::getPath() const
+{
+    return _path;
+}
+
+QString LogFile::getName() const
+{
+    return QFileInfo(_path).fileName();
+}
+
+QString LogFile::getError() const
+{
+    return _error;
+}
+
+qint64 LogFile::getSize() const
+{
+    return _size;
+}
+
+qint64 LogFile::getRecordCount() const
+{
+    return _recordCount;
+}
+
+QStringList LogFile::getTags() const
+{
+    QStringList tags;
+    for (auto i = _tagIds.constBegin(); i != _tagIds.constEnd(); i++)
+    {
+        if (!i.key().isEmpty()) tags << QString::fromUtf8(i.key());
+    }
+    return tags;
+}
+
+bool LogFile::isRoverLog() const
+{
+    QString name = getName();
+    for (const char *prefix : ROVER_LOG_PREFIXES)
+    {
+        if (name.startsWith(prefix)) return true;
+    }
+    return false;
+}
+
+qint64 LogFile::getStartTime() const
+{
+    return _startTime - _clockOffset;
+}
+
+qint64 LogFile::getEndTime() const
+{
+    return _endTime - _clockOffset;
+}
+
+QList<qint64> LogFile::getClockOffsets() const
+{
+    return _clockOffsets;
+}
+
+void LogFile::setClockOffset(qint64 offset)
+{
+    _clockOffset = offset;
+}
+
+qint64 LogFile::getClockOffset() const
+{
+    return _clockOffset;
+}
+
+} // namespace Soro
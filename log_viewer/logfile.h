@@ -0,0 +1,152 @@
+#ifndef SORO_LOGFILE_H
+#define SORO_LOGFILE_H
+
+#include <QtCore>
+#include <climits>
+
+namespace Soro {
+
+/* A line in a set of logs, by the time it was logged on the common timeline and where it is
+ */
+struct LogLineRef
+{
+    qint64 time;
+    qint64 offset;
+    int file;
+};
+
+/* One record from a log, with any lines after it that didn't start a record of their own
+ */
+struct LogRecord
+{
+    char level;
+    QString tag;
+    QString message;
+};
+
+/* What to show. Times are on the common timeline, in milliseconds since the epoch.
+ */
+struct LogFilter
+{
+    /* Mask of LogFile::Level values
+     */
+    int levels = 0xF;
+    /* Only these tags, or every tag if empty
+     */
+    QStringList tags;
+    qint64 from = LLONG_MIN;
+    qint64 to = LLONG_MAX;
+    /* Only records containing this, case sensitive, or every record if empty
+     */
+    QByteArray text;
+};
+
+/* A log file written by Logger, memory mapped and indexed so it can be filtered without
+ * reading all of it again.
+ *
+ * The index is sparse, one block for every BLOCK_RECORDS records, with the block's offset, time
+ * range, the levels in it and a bloom filter of its tags. A filter only reads the blocks that
+ * could have something it wants.
+ *
+ * Log lines only have a time of day, so the date comes from the file name (as every program
+ * names its log after when it started), and a time more than twelve hours before the last one
+ * is taken to be the next day.
+ */
+class LogFile {
+public:
+    enum Level {
+        ErrorLevel = 0x1,
+        WarningLevel = 0x2,
+        InformationLevel = 0x4,
+        DebugLevel = 0x8
+    };
+
+    explicit LogFile(QString path);
+    ~LogFile();
+
+    bool open();
+    /* Reads the whole file to build its index. Can be called from any thread.
+     */
+    void buildIndex();
+
+    QString getPath() const;
+    QString getName() const;
+    QString getError() const;
+    qint64 getSize() const;
+    qint64 getRecordCount() const;
+    QStringList getTags() const;
+
+    /* True if the log was written on the rover, by the rover or one of its streamers
+     */
+    bool isRoverLog() const;
+
+    /* Gets the first and last times in the log, on the common timeline
+     */
+    qint64 getStartTime() const;
+    qint64 getEndTime() const;
+
+    /* Gets every rover clock offset mission control measured and logged in this file
+     */
+    QList<qint64> getClockOffsets() const;
+
+    /* Sets how far this log's clock is ahead of the common timeline
+     */
+    void setClockOffset(qint64 offset);
+    qint64 getClockOffset() const;
+
+    /* Adds every record that passes a filter, in the order they were logged
+     */
+    void query(const LogFilter& filter, int fileIndex, QVector<LogLineRef> *lines) const;
+
+    LogRecord recordAt(qint64 offset) const;
+
+private:
+    struct Block
+    {
+        qint64 offset;
+        qint64 firstTime;
+        qint64 lastTime;
+        int day;
+        int lastTimeOfDay;
+        quint8 levels;
+        quint64 tags;
+    };
+
+    /* Where one record is, and what its header says
+     */
+    struct Header
+    {
+        const char *begin;
+        const char *end;
+        int level;
+        int timeOfDay;
+        const char *tag;
+        int tagLength;
+        const char *message;
+    };
+
+    QString _path;
+    QString _error;
+    QFile _file;
+    const char *_data = nullptr;
+    qint64 _size = 0;
+    qint64 _baseTime = 0;
+    qint64 _clockOffset = 0;
+    qint64 _recordCount = 0;
+    qint64 _startTime = 0;
+    qint64 _endTime = 0;
+    QVector<Block> _blocks;
+    QHash<QByteArray, int> _tagIds;
+    QList<qint64> _clockOffsets;
+    /* Time of day the file name says the log was started at, or -1
+     */
+    int _nameTimeOfDay = -1;
+
+    bool nextRecord(const char *p, Header *header) const;
+    qint64 advanceTime(int timeOfDay, int *day, int *lastTimeOfDay) const;
+    static quint64 tagBit(int id);
+};
+
+} // namespace Soro
+
+#endif // SORO_LOGFILE_H
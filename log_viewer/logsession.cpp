@@ -0,0 +1,248 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "logsession.h"
+#include "soro_core/logger.h"
+
+#include <algorithm>
+
+#define LOG_TAG "LogSession"
+
+namespace Soro {
+
+LogSession::LogSession(Executor *executor) : _executor(executor) { }
+
+LogSession::~LogSession()
+{
+    qDeleteAll(_files);
+}
+
+void LogSession::addPath(QString path)
+{
+    if (!QFileInfo(path).isDir())
+    {
+        _paths << path;
+        return;
+    }
+    QDirIterator it(path, QStringList() << "*.log", QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+    {
+        _paths << it.next();
+    }
+}
+
+bool LogSession::load()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    _paths.sort();
+    _paths.removeDuplicates();
+    for (const QString& path : _paths)
+    {
+        LogFile *file = new LogFile(path);
+        if (!file->open())
+        {
+            LOG_W(LOG_TAG, path + ": " + file->getError() + ", skipping it");
+            delete file;
+            continue;
+        }
+        _bytesIndexed += file->getSize();
+        _files << file;
+    }
+    if (_files.isEmpty())
+    {
+        _error = _paths.isEmpty() ? "No logs found" : "None of the logs could be read";
+        return false;
+    }
+
+    QVector<Executor::Task> tasks;
+    for (LogFile *file : _files)
+    {
+        tasks << [file]() { file->buildIndex(); };
+    }
+    runAll(tasks);
+
+    if (!_roverClockOffsetSet)
+    {
+        QList<qint64> offsets;
+        for (const LogFile *file : _files)
+        {
+            if (!file->isRoverLog()) offsets.append(file->getClockOffsets());
+        }
+        if (!offsets.isEmpty())
+        {
+            // The median, so one measurement over a slow round trip doesn't throw the rest off
+            std::sort(offsets.begin(), offsets.end());
+            _roverClockOffset = offsets[offsets.size() / 2];
+            _hasRoverClockOffset = true;
+        }
+    }
+    bool hasRoverLogs = false;
+    for (LogFile *file : _files)
+    {
+        if (!file->isRoverLog()) continue;
+        hasRoverLogs = true;
+        file->setClockOffset(_roverClockOffset);
+    }
+    if (hasRoverLogs && !_hasRoverClockOffset)
+    {
+        LOG_W(LOG_TAG, "No rover clock offset in the mission control logs, rover logs are shown on their own clock");
+    }
+
+    _elapsed = timer.elapsed();
+    return true;
+}
+
+void LogSession::runAll(const QVector<Executor::Task>& tasks) const
+{
+    QSemaphore done;
+    for (const Executor::Task& task : tasks)
+    {
+        _executor->post([&done, task]()
+        {
+            task();
+            done.release();
+        });
+    }
+    done.acquire(tasks.size());
+}
+
+QString LogSession::getError() const
+{
+    return _error;
+}
+
+void LogSession::setRoverClockOffset(qint64 offset)
+{
+    _roverClockOffset = offset;
+    _roverClockOffsetSet = true;
+    _hasRoverClockOffset = true;
+}
+
+bool LogSession::hasRoverClockOffset() const
+{
+    return _hasRoverClockOffset;
+}
+
+qint64 LogSession::getRoverClockOffset() const
+{
+    return _roverClockOffset;
+}
+
+int LogSession::getFileCount() const
+{
+    return _files.size();
+}
+
+const LogFile* LogSession::getFile(int index) const
+{
+    return _files[index];
+}
+
+qint64 LogSession::getRecordCount() const
+{
+    qint64 count = 0;
+    for (const LogFile *file : _files)
+    {
+        count += file->getRecordCount();
+    }
+    return count;
+}
+
+QStringList LogSession::getTags() const
+{
+    QSet<QString> tags;
+    for (const LogFile *file : _files)
+    {
+        for (const QString& tag : file->getTags())
+        {
+            tags.insert(tag);
+        }
+    }
+    QStringList sorted = tags.toList();
+    sorted.sort(Qt::CaseInsensitive);
+    return sorted;
+}
+
+qint64 LogSession::getStartTime() const
+{
+    qint64 start = LLONG_MAX;
+    for (const LogFile *file : _files)
+    {
+        if (file->getRecordCount() > 0) start = qMin(start, file->getStartTime());
+    }
+    return start == LLONG_MAX ? 0 : start;
+}
+
+qint64 LogSession::getEndTime() const
+{
+    qint64 end = LLONG_MIN;
+    for (const LogFile *file : _files)
+    {
+        if (file->getRecordCount() > 0) end = qMax(end, file->getEndTime());
+    }
+    return end == LLONG_MIN ? 0 : end;
+}
+
+QVector<LogLineRef> LogSession::query(const LogFilter& filter) const
+{
+    QVector<QVector<LogLineRef>> results(_files.size());
+    QVector<Executor::Task> tasks;
+    for (int i = 0; i < _files.size(); i++)
+    {
+        const LogFile *file = _files[i];
+        QVector<LogLineRef> *result = &results[i];
+        tasks << [file, filter, i, result]() { file->query(filter, i, result); };
+    }
+    runAll(tasks);
+
+    // Each file's records are already in order, so they are merged pairwise
+    QVector<LogLineRef> lines;
+    QVector<int> bounds;
+    bounds << 0;
+    for (const QVector<LogLineRef>& result : results)
+    {
+        lines += result;
+        bounds << lines.size();
+    }
+    auto earlier = [](const LogLineRef& a, const LogLineRef& b) { return a.time < b.time; };
+    while (bounds.size() > 2)
+    {
+        QVector<int> merged;
+        merged << 0;
+        for (int i = 0; i + 2 < bounds.size(); i += 2)
+        {
+            std::inplace_merge(lines.begin() + bounds[i], lines.begin() + bounds[i + 1], lines.begin() + bounds[i + 2], earlier);
+            merged << bounds[i + 2];
+        }
+        if ((bounds.size() - 1) % 2 == 1)
+        {
+            merged << bounds.last();
+        }
+        bounds = merged;
+    }
+    return lines;
+}
+
+QString LogSession::getStatistics() const
+{
+    return "Indexed " + QString::number(getRecordCount()) + " lines in " + QString::number(_files.size())
+            + " logs (" + QString::number(_bytesIndexed / (1024.0 * 1024.0), 'f', 1) + "MB) in "
+            + QString::number(_elapsed) + "ms";
+}
+
+} // namespace Soro
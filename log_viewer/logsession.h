@@ -0,0 +1,70 @@
+#ifndef SORO_LOGSESSION_H
+#define SORO_LOGSESSION_H
+
+#include <QtCore>
+
+#include "logfile.h"
+#include "soro_core/executor.h"
+
+namespace Soro {
+
+/* Logs from the rover and mission control put on one timeline, mission control's.
+ *
+ * Mission control logs the rover's clock offset each time it connects and each time a trial
+ * starts, and the median of those moves every rover log onto mission control's clock. Without
+ * one, rover logs are shown with the time they were written with.
+ *
+ * Files are indexed and filtered in parallel on the executor's workers.
+ */
+class LogSession {
+public:
+    explicit LogSession(Executor *executor);
+    ~LogSession();
+
+    /* Adds a log, or every log in a directory and its subdirectories
+     */
+    void addPath(QString path);
+
+    /* Opens and indexes every log that was added, returning false if none of them could be read
+     */
+    bool load();
+    QString getError() const;
+
+    /* Uses this offset for rover logs, in place of the one mission control recorded
+     */
+    void setRoverClockOffset(qint64 offset);
+    bool hasRoverClockOffset() const;
+    qint64 getRoverClockOffset() const;
+
+    int getFileCount() const;
+    const LogFile* getFile(int index) const;
+    qint64 getRecordCount() const;
+    QStringList getTags() const;
+    qint64 getStartTime() const;
+    qint64 getEndTime() const;
+
+    /* Gets every record that passes a filter, from every file, in time order
+     */
+    QVector<LogLineRef> query(const LogFilter& filter) const;
+
+    /* Gets how much was indexed and how long it took
+     */
+    QString getStatistics() const;
+
+private:
+    Executor *_executor;
+    QStringList _paths;
+    QList<LogFile*> _files;
+    QString _error;
+    bool _hasRoverClockOffset = false;
+    bool _roverClockOffsetSet = false;
+    qint64 _roverClockOffset = 0;
+    qint64 _bytesIndexed = 0;
+    qint64 _elapsed = 0;
+
+    void runAll(const QVector<Executor::Task>& tasks) const;
+};
+
+} // namespace Soro
+
+#endif // SORO_LOGSESSION_H
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "logtablemodel.h"
+
+#include <QColor>
+
+namespace Soro {
+
+LogTableModel::LogTableModel(const LogSession *session, QObject *parent) : QAbstractTableModel(parent)
+{
+    _session = session;
+}
+
+void LogTableModel::setLines(const QVector<LogLineRef>& lines)
+{
+    beginResetModel();
+    _lines = lines;
+    _cachedRow = -1;
+    endResetModel();
+}
+
+int LogTableModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : _lines.size();
+}
+
+int LogTableModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+const LogRecord& LogTableModel::recordAt(int row) const
+{
+    if (row != _cachedRow)
+    {
+        const LogLineRef& line = _lines[row];
+        _cachedRecord = _session->getFile(line.file)->recordAt(line.offset);
+        _cachedRow = row;
+    }
+    return _cachedRecord;
+}
+
+QVariant LogTableModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || (index.row() >= _lines.size())) return QVariant();
+    const LogLineRef& line = _lines[index.row()];
+
+    switch (role)
+    {
+    case Qt::DisplayRole:
+        switch (index.column())
+        {
+        case TimeColumn:
+            return QDateTime::fromMSecsSinceEpoch(line.time).toString("MM-dd hh:mm:ss.zzz");
+        case SourceColumn:
+            return _session->getFile(line.file)->getName();
+        case LevelColumn:
+            return QString(QChar(recordAt(index.row()).level));
+        case TagColumn:
+            return recordAt(index.row()).tag;
+        case MessageColumn:
+            return recordAt(index.row()).message;
+        }
+        break;
+    case Qt::ForegroundRole:
+        switch (recordAt(index.row()).level)
+        {
+        case 'E':
+            return QColor(Qt::red);
+        case 'W':
+            return QColor(Qt::darkYellow);
+        case 'D':
+            return QColor(Qt::gray);
+        }
+        break;
+    case Qt::ToolTipRole:
+        if (index.column() == SourceColumn) return _session->getFile(line.file)->getPath();
+        if (index.column() == MessageColumn) return recordAt(index.row()).message;
+        break;
+    }
+    return QVariant();
+}
+
+QVariant LogTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if ((orientation != Qt::Horizontal) || (role != Qt::DisplayRole)) return QVariant();
+    switch (section)
+    {
+    case TimeColumn:
+        return "Time";
+    case SourceColumn:
+        return "Source";
+    case LevelColumn:
+        return "Level";
+    case TagColumn:
+        return "Tag";
+    case MessageColumn:
+        return "Message";
+    }
+    return QVariant();
+}
+
+} // namespace Soro
@@ -0,0 +1,47 @@
+#ifndef SORO_LOGTABLEMODEL_H
+#define SORO_LOGTABLEMODEL_H
+
+#include <QAbstractTableModel>
+
+#include "logsession.h"
+
+namespace Soro {
+
+/* Shows the result of a query on a log session. Only the line references are held, and each
+ * row is read out of its mapped file when the view asks for it.
+ */
+class LogTableModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    enum Column {
+        TimeColumn = 0,
+        SourceColumn,
+        LevelColumn,
+        TagColumn,
+        MessageColumn,
+        ColumnCount
+    };
+
+    explicit LogTableModel(const LogSession *session, QObject *parent = nullptr);
+
+    void setLines(const QVector<LogLineRef>& lines);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    const LogSession *_session;
+    QVector<LogLineRef> _lines;
+    /* The view asks for every column of a row in turn, so the last record read is kept
+     */
+    mutable int _cachedRow = -1;
+    mutable LogRecord _cachedRecord;
+
+    const LogRecord& recordAt(int row) const;
+};
+
+} // namespace Soro
+
+#endif // SORO_LOGTABLEMODEL_H
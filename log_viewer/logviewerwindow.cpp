@@ -0,0 +1,166 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "logviewerwindow.h"
+
+#include <QHeaderView>
+#include <QStatusBar>
+#include <QToolBar>
+
+//Time to wait after the filter last changed before querying again
+#define QUERY_DELAY 150
+#define DATE_TIME_FORMAT "MM-dd hh:mm:ss.zzz"
+
+namespace Soro {
+
+LogViewerWindow::LogViewerWindow(const LogSession *session, QWidget *parent) : QMainWindow(parent)
+{
+    _session = session;
+    setWindowTitle("Log Viewer");
+    resize(1280, 800);
+
+    QToolBar *toolbar = addToolBar("Filter");
+    toolbar->setMovable(false);
+    const char *levelNames[] = { "Errors", "Warnings", "Info", "Debug" };
+    for (int i = 0; i < 4; i++)
+    {
+        _levelChecks[i] = new QCheckBox(levelNames[i], toolbar);
+        _levelChecks[i]->setChecked(true);
+        toolbar->addWidget(_levelChecks[i]);
+        connect(_levelChecks[i], &QCheckBox::toggled, this, &LogViewerWindow::scheduleQuery);
+    }
+    toolbar->addSeparator();
+
+    toolbar->addWidget(new QLabel("Tags ", toolbar));
+    _tagCombo = new QComboBox(toolbar);
+    _tagCombo->setEditable(true);
+    _tagCombo->setMinimumWidth(180);
+    _tagCombo->setToolTip("Tags to show, separated by commas, or empty for every tag");
+    _tagCombo->addItem("");
+    _tagCombo->addItems(_session->getTags());
+    toolbar->addWidget(_tagCombo);
+    connect(_tagCombo, &QComboBox::editTextChanged, this, &LogViewerWindow::scheduleQuery);
+    toolbar->addSeparator();
+
+    QDateTime start = QDateTime::fromMSecsSinceEpoch(_session->getStartTime());
+    QDateTime end = QDateTime::fromMSecsSinceEpoch(_session->getEndTime());
+    toolbar->addWidget(new QLabel("From ", toolbar));
+    _fromEdit = new QDateTimeEdit(start, toolbar);
+    _fromEdit->setDisplayFormat(DATE_TIME_FORMAT);
+    toolbar->addWidget(_fromEdit);
+    toolbar->addWidget(new QLabel(" to ", toolbar));
+    _toEdit = new QDateTimeEdit(end, toolbar);
+    _toEdit->setDisplayFormat(DATE_TIME_FORMAT);
+    toolbar->addWidget(_toEdit);
+    connect(_fromEdit, &QDateTimeEdit::dateTimeChanged, this, &LogViewerWindow::scheduleQuery);
+    connect(_toEdit, &QDateTimeEdit::dateTimeChanged, this, &LogViewerWindow::scheduleQuery);
+    toolbar->addSeparator();
+
+    _textEdit = new QLineEdit(toolbar);
+    _textEdit->setPlaceholderText("Containing...");
+    _textEdit->setClearButtonEnabled(true);
+    toolbar->addWidget(_textEdit);
+    connect(_textEdit, &QLineEdit::textChanged, this, &LogViewerWindow::scheduleQuery);
+
+    _model = new LogTableModel(_session, this);
+    _table = new QTableView(this);
+    _table->setModel(_model);
+    _table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    _table->setWordWrap(false);
+    _table->setAlternatingRowColors(true);
+    // Rows are all one height, so the view doesn't have to measure every one of them
+    _table->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    _table->verticalHeader()->setDefaultSectionSize(_table->fontMetrics().height() + 4);
+    _table->verticalHeader()->hide();
+    _table->horizontalHeader()->setStretchLastSection(true);
+    _table->setColumnWidth(LogTableModel::TimeColumn, 150);
+    _table->setColumnWidth(LogTableModel::SourceColumn, 260);
+    _table->setColumnWidth(LogTableModel::LevelColumn, 40);
+    _table->setColumnWidth(LogTableModel::TagColumn, 160);
+    setCentralWidget(_table);
+
+    _statusLabel = new QLabel(this);
+    statusBar()->addWidget(_statusLabel, 1);
+    statusBar()->addPermanentWidget(new QLabel(_session->getStatistics(), this));
+    if (_session->hasRoverClockOffset())
+    {
+        statusBar()->addPermanentWidget(new QLabel("Rover clock offset "
+                + QString::number(_session->getRoverClockOffset()) + "ms", this));
+    }
+
+    _queryTimer.setSingleShot(true);
+    _queryTimer.setInterval(QUERY_DELAY);
+    connect(&_queryTimer, &QTimer::timeout, this, &LogViewerWindow::runQuery);
+
+    runQuery();
+}
+
+void LogViewerWindow::setFilter(const LogFilter& filter)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        _levelChecks[i]->setChecked(filter.levels & (1 << i));
+    }
+    _tagCombo->setEditText(filter.tags.join(", "));
+    if (filter.from != LLONG_MIN)
+    {
+        _fromEdit->setDateTime(QDateTime::fromMSecsSinceEpoch(filter.from));
+    }
+    if (filter.to != LLONG_MAX)
+    {
+        _toEdit->setDateTime(QDateTime::fromMSecsSinceEpoch(filter.to));
+    }
+    _textEdit->setText(QString::fromUtf8(filter.text));
+}
+
+LogFilter LogViewerWindow::getFilter() const
+{
+    LogFilter filter;
+    filter.levels = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        if (_levelChecks[i]->isChecked()) filter.levels |= 1 << i;
+    }
+    for (const QString& tag : _tagCombo->currentText().split(',', QString::SkipEmptyParts))
+    {
+        if (!tag.trimmed().isEmpty()) filter.tags << tag.trimmed();
+    }
+    // Left at the ends of the session, the range stays open so the editors can't cut anything off
+    filter.from = _fromEdit->dateTime().toMSecsSinceEpoch();
+    filter.to = _toEdit->dateTime().toMSecsSinceEpoch();
+    if (filter.from <= _session->getStartTime()) filter.from = LLONG_MIN;
+    if (filter.to >= _session->getEndTime()) filter.to = LLONG_MAX;
+    filter.text = _textEdit->text().toUtf8();
+    return filter;
+}
+
+void LogViewerWindow::scheduleQuery()
+{
+    _queryTimer.start();
+}
+
+void LogViewerWindow::runQuery()
+{
+    QElapsedTimer timer;
+    timer.start();
+    QVector<LogLineRef> lines = _session->query(getFilter());
+    _model->setLines(lines);
+    _statusLabel->setText(QString::number(lines.size()) + " of " + QString::number(_session->getRecordCount())
+            + " records in " + QString::number(timer.elapsed()) + "ms");
+}
+
+} // namespace Soro
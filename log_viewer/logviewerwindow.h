@@ -0,0 +1,50 @@
+#ifndef SORO_LOGVIEWERWINDOW_H
+#define SORO_LOGVIEWERWINDOW_H
+
+#include <QMainWindow>
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDateTimeEdit>
+#include <QLabel>
+#include <QLineEdit>
+#include <QTableView>
+#include <QTimer>
+
+#include "logsession.h"
+#include "logtablemodel.h"
+
+namespace Soro {
+
+/* Window showing a log session as one table, with a toolbar to filter it. The query is run
+ * again a short time after the filter stops changing, instead of on every keystroke.
+ */
+class LogViewerWindow : public QMainWindow {
+    Q_OBJECT
+public:
+    explicit LogViewerWindow(const LogSession *session, QWidget *parent = nullptr);
+
+    /* Fills the toolbar from a filter, such as one given on the command line
+     */
+    void setFilter(const LogFilter& filter);
+    LogFilter getFilter() const;
+
+private Q_SLOTS:
+    void scheduleQuery();
+    void runQuery();
+
+private:
+    const LogSession *_session;
+    LogTableModel *_model;
+    QTableView *_table;
+    QCheckBox *_levelChecks[4];
+    QComboBox *_tagCombo;
+    QDateTimeEdit *_fromEdit;
+    QDateTimeEdit *_toEdit;
+    QLineEdit *_textEdit;
+    QLabel *_statusLabel;
+    QTimer _queryTimer;
+};
+
+} // namespace Soro
+
+#endif // SORO_LOGVIEWERWINDOW_H
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <QApplication>
+#include <QCommandLineParser>
+
+#include "logsession.h"
+#include "logviewerwindow.h"
+#include "soro_core/logger.h"
+
+#define LOG_TAG "LogViewer"
+
+using namespace Soro;
+
+/* Reads a time given on the command line, either a full ISO 8601 date and time or just a time of
+ * day on the day the session started
+ */
+static bool parseTime(QString value, qint64 sessionStart, qint64 *time)
+{
+    QDateTime dateTime = QDateTime::fromString(value, Qt::ISODate);
+    if (!dateTime.isValid())
+    {
+        for (const char *format : { "hh:mm:ss.zzz", "hh:mm:ss", "hh:mm" })
+        {
+            QTime timeOfDay = QTime::fromString(value, format);
+            if (timeOfDay.isValid())
+            {
+                dateTime = QDateTime(QDateTime::fromMSecsSinceEpoch(sessionStart).date(), timeOfDay);
+                break;
+            }
+        }
+    }
+    if (!dateTime.isValid()) return false;
+    *time = dateTime.toMSecsSinceEpoch();
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    // Printing doesn't need a display, so only start a GUI application when there is a window to show
+    bool print = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (qstrcmp(argv[i], "--print") == 0) print = true;
+    }
+    QScopedPointer<QCoreApplication> app(print ? new QCoreApplication(argc, argv) : new QApplication(argc, argv));
+    QCoreApplication::setApplicationName("log_viewer");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+            "Shows logs from the rover and mission control on one timeline, filtered by level, tag, time and text.\n\n"
+            "Rover logs are moved onto mission control's clock using the clock offset mission control logs "
+            "each time it connects to the rover.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("paths", "Logs to read, or directories to read every log in.", "paths...");
+    QCommandLineOption printOption("print", "Print the matching records instead of opening a window.");
+    QCommandLineOption levelOption("level", "Levels to show, as letters from EWID.", "levels", "EWID");
+    QCommandLineOption tagOption("tag", "Only show records with this tag. Can be given more than once.", "tag");
+    QCommandLineOption fromOption("from", "Only show records from this time on, either an ISO 8601 date and "
+                                  "time or a time of day on the day the logs start.", "time");
+    QCommandLineOption toOption("to", "Only show records up to this time.", "time");
+    QCommandLineOption grepOption("grep", "Only show records containing this text.", "text");
+    QCommandLineOption offsetOption("rover-offset", "How far the rover's clock is ahead of mission control's, "
+                                    "in place of the offset mission control logged.", "ms");
+    QCommandLineOption threadsOption("threads", "Number of threads to index with, 0 for one per core.", "count", "0");
+    parser.addOptions({ printOption, levelOption, tagOption, fromOption, toOption, grepOption, offsetOption, threadsOption });
+    parser.process(*app);
+
+    if (print)
+    {
+        Logger::rootLogger()->setMaxStdoutLevel(Logger::LogLevelWarning);
+    }
+    if (parser.positionalArguments().isEmpty())
+    {
+        parser.showHelp(2);
+    }
+
+    Executor::root()->setThreadCount(qMax(parser.value(threadsOption).toInt(), 0));
+    LogSession session(Executor::root());
+    for (const QString& path : parser.positionalArguments())
+    {
+        session.addPath(path);
+    }
+    if (parser.isSet(offsetOption))
+    {
+        bool ok;
+        qint64 offset = parser.value(offsetOption).toLongLong(&ok);
+        if (!ok)
+        {
+            LOG_E(LOG_TAG, "Invalid rover clock offset " + parser.value(offsetOption));
+            return 2;
+        }
+        session.setRoverClockOffset(offset);
+    }
+    if (!session.load())
+    {
+        LOG_E(LOG_TAG, session.getError());
+        return 1;
+    }
+
+    LogFilter filter;
+    filter.levels = 0;
+    const QString levels = parser.value(levelOption).toUpper();
+    const QString levelLetters = "EWID";
+    for (QChar level : levels)
+    {
+        int i = levelLetters.indexOf(level);
+        if (i < 0)
+        {
+            LOG_E(LOG_TAG, "Invalid level " + QString(level) + ", expected one of " + levelLetters);
+            return 2;
+        }
+        filter.levels |= 1 << i;
+    }
+    filter.tags = parser.values(tagOption);
+    if (parser.isSet(fromOption) && !parseTime(parser.value(fromOption), session.getStartTime(), &filter.from))
+    {
+        LOG_E(LOG_TAG, "Invalid time " + parser.value(fromOption));
+        return 2;
+    }
+    if (parser.isSet(toOption) && !parseTime(parser.value(toOption), session.getStartTime(), &filter.to))
+    {
+        LOG_E(LOG_TAG, "Invalid time " + parser.value(toOption));
+        return 2;
+    }
+    filter.text = parser.value(grepOption).toUtf8();
+
+    if (!print)
+    {
+        LogViewerWindow window(&session);
+        window.setFilter(filter);
+        window.show();
+        return app->exec();
+    }
+
+    QTextStream out(stdout);
+    for (const LogLineRef& line : session.query(filter))
+    {
+        const LogFile *file = session.getFile(line.file);
+        LogRecord record = file->recordAt(line.offset);
+        out << QDateTime::fromMSecsSinceEpoch(line.time).toString("yyyy-MM-dd hh:mm:ss.zzz") << " "
+            << file->getName() << " [" << record.level << "] " << record.tag << ": " << record.message << "\n";
+    }
+    out.flush();
+    return 0;
+}
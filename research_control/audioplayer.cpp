@@ -16,6 +16,7 @@
 
 #include "audioplayer.h"
 #include "soro_core/logger.h"
+#include "soro_core/tracer.h"
 
 #define LOG_TAG "AudioPlayer"
 
@@ -41,6 +42,7 @@ void AudioPlayer::resetPipeline()
 {
     if (_pipeline)
     {
+        TRACE_SPAN("gstreamer", "AudioPlayer stop pipeline");
         _pipeline->setState(QGst::StateNull);
         _pipeline.clear();
     }
@@ -49,6 +51,7 @@ void AudioPlayer::resetPipeline()
 void AudioPlayer::play(SocketAddress address, GStreamerUtil::AudioProfile profile)
 {
     resetPipeline();
+    TRACE_SPAN("gstreamer", "AudioPlayer start pipeline");
 
     _pipeline = QGst::Pipeline::create();
     _pipeline->bus()->addSignalWatch();
@@ -81,6 +84,7 @@ void AudioPlayer::onBusMessage(const QGst::MessagePtr & message)
         Q_EMIT eosMessage();
         break;
     case QGst::MessageError: {
+        TRACE_INSTANT("gstreamer", "AudioPlayer error");
         QString errorMessage = message.staticCast<QGst::ErrorMessage>()->error().message().toLatin1();
         LOG_E(LOG_TAG, "onBusMessage(): Received error message from gstreamer '" + errorMessage + "'");
         Q_EMIT error();
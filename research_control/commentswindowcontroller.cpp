@@ -11,19 +11,42 @@ namespace Soro {
 
 CommentsWindowController::CommentsWindowController(QQmlEngine *engine, QObject *parent) : QObject(parent)
 {
-    // Create UI for settings and control
-    QQmlComponent qmlComponent(engine, QUrl("qrc:/qml/CommentsWindow.qml"));
+    _engine = engine;
+    _connectionState = "connecting";
+    _recordingState = "idle";
+}
+
+void CommentsWindowController::create()
+{
+    LOG_I(LOG_TAG, "Creating comments window...");
+    QQmlComponent qmlComponent(_engine, QUrl("qrc:/qml/CommentsWindow.qml"));
     _window = qobject_cast<QQuickWindow*>(qmlComponent.create());
     if (!qmlComponent.errorString().isEmpty() || !_window)
     {
         MainController::panic(LOG_TAG, "Cannot create comments window QML: " + qmlComponent.errorString());
     }
 
-    _window->show();
-
     connect(_window, SIGNAL(recordButtonClicked()), this, SIGNAL(recordButtonClicked()));
     connect(_window, SIGNAL(logCommentEntered(QString)), this, SIGNAL(logCommentEntered(QString)));
-    connect(_window, SIGNAL(closed()), this, SIGNAL(closed()));
+    // Closing the comments window only hides it, the control and main windows own the app's lifetime
+    applyState();
+}
+
+void CommentsWindowController::applyState()
+{
+    _window->setProperty("connectionState", _connectionState);
+    _window->setProperty("recordingState", _recordingState);
+}
+
+void CommentsWindowController::show()
+{
+    if (!_window)
+    {
+        create();
+    }
+    _window->show();
+    _window->raise();
+    _window->requestActivate();
 }
 
 void CommentsWindowController::setConnectionState(Channel::State state)
@@ -31,15 +54,19 @@ void CommentsWindowController::setConnectionState(Channel::State state)
     switch (state)
     {
     case Channel::ErrorState:
-        _window->setProperty("connectionState", "error");
+        _connectionState = "error";
         break;
     case Channel::ConnectedState:
-        _window->setProperty("connectionState", "connected");
+        _connectionState = "connected";
         break;
     case Channel::ConnectingState:
-        _window->setProperty("connectionState", "connecting");
+        _connectionState = "connecting";
         break;
-    default: break;
+    default: return;
+    }
+    if (_window)
+    {
+        _window->setProperty("connectionState", _connectionState);
     }
 }
 
@@ -48,15 +75,24 @@ void CommentsWindowController::setRecordingState(RecordingState state)
     switch (state)
     {
     case RecordingState_Idle:
-        _window->setProperty("recordingState", "idle");
+        _recordingState = "idle";
         break;
     case RecordingState_Waiting:
-        _window->setProperty("recordingState", "waiting");
+        _recordingState = "waiting";
         break;
     case RecordingState_Recording:
-        _window->setProperty("recordingState", "recording");
+        _recordingState = "recording";
         break;
-    default: break;
+    default: return;
+    }
+    if (!_window && (state != RecordingState_Idle))
+    {
+        // Comments are taken during a recording, so have the window ready when one starts
+        show();
+    }
+    else if (_window)
+    {
+        _window->setProperty("recordingState", _recordingState);
     }
 }
 
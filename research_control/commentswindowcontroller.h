@@ -10,6 +10,9 @@
 
 namespace Soro {
 
+/* Controls the comments window, which is only created the first time it is shown
+ * (either by the user or when a recording starts) since most sessions never use it.
+ */
 class CommentsWindowController : public QObject
 {
     Q_OBJECT
@@ -19,14 +22,20 @@ public:
 Q_SIGNALS:
     void recordButtonClicked();
     void logCommentEntered(QString comment);
-    void closed();
 
 public Q_SLOTS:
     void setRecordingState(RecordingState state);
     void setConnectionState(Channel::State state);
+    void show();
 
 private:
+    void create();
+    void applyState();
+
+    QQmlEngine *_engine;
     QQuickWindow *_window = 0;
+    QString _connectionState;
+    QString _recordingState;
 };
 
 } // namespace Soro
@@ -28,6 +28,7 @@ ControlWindowController::ControlWindowController(QQmlEngine *engine, QObject *pa
     connect(_window, SIGNAL(requestUiSync()), this, SIGNAL(requestUiSync()));
     connect(_window, SIGNAL(closed()), this, SIGNAL(closed()));
     connect(_window, SIGNAL(zeroOrientationButtonClicked()), this, SIGNAL(zeroOrientationButtonClicked()));
+    connect(_window, SIGNAL(commentsButtonClicked()), this, SIGNAL(commentsButtonClicked()));
     connect(_window, SIGNAL(logCommentEntered(QString)), this, SIGNAL(logCommentEntered(QString)));
     connect(_window, SIGNAL(settingsApplied()), this, SIGNAL(settingsApplied()));
 
@@ -100,6 +101,16 @@ void ControlWindowController::ControlWindowController::updateGpsLocation(NmeaMes
                               Q_ARG(QVariant, msg.Longitude));
 }
 
+void ControlWindowController::updatePose(const PoseEstimate& pose)
+{
+    QMetaObject::invokeMethod(_window,
+                              "updatePose",
+                              Q_ARG(QVariant, pose.latitudeDegrees()),
+                              Q_ARG(QVariant, pose.longitudeDegrees()),
+                              Q_ARG(QVariant, pose.headingDegrees()),
+                              Q_ARG(QVariant, pose.accuracyMeters()));
+}
+
 void ControlWindowController::updateBitrate(int bpsUp, int bpsDown)
 {
     QMetaObject::invokeMethod(_window,
@@ -222,4 +233,78 @@ void ControlWindowController::onGamepadChanged(bool connected, QString name)
     }
 }
 
+QString ControlWindowController::formatCpu(quint32 cpu)
+{
+    return QString::number(cpu / 10.0, 'f', 1) + "%";
+}
+
+QString ControlWindowController::formatUsage(const ResourceUsage& usage)
+{
+    QString text = formatCpu(usage.cpu) + ", " + QString::number(usage.rss / 1024) + "MB, "
+            + QString::number(usage.fds) + " files, " + QString::number(usage.eventLoopLag) + "ms lag";
+    if (usage.allocationsPerSecond >= 0)
+    {
+        text += ", " + QString::number(usage.allocationsPerSecond) + " allocs/s";
+    }
+    return text;
+}
+
+void ControlWindowController::updateRoverResources(const ResourceUsage& usage)
+{
+    _window->setProperty("roverResources", formatUsage(usage));
+
+    QStringList streamers;
+    for (const ResourceUsage::Process& child : usage.children)
+    {
+        streamers.append(child.name + " " + formatCpu(child.cpu) + ", " + QString::number(child.rss / 1024) + "MB");
+    }
+    _window->setProperty("roverStreamerResources", streamers.isEmpty() ? "None" : streamers.join("\n"));
+
+    QStringList threads;
+    for (const ResourceUsage::Thread& thread : usage.threads)
+    {
+        // Idle threads would only push the busy ones out of view
+        if (thread.cpu == 0) continue;
+        threads.append(thread.name + " " + formatCpu(thread.cpu));
+    }
+    _window->setProperty("roverThreadResources", threads.isEmpty() ? "Idle" : threads.join("\n"));
+
+    QStringList channels;
+    for (const ResourceUsage::ChannelStats& channel : usage.channels)
+    {
+        QString text = channel.name + " " + QString::number(channel.depth) + " queued ("
+                + QString::number(channel.bytes / 1024) + "KB), " + QString::number(channel.conflated)
+                + " conflated, " + QString::number(channel.staleDropped + channel.overflowDropped) + " dropped";
+        if ((channel.reorderDepth > 0) || (channel.lateDropped > 0))
+        {
+            text += ", reordered " + QString::number(channel.reorderDepth) + " deep, "
+                    + QString::number(channel.lateDropped) + " late";
+        }
+        channels.append(text);
+    }
+    _window->setProperty("roverChannelResources", channels.isEmpty() ? "Unknown" : channels.join("\n"));
+}
+
+void ControlWindowController::updateControlResources(const ResourceUsage& usage)
+{
+    _window->setProperty("controlResources", formatUsage(usage));
+}
+
+void ControlWindowController::updateRoverGovernor(const VideoGovernorState& state)
+{
+    QString text = "Level " + QString::number(state.level);
+    if (state.level > 0)
+    {
+        text += " (" + QString::number(state.frameratePercent) + "% fps, "
+                + QString::number(state.resolutionPercent) + "% res, " + state.reason + ")";
+    }
+    if (state.temperature != VideoGovernorState::NoTemperature)
+    {
+        text += ", " + QString::number(state.temperature / 1000.0, 'f', 1) + "C of "
+                + QString::number(state.throttleTemperature / 1000.0, 'f', 0) + "C";
+    }
+    text += ", load " + QString::number(state.load / 10) + "%, " + QString::number(state.frameDeficit) + "% frames missed";
+    _window->setProperty("roverGovernor", text);
+}
+
 } // namespace Soro
@@ -10,6 +10,9 @@
 #include "soro_core/nmeamessage.h"
 #include "soro_core/channel.h"
 #include "soro_core/enums.h"
+#include "soro_core/resourcemonitor.h"
+#include "soro_core/videogovernor.h"
+#include "soro_core/poseestimator.h"
 
 namespace Soro {
 
@@ -27,12 +30,14 @@ Q_SIGNALS:
     void requestUiSync();
     void closed();
     void zeroOrientationButtonClicked();
+    void commentsButtonClicked();
     void logCommentEntered(QString comment);
     void settingsApplied();
 
 public Q_SLOTS:
     void onLatencyChanged(int ping);
     void updateGpsLocation(NmeaMessage msg);
+    void updatePose(const PoseEstimate& pose);
     void updateBitrate(int bpsUp, int bpsDown);
     void notify(NotificationType type, QString title, QString message);
     void clearGps();
@@ -41,11 +46,17 @@ public Q_SLOTS:
     void setConnectionState(Channel::State state);
     void onGamepadChanged(bool connected, QString name);
     void setDriveConnectionState(Channel::State state);
+    void updateRoverResources(const ResourceUsage& usage);
+    void updateControlResources(const ResourceUsage& usage);
+    void updateRoverGovernor(const VideoGovernorState& state);
 
 protected:
     void timerEvent(QTimerEvent *e);
 
 private:
+    static QString formatCpu(quint32 cpu);
+    static QString formatUsage(const ResourceUsage& usage);
+
     QQuickWindow *_window;
     int _updateLatencyTimerId;
     int _latency;
@@ -18,12 +18,13 @@
 #include "maincontroller.h"
 
 #include "soro_core/constants.h"
+#include "soro_core/tracer.h"
 
 #define LOG_TAG "DriveControlSystem"
 
 namespace Soro {
 
-DriveControlSystem::DriveControlSystem(const QHostAddress& roverAddress, QObject *parent) : QObject(parent)
+DriveControlSystem::DriveControlSystem(const QHostAddress& roverAddress, const QList<QHostAddress>& roverAltAddresses, QObject *parent) : QObject(parent)
 {
     _channel = Channel::createClient(this, SocketAddress(roverAddress, NETWORK_ALL_DRIVE_CHANNEL_PORT), CHANNEL_NAME_DRIVE,
                         Channel::UdpProtocol, QHostAddress::Any);
@@ -31,6 +32,27 @@ DriveControlSystem::DriveControlSystem(const QHostAddress& roverAddress, QObject
     {
         MainController::panic(LOG_TAG, "Could not open channel for drive control");
     }
+    for (const QHostAddress& altAddress : roverAltAddresses)
+    {
+        // Let routing pick the interface that reaches each rover address
+        _channel->addUdpPath(QHostAddress::Any, SocketAddress(altAddress, NETWORK_ALL_DRIVE_CHANNEL_PORT));
+    }
+    _channel->setUdpDuplicateMessages(true);
+    init();
+}
+
+DriveControlSystem::DriveControlSystem(QString localAddress, QObject *parent) : QObject(parent)
+{
+    _channel = Channel::createClient(this, localAddress, CHANNEL_NAME_DRIVE);
+    if (_channel->getState() == Channel::ErrorState)
+    {
+        MainController::panic(LOG_TAG, "Could not open channel for drive control");
+    }
+    init();
+}
+
+void DriveControlSystem::init()
+{
     _channel->open();
     _midSkidFactor = 0.2;
     _deadzone = 0.1;
@@ -81,6 +103,7 @@ void DriveControlSystem::timerEvent(QTimerEvent *e)
     QObject::timerEvent(e);
     if ((e->timerId() == _controlSendTimerId) && _channel && _gamepadConnected && _gamepadState)
     {
+        TRACE_SPAN("drive", "DriveControlSystem send");
         //send the rover a drive gamepad packet
         switch (_mode)
         {
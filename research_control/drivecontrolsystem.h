@@ -18,7 +18,15 @@ namespace Soro {
 class DriveControlSystem : public QObject {
     Q_OBJECT
 public:
-    explicit DriveControlSystem(const QHostAddress& roverAddress, QObject *parent = 0);
+    /* Drive commands are sent to roverAddress, and also duplicated to each of roverAltAddresses
+     * (other interfaces of the rover, such as a Wi-Fi link) when they are reachable
+     */
+    explicit DriveControlSystem(const QHostAddress& roverAddress, const QList<QHostAddress>& roverAltAddresses, QObject *parent = 0);
+
+    /* Drive commands are sent to a rover on the same host, through a local transport address
+     * (see ChannelTransport)
+     */
+    DriveControlSystem(QString localAddress, QObject *parent = 0);
 
     void enable();
     void disable();
@@ -57,6 +65,8 @@ private:
     int _controlSendTimerId = TIMER_INACTIVE;
     float _midSkidFactor; //The higher this is, the slower the middle wheels turn while skid steering
     char _buffer[256];
+
+    void init();
 };
 
 } // namespace Soro
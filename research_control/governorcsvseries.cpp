@@ -0,0 +1,54 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "governorcsvseries.h"
+
+namespace Soro {
+
+GovernorCsvSeries::GovernorCsvSeries(QObject *parent) : QObject(parent) { }
+
+const GovernorCsvSeries::LevelCsvSeries* GovernorCsvSeries::getLevelSeries() const
+{
+    return &_levelSeries;
+}
+
+const GovernorCsvSeries::TemperatureCsvSeries* GovernorCsvSeries::getTemperatureSeries() const
+{
+    return &_temperatureSeries;
+}
+
+const GovernorCsvSeries::LoadCsvSeries* GovernorCsvSeries::getLoadSeries() const
+{
+    return &_loadSeries;
+}
+
+const GovernorCsvSeries::FrameDeficitCsvSeries* GovernorCsvSeries::getFrameDeficitSeries() const
+{
+    return &_frameDeficitSeries;
+}
+
+void GovernorCsvSeries::update(const VideoGovernorState& state)
+{
+    _levelSeries.update(QVariant(state.level));
+    if (state.temperature != VideoGovernorState::NoTemperature)
+    {
+        _temperatureSeries.update(QVariant(state.temperature));
+    }
+    _loadSeries.update(QVariant(state.load));
+    _frameDeficitSeries.update(QVariant(state.frameDeficit));
+}
+
+} // namespace Soro
@@ -0,0 +1,54 @@
+#ifndef GOVERNORCSVSERIES_H
+#define GOVERNORCSVSERIES_H
+
+#include <QObject>
+
+#include "soro_core/csvrecorder.h"
+#include "soro_core/videogovernor.h"
+
+namespace Soro {
+
+/* Records what the rover's video governor is seeing and the level it has set. Temperature is in
+ * thousandths of a degree Celsius and load in thousandths of every core, as in VideoGovernorState.
+ */
+class GovernorCsvSeries : public QObject
+{
+    Q_OBJECT
+public:
+    explicit GovernorCsvSeries(QObject *parent = 0);
+
+    class LevelCsvSeries : public CsvDataSeries { friend class GovernorCsvSeries;
+    public: QString getSeriesName() const { return "Video Governor Level"; }
+            bool shouldKeepOldValues() const { return true; }
+    };
+    class TemperatureCsvSeries : public CsvDataSeries { friend class GovernorCsvSeries;
+    public: QString getSeriesName() const { return "Rover Temperature"; }
+            bool shouldKeepOldValues() const { return true; }
+    };
+    class LoadCsvSeries : public CsvDataSeries { friend class GovernorCsvSeries;
+    public: QString getSeriesName() const { return "Rover Load"; }
+            bool shouldKeepOldValues() const { return true; }
+    };
+    class FrameDeficitCsvSeries : public CsvDataSeries { friend class GovernorCsvSeries;
+    public: QString getSeriesName() const { return "Video Frame Deficit"; }
+            bool shouldKeepOldValues() const { return true; }
+    };
+
+    const LevelCsvSeries* getLevelSeries() const;
+    const TemperatureCsvSeries* getTemperatureSeries() const;
+    const LoadCsvSeries* getLoadSeries() const;
+    const FrameDeficitCsvSeries* getFrameDeficitSeries() const;
+
+public Q_SLOTS:
+    void update(const VideoGovernorState& state);
+
+private:
+    LevelCsvSeries _levelSeries;
+    TemperatureCsvSeries _temperatureSeries;
+    LoadCsvSeries _loadSeries;
+    FrameDeficitCsvSeries _frameDeficitSeries;
+};
+
+} // namespace Soro
+
+#endif // GOVERNORCSVSERIES_H
@@ -16,15 +16,25 @@
 
 #include "gstreamerrecorder.h"
 #include "soro_core/logger.h"
+#include "soro_core/tracer.h"
 
 #include <Qt5GStreamer/QGst/Bus>
 #include <Qt5GStreamer/QGlib/Connect>
+#include <climits>
 
 #define LOG_TAG "GStreamerRecorder" + _name
 
+//default memory budget for encoded video waiting to be written
+#define DEFAULT_QUEUE_BUDGET (64 * 1024 * 1024)
+//name of the queue in front of the file
+#define RECORD_QUEUE_NAME "recordqueue"
+//rate at which the queue's level is reported to its budget
+#define QUEUE_POLL_INTERVAL 1000
+
 namespace Soro {
 
-GStreamerRecorder::GStreamerRecorder(SocketAddress mediaAddress, QString name, QObject *parent) : QObject(parent)
+GStreamerRecorder::GStreamerRecorder(SocketAddress mediaAddress, QString name, QObject *parent) : QObject(parent),
+    _queueBudget(name.isEmpty() ? "video_recording" : "video_recording:" + name, DEFAULT_QUEUE_BUDGET, MemoryBudget::DropOldest)
 {
     _name = name;
     _mediaAddress = mediaAddress;
@@ -52,16 +62,28 @@ bool GStreamerRecorder::begin(quint8 codec, QDateTime startTime, bool vaapiEncod
                                                                  codec,
                                                                  filePath,
                                                                  true,
-                                                                 false);
+                                                                 false,
+                                                                 RECORD_QUEUE_NAME,
+                                                                 (quint32)qMin(_queueBudget.getCap(), (qint64)UINT_MAX));
 
     LOG_I(LOG_TAG, "Starting gstreamer recording with bin string " + binStr);
+    TRACE_SPAN("gstreamer", "GStreamerRecorder start pipeline");
     _pipeline = QGst::Pipeline::create();
     _pipeline->bus()->addSignalWatch();
     QGlib::connect(_pipeline->bus(), "message", this, &GStreamerRecorder::onBusMessage);
 
     _bin = QGst::Bin::fromDescription(binStr);
     _pipeline->add(_bin);
+
+    QGst::ElementPtr queue = _bin->getElementByName(RECORD_QUEUE_NAME);
+    if (!queue.isNull())
+    {
+        // Emitted from the streaming thread, which only touches the budget
+        QGlib::connect(queue, "overrun", this, &GStreamerRecorder::onQueueOverrun);
+        START_TIMER(_queuePollTimerId, QUEUE_POLL_INTERVAL);
+    }
     _pipeline->setState(QGst::StatePlaying);
+    return true;
 }
 
 void GStreamerRecorder::stop()
@@ -69,6 +91,9 @@ void GStreamerRecorder::stop()
     if (!_pipeline.isNull())
     {
         LOG_I(LOG_TAG, "Stopping recording");
+        TRACE_SPAN("gstreamer", "GStreamerRecorder stop pipeline");
+        KILL_TIMER(_queuePollTimerId);
+        _queueBudget.setUsage(0);
         _pipeline->bus()->removeSignalWatch();
         _pipeline->setState(QGst::StateNull);
         _pipeline.clear();
@@ -76,6 +101,24 @@ void GStreamerRecorder::stop()
     }
 }
 
+void GStreamerRecorder::timerEvent(QTimerEvent *e)
+{
+    if ((e->timerId() == _queuePollTimerId) && !_bin.isNull())
+    {
+        QGst::ElementPtr queue = _bin->getElementByName(RECORD_QUEUE_NAME);
+        if (!queue.isNull())
+        {
+            _queueBudget.setUsage(queue->property("current-level-bytes").get<quint32>());
+        }
+    }
+}
+
+void GStreamerRecorder::onQueueOverrun()
+{
+    // The queue drops the oldest buffers itself, how much it dropped isn't known
+    _queueBudget.overflowed(0);
+}
+
 void GStreamerRecorder::onBusMessage(const QGst::MessagePtr & message)
 {
     switch (message->type())
@@ -86,6 +129,7 @@ void GStreamerRecorder::onBusMessage(const QGst::MessagePtr & message)
         break;
     case QGst::MessageError:
     {
+        TRACE_INSTANT("gstreamer", "GStreamerRecorder error");
         QString errorMessage = message.staticCast<QGst::ErrorMessage>()->error().message().toLatin1();
         LOG_E(LOG_TAG, "onBusMessage(): Received error message from gstreamer '" + errorMessage + "'");
         stop();
@@ -6,6 +6,8 @@
 
 #include "soro_core/gstreamerutil.h"
 #include "soro_core/socketaddress.h"
+#include "soro_core/constants.h"
+#include "soro_core/memorybudget.h"
 
 #include <Qt5GStreamer/QGst/Pipeline>
 #include <Qt5GStreamer/QGst/Message>
@@ -13,6 +15,9 @@
 
 namespace Soro {
 
+/* Records the video stream to a file. Encoded video waiting to be written is held to the
+ * "video_recording" memory budget, past which the oldest video is dropped.
+ */
 class GStreamerRecorder : public QObject
 {
     Q_OBJECT
@@ -22,6 +27,9 @@ public:
     bool begin(quint8 codec, QDateTime startTime, bool vaapiEncode);
     void stop();
 
+protected:
+    void timerEvent(QTimerEvent *e);
+
 private Q_SLOTS:
     void onBusMessage(const QGst::MessagePtr & message);
 
@@ -30,7 +38,10 @@ private:
     QGst::BinPtr _bin;
     QString _name;
     SocketAddress _mediaAddress;
+    MemoryBudget _queueBudget;
+    int _queuePollTimerId = TIMER_INACTIVE;
 
+    void onQueueOverrun();
 };
 
 } // namespace Soro
@@ -17,9 +17,15 @@
 #include "hudlatencygraphimpl.h"
 #include "qmath.h"
 
+//default memory budget for the value history, the oldest values are dropped past it
+#define DEFAULT_HISTORY_BUDGET (64 * 1024)
+//bytes used by each value in the history
+#define HISTORY_ENTRY_SIZE ((qint64)sizeof(QMapNode<qint64, float>))
+
 namespace Soro {
 
-HudLatencyGraphImpl::HudLatencyGraphImpl(QQuickItem *parent) : QQuickPaintedItem(parent)
+HudLatencyGraphImpl::HudLatencyGraphImpl(QQuickItem *parent) : QQuickPaintedItem(parent),
+    _historyBudget("latency_history", DEFAULT_HISTORY_BUDGET, MemoryBudget::DropOldest)
 {
     _mode = "vertical";
     START_TIMER(_updateTimerId, 20);
@@ -70,7 +76,7 @@ void HudLatencyGraphImpl::setLatencyThreshold(int threshold)
 
 void HudLatencyGraphImpl::paint(QPainter *painter)
 {
-    qint64 now = QDateTime::currentDateTime().toMSecsSinceEpoch();
+    qint64 now = Clock::root()->msecsSinceEpoch();
 
     QMap<qint64, float>::const_iterator i = _history.constBegin();
 
@@ -89,7 +95,7 @@ void HudLatencyGraphImpl::paint(QPainter *painter)
                              blobSize);
 
         // Draw top blob
-        float endValue = nearestValue(QDateTime::currentDateTime().toMSecsSinceEpoch());
+        float endValue = nearestValue(Clock::root()->msecsSinceEpoch());
         int endBlobY = (height() / 2) + ((height() / 2 - blobSize / 2) * endValue);
         painter->setBrush(QBrush(Qt::white));
         painter->setPen(Qt::NoPen);
@@ -132,7 +138,7 @@ void HudLatencyGraphImpl::paint(QPainter *painter)
                              blobSize);
 
         // Draw top blob
-        float endValue = nearestValue(QDateTime::currentDateTime().toMSecsSinceEpoch());
+        float endValue = nearestValue(Clock::root()->msecsSinceEpoch());
         int endBlobX = (width() / 2) + ((width() / 2 - blobSize / 2) * endValue);
         painter->setBrush(QBrush(Qt::white));
         painter->setPen(Qt::NoPen);
@@ -196,7 +202,7 @@ void HudLatencyGraphImpl::timerEvent(QTimerEvent *e)
     if (e->timerId() == _updateTimerId)
     {
         // Prune value map
-        qint64 now = QDateTime::currentDateTime().toMSecsSinceEpoch();
+        qint64 now = Clock::root()->msecsSinceEpoch();
 
         // Remove values in the past
         QMap<qint64, float>::iterator i = _history.begin();
@@ -213,6 +219,13 @@ void HudLatencyGraphImpl::timerEvent(QTimerEvent *e)
         }
 
         _history.insert((now + _latency), _value);
+        _historyBudget.setUsage(_history.size() * HISTORY_ENTRY_SIZE);
+        while ((_history.size() > 1) && !_historyBudget.fits(0))
+        {
+            _history.erase(_history.begin());
+            _historyBudget.remove(HISTORY_ENTRY_SIZE);
+            _historyBudget.overflowed(HISTORY_ENTRY_SIZE);
+        }
         // Invalidate
         update();
     }
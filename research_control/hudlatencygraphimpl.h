@@ -9,6 +9,7 @@
 #include <QPainter>
 
 #include "soro_core/constants.h"
+#include "soro_core/memorybudget.h"
 
 namespace Soro {
 
@@ -44,6 +45,7 @@ private:
     float _value = 0;
     int _updateTimerId = TIMER_INACTIVE;
     QMap<qint64, float> _history;
+    MemoryBudget _historyBudget;
 
     void timerEvent(QTimerEvent *e);
     float nearestValue(qint64 time);
@@ -30,6 +30,11 @@ const LatencyCsvSeries::SimulatedLatencyCsvSeries* LatencyCsvSeries::getSimulate
     return &_simulatedLatencySeries;
 }
 
+const LatencyCsvSeries::MbedLatencyCsvSeries* LatencyCsvSeries::getMbedLatencySeries() const
+{
+    return &_mbedLatencySeries;
+}
+
 void LatencyCsvSeries::updateRealLatency(int latency)
 {
     _realLatencySeries.update(QVariant(latency));
@@ -40,4 +45,9 @@ void LatencyCsvSeries::updateSimulatedLatency(int latency)
     _simulatedLatencySeries.update(QVariant(latency));
 }
 
+void LatencyCsvSeries::updateMbedLatency(int latency)
+{
+    _mbedLatencySeries.update(QVariant(latency));
+}
+
 } // namespace Soro
@@ -24,17 +24,24 @@ public:
     public: QString getSeriesName() const { return "Simulated Latency"; }
             bool shouldKeepOldValues() const { return true; }
     };
+    class MbedLatencyCsvSeries : public CsvDataSeries { friend class LatencyCsvSeries;
+    public: QString getSeriesName() const { return "Mbed Latency"; }
+            bool shouldKeepOldValues() const { return true; }
+    };
 
     const RealLatencyCsvSeries* getRealLatencySeries() const;
     const SimulatedLatencyCsvSeries* getSimulatedLatencySeries() const;
+    const MbedLatencyCsvSeries* getMbedLatencySeries() const;
 
 public Q_SLOTS:
     void updateRealLatency(int latency);
     void updateSimulatedLatency(int latency);
+    void updateMbedLatency(int latency);
 
 private:
     RealLatencyCsvSeries _realLatencySeries;
     SimulatedLatencyCsvSeries _simulatedLatencySeries;
+    MbedLatencyCsvSeries _mbedLatencySeries;
 };
 
 } // namespace Soro
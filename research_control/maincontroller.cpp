@@ -17,7 +17,8 @@
 #include "maincontroller.h"
 #include "soro_core/logger.h"
 #include "soro_core/constants.h"
-#include "soro_core/confloader.h"
+#include "soro_core/tracer.h"
+#include "soro_core/memorybudget.h"
 
 #include "hudlatencygraphimpl.h"
 #include "hudpowerimpl.h"
@@ -35,6 +36,12 @@
 
 #define LOG_TAG "MainController"
 
+// Keys in research_control.conf starting with this are forwarded to the rover's research_rover.conf
+#define ROVER_CONFIG_PREFIX "rover."
+#define DEFAULT_DATA_RECORD_INTERVAL 50
+#define DEFAULT_RESOURCE_SAMPLE_INTERVAL 2000
+#define DEFAULT_EVENT_LOOP_STALL_THRESHOLD 100
+
 namespace Soro {
 
 MainController *MainController::_self = nullptr;
@@ -60,18 +67,18 @@ void MainController::init(QApplication *app)
     else
     {
         _self = new MainController(app);
+        _self->_launchTimer.start();
 
         // Use a timer to wait for the event loop to start
         QTimer::singleShot(0, _self, []()
         {
-            QGst::init();
-            QtWebEngine::initialize();
-
             // set root log output file
             Logger::rootLogger()->setLogfile(QCoreApplication::applicationDirPath()
                                              + "/../log/RoverControl_" + QDateTime::currentDateTime().toString("M-dd_h.mm_AP") + ".log");
             Logger::rootLogger()->setMaxFileLevel(Logger::LogLevelDebug);
             Logger::rootLogger()->setMaxStdoutLevel(Logger::LogLevelInformation);
+            Tracer::root()->setDumpDirectory(QCoreApplication::applicationDirPath() + "/../log", "RoverControl");
+            Tracer::root()->installSignalHandler();
 
             LOG_I(LOG_TAG, "-------------------------------------------------------");
             LOG_I(LOG_TAG, "-------------------------------------------------------");
@@ -81,290 +88,424 @@ void MainController::init(QApplication *app)
             LOG_I(LOG_TAG, "-------------------------------------------------------");
             LOG_I(LOG_TAG, "-------------------------------------------------------");
 
-            //
-            // Get settings from envvars
-            //
+            // Each subsystem is a task that runs once the ones it uses are ready. GStreamer
+            // initialization (which scans the plugin registry) overlaps with everything
+            // that doesn't need it.
+            _self->_startup = new StartupGraph("RoverControlStartup", _self);
 
-            LOG_I(LOG_TAG, "Reading settings...");
+            _self->_startup->addTask("gstreamer", []()
+            {
+                QGst::init();
+            }, QStringList(), StartupGraph::WorkerThread);
 
-            QFile confFile(QCoreApplication::applicationDirPath() + "/../config/research_control.conf");
-            if (!confFile.exists()) {
-                panic(LOG_TAG, "The configuration file ../config/research_control.conf does not exist.");
-            }
-            else {
-                ConfLoader config;
-                config.load(confFile);
+            _self->_startup->addTask("webengine", []()
+            {
+                QtWebEngine::initialize();
+            });
 
-                if (!config.valueAsIP("rover_address", &_self->_settings.roverAddress, false))
-                {
-                    panic(LOG_TAG, "Invalid value specified for rover_address in research_control.conf");
+            _self->_startup->addTask("config", []()
+            {
+                //
+                // Get settings from envvars
+                //
+
+                LOG_I(LOG_TAG, "Reading settings...");
+
+                _self->_config = new LiveConfig(_self);
+                _self->_config->define("rover_address", LiveConfig::IPType, QVariant(), false);
+                _self->_config->define("rover_alt_addresses", LiveConfig::StringListType, QStringList(), false);
+                _self->_config->define("local_transport", LiveConfig::StringType, "", false);
+                _self->_config->define("vaapi_enc_h264", LiveConfig::BoolType, QVariant());
+                _self->_config->define("vaapi_enc_mjpeg", LiveConfig::BoolType, QVariant());
+                _self->_config->define("vaapi_enc_h265", LiveConfig::BoolType, QVariant());
+                _self->_config->define("vaapi_enc_vp8", LiveConfig::BoolType, QVariant());
+                _self->_config->define("gst_hwrender", LiveConfig::BoolType, QVariant(), false);
+                _self->_config->define("simulated_delay", LiveConfig::IntType, 0);
+                _self->_config->setRange("simulated_delay", 0, 10000);
+                _self->_config->define("data_record_interval", LiveConfig::IntType, DEFAULT_DATA_RECORD_INTERVAL);
+                _self->_config->setRange("data_record_interval", 10, 1000);
+                _self->_config->define("resource_sample_interval", LiveConfig::IntType, DEFAULT_RESOURCE_SAMPLE_INTERVAL);
+                _self->_config->setRange("resource_sample_interval", 500, 60000);
+                _self->_config->define("event_loop_stall_threshold", LiveConfig::IntType, DEFAULT_EVENT_LOOP_STALL_THRESHOLD);
+                _self->_config->setRange("event_loop_stall_threshold", 20, 10000);
+                _self->_config->define("event_loop_stack_samples", LiveConfig::BoolType, false);
+
+                if (!_self->_config->load(QCoreApplication::applicationDirPath() + "/../config/research_control.conf")) {
+                    panic(LOG_TAG, "Cannot load ../config/research_control.conf: " + _self->_config->getError());
                 }
-
-                bool value;
-                if (!config.valueAsBool("vaapi_enc_h264", &value))
+                for (const QString& key : _self->_config->keys())
                 {
-                    panic(LOG_TAG, "Invalid value specified for vaapi_enc_h264 in research_control.conf");
+                    MemoryBudgetRegistry::root()->applyConfigValue(key, _self->_config->value(key));
                 }
-                _self->_settings.useVaapiEncodeForCodec.insert(GStreamerUtil::VIDEO_CODEC_H264, value);
 
-                if (!config.valueAsBool("vaapi_enc_mjpeg", &value))
+                _self->_settings.roverAddress = _self->_config->valueAsIP("rover_address");
+                for (QString address : _self->_config->valueAsStringList("rover_alt_addresses"))
                 {
-                    panic(LOG_TAG, "Invalid value specified for vaapi_enc_mjpeg in research_control.conf");
+                    QHostAddress altAddress(address);
+                    if (altAddress.isNull())
+                    {
+                        panic(LOG_TAG, "Invalid value specified for rover_alt_addresses in research_control.conf");
+                    }
+                    _self->_settings.roverAltAddresses.append(altAddress);
                 }
-                _self->_self->_settings.useVaapiEncodeForCodec.insert(GStreamerUtil::VIDEO_CODEC_MJPEG, value);
+                _self->_settings.useVaapiEncodeForCodec.insert(GStreamerUtil::VIDEO_CODEC_H264, _self->_config->valueAsBool("vaapi_enc_h264"));
+                _self->_settings.useVaapiEncodeForCodec.insert(GStreamerUtil::VIDEO_CODEC_MJPEG, _self->_config->valueAsBool("vaapi_enc_mjpeg"));
+                _self->_settings.useVaapiEncodeForCodec.insert(GStreamerUtil::VIDEO_CODEC_H265, _self->_config->valueAsBool("vaapi_enc_h265"));
+                _self->_settings.useVaapiEncodeForCodec.insert(GStreamerUtil::VIDEO_CODEC_VP8, _self->_config->valueAsBool("vaapi_enc_vp8"));
+                _self->_settings.useHwRendering = _self->_config->valueAsBool("gst_hwrender");
+                _self->_settings.selectedLatency = _self->_config->valueAsInt("simulated_delay");
+            });
 
-                if (!config.valueAsBool("vaapi_enc_h265", &value))
-                {
-                    panic(LOG_TAG, "Invalid value specified for vaapi_enc_h265 in research_control.conf");
-                }
-                _self->_settings.useVaapiEncodeForCodec.insert(GStreamerUtil::VIDEO_CODEC_H265, value);
+            _self->_startup->addTask("gamepad", []()
+            {
+                //
+                // Initialize gamepad manager
+                //
+
+                LOG_I(LOG_TAG, "Initializing gamepad manager...");
+                _self->_gamepad = new GamepadManager(QCoreApplication::applicationDirPath() + "/../config/gamecontrollerdb.txt", _self);
+            });
+
+            _self->_startup->addTask("channels", []()
+            {
+                //
+                // Initialize core connections
+                //
 
-                if (!config.valueAsBool("vaapi_enc_vp8", &value))
+                LOG_I(LOG_TAG, "Initializing core connections...");
+                QString localTransport = _self->_config->valueAsString("local_transport");
+                if (localTransport.isEmpty())
                 {
-                    panic(LOG_TAG, "Invalid value specified for vaapi_enc_vp8 in research_control.conf");
+                    _self->_mainChannel = Channel::createClient(_self, SocketAddress(_self->_settings.roverAddress, NETWORK_ALL_MAIN_CHANNEL_PORT), CHANNEL_NAME_MAIN,
+                            Channel::TcpProtocol, QHostAddress::Any);
+                    _self->_driveSystem = new DriveControlSystem(_self->_settings.roverAddress, _self->_settings.roverAltAddresses, _self);
                 }
-                _self->_settings.useVaapiEncodeForCodec.insert(GStreamerUtil::VIDEO_CODEC_VP8, value);
-
-                if (!config.valueAsBool("gst_hwrender", &_self->_settings.useHwRendering))
+                else
                 {
-                    panic(LOG_TAG, "Invalid value specified for gst_hwrender in research_control.conf");
+                    // Bench setup with the rover on this machine
+                    QString mainAddress = ChannelTransport::localAddress(localTransport, CHANNEL_NAME_MAIN, true);
+                    QString driveAddress = ChannelTransport::localAddress(localTransport, CHANNEL_NAME_DRIVE, false);
+                    if (mainAddress.isEmpty())
+                    {
+                        panic(LOG_TAG, "Invalid value specified for local_transport in research_control.conf");
+                    }
+                    LOG_I(LOG_TAG, "Connecting to the rover's main channel on " + mainAddress + " and its drive channel on " + driveAddress);
+                    _self->_mainChannel = Channel::createClient(_self, mainAddress, CHANNEL_NAME_MAIN);
+                    _self->_driveSystem = new DriveControlSystem(driveAddress, _self);
                 }
-            }
 
-            //
-            // Initialize gamepad manager
-            //
+                connect(_self->_mainChannel, &Channel::messageReceived,
+                        _self, &MainController::onMainChannelMessageReceived);
 
-            LOG_I(LOG_TAG, "Initializing gamepad manager...");
-            _self->_gamepad = new GamepadManager(QCoreApplication::applicationDirPath() + "/../config/gamecontrollerdb.txt", _self);
+                // Dump the rover's trace along with ours, so the two can be lined up
+                connect(Tracer::root(), &Tracer::dumpRequested, _self, &MainController::dumpTraces);
 
-            //
-            // Initialize core connections
-            //
+                _self->_driveSystem->setMode(DriveGamepadMode::SingleStickDrive);
+                _self->_driveSystem->getChannel()->setSimulatedDelay(_self->_settings.selectedLatency);
 
-            LOG_I(LOG_TAG, "Initializing core connections...");
-            _self->_mainChannel = Channel::createClient(_self, SocketAddress(_self->_settings.roverAddress, NETWORK_ALL_MAIN_CHANNEL_PORT), CHANNEL_NAME_MAIN,
-                    Channel::TcpProtocol, QHostAddress::Any);
+                connect(_self->_gamepad, &GamepadManager::poll,
+                        _self->_driveSystem, &DriveControlSystem::gamepadPoll);
+                connect(_self->_gamepad, &GamepadManager::gamepadChanged,
+                        _self->_driveSystem, &DriveControlSystem::gamepadChanged);
+            }, QStringList() << "config" << "gamepad");
 
-            connect(_self->_mainChannel, &Channel::messageReceived,
-                    _self, &MainController::onMainChannelMessageReceived);
+            _self->_startup->addTask("media", []()
+            {
+                //
+                // Initialize media systems...
+                //
 
-            _self->_driveSystem = new DriveControlSystem(_self->_settings.roverAddress, _self);
-            _self->_driveSystem->setMode(DriveGamepadMode::SingleStickDrive);
+                LOG_I(LOG_TAG, "Initializing audio/video systems...");
 
-            connect(_self->_gamepad, &GamepadManager::poll,
-                    _self->_driveSystem, &DriveControlSystem::gamepadPoll);
-            connect(_self->_gamepad, &GamepadManager::gamepadChanged,
-                    _self->_driveSystem, &DriveControlSystem::gamepadChanged);
-            connect(_self->_gamepad, &GamepadManager::poll, _self, [] (const GamepadManager::GamepadState *state) {
-                    _self->_gamepadXDataSeries->gamepadXChanged(state->axisLeftX);
-                    _self->_gamepadYDataSeries->gamepadYChanged(state->axisLeftY);
-            });
+                _self->_mainVideoClient = new VideoClient(MEDIAID_MAIN_CAMERA, SocketAddress(_self->_settings.roverAddress, NETWORK_ALL_MAIN_CAMERA_PORT), QHostAddress::Any, _self);
+                _self->_aux1VideoClient = new VideoClient(MEDIAID_AUX1_CAMERA, SocketAddress(_self->_settings.roverAddress, NETWORK_ALL_AUX1_CAMERA_PORT), QHostAddress::Any, _self);
 
-            _self->_mainChannel->open();
-            _self->_driveSystem->enable();
-
-            //
-            // Initialize media systems...
-            //
-
-            LOG_I(LOG_TAG, "Initializing audio/video systems...");
-
-            _self->_mainVideoClient = new VideoClient(MEDIAID_MAIN_CAMERA, SocketAddress(_self->_settings.roverAddress, NETWORK_ALL_MAIN_CAMERA_PORT), QHostAddress::Any, _self);
-            _self->_aux1VideoClient = new VideoClient(MEDIAID_AUX1_CAMERA, SocketAddress(_self->_settings.roverAddress, NETWORK_ALL_AUX1_CAMERA_PORT), QHostAddress::Any, _self);
-
-            // Add localhost bounce to video streams so they can be recorded and played at the same time
-            _self->_mainVideoClient->addForwardingAddress(SocketAddress(QHostAddress::LocalHost, NETWORK_ALL_MAIN_CAMERA_PORT));
-            _self->_mainVideoClient->addForwardingAddress(SocketAddress(QHostAddress::LocalHost, NETWORK_MC_CAMERA_REC_PORT));
-            _self->_aux1VideoClient->addForwardingAddress(SocketAddress(QHostAddress::LocalHost, NETWORK_ALL_AUX1_CAMERA_PORT));
-            _self->_aux1VideoClient->addForwardingAddress(SocketAddress(QHostAddress::LocalHost, NETWORK_MC_CAMERA_REC_PORT));
-
-            connect(_self->_mainVideoClient, &VideoClient::stateChanged, _self, &MainController::onVideoClientStateChanged);
-            connect(_self->_aux1VideoClient, &VideoClient::stateChanged, _self, &MainController::onVideoClientStateChanged);
-
-            _self->_audioClient = new AudioClient(MEDIAID_AUDIO, SocketAddress(_self->_settings.roverAddress, NETWORK_ALL_AUDIO_PORT), QHostAddress::Any, _self);
-
-            // Add localhost bounce to the media stream so the in-app player can display it from a udpsrc
-            _self->_audioClient->addForwardingAddress(SocketAddress(QHostAddress::LocalHost, NETWORK_ALL_AUDIO_PORT));
-            connect(_self->_audioClient, &AudioClient::stateChanged, _self, &MainController::onAudioClientStateChanged);
-
-            _self->_audioPlayer = new AudioPlayer(_self);
-
-            _self->_gstreamerRecorder = new GStreamerRecorder(SocketAddress(QHostAddress::LocalHost, NETWORK_MC_CAMERA_REC_PORT), "", _self);
-
-            //
-            // Initialize data recording system
-            //
-
-            LOG_I(LOG_TAG, "Initializing data recording systems...");
-            _self->_sensorDataSeries = new SensorDataParser(_self);
-            _self->_gpsDataSeries = new GpsCsvSeries(_self);
-            _self->_connectionEventSeries = new ConnectionEventCsvSeries(_self);
-            _self->_latencyDataSeries = new LatencyCsvSeries(_self);
-            _self->_wheelSpeedLMDataSeries = new WheelSpeedCsvSeries(DriveMessage::Index_LeftMiddle, _self);
-            _self->_wheelSpeedLODataSeries = new WheelSpeedCsvSeries(DriveMessage::Index_LeftOuter, _self);
-            _self->_wheelSpeedRMDataSeries = new WheelSpeedCsvSeries(DriveMessage::Index_RightMiddle, _self);
-            _self->_wheelSpeedRODataSeries = new WheelSpeedCsvSeries(DriveMessage::Index_RightOuter, _self);
-            _self->_commentDataSeries = new CommentCsvSeries(_self);
-            _self->_bitrateUpDataSeries = new BitrateUpCsvSeries(_self);
-            _self->_bitrateDownDataSeries = new BitrateDownCsvSeries(_self);
-            _self->_audioModeDataSeries = new AudioModeCsvSeries(_self);
-            _self->_videoModeDataSeries = new VideoModeCsvSeries(_self);
-            _self->_videoCodecDataSeries = new VideoCodecCsvSeries(_self);
-            _self->_videoWidthDataSeries = new VideoWidthCsvSeries(_self);
-            _self->_videoHeightDataSeries = new VideoHeightCsvSeries(_self);
-            _self->_videoBitrateDataSeries = new VideoBitrateCsvSeries(_self);
-            _self->_videoFramerateDataSeries = new VideoFramerateCsvSeries(_self);
-            _self->_hudParallaxDataSeries = new HudParallaxCsvSeries(_self);
-            _self->_hudLatencyDataSeries = new HudLatencyCsvSeries(_self);
-            _self->_gamepadXDataSeries = new GamepadXCsvSeries(_self);
-            _self->_gamepadYDataSeries = new GamepadYCsvSeries(_self);
-
-            _self->_dataRecorder = new CsvRecorder("data", _self);
-            _self->_dataRecorder->setUpdateInterval(50);
-
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getWheelPowerASeries());
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getWheelPowerBSeries());
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getWheelPowerCSeries());
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getWheelPowerDSeries());
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getWheelPowerESeries());
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getWheelPowerFSeries());
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getImuRearYawSeries());
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getImuRearPitchSeries());
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getImuRearRollSeries());
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getImuMiddleYawSeries());
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getImuMiddlePitchSeries());
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getImuMiddleRollSeries());
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getImuFrontYawSeries());
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getImuFrontPitchSeries());
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getImuFrontRollSeries());
-            _self->_dataRecorder->addColumn(_self->_wheelSpeedLODataSeries);
-            _self->_dataRecorder->addColumn(_self->_wheelSpeedLMDataSeries);
-            _self->_dataRecorder->addColumn(_self->_wheelSpeedRODataSeries);
-            _self->_dataRecorder->addColumn(_self->_wheelSpeedRMDataSeries);
-            _self->_dataRecorder->addColumn(_self->_gamepadXDataSeries);
-            _self->_dataRecorder->addColumn(_self->_gamepadYDataSeries);
-            _self->_dataRecorder->addColumn(_self->_gpsDataSeries->getLatitudeSeries());
-            _self->_dataRecorder->addColumn(_self->_gpsDataSeries->getLongitudeSeries());
-            _self->_dataRecorder->addColumn(_self->_bitrateUpDataSeries);
-            _self->_dataRecorder->addColumn(_self->_bitrateDownDataSeries);
-            _self->_dataRecorder->addColumn(_self->_latencyDataSeries->getRealLatencySeries());
-
-            _self->_commentRecorder = new CsvRecorder("comments", _self);
-            _self->_commentRecorder->addColumn(_self->_commentDataSeries);
-
-            _self->_settingsRecorder = new CsvRecorder("settings", _self);
-            _self->_settingsRecorder->addColumn(_self->_connectionEventSeries);
-            _self->_settingsRecorder->addColumn(_self->_latencyDataSeries->getSimulatedLatencySeries());
-            _self->_settingsRecorder->addColumn(_self->_videoModeDataSeries);
-            _self->_settingsRecorder->addColumn(_self->_videoCodecDataSeries);
-            _self->_settingsRecorder->addColumn(_self->_videoWidthDataSeries);
-            _self->_settingsRecorder->addColumn(_self->_videoHeightDataSeries);
-            _self->_settingsRecorder->addColumn(_self->_videoFramerateDataSeries);
-            _self->_settingsRecorder->addColumn(_self->_videoBitrateDataSeries);
-            _self->_settingsRecorder->addColumn(_self->_audioModeDataSeries);
-            _self->_settingsRecorder->addColumn(_self->_hudParallaxDataSeries);
-            _self->_settingsRecorder->addColumn(_self->_hudLatencyDataSeries);
-
-            connect(_self->_mainChannel, &Channel::stateChanged,
-                    _self->_connectionEventSeries, &ConnectionEventCsvSeries::mainChannelStateChanged);
-            connect(_self->_driveSystem->getChannel(), &Channel::stateChanged,
-                    _self->_connectionEventSeries, &ConnectionEventCsvSeries::driveChannelStateChanged);
-            connect(_self->_driveSystem, &DriveControlSystem::driveMessageSent,
-                    _self->_wheelSpeedLMDataSeries, &WheelSpeedCsvSeries::onDriveCommand);
-            connect(_self->_driveSystem, &DriveControlSystem::driveMessageSent,
-                    _self->_wheelSpeedLODataSeries, &WheelSpeedCsvSeries::onDriveCommand);
-            connect(_self->_driveSystem, &DriveControlSystem::driveMessageSent,
-                    _self->_wheelSpeedRMDataSeries, &WheelSpeedCsvSeries::onDriveCommand);
-            connect(_self->_driveSystem, &DriveControlSystem::driveMessageSent,
-                    _self->_wheelSpeedRODataSeries, &WheelSpeedCsvSeries::onDriveCommand);
-
-            //
-            // Initialize QML engine and register custom items
-            //
-
-            LOG_I(LOG_TAG, "Initializing QML and registering items...");
-            qmlRegisterType<HudLatencyGraphImpl>("Soro", 1, 0, "HudLatencyGraphImpl");
-            qmlRegisterType<HudPowerImpl>("Soro", 1, 0, "HudPowerImpl");
-            qmlRegisterType<HudOrientationSideImpl>("Soro", 1, 0, "HudOrientationSideImpl");
-            qmlRegisterType<HudOrientationBackImpl>("Soro", 1, 0, "HudOrientationBackImpl");
-            if (_self->_settings.useHwRendering)
+                // Add localhost bounce to video streams so they can be recorded and played at the same time
+                _self->_mainVideoClient->addForwardingAddress(SocketAddress(QHostAddress::LocalHost, NETWORK_ALL_MAIN_CAMERA_PORT));
+                _self->_mainVideoClient->addForwardingAddress(SocketAddress(QHostAddress::LocalHost, NETWORK_MC_CAMERA_REC_PORT));
+                _self->_aux1VideoClient->addForwardingAddress(SocketAddress(QHostAddress::LocalHost, NETWORK_ALL_AUX1_CAMERA_PORT));
+                _self->_aux1VideoClient->addForwardingAddress(SocketAddress(QHostAddress::LocalHost, NETWORK_MC_CAMERA_REC_PORT));
+
+                connect(_self->_mainVideoClient, &VideoClient::stateChanged, _self, &MainController::onVideoClientStateChanged);
+                connect(_self->_aux1VideoClient, &VideoClient::stateChanged, _self, &MainController::onVideoClientStateChanged);
+
+                _self->_audioClient = new AudioClient(MEDIAID_AUDIO, SocketAddress(_self->_settings.roverAddress, NETWORK_ALL_AUDIO_PORT), QHostAddress::Any, _self);
+
+                // Add localhost bounce to the media stream so the in-app player can display it from a udpsrc
+                _self->_audioClient->addForwardingAddress(SocketAddress(QHostAddress::LocalHost, NETWORK_ALL_AUDIO_PORT));
+                connect(_self->_audioClient, &AudioClient::stateChanged, _self, &MainController::onAudioClientStateChanged);
+
+                _self->_audioPlayer = new AudioPlayer(_self);
+
+                _self->_gstreamerRecorder = new GStreamerRecorder(SocketAddress(QHostAddress::LocalHost, NETWORK_MC_CAMERA_REC_PORT), "", _self);
+            }, QStringList() << "config" << "gstreamer");
+
+            _self->_startup->addTask("recorders", []()
             {
-                // Use the hardware opengl rendering surface, doesn't work on some hardware
-                LOG_I(LOG_TAG, "Registering QmlGStreamerItem as GStreamerSurface...");
-                qmlRegisterType<QmlGStreamerGlItem>("Soro", 1, 0, "GStreamerSurface");
-            }
-            else
+                //
+                // Initialize data recording system
+                //
+
+                LOG_I(LOG_TAG, "Initializing data recording systems...");
+                _self->_sensorDataSeries = new SensorDataParser(_self);
+                _self->_gpsDataSeries = new GpsCsvSeries(_self);
+                _self->_connectionEventSeries = new ConnectionEventCsvSeries(_self);
+                _self->_latencyDataSeries = new LatencyCsvSeries(_self);
+                _self->_resourceDataSeries = new ResourceCsvSeries(_self);
+                _self->_governorDataSeries = new GovernorCsvSeries(_self);
+                _self->_poseDataSeries = new PoseCsvSeries(_self);
+                _self->_wheelSpeedLMDataSeries = new WheelSpeedCsvSeries(DriveMessage::Index_LeftMiddle, _self);
+                _self->_wheelSpeedLODataSeries = new WheelSpeedCsvSeries(DriveMessage::Index_LeftOuter, _self);
+                _self->_wheelSpeedRMDataSeries = new WheelSpeedCsvSeries(DriveMessage::Index_RightMiddle, _self);
+                _self->_wheelSpeedRODataSeries = new WheelSpeedCsvSeries(DriveMessage::Index_RightOuter, _self);
+                _self->_commentDataSeries = new CommentCsvSeries(_self);
+                _self->_bitrateUpDataSeries = new BitrateUpCsvSeries(_self);
+                _self->_bitrateDownDataSeries = new BitrateDownCsvSeries(_self);
+                _self->_audioModeDataSeries = new AudioModeCsvSeries(_self);
+                _self->_videoModeDataSeries = new VideoModeCsvSeries(_self);
+                _self->_videoCodecDataSeries = new VideoCodecCsvSeries(_self);
+                _self->_videoWidthDataSeries = new VideoWidthCsvSeries(_self);
+                _self->_videoHeightDataSeries = new VideoHeightCsvSeries(_self);
+                _self->_videoBitrateDataSeries = new VideoBitrateCsvSeries(_self);
+                _self->_videoFramerateDataSeries = new VideoFramerateCsvSeries(_self);
+                _self->_hudParallaxDataSeries = new HudParallaxCsvSeries(_self);
+                _self->_hudLatencyDataSeries = new HudLatencyCsvSeries(_self);
+                _self->_gamepadXDataSeries = new GamepadXCsvSeries(_self);
+                _self->_gamepadYDataSeries = new GamepadYCsvSeries(_self);
+
+                _self->_dataRecorder = new CsvRecorder("data", _self);
+                _self->_dataRecorder->setUpdateInterval(_self->_config->valueAsInt("data_record_interval"));
+
+                _self->_sensorDataSeries->addColumns(_self->_dataRecorder);
+                _self->_dataRecorder->addColumn(_self->_wheelSpeedLODataSeries);
+                _self->_dataRecorder->addColumn(_self->_wheelSpeedLMDataSeries);
+                _self->_dataRecorder->addColumn(_self->_wheelSpeedRODataSeries);
+                _self->_dataRecorder->addColumn(_self->_wheelSpeedRMDataSeries);
+                _self->_dataRecorder->addColumn(_self->_gamepadXDataSeries);
+                _self->_dataRecorder->addColumn(_self->_gamepadYDataSeries);
+                _self->_dataRecorder->addColumn(_self->_gpsDataSeries->getLatitudeSeries());
+                _self->_dataRecorder->addColumn(_self->_gpsDataSeries->getLongitudeSeries());
+                _self->_dataRecorder->addColumn(_self->_poseDataSeries->getLatitudeSeries());
+                _self->_dataRecorder->addColumn(_self->_poseDataSeries->getLongitudeSeries());
+                _self->_dataRecorder->addColumn(_self->_poseDataSeries->getHeadingSeries());
+                _self->_dataRecorder->addColumn(_self->_poseDataSeries->getSpeedSeries());
+                _self->_dataRecorder->addColumn(_self->_poseDataSeries->getAccuracySeries());
+                _self->_dataRecorder->addColumn(_self->_bitrateUpDataSeries);
+                _self->_dataRecorder->addColumn(_self->_bitrateDownDataSeries);
+                _self->_dataRecorder->addColumn(_self->_latencyDataSeries->getRealLatencySeries());
+                _self->_dataRecorder->addColumn(_self->_latencyDataSeries->getMbedLatencySeries());
+                _self->_dataRecorder->addColumn(_self->_resourceDataSeries->getRoverCpuSeries());
+                _self->_dataRecorder->addColumn(_self->_resourceDataSeries->getRoverRssSeries());
+                _self->_dataRecorder->addColumn(_self->_resourceDataSeries->getRoverFdsSeries());
+                _self->_dataRecorder->addColumn(_self->_resourceDataSeries->getRoverAllocationsSeries());
+                _self->_dataRecorder->addColumn(_self->_resourceDataSeries->getRoverEventLoopLagSeries());
+                _self->_dataRecorder->addColumn(_self->_resourceDataSeries->getStreamerCpuSeries());
+                _self->_dataRecorder->addColumn(_self->_resourceDataSeries->getStreamerRssSeries());
+                _self->_dataRecorder->addColumn(_self->_resourceDataSeries->getRoverQueuedMessagesSeries());
+                _self->_dataRecorder->addColumn(_self->_resourceDataSeries->getRoverDiscardedMessagesSeries());
+                _self->_dataRecorder->addColumn(_self->_resourceDataSeries->getRoverLatePacketsSeries());
+                _self->_dataRecorder->addColumn(_self->_resourceDataSeries->getControlCpuSeries());
+                _self->_dataRecorder->addColumn(_self->_resourceDataSeries->getControlRssSeries());
+                _self->_dataRecorder->addColumn(_self->_resourceDataSeries->getControlEventLoopLagSeries());
+                _self->_dataRecorder->addColumn(_self->_governorDataSeries->getLevelSeries());
+                _self->_dataRecorder->addColumn(_self->_governorDataSeries->getTemperatureSeries());
+                _self->_dataRecorder->addColumn(_self->_governorDataSeries->getLoadSeries());
+                _self->_dataRecorder->addColumn(_self->_governorDataSeries->getFrameDeficitSeries());
+
+                _self->_commentRecorder = new CsvRecorder("comments", _self);
+                _self->_commentRecorder->addColumn(_self->_commentDataSeries);
+
+                _self->_settingsRecorder = new CsvRecorder("settings", _self);
+                _self->_settingsRecorder->addColumn(_self->_connectionEventSeries);
+                _self->_settingsRecorder->addColumn(_self->_latencyDataSeries->getSimulatedLatencySeries());
+                _self->_settingsRecorder->addColumn(_self->_videoModeDataSeries);
+                _self->_settingsRecorder->addColumn(_self->_videoCodecDataSeries);
+                _self->_settingsRecorder->addColumn(_self->_videoWidthDataSeries);
+                _self->_settingsRecorder->addColumn(_self->_videoHeightDataSeries);
+                _self->_settingsRecorder->addColumn(_self->_videoFramerateDataSeries);
+                _self->_settingsRecorder->addColumn(_self->_videoBitrateDataSeries);
+                _self->_settingsRecorder->addColumn(_self->_audioModeDataSeries);
+                _self->_settingsRecorder->addColumn(_self->_hudParallaxDataSeries);
+                _self->_settingsRecorder->addColumn(_self->_hudLatencyDataSeries);
+
+                connect(_self->_mainChannel, &Channel::stateChanged,
+                        _self->_connectionEventSeries, &ConnectionEventCsvSeries::mainChannelStateChanged);
+                connect(_self->_driveSystem->getChannel(), &Channel::stateChanged,
+                        _self->_connectionEventSeries, &ConnectionEventCsvSeries::driveChannelStateChanged);
+                connect(_self->_driveSystem, &DriveControlSystem::driveMessageSent,
+                        _self->_wheelSpeedLMDataSeries, &WheelSpeedCsvSeries::onDriveCommand);
+                connect(_self->_driveSystem, &DriveControlSystem::driveMessageSent,
+                        _self->_wheelSpeedLODataSeries, &WheelSpeedCsvSeries::onDriveCommand);
+                connect(_self->_driveSystem, &DriveControlSystem::driveMessageSent,
+                        _self->_wheelSpeedRMDataSeries, &WheelSpeedCsvSeries::onDriveCommand);
+                connect(_self->_driveSystem, &DriveControlSystem::driveMessageSent,
+                        _self->_wheelSpeedRODataSeries, &WheelSpeedCsvSeries::onDriveCommand);
+
+                connect(_self->_gamepad, &GamepadManager::poll, _self, [] (const GamepadManager::GamepadState *state) {
+                        _self->_gamepadXDataSeries->gamepadXChanged(state->axisLeftX);
+                        _self->_gamepadYDataSeries->gamepadYChanged(state->axisLeftY);
+                });
+            }, QStringList() << "channels" << "gamepad");
+
+            _self->_startup->addTask("qml", []()
             {
-                // Use the software rendering surface, works everywhere but slower
-                LOG_I(LOG_TAG, "Registering QmlGStreamerPaintedItem as GStreamerSurface...");
-                qmlRegisterType<QmlGStreamerPaintedItem>("Soro", 1, 0, "GStreamerSurface");
-            }
+                //
+                // Initialize QML engine and register custom items
+                //
+
+                LOG_I(LOG_TAG, "Initializing QML and registering items...");
+                qmlRegisterType<HudLatencyGraphImpl>("Soro", 1, 0, "HudLatencyGraphImpl");
+                qmlRegisterType<HudPowerImpl>("Soro", 1, 0, "HudPowerImpl");
+                qmlRegisterType<HudOrientationSideImpl>("Soro", 1, 0, "HudOrientationSideImpl");
+                qmlRegisterType<HudOrientationBackImpl>("Soro", 1, 0, "HudOrientationBackImpl");
+                if (_self->_settings.useHwRendering)
+                {
+                    // Use the hardware opengl rendering surface, doesn't work on some hardware
+                    LOG_I(LOG_TAG, "Registering QmlGStreamerItem as GStreamerSurface...");
+                    qmlRegisterType<QmlGStreamerGlItem>("Soro", 1, 0, "GStreamerSurface");
+                }
+                else
+                {
+                    // Use the software rendering surface, works everywhere but slower
+                    LOG_I(LOG_TAG, "Registering QmlGStreamerPaintedItem as GStreamerSurface...");
+                    qmlRegisterType<QmlGStreamerPaintedItem>("Soro", 1, 0, "GStreamerSurface");
+                }
 
-            _self->_qml = new QQmlEngine(_self);
-            QQuickStyle::setStyle("Material");
+                _self->_qml = new QQmlEngine(_self);
+                QQuickStyle::setStyle("Material");
+            }, QStringList() << "config" << "gstreamer");
 
-            //
-            // Create windows
-            //
-            LOG_I(LOG_TAG, "Creating windows...");
+            _self->_startup->addTask("windows", []()
+            {
+                //
+                // Create windows
+                //
+                LOG_I(LOG_TAG, "Creating windows...");
 
-            _self->_controlWindow = new ControlWindowController(_self->_qml, _self);
-            _self->_commentsWindow = new CommentsWindowController(_self->_qml, _self);
-            _self->_mainWindow = new MainWindowController(_self->_qml, _self);
+                _self->_controlWindow = new ControlWindowController(_self->_qml, _self);
+                _self->_commentsWindow = new CommentsWindowController(_self->_qml, _self);
+                _self->_mainWindow = new MainWindowController(_self->_qml, _self);
 
-            _self->_mainWindow->setDriveGamepadMode(_self->_driveSystem->getMode());
+                _self->_mainWindow->setDriveGamepadMode(_self->_driveSystem->getMode());
 
-            connect(_self->_mainChannel, &Channel::rttChanged, _self, [](int rtt) {
-                _self->_mainWindow->onLatencyChanged(rtt + _self->_settings.selectedLatency);
-            });
-            connect(_self->_mainChannel, &Channel::rttChanged,
-                    _self->_latencyDataSeries, &LatencyCsvSeries::updateRealLatency);
-            connect(_self->_mainChannel, &Channel::rttChanged,
-                    _self->_controlWindow, &ControlWindowController::onLatencyChanged);
-            connect(_self->_controlWindow, &ControlWindowController::requestUiSync,
-                    _self, &MainController::onRequestUiSync);
-            connect(_self->_controlWindow, &ControlWindowController::settingsApplied,
-                    _self, &MainController::onSettingsApplied);
-            connect(_self->_controlWindow, &ControlWindowController::zeroOrientationButtonClicked,
-                    _self->_mainWindow, &MainWindowController::onZeroHudOrientationClicked);
-            connect(_self->_gamepad, &GamepadManager::gamepadChanged,
-                    _self->_controlWindow, &ControlWindowController::onGamepadChanged);
-            connect(_self->_gamepad, &GamepadManager::poll,
-                    _self->_mainWindow, &MainWindowController::onGamepadUpdate);
-            connect(_self->_mainChannel, &Channel::stateChanged,
-                    _self->_controlWindow, &ControlWindowController::setConnectionState);
-
-            connect(_self->_controlWindow, &ControlWindowController::recordButtonClicked,
-                    _self, &MainController::toggleDataRecording);
-            connect (_self->_commentsWindow, &CommentsWindowController::recordButtonClicked,
-                     _self, &MainController::toggleDataRecording);
-
-            connect(_self->_sensorDataSeries, &SensorDataParser::dataParsed,
-                    _self->_mainWindow, &MainWindowController::onSensorUpdate);
-            connect(_self->_commentsWindow, &CommentsWindowController::logCommentEntered,
-                    _self->_commentDataSeries, &CommentCsvSeries::onCommentEntered);
-
-            connect(_self->_mainWindow, &MainWindowController::closed,
-                    _self, &MainController::onWindowClosed);
-            connect(_self->_controlWindow, &ControlWindowController::closed,
-                    _self, &MainController::onWindowClosed);
-            connect(_self->_commentsWindow, &CommentsWindowController::closed,
-                    _self, &MainController::onWindowClosed);
-
-            connect(_self->_mainWindow, &MainWindowController::gstreamerError, _self, [](QString message)
-            {
-               _self->_controlWindow->notify(NotificationType_Error, "Error Decoding Video", "Received an error decoding video: " + message);
-            });
+                connect(_self->_mainWindow, &MainWindowController::firstFrameShown, _self, []()
+                {
+                    LOG_I(LOG_TAG, "First frame shown " + QString::number(_self->_launchTimer.elapsed()) + "ms after launch");
+                });
+
+                connect(_self->_mainChannel, &Channel::rttChanged, _self, [](int rtt) {
+                    _self->_mainWindow->onLatencyChanged(rtt + _self->_settings.selectedLatency);
+                });
+                connect(_self->_mainChannel, &Channel::rttChanged,
+                        _self->_latencyDataSeries, &LatencyCsvSeries::updateRealLatency);
+                connect(_self->_mainChannel, &Channel::rttChanged,
+                        _self->_controlWindow, &ControlWindowController::onLatencyChanged);
+                connect(_self->_controlWindow, &ControlWindowController::requestUiSync,
+                        _self, &MainController::onRequestUiSync);
+                connect(_self->_controlWindow, &ControlWindowController::settingsApplied,
+                        _self, &MainController::onSettingsApplied);
+                connect(_self->_controlWindow, &ControlWindowController::zeroOrientationButtonClicked,
+                        _self->_mainWindow, &MainWindowController::onZeroHudOrientationClicked);
+                connect(_self->_controlWindow, &ControlWindowController::commentsButtonClicked,
+                        _self->_commentsWindow, &CommentsWindowController::show);
+                connect(_self->_gamepad, &GamepadManager::gamepadChanged,
+                        _self->_controlWindow, &ControlWindowController::onGamepadChanged);
+                connect(_self->_gamepad, &GamepadManager::poll,
+                        _self->_mainWindow, &MainWindowController::onGamepadUpdate);
+                connect(_self->_mainChannel, &Channel::stateChanged,
+                        _self->_controlWindow, &ControlWindowController::setConnectionState);
+
+                connect(_self->_controlWindow, &ControlWindowController::recordButtonClicked,
+                        _self, &MainController::toggleDataRecording);
+                connect (_self->_commentsWindow, &CommentsWindowController::recordButtonClicked,
+                         _self, &MainController::toggleDataRecording);
+
+                connect(_self->_sensorDataSeries, &SensorDataParser::dataParsed,
+                        _self->_mainWindow, &MainWindowController::onSensorUpdate);
+                connect(_self->_commentsWindow, &CommentsWindowController::logCommentEntered,
+                        _self->_commentDataSeries, &CommentCsvSeries::onCommentEntered);
+
+                connect(_self->_mainWindow, &MainWindowController::closed,
+                        _self, &MainController::onWindowClosed);
+                connect(_self->_controlWindow, &ControlWindowController::closed,
+                        _self, &MainController::onWindowClosed);
+
+                connect(_self->_mainWindow, &MainWindowController::gstreamerError, _self, [](QString message)
+                {
+                   _self->_controlWindow->notify(NotificationType_Error, "Error Decoding Video", "Received an error decoding video: " + message);
+                   Tracer::root()->dumpOnAnomaly("video_error");
+                });
+                connect(_self->_mainWindow, &MainWindowController::frameStalled, _self, [](int interval)
+                {
+                    LOG_W(LOG_TAG, "Video frame took " + QString::number(interval) + "ms to show");
+                    Tracer::root()->dumpOnAnomaly("frame_stall");
+                });
 
-            connect(_self->_mainChannel, &Channel::stateChanged,
-                    _self->_commentsWindow, &CommentsWindowController::setConnectionState);
+                connect(_self->_mainChannel, &Channel::stateChanged,
+                        _self->_commentsWindow, &CommentsWindowController::setConnectionState);
 
-            // Force an initial UI sync
-            _self->onRequestUiSync();
+                // Apply config changes from now on, and give the rover its settings whenever it connects
+                connect(_self->_config, &LiveConfig::valueChanged,
+                        _self, &MainController::onConfigValueChanged);
+                connect(_self->_mainChannel, &Channel::stateChanged, _self, [](Channel::State state)
+                {
+                    if (state == Channel::ConnectedState)
+                    {
+                        // Same workaround as the rover's status message, a Channel will not send
+                        // messages immediately after it connects
+                        QTimer::singleShot(1000, _self, []()
+                        {
+                            if (_self->_mainChannel->getState() != Channel::ConnectedState) return;
+                            for (QString key : _self->_config->keys())
+                            {
+                                if (key.startsWith(ROVER_CONFIG_PREFIX))
+                                {
+                                    _self->sendRoverConfigUpdate(key.mid(QString(ROVER_CONFIG_PREFIX).length()), _self->_config->valueAsString(key));
+                                }
+                            }
+                            _self->sendClockSync();
+                        });
+                    }
+                });
+
+                // Force an initial UI sync
+                _self->onRequestUiSync();
+
+                // Start bitrate calculate timer
+                _self->_bitrateUpdateTimerId = _self->startTimer(1000);
+
+                // Stalls here hold up drive commands and video frames alike
+                _self->_eventLoopMonitor = new EventLoopMonitor(_self);
+                _self->_eventLoopMonitor->setStallThreshold(_self->_config->valueAsInt("event_loop_stall_threshold"));
+                _self->_eventLoopMonitor->setStackSamplingEnabled(_self->_config->valueAsBool("event_loop_stack_samples"));
+                connect(_self->_eventLoopMonitor, &EventLoopMonitor::stalled, _self, []()
+                {
+                    Tracer::root()->dumpOnAnomaly("event_loop_stall");
+                });
+                _self->_eventLoopMonitor->start();
+
+                // Sample our own resource use to show next to the rover's
+                _self->_resourceMonitor = new ResourceMonitor(_self);
+                _self->_resourceMonitor->setEventLoopMonitor(_self->_eventLoopMonitor);
+                connect(_self->_resourceMonitor, &ResourceMonitor::sampled,
+                        _self->_resourceDataSeries, &ResourceCsvSeries::updateControlUsage);
+                connect(_self->_resourceMonitor, &ResourceMonitor::sampled,
+                        _self->_controlWindow, &ControlWindowController::updateControlResources);
+                _self->_resourceMonitor->start(_self->_config->valueAsInt("resource_sample_interval"));
+            }, QStringList() << "qml" << "webengine" << "channels" << "media" << "recorders");
+
+            // Nothing talks to the rover until everything that handles its messages exists
+            _self->_startup->addTask("connect", []()
+            {
+                LOG_I(LOG_TAG, "Connecting to the rover...");
+                _self->_mainChannel->open();
+                _self->_driveSystem->enable();
+            }, QStringList() << "windows");
 
-            // Start bitrate calculate timer
-            _self->_bitrateUpdateTimerId = _self->startTimer(1000);
+            if (!_self->_startup->start())
+            {
+                panic(LOG_TAG, "The startup sequence is invalid");
+            }
         });
     }
 }
@@ -504,6 +645,73 @@ void MainController::onSettingsApplied()
     _hudLatencyDataSeries->onSettingsChanged(&_settings);
 }
 
+void MainController::onConfigValueChanged(const QString& key, const QVariant& value)
+{
+    if (key.startsWith(ROVER_CONFIG_PREFIX))
+    {
+        // A rover setting that was removed from the file just stays as it is on the rover
+        if (value.isValid() && (_mainChannel->getState() == Channel::ConnectedState))
+        {
+            sendRoverConfigUpdate(key.mid(QString(ROVER_CONFIG_PREFIX).length()), value.toString());
+        }
+    }
+    else if (MemoryBudgetRegistry::root()->applyConfigValue(key, value))
+    {
+        // Handled by the registry
+    }
+    else if (key == "vaapi_enc_h264")
+    {
+        _settings.useVaapiEncodeForCodec.insert(GStreamerUtil::VIDEO_CODEC_H264, value.toBool());
+    }
+    else if (key == "vaapi_enc_mjpeg")
+    {
+        _settings.useVaapiEncodeForCodec.insert(GStreamerUtil::VIDEO_CODEC_MJPEG, value.toBool());
+    }
+    else if (key == "vaapi_enc_h265")
+    {
+        _settings.useVaapiEncodeForCodec.insert(GStreamerUtil::VIDEO_CODEC_H265, value.toBool());
+    }
+    else if (key == "vaapi_enc_vp8")
+    {
+        _settings.useVaapiEncodeForCodec.insert(GStreamerUtil::VIDEO_CODEC_VP8, value.toBool());
+    }
+    else if (key == "simulated_delay")
+    {
+        _settings.selectedLatency = value.toInt();
+        _driveSystem->getChannel()->setSimulatedDelay(_settings.selectedLatency);
+        _latencyDataSeries->updateSimulatedLatency(_settings.selectedLatency);
+        _controlWindow->updateFromSettingsModel(&_settings);
+    }
+    else if (key == "data_record_interval")
+    {
+        _dataRecorder->setUpdateInterval(value.toInt());
+    }
+    else if (key == "resource_sample_interval")
+    {
+        _resourceMonitor->start(value.toInt());
+    }
+    else if (key == "event_loop_stall_threshold")
+    {
+        _eventLoopMonitor->setStallThreshold(value.toInt());
+    }
+    else if (key == "event_loop_stack_samples")
+    {
+        _eventLoopMonitor->setStackSamplingEnabled(value.toBool());
+    }
+}
+
+void MainController::sendRoverConfigUpdate(QString key, QString value)
+{
+    QByteArray byteArray;
+    QDataStream stream(&byteArray, QIODevice::WriteOnly);
+    MainMessageType messageType = MainMessageType_RoverConfigUpdate;
+
+    stream << static_cast<qint32>(messageType);
+    stream << key;
+    stream << value;
+    _mainChannel->sendMessage(byteArray);
+}
+
 void MainController::onVideoClientStateChanged(MediaClient *client, MediaClient::State state)
 {
     if (client == _aux1VideoClient)
@@ -594,6 +802,32 @@ void MainController::sendStartRecordCommandToRover()
     stream << static_cast<qint32>(messageType);
     stream << _recordStartTime;
     _mainChannel->sendMessage(message);
+
+    // Measured again for every trial, so each one's logs can be lined up with the rover's
+    sendClockSync();
+}
+
+void MainController::sendClockSync()
+{
+    QByteArray message;
+    QDataStream stream(&message, QIODevice::WriteOnly);
+    MainMessageType messageType = MainMessageType_ClockSync;
+    stream << static_cast<qint32>(messageType);
+    stream << Clock::root()->msecsSinceEpoch();
+    _mainChannel->sendMessage(message);
+}
+
+void MainController::dumpTraces()
+{
+    Tracer::root()->dump("requested");
+    if (_mainChannel->getState() == Channel::ConnectedState)
+    {
+        QByteArray message;
+        QDataStream stream(&message, QIODevice::WriteOnly);
+        MainMessageType messageType = MainMessageType_DumpTrace;
+        stream << static_cast<qint32>(messageType);
+        _mainChannel->sendMessage(message);
+    }
 }
 
 void MainController::sendStopRecordCommandToRover()
@@ -632,6 +866,42 @@ void MainController::onMainChannelMessageReceived(const char *message, Channel::
         }
     }
         break;
+    case MainMessageType_ClockSync: {
+        qint64 sentTime, roverTime;
+        stream >> sentTime;
+        stream >> roverTime;
+        // Assumes the message took as long each way. The log viewer reads this line to put the
+        // rover's logs on mission control's timeline, so its wording matters.
+        qint64 roundTrip = Clock::root()->msecsSinceEpoch() - sentTime;
+        qint64 offset = roverTime - (sentTime + roundTrip / 2);
+        LOG_I(LOG_TAG, "Rover clock offset " + QString::number(offset) + "ms, measured over a "
+              + QString::number(roundTrip) + "ms round trip");
+    }
+        break;
+    case MainMessageType_RoverMbedRtt: {
+        qint32 rtt;
+        stream >> rtt;
+        _latencyDataSeries->updateMbedLatency(rtt);
+        if (rtt >= 0)
+        {
+            _controlWindow->setMbedStatus("Normal, " + QString::number(rtt) + "ms");
+        }
+    }
+        break;
+    case MainMessageType_RoverResourceUpdate: {
+        ResourceUsage usage;
+        stream >> usage;
+        _resourceDataSeries->updateRoverUsage(usage);
+        _controlWindow->updateRoverResources(usage);
+    }
+        break;
+    case MainMessageType_VideoGovernorUpdate: {
+        VideoGovernorState state;
+        stream >> state;
+        _governorDataSeries->update(state);
+        _controlWindow->updateRoverGovernor(state);
+    }
+        break;
     case MainMessageType_RoverMediaServerError: {
         qint32 mediaId;
         QString error;
@@ -663,6 +933,13 @@ void MainController::onMainChannelMessageReceived(const char *message, Channel::
         _gpsDataSeries->addLocation(location);
     }
         break;
+    case MainMessageType_RoverPoseUpdate: {
+        PoseEstimate pose;
+        stream >> pose;
+        _controlWindow->updatePose(pose);
+        _poseDataSeries->update(pose);
+    }
+        break;
     case MainMessageType_RoverDriveOverrideStart:
         _controlWindow->notify(NotificationType_Info,
                                "Network Driving Disabled",
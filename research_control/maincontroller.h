@@ -4,14 +4,22 @@
 #include <QObject>
 #include <QApplication>
 #include <QQmlEngine>
+#include <QElapsedTimer>
 
 #include "soro_core/csvrecorder.h"
 #include "soro_core/sensordataparser.h"
 #include "soro_core/gpscsvseries.h"
+#include "soro_core/posecsvseries.h"
 #include "soro_core/channel.h"
 #include "soro_core/wheelspeedcsvseries.h"
+#include "soro_core/liveconfig.h"
+#include "soro_core/startupgraph.h"
+#include "soro_core/resourcemonitor.h"
+#include "soro_core/eventloopmonitor.h"
 
 #include "latencycsvseries.h"
+#include "resourcecsvseries.h"
+#include "governorcsvseries.h"
 #include "commentcsvseries.h"
 #include "connectioneventcsvseries.h"
 #include "gamepadmanager.h"
@@ -53,6 +61,8 @@ private:
     static MainController *_self;
 
     QQmlEngine *_qml = 0;
+    LiveConfig *_config = 0;
+    StartupGraph *_startup = 0;
     GamepadManager *_gamepad = 0;
     SettingsModel _settings;
     DriveControlSystem *_driveSystem = 0;
@@ -91,6 +101,9 @@ private:
     HudLatencyCsvSeries *_hudLatencyDataSeries = 0;
     ConnectionEventCsvSeries *_connectionEventSeries = 0;
     LatencyCsvSeries *_latencyDataSeries = 0;
+    ResourceCsvSeries *_resourceDataSeries = 0;
+    GovernorCsvSeries *_governorDataSeries = 0;
+    PoseCsvSeries *_poseDataSeries = 0;
     CommentCsvSeries *_commentDataSeries = 0;
     GamepadXCsvSeries *_gamepadXDataSeries = 0;
     GamepadYCsvSeries *_gamepadYDataSeries = 0;
@@ -102,14 +115,19 @@ private:
     CsvRecorder *_settingsRecorder = 0;
 
     int _bitrateUpdateTimerId;
+    ResourceMonitor *_resourceMonitor = 0;
+    EventLoopMonitor *_eventLoopMonitor = 0;
 
     qint64 _recordStartTime = 0;
+    QElapsedTimer _launchTimer;
 
 private Q_SLOTS:
     void onMainChannelMessageReceived(const char *message, Channel::MessageSize length);
     void onWindowClosed();
     void onRequestUiSync();
     void onSettingsApplied();
+    void onConfigValueChanged(const QString& key, const QVariant& value);
+    void sendRoverConfigUpdate(QString key, QString value);
 
     void startDataRecording();
     void stopDataRecording();
@@ -124,6 +142,8 @@ private Q_SLOTS:
 
     void sendStopRecordCommandToRover();
     void sendStartRecordCommandToRover();
+    void sendClockSync();
+    void dumpTraces();
 
     void onAudioClientStateChanged(MediaClient *client, MediaClient::State state);
     void onVideoClientStateChanged(MediaClient *client, MediaClient::State state);
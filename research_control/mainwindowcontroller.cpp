@@ -18,13 +18,18 @@
 #include "maincontroller.h"
 #include "qmlgstreamerglitem.h"
 #include "soro_core/sensordataparser.h"
+#include "soro_core/sensortable.h"
 #include "soro_core/logger.h"
 #include "soro_core/constants.h"
+#include "soro_core/tracer.h"
 
 #include <QQmlComponent>
 
 #define LOG_TAG "MainWindowController"
 
+//time between frames, while video is playing, that counts as a stall worth dumping a trace for
+#define FRAME_STALL_THRESHOLD 250
+
 namespace Soro {
 
 MainWindowController::MainWindowController(QQmlEngine *engine, QObject *parent) : QObject(parent)
@@ -46,6 +51,31 @@ MainWindowController::MainWindowController(QQmlEngine *engine, QObject *parent)
 
     connect(_window, SIGNAL(closed()), this, SIGNAL(closed()));
 
+    // frameSwapped is emitted from the render thread, so this is queued back to the main thread
+    connect(_window, &QQuickWindow::frameSwapped, this, [this]()
+    {
+        if (_firstFrameShown) return;
+        _firstFrameShown = true;
+        disconnect(_window, &QQuickWindow::frameSwapped, this, nullptr);
+        Q_EMIT firstFrameShown();
+    }, Qt::QueuedConnection);
+
+    // Trace the scene graph's sync and render phases on the thread they happen on
+    connect(_window, &QQuickWindow::beforeSynchronizing, this, []() { TRACE_BEGIN("qml", "sync"); }, Qt::DirectConnection);
+    connect(_window, &QQuickWindow::afterSynchronizing, this, []() { TRACE_END("qml", "sync"); }, Qt::DirectConnection);
+    connect(_window, &QQuickWindow::beforeRendering, this, []() { TRACE_BEGIN("qml", "render"); }, Qt::DirectConnection);
+    connect(_window, &QQuickWindow::afterRendering, this, []() { TRACE_END("qml", "render"); }, Qt::DirectConnection);
+    connect(_window, &QQuickWindow::frameSwapped, this, [this]()
+    {
+        TRACE_INSTANT("qml", "frameSwapped");
+        // Video keeps the window redrawing, without it a long gap between frames is normal
+        if (_frameTimer.isValid() && _playing && (_frameTimer.elapsed() > FRAME_STALL_THRESHOLD))
+        {
+            Q_EMIT frameStalled((int)_frameTimer.elapsed());
+        }
+        _frameTimer.start();
+    }, Qt::DirectConnection);
+
     stopVideo();
 
     START_TIMER(_updateLatencyTimerId, 500);
@@ -61,6 +91,7 @@ void MainWindowController::resetPipeline()
     LOG_I(LOG_TAG, "Resetting gstreamer pipeline");
     if (!_pipeline.isNull())
     {
+        TRACE_SPAN("gstreamer", "Video stop pipeline");
         QGlib::disconnect(_pipeline->bus(), "message", this, &MainWindowController::onBusMessage);
         _pipeline->setState(QGst::StatePaused);
         _pipeline->setState(QGst::StateNull);
@@ -78,6 +109,7 @@ void MainWindowController::playVideo(SocketAddress address, GStreamerUtil::Video
         return;
     }
     _videoProfile = profile;
+    TRACE_SPAN("gstreamer", "Video start pipeline");
 
     _pipeline = QGst::Pipeline::create();
     _pipeline->bus()->addSignalWatch();
@@ -125,6 +157,7 @@ void MainWindowController::onBusMessage(const QGst::MessagePtr &message)
         Q_EMIT gstreamerError("Received unexpected EOS message");
         break;
     case QGst::MessageError: {
+        TRACE_INSTANT("gstreamer", "Video error");
         QString msg = message.staticCast<QGst::ErrorMessage>()->debugMessage();
         LOG_E(LOG_TAG, "onBusMessage(): Received error message from gstreamer '" + msg + "'");
         Q_EMIT gstreamerError(msg);
@@ -167,48 +200,10 @@ QGst::ElementPtr MainWindowController::getVideoSink()
 
 void MainWindowController::onSensorUpdate(char tag, int value)
 {
-    switch (tag) {
-    case SensorDataParser::DATATAG_WHEELPOWER_A:
-        _window->setProperty("wheelMLPower", value);
-        break;
-    case SensorDataParser::DATATAG_WHEELPOWER_B:
-        _window->setProperty("wheelFLPower", value);
-        break;
-    case SensorDataParser::DATATAG_WHEELPOWER_C:
-        _window->setProperty("wheelFRPower", value);
-        break;
-    case SensorDataParser::DATATAG_WHEELPOWER_D:
-        _window->setProperty("wheelMRPower", value);
-        break;
-    case SensorDataParser::DATATAG_WHEELPOWER_E:
-        _window->setProperty("wheelBRPower", value);
-        break;
-    case SensorDataParser::DATATAG_WHEELPOWER_F:
-        _window->setProperty("wheelBLPower", value);
-        break;
-    case SensorDataParser::DATATAG_IMUDATA_REAR_PITCH:
-        _window->setProperty("rearPitch", value);
-        break;
-    case SensorDataParser::DATATAG_IMUDATA_REAR_ROLL:
-        _window->setProperty("rearRoll", value);
-        break;
-    case SensorDataParser::DATATAG_IMUDATA_FRONT_PITCH:
-        _window->setProperty("frontPitch", value);
-        break;
-    case SensorDataParser::DATATAG_IMUDATA_FRONT_ROLL:
-        _window->setProperty("frontRoll", value);
-        break;
-    case SensorDataParser::DATATAG_IMUDATA_MIDDLE_PITCH:
-        _window->setProperty("middlePitch", value);
-        break;
-    case SensorDataParser::DATATAG_IMUDATA_MIDDLE_ROLL:
-        _window->setProperty("middleRoll", value);
-        break;
-    case SensorDataParser::DATATAG_IMUDATA_FRONT_YAW:
-       // _window->setProperty("compassHeading", (value - 100) * 360.0f / 800.0f); // original code
-        _window->setProperty("compassHeading", ((100 - value) * 360.0f / 800.0f)-130);  //Modified July 31 2017- works
-       //_window->setProperty("compassHeading", ((value - 100) * 360.0f / 800.0f*(-1.0))-50); //modified by MAG before Jul 31 2017
-        break;
+    const SensorDefinition *sensor = SensorTable::find(tag);
+    if (sensor && sensor->hudProperty)
+    {
+        _window->setProperty(sensor->hudProperty, sensor->toUnits(value));
     }
 }
 
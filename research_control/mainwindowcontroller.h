@@ -5,6 +5,7 @@
 #include <QQuickWindow>
 #include <QQmlApplicationEngine>
 #include <QTimerEvent>
+#include <QElapsedTimer>
 
 #include <Qt5GStreamer/QGst/Element>
 #include <Qt5GStreamer/QGst/Pipeline>
@@ -38,6 +39,13 @@ public:
 Q_SIGNALS:
     void closed();
     void gstreamerError(QString message);
+    /* Emitted once, after the window has put its first frame on screen
+     */
+    void firstFrameShown();
+    /* Emitted from the render thread when a frame was shown long after the one before it
+     * while video was playing
+     */
+    void frameStalled(int interval);
 
 public Q_SLOTS:
     void onLatencyChanged(int latency);
@@ -65,6 +73,8 @@ private:
     QQuickWindow *_window = 0;
     DriveGamepadMode _driveMode;
     int _updateLatencyTimerId;
+    bool _firstFrameShown = false;
+    QElapsedTimer _frameTimer;  // Only used on the render thread
 };
 
 } // namespace Soro
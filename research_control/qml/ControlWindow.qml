@@ -101,6 +101,12 @@ ApplicationWindow {
     property string roverAddress: "0.0.0.0"
     property string gamepad: "None"
     property string mbedStatus: "Unknown"
+    property string roverResources: "Unknown"
+    property string roverStreamerResources: "Unknown"
+    property string roverThreadResources: "Unknown"
+    property string roverChannelResources: "Unknown"
+    property string controlResources: "Unknown"
+    property string roverGovernor: "Unknown"
 
     // Internal properties
 
@@ -118,6 +124,7 @@ ApplicationWindow {
     signal logCommentEntered(string comment)
     signal recordButtonClicked()
     signal zeroOrientationButtonClicked()
+    signal commentsButtonClicked()
     signal closed()
 
     // Public functions
@@ -159,6 +166,13 @@ ApplicationWindow {
         gpsDataPoints++
     }
 
+    /*
+      Moves the rover's estimated pose on the map, this is called many times a second
+      */
+    function updatePose(lat, lng, heading, accuracy) {
+        webEngineView.runJavaScript("updatePose(" + lat + ", " + lng + ", " + heading + ", " + accuracy + ");")
+    }
+
     /*
       Updates the bitrate status label
       */
@@ -648,6 +662,144 @@ ApplicationWindow {
                     }
                 }
 
+                GroupBox {
+                    id: resourcesGroupBox
+                    height: roverGovernorField.y + roverGovernorField.height + topPadding + bottomPadding
+                    anchors.right: parent.right
+                    anchors.rightMargin: 0
+                    anchors.left: parent.left
+                    anchors.leftMargin: 0
+                    anchors.top: infoGroupBox.bottom
+                    anchors.topMargin: 8
+                    title: "Resources"
+
+                    Label {
+                        id: roverResourcesLabel
+                        width: 100
+                        text: "Rover"
+                        anchors.top: roverResourcesField.top
+                        anchors.left: parent.left
+                        anchors.leftMargin: 0
+                    }
+
+                    Label {
+                        id: roverResourcesField
+                        text: roverResources
+                        wrapMode: Text.WordWrap
+                        anchors.left: roverResourcesLabel.right
+                        anchors.leftMargin: 12
+                        anchors.right: parent.right
+                        anchors.rightMargin: 0
+                        anchors.top: parent.top
+                        anchors.topMargin: 0
+                    }
+
+                    Label {
+                        id: roverStreamerResourcesLabel
+                        width: 100
+                        text: "Streamers"
+                        anchors.top: roverStreamerResourcesField.top
+                        anchors.left: parent.left
+                        anchors.leftMargin: 0
+                    }
+
+                    Label {
+                        id: roverStreamerResourcesField
+                        text: roverStreamerResources
+                        wrapMode: Text.WordWrap
+                        anchors.left: roverStreamerResourcesLabel.right
+                        anchors.leftMargin: 12
+                        anchors.right: parent.right
+                        anchors.rightMargin: 0
+                        anchors.top: roverResourcesField.bottom
+                        anchors.topMargin: 8
+                    }
+
+                    Label {
+                        id: roverThreadResourcesLabel
+                        width: 100
+                        text: "Busiest Threads"
+                        anchors.top: roverThreadResourcesField.top
+                        anchors.left: parent.left
+                        anchors.leftMargin: 0
+                    }
+
+                    Label {
+                        id: roverThreadResourcesField
+                        text: roverThreadResources
+                        wrapMode: Text.WordWrap
+                        anchors.left: roverThreadResourcesLabel.right
+                        anchors.leftMargin: 12
+                        anchors.right: parent.right
+                        anchors.rightMargin: 0
+                        anchors.top: roverStreamerResourcesField.bottom
+                        anchors.topMargin: 8
+                    }
+
+                    Label {
+                        id: roverChannelResourcesLabel
+                        width: 100
+                        text: "Channels"
+                        anchors.top: roverChannelResourcesField.top
+                        anchors.left: parent.left
+                        anchors.leftMargin: 0
+                    }
+
+                    Label {
+                        id: roverChannelResourcesField
+                        text: roverChannelResources
+                        wrapMode: Text.WordWrap
+                        anchors.left: roverChannelResourcesLabel.right
+                        anchors.leftMargin: 12
+                        anchors.right: parent.right
+                        anchors.rightMargin: 0
+                        anchors.top: roverThreadResourcesField.bottom
+                        anchors.topMargin: 8
+                    }
+
+                    Label {
+                        id: controlResourcesLabel
+                        width: 100
+                        text: "Mission Control"
+                        anchors.top: controlResourcesField.top
+                        anchors.left: parent.left
+                        anchors.leftMargin: 0
+                    }
+
+                    Label {
+                        id: controlResourcesField
+                        text: controlResources
+                        wrapMode: Text.WordWrap
+                        anchors.left: controlResourcesLabel.right
+                        anchors.leftMargin: 12
+                        anchors.right: parent.right
+                        anchors.rightMargin: 0
+                        anchors.top: roverChannelResourcesField.bottom
+                        anchors.topMargin: 8
+                    }
+
+                    Label {
+                        id: roverGovernorLabel
+                        width: 100
+                        text: "Video Governor"
+                        anchors.top: roverGovernorField.top
+                        anchors.left: parent.left
+                        anchors.leftMargin: 0
+                    }
+
+                    Label {
+                        id: roverGovernorField
+                        text: roverGovernor
+                        wrapMode: Text.WordWrap
+                        anchors.left: roverGovernorLabel.right
+                        anchors.leftMargin: 12
+                        anchors.right: parent.right
+                        anchors.rightMargin: 0
+                        anchors.top: controlResourcesField.bottom
+                        anchors.topMargin: 8
+                    }
+                }
+
                 GroupBox {
                     id: interfaceGroupBox
                     x: -12
@@ -657,7 +809,7 @@ ApplicationWindow {
                     anchors.rightMargin: 0
                     anchors.left: parent.left
                     anchors.leftMargin: 0
-                    anchors.top: infoGroupBox.bottom
+                    anchors.top: resourcesGroupBox.bottom
                     anchors.topMargin: 8
                     title: "User Interface"
 
@@ -1366,6 +1518,16 @@ ApplicationWindow {
             }
         }
 
+        ToolbarButton {
+            id: commentsToolbarButton
+            anchors.right: recordToolbarButton.left
+            tooltip.text: "Show Comments Window"
+            image.source: "qrc:/icons/ic_comment_white_48px.svg"
+            onClicked: {
+                commentsButtonClicked()
+            }
+        }
+
         RecordButton {
             id: recordToolbarButton
             anchors.right: fullscreenToolbarButton.left
@@ -157,87 +157,92 @@ ApplicationWindow {
             enabled: visible
         }
 
-        HudCompass {
-            id: hudCompass2
-            x: overlayItem.width / 4 * 3 - width / 2
-            y: 12
-            compassHeading: mainWindow.compassHeading
-            compassHeadingZero: mainWindow.compassHeadingZero
-            width: parent.height * 0.12
-            height: width
-            halfWidth: true
-            visible: hudVisible && stereo
-            enabled: visible
-        }
-
-        HudPower {
-            id: hudPower2
-            wheelBLPower: mainWindow.wheelBLPower
-            wheelBRPower: mainWindow.wheelBRPower
-            wheelMLPower: mainWindow.wheelMLPower
-            wheelMRPower: mainWindow.wheelMRPower
-            wheelFLPower: mainWindow.wheelFLPower
-            wheelFRPower: mainWindow.wheelFRPower
-            blurSource: gstreamerSurface
-            x: overlayItem.width / 2
-            y: 0
-            width: height * 0.8
-            height: parent.height * 0.3
-            halfWidth: true
-            visible: hudVisible && stereo
-            enabled: visible
-        }
-
-        HudOrientationSide {
-            id: hudOrientationSide2
-            rearPitch: mainWindow.rearPitch
-            rearPitchZero: mainWindow.rearPitchZero
-            frontPitch: mainWindow.frontPitch
-            frontPitchZero: mainWindow.frontPitchZero
-            middlePitch: mainWindow.middlePitch
-            middlePitchZero: mainWindow.middlePitchZero
-            blurSource: gstreamerSurface
-            x: overlayItem.width / 2
-            y: overlayItem.height - height
-            width: height
-            height: parent.height * 0.3
-            halfWidth: true
-            visible: hudVisible && stereo
-            enabled: visible
-        }
-
-        HudOrientationBack {
-            id: hudOrientationBack2
-            rearRoll: mainWindow.rearRoll
-            rearRollZero: mainWindow.rearRollZero
-            frontRoll: mainWindow.frontRoll
-            frontRollZero: mainWindow.frontRollZero
-            middleRoll: mainWindow.middleRoll
-            middleRollZero: mainWindow.middleRollZero
-            blurSource: gstreamerSurface
-            x: overlayItem.width - width / 2 - hudParallax
-            y: overlayItem.height - height;
-            width: height
-            height: parent.height * 0.3
-            halfWidth: true
-            visible: hudVisible && stereo
-            enabled: visible
-        }
-
-        HudLatency {
-            id: hudLatency2
-            latency: mainWindow.latency
-            latencyTolerance: mainWindow.latencyTolerance
-            xValue: mainWindow.gamepadX
-            yValue: mainWindow.gamepadY
-            blurSource: gstreamerSurface
-            x: overlayItem.width - width / 2 - hudParallax
-            y: 0;
-            halfWidth: true
-            width: height
-            height: parent.height * 0.6
-            visible: hudVisible && stereo
-            enabled: visible
+        /* The right eye half of the HUD is only needed in stereo mode, so don't create it
+          until stereo is turned on. Hiding the HUD only hides it, so it isn't built again
+          every time the HUD is toggled
+          */
+        Loader {
+            id: stereoHudLoader
+            objectName: "stereoHudLoader"
+            anchors.fill: parent
+            active: stereo
+            visible: hudVisible
+            sourceComponent: Component {
+                Item {
+                    HudCompass {
+                        id: hudCompass2
+                        x: overlayItem.width / 4 * 3 - width / 2
+                        y: 12
+                        compassHeading: mainWindow.compassHeading
+                        compassHeadingZero: mainWindow.compassHeadingZero
+                        width: parent.height * 0.12
+                        height: width
+                        halfWidth: true
+                    }
+
+                    HudPower {
+                        id: hudPower2
+                        wheelBLPower: mainWindow.wheelBLPower
+                        wheelBRPower: mainWindow.wheelBRPower
+                        wheelMLPower: mainWindow.wheelMLPower
+                        wheelMRPower: mainWindow.wheelMRPower
+                        wheelFLPower: mainWindow.wheelFLPower
+                        wheelFRPower: mainWindow.wheelFRPower
+                        blurSource: gstreamerSurface
+                        x: overlayItem.width / 2
+                        y: 0
+                        width: height * 0.8
+                        height: parent.height * 0.3
+                        halfWidth: true
+                    }
+
+                    HudOrientationSide {
+                        id: hudOrientationSide2
+                        rearPitch: mainWindow.rearPitch
+                        rearPitchZero: mainWindow.rearPitchZero
+                        frontPitch: mainWindow.frontPitch
+                        frontPitchZero: mainWindow.frontPitchZero
+                        middlePitch: mainWindow.middlePitch
+                        middlePitchZero: mainWindow.middlePitchZero
+                        blurSource: gstreamerSurface
+                        x: overlayItem.width / 2
+                        y: overlayItem.height - height
+                        width: height
+                        height: parent.height * 0.3
+                        halfWidth: true
+                    }
+
+                    HudOrientationBack {
+                        id: hudOrientationBack2
+                        rearRoll: mainWindow.rearRoll
+                        rearRollZero: mainWindow.rearRollZero
+                        frontRoll: mainWindow.frontRoll
+                        frontRollZero: mainWindow.frontRollZero
+                        middleRoll: mainWindow.middleRoll
+                        middleRollZero: mainWindow.middleRollZero
+                        blurSource: gstreamerSurface
+                        x: overlayItem.width - width / 2 - hudParallax
+                        y: overlayItem.height - height;
+                        width: height
+                        height: parent.height * 0.3
+                        halfWidth: true
+                    }
+
+                    HudLatency {
+                        id: hudLatency2
+                        latency: mainWindow.latency
+                        latencyTolerance: mainWindow.latencyTolerance
+                        xValue: mainWindow.gamepadX
+                        yValue: mainWindow.gamepadY
+                        blurSource: gstreamerSurface
+                        x: overlayItem.width - width / 2 - hudParallax
+                        y: 0;
+                        halfWidth: true
+                        width: height
+                        height: parent.height * 0.6
+                    }
+                }
+            }
         }
     }
 }
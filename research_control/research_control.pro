@@ -1,6 +1,8 @@
 QT += core widgets network qml quick quickcontrols2 webengine
 
 CONFIG += c++11 no_keywords
+# Compile the QML in qml.qrc at build time instead of on every launch (qmlcachegen on Qt 5.11+)
+CONFIG += qtquickcompiler
 TARGET = research_control
 TEMPLATE = app
 
@@ -20,6 +22,8 @@ SOURCES += main.cpp \
     hudorientationbackimpl.cpp \
     abstracthudorientationimpl.cpp \
     latencycsvseries.cpp \
+    resourcecsvseries.cpp \
+    governorcsvseries.cpp \
     commentcsvseries.cpp \
     connectioneventcsvseries.cpp \
     gstreamerrecorder.cpp \
@@ -58,6 +62,8 @@ HEADERS  += \
     hudorientationbackimpl.h \
     abstracthudorientationimpl.h \
     latencycsvseries.h \
+    resourcecsvseries.h \
+    governorcsvseries.h \
     commentcsvseries.h \
     connectioneventcsvseries.h \
     gstreamerrecorder.h \
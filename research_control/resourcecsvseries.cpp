@@ -0,0 +1,115 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "resourcecsvseries.h"
+
+namespace Soro {
+
+ResourceCsvSeries::ResourceCsvSeries(QObject *parent) : QObject(parent) { }
+
+const ResourceCsvSeries::RoverCpuCsvSeries* ResourceCsvSeries::getRoverCpuSeries() const
+{
+    return &_roverCpuSeries;
+}
+
+const ResourceCsvSeries::RoverRssCsvSeries* ResourceCsvSeries::getRoverRssSeries() const
+{
+    return &_roverRssSeries;
+}
+
+const ResourceCsvSeries::RoverFdsCsvSeries* ResourceCsvSeries::getRoverFdsSeries() const
+{
+    return &_roverFdsSeries;
+}
+
+const ResourceCsvSeries::RoverAllocationsCsvSeries* ResourceCsvSeries::getRoverAllocationsSeries() const
+{
+    return &_roverAllocationsSeries;
+}
+
+const ResourceCsvSeries::RoverEventLoopLagCsvSeries* ResourceCsvSeries::getRoverEventLoopLagSeries() const
+{
+    return &_roverEventLoopLagSeries;
+}
+
+const ResourceCsvSeries::StreamerCpuCsvSeries* ResourceCsvSeries::getStreamerCpuSeries() const
+{
+    return &_streamerCpuSeries;
+}
+
+const ResourceCsvSeries::StreamerRssCsvSeries* ResourceCsvSeries::getStreamerRssSeries() const
+{
+    return &_streamerRssSeries;
+}
+
+const ResourceCsvSeries::RoverQueuedMessagesCsvSeries* ResourceCsvSeries::getRoverQueuedMessagesSeries() const
+{
+    return &_roverQueuedMessagesSeries;
+}
+
+const ResourceCsvSeries::RoverDiscardedMessagesCsvSeries* ResourceCsvSeries::getRoverDiscardedMessagesSeries() const
+{
+    return &_roverDiscardedMessagesSeries;
+}
+
+const ResourceCsvSeries::RoverLatePacketsCsvSeries* ResourceCsvSeries::getRoverLatePacketsSeries() const
+{
+    return &_roverLatePacketsSeries;
+}
+
+const ResourceCsvSeries::ControlCpuCsvSeries* ResourceCsvSeries::getControlCpuSeries() const
+{
+    return &_controlCpuSeries;
+}
+
+const ResourceCsvSeries::ControlRssCsvSeries* ResourceCsvSeries::getControlRssSeries() const
+{
+    return &_controlRssSeries;
+}
+
+const ResourceCsvSeries::ControlEventLoopLagCsvSeries* ResourceCsvSeries::getControlEventLoopLagSeries() const
+{
+    return &_controlEventLoopLagSeries;
+}
+
+void ResourceCsvSeries::updateRoverUsage(const ResourceUsage& usage)
+{
+    _roverCpuSeries.update(QVariant(usage.cpu));
+    _roverRssSeries.update(QVariant(usage.rss));
+    _roverFdsSeries.update(QVariant(usage.fds));
+    if (usage.allocationsPerSecond >= 0)
+    {
+        _roverAllocationsSeries.update(QVariant(usage.allocationsPerSecond));
+    }
+    _roverEventLoopLagSeries.update(QVariant(usage.eventLoopLag));
+    _streamerCpuSeries.update(QVariant(usage.getChildCpu()));
+    _streamerRssSeries.update(QVariant(usage.getChildRss()));
+    if (!usage.channels.isEmpty())
+    {
+        _roverQueuedMessagesSeries.update(QVariant(usage.getQueuedMessages()));
+        _roverDiscardedMessagesSeries.update(QVariant(usage.getDiscardedMessages()));
+        _roverLatePacketsSeries.update(QVariant(usage.getLateDroppedPackets()));
+    }
+}
+
+void ResourceCsvSeries::updateControlUsage(const ResourceUsage& usage)
+{
+    _controlCpuSeries.update(QVariant(usage.cpu));
+    _controlRssSeries.update(QVariant(usage.rss));
+    _controlEventLoopLagSeries.update(QVariant(usage.eventLoopLag));
+}
+
+} // namespace Soro
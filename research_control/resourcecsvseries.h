@@ -0,0 +1,114 @@
+#ifndef RESOURCECSVSERIES_H
+#define RESOURCECSVSERIES_H
+
+#include <QObject>
+
+#include "soro_core/csvrecorder.h"
+#include "soro_core/resourcemonitor.h"
+
+namespace Soro {
+
+/* Records the CPU and memory use of the rover, its streamer processes, and mission control.
+ * CPU is in tenths of a percent of one core, memory in kilobytes, and lag in milliseconds,
+ * as in ResourceUsage.
+ *
+ * Queued messages are those waiting in the send queues of the rover's channels, and discarded
+ * messages the running total conflated or dropped from them. Late packets are the running total
+ * of UDP packets the rover dropped for arriving after a newer one.
+ */
+class ResourceCsvSeries : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ResourceCsvSeries(QObject *parent = 0);
+
+    class RoverCpuCsvSeries : public CsvDataSeries { friend class ResourceCsvSeries;
+    public: QString getSeriesName() const { return "Rover CPU"; }
+            bool shouldKeepOldValues() const { return true; }
+    };
+    class RoverRssCsvSeries : public CsvDataSeries { friend class ResourceCsvSeries;
+    public: QString getSeriesName() const { return "Rover Memory"; }
+            bool shouldKeepOldValues() const { return true; }
+    };
+    class RoverFdsCsvSeries : public CsvDataSeries { friend class ResourceCsvSeries;
+    public: QString getSeriesName() const { return "Rover File Descriptors"; }
+            bool shouldKeepOldValues() const { return true; }
+    };
+    class RoverAllocationsCsvSeries : public CsvDataSeries { friend class ResourceCsvSeries;
+    public: QString getSeriesName() const { return "Rover Allocations/s"; }
+            bool shouldKeepOldValues() const { return true; }
+    };
+    class RoverEventLoopLagCsvSeries : public CsvDataSeries { friend class ResourceCsvSeries;
+    public: QString getSeriesName() const { return "Rover Event Loop Lag"; }
+            bool shouldKeepOldValues() const { return true; }
+    };
+    class StreamerCpuCsvSeries : public CsvDataSeries { friend class ResourceCsvSeries;
+    public: QString getSeriesName() const { return "Rover Streamer CPU"; }
+            bool shouldKeepOldValues() const { return true; }
+    };
+    class StreamerRssCsvSeries : public CsvDataSeries { friend class ResourceCsvSeries;
+    public: QString getSeriesName() const { return "Rover Streamer Memory"; }
+            bool shouldKeepOldValues() const { return true; }
+    };
+    class RoverQueuedMessagesCsvSeries : public CsvDataSeries { friend class ResourceCsvSeries;
+    public: QString getSeriesName() const { return "Rover Queued Messages"; }
+            bool shouldKeepOldValues() const { return true; }
+    };
+    class RoverDiscardedMessagesCsvSeries : public CsvDataSeries { friend class ResourceCsvSeries;
+    public: QString getSeriesName() const { return "Rover Discarded Messages"; }
+            bool shouldKeepOldValues() const { return true; }
+    };
+    class RoverLatePacketsCsvSeries : public CsvDataSeries { friend class ResourceCsvSeries;
+    public: QString getSeriesName() const { return "Rover Late Packets"; }
+            bool shouldKeepOldValues() const { return true; }
+    };
+    class ControlCpuCsvSeries : public CsvDataSeries { friend class ResourceCsvSeries;
+    public: QString getSeriesName() const { return "Mission Control CPU"; }
+            bool shouldKeepOldValues() const { return true; }
+    };
+    class ControlRssCsvSeries : public CsvDataSeries { friend class ResourceCsvSeries;
+    public: QString getSeriesName() const { return "Mission Control Memory"; }
+            bool shouldKeepOldValues() const { return true; }
+    };
+    class ControlEventLoopLagCsvSeries : public CsvDataSeries { friend class ResourceCsvSeries;
+    public: QString getSeriesName() const { return "Mission Control Event Loop Lag"; }
+            bool shouldKeepOldValues() const { return true; }
+    };
+
+    const RoverCpuCsvSeries* getRoverCpuSeries() const;
+    const RoverRssCsvSeries* getRoverRssSeries() const;
+    const RoverFdsCsvSeries* getRoverFdsSeries() const;
+    const RoverAllocationsCsvSeries* getRoverAllocationsSeries() const;
+    const RoverEventLoopLagCsvSeries* getRoverEventLoopLagSeries() const;
+    const StreamerCpuCsvSeries* getStreamerCpuSeries() const;
+    const StreamerRssCsvSeries* getStreamerRssSeries() const;
+    const RoverQueuedMessagesCsvSeries* getRoverQueuedMessagesSeries() const;
+    const RoverDiscardedMessagesCsvSeries* getRoverDiscardedMessagesSeries() const;
+    const RoverLatePacketsCsvSeries* getRoverLatePacketsSeries() const;
+    const ControlCpuCsvSeries* getControlCpuSeries() const;
+    const ControlRssCsvSeries* getControlRssSeries() const;
+    const ControlEventLoopLagCsvSeries* getControlEventLoopLagSeries() const;
+
+public Q_SLOTS:
+    void updateRoverUsage(const ResourceUsage& usage);
+    void updateControlUsage(const ResourceUsage& usage);
+
+private:
+    RoverCpuCsvSeries _roverCpuSeries;
+    RoverRssCsvSeries _roverRssSeries;
+    RoverFdsCsvSeries _roverFdsSeries;
+    RoverAllocationsCsvSeries _roverAllocationsSeries;
+    RoverEventLoopLagCsvSeries _roverEventLoopLagSeries;
+    StreamerCpuCsvSeries _streamerCpuSeries;
+    StreamerRssCsvSeries _streamerRssSeries;
+    RoverQueuedMessagesCsvSeries _roverQueuedMessagesSeries;
+    RoverDiscardedMessagesCsvSeries _roverDiscardedMessagesSeries;
+    RoverLatePacketsCsvSeries _roverLatePacketsSeries;
+    ControlCpuCsvSeries _controlCpuSeries;
+    ControlRssCsvSeries _controlRssSeries;
+    ControlEventLoopLagCsvSeries _controlEventLoopLagSeries;
+};
+
+} // namespace Soro
+
+#endif // RESOURCECSVSERIES_H
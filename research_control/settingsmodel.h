@@ -36,6 +36,7 @@ struct SettingsModel {
     int aux1CameraIndex;
 
     QHostAddress roverAddress;
+    QList<QHostAddress> roverAltAddresses;
     bool useHwRendering;
     QHash<quint8, bool> useVaapiEncodeForCodec;
 
@@ -19,8 +19,8 @@
 
 namespace Soro {
 
-AudioServer::AudioServer(int mediaId, quint16 bindPort, QObject *parent)
-    : MediaServer("AudioServer " + QString::number(mediaId), mediaId, QCoreApplication::applicationDirPath() + "/audio_streamer" , bindPort, parent) {
+AudioServer::AudioServer(int mediaId, SocketAddress host, QObject *parent)
+    : MediaServer("AudioServer " + QString::number(mediaId), mediaId, QCoreApplication::applicationDirPath() + "/audio_streamer" , host, parent) {
 }
 
 void AudioServer::onStreamStoppedInternal() {
@@ -40,12 +40,12 @@ void AudioServer::start(GStreamerUtil::AudioProfile profile) {
     _starting = false;
 }
 
-void AudioServer::constructChildArguments(QStringList& outArgs, quint16 bindPort, SocketAddress address, quint16 ipcPort) {
+void AudioServer::constructChildArguments(QStringList& outArgs, quint16 bindPort, SocketAddress address, QString ipcAddress) {
     outArgs << _profile.toString();
     outArgs << QHostAddress(address.host.toIPv4Address()).toString();
     outArgs << QString::number(address.port);
     outArgs << QString::number(bindPort);
-    outArgs << QString::number(ipcPort);
+    outArgs << ipcAddress;
 
     QString binString = GStreamerUtil::createRtpAlsaEncodeString(bindPort, address.host, address.port, _profile);
     LOG_I(LOG_TAG, "Child is about to start using gstreamer bin string " + binString);
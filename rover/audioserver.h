@@ -22,7 +22,7 @@ public:
      * @param host Address for the socket that will be used to communicate with the media client.
      * @param parent
      */
-    explicit AudioServer(int mediaId, quint16 bindPort, QObject *parent = nullptr);
+    explicit AudioServer(int mediaId, SocketAddress host, QObject *parent = nullptr);
 
     /**
      * Starts an audio stream. If the server is already streaming, it will be stopped and restarted to
@@ -46,7 +46,7 @@ protected:
      * Begins streaming video to the provided address.
      * This will fail if the stream is not in WaitingState
      */
-    void constructChildArguments(QStringList& outArgs, quint16 bindPort, SocketAddress address, quint16 ipcPort) Q_DECL_OVERRIDE;
+    void constructChildArguments(QStringList& outArgs, quint16 bindPort, SocketAddress address, QString ipcAddress) Q_DECL_OVERRIDE;
 
     void onStreamStoppedInternal() Q_DECL_OVERRIDE;
 
@@ -17,66 +17,340 @@
 #include "gpsserver.h"
 #include "soro_core/logger.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
 #define LOG_TAG "GpsServer"
 
 #define RECOVERY_DELAY 500
+//serial ports and gpsd usually stay unavailable for a while, so don't retry them as often
+#define DEVICE_RECOVERY_DELAY 2000
+#define MAX_FIX_RATE 10
+//size of a GGA and a VTG sentence, the least a receiver sends per fix
+#define BYTES_PER_FIX 120
 
 namespace Soro {
 
-GpsServer::GpsServer(SocketAddress hostAddress, QObject *parent) : QObject(parent) {
-    _socket = new QUdpSocket(this);
-    connect(_socket, &QUdpSocket::readyRead, this, &GpsServer::socketReadyRead);
-    connect(_socket, static_cast<void (QUdpSocket::*)(QUdpSocket::SocketError)>(&QUdpSocket::error), this, &GpsServer::socketError);
-    LOG_I(LOG_TAG, "Creating GPS server with host address " + hostAddress.toString());
-    _hostAddress = hostAddress;
-    resetConnection();
+GpsServer::GpsServer(QObject *parent) : QObject(parent) {
 }
 
 GpsServer::~GpsServer() {
-    delete _socket;
+    close();
+}
+
+void GpsServer::listenUdp(SocketAddress hostAddress) {
+    close();
+    LOG_I(LOG_TAG, "Listening for GPS on UDP " + hostAddress.toString());
+    _source = UdpSource;
+    _address = hostAddress;
+    _udpSocket = new QUdpSocket(this);
+    connect(_udpSocket, &QUdpSocket::readyRead, this, &GpsServer::udpSocketReadyRead);
+    connect(_udpSocket, static_cast<void (QUdpSocket::*)(QUdpSocket::SocketError)>(&QUdpSocket::error), this, &GpsServer::udpSocketError);
+    resetConnection();
+}
+
+void GpsServer::openSerial(const QString& device, int baudRate) {
+    close();
+    LOG_I(LOG_TAG, "Reading GPS from serial port " + device + " at " + QString::number(baudRate) + " baud");
+    _source = SerialSource;
+    _serialDevice = device;
+    _serialBaudRate = baudRate;
+    resetConnection();
+}
+
+void GpsServer::connectGpsd(SocketAddress gpsdAddress) {
+    close();
+    LOG_I(LOG_TAG, "Reading GPS from gpsd at " + gpsdAddress.toString());
+    _source = GpsdSource;
+    _address = gpsdAddress;
+    _gpsdSocket = new QTcpSocket(this);
+    connect(_gpsdSocket, &QTcpSocket::connected, this, &GpsServer::gpsdConnected);
+    connect(_gpsdSocket, &QTcpSocket::readyRead, this, &GpsServer::gpsdReadyRead);
+    connect(_gpsdSocket, static_cast<void (QTcpSocket::*)(QTcpSocket::SocketError)>(&QTcpSocket::error), this, &GpsServer::gpsdError);
+    resetConnection();
+}
+
+void GpsServer::close() {
+    KILL_TIMER(_resetConnectionTimerId);
+    closeSerialPort();
+    delete _udpSocket;
+    _udpSocket = nullptr;
+    delete _gpsdSocket;
+    _gpsdSocket = nullptr;
+    _source = NoSource;
+    _framer.clear();
+    _lastVtg.clear();
+}
+
+void GpsServer::setReceiver(ReceiverType type, int fixRate) {
+    _receiverType = type;
+    _fixRate = qBound(1, fixRate, MAX_FIX_RATE);
+    configureReceiver();
 }
 
-void GpsServer::socketReadyRead() {
-    LOG_D(LOG_TAG, "socketReadyRead() called");
-    SocketAddress address;
-    qint64 status;
-    while (_socket->hasPendingDatagrams()) {
+bool GpsServer::parseReceiverType(const QString& name, ReceiverType *type) {
+    if (name == "generic") {
+        *type = GenericReceiver;
+    }
+    else if (name == "mtk") {
+        *type = MtkReceiver;
+    }
+    else if (name == "ublox") {
+        *type = UbloxReceiver;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+quint64 GpsServer::getDroppedSentenceCount() const {
+    return _framer.getDroppedCount();
+}
+
+void GpsServer::udpSocketReadyRead() {
+    while (_udpSocket->hasPendingDatagrams()) {
         //read in a datagram
-        status = _socket->readDatagram(_buffer, 1024, &address.host, &address.port);
+        qint64 status = _udpSocket->readDatagram(_buffer, sizeof(_buffer));
         if (status < 0) {
-            //an error occurred reading from the socket, the onSocketError slot will handle it
+            //an error occurred reading from the socket, the udpSocketError slot will handle it
             return;
         }
-        QString nmea = QString(_buffer);
-        NmeaMessage nmeaMessage(nmea);
+        // Forwarders may NUL terminate the datagram, and may leave the line ending off the last
+        // sentence since the datagram already marks where it ends
+        int length = static_cast<int>(status);
+        while ((length > 0) && (_buffer[length - 1] == '\0')) length--;
+        _framer.append(_buffer, length);
+        processBytes("\n", 1);
+    }
+}
 
-        if ((nmeaMessage.Latitude != 0) && (nmeaMessage.Longitude != 0)) {
-            LOG_I(LOG_TAG, "Received GPS packet");
-            Q_EMIT gpsUpdate(nmeaMessage);
-        }
-        else {
-            LOG_W(LOG_TAG, "Received invalid GPS message on server port");
+void GpsServer::udpSocketError(QAbstractSocket::SocketError err) {
+    Q_EMIT connectionError(err);
+    LOG_E(LOG_TAG, "Server Error: " + _udpSocket->errorString());
+    scheduleReset();
+}
+
+void GpsServer::serialReadyRead() {
+    while (_serialFd >= 0) {
+        ssize_t status = ::read(_serialFd, _buffer, sizeof(_buffer));
+        if (status > 0) {
+            processBytes(_buffer, static_cast<int>(status));
+            continue;
         }
+        if ((status < 0) && (errno == EINTR)) continue;
+        if ((status < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) return;
+
+        // EOF or EIO, the receiver was most likely unplugged
+        LOG_E(LOG_TAG, "Lost serial port " + _serialDevice + ": " + (status < 0 ? QString(strerror(errno)) : QString("end of file")));
+        closeSerialPort();
+        scheduleReset();
+        return;
     }
 }
 
-void GpsServer::socketError(QAbstractSocket::SocketError err) {
+void GpsServer::gpsdConnected() {
+    LOG_I(LOG_TAG, "Connected to gpsd");
+    // Ask for the receiver's raw NMEA, gpsd's own JSON reports are skipped by the framer
+    _gpsdSocket->write("?WATCH={\"enable\":true,\"nmea\":true};\n");
+    configureReceiver();
+}
+
+void GpsServer::gpsdReadyRead() {
+    while (_gpsdSocket->bytesAvailable() > 0) {
+        qint64 status = _gpsdSocket->read(_buffer, sizeof(_buffer));
+        if (status <= 0) return;
+        processBytes(_buffer, static_cast<int>(status));
+    }
+}
+
+void GpsServer::gpsdError(QAbstractSocket::SocketError err) {
     Q_EMIT connectionError(err);
-    LOG_E(LOG_TAG, "Server Error: " + _socket->errorString());
-    START_TIMER(_resetConnectionTimerId, RECOVERY_DELAY);
+    LOG_E(LOG_TAG, "gpsd error: " + _gpsdSocket->errorString());
+    scheduleReset();
+}
+
+void GpsServer::processBytes(const char *data, int length) {
+    _framer.append(data, length);
+
+    // Only the newest fix in a read is worth parsing, older ones are already out of date
+    QByteArray sentence;
+    QByteArray gga;
+    while (_framer.next(&sentence)) {
+        // Sentence type after the $ and the two character talker ID, e.g. $GPGGA or $GNGGA
+        QByteArray type = sentence.mid(3, 3);
+        if (type == "GGA") {
+            gga = sentence;
+        }
+        else if (type == "VTG") {
+            _lastVtg = sentence;
+        }
+    }
+    if (gga.isEmpty()) return;
+
+    // Fix quality is the 6th field, 0 means the receiver has no fix
+    QByteArray fixQuality = gga.split(',').value(6);
+    NmeaMessage nmeaMessage(QString::fromLatin1(gga + "\n" + _lastVtg));
+    if (!fixQuality.isEmpty() && (fixQuality != "0") && (nmeaMessage.Latitude != 0) && (nmeaMessage.Longitude != 0)) {
+        LOG_D(LOG_TAG, "Received GPS fix");
+        Q_EMIT gpsUpdate(nmeaMessage);
+    }
+    else {
+        LOG_D(LOG_TAG, "Received GPS sentence without a fix");
+    }
+}
+
+void GpsServer::configureReceiver() {
+    if ((_source == GpsdSource) && _gpsdSocket && (_gpsdSocket->state() == QAbstractSocket::ConnectedState)) {
+        // gpsd knows how to set the fix rate on any receiver it has a driver for
+        _gpsdSocket->write("?DEVICE={\"cycle\":" + QByteArray::number(1.0 / _fixRate, 'f', 3) + "};\n");
+        return;
+    }
+    if ((_source != SerialSource) || (_serialFd < 0)) return;
+
+    switch (_receiverType) {
+    case MtkReceiver:
+        // Only GGA and VTG every fix, then the fix interval in milliseconds
+        writeToReceiver(NmeaFramer::checksummed("$PMTK314,0,0,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0"));
+        writeToReceiver(NmeaFramer::checksummed("$PMTK220," + QByteArray::number(1000 / _fixRate)));
+        break;
+    case UbloxReceiver: {
+        // GGA and VTG are on by default, turn off everything else that is
+        for (const char *type : { "GLL", "GSA", "GSV", "RMC" }) {
+            writeToReceiver(NmeaFramer::checksummed(QByteArray("$PUBX,40,") + type + ",0,0,0,0,0,0"));
+        }
+        // UBX CFG-RATE: measurement interval in milliseconds, one fix per measurement, aligned to GPS time
+        quint16 interval = static_cast<quint16>(1000 / _fixRate);
+        QByteArray ubx;
+        ubx.append('\x06').append('\x08').append('\x06').append('\x00');
+        ubx.append(static_cast<char>(interval & 0xFF)).append(static_cast<char>(interval >> 8));
+        ubx.append('\x01').append('\x00').append('\x01').append('\x00');
+        quint8 checksumA = 0, checksumB = 0;
+        for (char byte : ubx) {
+            checksumA += static_cast<quint8>(byte);
+            checksumB += checksumA;
+        }
+        ubx.prepend("\xB5\x62", 2);
+        ubx.append(static_cast<char>(checksumA)).append(static_cast<char>(checksumB));
+        writeToReceiver(ubx);
+        break;
+    }
+    default:
+        return;
+    }
+    LOG_I(LOG_TAG, "Asked the receiver for " + QString::number(_fixRate) + " fixes per second");
+    // Each byte takes 10 bits on the wire with its start and stop bits
+    if (_fixRate * BYTES_PER_FIX * 10 > _serialBaudRate) {
+        LOG_W(LOG_TAG, QString::number(_serialBaudRate) + " baud is too slow for " + QString::number(_fixRate)
+              + " fixes per second, set the receiver and gps_serial_baud to a faster rate");
+    }
+}
+
+void GpsServer::writeToReceiver(const QByteArray& data) {
+    if (::write(_serialFd, data.constData(), data.size()) != data.size()) {
+        LOG_W(LOG_TAG, "Could not write configuration to the receiver: " + QString(strerror(errno)));
+    }
+}
+
+bool GpsServer::openSerialPort() {
+    speed_t speed;
+    switch (_serialBaudRate) {
+    case 4800: speed = B4800; break;
+    case 9600: speed = B9600; break;
+    case 19200: speed = B19200; break;
+    case 38400: speed = B38400; break;
+    case 57600: speed = B57600; break;
+    case 115200: speed = B115200; break;
+    case 230400: speed = B230400; break;
+    default:
+        LOG_E(LOG_TAG, "Unsupported serial baud rate " + QString::number(_serialBaudRate));
+        return false;
+    }
+
+    _serialFd = ::open(_serialDevice.toLocal8Bit().constData(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (_serialFd < 0) {
+        LOG_E(LOG_TAG, "Cannot open serial port " + _serialDevice + ": " + QString(strerror(errno)));
+        return false;
+    }
+    struct termios tty;
+    if (tcgetattr(_serialFd, &tty) != 0) {
+        LOG_E(LOG_TAG, _serialDevice + " is not a serial port: " + QString(strerror(errno)));
+        closeSerialPort();
+        return false;
+    }
+    // Raw 8N1 without flow control, reads return whatever has arrived
+    cfmakeraw(&tty);
+    tty.c_cflag |= CLOCAL | CREAD;
+    tty.c_cflag &= ~(CSTOPB | CRTSCTS);
+    tty.c_cc[VMIN] = 0;
+    tty.c_cc[VTIME] = 0;
+    cfsetispeed(&tty, speed);
+    cfsetospeed(&tty, speed);
+    if (tcsetattr(_serialFd, TCSANOW, &tty) != 0) {
+        LOG_E(LOG_TAG, "Cannot configure serial port " + _serialDevice + ": " + QString(strerror(errno)));
+        closeSerialPort();
+        return false;
+    }
+    tcflush(_serialFd, TCIFLUSH);
+
+    _serialNotifier = new QSocketNotifier(_serialFd, QSocketNotifier::Read, this);
+    connect(_serialNotifier, &QSocketNotifier::activated, this, &GpsServer::serialReadyRead);
+    LOG_I(LOG_TAG, "Opened serial port " + _serialDevice);
+    return true;
+}
+
+void GpsServer::closeSerialPort() {
+    if (_serialNotifier) {
+        _serialNotifier->setEnabled(false);
+        _serialNotifier->deleteLater();
+        _serialNotifier = nullptr;
+    }
+    if (_serialFd >= 0) {
+        ::close(_serialFd);
+        _serialFd = -1;
+    }
+}
+
+void GpsServer::scheduleReset() {
+    START_TIMER(_resetConnectionTimerId, _source == UdpSource ? RECOVERY_DELAY : DEVICE_RECOVERY_DELAY);
 }
 
 void GpsServer::resetConnection() {
-    _socket->abort();
-    _socket->bind(_hostAddress.host, _hostAddress.port);
-    _socket->open(QIODevice::ReadWrite);
+    // Whatever was half received belongs to the old connection
+    _framer.clear();
+    _lastVtg.clear();
+    switch (_source) {
+    case UdpSource:
+        _udpSocket->abort();
+        _udpSocket->bind(_address.host, _address.port);
+        _udpSocket->open(QIODevice::ReadWrite);
+        break;
+    case SerialSource:
+        closeSerialPort();
+        if (openSerialPort()) {
+            configureReceiver();
+        }
+        else {
+            scheduleReset();
+        }
+        break;
+    case GpsdSource:
+        _gpsdSocket->abort();
+        _gpsdSocket->connectToHost(_address.host, _address.port);
+        break;
+    default:
+        break;
+    }
 }
 
 void GpsServer::timerEvent(QTimerEvent *e) {
     QObject::timerEvent(e);
     if (e->timerId() == _resetConnectionTimerId) {
-        resetConnection();
         KILL_TIMER(_resetConnectionTimerId);
+        resetConnection();
     }
 }
 
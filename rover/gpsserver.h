@@ -4,36 +4,102 @@
 #include <QtCore>
 #include <QObject>
 #include <QUdpSocket>
+#include <QTcpSocket>
+#include <QSocketNotifier>
 
 #include "soro_core/constants.h"
 #include "soro_core/socketaddress.h"
 #include "soro_core/nmeamessage.h"
-#include "soro_core/constants.h"
+#include "soro_core/nmeaframer.h"
 
 namespace Soro {
 
-/* Listens for NMEA formatted GPS messages on a UDP socket
+/* Receives NMEA formatted GPS fixes from one of:
+ * - a UDP socket, for a device that forwards the receiver's sentences
+ * - a serial port the receiver is plugged into
+ * - gpsd, which owns the receiver and passes its sentences on
+ *
+ * Sentences are framed from the byte stream, so they can arrive split across reads. A fix is
+ * emitted for every GGA sentence, with the course and speed from the most recent VTG sentence.
+ *
+ * On a serial port, the receiver can be told to report at a higher fix rate and to only send
+ * GGA and VTG sentences, which it needs to fit 10 fixes a second through a slow port. Through
+ * gpsd, the fix rate is asked of gpsd and it configures the receiver.
  */
 class GpsServer : public QObject {
     Q_OBJECT
 public:
-    explicit GpsServer(SocketAddress hostAddress, QObject *parent = nullptr);
+    enum ReceiverType {
+        /* Leave the receiver as it is
+         */
+        GenericReceiver,
+        /* MediaTek chipsets (PMTK commands), used by most small GPS breakouts
+         */
+        MtkReceiver,
+        /* u-blox chipsets (UBX and PUBX commands)
+         */
+        UbloxReceiver
+    };
+
+    explicit GpsServer(QObject *parent = nullptr);
     ~GpsServer();
 
+    void listenUdp(SocketAddress hostAddress);
+    void openSerial(const QString& device, int baudRate);
+    void connectGpsd(SocketAddress gpsdAddress);
+    void close();
+
+    /* Sets the receiver type and the fixes per second to ask it for, which is sent to the
+     * receiver (or gpsd) right away and again whenever the connection to it is reopened
+     */
+    void setReceiver(ReceiverType type, int fixRate);
+
+    /* Parses a receiver type as written in configuration files (generic, mtk or ublox),
+     * returning false for anything else
+     */
+    static bool parseReceiverType(const QString& name, ReceiverType *type);
+
+    quint64 getDroppedSentenceCount() const;
+
 private:
-    QUdpSocket *_socket;
+    enum Source {
+        NoSource, UdpSource, SerialSource, GpsdSource
+    };
+
+    Source _source = NoSource;
+    QUdpSocket *_udpSocket = nullptr;
+    QTcpSocket *_gpsdSocket = nullptr;
+    int _serialFd = -1;
+    QSocketNotifier *_serialNotifier = nullptr;
+    SocketAddress _address;
+    QString _serialDevice;
+    int _serialBaudRate = 0;
+    ReceiverType _receiverType = GenericReceiver;
+    int _fixRate = 1;
+    NmeaFramer _framer;
+    QByteArray _lastVtg;
     char _buffer[1024];
-    void resetConnection();
-    SocketAddress _hostAddress;
     int _resetConnectionTimerId = TIMER_INACTIVE;
 
+    void resetConnection();
+    void scheduleReset();
+    bool openSerialPort();
+    void closeSerialPort();
+    void configureReceiver();
+    void writeToReceiver(const QByteArray& data);
+    void processBytes(const char *data, int length);
+
 Q_SIGNALS:
     void connectionError(QAbstractSocket::SocketError err);
     void gpsUpdate(NmeaMessage update);
 
 private Q_SLOTS:
-    void socketReadyRead();
-    void socketError(QAbstractSocket::SocketError err);
+    void udpSocketReadyRead();
+    void udpSocketError(QAbstractSocket::SocketError err);
+    void serialReadyRead();
+    void gpsdConnected();
+    void gpsdReadyRead();
+    void gpsdError(QAbstractSocket::SocketError err);
 
 protected:
     void timerEvent(QTimerEvent *e);
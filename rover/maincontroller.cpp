@@ -16,11 +16,21 @@
 
 #include "maincontroller.h"
 #include "soro_core/logger.h"
-#include "soro_core/confloader.h"
+#include "soro_core/tracer.h"
+#include "soro_core/memorybudget.h"
+#include "soro_core/executor.h"
+#include "soro_core/clock.h"
 #include "usbcameraenumerator.h"
 
 #define LOG_TAG "ResearchRover"
 
+// Telemetry queued on the main channel for longer than this is dropped instead of sent
+#define DEFAULT_MAIN_CHANNEL_SEND_DEADLINE 3000
+#define DEFAULT_DATA_RECORD_INTERVAL 50
+#define DEFAULT_RESOURCE_SAMPLE_INTERVAL 2000
+#define DEFAULT_EVENT_LOOP_STALL_THRESHOLD 250
+#define DEFAULT_GOVERNOR_INTERVAL 2000
+
 namespace Soro {
 
 MainController *MainController::_self = nullptr;
@@ -53,159 +63,516 @@ void MainController::init(QCoreApplication *app)
                                              + "/../log/ResearchRover_" + QDateTime::currentDateTime().toString("M-dd_h.mm.ss_AP") + ".log");
             Logger::rootLogger()->setMaxFileLevel(Logger::LogLevelDebug);
             Logger::rootLogger()->setMaxStdoutLevel(Logger::LogLevelInformation);
+            Tracer::root()->setDumpDirectory(QCoreApplication::applicationDirPath() + "/../log", "ResearchRover");
+            Tracer::root()->installSignalHandler();
+            connect(Tracer::root(), &Tracer::dumpRequested, _self, []()
+            {
+                Tracer::root()->dump("requested");
+            });
+
+            // Each subsystem is a task that runs once the ones it uses are ready, so camera
+            // enumeration (which waits on udevadm) overlaps with everything else
+            _self->_startup = new StartupGraph("ResearchRoverStartup", _self);
+
+            _self->_startup->addTask("config", []()
+            {
+                _self->_config = new LiveConfig(_self);
+                _self->_config->define("data_record_interval", LiveConfig::IntType, DEFAULT_DATA_RECORD_INTERVAL);
+                _self->_config->setRange("data_record_interval", 10, 1000);
+                _self->_config->define("main_send_deadline", LiveConfig::IntType, DEFAULT_MAIN_CHANNEL_SEND_DEADLINE);
+                _self->_config->setRange("main_send_deadline", 0, 60000);
+                _self->_config->define("drive_degraded_phi", LiveConfig::DoubleType, 3.0);
+                _self->_config->setRange("drive_degraded_phi", 0.5, 50);
+                _self->_config->define("drive_failed_phi", LiveConfig::DoubleType, 8.0);
+                _self->_config->setRange("drive_failed_phi", 0.5, 50);
+                _self->_config->define("drive_reorder_delay", LiveConfig::IntType, 0);
+                _self->_config->setRange("drive_reorder_delay", 0, 1000);
+                _self->_config->define("drive_reorder_packets", LiveConfig::IntType, 8);
+                _self->_config->setRange("drive_reorder_packets", 1, 256);
+                _self->_config->define("bind_address", LiveConfig::IPType, "0.0.0.0", false);
+                _self->_config->define("local_transport", LiveConfig::StringType, "", false);
+                _self->_config->define("resource_sample_interval", LiveConfig::IntType, DEFAULT_RESOURCE_SAMPLE_INTERVAL);
+                _self->_config->setRange("resource_sample_interval", 500, 60000);
+                _self->_config->define("event_loop_stall_threshold", LiveConfig::IntType, DEFAULT_EVENT_LOOP_STALL_THRESHOLD);
+                _self->_config->setRange("event_loop_stall_threshold", 20, 10000);
+                _self->_config->define("event_loop_stack_samples", LiveConfig::BoolType, false);
+                _self->_config->define("sched_main", LiveConfig::StringType, "");
+                _self->_config->define("sched_video_streamer", LiveConfig::StringType, "");
+                _self->_config->define("sched_video_streaming_threads", LiveConfig::StringType, "");
+                _self->_config->define("sched_audio_streamer", LiveConfig::StringType, "");
+                _self->_config->define("sched_audio_streaming_threads", LiveConfig::StringType, "");
+                _self->_config->define("sched_executor", LiveConfig::StringType, "");
+                _self->_config->define("executor_threads", LiveConfig::IntType, 0, false);
+                _self->_config->setRange("executor_threads", 0, 64);
+                _self->_config->define("governor_enabled", LiveConfig::BoolType, true);
+                _self->_config->define("governor_interval", LiveConfig::IntType, DEFAULT_GOVERNOR_INTERVAL);
+                _self->_config->setRange("governor_interval", 500, 60000);
+                _self->_config->define("governor_throttle_temp", LiveConfig::IntType, 0);
+                _self->_config->setRange("governor_throttle_temp", 0, 150);
+                _self->_config->define("governor_margin", LiveConfig::IntType, 10);
+                _self->_config->setRange("governor_margin", 0, 50);
+                _self->_config->define("governor_hysteresis", LiveConfig::IntType, 5);
+                _self->_config->setRange("governor_hysteresis", 0, 50);
+                _self->_config->define("governor_max_load", LiveConfig::IntType, 95);
+                _self->_config->setRange("governor_max_load", 0, 100);
+                _self->_config->define("governor_max_deficit", LiveConfig::IntType, 20);
+                _self->_config->setRange("governor_max_deficit", 0, 100);
+                _self->_config->define("governor_step_down_delay", LiveConfig::IntType, 15000);
+                _self->_config->setRange("governor_step_down_delay", 0, 600000);
+                _self->_config->define("governor_step_up_delay", LiveConfig::IntType, 30000);
+                _self->_config->setRange("governor_step_up_delay", 0, 600000);
+                _self->_config->define("governor_thermal_path", LiveConfig::StringType, "/sys/class/thermal", false);
+                _self->_config->define("governor_stat_path", LiveConfig::StringType, "/proc/stat", false);
+                _self->_config->define("gps_source", LiveConfig::StringType, "udp", false);
+                _self->_config->define("gps_serial_device", LiveConfig::StringType, "/dev/ttyUSB0", false);
+                _self->_config->define("gps_serial_baud", LiveConfig::IntType, 9600, false);
+                _self->_config->define("gps_gpsd_address", LiveConfig::IPType, "127.0.0.1", false);
+                _self->_config->define("gps_gpsd_port", LiveConfig::IntType, 2947, false);
+                _self->_config->setRange("gps_gpsd_port", 1, 65535);
+                _self->_config->define("gps_receiver", LiveConfig::StringType, "generic");
+                _self->_config->define("gps_fix_rate", LiveConfig::IntType, 1);
+                _self->_config->setRange("gps_fix_rate", 1, 10);
+                _self->_config->define("estimator_enabled", LiveConfig::BoolType, true);
+                _self->_config->define("estimator_rate", LiveConfig::IntType, 20);
+                _self->_config->setRange("estimator_rate", 1, 50);
+                _self->_config->define("estimator_max_speed", LiveConfig::DoubleType, 1.0);
+                _self->_config->setRange("estimator_max_speed", 0.1, 10);
+                _self->_config->define("estimator_yaw_offset", LiveConfig::DoubleType, 0.0);
+                _self->_config->setRange("estimator_yaw_offset", -360, 360);
+                _self->_config->define("estimator_gps_gain", LiveConfig::DoubleType, 0.3);
+                _self->_config->setRange("estimator_gps_gain", 0, 1);
+                if (!_self->_config->load(QCoreApplication::applicationDirPath() + "/../config/research_rover.conf")) {
+                    panic(LOG_TAG, "Cannot load ../config/research_rover.conf: " + _self->_config->getError());
+                }
+                for (const QString& key : _self->_config->keys()) {
+                    MemoryBudgetRegistry::root()->applyConfigValue(key, _self->_config->value(key));
+                }
+                // Before anything else starts a thread, so they all inherit the main thread's cores
+                _self->schedulingPolicy("sched_main").applyToCurrentThread("main thread");
+                // Nothing is posted to the executor before this, so its workers start with these
+                Executor::root()->setThreadCount(_self->_config->valueAsInt("executor_threads"));
+                Executor::root()->setSchedulingPolicy(_self->schedulingPolicy("sched_executor"));
+            });
+
+            _self->_startup->addTask("channels", []()
+            {
+                QString localTransport = _self->_config->valueAsString("local_transport");
+                if (localTransport.isEmpty()) {
+                    QHostAddress bindAddress = _self->_config->valueAsIP("bind_address");
+                    _self->_driveChannel = Channel::createServer(_self, NETWORK_ALL_DRIVE_CHANNEL_PORT, CHANNEL_NAME_DRIVE,
+                                              Channel::UdpProtocol, bindAddress);
+                    _self->_mainChannel = Channel::createServer(_self, NETWORK_ALL_MAIN_CHANNEL_PORT, CHANNEL_NAME_MAIN,
+                                              Channel::TcpProtocol, bindAddress);
+                }
+                else {
+                    QString driveAddress = ChannelTransport::localAddress(localTransport, CHANNEL_NAME_DRIVE, false);
+                    QString mainAddress = ChannelTransport::localAddress(localTransport, CHANNEL_NAME_MAIN, true);
+                    if (driveAddress.isEmpty()) {
+                        panic(LOG_TAG, "Invalid value specified for local_transport in research_rover.conf");
+                    }
+                    LOG_I(LOG_TAG, "Serving the drive channel on " + driveAddress + " and the main channel on " + mainAddress);
+                    _self->_driveChannel = Channel::createServer(_self, driveAddress, CHANNEL_NAME_DRIVE);
+                    _self->_mainChannel = Channel::createServer(_self, mainAddress, CHANNEL_NAME_MAIN);
+                }
 
-            LOG_I(LOG_TAG, "*************Initializing core networking*****************");
+                _self->_mainChannel->setSendQueueDeadline(_self->_config->valueAsInt("main_send_deadline"));
+                _self->_driveChannel->setFailureDetectorThresholds(_self->_config->valueAsDouble("drive_degraded_phi"),
+                                                                   _self->_config->valueAsDouble("drive_failed_phi"));
+                // Mission control may reach the drive channel over several interfaces at once
+                _self->_driveChannel->setUdpMultipath(true);
+                _self->_driveChannel->setUdpDuplicateMessages(true);
+                _self->applyDriveReorderConfig();
 
-            _self->_driveChannel = Channel::createServer(_self, NETWORK_ALL_DRIVE_CHANNEL_PORT, CHANNEL_NAME_DRIVE,
-                                      Channel::UdpProtocol, QHostAddress::Any);
-            _self->_mainChannel = Channel::createServer(_self, NETWORK_ALL_MAIN_CHANNEL_PORT, CHANNEL_NAME_MAIN,
-                                      Channel::TcpProtocol, QHostAddress::Any);
+                if (_self->_driveChannel->getState() == Channel::ErrorState) {
+                    panic(LOG_TAG, "The drive channel experienced a fatal error during initialization");
+                }
+                if (_self->_mainChannel->getState() == Channel::ErrorState) {
+                    panic(LOG_TAG, "The shared channel experienced a fatal error during initialization");
+                }
+            }, QStringList() << "config");
+
+            _self->_startup->addTask("mbed", []()
+            {
+                _self->_mbed = new MbedChannel(SocketAddress(QHostAddress::Any, NETWORK_ROVER_MBED_PORT), MBED_ID, _self);
+            });
+
+            _self->_startup->addTask("gps", []()
+            {
+                _self->_gpsServer = new GpsServer(_self);
+                QString source = _self->_config->valueAsString("gps_source");
+                if (source == "serial") {
+                    _self->_gpsServer->openSerial(_self->_config->valueAsString("gps_serial_device"),
+                                                  _self->_config->valueAsInt("gps_serial_baud"));
+                }
+                else if (source == "gpsd") {
+                    _self->_gpsServer->connectGpsd(SocketAddress(_self->_config->valueAsIP("gps_gpsd_address"),
+                                                                 _self->_config->valueAsInt("gps_gpsd_port")));
+                }
+                else {
+                    if (source != "udp") {
+                        LOG_W(LOG_TAG, "Unknown gps_source " + source + ", listening for GPS on UDP");
+                    }
+                    _self->_gpsServer->listenUdp(SocketAddress(QHostAddress::Any, NETWORK_ROVER_GPS_PORT));
+                }
+                _self->applyGpsReceiverConfig();
+            }, QStringList() << "config");
+
+            _self->_startup->addTask("cameraEnumeration", []()
+            {
+                // Only touches _cameras, which nothing else uses until this is done
+                _self->_cameras = new UsbCameraEnumerator;
+                _self->_cameras->loadCameras();
+            }, QStringList(), StartupGraph::WorkerThread);
+
+            _self->_startup->addTask("cameras", []()
+            {
+                _self->_cameraConfig = new LiveConfig(_self);
+                if (!_self->_cameraConfig->load(QCoreApplication::applicationDirPath() + "/../config/research_cameras.conf")) {
+                    panic(LOG_TAG, "Cannot load ../config/research_cameras.conf: " + _self->_cameraConfig->getError());
+                }
+                _self->matchCameras();
+
+                // Camera definitions are matched again whenever they are edited, the new
+                // devices are used the next time a stream is started
+                connect(_self->_cameraConfig, &LiveConfig::reloaded, _self, []()
+                {
+                    // udevadm can take a while, so the cameras are enumerated on a worker and
+                    // only swapped in on the main thread
+                    Executor::root()->post([]()
+                    {
+                        UsbCameraEnumerator *cameras = new UsbCameraEnumerator;
+                        cameras->loadCameras();
+                        return cameras;
+                    }, _self, [](UsbCameraEnumerator *cameras)
+                    {
+                        delete _self->_cameras;
+                        _self->_cameras = cameras;
+                        _self->matchCameras();
+                    });
+                });
+            }, QStringList() << "cameraEnumeration");
+
+            _self->_startup->addTask("video", []()
+            {
+                QHostAddress bindAddress = _self->_config->valueAsIP("bind_address");
+                _self->_mainCameraServer = new VideoServer(MEDIAID_MAIN_CAMERA, SocketAddress(bindAddress, NETWORK_ALL_MAIN_CAMERA_PORT), _self);
+                _self->_aux1CameraServer = new VideoServer(MEDIAID_AUX1_CAMERA, SocketAddress(bindAddress, NETWORK_ALL_AUX1_CAMERA_PORT), _self);
+            }, QStringList() << "config");
+
+            _self->_startup->addTask("audio", []()
+            {
+                _self->_audioServer = new AudioServer(MEDIAID_AUDIO, SocketAddress(_self->_config->valueAsIP("bind_address"), NETWORK_ALL_AUDIO_PORT), _self);
+            }, QStringList() << "config");
+
+            _self->_startup->addTask("estimator", []()
+            {
+                // The estimator needs IMU yaw whether or not anything is being recorded
+                _self->_sensorDataSeries = new SensorDataParser(_self);
+                connect(_self->_mbed, &MbedChannel::messageReceived, _self->_sensorDataSeries, &SensorDataParser::newData);
+
+                _self->_poseEstimator = new PoseEstimator(_self);
+                connect(_self->_gpsServer, &GpsServer::gpsUpdate, _self->_poseEstimator, &PoseEstimator::gpsUpdate);
+                // The middle IMU sits on the body, the front and rear ones move with the suspension
+                const SensorDefinition *yaw = SensorTable::find(SensorDataParser::DATATAG_IMUDATA_MIDDLE_YAW);
+                connect(_self->_sensorDataSeries, &SensorDataParser::dataParsed, _self, [yaw](char tag, int value)
+                {
+                    if (tag == yaw->tag) {
+                        _self->_poseEstimator->yawUpdate(yaw->toUnits(value));
+                    }
+                });
+                connect(_self->_poseEstimator, &PoseEstimator::poseUpdated, _self, &MainController::poseUpdated);
+                _self->applyPoseEstimatorConfig();
+            }, QStringList() << "config" << "gps" << "mbed");
+
+            // Nothing is recorded until mission control asks for it, so the recorder isn't
+            // built until then
+            _self->_startup->addLazyTask("recorder", []()
+            {
+                _self->_gpsDataSeries = new GpsCsvSeries(_self);
+                _self->_poseDataSeries = new PoseCsvSeries(_self);
+                _self->_wheelSpeedLMDataSeries = new WheelSpeedCsvSeries(DriveMessage::Index_LeftMiddle, _self);
+                _self->_wheelSpeedLODataSeries = new WheelSpeedCsvSeries(DriveMessage::Index_LeftOuter, _self);
+                _self->_wheelSpeedRMDataSeries = new WheelSpeedCsvSeries(DriveMessage::Index_RightMiddle, _self);
+                _self->_wheelSpeedRODataSeries = new WheelSpeedCsvSeries(DriveMessage::Index_RightOuter, _self);
+                _self->_dataRecorder = new CsvRecorder("data", _self);
+
+                _self->_dataRecorder->setUpdateInterval(_self->_config->valueAsInt("data_record_interval"));
+                _self->_sensorDataSeries->addColumns(_self->_dataRecorder);
+                _self->_dataRecorder->addColumn(_self->_wheelSpeedLODataSeries);
+                _self->_dataRecorder->addColumn(_self->_wheelSpeedLMDataSeries);
+                _self->_dataRecorder->addColumn(_self->_wheelSpeedRODataSeries);
+                _self->_dataRecorder->addColumn(_self->_wheelSpeedRMDataSeries);
+                _self->_dataRecorder->addColumn(_self->_gpsDataSeries->getLatitudeSeries());
+                _self->_dataRecorder->addColumn(_self->_gpsDataSeries->getLongitudeSeries());
+                _self->_dataRecorder->addColumn(_self->_poseDataSeries->getLatitudeSeries());
+                _self->_dataRecorder->addColumn(_self->_poseDataSeries->getLongitudeSeries());
+                _self->_dataRecorder->addColumn(_self->_poseDataSeries->getHeadingSeries());
+                _self->_dataRecorder->addColumn(_self->_poseDataSeries->getSpeedSeries());
+                _self->_dataRecorder->addColumn(_self->_poseDataSeries->getAccuracySeries());
+                connect(_self->_gpsServer, &GpsServer::gpsUpdate, _self->_gpsDataSeries, &GpsCsvSeries::addLocation);
+                connect(_self->_poseEstimator, &PoseEstimator::poseUpdated, _self->_poseDataSeries, &PoseCsvSeries::update);
+            }, QStringList() << "config" << "gps" << "mbed" << "estimator");
+
+            // Observers are only connected once everything they use exists, and the channels are
+            // opened last so mission control can't reach a half initialized rover (a stream request
+            // needs the cameras matched, for one)
+            _self->_startup->addTask("network", []()
+            {
+                // observers for network channel connectivity changes
+                connect(_self->_mainChannel, &Channel::stateChanged, _self, &MainController::mainChannelStateChanged);
+                connect(_self->_driveChannel, &Channel::stateChanged, _self, &MainController::driveChannelStateChanged);
+                connect(_self->_driveChannel, &Channel::degradedChanged, _self, &MainController::driveChannelDegradedChanged);
+
+                // observers for mbed events
+                connect(_self->_mbed, &MbedChannel::messageReceived, _self, &MainController::mbedMessageReceived);
+                connect(_self->_mbed, &MbedChannel::stateChanged, _self, &MainController::mbedChannelStateChanged);
+                connect(_self->_mbed, &MbedChannel::rttChanged, _self, &MainController::mbedRttChanged);
+
+                // observers for network channels message received
+                connect(_self->_driveChannel, &Channel::messageReceived, _self, &MainController::driveChannelMessageReceived);
+                connect(_self->_mainChannel, &Channel::messageReceived, _self, &MainController::mainChannelMessageReceived);
+
+                connect(_self->_gpsServer, &GpsServer::gpsUpdate, _self, &MainController::gpsUpdate);
+                connect(_self->_mainCameraServer, &VideoServer::error, _self, &MainController::mediaServerError);
+                connect(_self->_aux1CameraServer, &VideoServer::error, _self, &MainController::mediaServerError);
+                connect(_self->_audioServer, &AudioServer::error, _self, &MainController::mediaServerError);
+
+                connect(_self->_config, &LiveConfig::valueChanged, _self, &MainController::configValueChanged);
+                _self->applyStreamerSchedulingPolicies();
+
+                _self->_eventLoopMonitor = new EventLoopMonitor(_self);
+                _self->_eventLoopMonitor->setStallThreshold(_self->_config->valueAsInt("event_loop_stall_threshold"));
+                _self->_eventLoopMonitor->setStackSamplingEnabled(_self->_config->valueAsBool("event_loop_stack_samples"));
+                connect(_self->_eventLoopMonitor, &EventLoopMonitor::stalled, _self, []()
+                {
+                    Tracer::root()->dumpOnAnomaly("event_loop_stall");
+                });
+                _self->_eventLoopMonitor->start();
+
+                _self->_resourceMonitor = new ResourceMonitor(_self);
+                _self->_resourceMonitor->setEventLoopMonitor(_self->_eventLoopMonitor);
+                connect(_self->_resourceMonitor, &ResourceMonitor::sampled, _self, &MainController::resourcesSampled);
+                _self->_resourceMonitor->start(_self->_config->valueAsInt("resource_sample_interval"));
+
+                _self->_videoGovernor = new VideoGovernor(_self);
+                _self->_videoGovernor->setThermalPath(_self->_config->valueAsString("governor_thermal_path"));
+                _self->_videoGovernor->setCpuStatPath(_self->_config->valueAsString("governor_stat_path"));
+                _self->applyVideoGovernorConfig();
+                connect(_self->_videoGovernor, &VideoGovernor::sampled, _self, &MainController::videoGovernorSampled);
+                connect(_self->_videoGovernor, &VideoGovernor::levelChanged, _self, &MainController::videoGovernorLevelChanged);
+                for (VideoServer *server : QList<VideoServer*>() << _self->_mainCameraServer << _self->_aux1CameraServer) {
+                    connect(server, &VideoServer::frameDeficitUpdated, _self, [](MediaServer *source, int percent)
+                    {
+                        _self->_videoGovernor->reportFrameDeficit(source->getMediaId(), percent);
+                    });
+                }
+                if (_self->_config->valueAsBool("governor_enabled")) {
+                    _self->_videoGovernor->start(_self->_config->valueAsInt("governor_interval"));
+                }
 
-            if (_self->_driveChannel->getState() == Channel::ErrorState) {
-                panic(LOG_TAG, "The drive channel experienced a fatal error during initialization");
+                _self->_driveChannel->open();
+                _self->_mainChannel->open();
+                LOG_I(LOG_TAG, "All network channels opened");
+            }, QStringList() << "channels" << "mbed" << "gps" << "estimator" << "video" << "audio" << "cameras");
+
+            connect(_self->_startup, &StartupGraph::finished, _self, []()
+            {
+                LOG_I(LOG_TAG, "-------------------------------------------------------");
+                LOG_I(LOG_TAG, "-------------------------------------------------------");
+                LOG_I(LOG_TAG, "-------------------------------------------------------");
+                LOG_I(LOG_TAG, "Initialization complete");
+                LOG_I(LOG_TAG, "-------------------------------------------------------");
+                LOG_I(LOG_TAG, "-------------------------------------------------------");
+                LOG_I(LOG_TAG, "-------------------------------------------------------");
+                // Reads a few files for every thread, which is better left to a worker
+                qint32 pid = QCoreApplication::applicationPid();
+                Executor::root()->post([pid]()
+                {
+                    LOG_I(LOG_TAG, "Effective scheduling of each thread:\n" + SchedulingPolicy::describeProcess(pid));
+                }, Executor::LowPriority);
+            });
+
+            if (!_self->_startup->start()) {
+                panic(LOG_TAG, "The startup sequence is invalid");
             }
-            if (_self->_mainChannel->getState() == Channel::ErrorState) {
-                panic(LOG_TAG, "The shared channel experienced a fatal error during initialization");
-            }
-
-            _self->_driveChannel->open();
-            _self->_mainChannel->open();
-
-            // observers for network channel connectivity changes
-            connect(_self->_mainChannel, &Channel::stateChanged, _self, &MainController::mainChannelStateChanged);
-            connect(_self->_driveChannel, &Channel::stateChanged, _self, &MainController::driveChannelStateChanged);
-
-
-            LOG_I(LOG_TAG, "All network channels initialized successfully");
-
-            LOG_I(LOG_TAG, "*****************Initializing MBED systems*******************");
-
-            // create mbed channels
-            _self->_mbed = new MbedChannel(SocketAddress(QHostAddress::Any, NETWORK_ROVER_MBED_PORT), MBED_ID, _self);
-
-            // observers for mbed events
-            connect(_self->_mbed, &MbedChannel::messageReceived, _self, &MainController::mbedMessageReceived);
-            connect(_self->_mbed, &MbedChannel::stateChanged, _self, &MainController::mbedChannelStateChanged);
-
-            // observers for network channels message received
-            connect(_self->_driveChannel, &Channel::messageReceived, _self, &MainController::driveChannelMessageReceived);
-            connect(_self->_mainChannel, &Channel::messageReceived, _self, &MainController::mainChannelMessageReceived);
+        });
+    }
+}
 
-            LOG_I(LOG_TAG, "*****************Initializing GPS system*******************");
+void MainController::matchCameras() {
+    if (GStreamerUtil::useTestSources()) {
+        // Every camera streams a test pattern, the device names are never used
+        LOG_W(LOG_TAG, TEST_SOURCES_ENV " is set, using test sources instead of cameras");
+        _stereoRCameraDevice = "test";
+        _stereoLCameraDevice = "test";
+        _monoCameraDevice = "test";
+        _aux1CameraDevice = "test";
+        return;
+    }
 
-            _self->_gpsServer = new GpsServer(SocketAddress(QHostAddress::Any, NETWORK_ROVER_GPS_PORT), _self);
-            connect(_self->_gpsServer, &GpsServer::gpsUpdate, _self, &MainController::gpsUpdate);
+    const UsbCamera* stereoRight = _cameras->find(_cameraConfig->valueAsString("sr_matchName"),
+                                    _cameraConfig->valueAsString("sr_matchDevice"),
+                                    _cameraConfig->valueAsString("sr_matchVendorId"),
+                                    _cameraConfig->valueAsString("sr_matchProductId"),
+                                    _cameraConfig->valueAsString("sr_matchSerial"));
+
+    const UsbCamera* stereoLeft = _cameras->find(_cameraConfig->valueAsString("sl_matchName"),
+                                    _cameraConfig->valueAsString("sl_matchDevice"),
+                                    _cameraConfig->valueAsString("sl_matchVendorId"),
+                                    _cameraConfig->valueAsString("sl_matchProductId"),
+                                    _cameraConfig->valueAsString("sl_matchSerial"));
+
+    const UsbCamera* aux1 = _cameras->find(_cameraConfig->valueAsString("a1_matchName"),
+                                    _cameraConfig->valueAsString("a1_matchDevice"),
+                                    _cameraConfig->valueAsString("a1_matchVendorId"),
+                                    _cameraConfig->valueAsString("a1_matchProductId"),
+                                    _cameraConfig->valueAsString("a1_matchSerial"));
+
+    _stereoRCameraDevice.clear();
+    _stereoLCameraDevice.clear();
+    _monoCameraDevice.clear();
+    _aux1CameraDevice.clear();
+    if (stereoRight) {
+        _stereoRCameraDevice = stereoRight->device;
+        _stereoRCameraDevice.remove("/dev/");
+        _monoCameraDevice = _stereoRCameraDevice;
+        LOG_I(LOG_TAG, "Right stereo camera found: " + stereoRight->toString());
+    }
+    else {
+        LOG_E(LOG_TAG, "Right stereo camera couldn't be found using provided definition.");
+    }
+    if (stereoLeft) {
+        _stereoLCameraDevice = stereoLeft->device;
+        _stereoLCameraDevice.remove("/dev/");
+        if (!stereoRight) {
+            _monoCameraDevice = _stereoLCameraDevice;
+        }
+        LOG_I(LOG_TAG, "Left stereo camera found: " + stereoLeft->toString());
+    }
+    else {
+        LOG_E(LOG_TAG, "Left stereo camera couldn't be found using provided definition.");
+    }
+    if (aux1) {
+        _aux1CameraDevice = aux1->device;
+        _aux1CameraDevice.remove("/dev/");
+        LOG_I(LOG_TAG, "Aux1 camera found: " + aux1->toString());
+    }
+    else {
+        LOG_E(LOG_TAG, "Aux1 camera couldn't be found using provided definition.");
+    }
+}
 
-            LOG_I(LOG_TAG, "*****************Initializing Video system*******************");
+SchedulingPolicy MainController::schedulingPolicy(const QString& key) {
+    SchedulingPolicy policy;
+    QString error;
+    if (!SchedulingPolicy::parse(_config->valueAsString(key), &policy, &error)) {
+        LOG_E(LOG_TAG, "Ignoring " + key + ": " + error);
+    }
+    return policy;
+}
 
-            _self->_mainCameraServer = new VideoServer(MEDIAID_MAIN_CAMERA, NETWORK_ALL_MAIN_CAMERA_PORT, _self);
-            _self->_aux1CameraServer = new VideoServer(MEDIAID_AUX1_CAMERA, NETWORK_ALL_AUX1_CAMERA_PORT, _self);
+void MainController::applyStreamerSchedulingPolicies() {
+    SchedulingPolicy videoStreamer = schedulingPolicy("sched_video_streamer");
+    SchedulingPolicy videoStreamingThreads = schedulingPolicy("sched_video_streaming_threads");
+    _mainCameraServer->setSchedulingPolicies(videoStreamer, videoStreamingThreads);
+    _aux1CameraServer->setSchedulingPolicies(videoStreamer, videoStreamingThreads);
+    _audioServer->setSchedulingPolicies(schedulingPolicy("sched_audio_streamer"),
+                                        schedulingPolicy("sched_audio_streaming_threads"));
+}
 
-            connect(_self->_mainCameraServer, &VideoServer::error, _self, &MainController::mediaServerError);
-            connect(_self->_aux1CameraServer, &VideoServer::error, _self, &MainController::mediaServerError);
+void MainController::applyVideoGovernorConfig() {
+    _videoGovernor->setThrottleTemperature(_config->valueAsInt("governor_throttle_temp") * 1000);
+    _videoGovernor->setMargin(_config->valueAsInt("governor_margin") * 1000);
+    _videoGovernor->setHysteresis(_config->valueAsInt("governor_hysteresis") * 1000);
+    _videoGovernor->setMaxLoad(_config->valueAsInt("governor_max_load") * 10);
+    _videoGovernor->setMaxFrameDeficit(_config->valueAsInt("governor_max_deficit"));
+    _videoGovernor->setStepDownDelay(_config->valueAsInt("governor_step_down_delay"));
+    _videoGovernor->setStepUpDelay(_config->valueAsInt("governor_step_up_delay"));
+}
 
-            UsbCameraEnumerator cameras;
-            cameras.loadCameras();
+void MainController::applyGpsReceiverConfig() {
+    GpsServer::ReceiverType type;
+    if (!GpsServer::parseReceiverType(_config->valueAsString("gps_receiver"), &type)) {
+        LOG_W(LOG_TAG, "Unknown gps_receiver " + _config->valueAsString("gps_receiver") + ", leaving the receiver as it is");
+        type = GpsServer::GenericReceiver;
+    }
+    _gpsServer->setReceiver(type, _config->valueAsInt("gps_fix_rate"));
+}
 
-            QFile camFile(QCoreApplication::applicationDirPath() + "/../config/research_cameras.conf");
-            if (!camFile.exists()) {
-                panic(LOG_TAG, "The camera configuration file ../config/research_cameras.conf does not exist.");
-            }
-            else {
-                ConfLoader camConfig;
-                camConfig.load(camFile);
-
-                const UsbCamera* stereoRight = cameras.find(camConfig.value("sr_matchName"),
-                                                camConfig.value("sr_matchDevice"),
-                                                camConfig.value("sr_matchVendorId"),
-                                                camConfig.value("sr_matchProductId"),
-                                                camConfig.value("sr_matchSerial"));
-
-                const UsbCamera* stereoLeft = cameras.find(camConfig.value("sr_matchName"),
-                                                camConfig.value("sl_matchDevice"),
-                                                camConfig.value("sl_matchVendorId"),
-                                                camConfig.value("sl_matchProductId"),
-                                                camConfig.value("sl_matchSerial"));
-
-                const UsbCamera* aux1 = cameras.find(camConfig.value("a1_matchName"),
-                                                camConfig.value("a1_matchDevice"),
-                                                camConfig.value("a1_matchVendorId"),
-                                                camConfig.value("a1_matchProductId"),
-                                                camConfig.value("a1_matchSerial"));
-
-                if (stereoRight) {
-                    _self->_stereoRCameraDevice = stereoRight->device;
-                    _self->_stereoRCameraDevice.remove("/dev/");
-                    _self->_monoCameraDevice = _self->_stereoRCameraDevice;
-                    LOG_I(LOG_TAG, "Right stereo camera found: " + stereoRight->toString());
-                }
-                else {
-                    LOG_E(LOG_TAG, "Right stereo camera couldn't be found using provided definition.");
-                }
-                if (stereoLeft) {
-                    _self->_stereoLCameraDevice = stereoLeft->device;
-                    _self->_stereoLCameraDevice.remove("/dev/");
-                    if (!stereoRight) {
-                        _self->_monoCameraDevice = _self->_stereoLCameraDevice;
-                    }
-                    LOG_I(LOG_TAG, "Left stereo camera found: " + stereoLeft->toString());
-                }
-                else {
-                    LOG_E(LOG_TAG, "Left stereo camera couldn't be found using provided definition.");
-                }
-                if (aux1) {
-                    _self->_aux1CameraDevice = aux1->device;
-                    _self->_aux1CameraDevice.remove("/dev/");
-                    LOG_I(LOG_TAG, "Aux1 camera found: " + aux1->toString());
-                }
-                else {
-                    LOG_E(LOG_TAG, "Aux1 camera couldn't be found using provided definition.");
-                }
+void MainController::applyPoseEstimatorConfig() {
+    _poseEstimator->setMaxSpeed(_config->valueAsDouble("estimator_max_speed"));
+    _poseEstimator->setYawOffset(_config->valueAsDouble("estimator_yaw_offset"));
+    _poseEstimator->setGpsGain(_config->valueAsDouble("estimator_gps_gain"));
+    if (_config->valueAsBool("estimator_enabled")) {
+        _poseEstimator->start(1000 / _config->valueAsInt("estimator_rate"));
+    }
+    else {
+        _poseEstimator->stop();
+    }
+}
 
-            }
+void MainController::applyDriveReorderConfig() {
+    // A delay of 0 leaves the buffer off, so only the latest drive command is ever delivered
+    int delay = _config->valueAsInt("drive_reorder_delay");
+    _driveChannel->setUdpReorderBuffer(delay, delay > 0 ? _config->valueAsInt("drive_reorder_packets") : 0);
+}
 
-            LOG_I(LOG_TAG, "*****************Initializing Audio system*******************");
-
-            _self->_audioServer = new AudioServer(MEDIAID_AUDIO, NETWORK_ALL_AUDIO_PORT, _self);
-
-            connect(_self->_audioServer, &AudioServer::error, _self, &MainController::mediaServerError);
-
-            LOG_I(LOG_TAG, "*****************Initializing Data Recording System*******************");
-
-            _self->_sensorDataSeries = new SensorDataParser(_self);
-            _self->_gpsDataSeries = new GpsCsvSeries(_self);
-            _self->_dataRecorder = new CsvRecorder("data", _self);
-
-            _self->_dataRecorder->setUpdateInterval(50);
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getWheelPowerASeries());
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getWheelPowerBSeries());
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getWheelPowerCSeries());
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getWheelPowerDSeries());
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getWheelPowerESeries());
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getWheelPowerFSeries());
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getImuRearYawSeries());
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getImuRearPitchSeries());
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getImuRearRollSeries());
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getImuFrontYawSeries());
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getImuFrontPitchSeries());
-            _self->_dataRecorder->addColumn(_self->_sensorDataSeries->getImuFrontRollSeries());
-            _self->_dataRecorder->addColumn(_self->_wheelSpeedLODataSeries);
-            _self->_dataRecorder->addColumn(_self->_wheelSpeedLMDataSeries);
-            _self->_dataRecorder->addColumn(_self->_wheelSpeedRODataSeries);
-            _self->_dataRecorder->addColumn(_self->_wheelSpeedRMDataSeries);
-            _self->_dataRecorder->addColumn(_self->_gpsDataSeries->getLatitudeSeries());
-            _self->_dataRecorder->addColumn(_self->_gpsDataSeries->getLongitudeSeries());
-            connect(_self->_gpsServer, &GpsServer::gpsUpdate, _self->_gpsDataSeries, &GpsCsvSeries::addLocation);
-            connect(_self->_mbed, &MbedChannel::messageReceived, _self->_sensorDataSeries, &SensorDataParser::newData);
-
-            LOG_I(LOG_TAG, "-------------------------------------------------------");
-            LOG_I(LOG_TAG, "-------------------------------------------------------");
-            LOG_I(LOG_TAG, "-------------------------------------------------------");
-            LOG_I(LOG_TAG, "Initialization complete");
-            LOG_I(LOG_TAG, "-------------------------------------------------------");
-            LOG_I(LOG_TAG, "-------------------------------------------------------");
-            LOG_I(LOG_TAG, "-------------------------------------------------------");
-        });
+void MainController::configValueChanged(const QString& key, const QVariant& value) {
+    if (MemoryBudgetRegistry::root()->applyConfigValue(key, value)) {
+        return;
+    }
+    if (key == "data_record_interval") {
+        // The recorder picks the current value up when it is created
+        if (_dataRecorder) {
+            _dataRecorder->setUpdateInterval(value.toInt());
+        }
+    }
+    else if (key == "main_send_deadline") {
+        _mainChannel->setSendQueueDeadline(value.toInt());
+    }
+    else if ((key == "drive_degraded_phi") || (key == "drive_failed_phi")) {
+        _driveChannel->setFailureDetectorThresholds(_config->valueAsDouble("drive_degraded_phi"),
+                                                    _config->valueAsDouble("drive_failed_phi"));
+    }
+    else if ((key == "drive_reorder_delay") || (key == "drive_reorder_packets")) {
+        applyDriveReorderConfig();
+    }
+    else if (key == "resource_sample_interval") {
+        _resourceMonitor->start(value.toInt());
+    }
+    else if (key == "event_loop_stall_threshold") {
+        _eventLoopMonitor->setStallThreshold(value.toInt());
+    }
+    else if (key == "event_loop_stack_samples") {
+        _eventLoopMonitor->setStackSamplingEnabled(value.toBool());
+    }
+    else if ((key == "governor_enabled") || (key == "governor_interval")) {
+        if (_config->valueAsBool("governor_enabled")) {
+            _videoGovernor->start(_config->valueAsInt("governor_interval"));
+        }
+        else {
+            _videoGovernor->stop();
+        }
+    }
+    else if (key.startsWith("governor_")) {
+        applyVideoGovernorConfig();
+    }
+    else if ((key == "gps_receiver") || (key == "gps_fix_rate")) {
+        applyGpsReceiverConfig();
+    }
+    else if (key.startsWith("estimator_")) {
+        applyPoseEstimatorConfig();
+    }
+    else if (key == "sched_executor") {
+        Executor::root()->setSchedulingPolicy(schedulingPolicy(key));
+    }
+    else if (key == "sched_main") {
+        // Threads started since keep what they inherited at startup
+        schedulingPolicy(key).applyToCurrentThread("main thread");
+    }
+    else if (key.startsWith("sched_")) {
+        LOG_I(LOG_TAG, "New streamer scheduling applies from the next stream started");
+        applyStreamerSchedulingPolicies();
     }
 }
 
@@ -226,11 +593,12 @@ void MainController::sendSystemStatusMessage() {
 
     stream << static_cast<qint32>(messageType);
     stream << (_mbed->getState() == MbedChannel::ConnectedState);
-    _mainChannel->sendMessage(message);
+    _mainChannel->sendConflatedMessage(messageType, message);
 }
 
 bool MainController::startDataRecording(QDateTime startTime) {
     LOG_I(LOG_TAG, "Starting test log with start time of " + QString::number(startTime.toMSecsSinceEpoch()));
+    _startup->require("recorder");
 
     return _dataRecorder->startLog(startTime, CsvRecorder::RECORDING_MODE_ON_INTERVAL);
 }
@@ -238,7 +606,9 @@ bool MainController::startDataRecording(QDateTime startTime) {
 void MainController::stopDataRecording() {
     LOG_I(LOG_TAG, "Ending test log");
 
-    _dataRecorder->stopLog();
+    if (_dataRecorder) {
+        _dataRecorder->stopLog();
+    }
 }
 
 void MainController::driveChannelStateChanged(Channel::State state) {
@@ -247,6 +617,20 @@ void MainController::driveChannelStateChanged(Channel::State state) {
         char stopMessage[DriveMessage::RequiredSize];
         DriveMessage::setGamepadData_DualStick(stopMessage, 0, 0, 0);
         _mbed->sendMessage(stopMessage, DriveMessage::RequiredSize);
+        _poseEstimator->driveCommand(stopMessage);
+    }
+}
+
+void MainController::driveChannelDegradedChanged(bool degraded) {
+    if (degraded) {
+        // Don't keep driving on the last command while mission control may have lost us,
+        // drive commands will resume as soon as they get through again
+        LOG_W(LOG_TAG, "Drive channel is degraded, stopping the rover");
+        Tracer::root()->dumpOnAnomaly("drive_degraded");
+        char stopMessage[DriveMessage::RequiredSize];
+        DriveMessage::setGamepadData_DualStick(stopMessage, 0, 0, 0);
+        _mbed->sendMessage(stopMessage, DriveMessage::RequiredSize);
+        _poseEstimator->driveCommand(stopMessage);
     }
 }
 
@@ -255,17 +639,85 @@ void MainController::mbedChannelStateChanged(MbedChannel::State state) {
     sendSystemStatusMessage();
 }
 
+void MainController::mbedRttChanged(int rtt) {
+    // Forward to mission control so it can account for the last hop of drive latency
+    QByteArray message;
+    QDataStream stream(&message, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::BigEndian);
+
+    MainMessageType messageType = MainMessageType_RoverMbedRtt;
+
+    stream << static_cast<qint32>(messageType);
+    stream << static_cast<qint32>(rtt);
+    _mainChannel->sendConflatedMessage(messageType, message);
+}
+
+void MainController::videoGovernorLevelChanged(int level) {
+    _mainCameraServer->setProfileScale(VideoGovernor::getFrameratePercent(level), VideoGovernor::getResolutionPercent(level));
+    _aux1CameraServer->setProfileScale(VideoGovernor::getFrameratePercent(level), VideoGovernor::getResolutionPercent(level));
+}
+
+void MainController::videoGovernorSampled(const VideoGovernorState& state) {
+    if (_mainChannel->getState() != Channel::ConnectedState) return;
+
+    QByteArray message;
+    QDataStream stream(&message, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::BigEndian);
+
+    MainMessageType messageType = MainMessageType_VideoGovernorUpdate;
+
+    stream << static_cast<qint32>(messageType);
+    stream << state;
+    _mainChannel->sendConflatedMessage(messageType, message);
+}
+
+ResourceUsage::ChannelStats MainController::sampleChannel(const Channel *channel) {
+    ResourceUsage::ChannelStats stats;
+    stats.name = channel->getName();
+    stats.depth = static_cast<quint16>(qMin(channel->getSendQueueDepth(), 0xFFFF));
+    stats.bytes = static_cast<quint32>(qMin<qint64>(channel->getSendQueueBytes(), 0xFFFFFFFFLL));
+    stats.conflated = static_cast<quint32>(channel->getConflatedMessageCount());
+    stats.staleDropped = static_cast<quint32>(channel->getStaleDroppedMessageCount());
+    stats.overflowDropped = static_cast<quint32>(channel->getOverflowDroppedMessageCount());
+    stats.reorderDepth = static_cast<quint16>(qMin(channel->getUdpReorderDepth(), 0xFFFF));
+    stats.lateDropped = static_cast<quint32>(channel->getUdpLateDroppedPacketCount());
+    return stats;
+}
+
+void MainController::resourcesSampled(const ResourceUsage& sample) {
+    if (_mainChannel->getState() != Channel::ConnectedState) return;
+
+    ResourceUsage usage = sample;
+    usage.channels.append(sampleChannel(_mainChannel));
+    usage.channels.append(sampleChannel(_driveChannel));
+
+    QByteArray message;
+    QDataStream stream(&message, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::BigEndian);
+
+    MainMessageType messageType = MainMessageType_RoverResourceUpdate;
+
+    stream << static_cast<qint32>(messageType);
+    stream << usage;
+    _mainChannel->sendConflatedMessage(messageType, message);
+}
+
 void MainController::driveChannelMessageReceived(const char* message, Channel::MessageSize size) {
     char header = message[0];
     MbedMessageType messageType;
     reinterpret_cast<qint32&>(messageType) = (qint32)reinterpret_cast<unsigned char&>(header);
     switch (messageType) {
-    case MbedMessage_Drive:
-        _wheelSpeedLMDataSeries->onDriveCommand(message);
-        _wheelSpeedLODataSeries->onDriveCommand(message);
-        _wheelSpeedRMDataSeries->onDriveCommand(message);
-        _wheelSpeedRODataSeries->onDriveCommand(message);
+    case MbedMessage_Drive: {
+        TRACE_SPAN("drive", "Forward drive command");
+        _poseEstimator->driveCommand(message);
+        if (_dataRecorder) {
+            _wheelSpeedLMDataSeries->onDriveCommand(message);
+            _wheelSpeedLODataSeries->onDriveCommand(message);
+            _wheelSpeedRMDataSeries->onDriveCommand(message);
+            _wheelSpeedRODataSeries->onDriveCommand(message);
+        }
         _mbed->sendMessage(message, (int)size);
+    }
         break;
     default:
         LOG_E(LOG_TAG, "Received invalid message from mission control on drive control channel");
@@ -381,6 +833,36 @@ void MainController::mainChannelMessageReceived(const char* message, Channel::Me
         //
         stopDataRecording();
         break;
+    case MainMessageType_RoverConfigUpdate: {
+        //
+        // Change a setting from research_rover.conf until the file itself changes it
+        //
+        QString key, value;
+        stream >> key;
+        stream >> value;
+        if (!_config->set(key, value)) {
+            LOG_W(LOG_TAG, "Mission control sent an invalid config update for " + key);
+        }
+    }
+        break;
+    case MainMessageType_DumpTrace:
+        // Mission control is dumping its own trace and wants ours to go with it
+        Tracer::root()->dump("requested_by_mission_control");
+        break;
+    case MainMessageType_ClockSync: {
+        //
+        // Echo mission control's clock back with ours, so it can work out the offset between them
+        //
+        qint64 sentTime;
+        stream >> sentTime;
+        QByteArray reply;
+        QDataStream replyStream(&reply, QIODevice::WriteOnly);
+        replyStream << static_cast<qint32>(MainMessageType_ClockSync);
+        replyStream << sentTime;
+        replyStream << Clock::root()->msecsSinceEpoch();
+        _mainChannel->sendMessage(reply);
+    }
+        break;
     default:
         LOG_W(LOG_TAG, "Got unknown shared channel message");
         break;
@@ -400,6 +882,20 @@ void MainController::mbedMessageReceived(const char* message, int size) {
     _mainChannel->sendMessage(byteArray);
 }
 
+void MainController::poseUpdated(const PoseEstimate& pose) {
+    if (_mainChannel->getState() != Channel::ConnectedState) return;
+
+    QByteArray message;
+    QDataStream stream(&message, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::BigEndian);
+
+    MainMessageType messageType = MainMessageType_RoverPoseUpdate;
+
+    stream << static_cast<qint32>(messageType);
+    stream << pose;
+    _mainChannel->sendConflatedMessage(messageType, message);
+}
+
 void MainController::gpsUpdate(NmeaMessage message) {
     // Forward this update to mission control
     QByteArray byteArray;
@@ -410,7 +906,7 @@ void MainController::gpsUpdate(NmeaMessage message) {
     stream << static_cast<qint32>(messageType);
     stream << message;
 
-    _mainChannel->sendMessage(byteArray);
+    _mainChannel->sendConflatedMessage(messageType, byteArray);
 }
 
 } // namespace Soro
@@ -11,10 +11,19 @@
 #include "soro_core/gpscsvseries.h"
 #include "soro_core/drivemessage.h"
 #include "soro_core/wheelspeedcsvseries.h"
+#include "soro_core/liveconfig.h"
+#include "soro_core/startupgraph.h"
+#include "soro_core/resourcemonitor.h"
+#include "soro_core/eventloopmonitor.h"
+#include "soro_core/schedulingpolicy.h"
+#include "soro_core/videogovernor.h"
+#include "soro_core/poseestimator.h"
+#include "soro_core/posecsvseries.h"
 
 #include "gpsserver.h"
 #include "audioserver.h"
 #include "videoserver.h"
+#include "usbcameraenumerator.h"
 
 namespace Soro {
 
@@ -30,6 +39,29 @@ private:
 
     static MainController *_self;
 
+    /* Rover settings that can be changed while running, and the camera definitions
+     */
+    LiveConfig *_config = 0;
+    LiveConfig *_cameraConfig = 0;
+
+    StartupGraph *_startup = 0;
+
+    /* Samples the rover's CPU and memory use, which is sent to mission control
+     */
+    ResourceMonitor *_resourceMonitor = 0;
+
+    /* Watches for anything holding up the event loop, which delays drive commands
+     */
+    EventLoopMonitor *_eventLoopMonitor = 0;
+
+    /* Lowers video quality when the rover is running hot or can't keep up with its streams
+     */
+    VideoGovernor *_videoGovernor = 0;
+
+    /* Estimates position and heading between GPS fixes for a smooth map on mission control
+     */
+    PoseEstimator *_poseEstimator = 0;
+
     /* Connects to mission control for command and status communication
      */
     Channel *_driveChannel = 0;
@@ -55,25 +87,45 @@ private:
     WheelSpeedCsvSeries *_wheelSpeedLMDataSeries = 0;
     WheelSpeedCsvSeries *_wheelSpeedRODataSeries = 0;
     WheelSpeedCsvSeries *_wheelSpeedRMDataSeries = 0;
+    UsbCameraEnumerator *_cameras = 0;
     QString _aux1CameraDevice;
     QString _stereoRCameraDevice;
     QString _stereoLCameraDevice;
     QString _monoCameraDevice;
 
-    CsvRecorder *_dataRecorder;
-    GpsCsvSeries *_gpsDataSeries;
-    SensorDataParser *_sensorDataSeries;
+    CsvRecorder *_dataRecorder = 0;
+    GpsCsvSeries *_gpsDataSeries = 0;
+    PoseCsvSeries *_poseDataSeries = 0;
+    SensorDataParser *_sensorDataSeries = 0;
+
+    /* Gets the statistics of a channel for the resource updates
+     */
+    static ResourceUsage::ChannelStats sampleChannel(const Channel *channel);
 
 private Q_SLOTS:
     void sendSystemStatusMessage();
     void mainChannelStateChanged(Channel::State state);
     void driveChannelStateChanged(Channel::State state);
+    void driveChannelDegradedChanged(bool degraded);
     void mbedChannelStateChanged(MbedChannel::State state);
+    void mbedRttChanged(int rtt);
+    void resourcesSampled(const ResourceUsage& usage);
+    void videoGovernorSampled(const VideoGovernorState& state);
+    void videoGovernorLevelChanged(int level);
     void mbedMessageReceived(const char* message, int size);
     void driveChannelMessageReceived(const char* message, Channel::MessageSize size);
     void mainChannelMessageReceived(const char* message, Channel::MessageSize size);
     void gpsUpdate(NmeaMessage message);
+    void poseUpdated(const PoseEstimate& pose);
     void mediaServerError(MediaServer* server, QString message);
+    void configValueChanged(const QString& key, const QVariant& value);
+    void matchCameras();
+    SchedulingPolicy schedulingPolicy(const QString& key);
+    void applyStreamerSchedulingPolicies();
+    void applyVideoGovernorConfig();
+    void applyDriveReorderConfig();
+    void applyGpsReceiverConfig();
+    void applyPoseEstimatorConfig();
     bool startDataRecording(QDateTime startTime);
     void stopDataRecording();
 };
@@ -16,26 +16,29 @@
 
 #include "mediaserver.h"
 #include "soro_core/logger.h"
+#include "soro_core/tracer.h"
 
 namespace Soro {
 
-MediaServer::MediaServer(QString logTag, int mediaId, QString childProcessPath, quint16 bindPort, QObject *parent) : QObject(parent) {
+MediaServer::MediaServer(QString logTag, int mediaId, QString childProcessPath, SocketAddress bindAddress, QObject *parent) : QObject(parent) {
     LOG_TAG = logTag;
-    LOG_I(LOG_TAG, "MediaServer(): Creating new media server on port " + QString::number(bindPort) + " with child process '" + childProcessPath + "'");
+    LOG_I(LOG_TAG, "MediaServer(): Creating new media server on " + bindAddress.toString() + " with child process '" + childProcessPath + "'");
 
-    _bindPort = bindPort;
+    _bindAddress = bindAddress;
     _mediaId = mediaId;
 
-    _controlChannel = Channel::createServer(this, bindPort, "soro_media" + QString::number(mediaId), Channel::TcpProtocol);
+    _controlChannel = Channel::createServer(this, bindAddress.port, "soro_media" + QString::number(mediaId), Channel::TcpProtocol,
+                                            bindAddress.host);
     _controlChannel->open();
 
     connect(_controlChannel, &Channel::stateChanged, this, &MediaServer::controlChannelStateChanged);
 
     _mediaSocket = new QUdpSocket(this);
 
-    _ipcServer = new QTcpServer(this);
-    _ipcServer->listen(QHostAddress::LocalHost);
-    connect(_ipcServer, &QTcpServer::newConnection, this, &MediaServer::ipcServerClientAvailable);
+    // The streaming process is always on this host, so it is talked to over a Unix-domain socket
+    _ipcChannel = Channel::createServer(this, "unix:" + QDir::tempPath() + "/soro_media" + QString::number(mediaId)
+                                        + "_" + QString::number(QCoreApplication::applicationPid()), CHANNEL_NAME_MEDIA_IPC);
+    connect(_ipcChannel, &Channel::messageReceived, this, &MediaServer::ipcMessageReceived);
 
     _child.setProgram(childProcessPath);
 
@@ -47,10 +50,10 @@ MediaServer::MediaServer(QString logTag, int mediaId, QString childProcessPath,
         LOG_E(LOG_TAG, "!!!! The binary '" + childProcessPath + "' does not exist or cannot be accessed. Streaming WILL NOT work !!!!");
     }
     else if (!childBinInfo.isExecutable()) {
-        LOG_W(LOG_TAG, "!!!! The binary '" + childProcessPath + "' does not have execute permission. Executing 'chmod +x' in attempt to fix !!!!");
-        QProcess chmod;
-        chmod.start("chmod", QStringList() << "+x" << childProcessPath);
-        chmod.waitForFinished(1000);
+        LOG_W(LOG_TAG, "!!!! The binary '" + childProcessPath + "' does not have execute permission. Setting it in attempt to fix !!!!");
+        // Rather than waiting on a chmod process
+        QFile::setPermissions(childProcessPath, QFile::permissions(childProcessPath)
+                              | QFile::ExeOwner | QFile::ExeGroup | QFile::ExeOther);
     }
 }
 
@@ -60,10 +63,17 @@ MediaServer::~MediaServer() {
 }
 
 void MediaServer::beginStream(SocketAddress address) {
+    TRACE_SPAN("gstreamer", "MediaServer::beginStream");
     QStringList args;
-    constructChildArguments(args, _bindPort, address, _ipcServer->serverPort());
+    _ipcChannel->open();
+    constructChildArguments(args, _bindAddress.port, address, _ipcChannel->getLocalAddress());
     _child.setArguments(args);
 
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert(SCHEDULING_POLICY_ENV, _processPolicy.withDefaults().toString());
+    environment.insert(STREAMING_SCHEDULING_POLICY_ENV, _streamingThreadPolicy.toString());
+    _child.setProcessEnvironment(environment);
+
     connect(&_child, &QProcess::stateChanged, this, &MediaServer::childStateChanged);
     _child.start();
 
@@ -84,12 +94,14 @@ void MediaServer::stop() {
         LOG_I(LOG_TAG, "stop(): Server is already stopped");
         return;
     }
+    TRACE_SPAN("gstreamer", "MediaServer::stop");
     if (_child.state() != QProcess::NotRunning) {
         LOG_I(LOG_TAG, "stop(): Asking the streaming process to stop");
         disconnect(&_child, &QProcess::stateChanged, this, &MediaServer::childStateChanged);
-        if (_ipcSocket) {
-            _ipcSocket->write("stop");
-            _ipcSocket->flush();
+        if (_ipcChannel->getState() == Channel::ConnectedState) {
+            _ipcChannel->sendMessage(QByteArray("stop"));
+            // Nothing is written by the event loop while this waits on the child
+            _ipcChannel->flush();
             if (!_child.waitForFinished(1000)) {
                 LOG_E(LOG_TAG, "stop(): Streaming process did not respond to stop request, terminating it");
                 _child.terminate();
@@ -108,13 +120,7 @@ void MediaServer::stop() {
         }
     }
 
-    if (_ipcSocket) {
-        LOG_I(LOG_TAG, "stop(): IPC socket is active, closing it");
-        disconnect(_ipcSocket, 0, 0, 0);
-        _ipcSocket->abort();
-        delete _ipcSocket;
-        _ipcSocket = nullptr;
-    }
+    _ipcChannel->close();
 
     onStreamStoppedInternal();
 
@@ -144,9 +150,9 @@ void MediaServer::beginClientHandshake() {
     if (_state != WaitingState) return;
     if (_controlChannel->getState() == Channel::ConnectedState) {
         _mediaSocket->abort();
-        if (!_mediaSocket->bind(_bindPort)) {
-            LOG_E(LOG_TAG, "beginClientHandshake(): Cannot bind to UDP socket " + QString::number(_bindPort) + ": " + _mediaSocket->errorString());
-            QTimer::singleShot(500, this, SLOT(beginClientHandshake()));
+        if (!_mediaSocket->bind(_bindAddress.host, _bindAddress.port)) {
+            LOG_E(LOG_TAG, "beginClientHandshake(): Cannot bind to UDP socket " + _bindAddress.toString() + ": " + _mediaSocket->errorString());
+            Clock::root()->singleShot(500, this, [this]() { beginClientHandshake(); });
             return;
         }
         connect(_mediaSocket, &QUdpSocket::readyRead, this, &MediaServer::mediaSocketReadyRead);
@@ -160,20 +166,21 @@ void MediaServer::beginClientHandshake() {
         stream << QString("start");
         _controlChannel->sendMessage(message.constData(), message.size());
         // client must respond on its UDP address within a certain time or the process will start again
-        QTimer::singleShot(3000, this, SLOT(beginClientHandshake()));
+        Clock::root()->singleShot(3000, this, [this]() { beginClientHandshake(); });
 
     }
     else {
         LOG_I(LOG_TAG, "beginClientHandshake(): Waiting for client to respond...");
-        QTimer::singleShot(500, this, SLOT(beginClientHandshake()));
+        Clock::root()->singleShot(500, this, [this]() { beginClientHandshake(); });
     }
 }
 
-void MediaServer::ipcServerClientAvailable() {
-    if (!_ipcSocket) {
-        _ipcSocket = _ipcServer->nextPendingConnection();
-        LOG_I(LOG_TAG, "ipcServerClientAvailable(): Streaming process is connected to its parent through TCP");
-    }
+void MediaServer::ipcMessageReceived(const char *message, Channel::MessageSize size) {
+    onChildMessage(QString::fromLatin1(message, size));
+}
+
+void MediaServer::onChildMessage(QString message) {
+    LOG_W(LOG_TAG, "onChildMessage(): Got unknown message from streaming process '" + message + "'");
 }
 
 void MediaServer::mediaSocketReadyRead() {
@@ -207,6 +214,7 @@ void MediaServer::mediaSocketReadyRead() {
 void MediaServer::childStateChanged(QProcess::ProcessState state) {
     switch (state) {
     case QProcess::NotRunning:
+        TRACE_INSTANT("gstreamer", "MediaServer streaming process exited");
         disconnect(&_child, &QProcess::stateChanged, this, &MediaServer::childStateChanged);
 
         switch (_child.exitCode()) {
@@ -252,6 +260,11 @@ void MediaServer::controlChannelStateChanged(Channel::State state) {
     }
 }
 
+void MediaServer::setSchedulingPolicies(const SchedulingPolicy& process, const SchedulingPolicy& streamingThreads) {
+    _processPolicy = process;
+    _streamingThreadPolicy = streamingThreads;
+}
+
 int MediaServer::getMediaId() {
     return _mediaId;
 }
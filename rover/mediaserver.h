@@ -7,6 +7,7 @@
 
 #include "soro_core/socketaddress.h"
 #include "soro_core/channel.h"
+#include "soro_core/schedulingpolicy.h"
 
 namespace Soro {
 
@@ -50,16 +51,24 @@ public:
      */
     MediaServer::State getState() const;
 
+    /**
+     * Sets the scheduling policies for the streaming process's main thread and its GStreamer streaming
+     * threads. These take effect the next time a stream is started. The process runs on every core at
+     * nice 0 for anything its policy leaves out, rather than inheriting the rover's main thread policy.
+     */
+    void setSchedulingPolicies(const SchedulingPolicy& process, const SchedulingPolicy& streamingThreads);
+
 private:
     int _mediaId;
-    quint16 _bindPort;
+    SocketAddress _bindAddress;
     Channel *_controlChannel = nullptr;
     QUdpSocket *_mediaSocket = nullptr;
     State _state = IdleState;
     QProcess _child;
-    QTcpServer *_ipcServer = nullptr;
-    QTcpSocket *_ipcSocket = nullptr;
+    Channel *_ipcChannel = nullptr;
     int _startInternalTimerId = TIMER_INACTIVE;
+    SchedulingPolicy _processPolicy;
+    SchedulingPolicy _streamingThreadPolicy;
 
     void beginStream(SocketAddress address);
 
@@ -73,7 +82,7 @@ private Q_SLOTS:
     void controlChannelStateChanged(Channel::State state);
     void beginClientHandshake();
     void childStateChanged(QProcess::ProcessState state);
-    void ipcServerClientAvailable();
+    void ipcMessageReceived(const char *message, Channel::MessageSize size);
 
 Q_SIGNALS:
     void stateChanged(MediaServer *server, MediaServer::State state);
@@ -94,10 +103,10 @@ protected:
      * all media streams to prevent any problems if ports are not properly configured.
      * @param childProcessPath The path to the process that will be executed to provide the media stream. This is done
      * in a child process to prevent any streaming/encoding errors from crashing the main program.
-     * @param bindPort Port for the local socket to bind to
+     * @param bindAddress Address and port for the local sockets to bind to
      * @param parent
      */
-    MediaServer(QString logTag, int mediaId, QString childProcessPath, quint16 bindPort, QObject *parent);
+    MediaServer(QString logTag, int mediaId, QString childProcessPath, SocketAddress bindAddress, QObject *parent);
 
     /**
      * Starts the media stream. This will immediately put the media server into the Waiting state. If
@@ -106,9 +115,14 @@ protected:
     void initStream();
 
     virtual void onStreamStoppedInternal() = 0;
-    virtual void constructChildArguments(QStringList& outArgs, quint16 bindPort, SocketAddress address, quint16 ipcPort)=0;
+    virtual void constructChildArguments(QStringList& outArgs, quint16 bindPort, SocketAddress address, QString ipcAddress)=0;
     virtual void constructStreamingMessage(QDataStream& stream)=0;
 
+    /**
+     * Called with each message the streaming process sends with MediaStreamer::sendToParent()
+     */
+    virtual void onChildMessage(QString message);
+
 };
 
 } // namespace Soro
@@ -30,6 +30,10 @@ int UsbCameraEnumerator::loadCameras() {
     QDir dev("/dev");
     QStringList allFiles = dev.entryList(QDir::NoDotAndDotDot | QDir::System | QDir::Files);
 
+    // Use udevadm to get info about each /dev/video* device. These are all started up front so
+    // they run at the same time instead of waiting on one another.
+    QList<UsbCamera*> cameras;
+    QList<QProcess*> queries;
     for (QString file : allFiles) {
         if (file.contains("video")) {
 
@@ -37,45 +41,52 @@ int UsbCameraEnumerator::loadCameras() {
             UsbCamera *camera = new UsbCamera;
             camera->device = "/dev/" + file;
 
-            // Use udevadm to get info about each /dev/video* device
-            QProcess udevadm;
-            udevadm.start("udevadm info -a -n " + camera->device);
-            udevadm.waitForFinished();
-            QString udevadmOutput = QString(udevadm.readAllStandardOutput());
-
-            QLatin1String nameToken("{name}==\"");
-            int nameIndex = udevadmOutput.indexOf(nameToken);
-            if (nameIndex >= 0) {
-                nameIndex += nameToken.size();
-                camera->name = udevadmOutput.mid(nameIndex, udevadmOutput.indexOf("\"", nameIndex) - nameIndex);
-            }
-
-            QLatin1String vendorToken("{idVendor}==\"");
-            int vendorIndex = udevadmOutput.indexOf(vendorToken);
-            if (vendorIndex >= 0) {
-                vendorIndex += vendorToken.size();
-                camera->vendorId = udevadmOutput.mid(vendorIndex, udevadmOutput.indexOf("\"", vendorIndex) - vendorIndex);
-            }
-
-            QLatin1String productToken("{idProduct}==\"");
-            int productIndex = udevadmOutput.indexOf(productToken);
-            if (productIndex >= 0) {
-                productIndex += productToken.size();
-                camera->productId = udevadmOutput.mid(productIndex, udevadmOutput.indexOf("\"", productIndex) - productIndex);
-            }
-
-            QLatin1String serialToken("{serial}==\"");
-            int serialIndex = udevadmOutput.indexOf(serialToken);
-            if (serialIndex >= 0) {
-                serialIndex += serialToken.size();
-                camera->serial = udevadmOutput.mid(serialIndex, udevadmOutput.indexOf("\"", serialIndex) - serialIndex);
-            }
-
-            LOG_I(LOG_TAG, "Found camera " + camera->toString());
-            _cameras.append(camera);
+            QProcess *udevadm = new QProcess;
+            udevadm->start("udevadm info -a -n " + camera->device);
+            cameras.append(camera);
+            queries.append(udevadm);
         }
     }
 
+    for (int i = 0; i < cameras.size(); ++i) {
+        UsbCamera *camera = cameras[i];
+        QProcess *udevadm = queries[i];
+        udevadm->waitForFinished();
+        QString udevadmOutput = QString(udevadm->readAllStandardOutput());
+        delete udevadm;
+
+        QLatin1String nameToken("{name}==\"");
+        int nameIndex = udevadmOutput.indexOf(nameToken);
+        if (nameIndex >= 0) {
+            nameIndex += nameToken.size();
+            camera->name = udevadmOutput.mid(nameIndex, udevadmOutput.indexOf("\"", nameIndex) - nameIndex);
+        }
+
+        QLatin1String vendorToken("{idVendor}==\"");
+        int vendorIndex = udevadmOutput.indexOf(vendorToken);
+        if (vendorIndex >= 0) {
+            vendorIndex += vendorToken.size();
+            camera->vendorId = udevadmOutput.mid(vendorIndex, udevadmOutput.indexOf("\"", vendorIndex) - vendorIndex);
+        }
+
+        QLatin1String productToken("{idProduct}==\"");
+        int productIndex = udevadmOutput.indexOf(productToken);
+        if (productIndex >= 0) {
+            productIndex += productToken.size();
+            camera->productId = udevadmOutput.mid(productIndex, udevadmOutput.indexOf("\"", productIndex) - productIndex);
+        }
+
+        QLatin1String serialToken("{serial}==\"");
+        int serialIndex = udevadmOutput.indexOf(serialToken);
+        if (serialIndex >= 0) {
+            serialIndex += serialToken.size();
+            camera->serial = udevadmOutput.mid(serialIndex, udevadmOutput.indexOf("\"", serialIndex) - serialIndex);
+        }
+
+        LOG_I(LOG_TAG, "Found camera " + camera->toString());
+        _cameras.append(camera);
+    }
+
     return _cameras.length();
 }
 
@@ -17,13 +17,20 @@
 #include "videoserver.h"
 #include "soro_core/logger.h"
 
+//number of frame counts from a new streaming process to ignore while its camera starts up
+#define FRAME_WARMUP_SAMPLES 2
+//scaled dimensions are rounded down to a multiple of this, which every encoder accepts
+#define DIMENSION_ALIGNMENT 8
+
 namespace Soro {
 
-VideoServer::VideoServer(int mediaId, quint16 bindPort, QObject *parent)
-    : MediaServer("VideoServer " + QString::number(mediaId), mediaId, QCoreApplication::applicationDirPath() + "/video_streamer" , bindPort, parent) {
+VideoServer::VideoServer(int mediaId, SocketAddress host, QObject *parent)
+    : MediaServer("VideoServer " + QString::number(mediaId), mediaId, QCoreApplication::applicationDirPath() + "/video_streamer" , host, parent) {
 }
 
 void VideoServer::onStreamStoppedInternal() {
+    _lastFrameCount = -1;
+    _frameSamples = 0;
     if (!_starting) {
         _videoDevice = "";
         _profile.codec = GStreamerUtil::CODEC_NULL;
@@ -58,15 +65,16 @@ void VideoServer::start(QString leftDeviceName, QString rightDeviceName, GStream
     _starting = false;
 }
 
-void VideoServer::constructChildArguments(QStringList& outArgs, quint16 bindPort, SocketAddress address, quint16 ipcPort) {
+void VideoServer::constructChildArguments(QStringList& outArgs, quint16 bindPort, SocketAddress address, QString ipcAddress) {
     outArgs << _videoDevice;
     outArgs << (_stereo ? "1" : "0");
-    outArgs << _profile.toString();
+    GStreamerUtil::VideoProfile profile = getEffectiveVideoProfile();
+    outArgs << profile.toString();
     outArgs << (_vaapi ? "1" : "0");
     outArgs << QHostAddress(address.host.toIPv4Address()).toString();
     outArgs << QString::number(address.port);
     outArgs << QString::number(bindPort);
-    outArgs << QString::number(ipcPort);
+    outArgs << ipcAddress;
 
     QString binString;
     if (_stereo)
@@ -76,7 +84,7 @@ void VideoServer::constructChildArguments(QStringList& outArgs, quint16 bindPort
                                                              bindPort,
                                                              address.host,
                                                              address.port,
-                                                             _profile,
+                                                             profile,
                                                              _vaapi);
     }
     else
@@ -85,14 +93,14 @@ void VideoServer::constructChildArguments(QStringList& outArgs, quint16 bindPort
                                                              bindPort,
                                                              address.host,
                                                              address.port,
-                                                             _profile,
+                                                             profile,
                                                              _vaapi);
     }
     LOG_I(LOG_TAG, "Child is about to start using gstreamer bin string " + binString);
 }
 
 void VideoServer::constructStreamingMessage(QDataStream& stream) {
-    stream << _profile.toString();
+    stream << getEffectiveVideoProfile().toString();
     stream << _stereo;
 }
 
@@ -100,4 +108,54 @@ GStreamerUtil::VideoProfile VideoServer::getVideoProfile() const {
     return _profile;
 }
 
+GStreamerUtil::VideoProfile VideoServer::getEffectiveVideoProfile() const {
+    GStreamerUtil::VideoProfile profile = _profile;
+    if (_resolutionPercent < 100) {
+        profile.width = qMax(profile.width * _resolutionPercent / 100 / DIMENSION_ALIGNMENT * DIMENSION_ALIGNMENT, DIMENSION_ALIGNMENT);
+        profile.height = qMax(profile.height * _resolutionPercent / 100 / DIMENSION_ALIGNMENT * DIMENSION_ALIGNMENT, DIMENSION_ALIGNMENT);
+    }
+    if (_frameratePercent < 100) {
+        profile.framerate = qMax(profile.framerate * _frameratePercent / 100, 1);
+    }
+    return profile;
+}
+
+void VideoServer::setProfileScale(int frameratePercent, int resolutionPercent) {
+    frameratePercent = qBound(1, frameratePercent, 100);
+    resolutionPercent = qBound(1, resolutionPercent, 100);
+    if ((frameratePercent == _frameratePercent) && (resolutionPercent == _resolutionPercent)) return;
+
+    GStreamerUtil::VideoProfile previous = getEffectiveVideoProfile();
+    _frameratePercent = frameratePercent;
+    _resolutionPercent = resolutionPercent;
+    if ((getState() != IdleState) && (getEffectiveVideoProfile() != previous)) {
+        LOG_I(LOG_TAG, "setProfileScale(): Restarting stream with profile " + getEffectiveVideoProfile().toString());
+        _starting = true;
+        initStream();
+        _starting = false;
+    }
+}
+
+void VideoServer::onChildMessage(QString message) {
+    if (!message.startsWith("frames ")) {
+        MediaServer::onChildMessage(message);
+        return;
+    }
+    bool ok;
+    qint64 frameCount = message.mid(7).toLongLong(&ok);
+    if (!ok) return;
+
+    qint64 elapsed = _frameSampleTimer.restart();
+    qint64 lastFrameCount = _lastFrameCount;
+    _lastFrameCount = frameCount;
+    if ((lastFrameCount < 0) || (frameCount < lastFrameCount) || (elapsed <= 0)) return;
+    if (++_frameSamples <= FRAME_WARMUP_SAMPLES) return;
+
+    int framerate = getEffectiveVideoProfile().framerate;
+    if (framerate == 0) return;
+    // frames per second * 100 / target framerate, done in milliseconds to keep it in integers
+    qint64 delivered = (frameCount - lastFrameCount) * 100000 / (elapsed * framerate);
+    Q_EMIT frameDeficitUpdated(this, static_cast<int>(qBound(qint64(0), 100 - delivered, qint64(100))));
+}
+
 } // namespace Soro
@@ -2,6 +2,7 @@
 #define VIDEOSERVER_H
 
 #include <QObject>
+#include <QElapsedTimer>
 
 #include "soro_core/socketaddress.h"
 #include "soro_core/gstreamerutil.h"
@@ -22,7 +23,7 @@ public:
      * @param host Address for the socket that will be used to communicate with the media client.
      * @param parent
      */
-    explicit VideoServer(int mediaId, quint16 bindPort, QObject *parent = 0);
+    explicit VideoServer(int mediaId, SocketAddress host, QObject *parent = 0);
 
     /**
      * Starts a video stream. If the server is already streaming, it will be stopped and restarted to
@@ -45,23 +46,48 @@ public:
 
     GStreamerUtil::VideoProfile getVideoProfile() const;
 
+    /**
+     * Scales down the framerate and resolution of the stream from those in its profile, as a percentage of
+     * each. A running stream is restarted if this changes its effective profile.
+     */
+    void setProfileScale(int frameratePercent, int resolutionPercent);
+
+    /**
+     * Gets the profile actually being streamed, which is the profile given to start() with the scale applied
+     */
+    GStreamerUtil::VideoProfile getEffectiveVideoProfile() const;
+
+Q_SIGNALS:
+    /**
+     * Emitted about once a second while streaming with the percentage of frames that the stream's framerate
+     * called for but didn't make it through the pipeline, because the camera or encoder couldn't keep up
+     */
+    void frameDeficitUpdated(MediaServer *server, int percent);
+
 private:
     GStreamerUtil::VideoProfile _profile;
     QString _videoDevice;
     bool _starting = false;
     bool _vaapi = false;
     bool _stereo = false;
+    int _frameratePercent = 100;
+    int _resolutionPercent = 100;
+    qint64 _lastFrameCount = -1;
+    int _frameSamples = 0;
+    QElapsedTimer _frameSampleTimer;
 
 protected:
     /**
      * Begins streaming video to the provided address.
      * This will fail if the stream is not in WaitingState
      */
-    void constructChildArguments(QStringList& outArgs, quint16 bindPort, SocketAddress address, quint16 ipcPort) Q_DECL_OVERRIDE;
+    void constructChildArguments(QStringList& outArgs, quint16 bindPort, SocketAddress address, QString ipcAddress) Q_DECL_OVERRIDE;
 
     void onStreamStoppedInternal() Q_DECL_OVERRIDE;
 
     void constructStreamingMessage(QDataStream& stream) Q_DECL_OVERRIDE;
+
+    void onChildMessage(QString message) Q_DECL_OVERRIDE;
 };
 
 } // namespace Soro
@@ -5,9 +5,21 @@ SUBDIRS =\
     video_streamer \
     audio_streamer \
     rover \
-    research_control
+    research_control \
+    soak_test \
+    link_proxy \
+    session_analyzer \
+    log_viewer \
+    channel_bench \
+    tests
 
 video_streamer.depends = soro_core
 audio_streamer.depends = soro_core
 rover.depends = soro_core audio_streamer video_streamer
 research_control.depends = soro_core audio_streamer video_streamer
+soak_test.depends = soro_core rover
+link_proxy.depends = soro_core
+session_analyzer.depends = soro_core
+log_viewer.depends = soro_core
+channel_bench.depends = soro_core
+tests.depends = soro_core
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+
+#include "sessionanalyzer.h"
+#include "soro_core/logger.h"
+
+using namespace Soro;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("session_analyzer");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+            "Summarizes every trial recorded during a session: latency, bitrate, drive input, link outages "
+            "and how each of them changed with the latency and video settings.\n\n"
+            "Point it at a directory holding the research_data files from mission control (and the rover, if "
+            "they were copied off it), along with any logs and research_media videos from the same day.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("session", "Directory to read, including its subdirectories.");
+    QCommandLineOption outputOption("output", "Also write each table as a CSV file in this directory.", "directory");
+    QCommandLineOption threadsOption("threads", "Number of threads to read with, 0 for one per core.", "count", "0");
+    QCommandLineOption deadzoneOption("deadzone", "How far the drive stick has to be pushed to count as driving, "
+                                      "in percent of its travel.", "percent", "10");
+    parser.addOptions({ outputOption, threadsOption, deadzoneOption });
+    parser.process(a);
+
+    Logger::rootLogger()->setMaxStdoutLevel(Logger::LogLevelWarning);
+
+    if (parser.positionalArguments().size() != 1)
+    {
+        parser.showHelp(2);
+    }
+    QString session = parser.positionalArguments().first();
+    if (!QDir(session).exists())
+    {
+        LOG_E("SessionAnalyzer", session + " is not a directory");
+        return 2;
+    }
+
+    Executor::root()->setThreadCount(qMax(parser.value(threadsOption).toInt(), 0));
+    SessionAnalyzer analyzer(Executor::root());
+    analyzer.setDeadzone(qBound(0.0, parser.value(deadzoneOption).toDouble(), 100.0));
+    if (!analyzer.analyze(session))
+    {
+        LOG_E("SessionAnalyzer", analyzer.getError());
+        return 1;
+    }
+
+    QTextStream out(stdout);
+    for (const SummaryTable *table : analyzer.getTables())
+    {
+        out << table->toText() << "\n";
+    }
+    out << analyzer.getStatistics() << "\n";
+    out.flush();
+
+    if (parser.isSet(outputOption))
+    {
+        QDir output(parser.value(outputOption));
+        if (!output.exists() && !QDir().mkpath(output.path()))
+        {
+            LOG_E("SessionAnalyzer", "Cannot create " + output.path());
+            return 1;
+        }
+        for (const SummaryTable *table : analyzer.getTables())
+        {
+            QString path = output.filePath(table->getTitle().toLower().replace(' ', '_') + ".csv");
+            if (!table->writeCsv(path))
+            {
+                LOG_E("SessionAnalyzer", "Cannot write " + path);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,408 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "recordingfile.h"
+
+#include <algorithm>
+#include <cstring>
+
+//rows are handed out to threads in chunks of about this many bytes
+#define CHUNK_SIZE (4 * 1024 * 1024)
+//numbers with more digits than this are left to Qt to parse
+#define MAX_FAST_DIGITS 18
+
+namespace Soro {
+
+static const double POW10[MAX_FAST_DIGITS + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18
+};
+
+/* Parses the plain decimals CsvRecorder writes nearly all of its values as, without the
+ * allocation and locale handling of QByteArray::toDouble(), falling back to it for anything else
+ */
+static bool parseNumber(const char *begin, const char *end, double *value)
+{
+    const char *p = begin;
+    bool negative = false;
+    if ((p < end) && ((*p == '-') || (*p == '+')))
+    {
+        negative = *p == '-';
+        p++;
+    }
+    quint64 mantissa = 0;
+    int digits = 0;
+    int decimals = 0;
+    bool point = false;
+    for (; p < end; p++)
+    {
+        if ((*p >= '0') && (*p <= '9'))
+        {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits++;
+            if (point) decimals++;
+        }
+        else if ((*p == '.') && !point)
+        {
+            point = true;
+        }
+        else break;
+    }
+    if ((p != end) || (digits > MAX_FAST_DIGITS))
+    {
+        bool ok;
+        *value = QByteArray(begin, end - begin).toDouble(&ok);
+        return ok;
+    }
+    if (digits == 0) return false;
+    *value = (negative ? -1.0 : 1.0) * mantissa / POW10[decimals];
+    return true;
+}
+
+static bool parseTime(const char *begin, const char *end, qint64 *time)
+{
+    const char *p = begin;
+    bool negative = (p < end) && (*p == '-');
+    if (negative) p++;
+    if (p == end) return false;
+    qint64 result = 0;
+    for (; p < end; p++)
+    {
+        if ((*p < '0') || (*p > '9')) return false;
+        result = result * 10 + (*p - '0');
+    }
+    *time = negative ? -result : result;
+    return true;
+}
+
+static void appendValue(RecordingColumn *column, qint64 time, double value, const QString& text)
+{
+    if (!text.isNull() && column->texts.isEmpty())
+    {
+        column->texts.resize(column->values.size());
+    }
+    column->times.append(time);
+    column->values.append(text.isNull() ? value : qQNaN());
+    if (!column->texts.isEmpty())
+    {
+        column->texts.append(text);
+    }
+}
+
+int RecordingColumn::size() const
+{
+    return times.size();
+}
+
+bool RecordingColumn::isEmpty() const
+{
+    return times.isEmpty();
+}
+
+QString RecordingColumn::textAt(int index) const
+{
+    if (!texts.isEmpty() && !texts[index].isNull())
+    {
+        return texts[index];
+    }
+    return QString::number(values[index]);
+}
+
+int RecordingColumn::lowerBound(qint64 time) const
+{
+    return std::lower_bound(times.constBegin(), times.constEnd(), time) - times.constBegin();
+}
+
+RecordingFile::RecordingFile(QString path) : _path(path) { }
+
+bool RecordingFile::parseFileName(const QString& fileName, QString *logName, QString *trialName)
+{
+    static const QRegularExpression pattern("^([a-z]+)_(.+)\\.csv$");
+    QRegularExpressionMatch match = pattern.match(fileName);
+    if (!match.hasMatch()) return false;
+    *logName = match.captured(1);
+    *trialName = match.captured(2);
+    return true;
+}
+
+bool RecordingFile::open()
+{
+    if (!parseFileName(QFileInfo(_path).fileName(), &_logName, &_trialName))
+    {
+        _error = "Not a recording file name";
+        return false;
+    }
+    _file.setFileName(_path);
+    if (!_file.open(QIODevice::ReadOnly))
+    {
+        _error = _file.errorString();
+        return false;
+    }
+    _size = _file.size();
+    _data = _size > 0 ? reinterpret_cast<const char*>(_file.map(0, _size)) : nullptr;
+    if (!_data)
+    {
+        _error = _size > 0 ? "Cannot map file: " + _file.errorString() : "File is empty";
+        _file.close();
+        return false;
+    }
+
+    qint64 pos = 0;
+    QByteArray started, interval, blank, header;
+    if (!readLine(&pos, &started) || !readLine(&pos, &interval) || !readLine(&pos, &blank) || !readLine(&pos, &header)
+            || !started.startsWith("Recording started at "))
+    {
+        _error = "Missing recording header";
+        finish();
+        return false;
+    }
+
+    _startTime = QDateTime::fromString(QString::fromUtf8(started.mid(21)), Qt::TextDate);
+    if (!_startTime.isValid())
+    {
+        // The file name has everything but the year
+        _startTime = QDateTime::fromString(_trialName, "M-dd_h.mm.ss_AP");
+        if (_startTime.isValid())
+        {
+            _startTime.setDate(_startTime.date().addYears(QFileInfo(_path).lastModified().date().year() - _startTime.date().year()));
+        }
+    }
+    static const QRegularExpression intervalPattern("every (\\d+) ");
+    QRegularExpressionMatch match = intervalPattern.match(QString::fromLatin1(interval));
+    _updateInterval = match.hasMatch() ? match.captured(1).toInt() : 0;
+
+    // Every column is written as its name then its name with (timestamp)
+    QList<QByteArray> names = header.split(',');
+    for (int i = 0; i + 1 < names.size(); i += 2)
+    {
+        RecordingColumn column;
+        column.name = QString::fromUtf8(names[i]);
+        _columnIndex.insert(column.name, _columns.size());
+        _columns.append(column);
+    }
+    if (_columns.isEmpty())
+    {
+        _error = "No columns in recording header";
+        finish();
+        return false;
+    }
+
+    while (pos < _size)
+    {
+        Chunk chunk;
+        chunk.begin = pos;
+        chunk.end = qMin(pos + CHUNK_SIZE, _size);
+        const char *newline = chunk.end < _size
+                ? reinterpret_cast<const char*>(memchr(_data + chunk.end, '\n', _size - chunk.end)) : nullptr;
+        chunk.end = newline ? (newline - _data) + 1 : _size;
+        pos = chunk.end;
+        _chunks.append(chunk);
+    }
+    return true;
+}
+
+bool RecordingFile::readLine(qint64 *pos, QByteArray *line) const
+{
+    if (*pos >= _size) return false;
+    const char *begin = _data + *pos;
+    const char *newline = reinterpret_cast<const char*>(memchr(begin, '\n', _size - *pos));
+    const char *end = newline ? newline : _data + _size;
+    *pos = (end - _data) + 1;
+    if ((end > begin) && (end[-1] == '\r')) end--;
+    *line = QByteArray(begin, end - begin);
+    return true;
+}
+
+int RecordingFile::getChunkCount() const
+{
+    return _chunks.size();
+}
+
+void RecordingFile::parseChunk(int index)
+{
+    Chunk& chunk = _chunks[index];
+    chunk.columns.resize(_columns.size());
+    const char *p = _data + chunk.begin;
+    const char *end = _data + chunk.end;
+    while (p < end)
+    {
+        const char *newline = reinterpret_cast<const char*>(memchr(p, '\n', end - p));
+        const char *lineEnd = newline ? newline : end;
+        const char *rowEnd = ((lineEnd > p) && (lineEnd[-1] == '\r')) ? lineEnd - 1 : lineEnd;
+        if (rowEnd > p)
+        {
+            chunk.rows++;
+            parseRow(p, rowEnd, &chunk.columns);
+        }
+        p = lineEnd + 1;
+    }
+}
+
+void RecordingFile::parseRow(const char *begin, const char *end, QVector<RecordingColumn> *columns) const
+{
+    // Each row is a value then its timestamp for every column, each followed by a comma
+    int count = columns->size();
+    const char *cells[2];
+    const char *cellEnds[2];
+    const char *p = begin;
+    for (int i = 0; i < count; i++)
+    {
+        if (count == 1)
+        {
+            // Comments can have commas in them, so a single column is split on its last commas
+            const char *last = end;
+            if ((last > p) && (last[-1] == ',')) last--;
+            const char *comma = last;
+            while ((comma > p) && (comma[-1] != ',')) comma--;
+            if (comma == p) return;
+            cells[0] = p;
+            cellEnds[0] = comma - 1;
+            cells[1] = comma;
+            cellEnds[1] = last;
+        }
+        else
+        {
+            for (int j = 0; j < 2; j++)
+            {
+                if (p > end) return;
+                const char *comma = reinterpret_cast<const char*>(memchr(p, ',', end - p));
+                cells[j] = p;
+                cellEnds[j] = comma ? comma : end;
+                p = cellEnds[j] + 1;
+            }
+        }
+
+        qint64 time;
+        if ((cells[0] == cellEnds[0]) || !parseTime(cells[1], cellEnds[1], &time)) continue;
+        RecordingColumn& column = (*columns)[i];
+        if (!column.times.isEmpty() && (column.times.last() == time)) continue;
+
+        double value;
+        if (parseNumber(cells[0], cellEnds[0], &value))
+        {
+            appendValue(&column, time, value, QString());
+        }
+        else
+        {
+            appendValue(&column, time, 0, QString::fromUtf8(cells[0], cellEnds[0] - cells[0]));
+        }
+    }
+}
+
+void RecordingFile::finish()
+{
+    for (int i = 0; i < _columns.size(); i++)
+    {
+        RecordingColumn& column = _columns[i];
+        int total = 0;
+        for (const Chunk& chunk : _chunks)
+        {
+            if (i < chunk.columns.size()) total += chunk.columns[i].size();
+        }
+        column.times.reserve(total);
+        column.values.reserve(total);
+        for (const Chunk& chunk : _chunks)
+        {
+            if (i >= chunk.columns.size()) continue;
+            const RecordingColumn& part = chunk.columns[i];
+            for (int j = 0; j < part.size(); j++)
+            {
+                // A value kept across the chunk boundary is still the same value
+                if (!column.times.isEmpty() && (column.times.last() == part.times[j])) continue;
+                appendValue(&column, part.times[j], part.values[j],
+                            part.texts.isEmpty() ? QString() : part.texts[j]);
+            }
+        }
+        if (!column.isEmpty())
+        {
+            _endTime = qMax(_endTime, column.times.last());
+        }
+    }
+    for (const Chunk& chunk : _chunks)
+    {
+        _rowCount += chunk.rows;
+    }
+    _chunks.clear();
+
+    if (_data)
+    {
+        _file.unmap(reinterpret_cast<uchar*>(const_cast<char*>(_data)));
+        _data = nullptr;
+    }
+    _file.close();
+}
+
+QString RecordingFile::getPath() const
+{
+    return _path;
+}
+
+QString RecordingFile::getError() const
+{
+    return _error;
+}
+
+qint64 RecordingFile::getSize() const
+{
+    return _size;
+}
+
+QString RecordingFile::getLogName() const
+{
+    return _logName;
+}
+
+QString RecordingFile::getTrialName() const
+{
+    return _trialName;
+}
+
+QDateTime RecordingFile::getStartTime() const
+{
+    return _startTime;
+}
+
+int RecordingFile::getUpdateInterval() const
+{
+    return _updateInterval;
+}
+
+qint64 RecordingFile::getRowCount() const
+{
+    return _rowCount;
+}
+
+qint64 RecordingFile::getEndTime() const
+{
+    return _endTime;
+}
+
+QStringList RecordingFile::getColumnNames() const
+{
+    QStringList names;
+    for (const RecordingColumn& column : _columns)
+    {
+        names << column.name;
+    }
+    return names;
+}
+
+const RecordingColumn* RecordingFile::getColumn(const QString& name) const
+{
+    int index = _columnIndex.value(name, -1);
+    return index < 0 ? nullptr : &_columns[index];
+}
+
+} // namespace Soro
@@ -0,0 +1,106 @@
+#ifndef SORO_RECORDINGFILE_H
+#define SORO_RECORDINGFILE_H
+
+#include <QtCore>
+
+namespace Soro {
+
+/* Every value recorded in one column of a CSV recording, in the order it was recorded.
+ * Times are milliseconds from the start of the recording. A value recorded again with the
+ * same timestamp (as columns that keep their old values are on every row) is only kept once.
+ */
+struct RecordingColumn
+{
+    QString name;
+    QVector<qint64> times;
+    /* NaN where the value isn't a number
+     */
+    QVector<double> values;
+    /* Empty unless some value in the column isn't a number, then one per value
+     */
+    QVector<QString> texts;
+
+    int size() const;
+    bool isEmpty() const;
+    QString textAt(int index) const;
+
+    /* Gets the index of the first value recorded at or after a time
+     */
+    int lowerBound(qint64 time) const;
+};
+
+/* A CSV file written by CsvRecorder (data_, comments_ or settings_ followed by the time the
+ * recording started), memory mapped and parsed in chunks that can be handed to different threads.
+ *
+ * open() reads the header and splits the rows into chunks, parseChunk() can then be called for
+ * every chunk from any thread, and finish() puts the chunks back together.
+ */
+class RecordingFile {
+public:
+    explicit RecordingFile(QString path);
+
+    bool open();
+    int getChunkCount() const;
+    void parseChunk(int index);
+    void finish();
+
+    QString getPath() const;
+    QString getError() const;
+    qint64 getSize() const;
+
+    /* Gets the recorder the file came from, such as "data" or "comments"
+     */
+    QString getLogName() const;
+    /* Gets the part of the file name shared by every file from the same recording
+     */
+    QString getTrialName() const;
+    QDateTime getStartTime() const;
+    /* Gets the row interval in milliseconds, or 0 if rows were written on demand
+     */
+    int getUpdateInterval() const;
+    qint64 getRowCount() const;
+    /* Gets the latest time any value in the file was recorded at
+     */
+    qint64 getEndTime() const;
+
+    QStringList getColumnNames() const;
+    /* Gets a column by name, or null if the file doesn't have it
+     */
+    const RecordingColumn* getColumn(const QString& name) const;
+
+    /* Splits a file name into its recorder and trial names, returning false if it isn't
+     * a CsvRecorder file
+     */
+    static bool parseFileName(const QString& fileName, QString *logName, QString *trialName);
+
+private:
+    struct Chunk
+    {
+        qint64 begin;
+        qint64 end;
+        qint64 rows = 0;
+        QVector<RecordingColumn> columns;
+    };
+
+    QString _path;
+    QString _error;
+    QString _logName;
+    QString _trialName;
+    QDateTime _startTime;
+    int _updateInterval = 0;
+    qint64 _rowCount = 0;
+    qint64 _endTime = 0;
+    QFile _file;
+    const char *_data = nullptr;
+    qint64 _size = 0;
+    QVector<RecordingColumn> _columns;
+    QHash<QString, int> _columnIndex;
+    QVector<Chunk> _chunks;
+
+    bool readLine(qint64 *pos, QByteArray *line) const;
+    void parseRow(const char *begin, const char *end, QVector<RecordingColumn> *columns) const;
+};
+
+} // namespace Soro
+
+#endif // SORO_RECORDINGFILE_H
@@ -0,0 +1,33 @@
+QT += core
+
+CONFIG += c++11 no_keywords
+CONFIG += console
+CONFIG -= app_bundle
+TARGET = session_analyzer
+TEMPLATE = app
+
+BUILD_DIR = ../build/session_analyzer
+DESTDIR = ../bin
+OBJECTS_DIR = $$BUILD_DIR
+MOC_DIR = $$BUILD_DIR
+RCC_DIR = $$BUILD_DIR
+UI_DIR = $$BUILD_DIR
+PRECOMPILED_DIR = $$BUILD_DIR
+
+HEADERS += \
+    sessionanalyzer.h \
+    recordingfile.h \
+    trialanalysis.h \
+    summarytable.h
+
+SOURCES += \
+    main.cpp \
+    sessionanalyzer.cpp \
+    recordingfile.cpp \
+    trialanalysis.cpp \
+    summarytable.cpp
+
+# Include headers from other subprojects
+INCLUDEPATH += $$PWD/..
+
+LIBS += -L../lib -lsoro_core
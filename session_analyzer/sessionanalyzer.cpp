@@ -0,0 +1,268 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sessionanalyzer.h"
+#include "soro_core/logger.h"
+
+#include <algorithm>
+#include <cstring>
+
+#define LOG_TAG "SessionAnalyzer"
+
+//a video's file name is the time it started, which can be a little before its trial's data
+#define MEDIA_START_SLACK 5000
+#define DEFAULT_DEADZONE 10
+
+namespace Soro {
+
+SessionAnalyzer::SessionAnalyzer(Executor *executor)
+    : _executor(executor),
+      _trialTable("Trials", TrialAnalysis::summaryHeaders()),
+      _conditionTable("Conditions", TrialAnalysis::conditionHeaders()),
+      _outageTable("Link outages", TrialAnalysis::outageHeaders()),
+      _logTable("Logs", QStringList() << "Log" << "Lines" << "Warnings" << "Errors")
+{
+    _deadzone = DEFAULT_DEADZONE;
+}
+
+SessionAnalyzer::~SessionAnalyzer()
+{
+    qDeleteAll(_files);
+}
+
+void SessionAnalyzer::setDeadzone(double percent)
+{
+    _deadzone = percent;
+}
+
+bool SessionAnalyzer::analyze(QString directory)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QStringList recordingPaths, logPaths, mediaPaths;
+    QDirIterator it(directory, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+    {
+        QString path = it.next();
+        QString suffix = it.fileInfo().suffix().toLower();
+        QString logName, trialName;
+        if ((suffix == "csv") && RecordingFile::parseFileName(it.fileName(), &logName, &trialName))
+        {
+            recordingPaths << path;
+        }
+        else if (suffix == "log")
+        {
+            logPaths << path;
+        }
+        else if ((suffix == "avi") || (suffix == "mp4") || (suffix == "mkv"))
+        {
+            mediaPaths << path;
+        }
+    }
+    if (recordingPaths.isEmpty() && logPaths.isEmpty())
+    {
+        _error = "No recordings or logs found in " + directory;
+        return false;
+    }
+
+    // Headers are read here, everything else is parsed in parallel
+    for (const QString& path : recordingPaths)
+    {
+        RecordingFile *file = new RecordingFile(path);
+        if (!file->open())
+        {
+            LOG_W(LOG_TAG, path + ": " + file->getError() + ", skipping it");
+            delete file;
+            continue;
+        }
+        _bytesRead += file->getSize();
+        _files << file;
+    }
+    QVector<LogSummary> logs(logPaths.size());
+    QVector<Executor::Task> tasks;
+    for (int i = 0; i < logPaths.size(); i++)
+    {
+        logs[i].path = logPaths[i];
+        _bytesRead += QFileInfo(logPaths[i]).size();
+        LogSummary *summary = &logs[i];
+        tasks << [summary]() { summarizeLog(summary); };
+    }
+    for (RecordingFile *file : _files)
+    {
+        for (int i = 0; i < file->getChunkCount(); i++)
+        {
+            tasks << [file, i]() { file->parseChunk(i); };
+        }
+    }
+    runAll(tasks);
+
+    tasks.clear();
+    for (RecordingFile *file : _files)
+    {
+        tasks << [file]() { file->finish(); };
+    }
+    runAll(tasks);
+
+    groupTrials();
+    assignMedia(mediaPaths);
+
+    QList<TrialAnalysis*> analyses;
+    tasks.clear();
+    for (const Trial& trial : _trials)
+    {
+        TrialAnalysis *analysis = new TrialAnalysis(&trial, _deadzone);
+        analyses << analysis;
+        tasks << [analysis]() { analysis->run(); };
+    }
+    runAll(tasks);
+
+    for (const TrialAnalysis *analysis : analyses)
+    {
+        _trialTable.addRow(analysis->getSummaryRow());
+        _conditionTable.addRows(analysis->getConditionRows());
+        _outageTable.addRows(analysis->getOutageRows());
+    }
+    qDeleteAll(analyses);
+
+    std::sort(logs.begin(), logs.end(), [](const LogSummary& a, const LogSummary& b) { return a.path < b.path; });
+    QDir root(directory);
+    for (const LogSummary& log : logs)
+    {
+        _logTable.addRow(QStringList() << root.relativeFilePath(log.path) << QString::number(log.lines)
+                         << QString::number(log.warnings) << QString::number(log.errors));
+    }
+    _logCount = logs.size();
+
+    _elapsed = timer.elapsed();
+    if (_trials.isEmpty() && logs.isEmpty())
+    {
+        _error = "None of the recordings in " + directory + " could be read";
+        return false;
+    }
+    return true;
+}
+
+void SessionAnalyzer::runAll(const QVector<Executor::Task>& tasks)
+{
+    QSemaphore done;
+    for (const Executor::Task& task : tasks)
+    {
+        _executor->post([&done, task]()
+        {
+            task();
+            done.release();
+        });
+    }
+    done.acquire(tasks.size());
+}
+
+void SessionAnalyzer::groupTrials()
+{
+    // Every recorder started by the same press of record has the same start time in its file name
+    QMap<QString, Trial> trials;
+    for (const RecordingFile *file : _files)
+    {
+        Trial& trial = trials[file->getTrialName()];
+        trial.name = file->getTrialName();
+        trial.files << file;
+        if (!trial.startTime.isValid() || (file->getStartTime().isValid() && (file->getStartTime() < trial.startTime)))
+        {
+            trial.startTime = file->getStartTime();
+        }
+    }
+    _trials = trials.values();
+    std::sort(_trials.begin(), _trials.end(), [](const Trial& a, const Trial& b)
+    {
+        return a.startTime < b.startTime;
+    });
+}
+
+void SessionAnalyzer::assignMedia(const QStringList& mediaFiles)
+{
+    for (const QString& path : mediaFiles)
+    {
+        QFileInfo info(path);
+        QDateTime started = QDateTime::fromString(info.completeBaseName(), "M-dd_h.mm.ss_AP");
+        if (!started.isValid()) continue;
+
+        // The file name has no year, so it is taken from the trial it's compared to
+        Trial *match = nullptr;
+        for (Trial& trial : _trials)
+        {
+            if (!trial.startTime.isValid()) continue;
+            QDateTime time = started.addYears(trial.startTime.date().year() - started.date().year());
+            qint64 offset = trial.startTime.msecsTo(time);
+            if ((offset >= -MEDIA_START_SLACK) && (offset <= trial.getDuration()))
+            {
+                match = &trial;
+            }
+        }
+        if (match)
+        {
+            match->mediaFiles << path;
+            match->mediaBytes += info.size();
+        }
+    }
+}
+
+void SessionAnalyzer::summarizeLog(LogSummary *summary)
+{
+    QFile file(summary->path);
+    if (!file.open(QIODevice::ReadOnly) || (file.size() == 0)) return;
+    const char *data = reinterpret_cast<const char*>(file.map(0, file.size()));
+    if (!data)
+    {
+        LOG_W(LOG_TAG, "Cannot map " + summary->path + ", skipping it");
+        return;
+    }
+    const char *end = data + file.size();
+    for (const char *p = data; p < end;)
+    {
+        // Log lines start with their level, as [W] or [E]
+        if ((end - p >= 3) && (p[0] == '[') && (p[2] == ']'))
+        {
+            if (p[1] == 'W') summary->warnings++;
+            else if (p[1] == 'E') summary->errors++;
+        }
+        summary->lines++;
+        const char *newline = reinterpret_cast<const char*>(memchr(p, '\n', end - p));
+        p = newline ? newline + 1 : end;
+    }
+    file.unmap(reinterpret_cast<uchar*>(const_cast<char*>(data)));
+}
+
+QString SessionAnalyzer::getError() const
+{
+    return _error;
+}
+
+QList<const SummaryTable*> SessionAnalyzer::getTables() const
+{
+    return QList<const SummaryTable*>() << &_trialTable << &_conditionTable << &_outageTable << &_logTable;
+}
+
+QString SessionAnalyzer::getStatistics() const
+{
+    double megabytes = _bytesRead / (1024.0 * 1024.0);
+    double secs = qMax(_elapsed, Q_INT64_C(1)) / 1000.0;
+    return "Read " + QString::number(_files.size()) + " recordings from " + QString::number(_trials.size())
+            + " trials and " + QString::number(_logCount) + " logs (" + QString::number(megabytes, 'f', 1)
+            + "MB) in " + QString::number(secs, 'f', 2) + "s (" + QString::number(megabytes / secs, 'f', 0)
+            + "MB/s) on " + QString::number(_executor->getThreadCount()) + " threads";
+}
+
+} // namespace Soro
@@ -0,0 +1,67 @@
+#ifndef SORO_SESSIONANALYZER_H
+#define SORO_SESSIONANALYZER_H
+
+#include <QtCore>
+
+#include "recordingfile.h"
+#include "summarytable.h"
+#include "trialanalysis.h"
+#include "soro_core/executor.h"
+
+namespace Soro {
+
+/* Finds every recording, log and video under a session directory (usually a copy of the
+ * research_data, research_media and log directories from a field day), and summarizes each trial.
+ *
+ * Files are parsed in chunks and trials are analyzed on the executor's workers, so a session
+ * is read about as fast as the disk allows.
+ */
+class SessionAnalyzer {
+public:
+    explicit SessionAnalyzer(Executor *executor);
+    ~SessionAnalyzer();
+
+    void setDeadzone(double percent);
+
+    /* Reads and analyzes a session, returning false if nothing in it could be read
+     */
+    bool analyze(QString directory);
+    QString getError() const;
+
+    QList<const SummaryTable*> getTables() const;
+
+    /* Gets how much was read and how long it took
+     */
+    QString getStatistics() const;
+
+private:
+    struct LogSummary
+    {
+        QString path;
+        qint64 lines = 0;
+        qint64 warnings = 0;
+        qint64 errors = 0;
+    };
+
+    Executor *_executor;
+    double _deadzone;
+    QString _error;
+    QList<RecordingFile*> _files;
+    QList<Trial> _trials;
+    SummaryTable _trialTable;
+    SummaryTable _conditionTable;
+    SummaryTable _outageTable;
+    SummaryTable _logTable;
+    int _logCount = 0;
+    qint64 _bytesRead = 0;
+    qint64 _elapsed = 0;
+
+    void runAll(const QVector<Executor::Task>& tasks);
+    void groupTrials();
+    void assignMedia(const QStringList& mediaFiles);
+    static void summarizeLog(LogSummary *summary);
+};
+
+} // namespace Soro
+
+#endif // SORO_SESSIONANALYZER_H
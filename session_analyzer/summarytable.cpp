@@ -0,0 +1,106 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "summarytable.h"
+
+//space between columns in text output
+#define COLUMN_GAP 2
+
+namespace Soro {
+
+SummaryTable::SummaryTable(QString title, QStringList headers) : _title(title), _headers(headers) { }
+
+void SummaryTable::addRow(const QStringList& row)
+{
+    _rows.append(row);
+}
+
+void SummaryTable::addRows(const QList<QStringList>& rows)
+{
+    _rows.append(rows);
+}
+
+QString SummaryTable::getTitle() const
+{
+    return _title;
+}
+
+int SummaryTable::getRowCount() const
+{
+    return _rows.size();
+}
+
+QString SummaryTable::toText() const
+{
+    QVector<int> widths(_headers.size());
+    for (int i = 0; i < _headers.size(); i++)
+    {
+        widths[i] = _headers[i].length();
+    }
+    for (const QStringList& row : _rows)
+    {
+        for (int i = 0; i < qMin(row.size(), widths.size()); i++)
+        {
+            widths[i] = qMax(widths[i], row[i].length());
+        }
+    }
+
+    QString text = _title + "\n";
+    QList<QStringList> lines;
+    lines << _headers;
+    lines.append(_rows);
+    for (const QStringList& line : lines)
+    {
+        QString formatted;
+        for (int i = 0; i < widths.size(); i++)
+        {
+            // The first column is a name, everything after it is a number or short label
+            QString cell = i < line.size() ? line[i] : QString();
+            formatted += i == 0 ? cell.leftJustified(widths[i]) : cell.rightJustified(widths[i] + COLUMN_GAP);
+        }
+        text += formatted + "\n";
+    }
+    return text;
+}
+
+bool SummaryTable::writeCsv(QString path) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    QTextStream stream(&file);
+    QList<QStringList> lines;
+    lines << _headers;
+    lines.append(_rows);
+    for (const QStringList& line : lines)
+    {
+        QStringList fields;
+        for (const QString& field : line)
+        {
+            fields << csvField(field);
+        }
+        stream << fields.join(',') << "\n";
+    }
+    stream.flush();
+    return file.error() == QFile::NoError;
+}
+
+QString SummaryTable::csvField(QString field)
+{
+    if (!field.contains(',') && !field.contains('"') && !field.contains('\n')) return field;
+    return "\"" + field.replace("\"", "\"\"") + "\"";
+}
+
+} // namespace Soro
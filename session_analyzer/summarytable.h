@@ -0,0 +1,33 @@
+#ifndef SORO_SUMMARYTABLE_H
+#define SORO_SUMMARYTABLE_H
+
+#include <QtCore>
+
+namespace Soro {
+
+/* A table of results, printed as aligned text or written as CSV for a spreadsheet
+ */
+class SummaryTable {
+public:
+    SummaryTable(QString title, QStringList headers);
+
+    void addRow(const QStringList& row);
+    void addRows(const QList<QStringList>& rows);
+
+    QString getTitle() const;
+    int getRowCount() const;
+
+    QString toText() const;
+    bool writeCsv(QString path) const;
+
+private:
+    QString _title;
+    QStringList _headers;
+    QList<QStringList> _rows;
+
+    static QString csvField(QString field);
+};
+
+} // namespace Soro
+
+#endif // SORO_SUMMARYTABLE_H
@@ -0,0 +1,331 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "trialanalysis.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <vector>
+
+//full travel of a gamepad axis as recorded
+#define AXIS_MAX 32767
+
+namespace Soro {
+
+/* Settings that define the conditions a stretch of a trial was run under
+ */
+static const char *CONDITION_COLUMNS[] = {
+    "Simulated Latency", "Video Mode", "Video Codec", "Video Width", "Video Height",
+    "Video Framerate", "Video Bitrate", "Audio Mode"
+};
+static const int CONDITION_COUNT = sizeof(CONDITION_COLUMNS) / sizeof(CONDITION_COLUMNS[0]);
+//the first condition is latency, the rest are video and audio settings
+static const int FIRST_VIDEO_CONDITION = 1;
+static const int LAST_VIDEO_CONDITION = 6;
+
+static QString number(double value, int precision)
+{
+    return std::isnan(value) ? QString("-") : QString::number(value, 'f', precision);
+}
+
+static QString seconds(qint64 msecs)
+{
+    return QString::number(msecs / 1000.0, 'f', 1);
+}
+
+const RecordingColumn* Trial::getColumn(const QString& name) const
+{
+    for (const RecordingFile *file : files)
+    {
+        const RecordingColumn *column = file->getColumn(name);
+        if (column && !column->isEmpty()) return column;
+    }
+    return nullptr;
+}
+
+qint64 Trial::getDuration() const
+{
+    qint64 duration = 0;
+    for (const RecordingFile *file : files)
+    {
+        duration = qMax(duration, file->getEndTime());
+    }
+    return duration;
+}
+
+qint64 Trial::getDataRowCount() const
+{
+    qint64 rows = 0;
+    for (const RecordingFile *file : files)
+    {
+        if (file->getLogName() == "data") rows = qMax(rows, file->getRowCount());
+    }
+    return rows;
+}
+
+TrialAnalysis::TrialAnalysis(const Trial *trial, double deadzone) : _trial(trial)
+{
+    _deadzone = deadzone / 100.0 * AXIS_MAX;
+}
+
+QStringList TrialAnalysis::summaryHeaders()
+{
+    return QStringList() << "Trial" << "Started" << "Duration (s)" << "Data rows"
+                         << "Latency p50 (ms)" << "Latency p90 (ms)" << "Latency p99 (ms)" << "Latency max (ms)"
+                         << "Mbed latency p50 (ms)" << "From rover (kb/s)" << "To rover (kb/s)"
+                         << "Drive active (%)" << "Drive inputs" << "Outages" << "Outage time (s)"
+                         << "Longest outage (s)" << "Video changes" << "Comments" << "Videos" << "Video size (MB)";
+}
+
+QStringList TrialAnalysis::conditionHeaders()
+{
+    return QStringList() << "Trial" << "From (s)" << "To (s)" << "Simulated latency (ms)" << "Video mode"
+                         << "Codec" << "Resolution" << "Framerate" << "Video bitrate" << "Audio mode"
+                         << "Latency samples" << "Latency p50 (ms)" << "Latency p90 (ms)" << "Latency p99 (ms)"
+                         << "From rover (kb/s)" << "Drive active (%)";
+}
+
+QStringList TrialAnalysis::outageHeaders()
+{
+    return QStringList() << "Trial" << "Channel" << "Start (s)" << "Duration (s)" << "Recovered";
+}
+
+void TrialAnalysis::run()
+{
+    _duration = _trial->getDuration();
+    const RecordingColumn *latencyColumn = _trial->getColumn("Actual Latency");
+    const RecordingColumn *fromRoverColumn = _trial->getColumn("Bitrate From Rover (b/s)");
+    const RecordingColumn *conditionColumns[CONDITION_COUNT];
+    for (int i = 0; i < CONDITION_COUNT; i++)
+    {
+        conditionColumns[i] = _trial->getColumn(CONDITION_COLUMNS[i]);
+    }
+
+    Distribution latency = distribution(latencyColumn, LLONG_MIN, LLONG_MAX);
+    Distribution mbedLatency = distribution(_trial->getColumn("Mbed Latency"), LLONG_MIN, LLONG_MAX);
+    Distribution fromRover = distribution(fromRoverColumn, LLONG_MIN, LLONG_MAX);
+    Distribution toRover = distribution(_trial->getColumn("Bitrate To Rover (b/s)"), LLONG_MIN, LLONG_MAX);
+    int inputs;
+    qint64 active = driveActivity(0, _duration, &inputs);
+    int outages;
+    qint64 outageTime, longestOutage;
+    findOutages(&outages, &outageTime, &longestOutage);
+
+    // Every time any condition changes starts a new stretch of the trial
+    QList<qint64> boundaries;
+    QSet<qint64> videoChanges;
+    for (int i = 0; i < CONDITION_COUNT; i++)
+    {
+        for (qint64 time : changeTimes(conditionColumns[i]))
+        {
+            if ((time > 0) && (time < _duration)) boundaries << time;
+            if ((i >= FIRST_VIDEO_CONDITION) && (i <= LAST_VIDEO_CONDITION)) videoChanges.insert(time);
+        }
+    }
+    boundaries << 0 << _duration;
+    std::sort(boundaries.begin(), boundaries.end());
+    boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+
+    const RecordingColumn *comments = _trial->getColumn("Comments");
+    _summaryRow << _trial->name << _trial->startTime.toString("yyyy-MM-dd hh:mm:ss") << seconds(_duration)
+                << QString::number(_trial->getDataRowCount())
+                << number(latency.p50, 0) << number(latency.p90, 0) << number(latency.p99, 0) << number(latency.max, 0)
+                << number(mbedLatency.p50, 0) << number(fromRover.mean / 1000, 1) << number(toRover.mean / 1000, 1)
+                << number(_duration > 0 ? active * 100.0 / _duration : qQNaN(), 1) << QString::number(inputs)
+                << QString::number(outages) << seconds(outageTime) << seconds(longestOutage)
+                << QString::number(videoChanges.size()) << QString::number(comments ? comments->size() : 0)
+                << QString::number(_trial->mediaFiles.size()) << number(_trial->mediaBytes / (1024.0 * 1024.0), 1);
+
+    for (int i = 0; i + 1 < boundaries.size(); i++)
+    {
+        qint64 from = boundaries[i];
+        qint64 to = boundaries[i + 1];
+        // The last stretch includes whatever was recorded at the very end
+        qint64 end = i + 2 == boundaries.size() ? to + 1 : to;
+        Distribution stretchLatency = distribution(latencyColumn, from, end);
+        Distribution stretchFromRover = distribution(fromRoverColumn, from, end);
+        int stretchInputs;
+        qint64 stretchActive = driveActivity(from, to, &stretchInputs);
+
+        QStringList row;
+        row << _trial->name << seconds(from) << seconds(to) << textAt(conditionColumns[0], from)
+            << textAt(conditionColumns[1], from) << textAt(conditionColumns[2], from)
+            << textAt(conditionColumns[3], from) + "x" + textAt(conditionColumns[4], from)
+            << textAt(conditionColumns[5], from) << textAt(conditionColumns[6], from)
+            << textAt(conditionColumns[7], from) << QString::number(stretchLatency.count)
+            << number(stretchLatency.p50, 0) << number(stretchLatency.p90, 0) << number(stretchLatency.p99, 0)
+            << number(stretchFromRover.mean / 1000, 1) << number(stretchActive * 100.0 / (to - from), 1);
+        _conditionRows << row;
+    }
+}
+
+TrialAnalysis::Distribution TrialAnalysis::distribution(const RecordingColumn *column, qint64 from, qint64 to)
+{
+    Distribution result;
+    if (!column) return result;
+    std::vector<double> values;
+    int last = column->lowerBound(to);
+    for (int i = column->lowerBound(from); i < last; i++)
+    {
+        if (!std::isnan(column->values[i])) values.push_back(column->values[i]);
+    }
+    if (values.empty()) return result;
+
+    std::sort(values.begin(), values.end());
+    double sum = 0;
+    for (double value : values)
+    {
+        sum += value;
+    }
+    result.count = static_cast<int>(values.size());
+    result.mean = sum / values.size();
+    // Nearest rank, so every percentile is a value that was actually measured
+    auto percentile = [&values](double p)
+    {
+        size_t rank = static_cast<size_t>(std::ceil(p * values.size()));
+        return values[qBound<size_t>(1, rank, values.size()) - 1];
+    };
+    result.p50 = percentile(0.5);
+    result.p90 = percentile(0.9);
+    result.p99 = percentile(0.99);
+    result.max = values.back();
+    return result;
+}
+
+double TrialAnalysis::valueAt(const RecordingColumn *column, qint64 time)
+{
+    if (!column) return qQNaN();
+    int index = column->lowerBound(time + 1) - 1;
+    return index < 0 ? qQNaN() : column->values[index];
+}
+
+QString TrialAnalysis::textAt(const RecordingColumn *column, qint64 time)
+{
+    if (!column) return "-";
+    // Settings are recorded just after the recording starts, and were in force before that
+    int index = qMax(column->lowerBound(time + 1) - 1, 0);
+    return column->textAt(index);
+}
+
+QList<qint64> TrialAnalysis::changeTimes(const RecordingColumn *column)
+{
+    QList<qint64> times;
+    if (!column) return times;
+    for (int i = 1; i < column->size(); i++)
+    {
+        if (column->textAt(i) != column->textAt(i - 1))
+        {
+            times << qMax(column->times[i], Q_INT64_C(0));
+        }
+    }
+    return times;
+}
+
+qint64 TrialAnalysis::driveActivity(qint64 from, qint64 to, int *inputs) const
+{
+    *inputs = 0;
+    const RecordingColumn *xColumn = _trial->getColumn("Gamepad X");
+    const RecordingColumn *yColumn = _trial->getColumn("Gamepad Y");
+    if (!xColumn && !yColumn) return 0;
+
+    // Unknown values compare as false, so count as the stick being centered
+    auto isActive = [this](double x, double y)
+    {
+        return (std::abs(x) > _deadzone) || (std::abs(y) > _deadzone);
+    };
+    double x = valueAt(xColumn, from);
+    double y = valueAt(yColumn, from);
+    int i = xColumn ? xColumn->lowerBound(from + 1) : 0;
+    int j = yColumn ? yColumn->lowerBound(from + 1) : 0;
+    bool wasActive = isActive(x, y);
+    qint64 time = from;
+    qint64 active = 0;
+    for (;;)
+    {
+        qint64 nextX = xColumn && (i < xColumn->size()) ? xColumn->times[i] : LLONG_MAX;
+        qint64 nextY = yColumn && (j < yColumn->size()) ? yColumn->times[j] : LLONG_MAX;
+        qint64 next = qMin(qMin(nextX, nextY), to);
+        if (wasActive) active += next - time;
+        if (next >= to) break;
+
+        time = next;
+        if (nextX == next) x = xColumn->values[i++];
+        if (nextY == next) y = yColumn->values[j++];
+        bool nowActive = isActive(x, y);
+        if (nowActive && !wasActive) (*inputs)++;
+        wasActive = nowActive;
+    }
+    return active;
+}
+
+void TrialAnalysis::findOutages(int *count, qint64 *total, qint64 *longest)
+{
+    *count = 0;
+    *total = 0;
+    *longest = 0;
+    const RecordingColumn *events = _trial->getColumn("Connection Events");
+    if (!events) return;
+
+    auto addOutage = [&](const QString& channel, qint64 start, qint64 end, bool recovered)
+    {
+        _outageRows << (QStringList() << _trial->name << channel << seconds(start) << seconds(end - start)
+                                      << (recovered ? "yes" : "no"));
+        (*count)++;
+        *total += end - start;
+        *longest = qMax(*longest, end - start);
+    };
+
+    // Events are written as "Main Channel CONNECTED", and a channel says it is disconnected
+    // again every time it retries, so only the first one starts an outage
+    QMap<QString, qint64> downSince;
+    for (int i = 0; i < events->size(); i++)
+    {
+        QString event = events->textAt(i);
+        QString channel = event.section(' ', 0, 1);
+        QString state = event.section(' ', -1);
+        qint64 time = qMax(events->times[i], Q_INT64_C(0));
+        if ((state == "DISCONNECTED") && !downSince.contains(channel))
+        {
+            downSince.insert(channel, time);
+        }
+        else if ((state == "CONNECTED") && downSince.contains(channel))
+        {
+            addOutage(channel, downSince.take(channel), time, true);
+        }
+    }
+    for (auto i = downSince.constBegin(); i != downSince.constEnd(); i++)
+    {
+        addOutage(i.key(), i.value(), qMax(_duration, i.value()), false);
+    }
+}
+
+QStringList TrialAnalysis::getSummaryRow() const
+{
+    return _summaryRow;
+}
+
+QList<QStringList> TrialAnalysis::getConditionRows() const
+{
+    return _conditionRows;
+}
+
+QList<QStringList> TrialAnalysis::getOutageRows() const
+{
+    return _outageRows;
+}
+
+} // namespace Soro
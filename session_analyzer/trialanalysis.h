@@ -0,0 +1,82 @@
+#ifndef SORO_TRIALANALYSIS_H
+#define SORO_TRIALANALYSIS_H
+
+#include <QtCore>
+
+#include "recordingfile.h"
+
+namespace Soro {
+
+/* Everything recorded between one press of record and the next stop: mission control's data,
+ * comments and settings files, the rover's data file if it was copied in alongside them, and
+ * any video recorded during it
+ */
+struct Trial
+{
+    QString name;
+    QDateTime startTime;
+    QList<const RecordingFile*> files;
+    QStringList mediaFiles;
+    qint64 mediaBytes = 0;
+
+    /* Gets a column from the first file that recorded anything in it, or null
+     */
+    const RecordingColumn* getColumn(const QString& name) const;
+    /* Gets the time of the last value recorded in any of the trial's files
+     */
+    qint64 getDuration() const;
+    qint64 getDataRowCount() const;
+};
+
+/* Works out the statistics for a trial. The data, settings and comments files are joined on their
+ * timestamps, which are all from the same start time, so every stretch of the trial with the same
+ * latency and video settings gets its own row in the conditions table.
+ *
+ * Each analysis only reads its own trial, so trials can be analyzed on different threads.
+ */
+class TrialAnalysis {
+public:
+    /* The deadzone is how far the drive stick has to be pushed to count as driving, as a
+     * percentage of its full travel
+     */
+    TrialAnalysis(const Trial *trial, double deadzone);
+
+    void run();
+
+    QStringList getSummaryRow() const;
+    QList<QStringList> getConditionRows() const;
+    QList<QStringList> getOutageRows() const;
+
+    static QStringList summaryHeaders();
+    static QStringList conditionHeaders();
+    static QStringList outageHeaders();
+
+private:
+    struct Distribution
+    {
+        int count = 0;
+        double mean = qQNaN();
+        double p50 = qQNaN();
+        double p90 = qQNaN();
+        double p99 = qQNaN();
+        double max = qQNaN();
+    };
+
+    const Trial *_trial;
+    double _deadzone;
+    qint64 _duration = 0;
+    QStringList _summaryRow;
+    QList<QStringList> _conditionRows;
+    QList<QStringList> _outageRows;
+
+    static Distribution distribution(const RecordingColumn *column, qint64 from, qint64 to);
+    static double valueAt(const RecordingColumn *column, qint64 time);
+    static QString textAt(const RecordingColumn *column, qint64 time);
+    static QList<qint64> changeTimes(const RecordingColumn *column);
+    qint64 driveActivity(qint64 from, qint64 to, int *inputs) const;
+    void findOutages(int *count, qint64 *total, qint64 *longest);
+};
+
+} // namespace Soro
+
+#endif // SORO_TRIALANALYSIS_H
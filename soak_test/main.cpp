@@ -0,0 +1,113 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+
+#include "soaktest.h"
+#include "soro_core/logger.h"
+
+using namespace Soro;
+
+/* Parses a video codec name (such as H264 or MJPEG) into its codec ID,
+ * returns CODEC_NULL if the name isn't recognized
+ */
+static quint8 parseVideoCodec(QString name)
+{
+    for (quint8 codec = GStreamerUtil::VIDEO_CODEC_H264; codec <= GStreamerUtil::VIDEO_CODEC_MJPEG; codec++)
+    {
+        if (GStreamerUtil::getCodecName(codec).compare(name, Qt::CaseInsensitive) == 0)
+        {
+            return codec;
+        }
+    }
+    return GStreamerUtil::CODEC_NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("soak_test");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Runs the rover for hours against simulated hardware and mission control, "
+                                     "and reports whether its memory, file descriptors, threads or latency crept up.");
+    parser.addHelpOption();
+    QCommandLineOption roverOption("rover", "Rover executable to test.", "path",
+                                   QCoreApplication::applicationDirPath() + "/rover");
+    QCommandLineOption outputOption("output", "Directory to write the log, samples and report to.", "directory",
+                                    QCoreApplication::applicationDirPath() + "/../soak/"
+                                    + QDateTime::currentDateTime().toString("yyyy-MM-dd_hh-mm-ss"));
+    QCommandLineOption durationOption("duration", "How long to run for, in minutes.", "minutes", "240");
+    QCommandLineOption sampleOption("sample-interval", "Seconds between samples.", "seconds", "10");
+    QCommandLineOption warmupOption("warmup", "Minutes at the start to leave out of the trend checks.", "minutes", "5");
+    QCommandLineOption recordOption("record-interval", "Minutes between starting and stopping data recording, 0 to never record.",
+                                    "minutes", "10");
+    QCommandLineOption codecOption("video-codec", "Codec to stream video in (H264, MPEG4, VP8, VP9, H265 or MJPEG).",
+                                   "codec", "H264");
+    QCommandLineOption rssOption("max-rss-growth", "Most rover memory growth allowed, in MB per hour.", "MB", "20");
+    QCommandLineOption rttOption("max-rtt-growth", "Most growth allowed in any round trip time, in milliseconds.", "ms", "20");
+    QCommandLineOption driftOption("max-latency-drift", "Most growth allowed in video latency, in milliseconds.", "ms", "50");
+    parser.addOptions({ roverOption, outputOption, durationOption, sampleOption, warmupOption, recordOption,
+                        codecOption, rssOption, rttOption, driftOption });
+    parser.process(a);
+
+    SoakTest::Options options;
+    options.roverPath = parser.value(roverOption);
+    options.outputDirectory = QDir::cleanPath(parser.value(outputOption));
+    options.duration = qRound(parser.value(durationOption).toDouble() * 60);
+    options.sampleInterval = qMax(parser.value(sampleOption).toInt(), 1);
+    options.recordingInterval = qRound(parser.value(recordOption).toDouble() * 60);
+    options.thresholds.warmup = parser.value(warmupOption).toDouble() * 60;
+    options.thresholds.maxRssGrowthMbPerHour = parser.value(rssOption).toDouble();
+    options.thresholds.maxRttGrowth = parser.value(rttOption).toDouble();
+    options.thresholds.maxLatencyDriftGrowth = parser.value(driftOption).toDouble();
+
+    // A modest stream, the same as the defaults in mission control's settings
+    options.videoProfile.codec = parseVideoCodec(parser.value(codecOption));
+    options.videoProfile.width = 640;
+    options.videoProfile.height = 480;
+    options.videoProfile.framerate = 30;
+    options.videoProfile.bitrate = 500000;
+    options.videoProfile.mjpeg_quality = 50;
+    options.videoProfile.grayscale = false;
+    options.audioProfile.codec = GStreamerUtil::AUDIO_CODEC_AC3;
+    options.audioProfile.bitrate = 32000;
+
+    Logger::rootLogger()->setMaxStdoutLevel(Logger::LogLevelInformation);
+
+    if (options.videoProfile.codec == GStreamerUtil::CODEC_NULL)
+    {
+        LOG_E("SoakTest", "Unknown video codec " + parser.value(codecOption));
+        return 2;
+    }
+    if (options.duration <= options.thresholds.warmup)
+    {
+        LOG_E("SoakTest", "The test must run for longer than the warmup period");
+        return 2;
+    }
+
+    SoakTest test(options);
+    QObject::connect(&test, &SoakTest::finished, &a, [&a](bool passed)
+    {
+        a.exit(passed ? 0 : 1);
+    });
+    if (!test.start())
+    {
+        return 2;
+    }
+    return a.exec();
+}
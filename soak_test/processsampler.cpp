@@ -0,0 +1,87 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "processsampler.h"
+
+namespace Soro {
+namespace ProcessSampler {
+
+ProcessStats& ProcessStats::operator+=(const ProcessStats& other)
+{
+    rssKb += other.rssKb;
+    threads += other.threads;
+    fds += other.fds;
+    processes += other.processes;
+    return *this;
+}
+
+ProcessStats sample(qint64 pid)
+{
+    ProcessStats stats;
+    QString procDir = "/proc/" + QString::number(pid);
+
+    QFile status(procDir + "/status");
+    if (!status.open(QIODevice::ReadOnly)) return stats;
+    // Lines look like "VmRSS:     12345 kB" and "Threads:    7"
+    for (QString line : QString(status.readAll()).split('\n'))
+    {
+        if (line.startsWith("VmRSS:"))
+        {
+            stats.rssKb = line.mid(6).trimmed().section(' ', 0, 0).toLongLong();
+        }
+        else if (line.startsWith("Threads:"))
+        {
+            stats.threads = line.mid(8).trimmed().toInt();
+        }
+    }
+    stats.fds = QDir(procDir + "/fd").entryList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::System).size();
+    stats.processes = 1;
+    return stats;
+}
+
+QList<qint64> children(qint64 pid)
+{
+    QList<qint64> result;
+    for (QString entry : QDir("/proc").entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+    {
+        bool ok;
+        qint64 candidate = entry.toLongLong(&ok);
+        if (!ok) continue;
+        QFile stat("/proc/" + entry + "/stat");
+        if (!stat.open(QIODevice::ReadOnly)) continue;
+        // "pid (name) state ppid ...", the name can contain spaces so parse from the last ')'
+        QString line = stat.readAll();
+        QStringList fields = line.mid(line.lastIndexOf(')') + 2).split(' ');
+        if ((fields.size() > 1) && (fields[1].toLongLong() == pid))
+        {
+            result.append(candidate);
+        }
+    }
+    return result;
+}
+
+ProcessStats sampleChildren(qint64 pid)
+{
+    ProcessStats total;
+    for (qint64 child : children(pid))
+    {
+        total += sample(child);
+    }
+    return total;
+}
+
+} // namespace ProcessSampler
+} // namespace Soro
@@ -0,0 +1,39 @@
+#ifndef SORO_PROCESSSAMPLER_H
+#define SORO_PROCESSSAMPLER_H
+
+#include <QtCore>
+
+namespace Soro {
+
+/* Reads resource usage of other processes out of /proc (so this only works on Linux)
+ */
+namespace ProcessSampler {
+
+struct ProcessStats
+{
+    // Resident set size in kilobytes
+    qint64 rssKb = 0;
+    int threads = 0;
+    int fds = 0;
+    // Number of processes these stats were added up from
+    int processes = 0;
+
+    ProcessStats& operator+=(const ProcessStats& other);
+};
+
+/* Gets the stats of a single process, the result has no processes if it does not exist
+ */
+ProcessStats sample(qint64 pid);
+
+/* Gets the IDs of the processes whose parent is the given process
+ */
+QList<qint64> children(qint64 pid);
+
+/* Gets the stats of all of a process's children added together
+ */
+ProcessStats sampleChildren(qint64 pid);
+
+} // namespace ProcessSampler
+} // namespace Soro
+
+#endif // SORO_PROCESSSAMPLER_H
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rtplatencyprobe.h"
+#include "soro_core/wirecodec.h"
+
+#include <limits>
+
+//fixed part of the RTP header, RFC 3550 section 5.1
+#define RTP_HEADER_LENGTH 12
+#define RTP_VERSION 2
+#define MAX_PACKET_LEN 65536
+
+namespace Soro {
+
+RtpLatencyProbe::RtpLatencyProbe(quint16 port, int clockRate, QObject *parent) : QObject(parent)
+{
+    _clockRate = clockRate;
+    _intervalMinOffset = std::numeric_limits<double>::infinity();
+    _socket = new QUdpSocket(this);
+    _bound = _socket->bind(QHostAddress::LocalHost, port);
+    connect(_socket, &QUdpSocket::readyRead, this, &RtpLatencyProbe::socketReadyRead);
+    _clock.start();
+}
+
+bool RtpLatencyProbe::isBound() const
+{
+    return _bound;
+}
+
+void RtpLatencyProbe::reset()
+{
+    _haveTimestamp = false;
+    _timestampWraps = 0;
+    _haveBaseline = false;
+    _intervalMinOffset = std::numeric_limits<double>::infinity();
+}
+
+void RtpLatencyProbe::socketReadyRead()
+{
+    static char packet[MAX_PACKET_LEN];
+    while (_socket->hasPendingDatagrams())
+    {
+        qint64 length = _socket->readDatagram(packet, sizeof(packet));
+        double now = _clock.nsecsElapsed() / 1000000.0;
+        Wire::Reader reader(packet, length > 0 ? (size_t)length : 0);
+        uint8_t flags = reader.read<uint8_t>();
+        uint8_t markerAndType = reader.read<uint8_t>();
+        reader.skip(2); // sequence number
+        uint32_t timestamp = reader.read<uint32_t>();
+        if (!reader.ok() || ((flags >> 6) != RTP_VERSION) || (length < RTP_HEADER_LENGTH)) continue;
+
+        // The marker bit is set on the last packet of each video frame
+        if (!(markerAndType & 0x80)) continue;
+
+        if (_haveTimestamp && (timestamp < _lastTimestamp) && (_lastTimestamp - timestamp > 0x80000000u))
+        {
+            _timestampWraps++;
+        }
+        _haveTimestamp = true;
+        _lastTimestamp = timestamp;
+
+        double captureTime = ((_timestampWraps << 32) + timestamp) * 1000.0 / _clockRate;
+        double offset = now - captureTime;
+        _intervalMinOffset = qMin(_intervalMinOffset, offset);
+        _frameCount++;
+    }
+}
+
+int RtpLatencyProbe::takeFrameCount()
+{
+    int count = _frameCount;
+    _frameCount = 0;
+    return count;
+}
+
+double RtpLatencyProbe::takeLatencyDrift()
+{
+    double offset = _intervalMinOffset;
+    _intervalMinOffset = std::numeric_limits<double>::infinity();
+    if (qIsInf(offset)) return qQNaN();
+    if (!_haveBaseline)
+    {
+        _baseline = offset;
+        _haveBaseline = true;
+    }
+    // The minimum filters out jitter, only a delay every frame in the interval had counts
+    return offset - _baseline;
+}
+
+} // namespace Soro
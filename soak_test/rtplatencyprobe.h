@@ -0,0 +1,59 @@
+#ifndef SORO_RTPLATENCYPROBE_H
+#define SORO_RTPLATENCYPROBE_H
+
+#include <QtCore>
+#include <QUdpSocket>
+
+namespace Soro {
+
+/* Watches an RTP video stream for frames arriving later and later.
+ *
+ * The sender and receiver don't share a clock, so absolute latency can't be measured.
+ * Instead each frame's arrival time is compared to its RTP timestamp (its capture time),
+ * and the smallest difference seen in an interval is reported relative to the first
+ * interval. Queues building up anywhere between the camera and here show up as this
+ * number growing.
+ */
+class RtpLatencyProbe: public QObject {
+    Q_OBJECT
+public:
+    /* Listens for RTP packets on a local port. clockRate is the RTP clock rate of the
+     * stream, which is 90kHz for every video payload we use
+     */
+    RtpLatencyProbe(quint16 port, int clockRate=90000, QObject *parent=nullptr);
+
+    bool isBound() const;
+
+    /* Gets the number of complete frames received since the last call
+     */
+    int takeFrameCount();
+
+    /* Gets how much later frames arrived in this interval than in the first one in
+     * milliseconds, or NaN if no frames arrived in this interval
+     */
+    double takeLatencyDrift();
+
+    /* Forgets the baseline, for when the stream restarts with new timestamps
+     */
+    void reset();
+
+private:
+    QUdpSocket *_socket;
+    int _clockRate;
+    bool _bound = false;
+    QElapsedTimer _clock;
+    bool _haveTimestamp = false;
+    quint32 _lastTimestamp = 0;
+    qint64 _timestampWraps = 0;
+    int _frameCount = 0;
+    double _intervalMinOffset;
+    bool _haveBaseline = false;
+    double _baseline = 0;
+
+private Q_SLOTS:
+    void socketReadyRead();
+};
+
+} // namespace Soro
+
+#endif // SORO_RTPLATENCYPROBE_H
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simulatedgps.h"
+
+#define FIX_INTERVAL 1000
+//center of the circle the receiver drives around (the OU campus), NmeaMessage assumes the western hemisphere
+#define CENTER_LATITUDE 35.2058
+#define CENTER_LONGITUDE 97.4457
+#define RADIUS_DEGREES 0.0005
+//seconds to go around the circle once
+#define LAP_TIME 600.0
+
+namespace Soro {
+
+SimulatedGps::SimulatedGps(SocketAddress rover, QObject *parent) : QObject(parent)
+{
+    _rover = rover;
+    _socket = new QUdpSocket(this);
+    _clock.start();
+    START_TIMER(_fixTimerId, FIX_INTERVAL);
+}
+
+QString SimulatedGps::checksummed(QString sentence)
+{
+    // XOR of every character between the $ and the *
+    QByteArray bytes = sentence.toLatin1();
+    unsigned char checksum = 0;
+    for (int i = 1; i < bytes.size(); i++)
+    {
+        checksum ^= (unsigned char)bytes[i];
+    }
+    return sentence + "*" + QString::number(checksum, 16).toUpper().rightJustified(2, '0') + "\r\n";
+}
+
+QString SimulatedGps::toNmeaAngle(double degrees, int degreeDigits)
+{
+    // NMEA angles are written as degrees followed by decimal minutes (ddmm.mmmm)
+    int wholeDegrees = (int)degrees;
+    double minutes = (degrees - wholeDegrees) * 60.0;
+    return QString::number(wholeDegrees).rightJustified(degreeDigits, '0')
+            + QString::number(minutes, 'f', 4).rightJustified(7, '0');
+}
+
+void SimulatedGps::timerEvent(QTimerEvent *e)
+{
+    QObject::timerEvent(e);
+    if (e->timerId() == _fixTimerId)
+    {
+        double angle = 2 * M_PI * (_clock.elapsed() / 1000.0) / LAP_TIME;
+        double latitude = CENTER_LATITUDE + RADIUS_DEGREES * qSin(angle);
+        double longitude = CENTER_LONGITUDE + RADIUS_DEGREES * qCos(angle);
+        int heading = ((int)qRadiansToDegrees(angle) + 90) % 360;
+        QString time = QDateTime::currentDateTimeUtc().toString("hhmmss.zzz").left(9);
+
+        QString nmea = checksummed("$GPGGA," + time + "," + toNmeaAngle(latitude, 2) + ",N,"
+                                   + toNmeaAngle(longitude, 3) + ",W,1,08,0.9,350.0,M,-26.0,M,,");
+        nmea += checksummed("$GPVTG," + QString::number(heading) + ".0,T," + QString::number(heading)
+                            + ".0,M,1.0,N,1.9,K,A");
+
+        // NUL terminated like the forwarders on the rover, which GpsServer has to cope with
+        QByteArray datagram = nmea.toLatin1();
+        datagram.append('\0');
+        _socket->writeDatagram(datagram, _rover.host, _rover.port);
+    }
+}
+
+} // namespace Soro
@@ -0,0 +1,35 @@
+#ifndef SORO_SIMULATEDGPS_H
+#define SORO_SIMULATEDGPS_H
+
+#include <QtCore>
+#include <QUdpSocket>
+
+#include "soro_core/socketaddress.h"
+#include "soro_core/constants.h"
+
+namespace Soro {
+
+/* Sends NMEA sentences to a rover's GpsServer once a second, for a receiver
+ * that is slowly driving in a circle
+ */
+class SimulatedGps: public QObject {
+    Q_OBJECT
+public:
+    SimulatedGps(SocketAddress rover, QObject *parent=nullptr);
+
+protected:
+    void timerEvent(QTimerEvent *e);
+
+private:
+    QUdpSocket *_socket;
+    SocketAddress _rover;
+    int _fixTimerId = TIMER_INACTIVE;
+    QElapsedTimer _clock;
+
+    static QString checksummed(QString sentence);
+    static QString toNmeaAngle(double degrees, int degreeDigits);
+};
+
+} // namespace Soro
+
+#endif // SORO_SIMULATEDGPS_H
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "simulatedmbed.h"
+#include "soro_core/logger.h"
+#include "soro_core/wirecodec.h"
+#include "soro_core/enums.h"
+
+//message types and ping format, these must match mbedchannel.cpp
+#define MSG_TYPE_NORMAL 1
+#define MSG_TYPE_HEARTBEAT 4
+#define MSG_TYPE_PING_REPLY 5
+#define PING_MARKER 0xFF
+#define PING_LENGTH 5
+//header on every packet, [mbed id][type][4 byte sequence] from the mbed and [0][mbed id][4 byte sequence] from the rover
+#define HEADER_LENGTH 6
+//must be well under MbedChannel's IDLE_CONNECTION_TIMEOUT
+#define HEARTBEAT_INTERVAL 250
+#define SENSOR_INTERVAL 100
+#define MAX_PACKET_LEN 1024
+
+namespace Soro {
+
+SimulatedMbed::SimulatedMbed(QHostAddress bindAddress, SocketAddress rover, QObject *parent) : QObject(parent)
+{
+    LOG_TAG = "SimulatedMbed";
+    _rover = rover;
+    _socket = new QUdpSocket(this);
+    connect(_socket, &QUdpSocket::readyRead, this, &SimulatedMbed::socketReadyRead);
+
+    // The rover has the same port bound on every address, both sides have to allow sharing it
+    _bound = _socket->bind(bindAddress, NETWORK_ROVER_MBED_PORT, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint);
+    if (!_bound)
+    {
+        LOG_E(LOG_TAG, "Cannot bind to " + bindAddress.toString() + ":" + QString::number(NETWORK_ROVER_MBED_PORT)
+              + ": " + _socket->errorString());
+        return;
+    }
+    _clock.start();
+    START_TIMER(_heartbeatTimerId, HEARTBEAT_INTERVAL);
+    START_TIMER(_sensorTimerId, SENSOR_INTERVAL);
+}
+
+bool SimulatedMbed::isBound() const
+{
+    return _bound;
+}
+
+int SimulatedMbed::takeDriveCommandCount()
+{
+    int count = _driveCommandCount;
+    _driveCommandCount = 0;
+    return count;
+}
+
+void SimulatedMbed::send(unsigned char type, const char *payload, int length)
+{
+    char packet[MAX_PACKET_LEN];
+    Wire::Writer writer(packet, sizeof(packet));
+    writer.write<uint8_t>(MBED_ID);
+    writer.write<uint8_t>(type);
+    writer.write<uint32_t>(_nextSendId++);
+    if (length > 0)
+    {
+        writer.writeBytes(payload, length);
+    }
+    if (writer.ok())
+    {
+        _socket->writeDatagram(packet, writer.position(), _rover.host, _rover.port);
+    }
+}
+
+void SimulatedMbed::socketReadyRead()
+{
+    char packet[MAX_PACKET_LEN];
+    while (_socket->hasPendingDatagrams())
+    {
+        qint64 length = _socket->readDatagram(packet, sizeof(packet));
+        if ((length <= HEADER_LENGTH) || (packet[0] != '\0') || (packet[1] != (char)MBED_ID)) continue;
+
+        const char *payload = packet + HEADER_LENGTH;
+        int payloadLength = (int)length - HEADER_LENGTH;
+        if (((unsigned char)payload[0] == PING_MARKER) && (payloadLength >= PING_LENGTH))
+        {
+            // Echo the timestamp back, just like the real mbed
+            send(MSG_TYPE_PING_REPLY, payload + 1, PING_LENGTH - 1);
+        }
+        else if ((unsigned char)payload[0] == MbedMessage_Drive)
+        {
+            _driveCommandCount++;
+        }
+    }
+}
+
+void SimulatedMbed::timerEvent(QTimerEvent *e)
+{
+    QObject::timerEvent(e);
+    if (e->timerId() == _heartbeatTimerId)
+    {
+        send(MSG_TYPE_HEARTBEAT, nullptr, 0);
+    }
+    else if (e->timerId() == _sensorTimerId)
+    {
+        // Slowly changing readings in SensorDataParser's format, a tag followed by 3 digits
+        double t = _clock.elapsed() / 1000.0;
+        int power = 500 + (int)(400 * qSin(t / 5.0));
+        int pitch = 400 + (int)(100 * qSin(t / 7.0));
+        int roll = 500 + (int)(100 * qCos(t / 11.0));
+        QByteArray data;
+        data.append('A').append(QString::number(power).rightJustified(3, '0').toLatin1());
+        data.append('B').append(QString::number(power).rightJustified(3, '0').toLatin1());
+        data.append('J').append(QString::number(pitch).rightJustified(3, '0').toLatin1());
+        data.append('K').append(QString::number(roll).rightJustified(3, '0').toLatin1());
+        send(MSG_TYPE_NORMAL, data.constData(), data.size());
+    }
+}
+
+} // namespace Soro
@@ -0,0 +1,52 @@
+#ifndef SORO_SIMULATEDMBED_H
+#define SORO_SIMULATEDMBED_H
+
+#include <QtCore>
+#include <QUdpSocket>
+#include <QHostAddress>
+
+#include "soro_core/socketaddress.h"
+#include "soro_core/constants.h"
+
+namespace Soro {
+
+/* Plays the part of the mbed for a rover running on the same machine.
+ *
+ * MbedChannel only accepts packets sent from its own port, so this binds the mbed port
+ * on a different loopback address than the rover. It sends heartbeats and made up
+ * sensor readings, echoes pings, and counts the drive commands it receives.
+ */
+class SimulatedMbed: public QObject {
+    Q_OBJECT
+public:
+    SimulatedMbed(QHostAddress bindAddress, SocketAddress rover, QObject *parent=nullptr);
+
+    bool isBound() const;
+
+    /* Gets the number of drive commands received since the last call
+     */
+    int takeDriveCommandCount();
+
+protected:
+    void timerEvent(QTimerEvent *e);
+
+private:
+    QString LOG_TAG;
+    QUdpSocket *_socket;
+    SocketAddress _rover;
+    bool _bound = false;
+    unsigned int _nextSendId = 1;
+    int _driveCommandCount = 0;
+    int _heartbeatTimerId = TIMER_INACTIVE;
+    int _sensorTimerId = TIMER_INACTIVE;
+    QElapsedTimer _clock;
+
+    void send(unsigned char type, const char *payload, int length);
+
+private Q_SLOTS:
+    void socketReadyRead();
+};
+
+} // namespace Soro
+
+#endif // SORO_SIMULATEDMBED_H
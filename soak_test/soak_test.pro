@@ -0,0 +1,43 @@
+QT += core network
+
+CONFIG += c++11 no_keywords
+CONFIG += console
+CONFIG -= app_bundle
+TARGET = soak_test
+TEMPLATE = app
+
+BUILD_DIR = ../build/soak_test
+DESTDIR = ../bin
+OBJECTS_DIR = $$BUILD_DIR
+MOC_DIR = $$BUILD_DIR
+RCC_DIR = $$BUILD_DIR
+UI_DIR = $$BUILD_DIR
+PRECOMPILED_DIR = $$BUILD_DIR
+
+HEADERS += \
+    soaktest.h \
+    soakreport.h \
+    simulatedmbed.h \
+    simulatedgps.h \
+    processsampler.h \
+    rtplatencyprobe.h \
+    ../research_control/mediaclient.h \
+    ../research_control/videoclient.h \
+    ../research_control/audioclient.h
+
+SOURCES += \
+    main.cpp \
+    soaktest.cpp \
+    soakreport.cpp \
+    simulatedmbed.cpp \
+    simulatedgps.cpp \
+    processsampler.cpp \
+    rtplatencyprobe.cpp \
+    ../research_control/mediaclient.cpp \
+    ../research_control/videoclient.cpp \
+    ../research_control/audioclient.cpp
+
+# Include headers from other subprojects
+INCLUDEPATH += $$PWD/..
+
+LIBS += -L../lib -lsoro_core
@@ -0,0 +1,291 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "soakreport.h"
+
+//size of each trend graph in the HTML report
+#define GRAPH_WIDTH 720
+#define GRAPH_HEIGHT 160
+#define GRAPH_MARGIN 40
+
+namespace Soro {
+
+QStringList SoakSample::columnNames()
+{
+    return QStringList() << "Elapsed (s)" << "Rover RSS (MB)" << "Rover threads" << "Rover open files"
+                         << "Streamer RSS (MB)" << "Streamer processes" << "Main channel RTT (ms)"
+                         << "Drive channel RTT (ms)" << "Mbed RTT (ms)" << "Video frames/s"
+                         << "Video latency drift (ms)" << "Audio bitrate (bit/s)" << "Drive commands/s";
+}
+
+QList<double> SoakSample::values() const
+{
+    return QList<double>() << elapsed << roverRssMb << roverThreads << roverFds << streamerRssMb
+                           << streamerProcesses << mainRtt << driveRtt << mbedRtt << videoFps
+                           << videoLatencyDrift << audioBitrate << driveCommandsPerSecond;
+}
+
+SoakReport::SoakReport(const QList<SoakSample>& samples, const SoakThresholds& thresholds,
+                       bool roverSurvived, QString roverExitReason)
+{
+    _samples = samples;
+    _thresholds = thresholds;
+
+    addCheck("Rover process stayed up", roverSurvived ? "yes" : roverExitReason, "no exits", roverSurvived);
+
+    int steady = steadyPoints(SoakSample::RoverRss).size();
+    if (steady < 3)
+    {
+        addCheck("Enough samples after warmup", QString::number(steady), "at least 3", false);
+        return;
+    }
+
+    double perHour;
+    fittedGrowth(SoakSample::RoverRss, &perHour);
+    addCheck("Rover memory growth", QString::number(perHour, 'f', 2) + " MB/hour",
+             QString::number(_thresholds.maxRssGrowthMbPerHour) + " MB/hour",
+             perHour <= _thresholds.maxRssGrowthMbPerHour);
+
+    fittedGrowth(SoakSample::StreamerRss, &perHour);
+    addCheck("Streamer memory growth", QString::number(perHour, 'f', 2) + " MB/hour",
+             QString::number(_thresholds.maxRssGrowthMbPerHour) + " MB/hour",
+             perHour <= _thresholds.maxRssGrowthMbPerHour);
+
+    double growth = fittedGrowth(SoakSample::RoverFds, &perHour);
+    addCheck("Rover open file growth", QString::number(growth, 'f', 1),
+             QString::number(_thresholds.maxFdGrowth), growth <= _thresholds.maxFdGrowth);
+
+    growth = fittedGrowth(SoakSample::RoverThreads, &perHour);
+    addCheck("Rover thread growth", QString::number(growth, 'f', 1),
+             QString::number(_thresholds.maxThreadGrowth), growth <= _thresholds.maxThreadGrowth);
+
+    growth = fittedGrowth(SoakSample::MainRtt, &perHour);
+    addCheck("Main channel RTT growth", QString::number(growth, 'f', 1) + " ms",
+             QString::number(_thresholds.maxRttGrowth) + " ms", growth <= _thresholds.maxRttGrowth);
+
+    growth = fittedGrowth(SoakSample::DriveRtt, &perHour);
+    addCheck("Drive channel RTT growth", QString::number(growth, 'f', 1) + " ms",
+             QString::number(_thresholds.maxRttGrowth) + " ms", growth <= _thresholds.maxRttGrowth);
+
+    growth = fittedGrowth(SoakSample::MbedRtt, &perHour);
+    addCheck("Mbed RTT growth", QString::number(growth, 'f', 1) + " ms",
+             QString::number(_thresholds.maxRttGrowth) + " ms", growth <= _thresholds.maxRttGrowth);
+
+    growth = fittedGrowth(SoakSample::VideoLatencyDrift, &perHour);
+    addCheck("Video latency growth", QString::number(growth, 'f', 1) + " ms",
+             QString::number(_thresholds.maxLatencyDriftGrowth) + " ms",
+             growth <= _thresholds.maxLatencyDriftGrowth);
+
+    double stalled = stalledFraction(SoakSample::VideoFps);
+    addCheck("Samples with no video", QString::number(stalled * 100, 'f', 1) + "%",
+             QString::number(_thresholds.maxStalledFraction * 100) + "%",
+             stalled <= _thresholds.maxStalledFraction);
+
+    stalled = stalledFraction(SoakSample::DriveCommands);
+    addCheck("Samples with no drive commands reaching the mbed", QString::number(stalled * 100, 'f', 1) + "%",
+             QString::number(_thresholds.maxStalledFraction * 100) + "%",
+             stalled <= _thresholds.maxStalledFraction);
+}
+
+void SoakReport::addCheck(QString name, QString measured, QString limit, bool passed)
+{
+    Check check;
+    check.name = name;
+    check.measured = measured;
+    check.limit = limit;
+    check.passed = passed;
+    _checks.append(check);
+    _passed &= passed;
+}
+
+QList<QPointF> SoakReport::steadyPoints(int column) const
+{
+    QList<QPointF> points;
+    for (const SoakSample& sample : _samples)
+    {
+        double value = sample.values()[column];
+        if ((sample.elapsed >= _thresholds.warmup) && !qIsNaN(value))
+        {
+            points.append(QPointF(sample.elapsed, value));
+        }
+    }
+    return points;
+}
+
+double SoakReport::fittedGrowth(int column, double *perHour) const
+{
+    // Least squares line through the samples taken after warmup
+    QList<QPointF> points = steadyPoints(column);
+    *perHour = 0;
+    if (points.size() < 2) return 0;
+    double meanX = 0, meanY = 0;
+    for (const QPointF& point : points)
+    {
+        meanX += point.x();
+        meanY += point.y();
+    }
+    meanX /= points.size();
+    meanY /= points.size();
+    double covariance = 0, variance = 0;
+    for (const QPointF& point : points)
+    {
+        covariance += (point.x() - meanX) * (point.y() - meanY);
+        variance += (point.x() - meanX) * (point.x() - meanX);
+    }
+    if (variance == 0) return 0;
+    double slope = covariance / variance;
+    *perHour = slope * 3600;
+    return slope * (points.last().x() - points.first().x());
+}
+
+double SoakReport::stalledFraction(int column) const
+{
+    int total = 0, stalled = 0;
+    for (const SoakSample& sample : _samples)
+    {
+        if (sample.elapsed < _thresholds.warmup) continue;
+        double value = sample.values()[column];
+        total++;
+        if (qIsNaN(value) || (value <= 0)) stalled++;
+    }
+    return total > 0 ? (double)stalled / total : 1;
+}
+
+bool SoakReport::passed() const
+{
+    return _passed;
+}
+
+QList<SoakReport::Check> SoakReport::getChecks() const
+{
+    return _checks;
+}
+
+QString SoakReport::getSummary() const
+{
+    QString summary;
+    for (const Check& check : _checks)
+    {
+        summary += QString(check.passed ? "PASS" : "FAIL") + "  " + check.name.leftJustified(50, ' ')
+                + check.measured + " (limit " + check.limit + ")\n";
+    }
+    summary += _passed ? "Soak test PASSED" : "Soak test FAILED";
+    return summary;
+}
+
+bool SoakReport::writeCsv(QString path) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    QTextStream stream(&file);
+    stream << SoakSample::columnNames().join(',') << "\n";
+    for (const SoakSample& sample : _samples)
+    {
+        QStringList row;
+        for (double value : sample.values())
+        {
+            row.append(qIsNaN(value) ? "" : QString::number(value));
+        }
+        stream << row.join(',') << "\n";
+    }
+    return true;
+}
+
+QString SoakReport::renderGraph(int column) const
+{
+    QList<QPointF> points;
+    double minY = 0, maxY = 0;
+    bool first = true;
+    for (const SoakSample& sample : _samples)
+    {
+        double value = sample.values()[column];
+        if (qIsNaN(value)) continue;
+        points.append(QPointF(sample.elapsed, value));
+        minY = first ? value : qMin(minY, value);
+        maxY = first ? value : qMax(maxY, value);
+        first = false;
+    }
+    QString name = SoakSample::columnNames()[column].toHtmlEscaped();
+    if (points.isEmpty())
+    {
+        return "<h3>" + name + "</h3><p>No data</p>\n";
+    }
+    if (maxY == minY)
+    {
+        maxY += 1;
+        minY -= 1;
+    }
+    double maxX = qMax(points.last().x(), 1.0);
+    double plotWidth = GRAPH_WIDTH - 2 * GRAPH_MARGIN;
+    // Half a margin above and below the plot, a whole one on either side for labels
+    double plotHeight = GRAPH_HEIGHT - GRAPH_MARGIN;
+
+    QString polyline;
+    for (const QPointF& point : points)
+    {
+        double x = GRAPH_MARGIN + point.x() / maxX * plotWidth;
+        double y = GRAPH_MARGIN / 2 + (maxY - point.y()) / (maxY - minY) * plotHeight;
+        polyline += QString::number(x, 'f', 1) + "," + QString::number(y, 'f', 1) + " ";
+    }
+    double warmupX = GRAPH_MARGIN + qMin(_thresholds.warmup / maxX, 1.0) * plotWidth;
+
+    QString svg = "<h3>" + name + "</h3>\n";
+    svg += QString("<svg width=\"%1\" height=\"%2\" xmlns=\"http://www.w3.org/2000/svg\">\n")
+            .arg(GRAPH_WIDTH).arg(GRAPH_HEIGHT);
+    svg += QString("<rect x=\"%1\" y=\"%2\" width=\"%3\" height=\"%4\" fill=\"#f4f4f4\"/>\n")
+            .arg(GRAPH_MARGIN).arg(GRAPH_MARGIN / 2).arg(plotWidth).arg(plotHeight);
+    svg += QString("<rect x=\"%1\" y=\"%2\" width=\"%3\" height=\"%4\" fill=\"#e0e0e0\"/>\n")
+            .arg(GRAPH_MARGIN).arg(GRAPH_MARGIN / 2).arg(warmupX - GRAPH_MARGIN).arg(plotHeight);
+    svg += "<polyline fill=\"none\" stroke=\"#1976D2\" stroke-width=\"1.5\" points=\"" + polyline + "\"/>\n";
+    svg += QString("<text x=\"2\" y=\"%1\" font-size=\"11\">%2</text>\n")
+            .arg(GRAPH_MARGIN / 2 + 10).arg(QString::number(maxY, 'g', 4));
+    svg += QString("<text x=\"2\" y=\"%1\" font-size=\"11\">%2</text>\n")
+            .arg(GRAPH_MARGIN / 2 + plotHeight).arg(QString::number(minY, 'g', 4));
+    svg += QString("<text x=\"%1\" y=\"%2\" font-size=\"11\" text-anchor=\"end\">%3 min</text>\n")
+            .arg(GRAPH_WIDTH - GRAPH_MARGIN).arg(GRAPH_HEIGHT - 4).arg(QString::number(maxX / 60, 'f', 0));
+    svg += "</svg>\n";
+    return svg;
+}
+
+bool SoakReport::writeHtml(QString path) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    QTextStream stream(&file);
+    stream << "<!DOCTYPE html>\n<html><head><meta charset=\"utf-8\"><title>Soak test report</title></head>\n<body>\n";
+    stream << "<h1>Soak test " << (_passed ? "PASSED" : "FAILED") << "</h1>\n";
+    stream << "<p>" << _samples.size() << " samples over "
+           << QString::number(_samples.isEmpty() ? 0 : _samples.last().elapsed / 60, 'f', 1)
+           << " minutes, the first " << QString::number(_thresholds.warmup / 60, 'f', 1)
+           << " minutes (shaded) are warmup and are not checked.</p>\n";
+    stream << "<table border=\"1\" cellpadding=\"4\" cellspacing=\"0\">\n"
+           << "<tr><th>Result</th><th>Check</th><th>Measured</th><th>Limit</th></tr>\n";
+    for (const Check& check : _checks)
+    {
+        stream << "<tr><td style=\"color:" << (check.passed ? "#388E3C\">PASS" : "#d32f2f\">FAIL") << "</td><td>"
+               << check.name.toHtmlEscaped() << "</td><td>" << check.measured.toHtmlEscaped() << "</td><td>"
+               << check.limit.toHtmlEscaped() << "</td></tr>\n";
+    }
+    stream << "</table>\n";
+    for (int column = SoakSample::Elapsed + 1; column < SoakSample::ColumnCount; column++)
+    {
+        stream << renderGraph(column);
+    }
+    stream << "</body></html>\n";
+    return true;
+}
+
+} // namespace Soro
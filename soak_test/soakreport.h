@@ -0,0 +1,91 @@
+#ifndef SORO_SOAKREPORT_H
+#define SORO_SOAKREPORT_H
+
+#include <QtCore>
+
+namespace Soro {
+
+/* One row of measurements taken during a soak test. Values that couldn't be measured
+ * in an interval are NaN.
+ */
+struct SoakSample
+{
+    /* Indices into columnNames() and values()
+     */
+    enum Column {
+        Elapsed, RoverRss, RoverThreads, RoverFds, StreamerRss, StreamerProcesses, MainRtt, DriveRtt,
+        MbedRtt, VideoFps, VideoLatencyDrift, AudioBitrate, DriveCommands, ColumnCount
+    };
+
+    double elapsed;             // Seconds since the test started
+    double roverRssMb;
+    double roverThreads;
+    double roverFds;
+    double streamerRssMb;       // All of the rover's streaming processes added together
+    double streamerProcesses;
+    double mainRtt;
+    double driveRtt;
+    double mbedRtt;
+    double videoFps;
+    double videoLatencyDrift;
+    double audioBitrate;
+    double driveCommandsPerSecond;
+
+    static QStringList columnNames();
+    QList<double> values() const;
+};
+
+/* Limits a soak test has to stay within to pass. Growth is measured between the end of the
+ * warmup period and the end of the test, using a least squares fit so one noisy sample
+ * can't fail the test.
+ */
+struct SoakThresholds
+{
+    double warmup = 300;                // Seconds to ignore while everything settles
+    double maxRssGrowthMbPerHour = 20;
+    double maxFdGrowth = 4;
+    double maxThreadGrowth = 4;
+    double maxRttGrowth = 20;           // Milliseconds
+    double maxLatencyDriftGrowth = 50;  // Milliseconds
+    double maxStalledFraction = 0.02;   // Fraction of samples allowed to have no video or no drive commands
+};
+
+/* Decides whether a soak test passed, and writes out its results as CSV and as an HTML
+ * report with a trend graph for every measurement
+ */
+class SoakReport {
+public:
+    struct Check
+    {
+        QString name;
+        QString measured;
+        QString limit;
+        bool passed;
+    };
+
+    SoakReport(const QList<SoakSample>& samples, const SoakThresholds& thresholds,
+               bool roverSurvived, QString roverExitReason);
+
+    bool passed() const;
+    QList<SoakReport::Check> getChecks() const;
+    QString getSummary() const;
+
+    bool writeCsv(QString path) const;
+    bool writeHtml(QString path) const;
+
+private:
+    QList<SoakSample> _samples;
+    SoakThresholds _thresholds;
+    QList<Check> _checks;
+    bool _passed = true;
+
+    void addCheck(QString name, QString measured, QString limit, bool passed);
+    QList<QPointF> steadyPoints(int column) const;
+    double fittedGrowth(int column, double *perHour) const;
+    double stalledFraction(int column) const;
+    QString renderGraph(int column) const;
+};
+
+} // namespace Soro
+
+#endif // SORO_SOAKREPORT_H
@@ -0,0 +1,344 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "soaktest.h"
+#include "processsampler.h"
+#include "soro_core/logger.h"
+#include "soro_core/enums.h"
+#include "soro_core/drivemessage.h"
+
+#include <QtMath>
+#include <climits>
+
+//mbed side of the loopback, Linux routes all of 127.0.0.0/8 to the loopback interface
+#define SIMULATED_MBED_ADDRESS "127.0.0.2"
+//rate at which scripted drive commands are sent, the same as a polled gamepad
+#define DRIVE_INTERVAL 50
+//seconds for the scripted gamepad to go through one full forward/turn/reverse cycle
+#define DRIVE_CYCLE 30.0
+//time to wait for the rover to stop before killing it
+#define ROVER_STOP_TIMEOUT 5000
+
+namespace Soro {
+
+SoakTest::SoakTest(const Options& options, QObject *parent) : QObject(parent)
+{
+    LOG_TAG = "SoakTest";
+    _options = options;
+}
+
+SoakTest::~SoakTest()
+{
+    if (_rover.state() != QProcess::NotRunning)
+    {
+        disconnect(&_rover, 0, this, 0);
+        _rover.kill();
+        _rover.waitForFinished(ROVER_STOP_TIMEOUT);
+    }
+}
+
+bool SoakTest::start()
+{
+    if (!QDir().mkpath(_options.outputDirectory))
+    {
+        LOG_E(LOG_TAG, "Cannot create output directory " + _options.outputDirectory);
+        return false;
+    }
+    Logger::rootLogger()->setLogfile(_options.outputDirectory + "/soak_test.log");
+
+    _mbed = new SimulatedMbed(QHostAddress(SIMULATED_MBED_ADDRESS), SocketAddress(QHostAddress::LocalHost, NETWORK_ROVER_MBED_PORT), this);
+    if (!_mbed->isBound())
+    {
+        LOG_E(LOG_TAG, "Cannot start the simulated mbed, is another rover or soak test running?");
+        return false;
+    }
+    _gps = new SimulatedGps(SocketAddress(QHostAddress::LocalHost, NETWORK_ROVER_GPS_PORT), this);
+
+    // Video is forwarded from the client to the probe, the same way mission control forwards it to its recorder
+    _videoProbe = new RtpLatencyProbe(NETWORK_MC_CAMERA_REC_PORT, 90000, this);
+    if (!_videoProbe->isBound())
+    {
+        LOG_E(LOG_TAG, "Cannot bind the video probe to port " + QString::number(NETWORK_MC_CAMERA_REC_PORT));
+        return false;
+    }
+
+    LOG_I(LOG_TAG, "Starting rover " + _options.roverPath + " with test sources");
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert(TEST_SOURCES_ENV, "1");
+    _rover.setProcessEnvironment(environment);
+    _rover.setProcessChannelMode(QProcess::MergedChannels);
+    _rover.setStandardOutputFile(_options.outputDirectory + "/rover.out");
+    connect(&_rover, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+            this, &SoakTest::roverFinished);
+    _rover.start(_options.roverPath, QStringList());
+    if (!_rover.waitForStarted(ROVER_STOP_TIMEOUT))
+    {
+        LOG_E(LOG_TAG, "Cannot start the rover: " + _rover.errorString());
+        return false;
+    }
+
+    _mainChannel = Channel::createClient(this, SocketAddress(QHostAddress::LocalHost, NETWORK_ALL_MAIN_CHANNEL_PORT), CHANNEL_NAME_MAIN,
+                                         Channel::TcpProtocol, QHostAddress::Any);
+    _driveChannel = Channel::createClient(this, SocketAddress(QHostAddress::LocalHost, NETWORK_ALL_DRIVE_CHANNEL_PORT), CHANNEL_NAME_DRIVE,
+                                          Channel::UdpProtocol, QHostAddress::Any);
+    connect(_mainChannel, &Channel::stateChanged, this, &SoakTest::mainChannelStateChanged);
+    connect(_mainChannel, &Channel::messageReceived, this, &SoakTest::mainChannelMessageReceived);
+
+    _videoClient = new VideoClient(MEDIAID_MAIN_CAMERA, SocketAddress(QHostAddress::LocalHost, NETWORK_ALL_MAIN_CAMERA_PORT), QHostAddress::Any, this);
+    _videoClient->addForwardingAddress(SocketAddress(QHostAddress::LocalHost, NETWORK_MC_CAMERA_REC_PORT));
+    connect(_videoClient, &VideoClient::stateChanged, this, &SoakTest::videoClientStateChanged);
+    _audioClient = new AudioClient(MEDIAID_AUDIO, SocketAddress(QHostAddress::LocalHost, NETWORK_ALL_AUDIO_PORT), QHostAddress::Any, this);
+
+    _mainChannel->open();
+    _driveChannel->open();
+
+    _clock.start();
+    START_TIMER(_sampleTimerId, _options.sampleInterval * 1000);
+    START_TIMER(_driveTimerId, DRIVE_INTERVAL);
+    START_TIMER(_endTimerId, _options.duration * 1000);
+    if (_options.recordingInterval > 0)
+    {
+        START_TIMER(_recordingTimerId, _options.recordingInterval * 1000);
+    }
+    LOG_I(LOG_TAG, "Soak test started, it will run for " + QString::number(_options.duration / 60.0, 'f', 1) + " minutes");
+    return true;
+}
+
+void SoakTest::mainChannelStateChanged(Channel::State state)
+{
+    if (state == Channel::ConnectedState)
+    {
+        // A Channel will not send messages immediately after it connects
+        QTimer::singleShot(1000, this, [this]()
+        {
+            if (_mainChannel->getState() == Channel::ConnectedState)
+            {
+                startStreams();
+            }
+        });
+    }
+}
+
+void SoakTest::sendMainMessage(const QByteArray& message)
+{
+    if (_mainChannel->getState() == Channel::ConnectedState)
+    {
+        _mainChannel->sendMessage(message);
+    }
+}
+
+void SoakTest::startStreams()
+{
+    LOG_I(LOG_TAG, "Asking the rover to stream video (" + _options.videoProfile.toString()
+          + ") and audio (" + _options.audioProfile.toString() + ")");
+    QByteArray video;
+    QDataStream videoStream(&video, QIODevice::WriteOnly);
+    videoStream << static_cast<qint32>(MainMessageType_StartMonoCameraStream);
+    videoStream << _options.videoProfile.toString();
+    videoStream << false; // vaapi
+    sendMainMessage(video);
+
+    QByteArray audio;
+    QDataStream audioStream(&audio, QIODevice::WriteOnly);
+    audioStream << static_cast<qint32>(MainMessageType_RequestActivateAudioStream);
+    audioStream << _options.audioProfile.toString();
+    sendMainMessage(audio);
+}
+
+void SoakTest::mainChannelMessageReceived(const char *message, Channel::MessageSize size)
+{
+    QByteArray byteArray = QByteArray::fromRawData(message, size);
+    QDataStream stream(byteArray);
+    stream.setByteOrder(QDataStream::BigEndian);
+    qint32 messageType;
+    stream >> messageType;
+    if (messageType == MainMessageType_RoverMbedRtt)
+    {
+        qint32 rtt;
+        stream >> rtt;
+        _mbedRtt = rtt;
+    }
+    else if (messageType == MainMessageType_RoverMediaServerError)
+    {
+        qint32 mediaId;
+        QString error;
+        stream >> mediaId;
+        stream >> error;
+        LOG_W(LOG_TAG, "Rover media server " + QString::number(mediaId) + " reported an error: " + error);
+    }
+}
+
+void SoakTest::videoClientStateChanged(MediaClient *client, MediaClient::State state)
+{
+    Q_UNUSED(client);
+    if (state == MediaClient::StreamingState)
+    {
+        // A new stream starts its RTP timestamps over
+        _videoProbe->reset();
+    }
+}
+
+void SoakTest::drive()
+{
+    if (_driveChannel->getState() != Channel::ConnectedState) return;
+
+    // Forward, turn in place, reverse, then sit still, over and over
+    double phase = fmod(_clock.elapsed() / 1000.0, DRIVE_CYCLE) / DRIVE_CYCLE;
+    double left = 0, right = 0;
+    if (phase < 0.3)
+    {
+        left = right = qSin(phase / 0.3 * M_PI);
+    }
+    else if (phase < 0.5)
+    {
+        left = qSin((phase - 0.3) / 0.2 * M_PI);
+        right = -left;
+    }
+    else if (phase < 0.8)
+    {
+        left = right = -qSin((phase - 0.5) / 0.3 * M_PI);
+    }
+    char message[DriveMessage::RequiredSize];
+    DriveMessage::setGamepadData_DualStick(message, (short)(left * SHRT_MAX), (short)(right * SHRT_MAX), 0.5);
+    _driveChannel->sendMessage(message, DriveMessage::RequiredSize);
+}
+
+void SoakTest::toggleRecording()
+{
+    QByteArray message;
+    QDataStream stream(&message, QIODevice::WriteOnly);
+    if (_recording)
+    {
+        LOG_I(LOG_TAG, "Stopping data recording");
+        stream << static_cast<qint32>(MainMessageType_StopDataRecording);
+    }
+    else
+    {
+        LOG_I(LOG_TAG, "Starting data recording");
+        stream << static_cast<qint32>(MainMessageType_StartDataRecording);
+        stream << QDateTime::currentDateTime().toMSecsSinceEpoch();
+    }
+    _recording = !_recording;
+    sendMainMessage(message);
+}
+
+void SoakTest::sample()
+{
+    double now = _clock.elapsed() / 1000.0;
+    double interval = qMax(now - _lastSampleTime, 0.001);
+    _lastSampleTime = now;
+
+    ProcessSampler::ProcessStats rover = ProcessSampler::sample(_rover.processId());
+    ProcessSampler::ProcessStats streamers = ProcessSampler::sampleChildren(_rover.processId());
+
+    SoakSample sample;
+    sample.elapsed = now;
+    sample.roverRssMb = rover.rssKb / 1024.0;
+    sample.roverThreads = rover.threads;
+    sample.roverFds = rover.fds;
+    sample.streamerRssMb = streamers.rssKb / 1024.0;
+    sample.streamerProcesses = streamers.processes;
+    sample.mainRtt = _mainChannel->getState() == Channel::ConnectedState ? _mainChannel->getLastRtt() : qQNaN();
+    sample.driveRtt = _driveChannel->getState() == Channel::ConnectedState ? _driveChannel->getLastRtt() : qQNaN();
+    sample.mbedRtt = _mbedRtt >= 0 ? _mbedRtt : qQNaN();
+    sample.videoFps = _videoProbe->takeFrameCount() / interval;
+    sample.videoLatencyDrift = _videoProbe->takeLatencyDrift();
+    sample.audioBitrate = _audioClient->getBitrate();
+    sample.driveCommandsPerSecond = _mbed->takeDriveCommandCount() / interval;
+    _samples.append(sample);
+
+    LOG_I(LOG_TAG, QString("t=%1s rss=%2MB threads=%3 fds=%4 streamers=%5MB rtt=%6/%7/%8ms video=%9fps drift=%10ms")
+          .arg(QString::number(now, 'f', 0),
+               QString::number(sample.roverRssMb, 'f', 1),
+               QString::number(rover.threads),
+               QString::number(rover.fds),
+               QString::number(sample.streamerRssMb, 'f', 1),
+               QString::number(sample.mainRtt),
+               QString::number(sample.driveRtt),
+               QString::number(sample.mbedRtt),
+               QString::number(sample.videoFps, 'f', 1))
+          .arg(QString::number(sample.videoLatencyDrift, 'f', 1)));
+}
+
+void SoakTest::roverFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    _roverSurvived = false;
+    _roverExitReason = exitStatus == QProcess::CrashExit ? "crashed" : "exited with code " + QString::number(exitCode);
+    LOG_E(LOG_TAG, "The rover " + _roverExitReason + " after " + QString::number(_clock.elapsed() / 1000) + " seconds");
+    finish();
+}
+
+void SoakTest::finish()
+{
+    if (_finished) return;
+    _finished = true;
+    KILL_TIMER(_sampleTimerId);
+    KILL_TIMER(_driveTimerId);
+    KILL_TIMER(_recordingTimerId);
+    KILL_TIMER(_endTimerId);
+
+    if (_rover.state() != QProcess::NotRunning)
+    {
+        LOG_I(LOG_TAG, "Stopping the rover");
+        disconnect(&_rover, 0, this, 0);
+        _rover.terminate();
+        if (!_rover.waitForFinished(ROVER_STOP_TIMEOUT))
+        {
+            LOG_W(LOG_TAG, "The rover did not stop, killing it");
+            _rover.kill();
+            _rover.waitForFinished(ROVER_STOP_TIMEOUT);
+        }
+    }
+
+    SoakReport report(_samples, _options.thresholds, _roverSurvived, _roverExitReason);
+    QString csvPath = _options.outputDirectory + "/samples.csv";
+    QString htmlPath = _options.outputDirectory + "/report.html";
+    if (!report.writeCsv(csvPath))
+    {
+        LOG_E(LOG_TAG, "Cannot write " + csvPath);
+    }
+    if (!report.writeHtml(htmlPath))
+    {
+        LOG_E(LOG_TAG, "Cannot write " + htmlPath);
+    }
+    LOG_I(LOG_TAG, "Results:\n" + report.getSummary());
+    LOG_I(LOG_TAG, "Report written to " + htmlPath);
+    Q_EMIT finished(report.passed());
+}
+
+void SoakTest::timerEvent(QTimerEvent *e)
+{
+    QObject::timerEvent(e);
+    if (e->timerId() == _driveTimerId)
+    {
+        drive();
+    }
+    else if (e->timerId() == _sampleTimerId)
+    {
+        sample();
+    }
+    else if (e->timerId() == _recordingTimerId)
+    {
+        toggleRecording();
+    }
+    else if (e->timerId() == _endTimerId)
+    {
+        sample();
+        finish();
+    }
+}
+
+} // namespace Soro
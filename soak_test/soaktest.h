@@ -0,0 +1,100 @@
+#ifndef SORO_SOAKTEST_H
+#define SORO_SOAKTEST_H
+
+#include <QtCore>
+
+#include "soro_core/channel.h"
+#include "soro_core/gstreamerutil.h"
+#include "soro_core/constants.h"
+#include "research_control/videoclient.h"
+#include "research_control/audioclient.h"
+
+#include "simulatedmbed.h"
+#include "simulatedgps.h"
+#include "rtplatencyprobe.h"
+#include "soakreport.h"
+
+namespace Soro {
+
+/* Runs the rover for a long time on this machine with everything it talks to simulated,
+ * and watches it for slow leaks and latency creep.
+ *
+ * The rover is started as a child process with test sources in place of its cameras and
+ * microphone. This process takes the place of mission control (driving it with a scripted
+ * gamepad, streaming video and audio from it, and starting and stopping data recording
+ * now and then), as well as its mbed and GPS receiver.
+ *
+ * When the test is over, samples.csv and report.html are written to the output directory
+ * and finished() is emitted with whether the test passed.
+ */
+class SoakTest: public QObject {
+    Q_OBJECT
+public:
+    struct Options
+    {
+        QString roverPath;
+        QString outputDirectory;
+        int duration = 4 * 3600;        // Seconds
+        int sampleInterval = 10;        // Seconds
+        int recordingInterval = 600;    // Seconds between starting or stopping data recording, 0 to never record
+        GStreamerUtil::VideoProfile videoProfile;
+        GStreamerUtil::AudioProfile audioProfile;
+        SoakThresholds thresholds;
+    };
+
+    SoakTest(const Options& options, QObject *parent=nullptr);
+    ~SoakTest();
+
+    /* Starts the rover and begins the test, returns false if something couldn't be set up
+     */
+    bool start();
+
+Q_SIGNALS:
+    void finished(bool passed);
+
+protected:
+    void timerEvent(QTimerEvent *e);
+
+private:
+    QString LOG_TAG;
+    Options _options;
+    QProcess _rover;
+    bool _roverSurvived = true;
+    QString _roverExitReason;
+    bool _finished = false;
+    QElapsedTimer _clock;
+    double _lastSampleTime = 0;
+    QList<SoakSample> _samples;
+
+    SimulatedMbed *_mbed = nullptr;
+    SimulatedGps *_gps = nullptr;
+    Channel *_mainChannel = nullptr;
+    Channel *_driveChannel = nullptr;
+    VideoClient *_videoClient = nullptr;
+    AudioClient *_audioClient = nullptr;
+    RtpLatencyProbe *_videoProbe = nullptr;
+    int _mbedRtt = -1;
+    bool _recording = false;
+
+    int _sampleTimerId = TIMER_INACTIVE;
+    int _driveTimerId = TIMER_INACTIVE;
+    int _recordingTimerId = TIMER_INACTIVE;
+    int _endTimerId = TIMER_INACTIVE;
+
+    void sample();
+    void drive();
+    void toggleRecording();
+    void startStreams();
+    void sendMainMessage(const QByteArray& message);
+    void finish();
+
+private Q_SLOTS:
+    void mainChannelStateChanged(Channel::State state);
+    void mainChannelMessageReceived(const char *message, Channel::MessageSize size);
+    void videoClientStateChanged(MediaClient *client, MediaClient::State state);
+    void roverFinished(int exitCode, QProcess::ExitStatus exitStatus);
+};
+
+} // namespace Soro
+
+#endif // SORO_SOAKTEST_H
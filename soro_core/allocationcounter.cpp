@@ -0,0 +1,121 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "allocationcounter.h"
+
+#ifdef SORO_ALLOCATION_COUNTING
+
+#include <atomic>
+#include <stddef.h>
+#include <errno.h>
+
+// Constant initialized, so it is usable by allocations made before any constructors run
+static std::atomic<quint64> _allocations(0);
+
+extern "C" {
+
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void *__libc_valloc(size_t size);
+void *__libc_pvalloc(size_t size);
+
+void *malloc(size_t size)
+{
+    _allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    _allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    _allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+void *memalign(size_t alignment, size_t size)
+{
+    _allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    // glibc's aligned_alloc() is memalign() under another name
+    _allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size)
+{
+    // Checked here, as __libc_memalign() rounds a bad alignment up instead of failing
+    if ((alignment % sizeof(void*) != 0) || ((alignment & (alignment - 1)) != 0) || (alignment == 0))
+    {
+        return EINVAL;
+    }
+    _allocations.fetch_add(1, std::memory_order_relaxed);
+    void *memory = __libc_memalign(alignment, size);
+    if (!memory)
+    {
+        return ENOMEM;
+    }
+    *ptr = memory;
+    return 0;
+}
+
+void *valloc(size_t size)
+{
+    _allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_valloc(size);
+}
+
+void *pvalloc(size_t size)
+{
+    _allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_pvalloc(size);
+}
+
+} // extern "C"
+
+#endif // SORO_ALLOCATION_COUNTING
+
+namespace Soro {
+
+bool AllocationCounter::isEnabled()
+{
+#ifdef SORO_ALLOCATION_COUNTING
+    return true;
+#else
+    return false;
+#endif
+}
+
+quint64 AllocationCounter::getCount()
+{
+#ifdef SORO_ALLOCATION_COUNTING
+    return _allocations.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+} // namespace Soro
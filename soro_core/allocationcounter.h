@@ -0,0 +1,34 @@
+#ifndef SORO_ALLOCATIONCOUNTER_H
+#define SORO_ALLOCATIONCOUNTER_H
+
+#include <QtCore>
+
+#include "soro_core_global.h"
+
+namespace Soro {
+
+/* Counts heap allocations made anywhere in the process.
+ *
+ * glibc no longer has malloc hooks, so this works by defining the allocation functions in
+ * soro_core itself and passing them through to glibc's __libc_malloc() and friends. Every
+ * program linking soro_core picks these up ahead of libc's, including allocations made by Qt
+ * and GStreamer. The counted entry points are malloc(), calloc(), realloc(), memalign(),
+ * aligned_alloc(), posix_memalign(), valloc() and pvalloc(); operator new goes through these.
+ * Memory mapped with mmap() directly is not counted.
+ *
+ * This adds an atomic increment to every allocation, so it is only compiled in when soro_core
+ * is built with SORO_ALLOCATION_COUNTING defined (see soro_core.pro). Otherwise isEnabled()
+ * returns false and the count is always 0.
+ */
+class SORO_CORE_EXPORT AllocationCounter {
+public:
+    static bool isEnabled();
+
+    /* Gets the number of allocations made since the process started
+     */
+    static quint64 getCount();
+};
+
+} // namespace Soro
+
+#endif // SORO_ALLOCATIONCOUNTER_H
@@ -16,20 +16,54 @@
 
 #include "channel.h"
 #include "logger.h"
-#include "util.h"
+#include "wirecodec.h"
+#include "tracer.h"
 
 //rough rate at which handshakes are sent when trying to establish a UDP connection
 #define HANDSHAKE_FREQUENCY 250
-//timeout for dropping a connection with no received packets
+//timeout for dropping a connection with no received packets, regardless of the failure detector
 #define IDLE_CONNECTION_TIMEOUT 5000
+//the failure detector can never drop a connection that has been silent for less than this
+#define MIN_FAILURE_TIMEOUT 1000
 //rough rate at which this channel should send the other side an ack for their last packet
 #define STATISTICS_INTERVAL 500
-//rough rate at which heartbeats should be sent if no other packets are being sent
+//rough rate at which heartbeats are sent, on a fast link this drops towards MIN_HEARTBEAT_INTERVAL.
+//Heartbeats are sent even alongside other traffic, as they are all the failure detector is fed
 #define HEARTBEAT_INTERVAL 500
+#define MIN_HEARTBEAT_INTERVAL 100
+//the failure detector starts over once the peer's heartbeat interval changes by more than 1/this
+#define HEARTBEAT_CADENCE_CHANGE_DIVISOR 4
+//rate at which the connection is checked for silence and heartbeats are sent
+#define CONNECTION_MONITOR_INTERVAL 50
+//default failure detector suspicion levels to report the link as degraded, and to drop it
+#define DEFAULT_DEGRADED_PHI 3.0
+#define DEFAULT_FAILED_PHI 8.0
 //number of sent entries to log for rtt calculation
 #define SENT_LOG_CAP 300
 //delay after an error when a reconnect will be tried
 #define RECOVERY_DELAY 1000
+//unsent bytes a stream socket may hold before messages wait in the send queue
+#define DEFAULT_SEND_QUEUE_WATERMARK 8192
+//maximum number of messages waiting in the send queue
+#define DEFAULT_SEND_QUEUE_CAPACITY 256
+//default memory budget for the send queue and stream socket buffer together
+#define DEFAULT_SEND_BUDGET (4 * 1024 * 1024)
+//default memory budget for packets waiting out the simulated delay
+#define DEFAULT_DELAY_BUDGET (8 * 1024 * 1024)
+//fraction of the reorder delay between checks for packets that have waited too long
+#define REORDER_CHECK_DIVISOR 4
+//rate at which each path of a multipath UDP channel is probed
+#define PATH_PROBE_INTERVAL 200
+//a path is unhealthy if none of its probes have been answered for this long
+#define PATH_TIMEOUT 1000
+//number of probes loss is calculated over
+#define PATH_LOSS_WINDOW 10
+//ms added to a path's RTT for each percent of loss when picking the primary path
+#define PATH_LOSS_PENALTY 10
+//how much better (in ms) another path must be before it replaces the primary path
+#define PRIMARY_PATH_HYSTERESIS 20
+//maximum number of paths a multipath server will learn for its client
+#define MAX_UDP_PATHS 8
 
 //Tags for writing the configuration file
 #define CONFIG_TAG_SERVER_ADDRESS "serveraddress"
@@ -49,7 +83,15 @@
 
 namespace Soro {
 
-Channel::Channel(QObject *parent) : QObject(parent) { }
+Channel::Channel(QObject *parent) : QObject(parent)
+{
+    _sendQueueWatermark = DEFAULT_SEND_QUEUE_WATERMARK;
+    _sendQueueCapacity = DEFAULT_SEND_QUEUE_CAPACITY;
+    _degradedPhi = DEFAULT_DEGRADED_PHI;
+    _failedPhi = DEFAULT_FAILED_PHI;
+    _heartbeatInterval = HEARTBEAT_INTERVAL;
+    _peerHeartbeatInterval = HEARTBEAT_INTERVAL;
+}
 
 Channel* Channel::createClient(QObject *parent, SocketAddress serverAddress, QString name, Protocol protocol,
                  QHostAddress hostAddress)
@@ -82,6 +124,30 @@ Channel* Channel::createServer(QObject *parent, quint16 port, QString name, Prot
     return c;
 }
 
+Channel* Channel::createClient(QObject *parent, QString localAddress, QString name)
+{
+    Channel *c = new Channel(parent);
+    c->_localAddress = localAddress;
+    c->_isServer = false;
+    c->_name = name;
+
+    c->init();
+
+    return c;
+}
+
+Channel* Channel::createServer(QObject *parent, QString localAddress, QString name)
+{
+    Channel *c = new Channel(parent);
+    c->_localAddress = localAddress;
+    c->_isServer = true;
+    c->_name = name;
+
+    c->init();
+
+    return c;
+}
+
 Channel::~Channel()
 {
     if (_sentTimeLog != nullptr)
@@ -92,6 +158,14 @@ Channel::~Channel()
     {
         delete [] _nameUtf8;
     }
+    while (!_delayPackets.empty())
+    {
+        PacketWrapper *next = _delayPackets.dequeue();
+        delete [] next->data;
+        delete next;
+    }
+    delete _sendBudget;
+    delete _delayBudget;
 }
 
 /*  Initialization, creates timers, sockets, apply configuration
@@ -103,6 +177,8 @@ void Channel::init()
 {
     //log tag for debugging
     LOG_TAG = _name + (_isServer ? "(S)" : "(C)");
+    _traceSendName = Tracer::intern(LOG_TAG + " send");
+    _traceReceiveName = Tracer::intern(LOG_TAG + " receive");
 
     //format the name as a UTF8 byte array
     QByteArray toUtf8 = _name.toUtf8();
@@ -113,6 +189,32 @@ void Channel::init()
     //create a buffer for storing received messages
     _sentTimeLog = new qint64[SENT_LOG_CAP];
 
+    //cap what this channel can buffer if the link backs up
+    _sendBudget = new MemoryBudget("channel_send:" + _name, DEFAULT_SEND_BUDGET, MemoryBudget::DropOldest);
+    _delayBudget = new MemoryBudget("channel_delay:" + _name, DEFAULT_DELAY_BUDGET, MemoryBudget::Block);
+
+    if (!_localAddress.isEmpty())
+    {
+        //Same-host channel, the transport is picked by the address scheme
+        _transport = ChannelTransport::create(_localAddress, _isServer, this);
+        if (_transport == nullptr)
+        {
+            LOG_E(LOG_TAG, "Invalid local transport address " + _localAddress);
+            _protocol = UdpProtocol;
+            setChannelState(ErrorState, true);
+            return;
+        }
+        //Stream transports get TCP framing, datagram transports get UDP framing
+        _protocol = _transport->isStream() ? TcpProtocol : UdpProtocol;
+        LOG_I(LOG_TAG, "Initializing with localAddress=" + _localAddress
+              + ",protocol=" + (_protocol == TcpProtocol ? "stream" : "datagram"));
+        connect(_transport, &ChannelTransport::readyRead, this, &Channel::transportReadyRead);
+        connect(_transport, &ChannelTransport::connected, this, &Channel::transportConnected);
+        connect(_transport, &ChannelTransport::error, this, &Channel::transportErrorInternal);
+        setChannelState(ReadyState, false); //now safe to call open()
+        return;
+    }
+
     LOG_I(LOG_TAG, "Initializing with serverAddress=" + _serverAddress.toString()
           + ",protocol=" + (_protocol == TcpProtocol ? "TCP" : "UDP"));
 
@@ -161,8 +263,12 @@ void Channel::open()
             setChannelState(ErrorState, true);
             return;
         }
+        if (_transport != nullptr)
+        {
+            LOG_I(LOG_TAG, "Attempting to open local transport " + _localAddress);
+        }
         //If this is the server, we will bind to the server port
-        if (_isServer)
+        else if (_isServer)
         {
             _hostAddress.port = _serverAddress.port;
             LOG_I(LOG_TAG, "Attempting to bind to " + _hostAddress.toString());
@@ -192,15 +298,30 @@ void Channel::resetConnectionVars()
     {
         // Clear the delay packet queue
         PacketWrapper *next = _delayPackets.dequeue();
-        delete next->data;
+        delete [] next->data;
         delete next;
     }
+    _delayBudget->setUsage(0);
+    _sendQueue.clear();
+    _sendQueueBytes = 0;
+    _sendBudget->setUsage(0);
+    _failureDetector.reset(Clock::root()->msecsSinceEpoch(), HEARTBEAT_INTERVAL);
+    _heartbeatInterval = HEARTBEAT_INTERVAL;
+    _peerHeartbeatInterval = HEARTBEAT_INTERVAL;
+    setDegraded(false);
+    _dedupeHighestID = 0;
+    _dedupeMask = 0;
+    _reorderBuffer.clear();
+    _reorderNextID = 0;
+    _highestReceivedID = 0;
+    _reorderDepth = 0;
+    KILL_TIMER(_reorderTimerID);
     _receiveBufferLength = 0;
     _lastReceiveID = 0;
     _lastRtt = -1;
     _lastAckSendTime = 0;
     _lastAckReceiveTime = 0;
-    _connectionEstablishedTime = QDateTime::currentMSecsSinceEpoch();
+    _connectionEstablishedTime = Clock::root()->msecsSinceEpoch();
     _nextSendID = 1;
     _messagesDown = 0;
     _messagesUp = 0;
@@ -227,7 +348,21 @@ void Channel::resetConnection()
         //Only allow the server address to connect
         setPeerAddress(_serverAddress);
     }
-    if (_tcpSocket != nullptr)
+    if (_transport != nullptr)
+    {
+        LOG_D(LOG_TAG, "Cancelling any previous local transport operations...");
+        _transport->abort();
+        if (!_transport->open())
+        {
+            LOG_E(LOG_TAG, "Cannot open local transport: " + _transport->errorString());
+            START_TIMER(_resetTimerID, RECOVERY_DELAY);
+        }
+        else if (!_isServer && !_transport->isStream())
+        {
+            START_TIMER(_handshakeTimerID, HANDSHAKE_FREQUENCY);
+        }
+    }
+    else if (_tcpSocket != nullptr)
     {
         LOG_D(LOG_TAG, "Cancelling any previous TCP operations...");
         _tcpSocket->abort();
@@ -253,6 +388,15 @@ void Channel::resetConnection()
         _udpSocket->abort();
         _udpSocket->bind(_hostAddress.host, _hostAddress.port);
         if (!_udpSocket->isOpen()) _udpSocket->open(QIODevice::ReadWrite);
+        for (int i = 0; i < _extraUdpSockets.size(); i++)
+        {
+            QUdpSocket *socket = _extraUdpSockets[i];
+            socket->abort();
+            socket->bind(_extraUdpHosts[i], _isServer ? _hostAddress.port : 0);
+            if (!socket->isOpen()) socket->open(QIODevice::ReadWrite);
+            LOG_I(LOG_TAG, "Bound additional path to " + _extraUdpHosts[i].toString() + ":" + QString::number(socket->localPort()));
+        }
+        resetUdpPaths();
         if (!_isServer) START_TIMER(_handshakeTimerID, HANDSHAKE_FREQUENCY);
         LOG_I(LOG_TAG, "Bound to UDP port " + QString::number(_udpSocket->localPort()));
     }
@@ -279,18 +423,36 @@ void Channel::timerEvent(QTimerEvent *e)
     int id = e->timerId();
     if (id == _connectionMonitorTimerID)
     {
-        qint64 now = QDateTime::currentMSecsSinceEpoch();
-        //check for a stale connection (several seconds without a message)
-        if (now - _lastReceiveTime >= IDLE_CONNECTION_TIMEOUT)
+        qint64 now = Clock::root()->msecsSinceEpoch();
+        qint64 silence = now - _lastReceiveTime;
+        double phi = _failureDetector.phi(now);
+        //check for a stale connection, either unusually long silence for this link
+        //or several seconds without a message
+        if ((silence >= IDLE_CONNECTION_TIMEOUT) || ((phi >= _failedPhi) && (silence >= MIN_FAILURE_TIMEOUT)))
         {
-            LOG_E(LOG_TAG, "Peer has stopped responding, dropping connection");
+            LOG_E(LOG_TAG, "Peer has stopped responding after " + QString::number(silence)
+                  + "ms (phi=" + QString::number(phi, 'f', 1) + "), dropping connection");
             resetConnection();
         }
-        else if (now - _lastSendTime >= HEARTBEAT_INTERVAL)
+        else
         {
-            //Send a heartbeat message, even on TCP (They are needed for RTT updates
-            //and are a good idea anyway)
-            sendHeartbeat();
+            setDegraded(phi >= _degradedPhi);
+            if (!_sendQueue.isEmpty())
+            {
+                //Also catches stale messages while the socket is not draining at all
+                flushSendQueue();
+            }
+            if (_udpMultipath && (now - _lastProbeTime >= PATH_PROBE_INTERVAL))
+            {
+                probeUdpPaths(now);
+            }
+            //While degraded, heartbeat as fast as possible so the peer can see the link is still there
+            if (now - _lastHeartbeatTime >= (_degraded ? MIN_HEARTBEAT_INTERVAL : _heartbeatInterval))
+            {
+                //Send a heartbeat message, even on TCP (They are needed for RTT updates
+                //and are a good idea anyway)
+                sendHeartbeat();
+            }
         }
     }
     else if (id == _resetTcpTimerID)
@@ -308,24 +470,22 @@ void Channel::timerEvent(QTimerEvent *e)
     {
         sendHandshake();
     }
+    else if (id == _reorderTimerID)
+    {
+        releaseReordered(Clock::root()->msecsSinceEpoch());
+    }
     else if (!_delayPackets.empty())
     {
         PacketWrapper* next = _delayPackets.dequeue();
+        _delayBudget->remove(next->len);
         //This must be a delay send timer
         if (_state == ConnectedState)
         {
-            if (_udpSocket != nullptr)
-            {
-                _udpSocket->writeDatagram(next->data, next->len, _peerAddress.host, _peerAddress.port);
-            }
-            else if (_tcpSocket != nullptr)
-            {
-                _tcpSocket->write(next->data, next->len);
-            }
-            delete next->data;
-            delete next;
+            writePacket(next->data, next->len, next->paths);
         }
-        killTimer(e->timerId());
+        delete [] next->data;
+        delete next;
+        Clock::root()->killTimer(this, e->timerId());
     }
 }
 
@@ -339,6 +499,7 @@ void Channel::configureNewTcpSocket()
         _socket->setSocketOption(QAbstractSocket::LowDelayOption, _lowDelaySocketOption);
         connect(_socket, &QAbstractSocket::readyRead, this, &Channel::tcpReadyRead);
         connect(_socket, &QAbstractSocket::connected, this, &Channel::tcpConnected);
+        connect(_socket, &QAbstractSocket::bytesWritten, this, &Channel::flushSendQueue);
         connect(_socket, static_cast<void (QAbstractSocket::*)(QAbstractSocket::SocketError)>(&QAbstractSocket::error), this, &Channel::connectionErrorInternal);
     }
 }
@@ -374,6 +535,21 @@ void Channel::newTcpClient()
     tcpConnected();
 }
 
+void Channel::transportConnected()
+{
+    //Same as tcpConnected(), both sides must still exchange handshakes
+    //before the channel is considered connected
+    if (_transport->device() != nullptr)
+    {
+        connect(_transport->device(), &QIODevice::bytesWritten, this, &Channel::flushSendQueue, Qt::UniqueConnection);
+    }
+    sendHandshake();
+    START_TIMER(_resetTcpTimerID, IDLE_CONNECTION_TIMEOUT);
+    LOG_I(LOG_TAG, "Local peer " + _transport->getPeer() + " has connected");
+
+    setChannelState(ConnectingState, false);
+}
+
 inline void Channel::setChannelState(Channel::State state, bool forceUpdate)
 {
     //signals the stateChanged event
@@ -414,6 +590,14 @@ void Channel::close(Channel::State closeState)
         {
             _tcpServer->close();
         }
+        for (QUdpSocket *socket : _extraUdpSockets)
+        {
+            socket->abort();
+        }
+        if (_transport)
+        {
+            _transport->close();
+        }
         KILL_TIMER(_connectionMonitorTimerID);
         KILL_TIMER(_resetTcpTimerID);
         KILL_TIMER(_resetTimerID);
@@ -439,6 +623,13 @@ void Channel::connectionErrorInternal(QAbstractSocket::SocketError err)
     Q_EMIT connectionError(err);
 }
 
+void Channel::transportErrorInternal(QString message)
+{
+    LOG_E(LOG_TAG, "Local transport error: " + message);
+    START_TIMER(_resetTimerID, RECOVERY_DELAY);
+    Q_EMIT connectionError(QAbstractSocket::UnknownSocketError);
+}
+
 void Channel::serverErrorInternal(QAbstractSocket::SocketError err)
 {
     LOG_E(LOG_TAG, "Server Error: " + _tcpServer->errorString());
@@ -460,23 +651,73 @@ void Channel::serverErrorInternal(QAbstractSocket::SocketError err)
 void Channel::udpReadyRead()
 {
     LOG_D(LOG_TAG, "udpReadyRead() called");
+    readUdpSocket(_udpSocket);
+    for (QUdpSocket *socket : _extraUdpSockets)
+    {
+        readUdpSocket(socket);
+    }
+}
+
+void Channel::readUdpSocket(QUdpSocket *socket)
+{
     SocketAddress address;
     MessageID ID;
     MessageType type;
     qint64 status;
-    while (_udpSocket->hasPendingDatagrams())
+    while (socket->hasPendingDatagrams())
     {
         //read in a datagram
-        status = _udpSocket->readDatagram(_receiveBuffer, MAX_MESSAGE_LENGTH, &address.host, &address.port);
+        status = socket->readDatagram(_receiveBuffer, MAX_MESSAGE_LENGTH, &address.host, &address.port);
         if (status < 0)
         {
             //an error occurred reading from the socket, the onSocketError slot will handle it
             return;
         }
+        if (status < UDP_HEADER_SIZE) continue;
         _receiveBufferLength = status;
         type = static_cast<MessageType>(_receiveBuffer[0]);
+        if ((type == MSGTYPE_PATH_PROBE) || (type == MSGTYPE_PATH_PROBE_REPLY))
+        {
+            processUdpProbe(socket, address, type, _receiveBuffer + UDP_HEADER_SIZE, _receiveBufferLength - UDP_HEADER_SIZE);
+            continue;
+        }
+        ID = Wire::load<MessageID>(_receiveBuffer + 1);
+        int path = -1;
         //ensure the datagram either came from the correct address, or is marked as a handshake
-        if (_isServer)
+        if (_udpMultipath)
+        {
+            path = findUdpPath(socket, address);
+            if ((path < 0) & !(_isServer & (type == MSGTYPE_CLIENT_HANDSHAKE)))
+            {
+                LOG_D(LOG_TAG, "Received UDP packet from unknown path");
+                continue;
+            }
+            if (_isServer & (type == MSGTYPE_CLIENT_HANDSHAKE))
+            {
+                if (!compareHandshake(_receiveBuffer + UDP_HEADER_SIZE, _receiveBufferLength - UDP_HEADER_SIZE))
+                {
+                    LOG_W(LOG_TAG, "Received client handshake with invalid channel name");
+                    continue;
+                }
+                if ((_state == ConnectedState) && (ID == _handshakeID))
+                {
+                    //the client sent this handshake over all of its paths, and the connection
+                    //was already established over another one
+                    if (path < 0) addUdpPath(socket, address);
+                    continue;
+                }
+                //new connection, the path this arrived over is the only one known so far
+                _udpPaths.clear();
+                path = addUdpPath(socket, address);
+                _primaryUdpPath = path;
+            }
+            else if ((type != MSGTYPE_SERVER_HANDSHAKE) && isDuplicate(ID))
+            {
+                _duplicatePackets++;
+                continue;
+            }
+        }
+        else if (_isServer)
         {
             if ((address != _peerAddress) & (type != MSGTYPE_CLIENT_HANDSHAKE))
             {
@@ -490,21 +731,249 @@ void Channel::udpReadyRead()
             continue;
         }
         _bytesDown += status;
-        ID = Util::deserialize<MessageID>(_receiveBuffer + 1);
         processBufferedMessage(type, ID, _receiveBuffer + UDP_HEADER_SIZE, _receiveBufferLength - UDP_HEADER_SIZE, address);
+        if ((path >= 0) && (path < _udpPaths.size()) && (type == (_isServer ? MSGTYPE_CLIENT_HANDSHAKE : MSGTYPE_SERVER_HANDSHAKE))
+                && (_state == ConnectedState))
+        {
+            //the handshake proves this path works both ways
+            _udpPaths[path].healthy = true;
+            _udpPaths[path].lastReplyTime = Clock::root()->msecsSinceEpoch();
+            if (_primaryUdpPath != path)
+            {
+                _primaryUdpPath = path;
+                Q_EMIT primaryUdpPathChanged(_primaryUdpPath);
+            }
+        }
+    }
+}
+
+void Channel::resetUdpPaths()
+{
+    _udpPaths.clear();
+    _primaryUdpPath = 0;
+    if (_udpMultipath && !_isServer)
+    {
+        //a client always knows where all of its paths lead
+        addUdpPath(_udpSocket, _serverAddress);
+        for (int i = 0; i < _extraUdpSockets.size(); i++)
+        {
+            addUdpPath(_extraUdpSockets[i], _extraUdpServers[i]);
+        }
+    }
+}
+
+int Channel::findUdpPath(QUdpSocket *socket, const SocketAddress &peer) const
+{
+    for (int i = 0; i < _udpPaths.size(); i++)
+    {
+        if ((_udpPaths[i].socket == socket) && (_udpPaths[i].peer == peer)) return i;
+    }
+    return -1;
+}
+
+int Channel::addUdpPath(QUdpSocket *socket, const SocketAddress &peer)
+{
+    if (_udpPaths.size() >= MAX_UDP_PATHS)
+    {
+        LOG_W(LOG_TAG, "Too many paths, ignoring new path to " + peer.toString());
+        return -1;
+    }
+    UdpPath path;
+    path.socket = socket;
+    path.peer = peer;
+    path.rtt = -1;
+    path.lastReplyTime = 0;
+    path.probesSent = 0;
+    path.probesAnswered = 0;
+    path.lossPercent = 0;
+    path.healthy = false;
+    _udpPaths.append(path);
+    LOG_I(LOG_TAG, "Added path " + QString::number(_udpPaths.size() - 1) + " to " + peer.toString());
+    return _udpPaths.size() - 1;
+}
+
+void Channel::probeUdpPaths(qint64 now)
+{
+    _lastProbeTime = now;
+    //probe format: timestamp, followed by the channel name from a client so the server
+    //can learn paths it did not get a handshake over
+    char probe[UDP_HEADER_SIZE + sizeof(qint64) + 256];
+    int probeSize = UDP_HEADER_SIZE + sizeof(qint64);
+    probe[0] = static_cast<char>(MSGTYPE_PATH_PROBE);
+    Wire::store<MessageID>(probe + 1, 0);
+    Wire::store<qint64>(probe + UDP_HEADER_SIZE, now);
+    if (!_isServer && (_nameUtf8Size <= 256))
+    {
+        memcpy(probe + probeSize, _nameUtf8, _nameUtf8Size);
+        probeSize += _nameUtf8Size;
+    }
+
+    int best = -1;
+    int bestScore = 0;
+    for (int i = 0; i < _udpPaths.size(); i++)
+    {
+        UdpPath &path = _udpPaths[i];
+        if (path.probesSent >= PATH_LOSS_WINDOW)
+        {
+            path.lossPercent = qMax(0, 100 * (path.probesSent - path.probesAnswered) / path.probesSent);
+            path.probesSent = 0;
+            path.probesAnswered = 0;
+        }
+        path.healthy = now - path.lastReplyTime < PATH_TIMEOUT;
+        path.socket->writeDatagram(probe, probeSize, path.peer.host, path.peer.port);
+        path.probesSent++;
+
+        if (path.healthy)
+        {
+            int score = (path.rtt < 0 ? PATH_TIMEOUT : path.rtt) + path.lossPercent * PATH_LOSS_PENALTY;
+            if ((best < 0) || (score < bestScore))
+            {
+                best = i;
+                bestScore = score;
+            }
+        }
+    }
+    if ((best >= 0) && (best != _primaryUdpPath))
+    {
+        bool switchPath = true;
+        if ((_primaryUdpPath < _udpPaths.size()) && _udpPaths[_primaryUdpPath].healthy)
+        {
+            const UdpPath &primary = _udpPaths[_primaryUdpPath];
+            int primaryScore = (primary.rtt < 0 ? PATH_TIMEOUT : primary.rtt) + primary.lossPercent * PATH_LOSS_PENALTY;
+            //don't flip between paths that are about the same
+            switchPath = primaryScore - bestScore > PRIMARY_PATH_HYSTERESIS;
+        }
+        if (switchPath)
+        {
+            LOG_I(LOG_TAG, "Switching primary path to " + QString::number(best) + " (" + _udpPaths[best].peer.toString() + ")");
+            _primaryUdpPath = best;
+            Q_EMIT primaryUdpPathChanged(_primaryUdpPath);
+        }
     }
 }
 
+void Channel::processUdpProbe(QUdpSocket *socket, const SocketAddress &address, MessageType type,
+                              const char *message, qint64 size)
+{
+    if ((_state != ConnectedState) || (size < (qint64)sizeof(qint64))) return;
+    int path = findUdpPath(socket, address);
+    if (type == MSGTYPE_PATH_PROBE)
+    {
+        if (path < 0)
+        {
+            if (_udpMultipath && _isServer)
+            {
+                //a path the client's handshake never made it over
+                if (!compareHandshake(message + sizeof(qint64), size - sizeof(qint64))) return;
+                path = addUdpPath(socket, address);
+            }
+            else if ((socket != _udpSocket) || (address != _peerAddress))
+            {
+                return;
+            }
+        }
+        //echo the timestamp back over the same path
+        char reply[UDP_HEADER_SIZE + sizeof(qint64)];
+        reply[0] = static_cast<char>(MSGTYPE_PATH_PROBE_REPLY);
+        Wire::store<MessageID>(reply + 1, 0);
+        memcpy(reply + UDP_HEADER_SIZE, message, sizeof(qint64));
+        socket->writeDatagram(reply, sizeof(reply), address.host, address.port);
+    }
+    else if (path >= 0)
+    {
+        qint64 now = Clock::root()->msecsSinceEpoch();
+        UdpPath &udpPath = _udpPaths[path];
+        udpPath.rtt = now - Wire::load<qint64>(message);
+        udpPath.lastReplyTime = now;
+        udpPath.probesAnswered++;
+        udpPath.healthy = true;
+    }
+}
+
+bool Channel::isDuplicate(MessageID ID)
+{
+    if (ID > _dedupeHighestID)
+    {
+        MessageID shift = ID - _dedupeHighestID;
+        _dedupeMask = shift >= 64 ? 0 : _dedupeMask << shift;
+        _dedupeMask |= 1;
+        _dedupeHighestID = ID;
+        return false;
+    }
+    MessageID age = _dedupeHighestID - ID;
+    if (age >= 64)
+    {
+        //too old to tell, let the normal old packet handling deal with it
+        return false;
+    }
+    quint64 bit = (quint64)1 << age;
+    if (_dedupeMask & bit) return true;
+    _dedupeMask |= bit;
+    return false;
+}
+
 void Channel::tcpReadyRead()
 {
     LOG_D(LOG_TAG, "tcpReadyRead() called");
+    readStream(_tcpSocket);
+}
+
+void Channel::transportReadyRead()
+{
+    LOG_D(LOG_TAG, "transportReadyRead() called");
+    if (_transport->isStream())
+    {
+        if (_transport->device() != nullptr)
+        {
+            readStream(_transport->device());
+        }
+        return;
+    }
+    QString sender;
+    MessageID ID;
+    MessageType type;
     qint64 status;
-    while (_tcpSocket->bytesAvailable() > 0)
+    while (_transport->hasPendingDatagrams())
+    {
+        status = _transport->readDatagram(_receiveBuffer, MAX_MESSAGE_LENGTH, &sender);
+        if (status < UDP_HEADER_SIZE)
+        {
+            if (status < 0) return;
+            continue;
+        }
+        _receiveBufferLength = status;
+        type = static_cast<MessageType>(_receiveBuffer[0]);
+        //ensure the datagram either came from the current peer, or is marked as a handshake
+        if (sender != _transport->getPeer())
+        {
+            if (!_isServer || (type != MSGTYPE_CLIENT_HANDSHAKE))
+            {
+                LOG_D(LOG_TAG, "Received non-handshake datagram from unknown local peer");
+                continue;
+            }
+            if (!compareHandshake(_receiveBuffer + UDP_HEADER_SIZE, _receiveBufferLength - UDP_HEADER_SIZE))
+            {
+                LOG_W(LOG_TAG, "Received client handshake with invalid channel name");
+                continue;
+            }
+            //reply to this client from now on
+            _transport->setPeer(sender);
+        }
+        _bytesDown += status;
+        ID = Wire::load<MessageID>(_receiveBuffer + 1);
+        processBufferedMessage(type, ID, _receiveBuffer + UDP_HEADER_SIZE, _receiveBufferLength - UDP_HEADER_SIZE, _peerAddress);
+    }
+}
+
+void Channel::readStream(QIODevice *device)
+{
+    qint64 status;
+    while (device->bytesAvailable() > 0)
     {
         if (_receiveBufferLength < TCP_HEADER_SIZE)
         {
             //read the header in first so we know how long the message should be
-            status = _tcpSocket->read(_receiveBuffer + _receiveBufferLength, TCP_HEADER_SIZE - _receiveBufferLength);
+            status = device->read(_receiveBuffer + _receiveBufferLength, TCP_HEADER_SIZE - _receiveBufferLength);
             if (status < 0)
             {
                 //an error occurred reading from the socket, the onSocketError slot will handle it
@@ -515,7 +984,7 @@ void Channel::tcpReadyRead()
         if (_receiveBufferLength >= TCP_HEADER_SIZE)
         {
             //The header is in the buffer, so we know how long the packet is
-            MessageSize length = Util::deserialize<MessageSize>(_receiveBuffer);
+            MessageSize length = Wire::load<MessageSize>(_receiveBuffer);
             if (length > MAX_MESSAGE_LENGTH + TCP_HEADER_SIZE)
             {
                 LOG_W(LOG_TAG, "TCP peer sent a message with an invalid header (length=" + QString::number(length) + ")");
@@ -523,7 +992,7 @@ void Channel::tcpReadyRead()
                 return;
             }
             //read the rest of the message (if it's all there)
-            status = _tcpSocket->read(_receiveBuffer + _receiveBufferLength, length - _receiveBufferLength);
+            status = device->read(_receiveBuffer + _receiveBufferLength, length - _receiveBufferLength);
             if (status < 0)
             {
                 //an error occurred reading from the socket, the onSocketError slot will handle it
@@ -536,7 +1005,7 @@ void Channel::tcpReadyRead()
                 //we have the whole message
                 _bytesDown += length;
                 MessageType type = static_cast<MessageType>(_receiveBuffer[sizeof(MessageSize)]);
-                MessageID ID = Util::deserialize<MessageID>(_receiveBuffer + sizeof(MessageSize) + 1);
+                MessageID ID = Wire::load<MessageID>(_receiveBuffer + sizeof(MessageSize) + 1);
                 processBufferedMessage(type, ID, _receiveBuffer + TCP_HEADER_SIZE, _receiveBufferLength - TCP_HEADER_SIZE, _peerAddress);
                 _receiveBufferLength = 0;
             }
@@ -550,15 +1019,19 @@ void Channel::processBufferedMessage(MessageType type, MessageID ID, const char
     {
     case MSGTYPE_NORMAL:
         //normal data packet
+        if (isReordering())
+        {
+            receiveOrdered(ID, message, size, true);
+        }
         //check the packet sequence ID
-        if ((ID > _lastReceiveID) | !_dropOldPackets)
+        else if ((ID > _lastReceiveID) | !_dropOldPackets)
+        {
+            deliverMessage(ID, message, size);
+        }
+        else
         {
-            LOG_D(LOG_TAG, "Received normal packet " + QString::number(ID));
-            _lastReceiveTime = QDateTime::currentMSecsSinceEpoch();
-            _receivedPackets++;
-            _droppedPackets += ID - _lastReceiveID + 1;
-            _lastReceiveID = ID;
-            Q_EMIT messageReceived(message, size);
+            _reorderDepth = qMax(_reorderDepth, (int)(_lastReceiveID - ID));
+            _lateDroppedPackets++;
         }
         break;
     case MSGTYPE_SERVER_HANDSHAKE:
@@ -573,10 +1046,12 @@ void Channel::processBufferedMessage(MessageType type, MessageID ID, const char
                 setPeerAddress(address);
                 KILL_TIMER(_handshakeTimerID);
                 KILL_TIMER(_resetTcpTimerID);
-                _lastReceiveTime = QDateTime::currentMSecsSinceEpoch();
+                _lastReceiveTime = Clock::root()->msecsSinceEpoch();
                 _lastReceiveID = ID;
+                _reorderNextID = ID + 1;
+                _highestReceivedID = ID;
                 _wasConnected = true;
-                START_TIMER(_connectionMonitorTimerID, (int)(HEARTBEAT_INTERVAL / 3.1415926));
+                START_TIMER(_connectionMonitorTimerID, CONNECTION_MONITOR_INTERVAL);
                 LOG_D(LOG_TAG, "Received handshake response from server " + _serverAddress.toString());
 
                 setChannelState(ConnectedState, false);
@@ -595,6 +1070,7 @@ void Channel::processBufferedMessage(MessageType type, MessageID ID, const char
             {
                 //We are the server getting a new (valid) handshake request, respond back and record the address
                 resetConnectionVars();
+                _handshakeID = ID;
                 setPeerAddress(address);
                 KILL_TIMER(_resetTcpTimerID);
                 if (_protocol == UdpProtocol)
@@ -602,10 +1078,12 @@ void Channel::processBufferedMessage(MessageType type, MessageID ID, const char
                     //send a handshake back in UDP server mode
                     sendHandshake();
                 }
-                _lastReceiveTime = QDateTime::currentMSecsSinceEpoch();
+                _lastReceiveTime = Clock::root()->msecsSinceEpoch();
                 _lastReceiveID = ID;
+                _reorderNextID = ID + 1;
+                _highestReceivedID = ID;
                 _wasConnected = true;
-                START_TIMER(_connectionMonitorTimerID, (int)(HEARTBEAT_INTERVAL / 3.1415926));
+                START_TIMER(_connectionMonitorTimerID, CONNECTION_MONITOR_INTERVAL);
                 LOG_D(LOG_TAG, "Received handshake request from client " + _peerAddress.toString());
 
                 setChannelState(ConnectedState, false);
@@ -616,10 +1094,32 @@ void Channel::processBufferedMessage(MessageType type, MessageID ID, const char
             }
         }
         return; //don't calculate statistics on handshake messages
-    case MSGTYPE_HEARTBEAT:
+    case MSGTYPE_HEARTBEAT: {
         LOG_D(LOG_TAG, "Received heartbeat packet " + QString::number(ID));
         //no reason to update or check _lastReceiveID
-        _lastReceiveTime = QDateTime::currentMSecsSinceEpoch();
+        _lastReceiveTime = Clock::root()->msecsSinceEpoch();
+        if (isReordering())
+        {
+            //heartbeats still use up an ID, don't hold normal packets back waiting for it
+            receiveOrdered(ID, nullptr, 0, false);
+        }
+        //Only heartbeats come at a steady rate, other messages stop and start with whatever the
+        //application is doing. The peer says how often it is heartbeating, and when that changes
+        //the old history would make the new rate look like a failing link
+        quint16 interval;
+        if (Wire::Reader(message, size).read(&interval) && (interval > 0)
+                && (qAbs(interval - _peerHeartbeatInterval) > _peerHeartbeatInterval / HEARTBEAT_CADENCE_CHANGE_DIVISOR))
+        {
+            LOG_D(LOG_TAG, "Peer heartbeat interval changed from " + QString::number(_peerHeartbeatInterval)
+                  + "ms to " + QString::number(interval) + "ms");
+            _peerHeartbeatInterval = interval;
+            _failureDetector.reset(_lastReceiveTime, interval);
+        }
+        else
+        {
+            _failureDetector.heartbeat(_lastReceiveTime);
+        }
+    }
         break;
     default:
         LOG_E(LOG_TAG, "Peer sent a message with an invalid header (type=" + QString::number(type) + ")");
@@ -627,7 +1127,11 @@ void Channel::processBufferedMessage(MessageType type, MessageID ID, const char
         return;
     case MSGTYPE_ACK:
         LOG_D(LOG_TAG, "Received ack packet " + QString::number(ID));
-        _lastReceiveTime = QDateTime::currentMSecsSinceEpoch();
+        _lastReceiveTime = Clock::root()->msecsSinceEpoch();
+        if (isReordering())
+        {
+            receiveOrdered(ID, nullptr, 0, false);
+        }
         float time = (_lastReceiveTime - _lastAckReceiveTime) / 1000.0f;
         _lastAckReceiveTime = _lastReceiveTime;
         if (time != 0)
@@ -637,8 +1141,8 @@ void Channel::processBufferedMessage(MessageType type, MessageID ID, const char
         }
         _bytesUp = 0;
         _bytesDown = 0;
-        MessageID ackID = Util::deserialize<MessageID>(message);
-        if (ackID >= _nextSendID) break;
+        MessageID ackID;
+        if (!Wire::Reader(message, size).read(&ackID) || (ackID >= _nextSendID)) break;
         int logIndex = _sentTimeLogIndex - (_nextSendID - ackID);
         if (logIndex < 0)
         {
@@ -650,21 +1154,134 @@ void Channel::processBufferedMessage(MessageType type, MessageID ID, const char
             logIndex += SENT_LOG_CAP;
         }
         _lastRtt = _lastReceiveTime - _sentTimeLog[logIndex];
+        //A fast link gets more frequent heartbeats so the peer's failure detector can react sooner,
+        //a slow one can't detect failure much faster than its RTT anyway
+        _heartbeatInterval = qBound(MIN_HEARTBEAT_INTERVAL, _lastRtt * 2, HEARTBEAT_INTERVAL);
         Q_EMIT rttChanged(_lastRtt);
         break;
     }
     _messagesDown++;
     //If we have reached _statisticsInterval without acking a received packet,
     //send one so the other side can calculate RTT
-    if (_sendAcks && (QDateTime::currentMSecsSinceEpoch() - _lastAckSendTime >= STATISTICS_INTERVAL))
+    if (_sendAcks && (Clock::root()->msecsSinceEpoch() - _lastAckSendTime >= STATISTICS_INTERVAL))
     {
         _lastAckSendTime = _lastReceiveTime;
-        char* ack = new char[sizeof(MessageID)];
-        Util::serialize<MessageID>(ack, ID);
+        char ack[sizeof(MessageID)];
+        Wire::store<MessageID>(ack, ID);
         sendMessage(ack, sizeof(MessageID), MSGTYPE_ACK);
     }
 }
 
+void Channel::setDegraded(bool degraded)
+{
+    if (degraded != _degraded)
+    {
+        _degraded = degraded;
+        if (_degraded)
+        {
+            LOG_W(LOG_TAG, "Link is degraded (" + QString::number(Clock::root()->msecsSinceEpoch() - _lastReceiveTime)
+                  + "ms since last message, usual interval " + QString::number((int)_failureDetector.getMeanInterval()) + "ms)");
+        }
+        else
+        {
+            LOG_I(LOG_TAG, "Link is no longer degraded");
+        }
+        Q_EMIT degradedChanged(_degraded);
+    }
+}
+
+void Channel::deliverMessage(MessageID ID, const char *message, MessageSize size)
+{
+    LOG_D(LOG_TAG, "Received normal packet " + QString::number(ID));
+    // Covers whatever is connected to messageReceived, which is where a slow receive would come from
+    TRACE_SPAN_ARG("channel", _traceReceiveName, "bytes", size);
+    _lastReceiveTime = Clock::root()->msecsSinceEpoch();
+    _receivedPackets++;
+    _droppedPackets += ID - _lastReceiveID + 1;
+    _lastReceiveID = ID;
+    Q_EMIT messageReceived(message, size);
+}
+
+inline bool Channel::isReordering() const
+{
+    return (_protocol == UdpProtocol) && _dropOldPackets && (_reorderMaxPackets > 0) && (_reorderNextID != 0);
+}
+
+void Channel::receiveOrdered(MessageID ID, const char *message, MessageSize size, bool deliver)
+{
+    if (ID < _reorderNextID)
+    {
+        //this packet's slot was already given up on
+        if (deliver)
+        {
+            LOG_D(LOG_TAG, "Dropping late packet " + QString::number(ID));
+            _lateDroppedPackets++;
+        }
+        return;
+    }
+    if (ID < _highestReceivedID)
+    {
+        //arrived out of order, but still in time
+        _reorderDepth = qMax(_reorderDepth, (int)(_highestReceivedID - ID));
+        if (deliver) _reorderedPackets++;
+    }
+    else
+    {
+        _highestReceivedID = ID;
+    }
+
+    qint64 now = Clock::root()->msecsSinceEpoch();
+    if (ID == _reorderNextID)
+    {
+        _reorderNextID++;
+        if (deliver) deliverMessage(ID, message, size);
+    }
+    else if (!_reorderBuffer.contains(ID))
+    {
+        ReorderedPacket packet;
+        if (deliver) packet.data = QByteArray(message, size);
+        packet.arrivalTime = now;
+        packet.deliver = deliver;
+        _reorderBuffer.insert(ID, packet);
+    }
+    releaseReordered(now);
+}
+
+void Channel::releaseReordered(qint64 now)
+{
+    while (!_reorderBuffer.isEmpty())
+    {
+        QMap<MessageID, ReorderedPacket>::iterator first = _reorderBuffer.begin();
+        if (first.key() != _reorderNextID)
+        {
+            if ((_reorderBuffer.size() <= _reorderMaxPackets) && (now - first.value().arrivalTime < _reorderMaxDelay))
+            {
+                //keep waiting for the missing packet
+                break;
+            }
+            //give up on the missing packet(s)
+            LOG_D(LOG_TAG, "Skipping missing packets " + QString::number(_reorderNextID) + "-" + QString::number(first.key() - 1));
+        }
+        ReorderedPacket packet = first.value();
+        MessageID ID = first.key();
+        _reorderBuffer.erase(first);
+        _reorderNextID = ID + 1;
+        if (packet.deliver)
+        {
+            deliverMessage(ID, packet.data.constData(), packet.data.size());
+        }
+        if (_reorderNextID == 0) return; //connection was reset by an observer
+    }
+    if (_reorderBuffer.isEmpty())
+    {
+        KILL_TIMER(_reorderTimerID);
+    }
+    else if (_reorderTimerID == TIMER_INACTIVE)
+    {
+        START_TIMER(_reorderTimerID, qMax(1, _reorderMaxDelay / REORDER_CHECK_DIVISOR));
+    }
+}
+
 inline bool Channel::compareHandshake(const char *message, MessageSize size)  const
 {
     if ((int)size != _nameUtf8Size) return false; //size + 1 to account for \0
@@ -684,7 +1301,11 @@ inline void Channel::sendHandshake()
 
 inline void Channel::sendHeartbeat()
 {
-    sendMessage("\0", 0, MSGTYPE_HEARTBEAT);
+    //Tell the peer how often to expect these, so its failure detector can follow changes
+    char heartbeat[sizeof(quint16)];
+    Wire::store<quint16>(heartbeat, _degraded ? MIN_HEARTBEAT_INTERVAL : _heartbeatInterval);
+    _lastHeartbeatTime = Clock::root()->msecsSinceEpoch();
+    sendMessage(heartbeat, sizeof(quint16), MSGTYPE_HEARTBEAT);
 }
 
 bool Channel::sendMessage(const char *message, MessageSize size)
@@ -694,9 +1315,9 @@ bool Channel::sendMessage(const char *message, MessageSize size)
         if (size > MAX_MESSAGE_LENGTH)
         {
             LOG_W(LOG_TAG, "Attempted to send a message that is too long, it will be truncated");
-            return sendMessage(message, MAX_MESSAGE_LENGTH, MSGTYPE_NORMAL);
+            return queueMessage(message, MAX_MESSAGE_LENGTH, 0, false);
         }
-        return sendMessage(message, size, MSGTYPE_NORMAL);
+        return queueMessage(message, size, 0, false);
     }
     else
     {
@@ -705,62 +1326,230 @@ bool Channel::sendMessage(const char *message, MessageSize size)
     }
 }
 
-bool Channel::sendMessage(const char *message, MessageSize size, MessageType type)
+bool Channel::sendConflatedMessage(quint32 key, const char *message, MessageSize size)
 {
-    qint64 status;
-    //LOG_D(LOG_TAG, "Sending packet type=" + QString::number(type) + ",id=" + QString::number(_nextSendID));
-    if (_protocol == UdpProtocol)
+    if (_state == ConnectedState)
     {
-        if (_simulatedDelay == 0)
+        if (size > MAX_MESSAGE_LENGTH)
         {
-            _sendBuffer[0] = static_cast<char>(type);
-            Util::serialize<MessageID>(_sendBuffer + 1, _nextSendID);
-            memcpy(_sendBuffer + sizeof(MessageID) + 1, message, (size_t)size);
-            status = _udpSocket->writeDatagram(_sendBuffer, size + UDP_HEADER_SIZE, _peerAddress.host, _peerAddress.port);
+            LOG_W(LOG_TAG, "Attempted to send a message that is too long, it will be truncated");
+            return queueMessage(message, MAX_MESSAGE_LENGTH, key, true);
         }
-        else
+        return queueMessage(message, size, key, true);
+    }
+    else
+    {
+        return false;
+    }
+}
+
+qint64 Channel::pendingWriteBytes() const
+{
+    if (_transport != nullptr)
+    {
+        return _transport->device() != nullptr ? _transport->device()->bytesToWrite() : 0;
+    }
+    if (_tcpSocket != nullptr)
+    {
+        return _tcpSocket->bytesToWrite();
+    }
+    return 0;
+}
+
+void Channel::updateSendBudget()
+{
+    if (_protocol == TcpProtocol)
+    {
+        _sendBudget->setUsage(_sendQueueBytes + pendingWriteBytes());
+    }
+}
+
+bool Channel::queueMessage(const char *message, MessageSize size, quint32 key, bool conflate)
+{
+    //Only stream sockets buffer outgoing data, a UDP socket drops what it can't send
+    if ((_protocol != TcpProtocol) || (_sendQueueWatermark <= 0)
+            || (_sendQueue.isEmpty() && (pendingWriteBytes() < _sendQueueWatermark)))
+    {
+        return sendMessage(message, size, MSGTYPE_NORMAL);
+    }
+    qint64 now = Clock::root()->msecsSinceEpoch();
+    if (conflate)
+    {
+        for (QueuedMessage& queued : _sendQueue)
         {
-            PacketWrapper *wrapper = new PacketWrapper;
-            wrapper->data = new char[size + UDP_HEADER_SIZE];
-            wrapper->data[0] = static_cast<char>(type);
-            Util::serialize<MessageID>(wrapper->data + 1, _nextSendID);
-            memcpy(wrapper->data + sizeof(MessageID) + 1, message, (size_t)size);
-            wrapper->len = size + UDP_HEADER_SIZE;
-            _delayPackets.enqueue(wrapper);
-            startTimer(_simulatedDelay);
-            status = size + UDP_HEADER_SIZE;
+            if (queued.conflate && (queued.key == key))
+            {
+                //Replace the older message, but keep its place in line
+                _sendQueueBytes += size - queued.data.size();
+                queued.data = QByteArray(message, size);
+                queued.queueTime = now;
+                _conflatedMessages++;
+                return true;
+            }
         }
     }
-    else if (_tcpSocket != nullptr)
+    if (_sendQueue.size() >= _sendQueueCapacity)
+    {
+        _sendQueueBytes -= _sendQueue.dequeue().data.size();
+        _overflowDroppedMessages++;
+        LOG_W(LOG_TAG, "Send queue is full, dropping oldest message");
+    }
+    QueuedMessage queued;
+    queued.data = QByteArray(message, size);
+    queued.queueTime = now;
+    queued.key = key;
+    queued.conflate = conflate;
+    _sendQueue.enqueue(queued);
+    _sendQueueBytes += size;
+    updateSendBudget();
+    while ((_sendQueue.size() > 1) && !_sendBudget->fits(0))
     {
-        MessageSize newSize = size + TCP_HEADER_SIZE;
-        if (_simulatedDelay == 0)
+        qint64 dropped = _sendQueue.dequeue().data.size();
+        _sendQueueBytes -= dropped;
+        _overflowDroppedMessages++;
+        _sendBudget->overflowed(dropped);
+        updateSendBudget();
+    }
+    return true;
+}
+
+void Channel::flushSendQueue()
+{
+    if (_state != ConnectedState) return;
+    qint64 now = Clock::root()->msecsSinceEpoch();
+    while (!_sendQueue.isEmpty() && (pendingWriteBytes() < _sendQueueWatermark))
+    {
+        QueuedMessage queued = _sendQueue.dequeue();
+        _sendQueueBytes -= queued.data.size();
+        if ((_sendQueueDeadline > 0) && (now - queued.queueTime > _sendQueueDeadline))
         {
-            Util::serialize<MessageSize>(_sendBuffer, newSize);
-            _sendBuffer[sizeof(MessageSize)] = static_cast<char>(type);
-            Util::serialize<MessageID>(_sendBuffer + sizeof(MessageSize) + 1, _nextSendID);
-            memcpy(_sendBuffer + sizeof(MessageID) + sizeof(MessageSize) + 1, message, (size_t)size);
-            status = _tcpSocket->write(_sendBuffer, newSize);
+            _staleDroppedMessages++;
+            continue;
         }
-        else
+        sendMessage(queued.data.constData(), queued.data.size(), MSGTYPE_NORMAL);
+    }
+    updateSendBudget();
+    if ((_sendQueueDeadline > 0) && !_sendQueue.isEmpty())
+    {
+        //The socket is still backed up, drop anything that will be stale by the time it's sent
+        while (!_sendQueue.isEmpty() && (now - _sendQueue.head().queueTime > _sendQueueDeadline))
         {
-            PacketWrapper *wrapper = new PacketWrapper;
-            wrapper->data = new char[newSize];
-            Util::serialize<MessageSize>(wrapper->data, newSize);
-            wrapper->data[sizeof(MessageSize)] = static_cast<char>(type);
-            Util::serialize<MessageID>(wrapper->data + sizeof(MessageSize) + 1, _nextSendID);
-            memcpy(wrapper->data + sizeof(MessageID) + sizeof(MessageSize) + 1, message, (size_t)size);
-            wrapper->len = newSize;
-            _delayPackets.enqueue(wrapper);
-            startTimer(_simulatedDelay);
-            status = newSize;
+            _sendQueueBytes -= _sendQueue.dequeue().data.size();
+            _staleDroppedMessages++;
         }
+        updateSendBudget();
     }
-    else
+}
+
+qint64 Channel::writePacket(const char *data, qint64 len, PathSelection paths)
+{
+    if (_transport != nullptr)
+    {
+        if (_transport->isStream())
+        {
+            QIODevice *device = _transport->device();
+            return device != nullptr ? device->write(data, len) : -1;
+        }
+        return _transport->writeDatagram(data, len);
+    }
+    if ((_udpSocket != nullptr) && !_udpPaths.isEmpty())
     {
-        LOG_E(LOG_TAG, "Attempted to send a message through a null TCP socket");
+        qint64 status = -1;
+        for (int i = 0; i < _udpPaths.size(); i++)
+        {
+            const UdpPath &path = _udpPaths[i];
+            if ((i == _primaryUdpPath) || (paths == AllPaths) || ((paths == HealthyPaths) && path.healthy))
+            {
+                qint64 pathStatus = path.socket->writeDatagram(data, len, path.peer.host, path.peer.port);
+                if (pathStatus > 0) status = pathStatus;
+            }
+        }
+        return status;
+    }
+    if (_udpSocket != nullptr)
+    {
+        return _udpSocket->writeDatagram(data, len, _peerAddress.host, _peerAddress.port);
+    }
+    if (_tcpSocket != nullptr)
+    {
+        return _tcpSocket->write(data, len);
+    }
+    LOG_E(LOG_TAG, "Attempted to send a message through a null TCP socket");
+    return -1;
+}
+
+bool Channel::sendMessage(const char *message, MessageSize size, MessageType type)
+{
+    TRACE_SPAN_ARG("channel", _traceSendName, "bytes", size);
+    qint64 status;
+    //LOG_D(LOG_TAG, "Sending packet type=" + QString::number(type) + ",id=" + QString::number(_nextSendID));
+    char *packet = _simulatedDelay == 0 ? _sendBuffer : new char[size + TCP_HEADER_SIZE];
+    //the writer is given the real size of the buffer, so a message that doesn't fit fails to encode
+    size_t capacity = _simulatedDelay == 0 ? sizeof(_sendBuffer) : size + TCP_HEADER_SIZE;
+    qint64 length;
+    PathSelection paths = PrimaryPath;
+    if ((type == MSGTYPE_CLIENT_HANDSHAKE) || (type == MSGTYPE_SERVER_HANDSHAKE))
+    {
+        paths = AllPaths;
+    }
+    else if (((type == MSGTYPE_NORMAL) || (type == MSGTYPE_HEARTBEAT)) && _udpDuplicateMessages)
+    {
+        //Heartbeats too, so the peer doesn't go without them while it notices its primary path is gone
+        paths = HealthyPaths;
+    }
+    Wire::Writer writer(packet, capacity);
+    if (_protocol != UdpProtocol)
+    {
+        writer.write<MessageSize>(size + TCP_HEADER_SIZE);
+    }
+    writer.write<MessageType>(type);
+    writer.write<MessageID>(_nextSendID);
+    writer.writeBytes(message, size);
+    if (!writer.ok())
+    {
+        //never put a partly written packet on the wire
+        LOG_E(LOG_TAG, "Could not encode a message of " + QString::number(size) + " bytes (type=" + QString::number(type) + ")");
+        if (packet != _sendBuffer) delete [] packet;
         return false;
     }
+    length = writer.position();
+    if (_simulatedDelay == 0)
+    {
+        if (_protocol == TcpProtocol)
+        {
+            //Nothing already handed to the socket can be taken back, so refuse the message.
+            //Handshakes, heartbeats and acks are tiny and keep the link's liveness going, so
+            //they are always written.
+            updateSendBudget();
+            if ((type == MSGTYPE_NORMAL) && !_sendBudget->fits(length))
+            {
+                _sendBudget->overflowed(length);
+                return false;
+            }
+        }
+        status = writePacket(packet, length, paths);
+        if (_protocol == TcpProtocol)
+        {
+            updateSendBudget();
+        }
+    }
+    else
+    {
+        if ((type == MSGTYPE_NORMAL) && !_delayBudget->fits(length))
+        {
+            _delayBudget->overflowed(length);
+            delete [] packet;
+            return false;
+        }
+        _delayBudget->add(length);
+        PacketWrapper *wrapper = new PacketWrapper;
+        wrapper->data = packet;
+        wrapper->len = length;
+        wrapper->paths = paths;
+        _delayPackets.enqueue(wrapper);
+        Clock::root()->startTimer(this, _simulatedDelay);
+        status = length;
+    }
     if (status <= 0)
     {
         LOG_W(LOG_TAG, "Could not send message (status=" + QString::number(status) + ")");
@@ -769,7 +1558,7 @@ bool Channel::sendMessage(const char *message, MessageSize size, MessageType typ
     //log statistics and increment _nextSendID
     _messagesUp++;
     _bytesUp += status;
-    _lastSendTime = QDateTime::currentMSecsSinceEpoch();
+    _lastSendTime = Clock::root()->msecsSinceEpoch();
     _sentTimeLog[_sentTimeLogIndex] = _lastSendTime;
     _nextSendID++;
     _sentTimeLogIndex++;
@@ -826,7 +1615,7 @@ int Channel::getConnectionUptime() const
 {
     if (_state == ConnectedState)
     {
-        return (QDateTime::currentMSecsSinceEpoch() - _connectionEstablishedTime) / 1000;
+        return (Clock::root()->msecsSinceEpoch() - _connectionEstablishedTime) / 1000;
     }
     return -1;
 }
@@ -861,11 +1650,87 @@ void Channel::setSendAcks(bool sendAcks)
     _sendAcks = sendAcks;
 }
 
+void Channel::flush()
+{
+    if (_state != ConnectedState) return;
+    if (!_sendQueue.isEmpty())
+    {
+        flushSendQueue();
+    }
+    if (_transport != nullptr)
+    {
+        _transport->flush();
+    }
+    else if (_tcpSocket != nullptr)
+    {
+        _tcpSocket->flush();
+    }
+}
+
 void Channel::setSimulatedDelay(int ms)
 {
     _simulatedDelay = ms;
 }
 
+void Channel::setSendQueueWatermark(qint64 bytes)
+{
+    _sendQueueWatermark = bytes;
+    if (_sendQueueWatermark <= 0)
+    {
+        //Nothing would ever drain the queue again
+        while (!_sendQueue.isEmpty() && (_state == ConnectedState))
+        {
+            QueuedMessage queued = _sendQueue.dequeue();
+            _sendQueueBytes -= queued.data.size();
+            sendMessage(queued.data.constData(), queued.data.size(), MSGTYPE_NORMAL);
+        }
+        _sendQueue.clear();
+        _sendQueueBytes = 0;
+        updateSendBudget();
+    }
+}
+
+void Channel::setSendQueueCapacity(int messages)
+{
+    _sendQueueCapacity = qMax(messages, 1);
+    while (_sendQueue.size() > _sendQueueCapacity)
+    {
+        _sendQueueBytes -= _sendQueue.dequeue().data.size();
+        _overflowDroppedMessages++;
+    }
+    updateSendBudget();
+}
+
+void Channel::setSendQueueDeadline(int ms)
+{
+    _sendQueueDeadline = ms;
+}
+
+int Channel::getSendQueueDepth() const
+{
+    return _sendQueue.size();
+}
+
+qint64 Channel::getSendQueueBytes() const
+{
+    return _sendQueueBytes;
+}
+
+quint64 Channel::getConflatedMessageCount() const
+{
+    return _conflatedMessages;
+}
+
+quint64 Channel::getStaleDroppedMessageCount() const
+{
+    return _staleDroppedMessages;
+}
+
+quint64 Channel::getOverflowDroppedMessageCount() const
+{
+    return _overflowDroppedMessages;
+}
+
 SocketAddress Channel::getHostAddress() const
 {
     if (_udpSocket != nullptr)
@@ -883,6 +1748,11 @@ SocketAddress Channel::getHostAddress() const
     return SocketAddress(QHostAddress::Null, 0);
 }
 
+QString Channel::getLocalAddress() const
+{
+    return _localAddress;
+}
+
 SocketAddress Channel::getProvidedServerAddress() const
 {
     return _serverAddress;
@@ -893,6 +1763,140 @@ void Channel::setUdpDropOldPackets(bool dropOldPackets)
     _dropOldPackets = dropOldPackets;
 }
 
+void Channel::addUdpPath(QHostAddress hostAddress, SocketAddress serverAddress)
+{
+    if ((_protocol != UdpProtocol) || (_udpSocket == nullptr) || _isServer)
+    {
+        LOG_E(LOG_TAG, "Server addresses for additional paths can only be given to a UDP client");
+        return;
+    }
+    QUdpSocket *socket = new QUdpSocket(this);
+    socket->setSocketOption(QAbstractSocket::LowDelayOption, _lowDelaySocketOption);
+    connect(socket, &QAbstractSocket::readyRead, this, &Channel::udpReadyRead);
+    connect(socket, static_cast<void (QAbstractSocket::*)(QAbstractSocket::SocketError)>(&QAbstractSocket::error), this, &Channel::connectionErrorInternal);
+    _extraUdpSockets.append(socket);
+    _extraUdpHosts.append(hostAddress);
+    _extraUdpServers.append(serverAddress);
+    _udpMultipath = true;
+}
+
+void Channel::addUdpPath(QHostAddress hostAddress)
+{
+    if ((_protocol != UdpProtocol) || (_udpSocket == nullptr) || !_isServer)
+    {
+        LOG_E(LOG_TAG, "Only a UDP server can listen on additional addresses");
+        return;
+    }
+    QUdpSocket *socket = new QUdpSocket(this);
+    socket->setSocketOption(QAbstractSocket::LowDelayOption, _lowDelaySocketOption);
+    connect(socket, &QAbstractSocket::readyRead, this, &Channel::udpReadyRead);
+    connect(socket, static_cast<void (QAbstractSocket::*)(QAbstractSocket::SocketError)>(&QAbstractSocket::error), this, &Channel::connectionErrorInternal);
+    _extraUdpSockets.append(socket);
+    _extraUdpHosts.append(hostAddress);
+    _extraUdpServers.append(SocketAddress(QHostAddress::Null, 0));
+    _udpMultipath = true;
+}
+
+void Channel::setUdpMultipath(bool multipath)
+{
+    //a local transport only ever has the one path
+    if ((_protocol != UdpProtocol) || (_transport != nullptr)) return;
+    //a client is multipath as soon as it has more than one path
+    _udpMultipath = multipath || (!_isServer && !_extraUdpSockets.isEmpty());
+    if (!_udpMultipath)
+    {
+        _udpPaths.clear();
+        _primaryUdpPath = 0;
+    }
+}
+
+void Channel::setUdpDuplicateMessages(bool duplicate)
+{
+    _udpDuplicateMessages = duplicate;
+}
+
+int Channel::getUdpPathCount() const
+{
+    return _udpPaths.size();
+}
+
+SocketAddress Channel::getUdpPathPeer(int path) const
+{
+    if ((path < 0) || (path >= _udpPaths.size())) return SocketAddress(QHostAddress::Null, 0);
+    return _udpPaths[path].peer;
+}
+
+int Channel::getUdpPathRtt(int path) const
+{
+    if ((path < 0) || (path >= _udpPaths.size())) return -1;
+    return _udpPaths[path].rtt;
+}
+
+int Channel::getUdpPathLossPercent(int path) const
+{
+    if ((path < 0) || (path >= _udpPaths.size())) return 0;
+    return _udpPaths[path].lossPercent;
+}
+
+bool Channel::isUdpPathHealthy(int path) const
+{
+    if ((path < 0) || (path >= _udpPaths.size())) return false;
+    return _udpPaths[path].healthy;
+}
+
+int Channel::getPrimaryUdpPath() const
+{
+    return _primaryUdpPath;
+}
+
+quint64 Channel::getUdpDuplicatePacketCount() const
+{
+    return _duplicatePackets;
+}
+
+void Channel::setFailureDetectorThresholds(double degradedPhi, double failedPhi)
+{
+    _degradedPhi = degradedPhi;
+    _failedPhi = failedPhi;
+}
+
+bool Channel::isDegraded() const
+{
+    return _degraded;
+}
+
+double Channel::getSuspicionLevel() const
+{
+    if (_state != ConnectedState) return 0;
+    return _failureDetector.phi(Clock::root()->msecsSinceEpoch());
+}
+
+void Channel::setUdpReorderBuffer(int maxDelay, int maxPackets)
+{
+    _reorderMaxDelay = qMax(maxDelay, 0);
+    _reorderMaxPackets = qMax(maxPackets, 0);
+    if (!_reorderBuffer.isEmpty())
+    {
+        //release anything that no longer fits the new limits
+        releaseReordered(Clock::root()->msecsSinceEpoch());
+    }
+}
+
+int Channel::getUdpReorderDepth() const
+{
+    return _reorderDepth;
+}
+
+quint64 Channel::getUdpReorderedPacketCount() const
+{
+    return _reorderedPackets;
+}
+
+quint64 Channel::getUdpLateDroppedPacketCount() const
+{
+    return _lateDroppedPackets;
+}
+
 bool Channel::wasConnected() const
 {
     return _wasConnected;
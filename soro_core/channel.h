@@ -7,6 +7,9 @@
 #include "soro_core_global.h"
 #include "constants.h"
 #include "socketaddress.h"
+#include "channeltransport.h"
+#include "phiaccrualdetector.h"
+#include "memorybudget.h"
 
 namespace Soro {
 
@@ -15,6 +18,12 @@ namespace Soro {
  * Channels abstract over message-based internet communication in a super easy way,
  * supporting either TCP or UDP as the transport protocol.
  *
+ * Channels between two endpoints on the same host can instead be created with a local
+ * transport address (see ChannelTransport), in which case a Unix-domain socket or shared
+ * memory ring is used in place of the loopback network stack. Stream transports use the
+ * TCP message structure and datagram transports use the UDP message structure below, so
+ * handshakes, heartbeats and statistics behave exactly the same.
+ *
  * The following information describes the inner workings of this class and is not
  * necessary to understand the API.
  *
@@ -37,6 +46,16 @@ namespace Soro {
  * The ID field uniquely identifies all messages sent by this endpoint. The ID value
  * increases (newer messages have higher IDs), so they also function an a sequence number
  * in UDP mode.
+ *
+ * -------- UDP multipath --------
+ * A UDP channel can send over several paths (local interface + peer address pairs) at once,
+ * see addUdpPath(). Each path is probed every 200ms with a PATH_PROBE message that the other
+ * side echoes back as a PATH_PROBE_REPLY on the same path, which gives the RTT and loss of
+ * that path. Probes have an ID of 0 and are not part of the message sequence. A client probe
+ * also carries the channel name so a server can learn a path it has not seen a handshake on.
+ *
+ * Messages that are sent over several paths keep the same ID, and the receiver drops the
+ * copies that arrive after the first.
  */
 class SORO_CORE_EXPORT Channel: public QObject {
     Q_OBJECT
@@ -53,6 +72,8 @@ private:
     static const MessageType MSGTYPE_SERVER_HANDSHAKE = 2;
     static const MessageType MSGTYPE_HEARTBEAT = 3;
     static const MessageType MSGTYPE_ACK = 4;
+    static const MessageType MSGTYPE_PATH_PROBE = 5;
+    static const MessageType MSGTYPE_PATH_PROBE_REPLY = 6;
 
     static const MessageSize TCP_HEADER_SIZE = sizeof(MessageSize) + sizeof(MessageID) + 1;
     static const MessageSize UDP_HEADER_SIZE = sizeof(MessageID) + 1;
@@ -96,6 +117,17 @@ public:
     static Channel* createClient(QObject *parent, SocketAddress serverAddress, QString name, Protocol protocol,
              QHostAddress hostAddress = QHostAddress::Any);
 
+    /* Creates a new channel to act as the server end point for communication with a peer
+     * on the same host. The protocol is implied by the address, see ChannelTransport
+     * (e.g. "unix:/tmp/soro_drive", "unixdgram:/tmp/soro_drive" or "shm:soro_drive")
+     */
+    static Channel* createServer(QObject *parent, QString localAddress, QString name);
+
+    /* Creates a new channel to act as the client end point for communication with a peer
+     * on the same host. The protocol is implied by the address, see ChannelTransport
+     */
+    static Channel* createClient(QObject *parent, QString localAddress, QString name);
+
     ~Channel();
 
     /* Gets the name the channel was configured with
@@ -120,6 +152,12 @@ public:
      */
     void close();
 
+    /* Writes out queued messages and anything the socket is still holding as far as it can
+     * without blocking, instead of waiting for the event loop to do it. For use right before
+     * blocking, such as waiting on a process that was just sent a message.
+     */
+    void flush();
+
     /* Sends a message to the other side of the channel
      */
     bool sendMessage(const char *message, Channel::MessageSize size);
@@ -128,6 +166,16 @@ public:
         return sendMessage(message.constData(), message.size());
     }
 
+    /* Sends a message which is made obsolete by the next message sent with the same key,
+     * such as a status or position update. If the message has to wait in the send queue,
+     * it replaces the older queued message with the same key instead of being queued behind it.
+     */
+    bool sendConflatedMessage(quint32 key, const char *message, Channel::MessageSize size);
+
+    inline bool sendConflatedMessage(quint32 key, const QByteArray& message) {
+        return sendConflatedMessage(key, message.constData(), message.size());
+    }
+
     /* Returns true if this channel object acts as the server side
      */
     bool isServer() const;
@@ -163,10 +211,102 @@ public:
 
     SocketAddress getProvidedServerAddress() const;
 
+    /* Gets the local transport address the channel was created with, or an
+     * empty string if it uses TCP/UDP
+     */
+    QString getLocalAddress() const;
+
     void setSendAcks(bool sendAcks);
 
     void setUdpDropOldPackets(bool dropOldPackets);
 
+    /* Adds another path for a UDP client channel to reach the server, through the local interface
+     * hostAddress (which can be QHostAddress::Any to let routing decide) to serverAddress, which
+     * can be another address of the same server. Must be called before open().
+     */
+    void addUdpPath(QHostAddress hostAddress, SocketAddress serverAddress);
+
+    /* Makes a UDP server channel also listen on hostAddress. This is only needed if the channel
+     * was not bound to QHostAddress::Any. Must be called before open().
+     */
+    void addUdpPath(QHostAddress hostAddress);
+
+    /* Allows a UDP server channel to accept its client from more than one address at the same
+     * time, treating each as a separate path
+     */
+    void setUdpMultipath(bool multipath);
+
+    /* If enabled, normal messages and heartbeats on a multipath UDP channel are sent over every
+     * healthy path instead of only the primary one
+     */
+    void setUdpDuplicateMessages(bool duplicate);
+
+    /* Gets the number of paths a multipath UDP channel currently has. The other getters
+     * for paths take an index below this
+     */
+    int getUdpPathCount() const;
+
+    SocketAddress getUdpPathPeer(int path) const;
+
+    /* Gets the last measured RTT of a path, or -1 if it has never been measured
+     */
+    int getUdpPathRtt(int path) const;
+
+    int getUdpPathLossPercent(int path) const;
+
+    /* Returns true if the path has answered a probe recently
+     */
+    bool isUdpPathHealthy(int path) const;
+
+    /* Gets the path used for traffic that is not sent over every path
+     */
+    int getPrimaryUdpPath() const;
+
+    /* Gets the number of received packets dropped for being copies of one that
+     * had already arrived over another path
+     */
+    quint64 getUdpDuplicatePacketCount() const;
+
+    /* Sets the failure detector suspicion levels (phi, see PhiAccrualDetector) at which the link
+     * is reported as degraded, and at which it is dropped. Regardless of these, a connection is
+     * never dropped after less than 1 second or kept after 5 seconds of silence.
+     */
+    void setFailureDetectorThresholds(double degradedPhi, double failedPhi);
+
+    /* Returns true if the peer's heartbeats have been missing for unusually long given the link's
+     * history, but not long enough to drop the connection. Heartbeats are sent at a steady rate
+     * whatever other traffic there is, so a change in how often messages are sent doesn't count.
+     */
+    bool isDegraded() const;
+
+    /* Gets the current failure detector suspicion level (phi) for the connected peer
+     */
+    double getSuspicionLevel() const;
+
+    /* Enables a reorder buffer on a UDP channel. Packets that arrive ahead of a missing one
+     * are held for up to maxDelay ms (or until maxPackets are waiting) for the missing packet
+     * to show up, and are then released in order. Packets arriving after their slot has been
+     * released are dropped as late.
+     *
+     * Leave this disabled (the default) for channels where only the latest message matters,
+     * such as drive commands. Has no effect if old packets are not being dropped.
+     */
+    void setUdpReorderBuffer(int maxDelay, int maxPackets);
+
+    /* Gets the deepest reordering seen on the current connection, in packets (how many newer
+     * packets had arrived before an out of order packet). This is measured whether or not the
+     * reorder buffer is enabled.
+     */
+    int getUdpReorderDepth() const;
+
+    /* Gets the number of out of order packets the reorder buffer delivered in order
+     */
+    quint64 getUdpReorderedPacketCount() const;
+
+    /* Gets the number of packets dropped for arriving after newer packets had already been delivered
+     */
+    quint64 getUdpLateDroppedPacketCount() const;
+
     void setLowDelaySocketOption(bool lowDelay);
 
     /* Returns true if this channel is or was connected to a peer
@@ -174,13 +314,97 @@ public:
      */
     bool wasConnected() const;
 
+    /* Holds every sent packet back for this long before writing it, for testing. Packets
+     * waiting out the delay are held to the channel_delay memory budget, past which new
+     * messages are refused. Control packets such as heartbeats are never refused.
+     */
     void setSimulatedDelay(int ms);
 
+    /* Sets how many bytes a stream socket may have waiting to be written before messages
+     * are held back in the channel's send queue instead. Once the socket drains below this
+     * mark, queued messages are written in order. Set to 0 to disable the send queue.
+     *
+     * This has no effect on UDP channels, which never buffer outgoing data.
+     */
+    void setSendQueueWatermark(qint64 bytes);
+
+    /* Sets the maximum number of messages the send queue can hold. When it is full,
+     * the oldest queued message is dropped.
+     *
+     * The queue is also held to the channel_send memory budget, which counts the bytes
+     * queued and the bytes the socket has not written. Past that cap the oldest queued
+     * messages are dropped, and with nothing left to drop new messages are refused.
+     * Control packets such as heartbeats and acks are never refused, so a backed up
+     * channel still looks alive to its peer.
+     */
+    void setSendQueueCapacity(int messages);
+
+    /* Sets how long a message may wait in the send queue before it is considered stale
+     * and dropped instead of sent. Set to 0 to never drop messages for being stale.
+     */
+    void setSendQueueDeadline(int ms);
+
+    /* Gets the number of messages currently waiting in the send queue
+     */
+    int getSendQueueDepth() const;
+
+    /* Gets the number of bytes currently waiting in the send queue, not including
+     * data already handed to the socket
+     */
+    qint64 getSendQueueBytes() const;
+
+    /* Gets the number of queued messages that were replaced by a newer message
+     * with the same key
+     */
+    quint64 getConflatedMessageCount() const;
+
+    /* Gets the number of queued messages that were dropped for exceeding the send
+     * queue deadline
+     */
+    quint64 getStaleDroppedMessageCount() const;
+
+    /* Gets the number of queued messages that were dropped because the send queue was full
+     */
+    quint64 getOverflowDroppedMessageCount() const;
+
 private:
+    // Which paths of a multipath UDP channel a packet should be sent over
+    enum PathSelection {
+        PrimaryPath, HealthyPaths, AllPaths
+    };
+
     // Struct to hold packet information for delayed sending
     struct PacketWrapper {
         char *data;
         qint64 len;
+        PathSelection paths;
+    };
+
+    // One path (socket and peer address) of a multipath UDP channel
+    struct UdpPath {
+        QUdpSocket *socket;
+        SocketAddress peer;
+        int rtt;
+        qint64 lastReplyTime;
+        int probesSent;
+        int probesAnswered;
+        int lossPercent;
+        bool healthy;
+    };
+
+    // Packet held in the reorder buffer until the packets before it arrive
+    struct ReorderedPacket {
+        QByteArray data;
+        qint64 arrivalTime;
+        bool deliver;   //false for control messages, which only fill their slot in the sequence
+    };
+
+    // Message waiting in the send queue for the socket to drain
+    struct QueuedMessage {
+        QByteArray data;
+        qint64 queueTime;
+        quint32 key;
+        bool conflate;
     };
 
     char _receiveBuffer[1024];  //buffer for received messages
@@ -190,6 +414,8 @@ private:
     QString _name;  //The name of the channel, also as a UTF8 byte array for handshaking
     char *_nameUtf8;
     int _nameUtf8Size;
+    const char *_traceSendName;     //Names for this channel's trace spans
+    const char *_traceReceiveName;
 
     State _state = ReadyState;   //current state the channel is in
 
@@ -203,6 +429,46 @@ private:
 
     QQueue<PacketWrapper*> _delayPackets;
     int _simulatedDelay = 0;
+    MemoryBudget *_delayBudget = nullptr;   //Bytes held by packets waiting out the simulated delay
+
+    QQueue<QueuedMessage> _sendQueue;   //Messages held back while the stream socket is backed up
+    qint64 _sendQueueBytes = 0;
+    qint64 _sendQueueWatermark;
+    int _sendQueueCapacity;
+    int _sendQueueDeadline = 0;
+    MemoryBudget *_sendBudget = nullptr;    //Bytes in the send queue plus bytes the stream socket has not written
+    quint64 _conflatedMessages = 0;
+    quint64 _staleDroppedMessages = 0;
+    quint64 _overflowDroppedMessages = 0;
+
+    QMap<MessageID, ReorderedPacket> _reorderBuffer;    //Out of order UDP packets, keyed by ID
+    MessageID _reorderNextID = 0;   //ID of the next packet to release from the reorder buffer
+    MessageID _highestReceivedID = 0;
+    QList<QUdpSocket*> _extraUdpSockets;    //Sockets bound to the additional local addresses of a multipath UDP channel
+    QList<QHostAddress> _extraUdpHosts;
+    QList<SocketAddress> _extraUdpServers;  //Server address reached through each additional socket (client only)
+    QList<UdpPath> _udpPaths;   //Paths of a multipath UDP channel, fixed for a client and learned by a server
+    int _primaryUdpPath = 0;
+    bool _udpMultipath = false;
+    bool _udpDuplicateMessages = false;
+    MessageID _handshakeID = 0; //ID of the handshake that established the current connection
+    MessageID _dedupeHighestID = 0; //Highest received ID and a mask of the IDs just below it,
+    quint64 _dedupeMask = 0;        //for dropping copies of a packet that arrive over another path
+    quint64 _duplicatePackets = 0;
+    qint64 _lastProbeTime = 0;
+
+    PhiAccrualDetector _failureDetector;    //Models the time between received heartbeats to detect a failing link
+    double _degradedPhi;
+    double _failedPhi;
+    bool _degraded = false;
+    int _heartbeatInterval;   //Current heartbeat interval, adapted to the link RTT
+    int _peerHeartbeatInterval; //Heartbeat interval last announced by the peer
+
+    int _reorderMaxDelay = 0;
+    int _reorderMaxPackets = 0;
+    int _reorderDepth = 0;
+    quint64 _reorderedPackets = 0;
+    quint64 _lateDroppedPackets = 0;
 
     SocketAddress _serverAddress = SocketAddress(QHostAddress::Null, 0);   //address of the server side of the channel
                                                                             //If we are the server, this may be 0 if the user
@@ -223,6 +489,8 @@ private:
     QTcpServer *_tcpServer = nullptr; //Currently active TCP server (for registering TCP clients)
     QUdpSocket *_udpSocket = nullptr; //Currently active UDP socket
     QAbstractSocket *_socket = nullptr;   //Pointer to either the TCP or UDP socket, depending on the configuration
+    ChannelTransport *_transport = nullptr;   //Same-host transport used in place of the above sockets, if configured
+    QString _localAddress;  //Address the same-host transport was created from
 
     MessageID _nextSendID; //ID to mark the next message with
     MessageID _lastReceiveID;  //ID the most recent inbound message was marked with
@@ -239,11 +507,13 @@ private:
     int _handshakeTimerID = TIMER_INACTIVE;
     int _resetTimerID = TIMER_INACTIVE;
     int _resetTcpTimerID = TIMER_INACTIVE;
+    int _reorderTimerID = TIMER_INACTIVE;
 
-    qint64 _lastReceiveTime = QDateTime::currentMSecsSinceEpoch(); //Last time a message was received
-    qint64 _lastSendTime = QDateTime::currentMSecsSinceEpoch();
-    qint64 _lastAckReceiveTime = QDateTime::currentMSecsSinceEpoch();
-    qint64 _lastAckSendTime = QDateTime::currentMSecsSinceEpoch();
+    qint64 _lastReceiveTime = Clock::root()->msecsSinceEpoch(); //Last time a message was received
+    qint64 _lastSendTime = Clock::root()->msecsSinceEpoch();
+    qint64 _lastHeartbeatTime = Clock::root()->msecsSinceEpoch();
+    qint64 _lastAckReceiveTime = Clock::root()->msecsSinceEpoch();
+    qint64 _lastAckSendTime = Clock::root()->msecsSinceEpoch();
 
     inline void setChannelState(State state, bool forceUpdate);  //Internal method to set the channel status and
                                                           //emit the statusChanged signal
@@ -264,8 +534,47 @@ private:
     void processBufferedMessage(MessageType type, MessageID ID,
                                 const char *message, MessageSize size, const SocketAddress &address);   //Processes a received message
 
+    void setDegraded(bool degraded);    //Internal method to set the degraded flag and emit degradedChanged
+
+    void deliverMessage(MessageID ID, const char *message, MessageSize size);    //Hands a normal message to observers
+
+    inline bool isReordering() const;   //Returns true if received packets pass through the reorder buffer
+
+    void receiveOrdered(MessageID ID, const char *message, MessageSize size, bool deliver); //Passes a received packet
+                                                                                            //through the reorder buffer
+
+    void releaseReordered(qint64 now); //Releases packets from the reorder buffer that are next in sequence
+                                       //or have waited too long
+
     void configureNewTcpSocket();   //Sets up a newly created TCP socket
 
+    bool queueMessage(const char *message, MessageSize size, quint32 key, bool conflate);  //Sends a normal message, or
+                                                                                        //queues it if the socket is backed up
+
+    qint64 pendingWriteBytes() const;   //Bytes the stream socket has not written yet
+
+    void updateSendBudget();    //Reports the send queue and socket buffer usage to the send budget
+
+    qint64 writePacket(const char *data, qint64 len, PathSelection paths = PrimaryPath);   //Writes a fully formed packet to whichever
+                                                                                        //socket or transport is active
+
+    void readUdpSocket(QUdpSocket *socket); //Reads all pending datagrams from one of the channel's UDP sockets
+
+    void resetUdpPaths();   //Sets up the paths of a multipath UDP channel for a new connection
+
+    int findUdpPath(QUdpSocket *socket, const SocketAddress &peer) const;
+
+    int addUdpPath(QUdpSocket *socket, const SocketAddress &peer);  //Adds a path learned by a server
+
+    void probeUdpPaths(qint64 now);    //Sends probes over every path and picks the primary path
+
+    void processUdpProbe(QUdpSocket *socket, const SocketAddress &address, MessageType type,
+                         const char *message, qint64 size);
+
+    bool isDuplicate(MessageID ID); //Returns true if a packet with this ID has already been received
+
+    void readStream(QIODevice *device); //Reads length-framed messages from a stream socket or transport
+
     void resetConnectionVars(); //Resets variables relating to the current connection state,
                                 //called when a new connection is established
 
@@ -287,6 +596,10 @@ private Q_SLOTS:
     void tcpReadyRead();
     void tcpConnected();
     void newTcpClient();
+    void transportReadyRead();
+    void transportConnected();
+    void transportErrorInternal(QString message);
+    void flushSendQueue();
     void connectionErrorInternal(QAbstractSocket::SocketError err);
     void serverErrorInternal(QAbstractSocket::SocketError err);
 
@@ -313,6 +626,16 @@ Q_SIGNALS:
 
     void rttChanged(int rtt);
 
+    /* Signal to notify an observer that the link has become degraded (the peer has been silent
+     * for unusually long) or has recovered. A degraded link is still connected, so this
+     * gives observers a chance to react before the connection is dropped
+     */
+    void degradedChanged(bool degraded);
+
+    /* Signal to notify an observer that a multipath UDP channel has picked a different primary path
+     */
+    void primaryUdpPathChanged(int path);
+
 protected:
     void timerEvent(QTimerEvent *);
 
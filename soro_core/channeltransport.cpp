@@ -0,0 +1,96 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "channeltransport.h"
+#include "unixstreamtransport.h"
+#include "unixdatagramtransport.h"
+#include "shmringtransport.h"
+
+#include <QDir>
+#include <cstring>
+
+#define SCHEME_UNIX_STREAM "unix:"
+#define SCHEME_UNIX_DATAGRAM "unixdgram:"
+#define SCHEME_SHARED_MEMORY "shm:"
+
+namespace Soro {
+
+ChannelTransport::ChannelTransport(const QString& address, bool server, QObject *parent) : QObject(parent)
+{
+    _address = address;
+    _server = server;
+}
+
+ChannelTransport* ChannelTransport::create(const QString& address, bool server, QObject *parent)
+{
+    if (address.startsWith(SCHEME_UNIX_DATAGRAM))
+    {
+        return new UnixDatagramTransport(address.mid(strlen(SCHEME_UNIX_DATAGRAM)), server, parent);
+    }
+    if (address.startsWith(SCHEME_UNIX_STREAM))
+    {
+        return new UnixStreamTransport(address.mid(strlen(SCHEME_UNIX_STREAM)), server, parent);
+    }
+    if (address.startsWith(SCHEME_SHARED_MEMORY))
+    {
+        return new ShmRingTransport(address.mid(strlen(SCHEME_SHARED_MEMORY)), server, parent);
+    }
+    return nullptr;
+}
+
+bool ChannelTransport::isLocalAddress(const QString& address)
+{
+    return address.startsWith(SCHEME_UNIX_DATAGRAM)
+            || address.startsWith(SCHEME_UNIX_STREAM)
+            || address.startsWith(SCHEME_SHARED_MEMORY);
+}
+
+QString ChannelTransport::localAddress(const QString& transport, const QString& channelName, bool stream)
+{
+    if ((transport != "unix") && (transport != "shm")) return QString();
+    QString path = QDir::tempPath() + "/" + channelName;
+    if (stream) return SCHEME_UNIX_STREAM + path;
+    if (transport == "shm") return SCHEME_SHARED_MEMORY + channelName;
+    return SCHEME_UNIX_DATAGRAM + path;
+}
+
+void ChannelTransport::setError(const QString& message)
+{
+    _errorString = message;
+    Q_EMIT error(message);
+}
+
+QString ChannelTransport::getPeer() const
+{
+    return _peer;
+}
+
+QString ChannelTransport::getAddress() const
+{
+    return _address;
+}
+
+bool ChannelTransport::isServer() const
+{
+    return _server;
+}
+
+QString ChannelTransport::errorString() const
+{
+    return _errorString;
+}
+
+} // namespace Soro
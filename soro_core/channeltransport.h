@@ -0,0 +1,126 @@
+#ifndef SORO_CHANNELTRANSPORT_H
+#define SORO_CHANNELTRANSPORT_H
+
+#include <QObject>
+#include <QIODevice>
+#include <QString>
+
+#include "soro_core_global.h"
+
+namespace Soro {
+
+/* Abstract transport used by a Channel to talk to a peer on the same host without
+ * going through the TCP/UDP loopback stack.
+ *
+ * A transport is selected purely by the address string it is created with:
+ *
+ *  unix:<path>         Unix-domain stream socket (TCP-like, Channel adds length framing)
+ *  unixdgram:<path>    Unix-domain datagram socket (UDP-like)
+ *  shm:<key>           Shared-memory ring buffer pair (UDP-like)
+ *
+ * Stream transports expose the connected peer as a QIODevice through device(),
+ * datagram transports implement the hasPendingDatagrams()/readDatagram()/writeDatagram() set.
+ */
+class SORO_CORE_EXPORT ChannelTransport: public QObject {
+    Q_OBJECT
+public:
+    /* Creates the transport matching the scheme of the given address, or returns
+     * nullptr if the address does not name a same-host transport
+     */
+    static ChannelTransport* create(const QString& address, bool server, QObject *parent);
+
+    /* Returns true if the address names a same-host transport (see above)
+     */
+    static bool isLocalAddress(const QString& address);
+
+    /* Gets the address both ends of a channel use when they run on the same host, for the
+     * transport named by a local_transport setting: "unix" for Unix-domain sockets, or "shm" to
+     * carry datagram channels over shared memory instead. Stream channels always use a Unix-domain
+     * socket. Returns an empty string for any other transport name.
+     */
+    static QString localAddress(const QString& transport, const QString& channelName, bool stream);
+
+    /* Returns true if this transport delivers a byte stream, false if
+     * it preserves message boundaries
+     */
+    virtual bool isStream() const=0;
+
+    /* Server side: starts listening (stream) or binds (datagram) if not already doing so.
+     * Client side: begins connecting (stream) or binds and sets the server as the peer (datagram).
+     *
+     * Returns false if the transport could not be opened.
+     */
+    virtual bool open()=0;
+
+    /* Drops the current peer. A listening server keeps listening.
+     */
+    virtual void abort()=0;
+
+    /* Drops the current peer and stops listening.
+     */
+    virtual void close()=0;
+
+    /* Gets the device for the connected peer of a stream transport, or nullptr if
+     * there is none (or this is a datagram transport)
+     */
+    virtual QIODevice* device() { return nullptr; }
+
+    /* Writes out as much buffered stream data as possible without blocking
+     */
+    virtual void flush() { }
+
+    virtual bool hasPendingDatagrams() const { return false; }
+
+    /* Reads the next datagram. The sender's transport address is stored in
+     * sender, if provided.
+     */
+    virtual qint64 readDatagram(char *data, qint64 maxLength, QString *sender=nullptr) {
+        Q_UNUSED(data); Q_UNUSED(maxLength); Q_UNUSED(sender); return -1;
+    }
+
+    /* Sends a datagram to the current peer
+     */
+    virtual qint64 writeDatagram(const char *data, qint64 length) {
+        Q_UNUSED(data); Q_UNUSED(length); return -1;
+    }
+
+    /* Sets the peer datagrams are written to. Only meaningful for a datagram server,
+     * which learns its peer from the client handshake.
+     */
+    virtual void setPeer(const QString& peer) { _peer = peer; }
+
+    QString getPeer() const;
+    QString getAddress() const;
+    bool isServer() const;
+    QString errorString() const;
+
+Q_SIGNALS:
+    /* Emitted when data can be read from the transport
+     */
+    void readyRead();
+
+    /* Emitted when a stream transport has a newly connected peer
+     */
+    void connected();
+
+    /* Emitted when the transport encounters an error, the channel
+     * will reset itself shortly after
+     */
+    void error(QString message);
+
+protected:
+    ChannelTransport(const QString& address, bool server, QObject *parent);
+
+    void setError(const QString& message);
+
+    QString _address;   //Scheme-less address (socket path or shared memory key)
+    QString _peer;
+    bool _server;
+
+private:
+    QString _errorString;
+};
+
+} // namespace Soro
+
+#endif // SORO_CHANNELTRANSPORT_H
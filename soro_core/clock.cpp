@@ -0,0 +1,53 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "clock.h"
+
+namespace Soro {
+
+Clock* Clock::_realClock = new Clock();
+Clock* Clock::_root = Clock::_realClock;
+
+Clock::Clock() { }
+
+Clock::~Clock() { }
+
+void Clock::setRoot(Clock *clock)
+{
+    _root = clock ? clock : _realClock;
+}
+
+qint64 Clock::msecsSinceEpoch() const
+{
+    return QDateTime::currentMSecsSinceEpoch();
+}
+
+int Clock::startTimer(QObject *receiver, int interval)
+{
+    return receiver->startTimer(interval);
+}
+
+void Clock::killTimer(QObject *receiver, int timerId)
+{
+    receiver->killTimer(timerId);
+}
+
+void Clock::singleShot(int msec, QObject *context, std::function<void()> functor)
+{
+    QTimer::singleShot(msec, context, functor);
+}
+
+} // namespace Soro
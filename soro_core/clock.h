@@ -0,0 +1,60 @@
+#ifndef SORO_CLOCK_H
+#define SORO_CLOCK_H
+
+#include <QtCore>
+#include <functional>
+
+#include "soro_core_global.h"
+
+namespace Soro {
+
+/* Where time comes from: the current time, timers, and single shot callbacks.
+ *
+ * This clock is the real one, which reads the system time and uses Qt timers. Everything that
+ * needs the time or a timer gets it from Clock::root(), and START_TIMER and KILL_TIMER (constants.h)
+ * go through it too, so a test can replace the root clock with a VirtualClock and decide exactly
+ * when time passes.
+ *
+ * Timers started through a clock have to be killed through the same clock, so the root clock should
+ * only be replaced before anything has started a timer. Timers are delivered to the receiver's
+ * timerEvent() as usual.
+ */
+class SORO_CORE_EXPORT Clock {
+public:
+    Clock();
+    virtual ~Clock();
+
+    /* Gets the clock in use by the whole process
+     */
+    static inline Clock* root() {
+        return _root;
+    }
+
+    /* Replaces the clock in use by the whole process, or restores the real clock if null.
+     * The clock is not deleted when it is replaced.
+     */
+    static void setRoot(Clock *clock);
+
+    /* Gets the current time in milliseconds since the epoch, like QDateTime::currentMSecsSinceEpoch()
+     */
+    virtual qint64 msecsSinceEpoch() const;
+
+    /* Starts a repeating timer for receiver, like QObject::startTimer(), and returns its ID
+     */
+    virtual int startTimer(QObject *receiver, int interval);
+    virtual void killTimer(QObject *receiver, int timerId);
+
+    /* Calls functor once after msec milliseconds, on context's thread, unless context is destroyed first
+     */
+    virtual void singleShot(int msec, QObject *context, std::function<void()> functor);
+
+private:
+    Q_DISABLE_COPY(Clock)
+
+    static Clock *_realClock;
+    static Clock *_root;
+};
+
+} // namespace Soro
+
+#endif // SORO_CLOCK_H
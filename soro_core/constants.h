@@ -19,13 +19,14 @@
 
 #ifdef QT_CORE_LIB
 #include <QCoreApplication>
+#include "clock.h"
 #endif
 
-/* Timer macros
+/* Timer macros, these go through the root clock so timers can be run on virtual time
  */
 #define TIMER_INACTIVE -1
-#define START_TIMER(X,Y) if (X == TIMER_INACTIVE) X = startTimer(Y)
-#define KILL_TIMER(X) if (X != TIMER_INACTIVE) { killTimer(X); X = TIMER_INACTIVE; }
+#define START_TIMER(X,Y) if (X == TIMER_INACTIVE) X = Soro::Clock::root()->startTimer(this, Y)
+#define KILL_TIMER(X) if (X != TIMER_INACTIVE) { Soro::Clock::root()->killTimer(this, X); X = TIMER_INACTIVE; }
 
 #define SORO_SETTINGS_DIR QCoreApplication::applicationDirPath() + "/../config"
 
@@ -44,6 +45,10 @@
 #define CHANNEL_NAME_DRIVE              "Soro_DriveChannel"
 #define CHANNEL_NAME_MAIN               "Soro_MainChannel"
 
+/* Channel name between a MediaServer and the streaming process it started
+ */
+#define CHANNEL_NAME_MEDIA_IPC          "Soro_MediaIpcChannel"
+
 /* These are return codes that audio/video streaming processes will return
  * depending on the error they encountered.
  */
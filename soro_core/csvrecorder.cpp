@@ -16,12 +16,16 @@
 
 #include "csvrecorder.h"
 #include "logger.h"
+#include "tracer.h"
 
 #include <QCoreApplication>
 #include <QDir>
 
 #define LOG_TAG "CsvRecorder"
 
+//default memory budget for rows waiting to be written to a CSV file, after which they are written out
+#define DEFAULT_CSV_BUDGET (64 * 1024)
+
 namespace Soro {
 
 CsvDataSeries::CsvDataSeries(QObject *parent) : QObject(parent) { }
@@ -35,7 +39,7 @@ qint64 CsvDataSeries::getValueTime() const {
 }
 
 void CsvDataSeries::update(QVariant value) {
-    _valueTime = QDateTime::currentDateTime().toMSecsSinceEpoch();
+    _valueTime = Clock::root()->msecsSinceEpoch();
     if (_value != value) {
         _value = value;
         Q_EMIT valueUpdated();
@@ -48,6 +52,12 @@ CsvRecorder::CsvRecorder(QString logName, QObject *parent) : QObject(parent)
 {
     _updateInterval = 100;
     _logName = logName;
+    _budget = new MemoryBudget("csv:" + logName, DEFAULT_CSV_BUDGET, MemoryBudget::Block);
+}
+
+CsvRecorder::~CsvRecorder()
+{
+    delete _budget;
 }
 
 bool CsvRecorder::startLog(QDateTime loggedStartTime, CsvRecorder::RecordingMode mode)
@@ -76,24 +86,28 @@ bool CsvRecorder::startLog(QDateTime loggedStartTime, CsvRecorder::RecordingMode
     }
     if (_file->open(QIODevice::WriteOnly))
     {
-        _fileStream = new QTextStream(_file);
         // Write header to file
-        *_fileStream << "Recording started at " << loggedStartTime.toString() << "\n";
+        QTextStream header(_file);
+        header.setCodec("UTF-8");
+        header << "Recording started at " << loggedStartTime.toString() << "\n";
         if (mode == RECORDING_MODE_ON_INTERVAL)
         {
-            *_fileStream << "Rows in this file were updated every " << _updateInterval << " milleseconds\n";
+            header << "Rows in this file were updated every " << _updateInterval << " milleseconds\n";
         }
         else
         {
-            *_fileStream << "Rows in this file were updated on demand\n";
+            header << "Rows in this file were updated on demand\n";
         }
-        *_fileStream << "\n";
+        header << "\n";
 
         for (const CsvDataSeries* column : _columns)
         {
-            *_fileStream << column->getSeriesName() << "," << column->getSeriesName() << " (timestamp),";
+            header << column->getSeriesName() << "," << column->getSeriesName() << " (timestamp),";
         }
-        *_fileStream << "\n";
+        header << "\n";
+        header.flush();
+        _pendingRows.clear();
+        _budget->setUsage(0);
 
         LOG_I(LOG_TAG, "Starting log " + QString::number(_logStartTime));
         if (mode == RECORDING_MODE_ON_INTERVAL)
@@ -128,8 +142,7 @@ void CsvRecorder::stopLog()
         {
            disconnect(column, &CsvDataSeries::valueUpdated, this, &CsvRecorder::onSeriesUpdated);
         }
-        delete _fileStream;
-        _fileStream = nullptr;
+        writePendingRows();
         LOG_I(LOG_TAG, "Ending log " + QString::number(_logStartTime));
 
         if (_file->isOpen())
@@ -138,8 +151,14 @@ void CsvRecorder::stopLog()
         }
         delete _file;
         _file = nullptr;
+        _budget->setUsage(0);
         _isRecording = false;
         _logStartTime = 0;
+        if (_pendingUpdateInterval > 0)
+        {
+            _updateInterval = _pendingUpdateInterval;
+            _pendingUpdateInterval = 0;
+        }
         Q_EMIT logStopped();
     }
 }
@@ -158,10 +177,13 @@ void CsvRecorder::setUpdateInterval(int interval)
 {
     if (_isRecording)
     {
-        LOG_E(LOG_TAG, "Cannot change update interval while recording");
+        // The interval is written in the file header, so it can't change partway through
+        LOG_I(LOG_TAG, "Update interval will change to " + QString::number(interval) + "ms when this log ends");
+        _pendingUpdateInterval = interval;
         return;
     }
     _updateInterval = interval;
+    _pendingUpdateInterval = 0;
 }
 
 void CsvRecorder::addColumn(const CsvDataSeries *series)
@@ -210,21 +232,53 @@ void CsvRecorder::clearColumns()
 
 void CsvRecorder::logRow()
 {
-    if (_fileStream)
+    if (_file)
     {
+        TRACE_SPAN_ARG("recording", "CsvRecorder::logRow", "columns", _columns.size());
+        QString row;
         for (const CsvDataSeries *column : _columns)
         {
             if ((_columnDataTimestamps.value(column) != column->getValueTime()) || column->shouldKeepOldValues())
             {
-                *_fileStream << column->getValue().toString() << "," << (column->getValueTime() > 0 ? QString::number(column->getValueTime() - _logStartTime) : "---") << ",";
+                row += column->getValue().toString() + "," + (column->getValueTime() > 0 ? QString::number(column->getValueTime() - _logStartTime) : "---") + ",";
                 _columnDataTimestamps.insert(column, column->getValueTime());
             }
             else {
-                *_fileStream << ",,";
+                row += ",,";
             }
         }
-        *_fileStream << "\n";
+        row += "\n";
+        QByteArray bytes = row.toUtf8();
+        if (!_budget->fits(bytes.size()))
+        {
+            writePendingRows();
+        }
+        _pendingRows += bytes;
+        _budget->setUsage(_pendingRows.size());
+        if (_budget->getCap() == 0)
+        {
+            // Nothing is held back without a cap, rather than holding back everything
+            writePendingRows();
+        }
+    }
+}
+
+bool CsvRecorder::writePendingRows()
+{
+    if (_pendingRows.isEmpty()) return true;
+    TRACE_SPAN_ARG("recording", "CsvRecorder::writePendingRows", "bytes", _pendingRows.size());
+    qint64 written = _file->write(_pendingRows);
+    bool ok = (written == _pendingRows.size()) && _file->flush();
+    if (!ok)
+    {
+        // The rows can't be kept around until the disk comes back, so at least say they're gone
+        LOG_E(LOG_TAG, "Cannot write " + QString::number(_pendingRows.size() - qMax(written, qint64(0)))
+              + " bytes of rows to " + _file->fileName() + ": " + _file->errorString());
+        _budget->overflowed(_pendingRows.size() - qMax(written, qint64(0)));
     }
+    _pendingRows.clear();
+    _budget->setUsage(0);
+    return ok;
 }
 
 void CsvRecorder::timerEvent(QTimerEvent *e)
@@ -9,6 +9,7 @@
 
 #include "soro_core_global.h"
 #include "constants.h"
+#include "memorybudget.h"
 
 namespace Soro {
 
@@ -57,6 +58,10 @@ private:
 };
 
 /* Class to record data at a regular interval in a CSV formatted file
+ *
+ * Rows are held in memory and written to the file together once they reach the "csv" memory
+ * budget, and when the log is stopped. Rows are only lost if the file can't be written, which
+ * is logged.
  */
 class SORO_CORE_EXPORT CsvRecorder : public QObject
 {
@@ -73,6 +78,7 @@ public:
     };
 
     CsvRecorder(QString logName, QObject *parent=0);
+    ~CsvRecorder();
 
     bool isRecording() const;
     qint64 getStartTime() const;
@@ -80,7 +86,8 @@ public:
     void addColumn(const CsvDataSeries* series);
     void removeColumn(const CsvDataSeries* series);
     void clearColumns();
-    /* Set the update interval to use if the recording mode is RECORDING_MODE_ON_INTERVAL
+    /* Set the update interval to use if the recording mode is RECORDING_MODE_ON_INTERVAL.
+     * If a log is being recorded, the change takes effect once it stops
      */
     void setUpdateInterval(int interval);
     int getUpdateInterval() const;
@@ -103,6 +110,7 @@ Q_SIGNALS:
 protected:
     void timerEvent(QTimerEvent *e);
     void logRow();
+    bool writePendingRows();
 
 protected Q_SLOTS:
     void onSeriesUpdated();
@@ -111,11 +119,13 @@ private:
     QList<const CsvDataSeries*> _columns;
     QHash<const CsvDataSeries*, qint64> _columnDataTimestamps;
     int _updateTimerId = TIMER_INACTIVE;
-    QTextStream *_fileStream = nullptr;
     QString _logDir;
     QString _logName;
     int _updateInterval;
+    int _pendingUpdateInterval = 0;
     QFile *_file = nullptr;
+    QByteArray _pendingRows;
+    MemoryBudget *_budget;
     qint64 _logStartTime;
     bool _isRecording=false;
     RecordingMode _mode=RECORDING_MODE_ON_INTERVAL;
@@ -42,7 +42,15 @@ enum MainMessageType {
     MainMessageType_StartAux1CameraStream,
     MainMessageType_RequestActivateAudioStream,
     MainMessageType_RequestDeactivateAudioStream,
-    MainMessageType_AudioStreamChanged
+    MainMessageType_AudioStreamChanged,
+    MainMessageType_RoverMbedRtt,
+    MainMessageType_RoverConfigUpdate,
+    MainMessageType_DumpTrace,
+    MainMessageType_RoverResourceUpdate,
+    MainMessageType_VideoGovernorUpdate,
+    MainMessageType_RoverPoseUpdate,
+    // Sent by mission control with its clock, and echoed back by the rover with the rover's clock
+    MainMessageType_ClockSync
 };
 
 enum RoverCameraState {
@@ -58,7 +66,7 @@ enum DriveGamepadMode {
 
 enum MbedMessageType
 {
-    // These MUST stay in 8-bit range
+    // These MUST stay in 8-bit range, and 0xFF is reserved by MbedChannel for pings
     MbedMessage_ArmMaster = 1,
     MbedMessage_ArmGamepad,
     MbedMessage_Drive,
@@ -0,0 +1,409 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "eventloopmonitor.h"
+#include "logger.h"
+#include "tracer.h"
+
+#include <QAbstractEventDispatcher>
+
+#ifdef Q_OS_LINUX
+#include <execinfo.h>
+#include <string.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#endif
+
+//interval between probes posted to the event loop
+#define PROBE_INTERVAL 20
+//interval between histograms written to the log
+#define REPORT_INTERVAL 60000
+//default time the event loop has to be unresponsive for to count as a stall
+#define DEFAULT_STALL_THRESHOLD 250
+//deepest backtrace taken of a stalled thread
+#define MAX_STACK_DEPTH 48
+//longest time to wait for the stalled thread to take its backtrace
+#define STACK_SAMPLE_TIMEOUT 100
+//frames at the top of a backtrace that belong to the signal handler
+#define STACK_HANDLER_FRAMES 2
+
+namespace Soro {
+
+namespace {
+
+// Upper bounds of each histogram bucket in milliseconds, the last bucket has no bound
+const int HISTOGRAM_BOUNDS[] = { 5, 10, 25, 50, 100, 250, 500, 1000 };
+const int HISTOGRAM_BUCKETS = sizeof(HISTOGRAM_BOUNDS) / sizeof(int) + 1;
+
+const QEvent::Type ProbeEventType = static_cast<QEvent::Type>(QEvent::registerEventType());
+
+class ProbeEvent: public QEvent {
+public:
+    explicit ProbeEvent(qint64 sentTime) : QEvent(ProbeEventType), sentTime(sentTime) { }
+    qint64 sentTime;
+};
+
+#ifdef Q_OS_LINUX
+// Not used by Qt or GStreamer, SIGUSR1 is already taken by the tracer
+#define STACK_SIGNAL (SIGRTMIN + 2)
+
+void *stackFrames[MAX_STACK_DEPTH];
+std::atomic<int> stackDepth(-1);
+
+void handleStackSignal(int)
+{
+    stackDepth.store(backtrace(stackFrames, MAX_STACK_DEPTH), std::memory_order_release);
+}
+
+void installStackHandler()
+{
+    static bool installed = false;
+    if (installed) return;
+    installed = true;
+
+    // backtrace() loads libgcc the first time it is called, which isn't safe inside a signal handler
+    void *frame;
+    backtrace(&frame, 1);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handleStackSignal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(STACK_SIGNAL, &action, nullptr);
+}
+#endif
+
+} // namespace
+
+/* Posts probes to the monitored event loop and notices when one goes undelivered for too long
+ */
+class EventLoopMonitor::Watchdog: public QThread {
+public:
+    explicit Watchdog(EventLoopMonitor *monitor) : _monitor(monitor)
+    {
+#ifdef Q_OS_LINUX
+        _target = pthread_self();
+#endif
+        _probeOutstanding.store(false);
+    }
+
+    void requestStop()
+    {
+        QMutexLocker locker(&_mutex);
+        _stopRequested = true;
+        _wake.wakeAll();
+    }
+
+    void probeDelivered()
+    {
+        _probeOutstanding.store(false, std::memory_order_release);
+    }
+
+protected:
+    void run()
+    {
+        Tracer::setThreadName("EventLoopWatchdog");
+        qint64 probeSentTime = 0;
+        bool stallRecorded = false;
+
+        QMutexLocker locker(&_mutex);
+        while (!_stopRequested)
+        {
+            _wake.wait(&_mutex, PROBE_INTERVAL);
+            if (_stopRequested) break;
+
+            qint64 now = _monitor->_clock.elapsed();
+            if (!_probeOutstanding.load(std::memory_order_acquire))
+            {
+                probeSentTime = now;
+                stallRecorded = false;
+                _probeOutstanding.store(true, std::memory_order_relaxed);
+                QCoreApplication::postEvent(_monitor, new ProbeEvent(now));
+            }
+            else if (!stallRecorded && (now - probeSentTime >= _monitor->_stallThreshold.load()))
+            {
+                // Look while the loop is still stuck, it will have moved on by the time it can tell us
+                stallRecorded = true;
+                Stall stall;
+                stall.culprit = _monitor->describeCurrentEvent(now);
+                if (_monitor->_stackSampling.load())
+                {
+                    stall.stack = sampleStack();
+                }
+                QMutexLocker stallLocker(&_monitor->_stallMutex);
+                _monitor->_stalls.append(stall);
+            }
+        }
+    }
+
+private:
+    EventLoopMonitor *_monitor;
+    QMutex _mutex;
+    QWaitCondition _wake;
+    bool _stopRequested = false;
+    std::atomic<bool> _probeOutstanding;
+#ifdef Q_OS_LINUX
+    pthread_t _target;
+#endif
+
+    QStringList sampleStack()
+    {
+        QStringList stack;
+#ifdef Q_OS_LINUX
+        stackDepth.store(-1);
+        if (pthread_kill(_target, STACK_SIGNAL) != 0) return stack;
+        for (int i = 0; (i < STACK_SAMPLE_TIMEOUT) && (stackDepth.load(std::memory_order_acquire) < 0); i++)
+        {
+            QThread::msleep(1);
+        }
+        int depth = stackDepth.load(std::memory_order_acquire);
+        if (depth <= STACK_HANDLER_FRAMES) return stack;
+
+        char **symbols = backtrace_symbols(stackFrames, depth);
+        if (!symbols) return stack;
+        for (int i = STACK_HANDLER_FRAMES; i < depth; i++)
+        {
+            stack.append(QString::fromLocal8Bit(symbols[i]));
+        }
+        free(symbols);
+#endif
+        return stack;
+    }
+};
+
+EventLoopMonitor::EventLoopMonitor(QObject *parent) : QObject(parent)
+{
+    LOG_TAG = "EventLoopMonitor";
+    _clock.start();
+    _histogram.fill(0, HISTOGRAM_BUCKETS);
+    _sequence.store(0);
+    _currentClass.store(nullptr);
+    _currentEvent.store(QEvent::None);
+    _currentTimerId.store(0);
+    _currentSince.store(0);
+    _stallThreshold.store(DEFAULT_STALL_THRESHOLD);
+    _stackSampling.store(false);
+}
+
+EventLoopMonitor::~EventLoopMonitor()
+{
+    stop();
+}
+
+void EventLoopMonitor::start()
+{
+    if (_watchdog) return;
+
+    // Application event filters see every event delivered on the main thread
+    QCoreApplication::instance()->installEventFilter(this);
+    connect(QAbstractEventDispatcher::instance(), &QAbstractEventDispatcher::awake,
+            this, &EventLoopMonitor::dispatcherAwake, Qt::DirectConnection);
+
+    // Created here so it can find out which thread it is watching
+    _watchdog = new Watchdog(this);
+    _watchdog->start();
+    START_TIMER(_reportTimerId, REPORT_INTERVAL);
+    LOG_I(LOG_TAG, "Watching the event loop, stalls are longer than " + QString::number(_stallThreshold.load()) + "ms");
+}
+
+void EventLoopMonitor::stop()
+{
+    if (!_watchdog) return;
+
+    _watchdog->requestStop();
+    _watchdog->wait();
+    delete _watchdog;
+    _watchdog = nullptr;
+
+    QCoreApplication::instance()->removeEventFilter(this);
+    disconnect(QAbstractEventDispatcher::instance(), &QAbstractEventDispatcher::awake,
+               this, &EventLoopMonitor::dispatcherAwake);
+    KILL_TIMER(_reportTimerId);
+}
+
+void EventLoopMonitor::setStallThreshold(int threshold)
+{
+    _stallThreshold.store(threshold);
+}
+
+void EventLoopMonitor::setStackSamplingEnabled(bool enabled)
+{
+#ifdef Q_OS_LINUX
+    if (enabled)
+    {
+        installStackHandler();
+    }
+    _stackSampling.store(enabled);
+#else
+    if (enabled)
+    {
+        LOG_W(LOG_TAG, "Stack sampling is only supported on Linux");
+    }
+#endif
+}
+
+int EventLoopMonitor::takeMaxLag()
+{
+    int lag = _maxLag;
+    _maxLag = 0;
+    return lag;
+}
+
+void EventLoopMonitor::setCurrentEvent(const QMetaObject *receiver, int type, int timerId)
+{
+    quint32 sequence = _sequence.load(std::memory_order_relaxed);
+    _sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _currentClass.store(receiver, std::memory_order_relaxed);
+    _currentEvent.store(type, std::memory_order_relaxed);
+    _currentTimerId.store(timerId, std::memory_order_relaxed);
+    _currentSince.store(_clock.elapsed(), std::memory_order_relaxed);
+    _sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool EventLoopMonitor::eventFilter(QObject *watched, QEvent *event)
+{
+    setCurrentEvent(watched->metaObject(), event->type(),
+                    event->type() == QEvent::Timer ? static_cast<QTimerEvent*>(event)->timerId() : 0);
+    return false;
+}
+
+void EventLoopMonitor::dispatcherAwake()
+{
+    setCurrentEvent(nullptr, QEvent::None, 0);
+}
+
+QString EventLoopMonitor::describeCurrentEvent(qint64 now) const
+{
+    const QMetaObject *receiver = nullptr;
+    int type = QEvent::None;
+    int timerId = 0;
+    qint64 since = now;
+
+    // The loop is stuck, so this only has to retry if it happened to move on while being read
+    bool consistent = false;
+    for (int attempt = 0; (attempt < 3) && !consistent; attempt++)
+    {
+        quint32 sequence = _sequence.load(std::memory_order_acquire);
+        if (sequence & 1) continue;
+        receiver = _currentClass.load(std::memory_order_relaxed);
+        type = _currentEvent.load(std::memory_order_relaxed);
+        timerId = _currentTimerId.load(std::memory_order_relaxed);
+        since = _currentSince.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        consistent = _sequence.load(std::memory_order_relaxed) == sequence;
+    }
+    if (!consistent) return "an unknown event";
+
+    QString description;
+    if (!receiver)
+    {
+        description = "the event dispatcher outside of any Qt event (such as a GLib source)";
+    }
+    else if (type == QEvent::Timer)
+    {
+        description = "timer " + QString::number(timerId) + " of " + receiver->className();
+    }
+    else if (type == QEvent::MetaCall)
+    {
+        description = QString("a queued slot call to ") + receiver->className();
+    }
+    else
+    {
+        QMetaEnum types = QEvent::staticMetaObject.enumerator(QEvent::staticMetaObject.indexOfEnumerator("Type"));
+        const char *typeName = types.valueToKey(type);
+        description = (typeName ? QString(typeName) : "type " + QString::number(type)) + " event for " + receiver->className();
+    }
+    return description + ", running for " + QString::number(now - since) + "ms";
+}
+
+bool EventLoopMonitor::event(QEvent *e)
+{
+    if (e->type() == ProbeEventType)
+    {
+        probeReceived(static_cast<ProbeEvent*>(e)->sentTime);
+        return true;
+    }
+    return QObject::event(e);
+}
+
+void EventLoopMonitor::probeReceived(qint64 sentTime)
+{
+    int lag = static_cast<int>(_clock.elapsed() - sentTime);
+    if (_watchdog)
+    {
+        _watchdog->probeDelivered();
+    }
+
+    int bucket = 0;
+    while ((bucket < HISTOGRAM_BUCKETS - 1) && (lag >= HISTOGRAM_BOUNDS[bucket])) bucket++;
+    _histogram[bucket]++;
+    _maxLag = qMax(_maxLag, lag);
+    _reportMaxLag = qMax(_reportMaxLag, lag);
+
+    QList<Stall> stalls;
+    {
+        QMutexLocker locker(&_stallMutex);
+        stalls.swap(_stalls);
+    }
+    for (const Stall& stall : stalls)
+    {
+        LOG_W(LOG_TAG, "Event loop stalled for " + QString::number(lag) + "ms in " + stall.culprit);
+        if (!stall.stack.isEmpty())
+        {
+            LOG_W(LOG_TAG, "Stack of the stalled thread:\n    " + stall.stack.join("\n    "));
+        }
+        if (Tracer::isEnabled())
+        {
+            Tracer::record('X', "eventloop", "stall", Tracer::now() - lag * 1000LL, lag * 1000LL);
+        }
+        Q_EMIT stalled(lag, stall.culprit);
+    }
+}
+
+QString EventLoopMonitor::getHistogramReport() const
+{
+    QStringList buckets;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+    {
+        if (_histogram[i] == 0) continue;
+        QString bound = i < HISTOGRAM_BUCKETS - 1 ?
+                    "<" + QString::number(HISTOGRAM_BOUNDS[i]) : ">=" + QString::number(HISTOGRAM_BOUNDS[i - 1]);
+        buckets.append(bound + "ms: " + QString::number(_histogram[i]));
+    }
+    if (buckets.isEmpty()) return "no samples";
+    return buckets.join(", ") + " (max " + QString::number(_reportMaxLag) + "ms)";
+}
+
+void EventLoopMonitor::logHistogram()
+{
+    LOG_I(LOG_TAG, "Event loop lag over the last " + QString::number(REPORT_INTERVAL / 1000) + "s: " + getHistogramReport());
+    _histogram.fill(0);
+    _reportMaxLag = 0;
+}
+
+void EventLoopMonitor::timerEvent(QTimerEvent *e)
+{
+    QObject::timerEvent(e);
+    if (e->timerId() == _reportTimerId)
+    {
+        logHistogram();
+    }
+}
+
+} // namespace Soro
@@ -0,0 +1,105 @@
+#ifndef SORO_EVENTLOOPMONITOR_H
+#define SORO_EVENTLOOPMONITOR_H
+
+#include <QtCore>
+#include <atomic>
+
+#include "soro_core_global.h"
+#include "constants.h"
+
+namespace Soro {
+
+/* Measures how responsive the event loop of the thread it is created on is, and works out
+ * what was running whenever it stops responding.
+ *
+ * A watchdog thread posts an event to the monitor at a fixed interval and the time it takes
+ * to be delivered is recorded as the event loop's lag. If an event goes undelivered for longer
+ * than the stall threshold, the watchdog looks up which event was being delivered at the time
+ * (the receiver's class, the event type, and the timer ID for timer events) so the stall can
+ * be logged once the loop recovers. With stack sampling enabled it also interrupts the stalled
+ * thread to take a backtrace of where it was stuck.
+ *
+ * Events are tracked with an application event filter, so only the outermost event is known
+ * when a slot spins its own event loop, and queued slot calls are only known by their receiver.
+ *
+ * A histogram of lags is logged every minute. Only one monitor should exist per process, since
+ * stack sampling installs a process wide signal handler.
+ */
+class SORO_CORE_EXPORT EventLoopMonitor: public QObject {
+    Q_OBJECT
+public:
+    explicit EventLoopMonitor(QObject *parent = nullptr);
+    ~EventLoopMonitor();
+
+    void start();
+    void stop();
+
+    /* Sets how long in milliseconds the event loop has to be unresponsive for to count as stalled
+     */
+    void setStallThreshold(int threshold);
+
+    /* Sets whether a backtrace of the stalled thread is taken for each stall. This is meant
+     * for debugging, as it sends a signal to the thread during the stall.
+     */
+    void setStackSamplingEnabled(bool enabled);
+
+    /* Gets the longest lag in milliseconds since the last call to this function
+     */
+    int takeMaxLag();
+
+    /* Gets a one line summary of the lags recorded since the last histogram was logged
+     */
+    QString getHistogramReport() const;
+
+Q_SIGNALS:
+    /* Emitted once the event loop recovers from a stall
+     */
+    void stalled(int duration, QString culprit);
+
+protected:
+    bool event(QEvent *e);
+    bool eventFilter(QObject *watched, QEvent *event);
+    void timerEvent(QTimerEvent *e);
+
+private:
+    class Watchdog;
+    friend class Watchdog;
+
+    struct Stall {
+        QString culprit;
+        QStringList stack;
+    };
+
+    QString LOG_TAG;
+    Watchdog *_watchdog = nullptr;
+    QElapsedTimer _clock;
+    int _reportTimerId = TIMER_INACTIVE;
+    QVector<int> _histogram;
+    int _maxLag = 0;
+    int _reportMaxLag = 0;
+
+    // Written by the monitored thread for every event, read by the watchdog like a seqlock
+    std::atomic<quint32> _sequence;
+    std::atomic<const QMetaObject*> _currentClass;
+    std::atomic<int> _currentEvent;
+    std::atomic<int> _currentTimerId;
+    std::atomic<qint64> _currentSince;
+
+    std::atomic<int> _stallThreshold;
+    std::atomic<bool> _stackSampling;
+
+    QMutex _stallMutex;
+    QList<Stall> _stalls;
+
+    void setCurrentEvent(const QMetaObject *receiver, int type, int timerId);
+    QString describeCurrentEvent(qint64 now) const;
+    void probeReceived(qint64 sentTime);
+    void logHistogram();
+
+private Q_SLOTS:
+    void dispatcherAwake();
+};
+
+} // namespace Soro
+
+#endif // SORO_EVENTLOOPMONITOR_H
@@ -0,0 +1,394 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "executor.h"
+#include "logger.h"
+#include "tracer.h"
+
+#include <climits>
+#include <deque>
+
+namespace Soro {
+
+class Executor::Worker: public QThread {
+public:
+    Worker(Executor *executor, int index) : executor(executor), index(index)
+    {
+        tid.store(0);
+    }
+
+    Executor *executor;
+    int index;
+    std::atomic<qint32> tid;
+    QMutex mutex;
+    std::deque<Task> queues[PRIORITY_COUNT];
+
+protected:
+    void run()
+    {
+        executor->workerLoop(this);
+    }
+};
+
+namespace {
+
+/* The executor and worker the calling thread belongs to, if it is a worker
+ */
+thread_local Executor *currentExecutor = nullptr;
+thread_local int currentWorkerIndex = -1;
+
+/* Carries a task to another thread's event loop, and runs it there if its context still exists
+ */
+class Delivery: public QObject {
+public:
+    Delivery(QPointer<QObject> context, Executor::Task task) : _context(context), _task(task) { }
+
+    bool event(QEvent *e)
+    {
+        if (e->type() != QEvent::User) return QObject::event(e);
+        if (_context)
+        {
+            _task();
+        }
+        deleteLater();
+        return true;
+    }
+
+private:
+    QPointer<QObject> _context;
+    Executor::Task _task;
+};
+
+} // namespace
+
+Executor* Executor::_root = new Executor("Executor");
+
+Executor::Executor(QString name, int threadCount) : _name(name)
+{
+    LOG_TAG = name;
+    _threadCount = threadCount;
+    _started.store(false);
+    _stopping.store(false);
+    _sleeping.store(0);
+    _queued.store(0);
+    _completed.store(0);
+    _stolen.store(0);
+    _nextWorker.store(0);
+    _nextDeadline.store(LLONG_MAX);
+    _clock.start();
+}
+
+Executor::~Executor()
+{
+    shutdown();
+    qDeleteAll(_workers);
+}
+
+void Executor::setThreadCount(int threadCount)
+{
+    QMutexLocker locker(&_mutex);
+    if (_started.load())
+    {
+        LOG_W(LOG_TAG, "Cannot change the number of workers once they are running");
+        return;
+    }
+    _threadCount = qMax(threadCount, 0);
+}
+
+int Executor::getThreadCount() const
+{
+    return _threadCount > 0 ? _threadCount : qMax(QThread::idealThreadCount(), 1);
+}
+
+void Executor::setSchedulingPolicy(const SchedulingPolicy& policy)
+{
+    QMutexLocker locker(&_mutex);
+    _policy = policy;
+    for (Worker *worker : _workers)
+    {
+        qint32 tid = worker->tid.load();
+        if (tid != 0)
+        {
+            _policy.withDefaults().applyToThread(tid, _name + " worker " + QString::number(worker->index));
+        }
+    }
+}
+
+void Executor::start()
+{
+    QMutexLocker locker(&_mutex);
+    if (_started.load() || _stopping.load()) return;
+    int count = getThreadCount();
+    for (int i = 0; i < count; i++)
+    {
+        Worker *worker = new Worker(this, i);
+        // Also names the thread in /proc, where the resource monitor and scheduling logs find it
+        worker->setObjectName(_name + QString::number(i));
+        _workers.append(worker);
+    }
+    _started.store(true);
+    for (Worker *worker : _workers)
+    {
+        worker->start();
+    }
+    LOG_I(LOG_TAG, "Started " + QString::number(count) + " workers");
+}
+
+void Executor::shutdown()
+{
+    {
+        QMutexLocker locker(&_mutex);
+        if (_stopping.load()) return;
+        _stopping.store(true);
+        _wake.wakeAll();
+    }
+    // Workers are only deleted with the executor, a post that raced with this may still push to them
+    for (Worker *worker : _workers)
+    {
+        worker->wait();
+        QMutexLocker locker(&worker->mutex);
+        for (std::deque<Task>& queue : worker->queues)
+        {
+            queue.clear();
+        }
+    }
+    QMutexLocker locker(&_mutex);
+    _timers.clear();
+    _timerDeadlines.clear();
+    _queued.store(0);
+}
+
+void Executor::post(Task task, Priority priority)
+{
+    if (!_started.load())
+    {
+        start();
+    }
+    if (_stopping.load()) return;
+    push(task, priority);
+    wakeWorker();
+}
+
+void Executor::push(Task task, Priority priority)
+{
+    Worker *worker;
+    if (currentExecutor == this)
+    {
+        worker = _workers[currentWorkerIndex];
+    }
+    else
+    {
+        worker = _workers[_nextWorker.fetch_add(1, std::memory_order_relaxed) % _workers.size()];
+    }
+    QMutexLocker locker(&worker->mutex);
+    worker->queues[priority].push_back(task);
+    _queued.fetch_add(1);
+}
+
+void Executor::wakeWorker()
+{
+    // A worker counts itself as sleeping before it looks at _queued one last time, and push()
+    // counts the task before this looks at _sleeping, so one of them always sees the other
+    if (_sleeping.load() > 0)
+    {
+        QMutexLocker locker(&_mutex);
+        _wake.wakeOne();
+    }
+}
+
+int Executor::postDelayed(int delay, Task task, Priority priority)
+{
+    return addTimer(delay, 0, task, priority);
+}
+
+int Executor::postRepeating(int interval, Task task, Priority priority)
+{
+    return addTimer(interval, qMax(interval, 1), task, priority);
+}
+
+int Executor::addTimer(int delay, int interval, Task task, Priority priority)
+{
+    if (!_started.load())
+    {
+        start();
+    }
+    QMutexLocker locker(&_mutex);
+    if (_stopping.load()) return 0;
+    int id = _nextTimerId++;
+    Timer timer;
+    timer.task = task;
+    timer.priority = priority;
+    timer.interval = interval;
+    _timers.insert(id, timer);
+    qint64 deadline = _clock.elapsed() + qMax(delay, 0);
+    _timerDeadlines.insert(std::make_pair(deadline, id));
+    if (deadline < _nextDeadline.load())
+    {
+        _nextDeadline.store(deadline);
+        // A waiting worker has to recalculate how long to wait for
+        _wake.wakeOne();
+    }
+    return id;
+}
+
+void Executor::cancel(int timerId)
+{
+    QMutexLocker locker(&_mutex);
+    // Its deadline is skipped when it comes up
+    _timers.remove(timerId);
+}
+
+Executor::Stats Executor::getStats() const
+{
+    Stats stats;
+    stats.threads = getThreadCount();
+    stats.queued = _queued.load();
+    stats.completed = _completed.load();
+    stats.stolen = _stolen.load();
+    return stats;
+}
+
+void Executor::deliver(QPointer<QObject> context, Task task)
+{
+    if (!context) return;
+    Delivery *delivery = new Delivery(context, task);
+    delivery->moveToThread(context->thread());
+    QCoreApplication::postEvent(delivery, new QEvent(QEvent::User));
+}
+
+bool Executor::take(Worker *worker, Task *task)
+{
+    int count = _workers.size();
+    for (int priority = 0; priority < PRIORITY_COUNT; priority++)
+    {
+        {
+            // A worker takes its own tasks oldest first
+            QMutexLocker locker(&worker->mutex);
+            std::deque<Task>& queue = worker->queues[priority];
+            if (!queue.empty())
+            {
+                *task = queue.front();
+                queue.pop_front();
+                _queued.fetch_sub(1);
+                return true;
+            }
+        }
+        for (int i = 1; i < count; i++)
+        {
+            // and steals the newest, which the victim would have gotten to last
+            Worker *victim = _workers[(worker->index + i) % count];
+            QMutexLocker locker(&victim->mutex);
+            std::deque<Task>& queue = victim->queues[priority];
+            if (!queue.empty())
+            {
+                *task = queue.back();
+                queue.pop_back();
+                _queued.fetch_sub(1);
+                _stolen.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+qint64 Executor::postDueTimers()
+{
+    qint64 now = _clock.elapsed();
+    while (!_timerDeadlines.empty() && (_timerDeadlines.begin()->first <= now))
+    {
+        qint64 deadline = _timerDeadlines.begin()->first;
+        int id = _timerDeadlines.begin()->second;
+        _timerDeadlines.erase(_timerDeadlines.begin());
+
+        QHash<int, Timer>::iterator timer = _timers.find(id);
+        if (timer == _timers.end()) continue;
+        push(timer.value().task, timer.value().priority);
+        _wake.wakeOne();
+        if (timer.value().interval > 0)
+        {
+            qint64 next = deadline + timer.value().interval;
+            if (next <= now) next = now + timer.value().interval;
+            _timerDeadlines.insert(std::make_pair(next, id));
+        }
+        else
+        {
+            _timers.erase(timer);
+        }
+    }
+    if (_timerDeadlines.empty())
+    {
+        _nextDeadline.store(LLONG_MAX);
+        return -1;
+    }
+    _nextDeadline.store(_timerDeadlines.begin()->first);
+    return _timerDeadlines.begin()->first - now;
+}
+
+void Executor::workerLoop(Worker *worker)
+{
+    currentExecutor = this;
+    currentWorkerIndex = worker->index;
+    worker->tid.store(SchedulingPolicy::currentThreadId());
+    Tracer::setThreadName(worker->objectName());
+    {
+        QMutexLocker locker(&_mutex);
+        // Workers are started from whichever thread posted first, and would otherwise keep its policy
+        _policy.withDefaults().applyToCurrentThread(_name + " worker " + QString::number(worker->index));
+    }
+
+    Task task;
+    while (true)
+    {
+        if (_clock.elapsed() >= _nextDeadline.load())
+        {
+            QMutexLocker locker(&_mutex);
+            postDueTimers();
+        }
+        if (take(worker, &task))
+        {
+            task();
+            task = nullptr;
+            _completed.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        QMutexLocker locker(&_mutex);
+        if (_stopping.load()) break;
+        qint64 wait = postDueTimers();
+        _sleeping.fetch_add(1);
+        if (_queued.load() > 0)
+        {
+            // Posted since take() looked, possibly without waking anyone
+            _sleeping.fetch_sub(1);
+            continue;
+        }
+        if (wait < 0)
+        {
+            _wake.wait(&_mutex);
+        }
+        else
+        {
+            _wake.wait(&_mutex, static_cast<unsigned long>(wait));
+        }
+        _sleeping.fetch_sub(1);
+        if (_stopping.load()) break;
+    }
+    currentExecutor = nullptr;
+    currentWorkerIndex = -1;
+}
+
+} // namespace Soro
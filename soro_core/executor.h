@@ -0,0 +1,161 @@
+#ifndef SORO_EXECUTOR_H
+#define SORO_EXECUTOR_H
+
+#include <QtCore>
+#include <atomic>
+#include <functional>
+#include <map>
+
+#include "soro_core_global.h"
+#include "schedulingpolicy.h"
+
+namespace Soro {
+
+/* Runs short tasks on a fixed pool of worker threads, so blocking or CPU heavy work can be moved
+ * off the main thread without writing a QThread for it.
+ *
+ * Each worker has its own queue for each priority, with its own lock. Tasks posted from a worker go
+ * on that worker's queue, tasks posted from anywhere else are spread across the workers, and a worker
+ * with nothing left to do steals from the others. Higher priority tasks are always taken first, from
+ * any worker. Tasks posted to the same executor are not run in any particular order.
+ *
+ * Posting only takes the lock of the queue the task goes on while every worker is busy. The
+ * executor's own lock is only taken to wake a sleeping worker, and for delayed tasks.
+ *
+ * Workers are started the first time a task is posted, so the pool can be sized and given a
+ * scheduling policy from configuration before that.
+ *
+ * Tasks must not block for long on other tasks in the same executor, as every worker could end
+ * up waiting. Tasks can't create QObjects that outlive them, workers don't run an event loop.
+ */
+class SORO_CORE_EXPORT Executor {
+public:
+    enum Priority {
+        HighPriority,
+        NormalPriority,
+        LowPriority
+    };
+
+    typedef std::function<void()> Task;
+
+    struct Stats {
+        int threads;
+        qint64 queued;
+        quint64 completed;
+        quint64 stolen;
+    };
+
+    /* Gets the process-wide executor
+     */
+    static inline Executor* root() {
+        return _root;
+    }
+
+    /* Creates an executor with this many workers, or one per core if 0
+     */
+    explicit Executor(QString name, int threadCount=0);
+
+    /* Waits for running tasks to finish, anything still queued is discarded
+     */
+    ~Executor();
+
+    /* Sets the number of workers, or one per core if 0. Must be called before the first task is posted.
+     */
+    void setThreadCount(int threadCount);
+    int getThreadCount() const;
+
+    /* Sets the scheduling policy of every worker, including ones already running. Workers run on
+     * every core at nice 0 for anything the policy leaves out, rather than with whatever the
+     * thread that started them was given.
+     */
+    void setSchedulingPolicy(const SchedulingPolicy& policy);
+
+    void post(Task task, Priority priority=NormalPriority);
+
+    /* Runs work on a worker, then calls done with its result on the thread context lives in. If context
+     * is destroyed before then, done is not called.
+     */
+    template<typename Work, typename Done>
+    void post(Work work, QObject *context, Done done, Priority priority=NormalPriority)
+    {
+        QPointer<QObject> guard(context);
+        post([work, guard, done]() mutable
+        {
+            auto result = work();
+            deliver(guard, [done, result]() mutable
+            {
+                done(result);
+            });
+        }, priority);
+    }
+
+    /* Posts a task after delay milliseconds, and returns an ID that can be used to cancel it
+     */
+    int postDelayed(int delay, Task task, Priority priority=NormalPriority);
+
+    /* Posts a task every interval milliseconds until it is cancelled. If a worker can't get to it in
+     * time, runs are skipped instead of bunched up.
+     */
+    int postRepeating(int interval, Task task, Priority priority=NormalPriority);
+
+    void cancel(int timerId);
+
+    /* Stops every worker after its current task, discarding anything still queued. Nothing
+     * posted after this is run.
+     */
+    void shutdown();
+
+    Stats getStats() const;
+
+    /* Calls task on the thread context lives in, as long as context still exists by then
+     */
+    static void deliver(QPointer<QObject> context, Task task);
+
+private:
+    Q_DISABLE_COPY(Executor)
+
+    class Worker;
+    friend class Worker;
+
+    struct Timer {
+        Task task;
+        Priority priority;
+        int interval;
+    };
+
+    static const int PRIORITY_COUNT = LowPriority + 1;
+
+    QString LOG_TAG;
+    QString _name;
+    int _threadCount;
+    SchedulingPolicy _policy;
+    QVector<Worker*> _workers;
+    std::atomic<bool> _started;
+    std::atomic<bool> _stopping;
+    std::atomic<int> _sleeping;
+    QMutex _mutex;
+    QWaitCondition _wake;
+    QElapsedTimer _clock;
+    std::atomic<qint64> _queued;
+    std::atomic<quint64> _completed;
+    std::atomic<quint64> _stolen;
+    std::atomic<unsigned> _nextWorker;
+    std::atomic<qint64> _nextDeadline;
+    int _nextTimerId = 1;
+    QHash<int, Timer> _timers;
+    std::multimap<qint64, int> _timerDeadlines;
+
+    static Executor *_root;
+
+    void start();
+    void push(Task task, Priority priority);
+    void wakeWorker();
+    int addTimer(int delay, int interval, Task task, Priority priority);
+    bool take(Worker *worker, Task *task);
+    qint64 postDueTimers();
+    void workerLoop(Worker *worker);
+};
+
+} // namespace Soro
+
+#endif // SORO_EXECUTOR_H
@@ -111,33 +111,50 @@ bool AudioProfile::operator==(const AudioProfile& other) const
             (bitrate == other.bitrate);
 }
 
+bool useTestSources()
+{
+    return qEnvironmentVariableIsSet(TEST_SOURCES_ENV);
+}
+
+QString getVideoSourceElement(QString cameraDevice)
+{
+    if (useTestSources())
+    {
+        // is-live makes it produce frames in real time like a camera instead of as fast as possible
+        return "videotestsrc is-live=true pattern=ball";
+    }
+    return "v4l2src device=/dev/" + cameraDevice;
+}
+
 QString createRtpAlsaEncodeString(quint16 bindPort,  QHostAddress address, quint16 port, AudioProfile profile)
 {
-    return "alsasrc ! audioconvert ! " + createRtpAudioEncodeString(bindPort, address, port, profile);
+    QString source = useTestSources() ? "audiotestsrc is-live=true wave=ticks" : "alsasrc";
+    return source + " ! audioconvert ! " + createRtpAudioEncodeString(bindPort, address, port, profile);
 }
 
 QString createRtpV4L2EncodeString(QString cameraDevice, quint16 bindPort, QHostAddress address, quint16 port, VideoProfile profile, bool vaapi)
 {
-    return QString("v4l2src device=/dev/%1 ! "
+    return QString("%1 ! "
                    "videoscale method=0 add-borders=true ! "
-                   "videorate drop-only=true ! "
+                   "videorate drop-only=true name=%3 ! "
                    "%2")
-            .arg(cameraDevice,
-                 createRtpVideoEncodeString(bindPort, address, port, profile, vaapi));
+            .arg(getVideoSourceElement(cameraDevice),
+                 createRtpVideoEncodeString(bindPort, address, port, profile, vaapi),
+                 VIDEO_RATE_ELEMENT_NAME);
 }
 
 QString createRtpStereoV4L2EncodeString(QString leftCameraDevice, QString rightCameraDevice, quint16 bindPort, QHostAddress address, quint16 port, VideoProfile profile, bool vaapi)
 {
-    return QString("v4l2src device=/dev/%5 ! "
+    return QString("%5 ! "
                    "videoscale method=0 add-borders=true ! "
-                   "videorate drop-only=true ! "
+                   "videorate drop-only=true name=%8 ! "
                    "video/x-raw,width=%1,height=%2,framerate=%3/1 ! "
                    "videoscale method=0 add-borders=false ! "
                    "video/x-raw,width=%4,height=%2 ! "
                    "videobox left=-%4 ! "
                    "videomixer name=mix background=black ! "
                    "%7 "
-                   "v4l2src device=/dev/%6 ! "
+                   "%6 ! "
                    "videoscale method=0 add-borders=true ! "
                    "videorate drop-only=true ! "
                    "video/x-raw,width=%1,height=%2,framerate=%3/1 ! "
@@ -148,9 +165,10 @@ QString createRtpStereoV4L2EncodeString(QString leftCameraDevice, QString rightC
                 QString::number(profile.height),
                 QString::number(profile.framerate),
                 QString::number(profile.width / 2),
-                rightCameraDevice,
-                leftCameraDevice,
-                createRtpVideoEncodeString(bindPort, address, port, profile, vaapi));
+                getVideoSourceElement(rightCameraDevice),
+                getVideoSourceElement(leftCameraDevice),
+                createRtpVideoEncodeString(bindPort, address, port, profile, vaapi),
+                VIDEO_RATE_ELEMENT_NAME);
 }
 
 QString createRtpVideoEncodeString(quint16 bindPort, QHostAddress address, quint16 port, VideoProfile profile, bool vaapi)
@@ -197,7 +215,8 @@ QString createRtpVideoDecodeString(QHostAddress address, quint16 port, quint8 co
     return createRtpDepayString(address, port, codec) + " ! " + getVideoDecodeElement(codec) + " ! videoconvert ! video/x-raw,format=RGB ! videoconvert";
 }
 
-QString createRtpVideoFileSaveString(QHostAddress address, quint16 port, quint8 codec, QString filePath, bool timeOverlay, bool encodeVaapi)
+QString createRtpVideoFileSaveString(QHostAddress address, quint16 port, quint8 codec, QString filePath, bool timeOverlay, bool encodeVaapi,
+                                     QString queueName, quint32 queueBytes)
 {
     QString bin = createRtpDepayString(address, port, codec)
             + " ! " + getVideoDecodeElement(codec)
@@ -210,11 +229,18 @@ QString createRtpVideoFileSaveString(QHostAddress address, quint16 port, quint8
     VideoProfile encodeProfile;
     encodeProfile.codec = VIDEO_CODEC_H264;
 
-    bin += getVideoEncodeElement(encodeProfile, encodeVaapi) + QString(" ! queue ! avimux ! filesink location=\"%1\"").arg(filePath);
+    QString queue = queueBytes > 0 ? getBoundedQueueElement(queueName, queueBytes, true) : "queue";
+    bin += getVideoEncodeElement(encodeProfile, encodeVaapi) + QString(" ! %1 ! avimux ! filesink location=\"%2\"").arg(queue, filePath);
 
     return bin;
 }
 
+QString getBoundedQueueElement(QString name, quint32 maxBytes, bool dropOldest)
+{
+    return QString("queue name=%1 max-size-bytes=%2 max-size-buffers=0 max-size-time=0 leaky=%3")
+            .arg(name, QString::number(maxBytes), dropOldest ? "downstream" : "no");
+}
+
 QString createVideoTestSrcString(QString pattern, bool grayscale, quint16 width, quint16 height, quint16 framerate)
 {
     return QString("videotestsrc pattern=%1 ! video/x-raw,format=%2,width=%3,height=%4,framerate=%5/1 ! videoconvert")
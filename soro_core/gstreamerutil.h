@@ -64,10 +64,28 @@ struct SORO_CORE_EXPORT AudioProfile
     }
 };
 
+/* Environment variable that replaces the rover's cameras and microphone with test sources
+ * when set, so the whole system can run on a machine without them (see soak_test)
+ */
+#define TEST_SOURCES_ENV "SORO_TEST_SOURCES"
+
+/* Returns true if TEST_SOURCES_ENV is set for this process
+ */
+bool useTestSources();
+
+/* Gets the source element for a camera device, or for a test pattern if useTestSources() is true
+ */
+QString getVideoSourceElement(QString cameraDevice);
+
 /* Creates a pipeline string that encodes ALSA audio into a RTP stream
  */
 QString createRtpAlsaEncodeString(quint16 bindPort, QHostAddress address, quint16 port, AudioProfile profile);
 
+/* Name of the videorate element in camera pipelines. Its "out" property counts the frames that
+ * made it through, so a streamer can tell when encoding can't keep up with the framerate.
+ */
+#define VIDEO_RATE_ELEMENT_NAME "camerarate"
+
 /* Creates a pipeline string that encodes video from a camera into a RTP stream
  */
 QString createRtpV4L2EncodeString(QString cameraDevice, quint16 bindPort, QHostAddress address, quint16 port, VideoProfile profile, bool vaapi=false);
@@ -89,8 +107,17 @@ QString createRtpVideoDecodeString(QHostAddress address, quint16 port, quint8 co
 /* Creates a pipeline string that accepts an RTP video stream on a UDP port, and decodes it from the specified codec and
  * re-encodes it as an H264 video file at the specifed location. If desired, a timestamp and/or custom text can be
  * overlaid on the video.
+ *
+ * If queueBytes is set, the encoded video waits for the file in a queue with the given name that holds at most
+ * that many bytes, dropping the oldest data past it (see getBoundedQueueElement()).
+ */
+QString createRtpVideoFileSaveString(QHostAddress address, quint16 port, quint8 codec, QString filePath, bool timeOverlay, bool encodeVaapi=false,
+                                     QString queueName="", quint32 queueBytes=0);
+
+/* Gets a queue element that holds at most maxBytes, no matter how many buffers or how much time that is. Past that,
+ * the oldest buffers are dropped if dropOldest is set, otherwise upstream is blocked until there is room.
  */
-QString createRtpVideoFileSaveString(QHostAddress address, quint16 port, quint8 codec, QString filePath, bool timeOverlay, bool encodeVaapi=false);
+QString getBoundedQueueElement(QString name, quint32 maxBytes, bool dropOldest);
 
 /* Creates a pipeline string that outputs a video test pattern
  */
@@ -0,0 +1,326 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "liveconfig.h"
+#include "logger.h"
+
+//time to wait after the file changes before reloading it, editors often write a file in several steps
+#define RELOAD_DELAY 250
+
+namespace Soro {
+
+LiveConfig::LiveConfig(QObject *parent) : QObject(parent)
+{
+    LOG_TAG = "LiveConfig";
+    _watcher = new QFileSystemWatcher(this);
+    connect(_watcher, &QFileSystemWatcher::fileChanged, this, &LiveConfig::fileChanged);
+}
+
+void LiveConfig::define(const QString& key, LiveConfig::Type type, const QVariant& defaultValue, bool live)
+{
+    KeyDefinition definition;
+    definition.type = type;
+    definition.defaultValue = defaultValue;
+    definition.live = live;
+    definition.hasRange = false;
+    definition.min = 0;
+    definition.max = 0;
+    _schema.insert(key.toLower(), definition);
+}
+
+void LiveConfig::setRange(const QString& key, double min, double max)
+{
+    QHash<QString, KeyDefinition>::iterator definition = _schema.find(key.toLower());
+    if (definition == _schema.end())
+    {
+        LOG_E(LOG_TAG, "setRange() called for undefined key " + key);
+        return;
+    }
+    definition->hasRange = true;
+    definition->min = min;
+    definition->max = max;
+}
+
+bool LiveConfig::load(const QString& path)
+{
+    _path = path;
+    _loaded = false;
+    LOG_TAG = "LiveConfig(" + QFileInfo(path).fileName() + ")";
+    if (!reload())
+    {
+        LOG_E(LOG_TAG, _error);
+        return false;
+    }
+    watch();
+    return true;
+}
+
+bool LiveConfig::parse(const QString& key, const QString& rawValue, QVariant *value) const
+{
+    if (!_schema.contains(key))
+    {
+        *value = rawValue;
+        return true;
+    }
+    const KeyDefinition& definition = _schema[key];
+    bool ok = true;
+    switch (definition.type)
+    {
+    case StringType:
+        *value = rawValue;
+        break;
+    case IntType:
+        *value = rawValue.toInt(&ok);
+        break;
+    case DoubleType:
+        *value = rawValue.toDouble(&ok);
+        break;
+    case BoolType: {
+        QString lower = rawValue.toLower();
+        if ((lower == "true") || (lower == "1")) *value = true;
+        else if ((lower == "false") || (lower == "0")) *value = false;
+        else ok = false;
+    }
+        break;
+    case IPType: {
+        QHostAddress address;
+        ok = address.setAddress(rawValue);
+        *value = address.toString();
+    }
+        break;
+    case StringListType: {
+        QStringList list;
+        for (QString item : rawValue.split(',', QString::SkipEmptyParts))
+        {
+            item = item.trimmed();
+            if (!item.isEmpty()) list.append(item);
+        }
+        *value = list;
+    }
+        break;
+    }
+    if (ok && definition.hasRange)
+    {
+        double number = value->toDouble();
+        ok = (number >= definition.min) && (number <= definition.max);
+    }
+    return ok;
+}
+
+bool LiveConfig::reload()
+{
+    QFile file(_path);
+    ConfLoader loader;
+    if (!loader.load(file))
+    {
+        _error = "Cannot read configuration file " + _path;
+        return false;
+    }
+    QHash<QString, QString> fileValues;
+    for (const QString& key : loader.tags())
+    {
+        fileValues.insert(key, loader.value(key));
+    }
+
+    // Validate everything before applying anything, so a bad edit can't leave half a config behind
+    QHash<QString, QVariant> values;
+    for (QHash<QString, KeyDefinition>::const_iterator i = _schema.constBegin(); i != _schema.constEnd(); i++)
+    {
+        QVariant value;
+        if (fileValues.contains(i.key()))
+        {
+            if (!parse(i.key(), fileValues.value(i.key()), &value))
+            {
+                _error = "Invalid value specified for " + i.key() + " (" + fileValues.value(i.key()) + ")";
+                return false;
+            }
+        }
+        else if (!i.value().defaultValue.isValid())
+        {
+            _error = "No value specified for required key " + i.key();
+            return false;
+        }
+        else
+        {
+            value = i.value().defaultValue;
+        }
+        values.insert(i.key(), value);
+    }
+    for (QHash<QString, QString>::const_iterator i = fileValues.constBegin(); i != fileValues.constEnd(); i++)
+    {
+        if (!_schema.contains(i.key()))
+        {
+            values.insert(i.key(), i.value());
+        }
+    }
+
+    if (!_loaded)
+    {
+        _values = values;
+        _fileValues = fileValues;
+        _loaded = true;
+        return true;
+    }
+
+    // Only apply keys that changed in the file, so values set() at runtime survive unrelated edits
+    QSet<QString> keys = values.keys().toSet() + _fileValues.keys().toSet();
+    bool changed = false;
+    for (const QString& key : keys)
+    {
+        if ((fileValues.contains(key) == _fileValues.contains(key))
+                && (fileValues.value(key) == _fileValues.value(key)))
+        {
+            continue;
+        }
+        if (_schema.contains(key) && !_schema[key].live)
+        {
+            LOG_W(LOG_TAG, "Changing " + key + " requires a restart, ignoring the new value for now");
+            continue;
+        }
+        QVariant value = values.value(key);
+        if (value == _values.value(key)) continue;
+        if (value.isValid())
+        {
+            _values.insert(key, value);
+        }
+        else
+        {
+            _values.remove(key);
+        }
+        LOG_I(LOG_TAG, "Applying " + key + "=" + fileValues.value(key));
+        Q_EMIT valueChanged(key, value);
+        changed = true;
+    }
+    _fileValues = fileValues;
+    if (changed)
+    {
+        Q_EMIT reloaded();
+    }
+    return true;
+}
+
+bool LiveConfig::set(const QString& key, const QString& rawValue)
+{
+    QString lowerKey = key.toLower();
+    if (_schema.contains(lowerKey) && !_schema[lowerKey].live)
+    {
+        LOG_W(LOG_TAG, "Cannot change " + lowerKey + " while running");
+        return false;
+    }
+    QVariant value;
+    if (!parse(lowerKey, rawValue, &value))
+    {
+        LOG_W(LOG_TAG, "Invalid value for " + lowerKey + " (" + rawValue + ")");
+        return false;
+    }
+    if (value != _values.value(lowerKey))
+    {
+        LOG_I(LOG_TAG, "Setting " + lowerKey + "=" + rawValue);
+        _values.insert(lowerKey, value);
+        Q_EMIT valueChanged(lowerKey, value);
+    }
+    return true;
+}
+
+void LiveConfig::watch()
+{
+    // Editors that save by replacing the file drop it from the watcher, so it has to be added back
+    if (!_watcher->files().contains(_path) && QFile::exists(_path))
+    {
+        _watcher->addPath(_path);
+    }
+}
+
+void LiveConfig::fileChanged(const QString& path)
+{
+    Q_UNUSED(path);
+    KILL_TIMER(_reloadTimerId);
+    START_TIMER(_reloadTimerId, RELOAD_DELAY);
+}
+
+void LiveConfig::timerEvent(QTimerEvent *e)
+{
+    QObject::timerEvent(e);
+    if (e->timerId() == _reloadTimerId)
+    {
+        // Keep waiting if the file is in the middle of being replaced
+        if (!QFile::exists(_path)) return;
+        KILL_TIMER(_reloadTimerId);
+        watch();
+        if (!reload())
+        {
+            LOG_E(LOG_TAG, _error + ", keeping the previous configuration");
+            Q_EMIT reloadFailed(_error);
+        }
+    }
+}
+
+QVariant LiveConfig::value(const QString& key) const
+{
+    return _values.value(key.toLower());
+}
+
+QString LiveConfig::valueAsString(const QString& key) const
+{
+    return value(key).toString();
+}
+
+int LiveConfig::valueAsInt(const QString& key) const
+{
+    return value(key).toInt();
+}
+
+bool LiveConfig::valueAsBool(const QString& key) const
+{
+    return value(key).toBool();
+}
+
+double LiveConfig::valueAsDouble(const QString& key) const
+{
+    return value(key).toDouble();
+}
+
+QHostAddress LiveConfig::valueAsIP(const QString& key) const
+{
+    return QHostAddress(value(key).toString());
+}
+
+QStringList LiveConfig::valueAsStringList(const QString& key) const
+{
+    return value(key).toStringList();
+}
+
+QStringList LiveConfig::keys() const
+{
+    return _values.keys();
+}
+
+bool LiveConfig::contains(const QString& key) const
+{
+    return _values.contains(key.toLower());
+}
+
+QString LiveConfig::getPath() const
+{
+    return _path;
+}
+
+QString LiveConfig::getError() const
+{
+    return _error;
+}
+
+} // namespace Soro
@@ -0,0 +1,118 @@
+#ifndef SORO_LIVECONFIG_H
+#define SORO_LIVECONFIG_H
+
+#include <QtCore>
+#include <QHostAddress>
+#include <QFileSystemWatcher>
+
+#include "soro_core_global.h"
+#include "confloader.h"
+#include "constants.h"
+
+namespace Soro {
+
+/* A configuration file with a typed schema that is reloaded whenever it changes on disk.
+ *
+ * - Call define() for each known key, giving its type, default value, and whether the
+ *   change can be applied while running
+ * - Call load() to read the file in and start watching it
+ * - Connect to valueChanged() to apply changes as they happen, or to reloaded() to
+ *   apply them all at once
+ *
+ * Keys that were never defined are still loaded as strings, so a file can carry settings
+ * meant for somebody else (such as rover settings forwarded by mission control).
+ *
+ * A reload that fails validation is rejected as a whole and the previous values stay in
+ * effect. Changes to keys that are not live are logged and ignored until a restart.
+ */
+class SORO_CORE_EXPORT LiveConfig: public QObject {
+    Q_OBJECT
+public:
+    enum Type {
+        StringType, IntType, BoolType, DoubleType, IPType, StringListType
+    };
+
+    explicit LiveConfig(QObject *parent = nullptr);
+
+    /* Adds a key to the schema. A default value of QVariant() makes the key required.
+     * If live is false, the key is only read in by the first load.
+     */
+    void define(const QString& key, LiveConfig::Type type, const QVariant& defaultValue, bool live=true);
+
+    /* Limits an IntType or DoubleType key to a range of values
+     */
+    void setRange(const QString& key, double min, double max);
+
+    /* Reads in the configuration file and starts watching it for changes.
+     *
+     * Returns false if the file does not exist or a value is invalid, in which case
+     * getError() describes the problem.
+     */
+    bool load(const QString& path);
+
+    /* Sets a value at runtime without touching the file, as if it had been changed there.
+     * The value stays in effect until the key is changed in the file.
+     *
+     * Returns false if the value is invalid or the key is not live.
+     */
+    bool set(const QString& key, const QString& rawValue);
+
+    QVariant value(const QString& key) const;
+    QString valueAsString(const QString& key) const;
+    int valueAsInt(const QString& key) const;
+    bool valueAsBool(const QString& key) const;
+    double valueAsDouble(const QString& key) const;
+    QHostAddress valueAsIP(const QString& key) const;
+    QStringList valueAsStringList(const QString& key) const;
+
+    /* Gets every key that has a value, whether it was defined or not
+     */
+    QStringList keys() const;
+    bool contains(const QString& key) const;
+
+    QString getPath() const;
+    QString getError() const;
+
+Q_SIGNALS:
+    /* Emitted for each key whose value changes after the first load
+     */
+    void valueChanged(const QString& key, const QVariant& value);
+    /* Emitted once a reload of the file has applied all of its changes
+     */
+    void reloaded();
+    void reloadFailed(QString error);
+
+protected:
+    void timerEvent(QTimerEvent *e);
+
+private:
+    struct KeyDefinition {
+        Type type;
+        QVariant defaultValue;
+        bool live;
+        bool hasRange;
+        double min;
+        double max;
+    };
+
+    QString LOG_TAG;
+    QString _path;
+    QString _error;
+    QFileSystemWatcher *_watcher;
+    QHash<QString, KeyDefinition> _schema;
+    QHash<QString, QVariant> _values;
+    QHash<QString, QString> _fileValues;
+    int _reloadTimerId = TIMER_INACTIVE;
+    bool _loaded = false;
+
+    bool reload();
+    bool parse(const QString& key, const QString& rawValue, QVariant *value) const;
+    void watch();
+
+private Q_SLOTS:
+    void fileChanged(const QString& path);
+};
+
+} // namespace Soro
+
+#endif // SORO_LIVECONFIG_H
@@ -67,8 +67,9 @@ void Logger::publish(Level level, QString tag, QString message)
     // check for file output
     if (level <= _maxFileLevel)
     {
+        // Milliseconds, so lines from the rover and mission control can be put in order
         QString formatted = _textFormat[reinterpret_cast<int&>(level) - 1]
-                .arg(QTime::currentTime().toString(), tag, message);
+                .arg(QTime::currentTime().toString("hh:mm:ss.zzz"), tag, message);
         _fileMutex.lock();
         if (_fileStream != nullptr)
         {
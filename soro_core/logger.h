@@ -22,6 +22,9 @@ namespace Soro {
  * with the rootLogger() method.
  *
  * This class uses a mutex around the file stream, which *should* make it thread safe.
+ *
+ * Every message is written to the file as soon as it is published, so nothing is held in
+ * memory waiting for the disk, and nothing is ever dropped from the file.
  */
 class SORO_CORE_EXPORT Logger: public QObject {
     Q_OBJECT
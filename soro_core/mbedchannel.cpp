@@ -19,13 +19,20 @@
  *********************************************************/
 
 #include "mbedchannel.h"
-#include "util.h"
+#include "wirecodec.h"
 
 #define MSG_TYPE_NORMAL 1
 #define MSG_TYPE_LOG 2
 //#define MSG_TYPE_BROADCAST 3
 #define MSG_TYPE_HEARTBEAT 4
+#define MSG_TYPE_PING_REPLY 5
 #define IDLE_CONNECTION_TIMEOUT 2000
+//messages from the server have no type field, so a ping is a message starting with this
+//byte (which must not be used as a MbedMessageType) followed by a 4 byte timestamp
+#define PING_MARKER 0xFF
+#define PING_LENGTH 5
+//rate at which the server pings the mbed
+#define PING_INTERVAL 500
 #define MAX_PACKET_LEN 1024
 
 namespace Soro {
@@ -82,7 +89,7 @@ void MbedChannel::socketReadyRead()
         _mbed.host = peer.host;
         _mbed.port = peer.port;
 
-        unsigned int sequence = Util::deserialize<unsigned int>(_buffer + 2);
+        unsigned int sequence = Wire::load<uint32_t>(_buffer + 2);
         if (_state == ConnectingState)
         {
             LOG_I(LOG_TAG, "Connected to mbed client");
@@ -110,6 +117,13 @@ void MbedChannel::socketReadyRead()
             break;*/
         case MSG_TYPE_HEARTBEAT: // Heartbeat message
             break;
+        case MSG_TYPE_PING_REPLY: // Mbed echoed one of our pings back
+            if (length >= 6 + 4)
+            {
+                _lastRtt = (int)((unsigned int)Clock::root()->msecsSinceEpoch() - Wire::load<uint32_t>(_buffer + 6));
+                Q_EMIT rttChanged(_lastRtt);
+            }
+            break;
         default:
             LOG_E(LOG_TAG, "Got message with unknown type");
             break;
@@ -122,6 +136,7 @@ void MbedChannel::resetConnection()
     LOG_I(LOG_TAG, "Connection is resetting...");
     setChannelState(ConnectingState);
     _lastReceiveId = 0;
+    _lastRtt = -1;
     _active = false;
     _socket->abort();
     if (_socket->bind(_host.host, _host.port))
@@ -147,6 +162,7 @@ MbedChannel::MbedChannel(SocketAddress host, unsigned char mbedId, QObject *pare
     connect(_socket, static_cast<void (QUdpSocket::*)(QUdpSocket::SocketError)>(&QUdpSocket::error), this, &MbedChannel::socketError);
     resetConnection();
     START_TIMER(_watchdogTimerId, IDLE_CONNECTION_TIMEOUT);
+    START_TIMER(_pingTimerId, PING_INTERVAL);
 }
 
 MbedChannel::~MbedChannel()
@@ -162,12 +178,26 @@ void MbedChannel::sendMessage(const char *message, int length)
     {
         _buffer[0] = '\0';
         _buffer[1] = _mbedId;
-        Util::serialize<unsigned int>(_buffer + 2, _nextSendId++);
+        Wire::store<uint32_t>(_buffer + 2, _nextSendId++);
         memcpy(_buffer + 6, message, length);
         _socket->writeDatagram(_buffer, length + 6, _mbed.host, _mbed.port);
     }
 }
 
+void MbedChannel::sendPing()
+{
+    // The timestamp is echoed back, so nothing needs to be remembered about the ping
+    char ping[PING_LENGTH];
+    ping[0] = static_cast<char>(PING_MARKER);
+    Wire::store<uint32_t>(ping + 1, (unsigned int)Clock::root()->msecsSinceEpoch());
+    sendMessage(ping, PING_LENGTH);
+}
+
+int MbedChannel::getLastRtt() const
+{
+    return _lastRtt;
+}
+
 void MbedChannel::timerEvent(QTimerEvent *e)
 {
     QObject::timerEvent(e);
@@ -176,10 +206,18 @@ void MbedChannel::timerEvent(QTimerEvent *e)
         if ((_state == ConnectedState) & !_active)
         {
             LOG_E(LOG_TAG, "Mbed client has timed out");
+            _lastRtt = -1;
             setChannelState(ConnectingState);
         }
         _active = false;
     }
+    else if (e->timerId() == _pingTimerId)
+    {
+        if (_state == ConnectedState)
+        {
+            sendPing();
+        }
+    }
     else if (e->timerId() == _resetConnectionTimerId)
     {
         resetConnection();
@@ -412,7 +450,7 @@ void MbedChannel::sendMessage(char *message, int length, unsigned char type)
     }
     _buffer[0] = _mbedId;
     _buffer[1] = static_cast<char>(type);
-    Util::serialize<unsigned int>(_buffer + 2, _nextSendId++);
+    Wire::store<uint32_t>(_buffer + 2, _nextSendId++);
     memcpy(_buffer + 6, message, length);
     _socket->sendTo(_server, _buffer, length + 6);
     _lastSendTime = time(NULL);
@@ -438,7 +476,6 @@ int MbedChannel::read(char *outMessage, int maxLength)
         sendMessage(NULL, 0, MSG_TYPE_HEARTBEAT);
     }
     int len = _socket->receiveFrom(peer, _buffer, maxLength);
-    unsigned int sequence = Util::deserialize<unsigned int>(_buffer + 2);
     if ((len < 6)
             || (peer.get_port() != _serverPort)
             || (_buffer[0] != '\0')
@@ -446,6 +483,7 @@ int MbedChannel::read(char *outMessage, int maxLength)
     {
         return -1;
     }
+    unsigned int sequence = Wire::load<uint32_t>(_buffer + 2);
     if (_led1 == 1) _led1 = 0;
     else _led1 = 1;
     if ((sequence < _lastReceiveId) && (time(NULL) - _lastReceiveTime < 2))
@@ -454,6 +492,14 @@ int MbedChannel::read(char *outMessage, int maxLength)
     }
     _lastReceiveId = sequence;
     _lastReceiveTime = time(NULL);
+    if ((len == 6 + PING_LENGTH) && (static_cast<unsigned char>(_buffer[6]) == PING_MARKER))
+    {
+        // Echo the server's timestamp back, sendMessage() reuses _buffer so copy it out first
+        char timestamp[PING_LENGTH - 1];
+        memcpy(timestamp, _buffer + 7, PING_LENGTH - 1);
+        sendMessage(timestamp, PING_LENGTH - 1, MSG_TYPE_PING_REPLY);
+        return -1;
+    }
     memcpy(outMessage, _buffer + 6, len - 6);
     return len - 6;
 }
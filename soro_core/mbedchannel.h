@@ -60,7 +60,10 @@ private:
     unsigned int _nextSendId = 0;
     int _watchdogTimerId = TIMER_INACTIVE;
     int _resetConnectionTimerId = TIMER_INACTIVE;
+    int _pingTimerId = TIMER_INACTIVE;
+    int _lastRtt = -1;
     void setChannelState(MbedChannel::State state);
+    void sendPing();
 
 private Q_SLOTS:
     void socketError(QAbstractSocket::SocketError err);
@@ -78,6 +81,12 @@ public:
      */
     void sendMessage(const char *message, int length);
 
+    /* Gets the last measured round trip time to the mbed in milliseconds, or -1 if
+     * it is not connected. This includes the time the mbed takes to get around to
+     * reading the message, so it is the delay before a drive command is acted on.
+     */
+    int getLastRtt() const;
+
 Q_SIGNALS:
     /* Emitted when we get a message from the mbed
      */
@@ -85,6 +94,9 @@ Q_SIGNALS:
     /* Emitted when the mbed connects or times out
      */
     void stateChanged(MbedChannel::State state);
+    /* Emitted when a new round trip time to the mbed is measured
+     */
+    void rttChanged(int rtt);
 
 protected:
     void timerEvent(QTimerEvent *e);
@@ -17,11 +17,17 @@
 #include "mediastreamer.h"
 #include "logger.h"
 #include "constants.h"
+#include "clock.h"
+
+//time the parent has to accept the IPC connection before this process gives up on it
+#define PARENT_CONNECT_TIMEOUT 3000
 
 namespace Soro {
 
 MediaStreamer::MediaStreamer(QString LOG_TAG, QObject *parent) : QObject(parent) {
     this->LOG_TAG = LOG_TAG;
+    SchedulingPolicy::fromEnvironment(SCHEDULING_POLICY_ENV).applyToCurrentThread(LOG_TAG + " main thread");
+    _streamingThreadPolicy = SchedulingPolicy::fromEnvironment(STREAMING_SCHEDULING_POLICY_ENV);
 }
 
 MediaStreamer::~MediaStreamer() {
@@ -35,50 +41,66 @@ void MediaStreamer::stop() {
         _pipeline->setState(QGst::StateNull);
         _pipeline.clear();
     }
-    if (_ipcSocket) {
-        LOG_I(LOG_TAG, "stop(): deleting IPC socket");
-        disconnect(_ipcSocket, 0, this, 0);
-        delete _ipcSocket;
-        _ipcSocket = nullptr;
+    if (_ipcChannel) {
+        LOG_I(LOG_TAG, "stop(): closing IPC channel");
+        disconnect(_ipcChannel, 0, this, 0);
+        _ipcChannel->close();
+        // This may be called from one of the channel's own signals
+        _ipcChannel->deleteLater();
+        _ipcChannel = nullptr;
     }
 }
 
-bool MediaStreamer::connectToParent(quint16 port) {
-    LOG_I(LOG_TAG, "connectToParent(): Creating new TCP socket on port " + QString::number(port));
-    _ipcSocket = new QTcpSocket(this);
-
-    connect(_ipcSocket, &QTcpSocket::readyRead, this, &MediaStreamer::ipcSocketReadyRead);
-    connect(_ipcSocket, &QTcpSocket::disconnected, this, &MediaStreamer::ipcSocketDisconnected);
-    connect(_ipcSocket, static_cast<void (QTcpSocket::*)(QTcpSocket::SocketError)>(&QTcpSocket::error), this, &MediaStreamer::ipcSocketError);
-
-    _ipcSocket->connectToHost(QHostAddress::LocalHost, port);
-    if (!_ipcSocket->waitForConnected(1000)) {
-        LOG_E(LOG_TAG, "connectToParent(): Unable to connect to parent");
-        QCoreApplication::exit(0);
+bool MediaStreamer::connectToParent(QString address) {
+    LOG_I(LOG_TAG, "connectToParent(): Connecting to parent on " + address);
+    _ipcChannel = Channel::createClient(this, address, CHANNEL_NAME_MEDIA_IPC);
+    if (_ipcChannel->getState() == Channel::ErrorState) {
+        LOG_E(LOG_TAG, "connectToParent(): Unable to create IPC channel");
+        QCoreApplication::exit(STREAMPROCESS_ERR_SOCKET_ERROR);
         return false;
     }
+    connect(_ipcChannel, &Channel::messageReceived, this, &MediaStreamer::ipcMessageReceived);
+    connect(_ipcChannel, &Channel::stateChanged, this, &MediaStreamer::ipcChannelStateChanged);
+    _ipcChannel->open();
+
+    // The parent listens before it starts this process, so if it hasn't answered by now it is gone
+    Clock::root()->singleShot(PARENT_CONNECT_TIMEOUT, this, [this]() {
+        if (_ipcChannel && !_parentConnected) {
+            LOG_E(LOG_TAG, "connectToParent(): Unable to connect to parent");
+            stop();
+            QCoreApplication::exit(STREAMPROCESS_ERR_SOCKET_ERROR);
+        }
+    });
     return true;
 }
 
-void MediaStreamer::ipcSocketReadyRead() {
-    char buffer[512];
-    while (_ipcSocket->bytesAvailable() > 0) {
-        _ipcSocket->readLine(buffer, 512);
-        if (QString(buffer).compare("stop") == 0) {
-            LOG_I(LOG_TAG, "ipcSocketReadyRead(): Got stop request from parent");
-            stop();
-            QCoreApplication::exit(0);
-        }
-        else {
-            LOG_W(LOG_TAG, "ipcSocketReadyRead(): Got unknown request from parent '" + QString(buffer) + "'");
-        }
+void MediaStreamer::ipcMessageReceived(const char *message, Channel::MessageSize size) {
+    QByteArray request(message, size);
+    if (request == "stop") {
+        LOG_I(LOG_TAG, "ipcMessageReceived(): Got stop request from parent");
+        stop();
+        QCoreApplication::exit(0);
     }
+    else {
+        LOG_W(LOG_TAG, "ipcMessageReceived(): Got unknown request from parent '" + QString::fromLatin1(request) + "'");
+    }
+}
+
+void MediaStreamer::sendToParent(QString message) {
+    if (!_ipcChannel || (_ipcChannel->getState() != Channel::ConnectedState)) return;
+    _ipcChannel->sendMessage(message.toLatin1());
 }
 
 QGst::PipelinePtr MediaStreamer::createPipeline() {
     QGst::PipelinePtr pipeline = QGst::Pipeline::create();
     pipeline->bus()->addSignalWatch();
     QGlib::connect(pipeline->bus(), "message", this, &MediaStreamer::onBusMessage);
+    if (!_streamingThreadPolicy.isEmpty()) {
+        // Sync messages are delivered on the thread that posted them, which for a stream status
+        // message is the streaming thread itself
+        pipeline->bus()->enableSyncMessageEmission();
+        QGlib::connect(pipeline->bus(), "sync-message", this, &MediaStreamer::onBusSyncMessage);
+    }
 
     LOG_I(LOG_TAG, "createPipeline(): pipeline created successfully");
     return pipeline;
@@ -102,17 +124,25 @@ void MediaStreamer::onBusMessage(const QGst::MessagePtr & message) {
     }
 }
 
-void MediaStreamer::ipcSocketError(QAbstractSocket::SocketError error) {
-    Q_UNUSED(error);
-    LOG_E(LOG_TAG, "ipcSocketError(): Socket error");
-    stop();
-    QCoreApplication::exit(STREAMPROCESS_ERR_SOCKET_ERROR);
+void MediaStreamer::onBusSyncMessage(const QGst::MessagePtr & message) {
+    if (message->type() != QGst::MessageStreamStatus) return;
+    QGst::StreamStatusMessagePtr status = message.staticCast<QGst::StreamStatusMessage>();
+    if (status->statusType() == QGst::StreamStatusTypeEnter) {
+        QGst::ElementPtr owner = status->owner();
+        _streamingThreadPolicy.applyToCurrentThread("streaming thread of " + (owner.isNull() ? QString("?") : owner->name()));
+    }
 }
 
-void MediaStreamer::ipcSocketDisconnected() {
-    LOG_E(LOG_TAG, "ipcSocketDisconnected(): Socket disconnected");
-    stop();
-    QCoreApplication::exit(STREAMPROCESS_ERR_SOCKET_ERROR);
+void MediaStreamer::ipcChannelStateChanged(Channel::State state) {
+    if (state == Channel::ConnectedState) {
+        LOG_I(LOG_TAG, "ipcChannelStateChanged(): Connected to parent");
+        _parentConnected = true;
+    }
+    else if (_parentConnected) {
+        LOG_E(LOG_TAG, "ipcChannelStateChanged(): Lost connection to parent");
+        stop();
+        QCoreApplication::exit(STREAMPROCESS_ERR_SOCKET_ERROR);
+    }
 }
 
 } // namespace Soro
@@ -3,7 +3,6 @@
 
 #include <QObject>
 #include <QCoreApplication>
-#include <QTcpSocket>
 
 #include <Qt5GStreamer/QGst/Pipeline>
 #include <Qt5GStreamer/QGst/Element>
@@ -17,12 +16,18 @@
 
 #include "socketaddress.h"
 #include "soro_core_global.h"
+#include "schedulingpolicy.h"
+#include "channel.h"
 
 namespace Soro {
 
 /**
  * Uses a gstreamer backend to stream media to a remote address. This class does not run in the main process,
  * instead it runs in a child process is controlled by a corresponding MediaServer in the main process.
+ *
+ * The parent can set scheduling policies for the streamer's main thread and for each of its GStreamer
+ * streaming threads through the SCHEDULING_POLICY_ENV and STREAMING_SCHEDULING_POLICY_ENV environment
+ * variables. Streaming threads are caught as they start from their stream status messages.
  */
 class SORO_CORE_EXPORT MediaStreamer : public QObject {
     Q_OBJECT
@@ -34,21 +39,29 @@ protected:
 
     QGst::PipelinePtr _pipeline;
     QGst::PipelinePtr createPipeline();
-    QTcpSocket *_ipcSocket = nullptr;
+    Channel *_ipcChannel = nullptr;
     QString LOG_TAG;
+    SchedulingPolicy _streamingThreadPolicy;
+    bool _parentConnected = false;
 
     /**
-     * Should be called by the subclass when it is ready to connect to the parent MediaServer
-     * @param port The IPC port to connect on
+     * Should be called by the subclass when it is ready to connect to the parent MediaServer. The process
+     * exits if the parent can't be reached, or once it goes away.
+     * @param address The local transport address the parent is listening on for IPC
      */
-    bool connectToParent(quint16 port);
+    bool connectToParent(QString address);
     void stop();
 
+    /**
+     * Sends a message to the parent MediaServer, which passes it to MediaServer::onChildMessage()
+     */
+    void sendToParent(QString message);
+
 private Q_SLOTS:
     void onBusMessage(const QGst::MessagePtr & message);
-    void ipcSocketReadyRead();
-    void ipcSocketError(QAbstractSocket::SocketError error);
-    void ipcSocketDisconnected();
+    void onBusSyncMessage(const QGst::MessagePtr & message);
+    void ipcMessageReceived(const char *message, Channel::MessageSize size);
+    void ipcChannelStateChanged(Channel::State state);
 
 Q_SIGNALS:
     /**
@@ -0,0 +1,280 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "memorybudget.h"
+#include "logger.h"
+
+//prefix of configuration keys that set a budget's cap
+#define CONFIG_KEY_PREFIX "budget_"
+//once a cap is reported, usage has to fall under this fraction (in percent) of it to be reported again
+#define CAP_REPORT_RESET_PERCENT 75
+
+namespace Soro {
+
+MemoryBudget::MemoryBudget(const QString& name, qint64 cap, Policy policy)
+    : _name(name), _policy(policy), _cap(qMax(cap, qint64(0))), _usage(0), _peakUsage(0),
+      _overflowCount(0), _droppedBytes(0), _capReported(false)
+{
+    MemoryBudgetRegistry::root()->registerBudget(this);
+}
+
+MemoryBudget::~MemoryBudget()
+{
+    MemoryBudgetRegistry::root()->unregisterBudget(this);
+}
+
+QString MemoryBudget::getName() const
+{
+    return _name;
+}
+
+QString MemoryBudget::getGroup() const
+{
+    return _name.section(':', 0, 0);
+}
+
+MemoryBudget::Policy MemoryBudget::getPolicy() const
+{
+    return _policy;
+}
+
+qint64 MemoryBudget::getCap() const
+{
+    return _cap.load(std::memory_order_relaxed);
+}
+
+qint64 MemoryBudget::getUsage() const
+{
+    return _usage.load(std::memory_order_relaxed);
+}
+
+qint64 MemoryBudget::getPeakUsage() const
+{
+    return _peakUsage.load(std::memory_order_relaxed);
+}
+
+quint64 MemoryBudget::getOverflowCount() const
+{
+    return _overflowCount.load(std::memory_order_relaxed);
+}
+
+quint64 MemoryBudget::getDroppedBytes() const
+{
+    return _droppedBytes.load(std::memory_order_relaxed);
+}
+
+void MemoryBudget::setCap(qint64 cap)
+{
+    _cap.store(qMax(cap, qint64(0)), std::memory_order_relaxed);
+    _capReported.store(false, std::memory_order_relaxed);
+}
+
+bool MemoryBudget::fits(qint64 bytes) const
+{
+    return excess(bytes) == 0;
+}
+
+qint64 MemoryBudget::excess(qint64 bytes) const
+{
+    qint64 cap = _cap.load(std::memory_order_relaxed);
+    if (cap == 0) return 0;
+    return qMax(_usage.load(std::memory_order_relaxed) + bytes - cap, qint64(0));
+}
+
+void MemoryBudget::add(qint64 bytes)
+{
+    usageChanged(_usage.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+}
+
+void MemoryBudget::remove(qint64 bytes)
+{
+    usageChanged(_usage.fetch_sub(bytes, std::memory_order_relaxed) - bytes);
+}
+
+void MemoryBudget::setUsage(qint64 bytes)
+{
+    _usage.store(bytes, std::memory_order_relaxed);
+    usageChanged(bytes);
+}
+
+void MemoryBudget::usageChanged(qint64 usage)
+{
+    qint64 peak = _peakUsage.load(std::memory_order_relaxed);
+    while ((usage > peak) && !_peakUsage.compare_exchange_weak(peak, usage, std::memory_order_relaxed));
+
+    if (_capReported.load(std::memory_order_relaxed)
+            && (usage < _cap.load(std::memory_order_relaxed) * CAP_REPORT_RESET_PERCENT / 100))
+    {
+        _capReported.store(false, std::memory_order_relaxed);
+    }
+}
+
+void MemoryBudget::overflowed(qint64 droppedBytes)
+{
+    _overflowCount.fetch_add(1, std::memory_order_relaxed);
+    _droppedBytes.fetch_add(qMax(droppedBytes, qint64(0)), std::memory_order_relaxed);
+    if (!_capReported.exchange(true, std::memory_order_relaxed))
+    {
+        MemoryBudgetRegistry::root()->reportCapReached(this);
+    }
+}
+
+////////////////////////////////////////
+
+MemoryBudgetRegistry* MemoryBudgetRegistry::_root = new MemoryBudgetRegistry();
+
+MemoryBudgetRegistry::MemoryBudgetRegistry() : QObject()
+{
+    LOG_TAG = "MemoryBudget";
+}
+
+void MemoryBudgetRegistry::registerBudget(MemoryBudget *budget)
+{
+    QMutexLocker locker(&_mutex);
+    _budgets.append(budget);
+    QString name = budget->getName().toLower();
+    QString group = budget->getGroup().toLower();
+    if (_caps.contains(name))
+    {
+        budget->setCap(_caps.value(name));
+    }
+    else if (_caps.contains(group))
+    {
+        budget->setCap(_caps.value(group));
+    }
+}
+
+void MemoryBudgetRegistry::unregisterBudget(MemoryBudget *budget)
+{
+    QMutexLocker locker(&_mutex);
+    _budgets.removeOne(budget);
+}
+
+void MemoryBudgetRegistry::setCap(const QString& name, qint64 cap)
+{
+    QMutexLocker locker(&_mutex);
+    // Configuration keys are always lower case, so names are matched regardless of case
+    QString lowerName = name.toLower();
+    _caps.insert(lowerName, cap);
+    for (MemoryBudget *budget : _budgets)
+    {
+        QString budgetName = budget->getName().toLower();
+        if ((budgetName == lowerName)
+                || ((budget->getGroup().toLower() == lowerName) && !_caps.contains(budgetName)))
+        {
+            budget->setCap(cap);
+        }
+    }
+}
+
+bool MemoryBudgetRegistry::applyConfigValue(const QString& key, const QVariant& value)
+{
+    if (!key.startsWith(CONFIG_KEY_PREFIX)) return false;
+    // A cap that was removed from the file just stays as it is
+    if (!value.isValid()) return true;
+    bool ok;
+    qint64 cap = value.toLongLong(&ok);
+    if (!ok || (cap < 0))
+    {
+        LOG_W(LOG_TAG, "Invalid cap for " + key + " (" + value.toString() + ")");
+        return true;
+    }
+    QString name = key.mid(QString(CONFIG_KEY_PREFIX).length());
+    LOG_I(LOG_TAG, "Setting cap of " + name + " to " + QString::number(cap) + "kB");
+    setCap(name, cap * 1024);
+    return true;
+}
+
+QList<MemoryBudgetRegistry::Usage> MemoryBudgetRegistry::getUsage() const
+{
+    QMutexLocker locker(&_mutex);
+    QList<Usage> usage;
+    for (const MemoryBudget *budget : _budgets)
+    {
+        Usage entry;
+        entry.name = budget->getName();
+        entry.policy = budget->getPolicy();
+        entry.cap = budget->getCap();
+        entry.usage = budget->getUsage();
+        entry.peakUsage = budget->getPeakUsage();
+        entry.overflowCount = budget->getOverflowCount();
+        entry.droppedBytes = budget->getDroppedBytes();
+        usage.append(entry);
+    }
+    return usage;
+}
+
+qint64 MemoryBudgetRegistry::getTotalUsage() const
+{
+    QMutexLocker locker(&_mutex);
+    qint64 total = 0;
+    for (const MemoryBudget *budget : _budgets)
+    {
+        total += budget->getUsage();
+    }
+    return total;
+}
+
+QString MemoryBudgetRegistry::getReport() const
+{
+    QStringList entries;
+    for (const Usage& entry : getUsage())
+    {
+        QString text = entry.name + " " + QString::number(entry.usage / 1024) + "kB";
+        if (entry.cap > 0)
+        {
+            text += "/" + QString::number(entry.cap / 1024) + "kB " + policyName(entry.policy);
+        }
+        text += " peak=" + QString::number(entry.peakUsage / 1024) + "kB";
+        if (entry.overflowCount > 0)
+        {
+            text += " overflows=" + QString::number(entry.overflowCount)
+                    + " dropped=" + QString::number(entry.droppedBytes / 1024) + "kB";
+        }
+        entries.append(text);
+    }
+    return entries.join(", ");
+}
+
+QString MemoryBudgetRegistry::policyName(MemoryBudget::Policy policy)
+{
+    switch (policy)
+    {
+    case MemoryBudget::DropOldest:
+        return "drop_oldest";
+    case MemoryBudget::DropNewest:
+        return "drop_newest";
+    case MemoryBudget::Block:
+        return "block";
+    }
+    return "";
+}
+
+void MemoryBudgetRegistry::reportCapReached(const MemoryBudget *budget)
+{
+    if (QCoreApplication::instance() == nullptr) return;
+    // Always queued, the budget's owner may be reporting with its own lock held
+    QMetaObject::invokeMethod(this, "onCapReached", Qt::QueuedConnection,
+                              Q_ARG(QString, budget->getName()), Q_ARG(qint64, budget->getCap()));
+}
+
+void MemoryBudgetRegistry::onCapReached(QString name, qint64 cap)
+{
+    LOG_W(LOG_TAG, "Budget " + name + " reached its cap of " + QString::number(cap / 1024) + "kB, dropping data");
+    Q_EMIT capReached(name, cap);
+}
+
+} // namespace Soro
@@ -0,0 +1,157 @@
+#ifndef SORO_MEMORYBUDGET_H
+#define SORO_MEMORYBUDGET_H
+
+#include <QtCore>
+#include <atomic>
+
+#include "soro_core_global.h"
+
+namespace Soro {
+
+/* A cap on the number of bytes a buffering subsystem (a queue, a history, a file) may hold,
+ * so a bad link or a stuck consumer can't grow it until the process is killed.
+ *
+ * The subsystem reports its usage as it changes, checks fits() before taking on more data,
+ * and calls overflowed() whenever it has to drop or refuse data to stay under the cap. The
+ * policy says which data goes when the cap is reached:
+ *
+ * DropOldest - the oldest buffered data is discarded to make room
+ * DropNewest - the new data is silently discarded
+ * Block - the new data is refused and the producer is told, so it can back off
+ *
+ * Budgets are named "group" or "group:instance" (e.g. "channel_send:main"), and register
+ * themselves with MemoryBudgetRegistry for the lifetime of the object. A cap of 0 means
+ * the budget is unlimited and only tracks usage.
+ *
+ * All functions are thread safe.
+ */
+class SORO_CORE_EXPORT MemoryBudget {
+public:
+    enum Policy {
+        DropOldest,
+        DropNewest,
+        Block
+    };
+
+    MemoryBudget(const QString& name, qint64 cap, Policy policy);
+    ~MemoryBudget();
+
+    QString getName() const;
+    QString getGroup() const;
+    Policy getPolicy() const;
+    qint64 getCap() const;
+    qint64 getUsage() const;
+    qint64 getPeakUsage() const;
+    quint64 getOverflowCount() const;
+    quint64 getDroppedBytes() const;
+
+    void setCap(qint64 cap);
+
+    /* Checks if this many more bytes can be held without going over the cap
+     */
+    bool fits(qint64 bytes) const;
+
+    /* Gets how many bytes over the cap the budget would be with this many more bytes held,
+     * or 0 if it would still be under it
+     */
+    qint64 excess(qint64 bytes=0) const;
+
+    void add(qint64 bytes);
+    void remove(qint64 bytes);
+    void setUsage(qint64 bytes);
+
+    /* Records that data was dropped or refused because of the cap. The registry is told
+     * the first time this happens after usage last fell well under the cap.
+     */
+    void overflowed(qint64 droppedBytes);
+
+private:
+    Q_DISABLE_COPY(MemoryBudget)
+
+    QString _name;
+    Policy _policy;
+    std::atomic<qint64> _cap;
+    std::atomic<qint64> _usage;
+    std::atomic<qint64> _peakUsage;
+    std::atomic<quint64> _overflowCount;
+    std::atomic<quint64> _droppedBytes;
+    std::atomic<bool> _capReported;
+
+    void usageChanged(qint64 usage);
+};
+
+/* Keeps track of every memory budget in the process, so their usage can be reported together
+ * and their caps set from configuration.
+ *
+ * Reaching a cap is logged and signaled from the registry's thread, never from the thread that
+ * hit it, as that may be the logger itself.
+ */
+class SORO_CORE_EXPORT MemoryBudgetRegistry: public QObject {
+    Q_OBJECT
+public:
+    struct Usage {
+        QString name;
+        MemoryBudget::Policy policy;
+        qint64 cap;
+        qint64 usage;
+        qint64 peakUsage;
+        quint64 overflowCount;
+        quint64 droppedBytes;
+    };
+
+    /* Gets the process-wide registry
+     */
+    static inline MemoryBudgetRegistry* root() {
+        return _root;
+    }
+
+    /* Gets a snapshot of every registered budget
+     */
+    QList<Usage> getUsage() const;
+
+    /* Gets the total bytes held by every registered budget
+     */
+    qint64 getTotalUsage() const;
+
+    /* Sets the cap of a budget, or of every budget in a group if a group name is given. The cap
+     * also applies to budgets registered later with that name or group. Names are not case sensitive.
+     */
+    void setCap(const QString& name, qint64 cap);
+
+    /* Applies a configuration value if its key is "budget_" followed by a budget or group
+     * name, giving the cap in kilobytes. Returns false for any other key.
+     */
+    bool applyConfigValue(const QString& key, const QVariant& value);
+
+    /* Gets a one line summary of the usage of every budget
+     */
+    QString getReport() const;
+
+    static QString policyName(MemoryBudget::Policy policy);
+
+Q_SIGNALS:
+    void capReached(QString name, qint64 cap);
+
+private:
+    friend class MemoryBudget;
+
+    MemoryBudgetRegistry();
+
+    QString LOG_TAG;
+    mutable QMutex _mutex;
+    QList<MemoryBudget*> _budgets;
+    QHash<QString, qint64> _caps;
+
+    static MemoryBudgetRegistry *_root;
+
+    void registerBudget(MemoryBudget *budget);
+    void unregisterBudget(MemoryBudget *budget);
+    void reportCapReached(const MemoryBudget *budget);
+
+private Q_SLOTS:
+    void onCapReached(QString name, qint64 cap);
+};
+
+} // namespace Soro
+
+#endif // SORO_MEMORYBUDGET_H
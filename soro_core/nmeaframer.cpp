@@ -0,0 +1,120 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "nmeaframer.h"
+
+//NMEA allows 82 characters, some receivers go a little past that with extra precision
+#define MAX_SENTENCE_LENGTH 160
+
+namespace Soro {
+
+NmeaFramer::NmeaFramer() { }
+
+void NmeaFramer::append(const char *data, int length)
+{
+    _buffer.append(data, length);
+}
+
+bool NmeaFramer::next(QByteArray *sentence)
+{
+    while (true)
+    {
+        int start = _buffer.indexOf('$');
+        if (start < 0)
+        {
+            // Nothing here can become a sentence
+            _buffer.clear();
+            return false;
+        }
+        if (start > 0)
+        {
+            _buffer.remove(0, start);
+        }
+
+        int end = _buffer.indexOf('\n');
+        // A sentence cut off by another one starting means bytes were lost
+        int restart = _buffer.indexOf('$', 1);
+        if ((restart > 0) && ((end < 0) || (restart < end)))
+        {
+            _dropped++;
+            _buffer.remove(0, restart);
+            continue;
+        }
+        if (end < 0)
+        {
+            if (_buffer.size() > MAX_SENTENCE_LENGTH)
+            {
+                _dropped++;
+                _buffer.remove(0, 1);
+                continue;
+            }
+            return false;
+        }
+
+        QByteArray line = _buffer.left(end);
+        _buffer.remove(0, end + 1);
+        if (line.endsWith('\r'))
+        {
+            line.chop(1);
+        }
+        if ((line.size() > MAX_SENTENCE_LENGTH) || !hasValidChecksum(line))
+        {
+            _dropped++;
+            continue;
+        }
+        *sentence = line;
+        return true;
+    }
+}
+
+void NmeaFramer::clear()
+{
+    _buffer.clear();
+}
+
+quint64 NmeaFramer::getDroppedCount() const
+{
+    return _dropped;
+}
+
+QByteArray NmeaFramer::checksummed(const QByteArray& body)
+{
+    // XOR of every character between the $ and the *
+    unsigned char checksum = 0;
+    for (int i = 1; i < body.size(); i++)
+    {
+        checksum ^= static_cast<unsigned char>(body[i]);
+    }
+    return body + "*" + QByteArray::number(checksum, 16).toUpper().rightJustified(2, '0') + "\r\n";
+}
+
+bool NmeaFramer::hasValidChecksum(const QByteArray& sentence)
+{
+    int star = sentence.lastIndexOf('*');
+    if (star < 0) return true;
+    if (star + 3 != sentence.size()) return false;
+
+    unsigned char checksum = 0;
+    for (int i = 1; i < star; i++)
+    {
+        checksum ^= static_cast<unsigned char>(sentence[i]);
+    }
+    bool ok;
+    int expected = sentence.mid(star + 1, 2).toInt(&ok, 16);
+    return ok && (expected == checksum);
+}
+
+} // namespace Soro
@@ -0,0 +1,48 @@
+#ifndef SORO_NMEAFRAMER_H
+#define SORO_NMEAFRAMER_H
+
+#include <QtCore>
+
+#include "soro_core_global.h"
+
+namespace Soro {
+
+/* Splits a stream of bytes from a GPS receiver into NMEA sentences.
+ *
+ * Bytes can be appended in pieces of any size, as they come off a serial port or socket, and a
+ * sentence is only returned once all of it has arrived. Anything that isn't a sentence, such as
+ * binary replies from the receiver or gpsd's JSON reports, is skipped. Sentences that fail their
+ * checksum or run far past the NMEA length limit are dropped and counted.
+ */
+class SORO_CORE_EXPORT NmeaFramer {
+public:
+    NmeaFramer();
+
+    void append(const char *data, int length);
+
+    /* Takes the next complete sentence, without its line ending, or returns false if there isn't one yet
+     */
+    bool next(QByteArray *sentence);
+
+    void clear();
+
+    /* Gets the number of sentences dropped for a bad checksum or length
+     */
+    quint64 getDroppedCount() const;
+
+    /* Adds the checksum and line ending to a sentence body, e.g. "$PMTK220,100" becomes "$PMTK220,100*2F\r\n"
+     */
+    static QByteArray checksummed(const QByteArray& body);
+
+    /* Checks a sentence's checksum. Sentences without one pass, as the checksum is optional.
+     */
+    static bool hasValidChecksum(const QByteArray& sentence);
+
+private:
+    QByteArray _buffer;
+    quint64 _dropped = 0;
+};
+
+} // namespace Soro
+
+#endif // SORO_NMEAFRAMER_H
@@ -16,17 +16,23 @@
 
 #include "nmeamessage.h"
 
+#include <QRegularExpression>
+
 namespace Soro {
 
 NmeaMessage::NmeaMessage() { }
 
 NmeaMessage::NmeaMessage(QString nmea)
 {
-    int ggaPos = nmea.indexOf("$GPGGA,");
-    int vtgPos = nmea.indexOf("$GPVTG,");
-    if (ggaPos >= 0)
+    // Any talker, as multi-constellation receivers send $GNGGA rather than $GPGGA
+    static const QRegularExpression ggaPattern("\\$G[A-Z]GGA,");
+    static const QRegularExpression vtgPattern("\\$G[A-Z]VTG,");
+    int ggaPos = nmea.indexOf(ggaPattern);
+    int vtgPos = nmea.indexOf(vtgPattern);
+    QStringList ggaList = ggaPos >= 0 ? nmea.mid(ggaPos).split(",") : QStringList();
+    QStringList vtgList = vtgPos >= 0 ? nmea.mid(vtgPos).split(",") : QStringList();
+    if (ggaList.size() >= 11)
     {
-        QStringList ggaList = nmea.mid(ggaPos).split(",");
         QString time = ggaList[1];
         QString latitude = ggaList[2];
         QString latDirection = ggaList[3];
@@ -58,9 +64,8 @@ NmeaMessage::NmeaMessage(QString nmea)
         Satellites = 0;
         Altitude = -1;
     }
-    if (vtgPos >= 0)
+    if (vtgList.size() >= 8)
     {
-        QStringList vtgList = nmea.mid(vtgPos).split(",");
         QString trackTrueNorth = vtgList[1];
         QString trackMagNorth = vtgList[3];
         QString groundSpeedKnots = vtgList[5];
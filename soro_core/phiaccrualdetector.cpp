@@ -0,0 +1,122 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "phiaccrualdetector.h"
+
+#include <cmath>
+
+//phi is capped here, beyond this the result is just floating point noise
+#define MAX_PHI 100.0
+
+namespace Soro {
+
+PhiAccrualDetector::PhiAccrualDetector(int windowSize, double minStdDeviation, qint64 firstInterval)
+{
+    _windowSize = qMax(windowSize, 2);
+    _minStdDeviation = minStdDeviation;
+    _firstInterval = firstInterval;
+    _intervals.reserve(_windowSize);
+    reset(0);
+}
+
+void PhiAccrualDetector::reset(qint64 now)
+{
+    _intervals.clear();
+    _nextIndex = 0;
+    _intervalSum = 0;
+    _intervalSquaredSum = 0;
+    _lastArrival = now;
+    // Seed with a guess around the first interval so phi is usable right away,
+    // the guess is pushed out of the window as real samples arrive
+    addInterval(_firstInterval - _firstInterval / 4);
+    addInterval(_firstInterval + _firstInterval / 4);
+}
+
+void PhiAccrualDetector::reset(qint64 now, qint64 firstInterval)
+{
+    _firstInterval = firstInterval;
+    reset(now);
+}
+
+void PhiAccrualDetector::addInterval(qint64 interval)
+{
+    if (_intervals.size() < _windowSize)
+    {
+        _intervals.append(interval);
+    }
+    else
+    {
+        qint64 old = _intervals[_nextIndex];
+        _intervalSum -= old;
+        _intervalSquaredSum -= (double)old * old;
+        _intervals[_nextIndex] = interval;
+        _nextIndex = (_nextIndex + 1) % _windowSize;
+    }
+    _intervalSum += interval;
+    _intervalSquaredSum += (double)interval * interval;
+}
+
+void PhiAccrualDetector::heartbeat(qint64 now)
+{
+    if (now > _lastArrival)
+    {
+        addInterval(now - _lastArrival);
+    }
+    _lastArrival = qMax(now, _lastArrival);
+}
+
+double PhiAccrualDetector::getMeanInterval() const
+{
+    return _intervalSum / _intervals.size();
+}
+
+double PhiAccrualDetector::getStdDeviation() const
+{
+    double mean = getMeanInterval();
+    double variance = _intervalSquaredSum / _intervals.size() - mean * mean;
+    return qMax(_minStdDeviation, variance > 0 ? std::sqrt(variance) : 0.0);
+}
+
+int PhiAccrualDetector::getSampleCount() const
+{
+    return _intervals.size();
+}
+
+qint64 PhiAccrualDetector::getLastArrival() const
+{
+    return _lastArrival;
+}
+
+double PhiAccrualDetector::phi(qint64 now) const
+{
+    double elapsed = now - _lastArrival;
+    double y = (elapsed - getMeanInterval()) / getStdDeviation();
+    // Logistic approximation of the normal CDF, accurate to ~1e-4 and
+    // avoids erf() on the tail where 1 - CDF would round to 0
+    double e = std::exp(-y * (1.5976 + 0.070566 * y * y));
+    double phi;
+    if (y > 0)
+    {
+        phi = -std::log10(e / (1.0 + e));
+    }
+    else
+    {
+        phi = -std::log10(1.0 - 1.0 / (1.0 + e));
+    }
+    return qBound(0.0, phi, MAX_PHI);
+}
+
+} // namespace Soro
@@ -0,0 +1,72 @@
+#ifndef SORO_PHIACCRUALDETECTOR_H
+#define SORO_PHIACCRUALDETECTOR_H
+
+#include <QtCore>
+
+#include "soro_core_global.h"
+
+namespace Soro {
+
+/* Phi accrual failure detector (Hayashibara et al.)
+ *
+ * Instead of a fixed timeout, this keeps a sliding window of the times between received
+ * messages and models them as a normal distribution. phi() then gives the suspicion level
+ * that the peer has failed, given how long it has been since the last message:
+ *
+ *      phi = -log10(P(next message arrives later than now))
+ *
+ * so phi = 1 means a 10% chance the silence is still normal, phi = 2 means 1%, and so on.
+ * A jittery link spreads the distribution out and the same silence gets a lower phi, so a
+ * single threshold adapts to both clean and noisy links.
+ */
+class SORO_CORE_EXPORT PhiAccrualDetector {
+public:
+    /* windowSize is the number of inter-arrival times to keep. minStdDeviation (ms) keeps
+     * a very regular link from making phi jump on the first slightly late message.
+     * firstInterval (ms) seeds the window after a reset, before any messages have arrived
+     */
+    PhiAccrualDetector(int windowSize=100, double minStdDeviation=50, qint64 firstInterval=500);
+
+    /* Clears the history, as if a message had just been received at time now
+     */
+    void reset(qint64 now);
+
+    /* Clears the history as above, and expects messages every firstInterval ms from now on,
+     * for when the sender announces a new message rate
+     */
+    void reset(qint64 now, qint64 firstInterval);
+
+    /* Records that a message was received at time now
+     */
+    void heartbeat(qint64 now);
+
+    /* Gets the suspicion level at time now
+     */
+    double phi(qint64 now) const;
+
+    /* Gets the time of the last recorded message
+     */
+    qint64 getLastArrival() const;
+
+    double getMeanInterval() const;
+
+    double getStdDeviation() const;
+
+    int getSampleCount() const;
+
+private:
+    QVector<qint64> _intervals;
+    int _windowSize;
+    int _nextIndex = 0;
+    double _intervalSum = 0;
+    double _intervalSquaredSum = 0;
+    double _minStdDeviation;
+    qint64 _firstInterval;
+    qint64 _lastArrival = 0;
+
+    void addInterval(qint64 interval);
+};
+
+} // namespace Soro
+
+#endif // SORO_PHIACCRUALDETECTOR_H
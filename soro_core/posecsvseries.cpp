@@ -0,0 +1,57 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "posecsvseries.h"
+
+namespace Soro {
+
+PoseCsvSeries::PoseCsvSeries(QObject *parent) : QObject(parent) { }
+
+const PoseCsvSeries::LatitudeCsvSeries* PoseCsvSeries::getLatitudeSeries() const
+{
+    return &_latitudeSeries;
+}
+
+const PoseCsvSeries::LongitudeCsvSeries* PoseCsvSeries::getLongitudeSeries() const
+{
+    return &_longitudeSeries;
+}
+
+const PoseCsvSeries::HeadingCsvSeries* PoseCsvSeries::getHeadingSeries() const
+{
+    return &_headingSeries;
+}
+
+const PoseCsvSeries::SpeedCsvSeries* PoseCsvSeries::getSpeedSeries() const
+{
+    return &_speedSeries;
+}
+
+const PoseCsvSeries::AccuracyCsvSeries* PoseCsvSeries::getAccuracySeries() const
+{
+    return &_accuracySeries;
+}
+
+void PoseCsvSeries::update(const PoseEstimate& pose)
+{
+    _latitudeSeries.update(QVariant(pose.latitudeDegrees()));
+    _longitudeSeries.update(QVariant(pose.longitudeDegrees()));
+    _headingSeries.update(QVariant(pose.headingDegrees()));
+    _speedSeries.update(QVariant(pose.speedMetersPerSecond()));
+    _accuracySeries.update(QVariant(pose.accuracyMeters()));
+}
+
+} // namespace Soro
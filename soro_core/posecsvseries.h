@@ -0,0 +1,60 @@
+#ifndef POSECSVSERIES_H
+#define POSECSVSERIES_H
+
+#include <QObject>
+
+#include "soro_core_global.h"
+#include "poseestimator.h"
+#include "csvrecorder.h"
+
+namespace Soro {
+
+/* Records the rover's estimated pose from PoseEstimator, in degrees, meters and meters per second
+ */
+class SORO_CORE_EXPORT PoseCsvSeries : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PoseCsvSeries(QObject *parent = 0);
+
+    class LatitudeCsvSeries : public CsvDataSeries { friend class PoseCsvSeries;
+    public:     QString getSeriesName() const { return "Estimated Latitude"; }
+                bool shouldKeepOldValues() const { return true; }
+    };
+    class LongitudeCsvSeries : public CsvDataSeries { friend class PoseCsvSeries;
+    public:     QString getSeriesName() const { return "Estimated Longitude"; }
+                bool shouldKeepOldValues() const { return true; }
+    };
+    class HeadingCsvSeries : public CsvDataSeries { friend class PoseCsvSeries;
+    public:     QString getSeriesName() const { return "Estimated Heading"; }
+                bool shouldKeepOldValues() const { return true; }
+    };
+    class SpeedCsvSeries : public CsvDataSeries { friend class PoseCsvSeries;
+    public:     QString getSeriesName() const { return "Estimated Speed"; }
+                bool shouldKeepOldValues() const { return true; }
+    };
+    class AccuracyCsvSeries : public CsvDataSeries { friend class PoseCsvSeries;
+    public:     QString getSeriesName() const { return "Estimated Position Error"; }
+                bool shouldKeepOldValues() const { return true; }
+    };
+
+    const LatitudeCsvSeries* getLatitudeSeries() const;
+    const LongitudeCsvSeries* getLongitudeSeries() const;
+    const HeadingCsvSeries* getHeadingSeries() const;
+    const SpeedCsvSeries* getSpeedSeries() const;
+    const AccuracyCsvSeries* getAccuracySeries() const;
+
+public Q_SLOTS:
+    void update(const PoseEstimate& pose);
+
+private:
+    LatitudeCsvSeries _latitudeSeries;
+    LongitudeCsvSeries _longitudeSeries;
+    HeadingCsvSeries _headingSeries;
+    SpeedCsvSeries _speedSeries;
+    AccuracyCsvSeries _accuracySeries;
+};
+
+} // namespace Soro
+
+#endif // POSECSVSERIES_H
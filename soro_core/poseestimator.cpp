@@ -0,0 +1,281 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "poseestimator.h"
+#include "drivemessage.h"
+#include "clock.h"
+
+#include <cmath>
+
+#define METERS_PER_DEGREE_LATITUDE 111320.0
+//typical error of a single GPS fix, in meters
+#define GPS_ERROR 3.0
+//dead reckoning error grows by this fraction of the distance travelled
+#define DRIFT_PER_METER 0.05
+//a fix this many meters from the estimate replaces it instead of being blended in
+#define RESET_DISTANCE 25.0
+//a fix this many milliseconds after the last one replaces the estimate
+#define MAX_FIX_GAP 10000
+//IMU yaw older than this is not used for heading
+#define YAW_TIMEOUT 1000
+//longest step dead reckoned at once, so a stalled event loop doesn't fling the estimate away
+#define MAX_ADVANCE_INTERVAL 1000
+//the GPS course is only trusted above this speed in meters per second
+#define MIN_COURSE_SPEED 0.5
+//speed is only learned while the wheels are commanded at least this hard
+#define MIN_LEARNING_COMMAND 0.2
+#define YAW_CORRECTION_GAIN 0.05
+#define SPEED_LEARNING_GAIN 0.1
+
+namespace Soro {
+
+PoseEstimate::PoseEstimate()
+{
+    latitude = 0;
+    longitude = 0;
+    heading = 0;
+    speed = 0;
+    accuracy = 0;
+    fixAge = 0;
+}
+
+double PoseEstimate::latitudeDegrees() const
+{
+    return latitude / 1e7;
+}
+
+double PoseEstimate::longitudeDegrees() const
+{
+    return longitude / 1e7;
+}
+
+double PoseEstimate::headingDegrees() const
+{
+    return heading / 100.0;
+}
+
+double PoseEstimate::speedMetersPerSecond() const
+{
+    return speed / 100.0;
+}
+
+double PoseEstimate::accuracyMeters() const
+{
+    return accuracy / 100.0;
+}
+
+QDataStream& operator<<(QDataStream& stream, const PoseEstimate& pose)
+{
+    stream << pose.latitude << pose.longitude << pose.heading << pose.speed << pose.accuracy << pose.fixAge;
+    return stream;
+}
+
+QDataStream& operator>>(QDataStream& stream, PoseEstimate& pose)
+{
+    stream >> pose.latitude >> pose.longitude >> pose.heading >> pose.speed >> pose.accuracy >> pose.fixAge;
+    return stream;
+}
+
+PoseEstimator::PoseEstimator(QObject *parent) : QObject(parent) { }
+
+void PoseEstimator::start(int interval)
+{
+    KILL_TIMER(_updateTimerId);
+    START_TIMER(_updateTimerId, interval);
+}
+
+void PoseEstimator::stop()
+{
+    KILL_TIMER(_updateTimerId);
+}
+
+bool PoseEstimator::isRunning() const
+{
+    return _updateTimerId != TIMER_INACTIVE;
+}
+
+void PoseEstimator::setMaxSpeed(double speed)
+{
+    _maxSpeed = speed;
+    if (!_hasLearnedSpeed)
+    {
+        _speedPerCommand = speed;
+    }
+}
+
+void PoseEstimator::setYawOffset(double offset)
+{
+    _yawOffset = offset;
+}
+
+void PoseEstimator::setGpsGain(double gain)
+{
+    _gpsGain = qBound(0.0, gain, 1.0);
+}
+
+bool PoseEstimator::hasPose() const
+{
+    return _hasReference;
+}
+
+PoseEstimate PoseEstimator::getPose() const
+{
+    PoseEstimate pose;
+    if (!_hasReference) return pose;
+
+    double heading = currentHeading(_lastAdvanceTime);
+    pose.latitude = static_cast<qint32>(qRound64((_referenceLatitude + _north / METERS_PER_DEGREE_LATITUDE) * 1e7));
+    pose.longitude = static_cast<qint32>(qRound64((_referenceLongitude + _east / _metersPerDegreeLongitude) * 1e7));
+    pose.heading = static_cast<quint16>(heading < 0 ? 0 : qRound(heading * 100) % 36000);
+    pose.speed = static_cast<qint16>(qBound(-32768, qRound(_command * _speedPerCommand * 100), 32767));
+    pose.accuracy = static_cast<quint16>(qBound(0, qRound(_error * 100), 65535));
+    pose.fixAge = static_cast<quint16>(qBound((qint64)0, _lastAdvanceTime - _lastFixTime, (qint64)65535));
+    return pose;
+}
+
+void PoseEstimator::gpsUpdate(NmeaMessage fix)
+{
+    qint64 now = Clock::root()->msecsSinceEpoch();
+    if (!_hasReference)
+    {
+        // Positions are kept in meters from the first fix, which is plenty accurate over the
+        // distances a rover covers
+        _referenceLatitude = fix.Latitude;
+        _referenceLongitude = fix.Longitude;
+        _metersPerDegreeLongitude = qMax(METERS_PER_DEGREE_LATITUDE * std::cos(qDegreesToRadians(fix.Latitude)), 1.0);
+        _hasReference = true;
+        _lastAdvanceTime = now;
+        resetTo(0, 0);
+    }
+    else
+    {
+        advance(now);
+        double fixEast = (fix.Longitude - _referenceLongitude) * _metersPerDegreeLongitude;
+        double fixNorth = (fix.Latitude - _referenceLatitude) * METERS_PER_DEGREE_LATITUDE;
+        double eastError = fixEast - _east;
+        double northError = fixNorth - _north;
+        if ((std::sqrt(eastError * eastError + northError * northError) > RESET_DISTANCE) || (now - _lastFixTime > MAX_FIX_GAP))
+        {
+            resetTo(fixEast, fixNorth);
+        }
+        else
+        {
+            _east += _gpsGain * eastError;
+            _north += _gpsGain * northError;
+            _error = (1 - _gpsGain) * _error + _gpsGain * GPS_ERROR;
+        }
+    }
+    _lastFixTime = now;
+
+    double groundSpeed = fix.GroundSpeed >= 0 ? fix.GroundSpeed / 3.6 : -1;
+    if ((groundSpeed >= 0) && (qAbs(_command) >= MIN_LEARNING_COMMAND))
+    {
+        double observed = groundSpeed / qAbs(_command);
+        _speedPerCommand = qBound(0.0, _speedPerCommand + SPEED_LEARNING_GAIN * (observed - _speedPerCommand), _maxSpeed * 3);
+        _hasLearnedSpeed = true;
+    }
+    if ((fix.Heading >= 0) && (groundSpeed >= MIN_COURSE_SPEED))
+    {
+        // Backing up, the course is opposite the way the rover is facing
+        double course = _command < 0 ? std::fmod(fix.Heading + 180.0, 360.0) : fix.Heading;
+        if (hasRecentYaw(now))
+        {
+            _yawCorrection = wrapDegrees(_yawCorrection + YAW_CORRECTION_GAIN * wrapDegrees(course - currentHeading(now)));
+        }
+        _gpsCourse = course;
+    }
+}
+
+void PoseEstimator::yawUpdate(double yaw)
+{
+    qint64 now = Clock::root()->msecsSinceEpoch();
+    advance(now);
+    _yaw = yaw;
+    _lastYawTime = now;
+}
+
+void PoseEstimator::driveCommand(const char *driveMessage)
+{
+    advance(Clock::root()->msecsSinceEpoch());
+    // Forward speed is the average of both sides, turning comes from the IMU
+    _command = (DriveMessage::getLeftOuter(driveMessage) + DriveMessage::getLeftMiddle(driveMessage)
+                + DriveMessage::getRightOuter(driveMessage) + DriveMessage::getRightMiddle(driveMessage)) / 4.0;
+}
+
+void PoseEstimator::update()
+{
+    if (!_hasReference) return;
+    advance(Clock::root()->msecsSinceEpoch());
+    Q_EMIT poseUpdated(getPose());
+}
+
+void PoseEstimator::timerEvent(QTimerEvent *e)
+{
+    QObject::timerEvent(e);
+    if (e->timerId() == _updateTimerId)
+    {
+        update();
+    }
+}
+
+bool PoseEstimator::hasRecentYaw(qint64 now) const
+{
+    return (_lastYawTime >= 0) && (now - _lastYawTime <= YAW_TIMEOUT);
+}
+
+double PoseEstimator::currentHeading(qint64 now) const
+{
+    if (hasRecentYaw(now))
+    {
+        double heading = std::fmod(_yaw + _yawOffset + _yawCorrection, 360.0);
+        return heading < 0 ? heading + 360.0 : heading;
+    }
+    return _gpsCourse;
+}
+
+void PoseEstimator::advance(qint64 now)
+{
+    if (!_hasReference || (now <= _lastAdvanceTime)) return;
+    double elapsed = qMin(now - _lastAdvanceTime, (qint64)MAX_ADVANCE_INTERVAL) / 1000.0;
+    _lastAdvanceTime = now;
+
+    double distance = _command * _speedPerCommand * elapsed;
+    double heading = currentHeading(now);
+    if (heading < 0)
+    {
+        // Moving in an unknown direction, so the estimate could be anywhere that far away
+        _error += qAbs(distance);
+        return;
+    }
+    _east += distance * std::sin(qDegreesToRadians(heading));
+    _north += distance * std::cos(qDegreesToRadians(heading));
+    _error += qAbs(distance) * DRIFT_PER_METER;
+}
+
+void PoseEstimator::resetTo(double east, double north)
+{
+    _east = east;
+    _north = north;
+    _error = GPS_ERROR;
+}
+
+double PoseEstimator::wrapDegrees(double degrees)
+{
+    double wrapped = std::fmod(degrees + 180.0, 360.0);
+    return (wrapped < 0 ? wrapped + 360.0 : wrapped) - 180.0;
+}
+
+} // namespace Soro
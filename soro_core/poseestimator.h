@@ -0,0 +1,133 @@
+#ifndef SORO_POSEESTIMATOR_H
+#define SORO_POSEESTIMATOR_H
+
+#include <QtCore>
+#include <QDataStream>
+
+#include "soro_core_global.h"
+#include "constants.h"
+#include "nmeamessage.h"
+
+namespace Soro {
+
+/* The rover's estimated position and heading, packed small enough to send many times a second.
+ *
+ * Latitude and longitude are in ten millionths of a degree (about a centimeter), heading in
+ * hundredths of a degree clockwise from north, speed in centimeters per second, and accuracy is
+ * the estimated position error in centimeters.
+ */
+struct SORO_CORE_EXPORT PoseEstimate {
+    qint32 latitude;
+    qint32 longitude;
+    quint16 heading;
+    qint16 speed;
+    quint16 accuracy;
+    /* Milliseconds since the last GPS fix, saturating at 65535
+     */
+    quint16 fixAge;
+
+    PoseEstimate();
+
+    double latitudeDegrees() const;
+    double longitudeDegrees() const;
+    double headingDegrees() const;
+    double speedMetersPerSecond() const;
+    double accuracyMeters() const;
+
+    friend QDataStream& operator<<(QDataStream& stream, const PoseEstimate& pose);
+    friend QDataStream& operator>>(QDataStream& stream, PoseEstimate& pose);
+};
+
+/* Estimates the rover's position and heading between GPS fixes, so the map and HUD can move
+ * smoothly instead of jumping once a second.
+ *
+ * This is a complementary filter. Between fixes the position is dead reckoned from the IMU yaw
+ * and the speed the wheels were last commanded to. Each fix pulls the position part of the way to
+ * it (the GPS gain), and is used to slowly learn:
+ * - the offset between IMU yaw and the GPS course, so a magnetometer that is off doesn't send
+ *   the estimate off sideways
+ * - how fast the rover actually goes for a given wheel command
+ * Without recent IMU data the GPS course is used as the heading. A fix far from the estimate,
+ * or after a long gap, replaces it outright.
+ *
+ * Time comes from Clock::root(), so recorded sessions can be replayed through it on a VirtualClock.
+ */
+class SORO_CORE_EXPORT PoseEstimator: public QObject {
+    Q_OBJECT
+public:
+    explicit PoseEstimator(QObject *parent = nullptr);
+
+    /* Starts emitting the pose every interval milliseconds, once the first GPS fix has arrived
+     */
+    void start(int interval);
+    void stop();
+    bool isRunning() const;
+
+    /* Sets the speed in meters per second the rover is expected to go at full wheel command,
+     * until it has learned the real speed from GPS
+     */
+    void setMaxSpeed(double speed);
+    /* Sets the angle in degrees to add to IMU yaw to get a heading from north
+     */
+    void setYawOffset(double offset);
+    /* Sets how far each GPS fix pulls the position toward it, from 0 to 1
+     */
+    void setGpsGain(double gain);
+
+    bool hasPose() const;
+    PoseEstimate getPose() const;
+
+public Q_SLOTS:
+    void gpsUpdate(NmeaMessage fix);
+    void yawUpdate(double yaw);
+    /* Takes the wheel speeds from a drive message, see DriveMessage
+     */
+    void driveCommand(const char *driveMessage);
+
+    /* Brings the estimate up to now and emits it, without waiting for the timer
+     */
+    void update();
+
+Q_SIGNALS:
+    void poseUpdated(const PoseEstimate& pose);
+
+protected:
+    void timerEvent(QTimerEvent *e) Q_DECL_OVERRIDE;
+
+private:
+    int _updateTimerId = TIMER_INACTIVE;
+    double _maxSpeed = 1.0;
+    double _yawOffset = 0;
+    double _gpsGain = 0.3;
+
+    bool _hasReference = false;
+    double _referenceLatitude = 0;
+    double _referenceLongitude = 0;
+    double _metersPerDegreeLongitude = 0;
+    /* Position in meters east and north of the reference
+     */
+    double _east = 0;
+    double _north = 0;
+    double _error = 0;
+    double _gpsCourse = -1;
+    double _command = 0;
+    double _speedPerCommand = 1.0;
+    bool _hasLearnedSpeed = false;
+    double _yaw = 0;
+    double _yawCorrection = 0;
+    qint64 _lastYawTime = -1;
+    qint64 _lastFixTime = -1;
+    qint64 _lastAdvanceTime = -1;
+
+    bool hasRecentYaw(qint64 now) const;
+    double currentHeading(qint64 now) const;
+    void advance(qint64 now);
+    void resetTo(double east, double north);
+    static double wrapDegrees(double degrees);
+};
+
+} // namespace Soro
+
+Q_DECLARE_METATYPE(Soro::PoseEstimate)
+
+#endif // SORO_POSEESTIMATOR_H
@@ -0,0 +1,337 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "resourcemonitor.h"
+#include "allocationcounter.h"
+#include "executor.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <climits>
+#include <unistd.h>
+
+//number of threads included in each sample, the rest are only counted in the process total
+#define MAX_REPORTED_THREADS 6
+//largest CPU usage that fits in a sample (about 65 cores)
+#define MAX_CPU_USAGE 65535
+
+namespace Soro {
+
+ResourceUsage::ResourceUsage()
+{
+    cpu = 0;
+    rss = 0;
+    fds = 0;
+    allocationsPerSecond = -1;
+    eventLoopLag = 0;
+}
+
+quint32 ResourceUsage::getChildCpu() const
+{
+    quint32 total = 0;
+    for (const Process& child : children)
+    {
+        total += child.cpu;
+    }
+    return total;
+}
+
+quint32 ResourceUsage::getChildRss() const
+{
+    quint32 total = 0;
+    for (const Process& child : children)
+    {
+        total += child.rss;
+    }
+    return total;
+}
+
+quint32 ResourceUsage::getQueuedMessages() const
+{
+    quint32 total = 0;
+    for (const ChannelStats& channel : channels)
+    {
+        total += channel.depth;
+    }
+    return total;
+}
+
+quint32 ResourceUsage::getDiscardedMessages() const
+{
+    quint32 total = 0;
+    for (const ChannelStats& channel : channels)
+    {
+        total += channel.conflated + channel.staleDropped + channel.overflowDropped;
+    }
+    return total;
+}
+
+quint32 ResourceUsage::getLateDroppedPackets() const
+{
+    quint32 total = 0;
+    for (const ChannelStats& channel : channels)
+    {
+        total += channel.lateDropped;
+    }
+    return total;
+}
+
+QDataStream& operator<<(QDataStream& stream, const ResourceUsage& usage)
+{
+    stream << usage.cpu << usage.rss << usage.fds << usage.allocationsPerSecond << usage.eventLoopLag;
+
+    // Thread and process names come from /proc and are at most 15 characters of ASCII
+    int threadCount = qMin(usage.threads.size(), 255);
+    stream << static_cast<quint8>(threadCount);
+    for (int i = 0; i < threadCount; i++)
+    {
+        stream << usage.threads[i].name.toLatin1() << usage.threads[i].cpu;
+    }
+    int childCount = qMin(usage.children.size(), 255);
+    stream << static_cast<quint8>(childCount);
+    for (int i = 0; i < childCount; i++)
+    {
+        const ResourceUsage::Process& child = usage.children[i];
+        stream << child.name.toLatin1() << child.pid << child.cpu << child.rss;
+    }
+    int channelCount = qMin(usage.channels.size(), 255);
+    stream << static_cast<quint8>(channelCount);
+    for (int i = 0; i < channelCount; i++)
+    {
+        const ResourceUsage::ChannelStats& channel = usage.channels[i];
+        stream << channel.name.toUtf8() << channel.depth << channel.bytes << channel.conflated
+               << channel.staleDropped << channel.overflowDropped << channel.reorderDepth << channel.lateDropped;
+    }
+    return stream;
+}
+
+QDataStream& operator>>(QDataStream& stream, ResourceUsage& usage)
+{
+    stream >> usage.cpu >> usage.rss >> usage.fds >> usage.allocationsPerSecond >> usage.eventLoopLag;
+
+    quint8 count;
+    QByteArray name;
+    stream >> count;
+    usage.threads.clear();
+    for (int i = 0; (i < count) && (stream.status() == QDataStream::Ok); i++)
+    {
+        ResourceUsage::Thread thread;
+        stream >> name >> thread.cpu;
+        thread.name = QString::fromLatin1(name);
+        usage.threads.append(thread);
+    }
+    stream >> count;
+    usage.children.clear();
+    for (int i = 0; (i < count) && (stream.status() == QDataStream::Ok); i++)
+    {
+        ResourceUsage::Process child;
+        stream >> name >> child.pid >> child.cpu >> child.rss;
+        child.name = QString::fromLatin1(name);
+        usage.children.append(child);
+    }
+    stream >> count;
+    usage.channels.clear();
+    for (int i = 0; (i < count) && (stream.status() == QDataStream::Ok); i++)
+    {
+        ResourceUsage::ChannelStats channel;
+        stream >> name >> channel.depth >> channel.bytes >> channel.conflated
+               >> channel.staleDropped >> channel.overflowDropped >> channel.reorderDepth >> channel.lateDropped;
+        channel.name = QString::fromUtf8(name);
+        usage.channels.append(channel);
+    }
+    return stream;
+}
+
+ResourceMonitor::ResourceMonitor(QObject *parent) : QObject(parent)
+{
+    LOG_TAG = "ResourceMonitor";
+}
+
+void ResourceMonitor::start(int interval)
+{
+    KILL_TIMER(_sampleTimerId);
+    _sampler = QSharedPointer<Sampler>(new Sampler);
+    _sampler->clock.start();
+    _sampler->lastAllocations = AllocationCounter::getCount();
+    _sampler->ticksPerSecond = sysconf(_SC_CLK_TCK);
+    _sampler->pageSize = sysconf(_SC_PAGESIZE);
+    // Take the baseline the first real sample is measured against
+    _sampling = false;
+    postSample(false);
+    START_TIMER(_sampleTimerId, interval);
+    LOG_I(LOG_TAG, "Sampling every " + QString::number(interval) + "ms"
+          + (AllocationCounter::isEnabled() ? ", counting allocations" : ""));
+}
+
+void ResourceMonitor::stop()
+{
+    KILL_TIMER(_sampleTimerId);
+}
+
+bool ResourceMonitor::isRunning() const
+{
+    return _sampleTimerId != TIMER_INACTIVE;
+}
+
+ResourceUsage ResourceMonitor::getLastUsage() const
+{
+    return _lastUsage;
+}
+
+void ResourceMonitor::setEventLoopMonitor(EventLoopMonitor *monitor)
+{
+    _eventLoopMonitor = monitor;
+}
+
+void ResourceMonitor::timerEvent(QTimerEvent *e)
+{
+    QObject::timerEvent(e);
+    if (e->timerId() == _sampleTimerId)
+    {
+        postSample(true);
+    }
+}
+
+void ResourceMonitor::postSample(bool emitUsage)
+{
+    if (_sampling)
+    {
+        LOG_D(LOG_TAG, "Skipping a sample, the last one is still being taken");
+        return;
+    }
+    _sampling = true;
+    QSharedPointer<Sampler> sampler = _sampler;
+    Executor::root()->post([sampler]()
+    {
+        return sampler->sample();
+    }, this, [this, sampler, emitUsage](ResourceUsage usage)
+    {
+        // Taken by a sampler from before the monitor was restarted
+        if (sampler != _sampler) return;
+        _sampling = false;
+        if (!emitUsage) return;
+        if (_eventLoopMonitor)
+        {
+            usage.eventLoopLag = static_cast<quint16>(qMin(_eventLoopMonitor->takeMaxLag(), 65535));
+        }
+        _lastUsage = usage;
+        Q_EMIT sampled(usage);
+    });
+}
+
+bool ResourceMonitor::Sampler::readStat(const QString& path, ProcStat *stat) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    QByteArray line = file.readAll();
+
+    // The name is in parentheses and can itself contain spaces and parentheses
+    int nameStart = line.indexOf('(');
+    int nameEnd = line.lastIndexOf(')');
+    if ((nameStart < 0) || (nameEnd < nameStart)) return false;
+
+    // Fields after the name, starting with the state (field 3 in proc(5))
+    QList<QByteArray> fields = line.mid(nameEnd + 2).split(' ');
+    if (fields.size() < 22) return false;
+
+    stat->name = QString::fromLatin1(line.mid(nameStart + 1, nameEnd - nameStart - 1));
+    stat->ppid = fields[1].toInt();
+    stat->ticks = fields[11].toULongLong() + fields[12].toULongLong(); // utime + stime
+    stat->rssPages = fields[21].toULongLong();
+    return true;
+}
+
+quint16 ResourceMonitor::Sampler::cpuUsage(quint64 ticks, quint64 lastTicks, qint64 elapsed) const
+{
+    if ((elapsed <= 0) || (ticks < lastTicks) || (ticksPerSecond <= 0)) return 0;
+    quint64 usage = (ticks - lastTicks) * 1000 * 1000 / (ticksPerSecond * elapsed);
+    return static_cast<quint16>(qMin(usage, (quint64)MAX_CPU_USAGE));
+}
+
+ResourceUsage ResourceMonitor::Sampler::sample()
+{
+    qint64 now = clock.elapsed();
+    qint64 elapsed = now - lastSampleTime;
+    lastSampleTime = now;
+
+    ResourceUsage usage;
+    ProcStat stat;
+
+    if (readStat("/proc/self/stat", &stat))
+    {
+        usage.cpu = cpuUsage(stat.ticks, lastProcessTicks, elapsed);
+        usage.rss = static_cast<quint32>(stat.rssPages * pageSize / 1024);
+        lastProcessTicks = stat.ticks;
+    }
+
+    usage.fds = static_cast<quint16>(QDir("/proc/self/fd").entryList(
+                QDir::AllEntries | QDir::System | QDir::NoDotAndDotDot).size());
+
+    if (AllocationCounter::isEnabled())
+    {
+        quint64 allocations = AllocationCounter::getCount();
+        usage.allocationsPerSecond = elapsed > 0 ?
+                    static_cast<qint32>(qMin((allocations - lastAllocations) * 1000 / elapsed, (quint64)INT_MAX)) : 0;
+        lastAllocations = allocations;
+    }
+
+    // Threads that started since the last sample are measured from zero
+    QHash<qint32, quint64> threadTicks;
+    for (const QString& tid : QDir("/proc/self/task").entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+    {
+        // The thread may have exited since the directory was listed
+        if (!readStat("/proc/self/task/" + tid + "/stat", &stat)) continue;
+        qint32 id = tid.toInt();
+        threadTicks.insert(id, stat.ticks);
+
+        ResourceUsage::Thread thread;
+        thread.name = stat.name;
+        thread.cpu = cpuUsage(stat.ticks, lastThreadTicks.value(id, 0), elapsed);
+        usage.threads.append(thread);
+    }
+    lastThreadTicks = threadTicks;
+    std::sort(usage.threads.begin(), usage.threads.end(),
+              [](const ResourceUsage::Thread& a, const ResourceUsage::Thread& b) { return a.cpu > b.cpu; });
+    if (usage.threads.size() > MAX_REPORTED_THREADS)
+    {
+        usage.threads.erase(usage.threads.begin() + MAX_REPORTED_THREADS, usage.threads.end());
+    }
+
+    // Children are found by scanning every process for our pid as the parent, /proc/<pid>/task/<tid>/children
+    // would be cheaper but isn't built into every kernel
+    qint32 self = static_cast<qint32>(getpid());
+    QHash<qint32, quint64> childTicks;
+    for (const QString& pid : QDir("/proc").entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+    {
+        bool ok;
+        qint32 id = pid.toInt(&ok);
+        if (!ok) continue;
+        if (!readStat("/proc/" + pid + "/stat", &stat) || (stat.ppid != self)) continue;
+        childTicks.insert(id, stat.ticks);
+
+        ResourceUsage::Process child;
+        child.name = stat.name;
+        child.pid = id;
+        child.cpu = cpuUsage(stat.ticks, lastChildTicks.value(id, 0), elapsed);
+        child.rss = static_cast<quint32>(stat.rssPages * pageSize / 1024);
+        usage.children.append(child);
+    }
+    lastChildTicks = childTicks;
+
+    return usage;
+}
+
+} // namespace Soro
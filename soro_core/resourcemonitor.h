@@ -0,0 +1,162 @@
+#ifndef SORO_RESOURCEMONITOR_H
+#define SORO_RESOURCEMONITOR_H
+
+#include <QtCore>
+#include <QDataStream>
+
+#include "soro_core_global.h"
+#include "constants.h"
+#include "eventloopmonitor.h"
+
+namespace Soro {
+
+/* One sample of a process's resource usage, small enough to send to mission control every
+ * few seconds.
+ *
+ * CPU usage is in tenths of a percent of one core, so a process keeping two cores busy is at 2000.
+ * Memory is resident set size in kilobytes.
+ */
+struct SORO_CORE_EXPORT ResourceUsage {
+
+    struct Thread {
+        QString name;
+        quint16 cpu;
+    };
+
+    struct Process {
+        QString name;
+        qint32 pid;
+        quint16 cpu;
+        quint32 rss;
+    };
+
+    /* Send queue and UDP receive statistics of one of the process's channels. Drop and
+     * conflation counts are totals since the channel was created, the reorder depth is the
+     * deepest seen on the current connection.
+     */
+    struct ChannelStats {
+        QString name;
+        quint16 depth;
+        quint32 bytes;
+        quint32 conflated;
+        quint32 staleDropped;
+        quint32 overflowDropped;
+        quint16 reorderDepth;
+        quint32 lateDropped;
+    };
+
+    quint16 cpu;
+    quint32 rss;
+    quint16 fds;
+    /* Heap allocations per second, or -1 if soro_core was built without allocation counting
+     */
+    qint32 allocationsPerSecond;
+    /* Longest event loop lag in milliseconds since the last sample, or 0 if it isn't monitored
+     */
+    quint16 eventLoopLag;
+    /* The busiest threads, busiest first
+     */
+    QList<Thread> threads;
+    /* Processes started by this one, such as the video and audio streamers
+     */
+    QList<Process> children;
+    /* Channels the process wants reported, filled in by its owner as the monitor doesn't
+     * know about channels
+     */
+    QList<ChannelStats> channels;
+
+    ResourceUsage();
+
+    /* Gets the total CPU usage of every child process
+     */
+    quint32 getChildCpu() const;
+    /* Gets the total resident set size of every child process in kilobytes
+     */
+    quint32 getChildRss() const;
+    /* Gets the number of messages waiting in every reported channel's send queue
+     */
+    quint32 getQueuedMessages() const;
+    /* Gets the total number of messages conflated or dropped from every reported channel's send queue
+     */
+    quint32 getDiscardedMessages() const;
+    /* Gets the total number of UDP packets every reported channel dropped for arriving late
+     */
+    quint32 getLateDroppedPackets() const;
+
+    friend QDataStream& operator<<(QDataStream& stream, const ResourceUsage& usage);
+    friend QDataStream& operator>>(QDataStream& stream, ResourceUsage& usage);
+};
+
+/* Samples the CPU usage of each of this process's threads and of its child processes, along
+ * with memory use and open file descriptors, from /proc.
+ *
+ * Sampling is meant to happen every few seconds at most, as every sample reads a file for each
+ * thread and scans /proc for child processes. Samples are taken on the executor and emitted on the
+ * monitor's thread, and a sample that comes due while the last one is still being taken is skipped.
+ */
+class SORO_CORE_EXPORT ResourceMonitor: public QObject {
+    Q_OBJECT
+public:
+    explicit ResourceMonitor(QObject *parent = nullptr);
+
+    /* Starts sampling every interval milliseconds. The first sample is emitted after one interval,
+     * as CPU usage can't be known until then.
+     */
+    void start(int interval);
+    void stop();
+    bool isRunning() const;
+
+    ResourceUsage getLastUsage() const;
+
+    /* Includes the longest lag seen by an event loop monitor in each sample
+     */
+    void setEventLoopMonitor(EventLoopMonitor *monitor);
+
+Q_SIGNALS:
+    void sampled(const ResourceUsage& usage);
+
+protected:
+    void timerEvent(QTimerEvent *e);
+
+private:
+    struct ProcStat {
+        QString name;
+        qint32 ppid;
+        quint64 ticks;
+        quint64 rssPages;
+    };
+
+    /* What each sample is measured against. Only one sample is taken at a time, on the executor,
+     * and a new sampler is started whenever the monitor is, so a sample still being taken when the
+     * monitor is restarted or destroyed doesn't get mixed up with the new ones.
+     */
+    struct Sampler {
+        QElapsedTimer clock;
+        qint64 lastSampleTime = 0;
+        quint64 lastProcessTicks = 0;
+        quint64 lastAllocations = 0;
+        QHash<qint32, quint64> lastThreadTicks;
+        QHash<qint32, quint64> lastChildTicks;
+        long ticksPerSecond;
+        long pageSize;
+
+        ResourceUsage sample();
+        bool readStat(const QString& path, ProcStat *stat) const;
+        quint16 cpuUsage(quint64 ticks, quint64 lastTicks, qint64 elapsed) const;
+    };
+
+    QString LOG_TAG;
+    int _sampleTimerId = TIMER_INACTIVE;
+    QSharedPointer<Sampler> _sampler;
+    bool _sampling = false;
+    ResourceUsage _lastUsage;
+    EventLoopMonitor *_eventLoopMonitor = nullptr;
+
+    void postSample(bool emitUsage);
+};
+
+} // namespace Soro
+
+Q_DECLARE_METATYPE(Soro::ResourceUsage)
+
+#endif // SORO_RESOURCEMONITOR_H
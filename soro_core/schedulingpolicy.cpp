@@ -0,0 +1,304 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "schedulingpolicy.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <errno.h>
+#include <sched.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+#ifndef SCHED_RESET_ON_FORK
+#define SCHED_RESET_ON_FORK 0x40000000
+#endif
+
+#define LOG_TAG "SchedulingPolicy"
+
+namespace Soro {
+
+SchedulingPolicy::SchedulingPolicy() { }
+
+bool SchedulingPolicy::parse(const QString& description, SchedulingPolicy *policy, QString *error)
+{
+    SchedulingPolicy parsed;
+    QString problem;
+    for (const QString& token : description.split(' ', QString::SkipEmptyParts))
+    {
+        QString name = token.section(':', 0, 0).toLower();
+        QString value = token.section(':', 1);
+        bool ok = true;
+        if (name == "cpus")
+        {
+            for (const QString& range : value.split(',', QString::SkipEmptyParts))
+            {
+                int first = range.section('-', 0, 0).toInt(&ok);
+                if (!ok) break;
+                int last = range.contains('-') ? range.section('-', 1).toInt(&ok) : first;
+                if (!ok || (first < 0) || (last < first) || (last >= CPU_SETSIZE))
+                {
+                    ok = false;
+                    break;
+                }
+                for (int cpu = first; cpu <= last; cpu++)
+                {
+                    if (!parsed._cpus.contains(cpu)) parsed._cpus.append(cpu);
+                }
+            }
+            ok = ok && !parsed._cpus.isEmpty();
+        }
+        else if (name == "nice")
+        {
+            parsed._nice = value.toInt(&ok);
+            parsed._hasNice = true;
+            ok = ok && (parsed._nice >= -20) && (parsed._nice <= 19);
+        }
+        else if ((name == "fifo") || (name == "rr"))
+        {
+            parsed._class = name == "fifo" ? FifoClass : RoundRobinClass;
+            parsed._priority = value.toInt(&ok);
+            ok = ok && (parsed._priority >= 1) && (parsed._priority <= 99);
+        }
+        else if ((name == "other") && value.isEmpty())
+        {
+            parsed._class = OtherClass;
+        }
+        else
+        {
+            ok = false;
+        }
+        if (!ok)
+        {
+            problem = "Invalid scheduling setting '" + token + "'";
+            break;
+        }
+    }
+    if (!problem.isEmpty())
+    {
+        if (error) *error = problem;
+        *policy = SchedulingPolicy();
+        return false;
+    }
+    *policy = parsed;
+    return true;
+}
+
+SchedulingPolicy SchedulingPolicy::fromEnvironment(const char *variable)
+{
+    SchedulingPolicy policy;
+    QString description = QString::fromLatin1(qgetenv(variable));
+    QString error;
+    if (!parse(description, &policy, &error))
+    {
+        LOG_W(LOG_TAG, QString(variable) + ": " + error);
+    }
+    return policy;
+}
+
+bool SchedulingPolicy::isEmpty() const
+{
+    return _cpus.isEmpty() && !_hasNice && (_class == UnchangedClass);
+}
+
+QString SchedulingPolicy::toString() const
+{
+    QStringList tokens;
+    if (!_cpus.isEmpty())
+    {
+        tokens << "cpus:" + cpuListString(_cpus);
+    }
+    switch (_class)
+    {
+    case OtherClass:
+        tokens << "other";
+        break;
+    case FifoClass:
+        tokens << "fifo:" + QString::number(_priority);
+        break;
+    case RoundRobinClass:
+        tokens << "rr:" + QString::number(_priority);
+        break;
+    default:
+        break;
+    }
+    if (_hasNice)
+    {
+        tokens << "nice:" + QString::number(_nice);
+    }
+    return tokens.join(' ');
+}
+
+SchedulingPolicy SchedulingPolicy::withDefaults() const
+{
+    SchedulingPolicy policy = *this;
+    if (policy._cpus.isEmpty())
+    {
+        // Cores that aren't online or allowed by the process's cpuset are left out by the kernel
+        long count = qBound(1L, sysconf(_SC_NPROCESSORS_CONF), (long)CPU_SETSIZE);
+        for (int cpu = 0; cpu < count; cpu++)
+        {
+            policy._cpus.append(cpu);
+        }
+    }
+    if (!policy._hasNice)
+    {
+        policy._hasNice = true;
+        policy._nice = 0;
+    }
+    return policy;
+}
+
+bool SchedulingPolicy::applyToThread(qint32 tid, const QString& role) const
+{
+    if (isEmpty()) return true;
+    bool applied = true;
+
+    if (!_cpus.isEmpty())
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : _cpus)
+        {
+            CPU_SET(cpu, &set);
+        }
+        if (sched_setaffinity(tid, sizeof(set), &set) != 0)
+        {
+            LOG_W(LOG_TAG, "Cannot pin " + role + " to cpus " + cpuListString(_cpus) + ": " + strerror(errno));
+            applied = false;
+        }
+    }
+
+    if ((_class == FifoClass) || (_class == RoundRobinClass))
+    {
+        int policy = _class == FifoClass ? SCHED_FIFO : SCHED_RR;
+        struct sched_param param;
+        param.sched_priority = qBound(sched_get_priority_min(policy), _priority, sched_get_priority_max(policy));
+        if (sched_setscheduler(tid, policy | SCHED_RESET_ON_FORK, &param) != 0)
+        {
+            // Usually EPERM without CAP_SYS_NICE or an RLIMIT_RTPRIO allowance
+            LOG_W(LOG_TAG, "Cannot run " + role + " as " + (_class == FifoClass ? "fifo" : "rr") + ":"
+                  + QString::number(param.sched_priority) + " (" + strerror(errno) + "), it stays on the default scheduler");
+            applied = false;
+        }
+    }
+    else if (_class == OtherClass)
+    {
+        struct sched_param param;
+        param.sched_priority = 0;
+        if (sched_setscheduler(tid, SCHED_OTHER, &param) != 0)
+        {
+            LOG_W(LOG_TAG, "Cannot return " + role + " to the default scheduler: " + strerror(errno));
+            applied = false;
+        }
+    }
+
+    if (_hasNice && (setpriority(PRIO_PROCESS, tid, _nice) != 0))
+    {
+        LOG_W(LOG_TAG, "Cannot set nice " + QString::number(_nice) + " for " + role + ": " + strerror(errno));
+        applied = false;
+    }
+
+    LOG_I(LOG_TAG, "Requested " + toString() + " for " + role + ", running with " + describeThread(tid));
+    return applied;
+}
+
+bool SchedulingPolicy::applyToCurrentThread(const QString& role) const
+{
+    return applyToThread(currentThreadId(), role);
+}
+
+qint32 SchedulingPolicy::currentThreadId()
+{
+    return (qint32)syscall(SYS_gettid);
+}
+
+QString SchedulingPolicy::describeThread(qint32 tid)
+{
+    QStringList tokens;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(tid, sizeof(set), &set) == 0)
+    {
+        QList<int> cpus;
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET(cpu, &set)) cpus.append(cpu);
+        }
+        tokens << "cpus:" + cpuListString(cpus);
+    }
+
+    int policy = sched_getscheduler(tid);
+    struct sched_param param;
+    if ((policy >= 0) && (sched_getparam(tid, &param) == 0))
+    {
+        switch (policy & ~SCHED_RESET_ON_FORK)
+        {
+        case SCHED_FIFO:
+            tokens << "fifo:" + QString::number(param.sched_priority);
+            break;
+        case SCHED_RR:
+            tokens << "rr:" + QString::number(param.sched_priority);
+            break;
+        default:
+            tokens << "other";
+            break;
+        }
+    }
+
+    // getpriority() can legitimately return -1, so errno is the only way to tell it failed
+    errno = 0;
+    int nice = getpriority(PRIO_PROCESS, tid);
+    if (errno == 0)
+    {
+        tokens << "nice:" + QString::number(nice);
+    }
+    return tokens.join(' ');
+}
+
+QString SchedulingPolicy::describeProcess(qint32 pid)
+{
+    QStringList lines;
+    QDir tasks("/proc/" + QString::number(pid) + "/task");
+    for (const QString& entry : tasks.entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+    {
+        QFile comm(tasks.filePath(entry + "/comm"));
+        QString name = comm.open(QIODevice::ReadOnly) ? QString::fromLatin1(comm.readAll()).trimmed() : "?";
+        lines << name + "(" + entry + ") " + describeThread(entry.toInt());
+    }
+    return lines.join('\n');
+}
+
+QString SchedulingPolicy::cpuListString(const QList<int>& cpus)
+{
+    QList<int> sorted = cpus;
+    std::sort(sorted.begin(), sorted.end());
+    QStringList ranges;
+    int i = 0;
+    while (i < sorted.size())
+    {
+        int j = i;
+        while ((j + 1 < sorted.size()) && (sorted[j + 1] == sorted[j] + 1)) j++;
+        ranges << (j == i ? QString::number(sorted[i]) : QString::number(sorted[i]) + "-" + QString::number(sorted[j]));
+        i = j + 1;
+    }
+    return ranges.join(',');
+}
+
+} // namespace Soro
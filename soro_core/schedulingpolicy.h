@@ -0,0 +1,91 @@
+#ifndef SORO_SCHEDULINGPOLICY_H
+#define SORO_SCHEDULINGPOLICY_H
+
+#include <QtCore>
+
+#include "soro_core_global.h"
+
+/* Environment variables a parent process uses to pass scheduling policies to its streamer
+ * children, for the child's main thread and for its GStreamer streaming threads
+ */
+#define SCHEDULING_POLICY_ENV "SORO_SCHEDULING"
+#define STREAMING_SCHEDULING_POLICY_ENV "SORO_STREAMING_SCHEDULING"
+
+namespace Soro {
+
+/* CPU affinity, niceness and scheduling class for a thread, as written in configuration files.
+ *
+ * A policy is a space separated list of any of:
+ * - cpus:<list> pins the thread to the listed cores, e.g. cpus:0 or cpus:1-3,5
+ * - nice:<n> sets the niceness, from -20 to 19
+ * - fifo:<priority> or rr:<priority> uses SCHED_FIFO or SCHED_RR at a priority from 1 to 99
+ * - other returns the thread to the default scheduler
+ * Anything left out is not changed, so an empty policy does nothing.
+ *
+ * Real-time classes are set with SCHED_RESET_ON_FORK, so threads and processes started by a
+ * real-time thread go back to the default scheduler. The cores a thread is pinned to and its
+ * niceness are inherited by anything it starts, so threads and processes that shouldn't share
+ * them apply withDefaults() instead.
+ *
+ * A process without the privileges for a real-time class or a negative niceness keeps running
+ * on the default scheduler with a warning, so a policy never stops anything from starting.
+ */
+class SORO_CORE_EXPORT SchedulingPolicy {
+public:
+    enum Class {
+        UnchangedClass,
+        OtherClass,
+        FifoClass,
+        RoundRobinClass
+    };
+
+    SchedulingPolicy();
+
+    /* Parses a policy, returning false and leaving the policy empty if it is invalid
+     */
+    static bool parse(const QString& description, SchedulingPolicy *policy, QString *error=nullptr);
+
+    /* Gets the policy in an environment variable, or an empty policy if it isn't set or is invalid
+     */
+    static SchedulingPolicy fromEnvironment(const char *variable);
+
+    bool isEmpty() const;
+    QString toString() const;
+
+    /* Gets this policy with every core and nice 0 for anything it leaves out, so applying it
+     * resets what a thread or process inherited from the one that started it
+     */
+    SchedulingPolicy withDefaults() const;
+
+    /* Applies the policy to a thread, logging a warning for anything the process is not allowed
+     * to change. Returns true if everything was applied.
+     */
+    bool applyToThread(qint32 tid, const QString& role) const;
+    bool applyToCurrentThread(const QString& role) const;
+
+    /* Gets the ID of the calling thread, as used by the kernel
+     */
+    static qint32 currentThreadId();
+
+    /* Gets the affinity, niceness and scheduling class a thread is actually running with,
+     * in the same format as a policy
+     */
+    static QString describeThread(qint32 tid);
+
+    /* Gets the effective settings of every thread in a process, one per line
+     */
+    static QString describeProcess(qint32 pid);
+
+private:
+    QList<int> _cpus;
+    bool _hasNice = false;
+    int _nice = 0;
+    Class _class = UnchangedClass;
+    int _priority = 0;
+
+    static QString cpuListString(const QList<int>& cpus);
+};
+
+} // namespace Soro
+
+#endif // SORO_SCHEDULINGPOLICY_H
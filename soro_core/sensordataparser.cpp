@@ -15,15 +15,23 @@
  */
 
 #include "sensordataparser.h"
+#include "tracer.h"
 
 #define LOG_TAG "SensorDataRecorder"
 
 namespace Soro {
 
-SensorDataParser::SensorDataParser(QObject *parent) : QObject(parent) { }
+SensorDataParser::SensorDataParser(QObject *parent) : QObject(parent)
+{
+    for (int i = 0; i < SensorTable::count(); i++)
+    {
+        _series.append(new SensorCsvSeries(&SensorTable::at(i), this));
+    }
+}
 
 void SensorDataParser::newData(const char* data, int len)
 {
+    TRACE_SPAN_ARG("sensors", "SensorDataParser::newData", "bytes", len);
     _buffer.append(data, len);
 
     parseBuffer();
@@ -31,185 +39,51 @@ void SensorDataParser::newData(const char* data, int len)
 
 void SensorDataParser::parseBuffer()
 {
-    if (_buffer.length() < 4) return; // 4  is the size of a complete data point
-
-    char tag = _buffer.at(0);
-    bool ok;
-    float data = QString(_buffer.mid(1, 3)).toFloat(&ok);
-
-    if (ok)
+    // Consumed bytes are only removed from the buffer once it has been parsed as far as it can be
+    int pos = 0;
+    while (_buffer.length() - pos >= 4) // 4  is the size of a complete data point
     {
-        switch (tag)
+        char tag = _buffer.at(pos);
+        int index = SensorTable::indexOf(tag);
+        bool ok = false;
+        float data = 0;
+        if (index >= 0)
+        {
+            data = QString::fromLatin1(_buffer.constData() + pos + 1, 3).toFloat(&ok);
+        }
+
+        if (!ok)
         {
-        case DATATAG_WHEELPOWER_A:
-            _wheelPowerASeries.update(QVariant(data));
-            break;
-        case DATATAG_WHEELPOWER_B:
-            _wheelPowerBSeries.update(QVariant(data));
-            break;
-        case DATATAG_WHEELPOWER_C:
-            _wheelPowerCSeries.update(QVariant(data));
-            break;
-        case DATATAG_WHEELPOWER_D:
-            _wheelPowerDSeries.update(QVariant(data));
-            break;
-        case DATATAG_WHEELPOWER_E:
-            _wheelPowerESeries.update(QVariant(data));
-            break;
-        case DATATAG_WHEELPOWER_F:
-            _wheelPowerFSeries.update(QVariant(data));
-            break;
-        case DATATAG_IMUDATA_REAR_YAW:
-            _imuRearYawSeries.update(QVariant(data));
-            break;
-        case DATATAG_IMUDATA_REAR_PITCH:
-            // P: [ 100 - 800 ] -> [ -90, 90 ]
-            //data = (data - 100) * (180/800) - 90;
-            _imuRearPitchSeries.update(QVariant(data));
-            break;
-        case DATATAG_IMUDATA_REAR_ROLL:
-            // R: [ 100 - 900 ] -> [ -180, 180 ]
-            //data = (data - 100) * (360/800) - 180;
-            _imuRearRollSeries.update(QVariant(data));
-            break;
-        case DATATAG_IMUDATA_FRONT_YAW:
-            _imuFrontYawSeries.update(QVariant(data));
-            break;
-        case DATATAG_IMUDATA_FRONT_PITCH:
-            // P: [ 100 - 800 ] -> [ -90, 90 ]
-            //data = (data - 100) * (180/800) - 90;
-            _imuFrontPitchSeries.update(QVariant(data));
-            break;
-        case DATATAG_IMUDATA_FRONT_ROLL:
-            // R: [ 100 - 900 ] -> [ -180, 180 ]
-            //data = (data - 100) * (360/800) - 180;
-            _imuFrontRollSeries.update(QVariant(data));
-            break;
-        case DATATAG_IMUDATA_MIDDLE_YAW:
-            _imuMiddleYawSeries.update(QVariant(data));
-            break;
-        case DATATAG_IMUDATA_MIDDLE_PITCH:
-            // P: [ 100 - 800 ] -> [ -90, 90 ]
-            //data = (data - 100) * (180/800) - 90;
-            _imuMiddlePitchSeries.update(QVariant(data));
-            break;
-        case DATATAG_IMUDATA_MIDDLE_ROLL:
-            // R: [ 100 - 900 ] -> [ -180, 180 ]
-            //data = (data - 100) * (360/800) - 180;
-            _imuMiddleRollSeries.update(QVariant(data));
-            break;
-        default:
             // Something went wrong trying to parse
-            // Remove the first char and try to parse again
-            _buffer.remove(0, 1);
-            parseBuffer();
-            return;
+            // Skip the first char and try to parse again
+            pos++;
+            continue;
         }
+
+        _series[index]->update(QVariant(data));
         Q_EMIT dataParsed(tag, data);
-        _buffer.remove(0, 4);
-        parseBuffer();
+        pos += 4;
     }
-    else
-    {
-        // Something went wrong trying to parse
-        // Remove the first char and try to parse again
-        _buffer.remove(0, 1);
-        parseBuffer();
-    }
-}
-
-const SensorDataParser::WheelPowerACsvSeries* SensorDataParser::getWheelPowerASeries() const
-{
-    return &_wheelPowerASeries;
-}
-
-const SensorDataParser::WheelPowerBCsvSeries* SensorDataParser::getWheelPowerBSeries() const
-{
-    return &_wheelPowerBSeries;
-}
-
-const SensorDataParser::WheelPowerCCsvSeries* SensorDataParser::getWheelPowerCSeries() const
-{
-    return &_wheelPowerCSeries;
-}
-
-const SensorDataParser::WheelPowerDCsvSeries* SensorDataParser::getWheelPowerDSeries() const
-{
-    return &_wheelPowerDSeries;
-}
-
-const SensorDataParser::WheelPowerECsvSeries* SensorDataParser::getWheelPowerESeries() const
-{
-    return &_wheelPowerESeries;
+    _buffer.remove(0, pos);
 }
 
-const SensorDataParser::WheelPowerFCsvSeries* SensorDataParser::getWheelPowerFSeries() const
+const SensorDataParser::SensorCsvSeries* SensorDataParser::getSeries(char tag) const
 {
-    return &_wheelPowerFSeries;
+    int index = SensorTable::indexOf(tag);
+    return index < 0 ? nullptr : _series[index];
 }
 
-const SensorDataParser::ImuRearYawCsvSeries* SensorDataParser::getImuRearYawSeries() const
+void SensorDataParser::addColumns(CsvRecorder *recorder) const
 {
-    return &_imuRearYawSeries;
-}
-
-const SensorDataParser::ImuRearPitchCsvSeries* SensorDataParser::getImuRearPitchSeries() const
-{
-    return &_imuRearPitchSeries;
-}
-
-const SensorDataParser::ImuRearRollCsvSeries* SensorDataParser::getImuRearRollSeries() const
-{
-    return &_imuRearRollSeries;
-}
-
-const SensorDataParser::ImuFrontYawCsvSeries* SensorDataParser::getImuFrontYawSeries() const
-{
-    return &_imuFrontYawSeries;
-}
-
-const SensorDataParser::ImuFrontPitchCsvSeries* SensorDataParser::getImuFrontPitchSeries() const
-{
-    return &_imuFrontPitchSeries;
-}
-
-const SensorDataParser::ImuFrontRollCsvSeries* SensorDataParser::getImuFrontRollSeries() const
-{
-    return &_imuFrontRollSeries;
-}
-
-const SensorDataParser::ImuMiddleYawCsvSeries* SensorDataParser::getImuMiddleYawSeries() const
-{
-    return &_imuMiddleYawSeries;
-}
-
-const SensorDataParser::ImuMiddlePitchCsvSeries* SensorDataParser::getImuMiddlePitchSeries() const
-{
-    return &_imuMiddlePitchSeries;
-}
-
-const SensorDataParser::ImuMiddleRollCsvSeries* SensorDataParser::getImuMiddleRollSeries() const
-{
-    return &_imuMiddleRollSeries;
+    for (int i = 0; i < SensorTable::count(); i++)
+    {
+        recorder->addColumn(_series[i]);
+    }
 }
 
 bool SensorDataParser::isValidTag(char c)
 {
-    return (c == DATATAG_WHEELPOWER_A) ||
-            (c == DATATAG_WHEELPOWER_B) ||
-            (c == DATATAG_WHEELPOWER_C) ||
-            (c == DATATAG_WHEELPOWER_D) ||
-            (c == DATATAG_WHEELPOWER_E) ||
-            (c == DATATAG_WHEELPOWER_F) ||
-            (c == DATATAG_IMUDATA_REAR_YAW) ||
-            (c == DATATAG_IMUDATA_REAR_PITCH) ||
-            (c == DATATAG_IMUDATA_REAR_ROLL) ||
-            (c == DATATAG_IMUDATA_FRONT_YAW) ||
-            (c == DATATAG_IMUDATA_FRONT_PITCH) ||
-            (c == DATATAG_IMUDATA_FRONT_ROLL) ||
-            (c == DATATAG_IMUDATA_MIDDLE_YAW) ||
-            (c == DATATAG_IMUDATA_MIDDLE_PITCH) ||
-            (c == DATATAG_IMUDATA_MIDDLE_ROLL);
+    return SensorTable::indexOf(c) >= 0;
 }
 
 } // namespace Soro
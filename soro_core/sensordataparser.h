@@ -4,12 +4,15 @@
 #include "soro_core_global.h"
 #include "mbedchannel.h"
 #include "csvrecorder.h"
+#include "sensortable.h"
 
 namespace Soro {
 
 /* This class is responsible for logging the data sent back by the research mbed, including
  * IMU and power consumption data. These values are stored in a binary logfile and timestamped;
  * additionally they can be accessed immediately by attaching to the newData() signal.
+ *
+ * Which tags exist, and what they are recorded as, comes from the sensor table (sensortable.h).
  */
 class SORO_CORE_EXPORT SensorDataParser : public QObject
 {
@@ -33,105 +36,33 @@ public:
     static const char DATATAG_IMUDATA_MIDDLE_ROLL = 'Z';
     static const char DATATAG_ERROR = '?';
 
-    class WheelPowerACsvSeries : public CsvDataSeries { friend class SensorDataParser;
-    public:     QString getSeriesName() const { return "Wheel A Power"; }
-                bool shouldKeepOldValues() const { return true; }
-    };
-    class WheelPowerBCsvSeries : public CsvDataSeries { friend class SensorDataParser;
-    public:     QString getSeriesName() const { return "Wheel B Power"; }
-                bool shouldKeepOldValues() const { return true; }
-    };
-    class WheelPowerCCsvSeries : public CsvDataSeries { friend class SensorDataParser;
-    public:     QString getSeriesName() const { return "Wheel C Power"; }
-                bool shouldKeepOldValues() const { return true; }
-    };
-    class WheelPowerDCsvSeries : public CsvDataSeries { friend class SensorDataParser;
-    public:     QString getSeriesName() const { return "Wheel D Power"; }
-                bool shouldKeepOldValues() const { return true; }
-    };
-    class WheelPowerECsvSeries : public CsvDataSeries { friend class SensorDataParser;
-    public:     QString getSeriesName() const { return "Wheel E Power"; }
-                bool shouldKeepOldValues() const { return true; }
-    };
-    class WheelPowerFCsvSeries : public CsvDataSeries { friend class SensorDataParser;
-    public:     QString getSeriesName() const { return "Wheel F Power"; }
-                bool shouldKeepOldValues() const { return true; }
-    };
-    class ImuRearYawCsvSeries : public CsvDataSeries { friend class SensorDataParser;
-    public:     QString getSeriesName() const { return "Rear Yaw"; }
-                bool shouldKeepOldValues() const { return true; }
-    };
-    class ImuRearPitchCsvSeries : public CsvDataSeries { friend class SensorDataParser;
-    public:     QString getSeriesName() const { return "Rear Pitch"; }
-                bool shouldKeepOldValues() const { return true; }
-    };
-    class ImuRearRollCsvSeries : public CsvDataSeries { friend class SensorDataParser;
-    public:     QString getSeriesName() const { return "Rear Roll"; }
-                bool shouldKeepOldValues() const { return true; }
-    };
-    class ImuFrontYawCsvSeries : public CsvDataSeries { friend class SensorDataParser;
-    public:     QString getSeriesName() const { return "Front Yaw"; }
-                bool shouldKeepOldValues() const { return true; }
-    };
-    class ImuFrontPitchCsvSeries : public CsvDataSeries { friend class SensorDataParser;
-    public:     QString getSeriesName() const { return "Front Pitch"; }
-                bool shouldKeepOldValues() const { return true; }
-    };
-    class ImuFrontRollCsvSeries : public CsvDataSeries { friend class SensorDataParser;
-    public:     QString getSeriesName() const { return "Front Roll"; }
-                bool shouldKeepOldValues() const { return true; }
-    };
-    class ImuMiddleYawCsvSeries : public CsvDataSeries { friend class SensorDataParser;
-    public:     QString getSeriesName() const { return "Middle Yaw"; }
-                bool shouldKeepOldValues() const { return true; }
-    };
-    class ImuMiddlePitchCsvSeries : public CsvDataSeries { friend class SensorDataParser;
-    public:     QString getSeriesName() const { return "Middle Pitch"; }
-                bool shouldKeepOldValues() const { return true; }
-    };
-    class ImuMiddleRollCsvSeries : public CsvDataSeries { friend class SensorDataParser;
-    public:     QString getSeriesName() const { return "Middle Roll"; }
+    /* Records one sensor from the sensor table
+     */
+    class SensorCsvSeries : public CsvDataSeries { friend class SensorDataParser;
+    public:     SensorCsvSeries(const SensorDefinition *definition, QObject *parent) : CsvDataSeries(parent), _definition(definition) { }
+                QString getSeriesName() const { return _definition->name; }
                 bool shouldKeepOldValues() const { return true; }
+                const SensorDefinition* getDefinition() const { return _definition; }
+    private:    const SensorDefinition *_definition;
     };
 
     explicit SensorDataParser(QObject *parent=0);
 
     bool isValidTag(char c);
-    QString getSeriesName() const;
 
-    const WheelPowerACsvSeries* getWheelPowerASeries() const;
-    const WheelPowerBCsvSeries* getWheelPowerBSeries() const;
-    const WheelPowerCCsvSeries* getWheelPowerCSeries() const;
-    const WheelPowerDCsvSeries* getWheelPowerDSeries() const;
-    const WheelPowerECsvSeries* getWheelPowerESeries() const;
-    const WheelPowerFCsvSeries* getWheelPowerFSeries() const;
-    const ImuRearYawCsvSeries* getImuRearYawSeries() const;
-    const ImuRearPitchCsvSeries* getImuRearPitchSeries() const;
-    const ImuRearRollCsvSeries* getImuRearRollSeries() const;
-    const ImuFrontYawCsvSeries* getImuFrontYawSeries() const;
-    const ImuFrontPitchCsvSeries* getImuFrontPitchSeries() const;
-    const ImuFrontRollCsvSeries* getImuFrontRollSeries() const;
-    const ImuMiddleYawCsvSeries* getImuMiddleYawSeries() const;
-    const ImuMiddlePitchCsvSeries* getImuMiddlePitchSeries() const;
-    const ImuMiddleRollCsvSeries* getImuMiddleRollSeries() const;
+    /* Gets the series a tag is recorded in, or null if no sensor uses it
+     */
+    const SensorCsvSeries* getSeries(char tag) const;
+
+    /* Adds a column for every sensor, in the order of the sensor table
+     */
+    void addColumns(CsvRecorder *recorder) const;
 
 private:
     QByteArray _buffer;
-    WheelPowerACsvSeries _wheelPowerASeries;
-    WheelPowerBCsvSeries _wheelPowerBSeries;
-    WheelPowerCCsvSeries _wheelPowerCSeries;
-    WheelPowerDCsvSeries _wheelPowerDSeries;
-    WheelPowerECsvSeries _wheelPowerESeries;
-    WheelPowerFCsvSeries _wheelPowerFSeries;
-    ImuRearYawCsvSeries _imuRearYawSeries;
-    ImuRearPitchCsvSeries _imuRearPitchSeries;
-    ImuRearRollCsvSeries _imuRearRollSeries;
-    ImuFrontYawCsvSeries _imuFrontYawSeries;
-    ImuFrontPitchCsvSeries _imuFrontPitchSeries;
-    ImuFrontRollCsvSeries _imuFrontRollSeries;
-    ImuMiddleYawCsvSeries _imuMiddleYawSeries;
-    ImuMiddlePitchCsvSeries _imuMiddlePitchSeries;
-    ImuMiddleRollCsvSeries _imuMiddleRollSeries;
+    /* One per sensor table entry, in the same order
+     */
+    QVector<SensorCsvSeries*> _series;
 
     void parseBuffer();
 
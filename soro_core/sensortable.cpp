@@ -0,0 +1,90 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sensortable.h"
+
+//tags are ASCII, anything past this can't be a sensor
+#define TAG_LIMIT 128
+
+namespace Soro {
+
+/* Readings are recorded raw. The IMUs count 800 to a turn, the opposite way to a compass. The front
+ * IMU's yaw is converted for the HUD, to a compass heading (((100 - value) * 360 / 800) - 130 as
+ * calibrated on the rover), and the middle IMU's for the rover's pose estimator, which points it north
+ * with estimator_yaw_offset. The HUD zeroes the others itself.
+ */
+static const SensorDefinition SENSORS[] = {
+    { 'A', "Wheel A Power", SensorDefinition::WheelPowerSensor, 1, 0, "raw", "wheelMLPower" },
+    { 'B', "Wheel B Power", SensorDefinition::WheelPowerSensor, 1, 0, "raw", "wheelFLPower" },
+    { 'C', "Wheel C Power", SensorDefinition::WheelPowerSensor, 1, 0, "raw", "wheelFRPower" },
+    { 'D', "Wheel D Power", SensorDefinition::WheelPowerSensor, 1, 0, "raw", "wheelMRPower" },
+    { 'E', "Wheel E Power", SensorDefinition::WheelPowerSensor, 1, 0, "raw", "wheelBRPower" },
+    { 'F', "Wheel F Power", SensorDefinition::WheelPowerSensor, 1, 0, "raw", "wheelBLPower" },
+    { 'L', "Rear Yaw", SensorDefinition::ImuYawSensor, 1, 0, "raw", nullptr },
+    { 'J', "Rear Pitch", SensorDefinition::ImuPitchSensor, 1, 0, "raw", "rearPitch" },
+    { 'K', "Rear Roll", SensorDefinition::ImuRollSensor, 1, 0, "raw", "rearRoll" },
+    { 'X', "Middle Yaw", SensorDefinition::ImuYawSensor, -360.0f / 800.0f, 0, "degrees", nullptr },
+    { 'Y', "Middle Pitch", SensorDefinition::ImuPitchSensor, 1, 0, "raw", "middlePitch" },
+    { 'Z', "Middle Roll", SensorDefinition::ImuRollSensor, 1, 0, "raw", "middleRoll" },
+    { 'P', "Front Yaw", SensorDefinition::ImuYawSensor, -360.0f / 800.0f, -85.0f, "degrees", "compassHeading" },
+    { 'Q', "Front Pitch", SensorDefinition::ImuPitchSensor, 1, 0, "raw", "frontPitch" },
+    { 'R', "Front Roll", SensorDefinition::ImuRollSensor, 1, 0, "raw", "frontRoll" },
+};
+
+static const int SENSOR_COUNT = sizeof(SENSORS) / sizeof(SENSORS[0]);
+
+/* Position of every tag in SENSORS, or -1
+ */
+struct TagIndex {
+    qint8 index[TAG_LIMIT];
+
+    TagIndex() {
+        memset(index, -1, sizeof(index));
+        for (int i = 0; i < SENSOR_COUNT; i++) {
+            index[static_cast<unsigned char>(SENSORS[i].tag)] = static_cast<qint8>(i);
+        }
+    }
+};
+
+static const TagIndex TAG_INDEX;
+
+namespace SensorTable {
+
+int count()
+{
+    return SENSOR_COUNT;
+}
+
+const SensorDefinition& at(int index)
+{
+    return SENSORS[index];
+}
+
+int indexOf(char tag)
+{
+    unsigned char c = static_cast<unsigned char>(tag);
+    return c < TAG_LIMIT ? TAG_INDEX.index[c] : -1;
+}
+
+const SensorDefinition* find(char tag)
+{
+    int index = indexOf(tag);
+    return index < 0 ? nullptr : &SENSORS[index];
+}
+
+} // namespace SensorTable
+
+} // namespace Soro
@@ -0,0 +1,58 @@
+#ifndef SORO_SENSORTABLE_H
+#define SORO_SENSORTABLE_H
+
+#include <QtCore>
+
+#include "soro_core_global.h"
+
+namespace Soro {
+
+/* Describes one kind of reading the research mbed sends, identified by a single character tag
+ */
+struct SORO_CORE_EXPORT SensorDefinition {
+    enum Type {
+        WheelPowerSensor,
+        ImuYawSensor,
+        ImuPitchSensor,
+        ImuRollSensor
+    };
+
+    char tag;
+    /* Name of the CSV column the raw reading is recorded in
+     */
+    const char *name;
+    Type type;
+    /* Converts a raw reading to unit, as value * scale + offset
+     */
+    float scale;
+    float offset;
+    const char *unit;
+    /* Mission control main window property the converted reading is shown in, or null
+     */
+    const char *hudProperty;
+
+    inline float toUnits(float raw) const {
+        return raw * scale + offset;
+    }
+};
+
+/* Every sensor the research mbed reports, in the order their columns appear in data logs.
+ * A new sensor only needs a line in the table in sensortable.cpp.
+ */
+namespace SensorTable {
+
+    SORO_CORE_EXPORT int count();
+    SORO_CORE_EXPORT const SensorDefinition& at(int index);
+
+    /* Gets the position of a tag in the table in constant time, or -1 if no sensor uses it
+     */
+    SORO_CORE_EXPORT int indexOf(char tag);
+
+    /* Gets the definition for a tag, or null if no sensor uses it
+     */
+    SORO_CORE_EXPORT const SensorDefinition* find(char tag);
+}
+
+} // namespace Soro
+
+#endif // SORO_SENSORTABLE_H
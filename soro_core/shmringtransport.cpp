@@ -0,0 +1,409 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "shmringtransport.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <atomic>
+#include <new>
+#include <cerrno>
+#include <cstring>
+#include <cstddef>
+
+//size of each ring in bytes, must be a power of 2
+#define RING_CAPACITY 65536
+#define RING_MASK (RING_CAPACITY - 1)
+//bytes used to store the length of each datagram in the ring
+#define RECORD_HEADER_SIZE 2
+//marks a segment that has been set up by a live server
+#define SEGMENT_MAGIC 0x534F524F
+//rate at which a ring is read while it still holds datagrams after a wakeup
+#define POLL_INTERVAL 1
+//rate of the server's heartbeat, and of the client's checks on the server and attach retries
+#define MAINTENANCE_INTERVAL 100
+//time after which a client gives up on a server whose heartbeat has stopped
+#define SERVER_SILENCE_TIMEOUT 3000
+
+namespace Soro {
+
+struct ShmRingTransport::Ring {
+    std::atomic<quint32> head;  //Total bytes ever written, only modified by the producer
+    std::atomic<quint32> tail;  //Total bytes ever read, only modified by the consumer
+};
+
+struct ShmRingTransport::Segment {
+    std::atomic<quint32> magic;
+    std::atomic<quint32> generation;    //Incremented each time a server sets the segment up
+    std::atomic<quint32> serverBeat;    //Incremented by the server on every maintenance tick
+    Ring toServer;
+    Ring toClient;
+    char toServerData[RING_CAPACITY];
+    char toClientData[RING_CAPACITY];
+};
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "Shared memory rings require lock-free atomics");
+
+static inline void ringWrite(char *ring, quint32 position, const char *data, quint32 length)
+{
+    quint32 offset = position & RING_MASK;
+    quint32 first = qMin(length, (quint32)RING_CAPACITY - offset);
+    memcpy(ring + offset, data, first);
+    memcpy(ring, data + first, length - first);
+}
+
+/* Doorbell sockets live in the abstract namespace, so nothing is left behind in the file system
+ * by a process that crashes
+ */
+static socklen_t makeDoorbellAddress(const QString& name, sockaddr_un *addr)
+{
+    QByteArray encoded = name.toUtf8();
+    memset(addr, 0, sizeof(sockaddr_un));
+    addr->sun_family = AF_UNIX;
+    int length = qMin(encoded.size(), (int)sizeof(addr->sun_path) - 1);
+    memcpy(addr->sun_path + 1, encoded.constData(), length);
+    return (socklen_t)(offsetof(sockaddr_un, sun_path) + 1 + length);
+}
+
+static inline void ringRead(const char *ring, quint32 position, char *data, quint32 length)
+{
+    quint32 offset = position & RING_MASK;
+    quint32 first = qMin(length, (quint32)RING_CAPACITY - offset);
+    memcpy(data, ring + offset, first);
+    memcpy(data + first, ring, length - first);
+}
+
+ShmRingTransport::ShmRingTransport(const QString& key, bool server, QObject *parent)
+    : ChannelTransport(key, server, parent)
+{
+    _memory.setKey("soro_channel_" + key);
+    _peer = "shm:" + key;
+}
+
+ShmRingTransport::~ShmRingTransport()
+{
+    close();
+}
+
+bool ShmRingTransport::isStream() const
+{
+    return false;
+}
+
+bool ShmRingTransport::attach()
+{
+    if (_segment) return true;
+    if (_server)
+    {
+        // Only one live process can hold the server's doorbell, which open() binds before this,
+        // and the kernel lets go of it when that process dies. Any server that was using an
+        // existing segment is therefore gone.
+        if (_memory.create(sizeof(Segment)))
+        {
+            _segment = new (_memory.data()) Segment;
+            _segment->toServer.head.store(0);
+            _segment->toServer.tail.store(0);
+            _segment->toClient.head.store(0);
+            _segment->toClient.tail.store(0);
+            _segment->serverBeat.store(0);
+            _segment->generation.store(1);
+        }
+        else
+        {
+            // A segment left behind by a server that crashed lives on while its client is still
+            // attached (or for good, if nothing ever detached from it), so take it over
+            if ((_memory.error() != QSharedMemory::AlreadyExists) || !_memory.attach())
+            {
+                setError("Cannot create shared memory segment: " + _memory.errorString());
+                return false;
+            }
+            if (_memory.size() < (int)sizeof(Segment))
+            {
+                _memory.detach();
+                setError("Existing shared memory segment is too small");
+                return false;
+            }
+            _segment = static_cast<Segment*>(_memory.data());
+            // The client may be writing or reading right now, so only what the server owns is
+            // touched: the read position of the ring to the server, skipping whatever the old
+            // server left unread, and the write position of the ring to the client, which carries on
+            _segment->toServer.tail.store(_segment->toServer.head.load(std::memory_order_acquire), std::memory_order_release);
+            _segment->generation.fetch_add(1, std::memory_order_release);
+        }
+        _segment->magic.store(SEGMENT_MAGIC, std::memory_order_release);
+        _rxRing = &_segment->toServer;
+        _rxData = _segment->toServerData;
+        _txRing = &_segment->toClient;
+        _txData = _segment->toClientData;
+        return true;
+    }
+    if (!_memory.attach())
+    {
+        // Server is not up yet, try again on the next maintenance tick
+        return false;
+    }
+    if ((_memory.size() < (int)sizeof(Segment))
+            || (static_cast<Segment*>(_memory.data())->magic.load(std::memory_order_acquire) != SEGMENT_MAGIC))
+    {
+        _memory.detach();
+        return false;
+    }
+    _segment = static_cast<Segment*>(_memory.data());
+    _generation = _segment->generation.load(std::memory_order_relaxed);
+    _lastServerBeat = _segment->serverBeat.load(std::memory_order_relaxed);
+    _lastServerBeatTime = Clock::root()->msecsSinceEpoch();
+    // Skip anything left over from a previous client
+    _segment->toClient.tail.store(_segment->toClient.head.load(std::memory_order_acquire), std::memory_order_release);
+    _rxRing = &_segment->toClient;
+    _rxData = _segment->toClientData;
+    _txRing = &_segment->toServer;
+    _txData = _segment->toServerData;
+    return true;
+}
+
+bool ShmRingTransport::openDoorbell()
+{
+    if (_doorbellFd >= 0) return true;
+    sockaddr_un addr;
+    socklen_t length = makeDoorbellAddress(_memory.key() + (_server ? ".server" : ".client"), &addr);
+    _doorbellFd = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (_doorbellFd < 0)
+    {
+        setError(QString("socket() failed: ") + strerror(errno));
+        return false;
+    }
+    if (::bind(_doorbellFd, reinterpret_cast<sockaddr*>(&addr), length) != 0)
+    {
+        QString message = errno == EADDRINUSE
+                ? QString("Another ") + (_server ? "server" : "client") + " is still using this segment"
+                : QString("Cannot bind doorbell socket: ") + strerror(errno);
+        closeDoorbell();
+        setError(message);
+        return false;
+    }
+    _doorbellNotifier = new QSocketNotifier(_doorbellFd, QSocketNotifier::Read, this);
+    connect(_doorbellNotifier, &QSocketNotifier::activated, this, &ShmRingTransport::doorbellRung);
+    return true;
+}
+
+void ShmRingTransport::closeDoorbell()
+{
+    if (_doorbellNotifier)
+    {
+        _doorbellNotifier->setEnabled(false);
+        _doorbellNotifier->deleteLater();
+        _doorbellNotifier = nullptr;
+    }
+    if (_doorbellFd >= 0)
+    {
+        ::close(_doorbellFd);
+        _doorbellFd = -1;
+    }
+}
+
+void ShmRingTransport::ringDoorbell()
+{
+    if (_doorbellFd < 0) return;
+    sockaddr_un addr;
+    socklen_t length = makeDoorbellAddress(_memory.key() + (_server ? ".client" : ".server"), &addr);
+    // Nobody listening, or a full socket buffer that already holds a wakeup, can both be ignored
+    char ring = 0;
+    ::sendto(_doorbellFd, &ring, 1, MSG_DONTWAIT | MSG_NOSIGNAL, reinterpret_cast<sockaddr*>(&addr), length);
+}
+
+void ShmRingTransport::doorbellRung()
+{
+    char buffer[64];
+    while (::recv(_doorbellFd, buffer, sizeof(buffer), MSG_DONTWAIT) > 0) { }
+    deliver();
+}
+
+void ShmRingTransport::deliver()
+{
+    if (hasPendingDatagrams())
+    {
+        Q_EMIT readyRead();
+    }
+    // Keep reading on a timer only while a reader left something in the ring, the next writer
+    // to find it empty rings the doorbell again
+    if (hasPendingDatagrams())
+    {
+        if (_pollTimerId == TIMER_INACTIVE) START_TIMER(_pollTimerId, POLL_INTERVAL);
+    }
+    else
+    {
+        KILL_TIMER(_pollTimerId);
+    }
+}
+
+void ShmRingTransport::detach()
+{
+    if (_segment)
+    {
+        if (_server)
+        {
+            _segment->magic.store(0, std::memory_order_release);
+        }
+        _segment = nullptr;
+        _rxRing = _txRing = nullptr;
+        _rxData = _txData = nullptr;
+        _memory.detach();
+    }
+}
+
+bool ShmRingTransport::open()
+{
+    if (!openDoorbell()) return false;
+    if (!attach() && _server) return false;
+    START_TIMER(_maintenanceTimerId, MAINTENANCE_INTERVAL);
+    if (hasPendingDatagrams())
+    {
+        // Written before the doorbell was bound, so nobody rang it
+        START_TIMER(_pollTimerId, POLL_INTERVAL);
+    }
+    return true;
+}
+
+void ShmRingTransport::abort()
+{
+    // There is only ever one client, so there is no peer to forget
+}
+
+void ShmRingTransport::close()
+{
+    KILL_TIMER(_pollTimerId);
+    KILL_TIMER(_maintenanceTimerId);
+    detach();
+    closeDoorbell();
+}
+
+void ShmRingTransport::setPeer(const QString& peer)
+{
+    Q_UNUSED(peer);
+}
+
+bool ShmRingTransport::hasPendingDatagrams() const
+{
+    return _rxRing && (_rxRing->head.load(std::memory_order_acquire) != _rxRing->tail.load(std::memory_order_relaxed));
+}
+
+qint64 ShmRingTransport::readDatagram(char *data, qint64 maxLength, QString *sender)
+{
+    if (!_rxRing) return -1;
+    quint32 head = _rxRing->head.load(std::memory_order_acquire);
+    quint32 tail = _rxRing->tail.load(std::memory_order_relaxed);
+    quint32 available = head - tail;
+    if (available < RECORD_HEADER_SIZE) return -1;
+    unsigned char header[RECORD_HEADER_SIZE];
+    ringRead(_rxData, tail, reinterpret_cast<char*>(header), RECORD_HEADER_SIZE);
+    quint32 length = ((quint32)header[0] << 8) | header[1];
+    if ((available > RING_CAPACITY) || (length > available - RECORD_HEADER_SIZE))
+    {
+        // The ring is corrupt, drop whatever is in it instead of reading past what was written
+        _rxRing->tail.store(head, std::memory_order_release);
+        return -1;
+    }
+    // Like a datagram socket, anything that does not fit is discarded
+    ringRead(_rxData, tail + RECORD_HEADER_SIZE, data, qMin((quint32)maxLength, length));
+    _rxRing->tail.store(tail + RECORD_HEADER_SIZE + length, std::memory_order_release);
+    // Pairs with the fence in writeDatagram(), so either the next hasPendingDatagrams() sees a
+    // datagram written after this one, or its writer sees the ring empty and rings the doorbell
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sender)
+    {
+        *sender = _peer;
+    }
+    return qMin((qint64)length, maxLength);
+}
+
+qint64 ShmRingTransport::writeDatagram(const char *data, qint64 length)
+{
+    if (!_txRing || (length > 0xFFFF)) return -1;
+    quint32 head = _txRing->head.load(std::memory_order_relaxed);
+    quint32 used = head - _txRing->tail.load(std::memory_order_acquire);
+    if (RING_CAPACITY - used < RECORD_HEADER_SIZE + (quint32)length)
+    {
+        // Ring is full, drop the datagram
+        return -1;
+    }
+    unsigned char header[RECORD_HEADER_SIZE] = { (unsigned char)((length >> 8) & 0xFF), (unsigned char)(length & 0xFF) };
+    ringWrite(_txData, head, reinterpret_cast<const char*>(header), RECORD_HEADER_SIZE);
+    ringWrite(_txData, head + RECORD_HEADER_SIZE, data, (quint32)length);
+    _txRing->head.store(head + RECORD_HEADER_SIZE + (quint32)length, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_txRing->tail.load(std::memory_order_relaxed) == head)
+    {
+        // The reader had caught up, so it may be asleep
+        ringDoorbell();
+    }
+    return length;
+}
+
+void ShmRingTransport::checkServer()
+{
+    if (_segment->magic.load(std::memory_order_acquire) != SEGMENT_MAGIC)
+    {
+        // Server has closed the segment, wait for it to come back
+        detach();
+        return;
+    }
+    qint64 now = Clock::root()->msecsSinceEpoch();
+    quint32 generation = _segment->generation.load(std::memory_order_acquire);
+    quint32 beat = _segment->serverBeat.load(std::memory_order_relaxed);
+    if ((generation != _generation) || (beat != _lastServerBeat))
+    {
+        if (generation != _generation)
+        {
+            // Anything still unread came from the server that died
+            _segment->toClient.tail.store(_segment->toClient.head.load(std::memory_order_acquire), std::memory_order_release);
+        }
+        _generation = generation;
+        _lastServerBeat = beat;
+        _lastServerBeatTime = now;
+    }
+    else if (now - _lastServerBeatTime > SERVER_SILENCE_TIMEOUT)
+    {
+        // The server died without closing the segment. Once nobody is attached the segment is
+        // destroyed, and a new server creates a fresh one.
+        detach();
+    }
+}
+
+void ShmRingTransport::timerEvent(QTimerEvent *e)
+{
+    QObject::timerEvent(e);
+    if (e->timerId() == _pollTimerId)
+    {
+        deliver();
+    }
+    else if (e->timerId() == _maintenanceTimerId)
+    {
+        if (_server)
+        {
+            if (_segment) _segment->serverBeat.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            if (_segment) checkServer();
+            if (!_segment && !attach()) return;
+        }
+        deliver();
+    }
+}
+
+} // namespace Soro
@@ -0,0 +1,81 @@
+#ifndef SORO_SHMRINGTRANSPORT_H
+#define SORO_SHMRINGTRANSPORT_H
+
+#include <QSharedMemory>
+#include <QSocketNotifier>
+#include <QTimerEvent>
+
+#include "soro_core_global.h"
+#include "channeltransport.h"
+#include "constants.h"
+
+namespace Soro {
+
+/* Shared-memory transport (shm:<key>), a datagram transport for a server and a single
+ * client on the same host.
+ *
+ * The server creates a segment holding two single-producer/single-consumer rings, one
+ * for each direction. Each datagram is stored as a 2 byte length followed by its data.
+ * A full ring drops the datagram, just like an overflowing UDP socket buffer would.
+ *
+ * Each side also binds a Unix datagram socket in the abstract namespace as a doorbell. A writer
+ * that finds the ring empty before its datagram rings the reader's doorbell, and the reader
+ * wakes up on its socket notifier instead of polling. The ring is only polled (every 1ms) while
+ * it still holds datagrams after the reader was woken, and checked on a slow maintenance timer
+ * in case a ring was filled before the reader's doorbell existed.
+ *
+ * The server's doorbell also keeps a second server off the segment while the first is alive,
+ * since only one process can bind it. A server that finds a segment left behind by a crashed
+ * server takes it over without resetting anything the client writes, as the client may still be
+ * using it. The server counts up a heartbeat on every maintenance tick, and a client detaches from
+ * a segment whose heartbeat has stopped so a dead server's segment doesn't outlive it.
+ */
+class SORO_CORE_EXPORT ShmRingTransport: public ChannelTransport {
+    Q_OBJECT
+public:
+    ShmRingTransport(const QString& key, bool server, QObject *parent);
+    ~ShmRingTransport();
+
+    bool isStream() const Q_DECL_OVERRIDE;
+    bool open() Q_DECL_OVERRIDE;
+    void abort() Q_DECL_OVERRIDE;
+    void close() Q_DECL_OVERRIDE;
+    bool hasPendingDatagrams() const Q_DECL_OVERRIDE;
+    qint64 readDatagram(char *data, qint64 maxLength, QString *sender=nullptr) Q_DECL_OVERRIDE;
+    qint64 writeDatagram(const char *data, qint64 length) Q_DECL_OVERRIDE;
+    void setPeer(const QString& peer) Q_DECL_OVERRIDE;
+
+protected:
+    void timerEvent(QTimerEvent *e);
+
+private:
+    struct Ring;
+    struct Segment;
+
+    QSharedMemory _memory;
+    Segment *_segment = nullptr;
+    Ring *_rxRing = nullptr;
+    Ring *_txRing = nullptr;
+    char *_rxData = nullptr;
+    char *_txData = nullptr;
+    int _doorbellFd = -1;
+    QSocketNotifier *_doorbellNotifier = nullptr;
+    int _pollTimerId = TIMER_INACTIVE;
+    int _maintenanceTimerId = TIMER_INACTIVE;
+    quint32 _generation = 0;
+    quint32 _lastServerBeat = 0;
+    qint64 _lastServerBeatTime = 0;
+
+    bool attach();
+    void detach();
+    void checkServer();
+    bool openDoorbell();
+    void closeDoorbell();
+    void ringDoorbell();
+    void deliver();
+    void doorbellRung();
+};
+
+} // namespace Soro
+
+#endif // SORO_SHMRINGTRANSPORT_H
@@ -1,4 +1,4 @@
-QT += core network
+QT += core network concurrent
 QT -= gui
 
 CONFIG += c++11 no_keywords
@@ -9,6 +9,9 @@ TEMPLATE = lib
 DEFINES += SORO_CORE_LIBRARY
 DEFINES += QT_DEPRECATED_WARNINGS
 
+# Uncomment to count heap allocations for ResourceMonitor, this slows down every allocation
+#DEFINES += SORO_ALLOCATION_COUNTING
+
 BUILD_DIR = ../build/soro_core
 DESTDIR = ../lib
 OBJECTS_DIR = $$BUILD_DIR
@@ -31,7 +34,28 @@ SOURCES += \
     gstreamerutil.cpp \
     mediastreamer.cpp \
     confloader.cpp \
-    wheelspeedcsvseries.cpp
+    wheelspeedcsvseries.cpp \
+    channeltransport.cpp \
+    unixstreamtransport.cpp \
+    unixdatagramtransport.cpp \
+    shmringtransport.cpp \
+    phiaccrualdetector.cpp \
+    liveconfig.cpp \
+    startupgraph.cpp \
+    tracer.cpp \
+    allocationcounter.cpp \
+    resourcemonitor.cpp \
+    eventloopmonitor.cpp \
+    memorybudget.cpp \
+    schedulingpolicy.cpp \
+    videogovernor.cpp \
+    executor.cpp \
+    clock.cpp \
+    virtualclock.cpp \
+    nmeaframer.cpp \
+    poseestimator.cpp \
+    posecsvseries.cpp \
+    sensortable.cpp
 
 HEADERS += \
     channel.h \
@@ -45,14 +69,35 @@ HEADERS += \
     logger.h \
     mbedchannel.h \
     nmeamessage.h \
-    util.h \
+    wirecodec.h \
     socketaddress.h \
     sensordataparser.h \
     gstreamerutil.h \
     soro_core_global.h \
     mediastreamer.h \
     confloader.h \
-    wheelspeedcsvseries.h
+    wheelspeedcsvseries.h \
+    channeltransport.h \
+    unixstreamtransport.h \
+    unixdatagramtransport.h \
+    shmringtransport.h \
+    phiaccrualdetector.h \
+    liveconfig.h \
+    startupgraph.h \
+    tracer.h \
+    allocationcounter.h \
+    resourcemonitor.h \
+    eventloopmonitor.h \
+    memorybudget.h \
+    schedulingpolicy.h \
+    videogovernor.h \
+    executor.h \
+    clock.h \
+    virtualclock.h \
+    nmeaframer.h \
+    poseestimator.h \
+    posecsvseries.h \
+    sensortable.h
 
 #Link Qt5GStreamer
 LIBS += -lQt5GStreamer-1.0 -lQt5GLib-2.0 -lQt5GStreamerUtils-1.0
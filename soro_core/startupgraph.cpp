@@ -0,0 +1,287 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "startupgraph.h"
+#include "logger.h"
+
+#include <QtConcurrent>
+
+namespace Soro {
+
+StartupGraph::StartupGraph(QString name, QObject *parent) : QObject(parent)
+{
+    LOG_TAG = name;
+}
+
+StartupGraph::~StartupGraph()
+{
+    for (TaskInfo *info : _tasks)
+    {
+        // Worker tasks capture objects that are about to be destroyed
+        info->future.waitForFinished();
+        delete info;
+    }
+}
+
+void StartupGraph::addTask(QString name, Task task, QStringList dependencies, StartupGraph::TaskThread thread)
+{
+    addTask(name, task, dependencies, thread, false);
+}
+
+void StartupGraph::addLazyTask(QString name, Task task, QStringList dependencies)
+{
+    addTask(name, task, dependencies, MainThread, true);
+}
+
+void StartupGraph::addTask(QString name, Task task, QStringList dependencies, TaskThread thread, bool lazy)
+{
+    if (_started)
+    {
+        LOG_E(LOG_TAG, "Cannot add task " + name + " after startup has begun");
+        return;
+    }
+    if (_tasks.contains(name))
+    {
+        LOG_E(LOG_TAG, "Task " + name + " was added more than once");
+        return;
+    }
+    TaskInfo *info = new TaskInfo;
+    info->task = task;
+    info->dependencies = dependencies;
+    info->thread = thread;
+    info->lazy = lazy;
+    info->state = PendingState;
+    info->startTime = -1;
+    info->duration = -1;
+    _tasks.insert(name, info);
+    _order.append(name);
+}
+
+bool StartupGraph::hasCycle(QString name, QSet<QString>& visiting, QSet<QString>& visited) const
+{
+    if (visited.contains(name)) return false;
+    if (visiting.contains(name)) return true;
+    visiting.insert(name);
+    for (const QString& dependency : _tasks[name]->dependencies)
+    {
+        if (hasCycle(dependency, visiting, visited)) return true;
+    }
+    visiting.remove(name);
+    visited.insert(name);
+    return false;
+}
+
+bool StartupGraph::start()
+{
+    if (_started) return true;
+    QSet<QString> visiting, visited;
+    for (const QString& name : _order)
+    {
+        for (const QString& dependency : _tasks[name]->dependencies)
+        {
+            if (!_tasks.contains(dependency))
+            {
+                LOG_E(LOG_TAG, "Task " + name + " depends on " + dependency + ", which does not exist");
+                return false;
+            }
+        }
+    }
+    for (const QString& name : _order)
+    {
+        if (hasCycle(name, visiting, visited))
+        {
+            LOG_E(LOG_TAG, "Task " + name + " has a circular dependency");
+            return false;
+        }
+    }
+    _started = true;
+    _clock.start();
+    schedule();
+    return true;
+}
+
+bool StartupGraph::dependenciesDone(const TaskInfo *info) const
+{
+    for (const QString& dependency : info->dependencies)
+    {
+        if (_tasks[dependency]->state != DoneState) return false;
+    }
+    return true;
+}
+
+void StartupGraph::schedule()
+{
+    if (_scheduling)
+    {
+        // A task called require(), let the outer loop pick up anything that unblocked
+        _rescheduleRequested = true;
+        return;
+    }
+    _scheduling = true;
+    do
+    {
+        _rescheduleRequested = false;
+        for (const QString& name : _order)
+        {
+            TaskInfo *info = _tasks[name];
+            if ((info->state != PendingState) || info->lazy || !dependenciesDone(info)) continue;
+            if (info->thread == WorkerThread)
+            {
+                launch(name);
+            }
+            else
+            {
+                run(name);
+                _rescheduleRequested = true;
+            }
+        }
+    } while (_rescheduleRequested);
+    _scheduling = false;
+
+    if (!_finished)
+    {
+        for (const TaskInfo *info : _tasks)
+        {
+            if (!info->lazy && (info->state != DoneState)) return;
+        }
+        _finished = true;
+        LOG_I(LOG_TAG, "Startup finished in " + QString::number(_clock.elapsed()) + "ms:\n" + getTimingReport());
+        Q_EMIT finished();
+    }
+}
+
+void StartupGraph::run(QString name)
+{
+    TaskInfo *info = _tasks[name];
+    info->state = RunningState;
+    info->startTime = _clock.elapsed();
+    QElapsedTimer timer;
+    timer.start();
+    info->task();
+    info->duration = timer.elapsed();
+    complete(name);
+}
+
+void StartupGraph::launch(QString name)
+{
+    TaskInfo *info = _tasks[name];
+    info->state = RunningState;
+    info->startTime = _clock.elapsed();
+    QFutureWatcher<void> *watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcher<void>::finished, this, [this, name, watcher]()
+    {
+        watcher->deleteLater();
+        complete(name);
+        schedule();
+    });
+    // Time the task on its own thread, so a busy event loop doesn't inflate it
+    Task task = info->task;
+    qint64 *duration = &info->duration;
+    info->future = QtConcurrent::run([task, duration]()
+    {
+        QElapsedTimer timer;
+        timer.start();
+        task();
+        *duration = timer.elapsed();
+    });
+    watcher->setFuture(info->future);
+}
+
+void StartupGraph::complete(QString name)
+{
+    TaskInfo *info = _tasks[name];
+    if (info->state == DoneState) return;
+    info->state = DoneState;
+    LOG_D(LOG_TAG, "Task " + name + " finished in " + QString::number(info->duration) + "ms");
+    Q_EMIT taskFinished(name, info->duration);
+}
+
+void StartupGraph::require(QString name)
+{
+    TaskInfo *info = _tasks.value(name, nullptr);
+    if (!info)
+    {
+        LOG_E(LOG_TAG, "require() called for task " + name + ", which does not exist");
+        return;
+    }
+    if (info->state == DoneState) return;
+    if (info->state == RunningState)
+    {
+        if (info->thread == WorkerThread)
+        {
+            info->future.waitForFinished();
+            complete(name);
+        }
+        else
+        {
+            LOG_E(LOG_TAG, "Task " + name + " was required by something it depends on");
+        }
+        return;
+    }
+    for (const QString& dependency : info->dependencies)
+    {
+        require(dependency);
+    }
+    if (info->lazy)
+    {
+        LOG_I(LOG_TAG, "Running deferred task " + name);
+    }
+    run(name);
+    if (_started)
+    {
+        schedule();
+    }
+}
+
+bool StartupGraph::isDone(QString name) const
+{
+    const TaskInfo *info = _tasks.value(name, nullptr);
+    return info && (info->state == DoneState);
+}
+
+qint64 StartupGraph::getDuration(QString name) const
+{
+    const TaskInfo *info = _tasks.value(name, nullptr);
+    return (info && (info->state == DoneState)) ? info->duration : -1;
+}
+
+QString StartupGraph::getTimingReport() const
+{
+    QString report;
+    for (const QString& name : _order)
+    {
+        const TaskInfo *info = _tasks[name];
+        QString line = "    " + name.leftJustified(24, ' ');
+        if (info->state == DoneState)
+        {
+            line += QString::number(info->duration).rightJustified(6, ' ') + "ms";
+            line += "  (started at +" + QString::number(info->startTime) + "ms";
+            line += info->thread == WorkerThread ? ", worker thread)" : ")";
+        }
+        else if (info->lazy)
+        {
+            line += "deferred until first use";
+        }
+        else
+        {
+            line += "not finished";
+        }
+        report += line + "\n";
+    }
+    return report;
+}
+
+} // namespace Soro
@@ -0,0 +1,107 @@
+#ifndef SORO_STARTUPGRAPH_H
+#define SORO_STARTUPGRAPH_H
+
+#include <QtCore>
+#include <QFuture>
+#include <functional>
+
+#include "soro_core_global.h"
+
+namespace Soro {
+
+/* Runs a program's startup as a graph of named tasks instead of one long sequence.
+ *
+ * Each task lists the tasks it depends on, and is run as soon as all of them are done.
+ * Main thread tasks are run back to back without returning to the event loop, so objects
+ * they create can't receive signals before the tasks they depend on have finished.
+ * Worker thread tasks are for blocking work that creates no QObjects (such as waiting on
+ * external processes), and run concurrently with everything else.
+ *
+ * Lazy tasks are not run by start(), they are run the first time require() is called
+ * for them.
+ *
+ * Once every non-lazy task is done, a breakdown of how long each one took is logged and
+ * finished() is emitted.
+ */
+class SORO_CORE_EXPORT StartupGraph: public QObject {
+    Q_OBJECT
+public:
+    enum TaskThread {
+        MainThread, WorkerThread
+    };
+
+    typedef std::function<void()> Task;
+
+    StartupGraph(QString name, QObject *parent=nullptr);
+    ~StartupGraph();
+
+    /* Adds a task to be run once all of its dependencies are done. Must be called before start()
+     */
+    void addTask(QString name, Task task, QStringList dependencies=QStringList(),
+                 StartupGraph::TaskThread thread=MainThread);
+
+    /* Adds a main thread task that is only run when require() is called for it
+     */
+    void addLazyTask(QString name, Task task, QStringList dependencies=QStringList());
+
+    /* Starts running tasks. Returns false if a dependency does not exist or
+     * the dependencies form a cycle, in which case nothing is run.
+     */
+    bool start();
+
+    /* Makes sure a task has been run, running it (and anything it depends on that hasn't
+     * been run) immediately if necessary. This will block on any worker tasks it depends on.
+     */
+    void require(QString name);
+
+    bool isDone(QString name) const;
+
+    /* Gets how long a task took to run in milliseconds, or -1 if it hasn't finished
+     */
+    qint64 getDuration(QString name) const;
+
+    /* Gets a human-readable table of when each task started and how long it took
+     */
+    QString getTimingReport() const;
+
+Q_SIGNALS:
+    void taskFinished(QString name, qint64 duration);
+    void finished();
+
+private:
+    enum TaskState {
+        PendingState, RunningState, DoneState
+    };
+
+    struct TaskInfo {
+        Task task;
+        QStringList dependencies;
+        TaskThread thread;
+        bool lazy;
+        TaskState state;
+        qint64 startTime;
+        qint64 duration;
+        QFuture<void> future;
+    };
+
+    QString LOG_TAG;
+    QStringList _order;
+    QHash<QString, TaskInfo*> _tasks;
+    QElapsedTimer _clock;
+    bool _started = false;
+    bool _scheduling = false;
+    bool _rescheduleRequested = false;
+    bool _finished = false;
+
+    void addTask(QString name, Task task, QStringList dependencies, TaskThread thread, bool lazy);
+    bool dependenciesDone(const TaskInfo *info) const;
+    bool hasCycle(QString name, QSet<QString>& visiting, QSet<QString>& visited) const;
+    void schedule();
+    void run(QString name);
+    void launch(QString name);
+    void complete(QString name);
+};
+
+} // namespace Soro
+
+#endif // SORO_STARTUPGRAPH_H
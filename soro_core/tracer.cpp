@@ -0,0 +1,410 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tracer.h"
+#include "logger.h"
+#include "executor.h"
+
+#include <chrono>
+
+#ifdef Q_OS_UNIX
+#include <signal.h>
+#endif
+
+//events kept per thread, at roughly 50 bytes each
+#define RING_CAPACITY 16384
+//shortest time between two dumps for anomalies
+#define MIN_ANOMALY_DUMP_INTERVAL 60000
+//interval at which a received SIGUSR1 is noticed
+#define SIGNAL_POLL_INTERVAL 250
+//buffers of exited threads kept until a dump covers them, beyond this the oldest are let go
+#define MAX_EXITED_BUFFERS 16
+//buffers kept around for new threads to reuse instead of allocating their own
+#define MAX_SPARE_BUFFERS 4
+
+namespace Soro {
+
+namespace {
+
+struct TraceEvent
+{
+    const char *category;
+    const char *name;
+    const char *argName;
+    qint64 argValue;
+    qint64 timestamp;
+    qint64 duration;
+    char phase;
+};
+
+/* Only the owning thread writes to a buffer. It fills in an event before publishing it by
+ * incrementing written, so a reader that loads written first knows which events are complete.
+ */
+struct ThreadBuffer
+{
+    int threadId;
+    QString name;
+    bool exited;
+    TraceEvent events[RING_CAPACITY];
+    std::atomic<quint64> written;
+};
+
+/* The events of one thread, copied out of its buffer so they can be written without holding
+ * up the threads that are still recording
+ */
+struct ThreadSnapshot
+{
+    int threadId;
+    QString name;
+    QVector<TraceEvent> events;
+};
+
+QMutex buffersMutex;
+// Buffers outlive their threads, so a dump still shows what a thread did before it exited.
+// Once a dump has copied an exited thread's events its buffer is reused or freed.
+QList<ThreadBuffer*> buffers;
+QList<ThreadBuffer*> spareBuffers;
+int nextThreadId = 1;
+
+void releaseThreadBuffer(ThreadBuffer *buffer);
+
+/* Hands the calling thread's buffer back when the thread exits
+ */
+struct ThreadBufferHolder
+{
+    ThreadBuffer *buffer = nullptr;
+
+    ~ThreadBufferHolder()
+    {
+        if (buffer)
+        {
+            releaseThreadBuffer(buffer);
+        }
+    }
+};
+
+thread_local ThreadBufferHolder threadBuffer;
+
+QMutex internMutex;
+QHash<QString, QByteArray*> internedStrings;
+
+#ifdef Q_OS_UNIX
+volatile sig_atomic_t dumpSignalled = 0;
+
+void handleDumpSignal(int)
+{
+    dumpSignalled = 1;
+}
+#endif
+
+void recycleThreadBuffer(ThreadBuffer *buffer)
+{
+    if (spareBuffers.size() < MAX_SPARE_BUFFERS)
+    {
+        spareBuffers.append(buffer);
+    }
+    else
+    {
+        delete buffer;
+    }
+}
+
+ThreadBuffer* createThreadBuffer()
+{
+    QString name;
+    QThread *thread = QThread::currentThread();
+    if (thread && !thread->objectName().isEmpty())
+    {
+        name = thread->objectName();
+    }
+    else if (QCoreApplication::instance() && (thread == QCoreApplication::instance()->thread()))
+    {
+        name = "main";
+    }
+    QMutexLocker locker(&buffersMutex);
+    ThreadBuffer *buffer = spareBuffers.isEmpty() ? new ThreadBuffer : spareBuffers.takeLast();
+    buffer->written.store(0);
+    buffer->exited = false;
+    // IDs aren't reused along with buffers, so a dump never shows two threads as one
+    buffer->threadId = nextThreadId++;
+    buffer->name = name.isEmpty() ? "thread " + QString::number(buffer->threadId) : name;
+    buffers.append(buffer);
+    return buffer;
+}
+
+void releaseThreadBuffer(ThreadBuffer *buffer)
+{
+    QMutexLocker locker(&buffersMutex);
+    buffer->exited = true;
+    int exited = 0;
+    for (int i = buffers.size() - 1; i >= 0; i--)
+    {
+        if (!buffers[i]->exited) continue;
+        // Threads that come and go without a dump in between shouldn't keep a buffer each forever
+        if (++exited > MAX_EXITED_BUFFERS)
+        {
+            recycleThreadBuffer(buffers.takeAt(i));
+        }
+    }
+}
+
+/* Copies the events out of every buffer. Buffers of threads that have exited aren't needed
+ * once their events are copied, so they are released for reuse.
+ */
+QList<ThreadSnapshot> takeSnapshot()
+{
+    QList<ThreadSnapshot> snapshot;
+    QMutexLocker locker(&buffersMutex);
+    QVector<TraceEvent> events(RING_CAPACITY);
+    for (ThreadBuffer *buffer : buffers)
+    {
+        // The thread keeps recording while this copies, so only keep events that were complete
+        // before the copy started and weren't written over while it was going on
+        quint64 end = buffer->written.load(std::memory_order_acquire);
+        quint64 first = end > RING_CAPACITY ? end - RING_CAPACITY : 0;
+        for (quint64 i = first; i < end; i++)
+        {
+            events[(int)(i - first)] = buffer->events[i % RING_CAPACITY];
+        }
+        quint64 after = buffer->written.load(std::memory_order_acquire);
+        quint64 start = first;
+        if (after + 1 > start + RING_CAPACITY)
+        {
+            start = after + 1 - RING_CAPACITY;
+        }
+
+        ThreadSnapshot thread;
+        thread.threadId = buffer->threadId;
+        thread.name = buffer->name;
+        if (start < end)
+        {
+            thread.events = events.mid((int)(start - first), (int)(end - start));
+        }
+        snapshot.append(thread);
+    }
+    for (int i = buffers.size() - 1; i >= 0; i--)
+    {
+        if (buffers[i]->exited)
+        {
+            recycleThreadBuffer(buffers.takeAt(i));
+        }
+    }
+    return snapshot;
+}
+
+void writeJsonString(QTextStream& stream, const char *string)
+{
+    stream << '"';
+    for (const char *c = string; *c; c++)
+    {
+        if ((*c == '"') || (*c == '\\')) stream << '\\';
+        if ((unsigned char)*c >= 0x20) stream << *c;
+    }
+    stream << '"';
+}
+
+bool writeSnapshot(QString path, QString processName, const QList<ThreadSnapshot>& snapshot)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        return false;
+    }
+    QTextStream stream(&file);
+    qint64 pid = QCoreApplication::applicationPid();
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    stream << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" << pid << ",\"tid\":0,\"args\":{\"name\":";
+    writeJsonString(stream, processName.toUtf8().constData());
+    stream << "}}";
+
+    for (const ThreadSnapshot& thread : snapshot)
+    {
+        stream << ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << pid << ",\"tid\":" << thread.threadId
+               << ",\"args\":{\"name\":";
+        writeJsonString(stream, thread.name.toUtf8().constData());
+        stream << "}}";
+
+        for (const TraceEvent& event : thread.events)
+        {
+            stream << ",\n{\"ph\":\"" << event.phase << "\",\"cat\":";
+            writeJsonString(stream, event.category);
+            stream << ",\"name\":";
+            writeJsonString(stream, event.name);
+            stream << ",\"pid\":" << pid << ",\"tid\":" << thread.threadId << ",\"ts\":" << event.timestamp;
+            if (event.phase == 'X')
+            {
+                stream << ",\"dur\":" << event.duration;
+            }
+            else if (event.phase == 'i')
+            {
+                stream << ",\"s\":\"t\"";
+            }
+            if (event.argName)
+            {
+                stream << ",\"args\":{";
+                writeJsonString(stream, event.argName);
+                stream << ":" << event.argValue << "}";
+            }
+            stream << "}";
+        }
+    }
+    stream << "\n]}\n";
+    stream.flush();
+    return file.error() == QFile::NoError;
+}
+
+} // namespace
+
+Tracer* Tracer::_root = new Tracer();
+std::atomic<bool> Tracer::_enabled(qgetenv("SORO_TRACE") != "0");
+
+Tracer::Tracer(QObject *parent) : QObject(parent)
+{
+    LOG_TAG = "Tracer";
+    _processName = "soro";
+}
+
+void Tracer::setEnabled(bool enabled)
+{
+    _enabled.store(enabled);
+}
+
+qint64 Tracer::now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void Tracer::record(char phase, const char *category, const char *name, qint64 timestamp,
+                    qint64 duration, const char *argName, qint64 argValue)
+{
+    ThreadBuffer *buffer = threadBuffer.buffer;
+    if (!buffer)
+    {
+        buffer = threadBuffer.buffer = createThreadBuffer();
+    }
+    quint64 index = buffer->written.load(std::memory_order_relaxed);
+    TraceEvent& event = buffer->events[index % RING_CAPACITY];
+    event.category = category;
+    event.name = name;
+    event.argName = argName;
+    event.argValue = argValue;
+    event.timestamp = timestamp;
+    event.duration = duration;
+    event.phase = phase;
+    buffer->written.store(index + 1, std::memory_order_release);
+}
+
+void Tracer::setThreadName(QString name)
+{
+    if (!threadBuffer.buffer)
+    {
+        threadBuffer.buffer = createThreadBuffer();
+    }
+    QMutexLocker locker(&buffersMutex);
+    threadBuffer.buffer->name = name;
+}
+
+const char* Tracer::intern(QString string)
+{
+    QMutexLocker locker(&internMutex);
+    QByteArray *interned = internedStrings.value(string, nullptr);
+    if (!interned)
+    {
+        // Never freed, names are only interned once for each thing that is traced
+        interned = new QByteArray(string.toUtf8());
+        internedStrings.insert(string, interned);
+    }
+    return interned->constData();
+}
+
+void Tracer::setDumpDirectory(QString directory, QString processName)
+{
+    _dumpDirectory = directory;
+    _processName = processName;
+}
+
+bool Tracer::writeJson(QString path) const
+{
+    return writeSnapshot(path, _processName, takeSnapshot());
+}
+
+void Tracer::dump(QString reason)
+{
+    QString directory = _dumpDirectory.isEmpty() ? QDir::currentPath() : _dumpDirectory;
+    QString path = directory + "/trace_" + _processName + "_"
+            + QDateTime::currentDateTime().toString("M-dd_h.mm.ss.zzz") + "_" + reason + ".json";
+    QString processName = _processName;
+    QString logTag = LOG_TAG;
+    // Copying the rings is quick, formatting and writing them out is not, and this is usually
+    // called on the main thread right when something is already going wrong
+    QList<ThreadSnapshot> snapshot = takeSnapshot();
+    Executor::root()->post([directory, path, processName, logTag, reason, snapshot]() -> bool
+    {
+        QElapsedTimer timer;
+        timer.start();
+        QDir().mkpath(directory);
+        if (!writeSnapshot(path, processName, snapshot))
+        {
+            LOG_E(logTag, "Cannot write trace to " + path);
+            return false;
+        }
+        LOG_I(logTag, "Wrote trace for " + reason + " to " + path + " in " + QString::number(timer.elapsed()) + "ms");
+        return true;
+    }, this, [this, path, reason](bool written)
+    {
+        if (written)
+        {
+            Q_EMIT dumped(path, reason);
+        }
+    }, Executor::LowPriority);
+}
+
+void Tracer::dumpOnAnomaly(QString reason)
+{
+    if (!isEnabled()) return;
+    if (_lastAnomalyDump.isValid() && (_lastAnomalyDump.elapsed() < MIN_ANOMALY_DUMP_INTERVAL))
+    {
+        LOG_D(LOG_TAG, "Not dumping a trace for " + reason + ", there was one recently");
+        return;
+    }
+    _lastAnomalyDump.start();
+    dump(reason);
+}
+
+void Tracer::installSignalHandler()
+{
+#ifdef Q_OS_UNIX
+    // Only a flag can be touched safely from a signal handler, so it is polled from the event loop
+    signal(SIGUSR1, handleDumpSignal);
+    START_TIMER(_signalTimerId, SIGNAL_POLL_INTERVAL);
+#endif
+}
+
+void Tracer::timerEvent(QTimerEvent *e)
+{
+    QObject::timerEvent(e);
+#ifdef Q_OS_UNIX
+    if ((e->timerId() == _signalTimerId) && dumpSignalled)
+    {
+        dumpSignalled = 0;
+        LOG_I(LOG_TAG, "Received SIGUSR1, dumping trace");
+        Q_EMIT dumpRequested();
+    }
+#endif
+}
+
+} // namespace Soro
@@ -0,0 +1,154 @@
+#ifndef SORO_TRACER_H
+#define SORO_TRACER_H
+
+#include <QtCore>
+#include <atomic>
+
+#include "soro_core_global.h"
+#include "constants.h"
+
+#define SORO_TRACE_CONCAT_(A, B) A##B
+#define SORO_TRACE_CONCAT(A, B) SORO_TRACE_CONCAT_(A, B)
+
+/* These macros record trace events to the calling thread's ring buffer. Category and name
+ * must be string literals (or strings from Tracer::intern()), since only the pointers are kept.
+ */
+#define TRACE_SPAN(Category, Name) Soro::TraceSpan SORO_TRACE_CONCAT(_traceSpan, __LINE__)(Category, Name)
+#define TRACE_SPAN_ARG(Category, Name, ArgName, ArgValue) \
+    Soro::TraceSpan SORO_TRACE_CONCAT(_traceSpan, __LINE__)(Category, Name, ArgName, ArgValue)
+#define TRACE_INSTANT(Category, Name) \
+    do { if (Soro::Tracer::isEnabled()) Soro::Tracer::record('i', Category, Name, Soro::Tracer::now()); } while (0)
+#define TRACE_BEGIN(Category, Name) \
+    do { if (Soro::Tracer::isEnabled()) Soro::Tracer::record('B', Category, Name, Soro::Tracer::now()); } while (0)
+#define TRACE_END(Category, Name) \
+    do { if (Soro::Tracer::isEnabled()) Soro::Tracer::record('E', Category, Name, Soro::Tracer::now()); } while (0)
+
+namespace Soro {
+
+/* Low overhead tracing of what each thread is doing, for tracking down stutters and stalls.
+ *
+ * Every thread records events to its own fixed size ring buffer without taking any locks,
+ * so recording is always on and the last few seconds before a problem can be dumped after
+ * the fact. Dumps are written in the Chrome trace event format, which opens in Perfetto
+ * (ui.perfetto.dev) or chrome://tracing.
+ *
+ * Timestamps are microseconds since the epoch, so dumps taken on the rover and mission
+ * control at the same time can be loaded together and lined up (as well as their clocks are).
+ *
+ * A dump can be taken with dump(), on an anomaly with dumpOnAnomaly() (which won't dump
+ * more than once a minute), or by sending the process SIGUSR1 once installSignalHandler()
+ * has been called, which emits dumpRequested(). Dumps are written out on the executor, so
+ * taking one doesn't stall the thread that noticed the problem.
+ *
+ * Setting the SORO_TRACE environment variable to 0 turns recording off.
+ */
+class SORO_CORE_EXPORT Tracer: public QObject {
+    Q_OBJECT
+public:
+    /* Gets the process-wide tracer
+     */
+    static inline Tracer* root() {
+        return _root;
+    }
+
+    static inline bool isEnabled() {
+        return _enabled.load(std::memory_order_relaxed);
+    }
+
+    static void setEnabled(bool enabled);
+
+    /* Gets the current time in microseconds since the epoch
+     */
+    static qint64 now();
+
+    /* Records an event. Phase is 'X' (a complete span with a duration), 'i' (an instant),
+     * or 'B'/'E' (the beginning and end of a span recorded separately, on the same thread).
+     */
+    static void record(char phase, const char *category, const char *name, qint64 timestamp,
+                       qint64 duration=0, const char *argName=nullptr, qint64 argValue=0);
+
+    /* Names the calling thread in dumps. Threads are otherwise named after their QThread's
+     * object name, if they have one.
+     */
+    static void setThreadName(QString name);
+
+    /* Gets a copy of a string that lives as long as the process, for use as an event name
+     */
+    static const char* intern(QString string);
+
+    /* Sets where dump() and dumpOnAnomaly() write to, and the name the process is given in them
+     */
+    void setDumpDirectory(QString directory, QString processName);
+
+    /* Copies everything in the ring buffers, and writes it to a new file in the dump directory
+     * on the executor. Emits dumped() once the file has been written.
+     */
+    void dump(QString reason);
+
+    /* Dumps because something went wrong, unless there was already a dump for an anomaly
+     * in the last minute
+     */
+    void dumpOnAnomaly(QString reason);
+
+    /* Writes everything in the ring buffers to a file right away, on the calling thread
+     */
+    bool writeJson(QString path) const;
+
+    /* Emits dumpRequested() whenever the process receives SIGUSR1 (on Unix)
+     */
+    void installSignalHandler();
+
+Q_SIGNALS:
+    void dumpRequested();
+    void dumped(QString path, QString reason);
+
+protected:
+    void timerEvent(QTimerEvent *e);
+
+private:
+    Tracer(QObject *parent = nullptr);
+
+    static Tracer *_root;
+    static std::atomic<bool> _enabled;
+
+    QString LOG_TAG;
+    QString _dumpDirectory;
+    QString _processName;
+    QElapsedTimer _lastAnomalyDump;
+    int _signalTimerId = TIMER_INACTIVE;
+};
+
+/* Records a span covering its own lifetime, use the TRACE_SPAN macros rather than this directly
+ */
+class TraceSpan {
+public:
+    inline TraceSpan(const char *category, const char *name, const char *argName=nullptr, qint64 argValue=0)
+        : _category(category), _name(name), _argName(argName), _argValue(argValue)
+    {
+        _start = Tracer::isEnabled() ? Tracer::now() : -1;
+    }
+
+    inline ~TraceSpan()
+    {
+        if (_start >= 0)
+        {
+            Tracer::record('X', _category, _name, _start, Tracer::now() - _start, _argName, _argValue);
+        }
+    }
+
+    inline void setArg(qint64 value)
+    {
+        _argValue = value;
+    }
+
+private:
+    const char *_category;
+    const char *_name;
+    const char *_argName;
+    qint64 _argValue;
+    qint64 _start;
+};
+
+} // namespace Soro
+
+#endif // SORO_TRACER_H
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "unixdatagramtransport.h"
+
+#include <QCoreApplication>
+#include <QFile>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <cstring>
+#include <cstddef>
+
+namespace Soro {
+
+static bool makeUnixAddress(const QString& path, sockaddr_un *addr)
+{
+    QByteArray encoded = QFile::encodeName(path);
+    if ((size_t)encoded.size() >= sizeof(addr->sun_path)) return false;
+    memset(addr, 0, sizeof(sockaddr_un));
+    addr->sun_family = AF_UNIX;
+    memcpy(addr->sun_path, encoded.constData(), encoded.size());
+    return true;
+}
+
+UnixDatagramTransport::UnixDatagramTransport(const QString& path, bool server, QObject *parent)
+    : ChannelTransport(path, server, parent)
+{
+    static int clientCount = 0;
+    if (_server)
+    {
+        _bindPath = path;
+    }
+    else
+    {
+        _bindPath = path + "." + QString::number(QCoreApplication::applicationPid()) + "." + QString::number(clientCount++);
+        _peer = path;
+    }
+}
+
+UnixDatagramTransport::~UnixDatagramTransport()
+{
+    close();
+}
+
+bool UnixDatagramTransport::isStream() const
+{
+    return false;
+}
+
+bool UnixDatagramTransport::open()
+{
+    close();
+    sockaddr_un addr;
+    if (!makeUnixAddress(_bindPath, &addr))
+    {
+        setError("Socket path is too long: " + _bindPath);
+        return false;
+    }
+    _fd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (_fd < 0)
+    {
+        setError(QString("socket() failed: ") + strerror(errno));
+        return false;
+    }
+    ::fcntl(_fd, F_SETFL, ::fcntl(_fd, F_GETFL) | O_NONBLOCK);
+    // Clean up a stale socket file left behind by a crashed process
+    ::unlink(addr.sun_path);
+    if (::bind(_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        QString message = QString("bind() failed: ") + strerror(errno);
+        close();
+        setError(message);
+        return false;
+    }
+    _notifier = new QSocketNotifier(_fd, QSocketNotifier::Read, this);
+    connect(_notifier, &QSocketNotifier::activated, this, &UnixDatagramTransport::readyRead);
+    return true;
+}
+
+void UnixDatagramTransport::abort()
+{
+    if (_server)
+    {
+        _peer.clear();
+    }
+}
+
+void UnixDatagramTransport::close()
+{
+    if (_notifier)
+    {
+        _notifier->setEnabled(false);
+        _notifier->deleteLater();
+        _notifier = nullptr;
+    }
+    if (_fd >= 0)
+    {
+        ::close(_fd);
+        _fd = -1;
+        ::unlink(QFile::encodeName(_bindPath).constData());
+    }
+    abort();
+}
+
+bool UnixDatagramTransport::hasPendingDatagrams() const
+{
+    if (_fd < 0) return false;
+    char c;
+    return ::recv(_fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) >= 0;
+}
+
+qint64 UnixDatagramTransport::readDatagram(char *data, qint64 maxLength, QString *sender)
+{
+    if (_fd < 0) return -1;
+    sockaddr_un from;
+    socklen_t fromLength = sizeof(from);
+    memset(&from, 0, sizeof(from));
+    ssize_t status = ::recvfrom(_fd, data, (size_t)maxLength, MSG_DONTWAIT, reinterpret_cast<sockaddr*>(&from), &fromLength);
+    if (status < 0)
+    {
+        if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
+        {
+            setError(QString("recvfrom() failed: ") + strerror(errno));
+        }
+        return -1;
+    }
+    if (sender)
+    {
+        *sender = fromLength > offsetof(sockaddr_un, sun_path) ? QFile::decodeName(from.sun_path) : QString();
+    }
+    return status;
+}
+
+qint64 UnixDatagramTransport::writeDatagram(const char *data, qint64 length)
+{
+    if ((_fd < 0) || _peer.isEmpty()) return -1;
+    sockaddr_un to;
+    if (!makeUnixAddress(_peer, &to)) return -1;
+    ssize_t status = ::sendto(_fd, data, (size_t)length, MSG_DONTWAIT, reinterpret_cast<sockaddr*>(&to), sizeof(to));
+    if (status < 0)
+    {
+        // ECONNREFUSED/ENOENT just mean the other side is not up (yet), which the channel
+        // handles through its handshake and idle timeouts like a lost UDP packet
+        if ((errno != ECONNREFUSED) && (errno != ENOENT) && (errno != EAGAIN) && (errno != EWOULDBLOCK))
+        {
+            setError(QString("sendto() failed: ") + strerror(errno));
+        }
+        return -1;
+    }
+    return status;
+}
+
+} // namespace Soro
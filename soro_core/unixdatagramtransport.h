@@ -0,0 +1,39 @@
+#ifndef SORO_UNIXDATAGRAMTRANSPORT_H
+#define SORO_UNIXDATAGRAMTRANSPORT_H
+
+#include <QSocketNotifier>
+
+#include "soro_core_global.h"
+#include "channeltransport.h"
+
+namespace Soro {
+
+/* Unix-domain datagram socket transport (unixdgram:<path>), the same-host replacement
+ * for a UDP channel.
+ *
+ * The server binds to <path>. Clients bind to their own path (<path>.<pid>.<n>) so the
+ * server has somewhere to reply to.
+ */
+class SORO_CORE_EXPORT UnixDatagramTransport: public ChannelTransport {
+    Q_OBJECT
+public:
+    UnixDatagramTransport(const QString& path, bool server, QObject *parent);
+    ~UnixDatagramTransport();
+
+    bool isStream() const Q_DECL_OVERRIDE;
+    bool open() Q_DECL_OVERRIDE;
+    void abort() Q_DECL_OVERRIDE;
+    void close() Q_DECL_OVERRIDE;
+    bool hasPendingDatagrams() const Q_DECL_OVERRIDE;
+    qint64 readDatagram(char *data, qint64 maxLength, QString *sender=nullptr) Q_DECL_OVERRIDE;
+    qint64 writeDatagram(const char *data, qint64 length) Q_DECL_OVERRIDE;
+
+private:
+    int _fd = -1;
+    QString _bindPath;
+    QSocketNotifier *_notifier = nullptr;
+};
+
+} // namespace Soro
+
+#endif // SORO_UNIXDATAGRAMTRANSPORT_H
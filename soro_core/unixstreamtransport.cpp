@@ -0,0 +1,147 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "unixstreamtransport.h"
+
+namespace Soro {
+
+UnixStreamTransport::UnixStreamTransport(const QString& path, bool server, QObject *parent)
+    : ChannelTransport(path, server, parent)
+{
+    if (_server)
+    {
+        _localServer = new QLocalServer(this);
+        _localServer->setMaxPendingConnections(1);
+        connect(_localServer, &QLocalServer::newConnection, this, &UnixStreamTransport::newClient);
+    }
+    else
+    {
+        _localSocket = new QLocalSocket(this);
+        configureNewSocket();
+    }
+}
+
+bool UnixStreamTransport::isStream() const
+{
+    return true;
+}
+
+void UnixStreamTransport::configureNewSocket()
+{
+    if (_localSocket)
+    {
+        connect(_localSocket, &QLocalSocket::readyRead, this, &UnixStreamTransport::readyRead);
+        connect(_localSocket, &QLocalSocket::connected, this, &UnixStreamTransport::connected);
+        connect(_localSocket, static_cast<void (QLocalSocket::*)(QLocalSocket::LocalSocketError)>(&QLocalSocket::error),
+                this, &UnixStreamTransport::socketError);
+    }
+}
+
+bool UnixStreamTransport::open()
+{
+    if (_server)
+    {
+        if (!_localServer->isListening())
+        {
+            // Clean up a stale socket file left behind by a crashed process
+            QLocalServer::removeServer(_address);
+            if (!_localServer->listen(_address))
+            {
+                setError(_localServer->errorString());
+                return false;
+            }
+        }
+        if (_localServer->hasPendingConnections())
+        {
+            newClient();
+        }
+        return true;
+    }
+    _localSocket->abort();
+    _peer = _address;
+    _localSocket->connectToServer(_address, QIODevice::ReadWrite);
+    return true;
+}
+
+void UnixStreamTransport::dropSocket()
+{
+    if (_localSocket)
+    {
+        disconnect(_localSocket, 0, this, 0);
+        _localSocket->abort();
+        _localSocket->deleteLater();
+        _localSocket = nullptr;
+    }
+}
+
+void UnixStreamTransport::abort()
+{
+    if (_server)
+    {
+        dropSocket();
+        _peer.clear();
+    }
+    else
+    {
+        _localSocket->abort();
+    }
+}
+
+void UnixStreamTransport::close()
+{
+    abort();
+    if (_localServer)
+    {
+        _localServer->close();
+    }
+}
+
+QIODevice* UnixStreamTransport::device()
+{
+    return _localSocket;
+}
+
+void UnixStreamTransport::flush()
+{
+    if (_localSocket)
+    {
+        _localSocket->flush();
+    }
+}
+
+void UnixStreamTransport::newClient()
+{
+    dropSocket();
+    _localSocket = _localServer->nextPendingConnection();
+    if (_localSocket)
+    {
+        _peer = _address + "#" + QString::number(_localSocket->socketDescriptor());
+        configureNewSocket();
+        Q_EMIT connected();
+        if (_localSocket->bytesAvailable() > 0)
+        {
+            Q_EMIT readyRead();
+        }
+    }
+}
+
+void UnixStreamTransport::socketError(QLocalSocket::LocalSocketError err)
+{
+    Q_UNUSED(err);
+    setError(_localSocket ? _localSocket->errorString() : "Local socket error");
+}
+
+} // namespace Soro
@@ -0,0 +1,41 @@
+#ifndef SORO_UNIXSTREAMTRANSPORT_H
+#define SORO_UNIXSTREAMTRANSPORT_H
+
+#include <QLocalServer>
+#include <QLocalSocket>
+
+#include "soro_core_global.h"
+#include "channeltransport.h"
+
+namespace Soro {
+
+/* Unix-domain stream socket transport (unix:<path>), the same-host replacement
+ * for a TCP channel. Only one peer is served at a time, newer clients replace older ones.
+ */
+class SORO_CORE_EXPORT UnixStreamTransport: public ChannelTransport {
+    Q_OBJECT
+public:
+    UnixStreamTransport(const QString& path, bool server, QObject *parent);
+
+    bool isStream() const Q_DECL_OVERRIDE;
+    bool open() Q_DECL_OVERRIDE;
+    void abort() Q_DECL_OVERRIDE;
+    void close() Q_DECL_OVERRIDE;
+    QIODevice* device() Q_DECL_OVERRIDE;
+    void flush() Q_DECL_OVERRIDE;
+
+private:
+    QLocalServer *_localServer = nullptr;
+    QLocalSocket *_localSocket = nullptr;
+
+    void configureNewSocket();
+    void dropSocket();
+
+private Q_SLOTS:
+    void newClient();
+    void socketError(QLocalSocket::LocalSocketError err);
+};
+
+} // namespace Soro
+
+#endif // SORO_UNIXSTREAMTRANSPORT_H
@@ -0,0 +1,357 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "videogovernor.h"
+#include "logger.h"
+
+#include <climits>
+
+//throttle temperature used when none is set and no thermal zone has a passive trip point
+#define DEFAULT_THROTTLE_TEMPERATURE 85000
+#define DEFAULT_MARGIN 10000
+#define DEFAULT_HYSTERESIS 5000
+#define DEFAULT_MAX_LOAD 950
+#define DEFAULT_MAX_FRAME_DEFICIT 20
+#define DEFAULT_STEP_DOWN_DELAY 15000
+#define DEFAULT_STEP_UP_DELAY 30000
+//frame deficits not reported again in this many sample intervals are from streams that stopped
+#define FRAME_DEFICIT_EXPIRY_INTERVALS 3
+
+namespace Soro {
+
+/* Framerate is given up first, since the operators can still see everything at a lower framerate,
+ * then resolution once framerate is down to half
+ */
+static const int LEVEL_FRAMERATE_PERCENT[] = { 100, 75, 50, 50, 50 };
+static const int LEVEL_RESOLUTION_PERCENT[] = { 100, 100, 100, 75, 50 };
+static const int LEVEL_COUNT = sizeof(LEVEL_FRAMERATE_PERCENT) / sizeof(LEVEL_FRAMERATE_PERCENT[0]);
+
+VideoGovernorState::VideoGovernorState()
+{
+    level = 0;
+    frameratePercent = 100;
+    resolutionPercent = 100;
+    temperature = NoTemperature;
+    throttleTemperature = 0;
+    load = 0;
+    frameDeficit = 0;
+}
+
+QDataStream& operator<<(QDataStream& stream, const VideoGovernorState& state)
+{
+    stream << state.level << state.frameratePercent << state.resolutionPercent << state.temperature
+           << state.throttleTemperature << state.load << state.frameDeficit << state.reason;
+    return stream;
+}
+
+QDataStream& operator>>(QDataStream& stream, VideoGovernorState& state)
+{
+    stream >> state.level >> state.frameratePercent >> state.resolutionPercent >> state.temperature
+           >> state.throttleTemperature >> state.load >> state.frameDeficit >> state.reason;
+    return stream;
+}
+
+VideoGovernor::VideoGovernor(QObject *parent) : QObject(parent)
+{
+    LOG_TAG = "VideoGovernor";
+    _thermalPath = "/sys/class/thermal";
+    _cpuStatPath = "/proc/stat";
+    _margin = DEFAULT_MARGIN;
+    _hysteresis = DEFAULT_HYSTERESIS;
+    _maxLoad = DEFAULT_MAX_LOAD;
+    _maxFrameDeficit = DEFAULT_MAX_FRAME_DEFICIT;
+    _stepDownDelay = DEFAULT_STEP_DOWN_DELAY;
+    _stepUpDelay = DEFAULT_STEP_UP_DELAY;
+    _clock.start();
+}
+
+void VideoGovernor::start(int interval)
+{
+    KILL_TIMER(_sampleTimerId);
+    _interval = interval;
+    // Load is measured from the first sample on
+    _lastCpuBusy = _lastCpuTotal = 0;
+    START_TIMER(_sampleTimerId, interval);
+    LOG_I(LOG_TAG, "Sampling every " + QString::number(interval) + "ms");
+}
+
+void VideoGovernor::stop()
+{
+    KILL_TIMER(_sampleTimerId);
+    _frameDeficits.clear();
+    if (_state.level != 0)
+    {
+        setLevel(0, "stopped", _clock.elapsed());
+    }
+}
+
+bool VideoGovernor::isRunning() const
+{
+    return _sampleTimerId != TIMER_INACTIVE;
+}
+
+void VideoGovernor::setThermalPath(const QString& path)
+{
+    _thermalPath = path;
+    _warnedNoThermal = false;
+}
+
+void VideoGovernor::setCpuStatPath(const QString& path)
+{
+    _cpuStatPath = path;
+    _lastCpuBusy = _lastCpuTotal = 0;
+}
+
+void VideoGovernor::setThrottleTemperature(qint32 temperature)
+{
+    _throttleTemperature = temperature;
+}
+
+void VideoGovernor::setMargin(qint32 margin)
+{
+    _margin = margin;
+}
+
+void VideoGovernor::setHysteresis(qint32 hysteresis)
+{
+    _hysteresis = hysteresis;
+}
+
+void VideoGovernor::setMaxLoad(int load)
+{
+    _maxLoad = load;
+}
+
+void VideoGovernor::setMaxFrameDeficit(int percent)
+{
+    _maxFrameDeficit = percent;
+}
+
+void VideoGovernor::setStepDownDelay(int delay)
+{
+    _stepDownDelay = delay;
+}
+
+void VideoGovernor::setStepUpDelay(int delay)
+{
+    _stepUpDelay = delay;
+}
+
+int VideoGovernor::getLevel() const
+{
+    return _state.level;
+}
+
+VideoGovernorState VideoGovernor::getState() const
+{
+    return _state;
+}
+
+int VideoGovernor::getLevelCount()
+{
+    return LEVEL_COUNT;
+}
+
+int VideoGovernor::getFrameratePercent(int level)
+{
+    return LEVEL_FRAMERATE_PERCENT[qBound(0, level, LEVEL_COUNT - 1)];
+}
+
+int VideoGovernor::getResolutionPercent(int level)
+{
+    return LEVEL_RESOLUTION_PERCENT[qBound(0, level, LEVEL_COUNT - 1)];
+}
+
+void VideoGovernor::reportFrameDeficit(int streamId, int percent)
+{
+    FrameDeficit deficit;
+    deficit.percent = qBound(0, percent, 100);
+    deficit.time = _clock.elapsed();
+    _frameDeficits.insert(streamId, deficit);
+}
+
+void VideoGovernor::timerEvent(QTimerEvent *e)
+{
+    QObject::timerEvent(e);
+    if (e->timerId() == _sampleTimerId)
+    {
+        sample();
+    }
+}
+
+void VideoGovernor::sample()
+{
+    qint64 now = _clock.elapsed();
+    qint32 throttleTemperature;
+    qint32 temperature = readTemperature(&throttleTemperature);
+    int load = readLoad();
+    int frameDeficit = currentFrameDeficit(now);
+
+    _state.temperature = temperature;
+    _state.throttleTemperature = throttleTemperature;
+    _state.load = static_cast<quint16>(qBound(0, load, 65535));
+    _state.frameDeficit = static_cast<quint8>(frameDeficit);
+
+    bool hasTemperature = temperature != VideoGovernorState::NoTemperature;
+    QString pressure;
+    if (hasTemperature && (temperature >= throttleTemperature - _margin))
+    {
+        pressure = "temperature " + QString::number(temperature / 1000.0, 'f', 1) + "C";
+    }
+    else if ((_maxLoad > 0) && (load >= _maxLoad))
+    {
+        pressure = "load " + QString::number(load / 10.0, 'f', 1) + "%";
+    }
+    else if ((_maxFrameDeficit > 0) && (frameDeficit >= _maxFrameDeficit))
+    {
+        pressure = "frame deficit " + QString::number(frameDeficit) + "%";
+    }
+
+    if (!pressure.isEmpty())
+    {
+        _lastPressure = now;
+        if ((_state.level < LEVEL_COUNT - 1) && ((_lastLevelChange < 0) || (now - _lastLevelChange >= _stepDownDelay)))
+        {
+            setLevel(_state.level + 1, pressure, now);
+        }
+    }
+    else if (_state.level > 0)
+    {
+        bool cool = !hasTemperature || (temperature < throttleTemperature - _margin - _hysteresis);
+        bool idle = (_maxLoad <= 0) || (load < _maxLoad * 3 / 4);
+        bool keepingUp = (_maxFrameDeficit <= 0) || (frameDeficit < _maxFrameDeficit / 2);
+        if (cool && idle && keepingUp && (now - _lastPressure >= _stepUpDelay) && (now - _lastLevelChange >= _stepUpDelay))
+        {
+            setLevel(_state.level - 1, "recovered", now);
+        }
+    }
+
+    Q_EMIT sampled(_state);
+}
+
+qint32 VideoGovernor::readTemperature(qint32 *throttleTemperature)
+{
+    qint32 hottest = VideoGovernorState::NoTemperature;
+    qint32 lowestTrip = INT_MAX;
+    QDir thermal(_thermalPath);
+    for (const QString& zone : thermal.entryList(QStringList() << "thermal_zone*", QDir::Dirs | QDir::NoDotAndDotDot))
+    {
+        QDir zoneDir(thermal.filePath(zone));
+        QFile tempFile(zoneDir.filePath("temp"));
+        if (tempFile.open(QIODevice::ReadOnly))
+        {
+            bool ok;
+            qint32 temperature = QString::fromLatin1(tempFile.readAll()).trimmed().toInt(&ok);
+            if (ok) hottest = qMax(hottest, temperature);
+        }
+        if (_throttleTemperature > 0) continue;
+
+        for (const QString& typeName : zoneDir.entryList(QStringList() << "trip_point_*_type", QDir::Files))
+        {
+            QFile typeFile(zoneDir.filePath(typeName));
+            if (!typeFile.open(QIODevice::ReadOnly)) continue;
+            if (QString::fromLatin1(typeFile.readAll()).trimmed() != "passive") continue;
+
+            QString tempName = typeName.left(typeName.length() - QString("type").length()) + "temp";
+            QFile tripFile(zoneDir.filePath(tempName));
+            if (!tripFile.open(QIODevice::ReadOnly)) continue;
+            bool ok;
+            qint32 trip = QString::fromLatin1(tripFile.readAll()).trimmed().toInt(&ok);
+            if (ok && (trip > 0)) lowestTrip = qMin(lowestTrip, trip);
+        }
+    }
+
+    if (_throttleTemperature > 0)
+    {
+        *throttleTemperature = _throttleTemperature;
+    }
+    else
+    {
+        *throttleTemperature = lowestTrip == INT_MAX ? DEFAULT_THROTTLE_TEMPERATURE : lowestTrip;
+    }
+
+    if ((hottest == VideoGovernorState::NoTemperature) && !_warnedNoThermal)
+    {
+        LOG_W(LOG_TAG, "No readable thermal zones in " + _thermalPath + ", governing on load and frame deficit only");
+        _warnedNoThermal = true;
+    }
+    return hottest;
+}
+
+int VideoGovernor::readLoad()
+{
+    QFile file(_cpuStatPath);
+    if (!file.open(QIODevice::ReadOnly)) return 0;
+    // The first line adds up every core: cpu user nice system idle iowait irq softirq steal guest guest_nice.
+    // Guest time is already counted in user time, so it's left out.
+    QStringList fields = QString::fromLatin1(file.readLine()).simplified().split(' ');
+    if ((fields.size() < 5) || (fields[0] != "cpu")) return 0;
+    quint64 total = 0;
+    quint64 idle = 0;
+    for (int i = 1; (i < fields.size()) && (i <= 8); i++)
+    {
+        bool ok;
+        quint64 ticks = fields[i].toULongLong(&ok);
+        if (!ok) return 0;
+        total += ticks;
+        if ((i == 4) || (i == 5)) idle += ticks;
+    }
+    quint64 busy = total - idle;
+
+    int load = 0;
+    // Nothing to compare the first sample to
+    if ((_lastCpuTotal > 0) && (total > _lastCpuTotal) && (busy >= _lastCpuBusy))
+    {
+        load = static_cast<int>((busy - _lastCpuBusy) * 1000 / (total - _lastCpuTotal));
+    }
+    _lastCpuBusy = busy;
+    _lastCpuTotal = total;
+    return load;
+}
+
+int VideoGovernor::currentFrameDeficit(qint64 now)
+{
+    int largest = 0;
+    QMutableHashIterator<int, FrameDeficit> i(_frameDeficits);
+    while (i.hasNext())
+    {
+        i.next();
+        if ((_interval > 0) && (now - i.value().time > _interval * FRAME_DEFICIT_EXPIRY_INTERVALS))
+        {
+            i.remove();
+            continue;
+        }
+        largest = qMax(largest, i.value().percent);
+    }
+    return largest;
+}
+
+void VideoGovernor::setLevel(int level, const QString& reason, qint64 now)
+{
+    _state.level = static_cast<quint8>(level);
+    _state.frameratePercent = static_cast<quint8>(getFrameratePercent(level));
+    _state.resolutionPercent = static_cast<quint8>(getResolutionPercent(level));
+    _state.reason = reason;
+    _lastLevelChange = now;
+    // The streams restart at the new level, so anything they reported before is stale
+    _frameDeficits.clear();
+
+    LOG_I(LOG_TAG, "Video at level " + QString::number(level) + " (" + QString::number(_state.frameratePercent)
+          + "% framerate, " + QString::number(_state.resolutionPercent) + "% resolution): " + reason);
+    Q_EMIT levelChanged(level);
+}
+
+} // namespace Soro
@@ -0,0 +1,161 @@
+#ifndef SORO_VIDEOGOVERNOR_H
+#define SORO_VIDEOGOVERNOR_H
+
+#include <QtCore>
+#include <QDataStream>
+
+#include "soro_core_global.h"
+#include "constants.h"
+
+namespace Soro {
+
+/* One sample of what the video governor is seeing and what it has decided, small enough to send
+ * to mission control every few seconds.
+ *
+ * Temperatures are in thousandths of a degree Celsius as the kernel reports them, and load is
+ * the share of time every core spent busy since the previous sample, in thousandths, so a fully
+ * busy CPU is at 1000.
+ */
+struct SORO_CORE_EXPORT VideoGovernorState {
+
+    /* Temperature used when no thermal zone could be read
+     */
+    static const qint32 NoTemperature = -273150;
+
+    /* How far video is stepped down, from 0 (as configured) to VideoGovernor::getLevelCount() - 1
+     */
+    quint8 level;
+    quint8 frameratePercent;
+    quint8 resolutionPercent;
+    /* Hottest thermal zone, or NoTemperature
+     */
+    qint32 temperature;
+    /* Temperature the CPU starts throttling at
+     */
+    qint32 throttleTemperature;
+    quint16 load;
+    /* Largest percentage of frames any video stream is failing to deliver
+     */
+    quint8 frameDeficit;
+    /* Why the level last changed
+     */
+    QString reason;
+
+    VideoGovernorState();
+
+    friend QDataStream& operator<<(QDataStream& stream, const VideoGovernorState& state);
+    friend QDataStream& operator>>(QDataStream& stream, VideoGovernorState& state);
+};
+
+/* Steps the rover's video framerate and then resolution down when the CPU gets close to thermal
+ * throttling, is overloaded, or can't keep up with the streams, and back up once it recovers.
+ *
+ * Temperature comes from every thermal_zone* under the thermal path (/sys/class/thermal), and the
+ * throttle temperature from their lowest passive trip point unless one is set. Load comes from
+ * the difference between the CPU time counters in the CPU stat file (/proc/stat) at consecutive
+ * samples, so it follows the last sample interval rather than lagging a minute behind like the
+ * load average. Both paths can be pointed at synthetic files to see how the governor reacts.
+ *
+ * Video is stepped down one level per sample while any of these hold, at most once per step down
+ * delay so each new level has time to take effect:
+ * - the temperature is within the margin of the throttle temperature
+ * - the load is at the maximum load
+ * - a stream's frame deficit is at the maximum deficit
+ *
+ * It is stepped back up one level only once the temperature is a further hysteresis below that,
+ * load is under three quarters of the maximum, frame deficit is under half the maximum, and none
+ * of them have been a problem for the step up delay.
+ */
+class SORO_CORE_EXPORT VideoGovernor: public QObject {
+    Q_OBJECT
+public:
+    explicit VideoGovernor(QObject *parent = nullptr);
+
+    /* Starts sampling every interval milliseconds
+     */
+    void start(int interval);
+
+    /* Stops sampling and returns video to level 0
+     */
+    void stop();
+    bool isRunning() const;
+
+    void setThermalPath(const QString& path);
+    void setCpuStatPath(const QString& path);
+
+    /* Sets the temperature throttling starts at, or 0 to read it from the thermal zones' trip points
+     */
+    void setThrottleTemperature(qint32 temperature);
+    void setMargin(qint32 margin);
+    void setHysteresis(qint32 hysteresis);
+    /* Sets the maximum load, or 0 to ignore load
+     */
+    void setMaxLoad(int load);
+    /* Sets the maximum frame deficit in percent, or 0 to ignore frame deficits
+     */
+    void setMaxFrameDeficit(int percent);
+    void setStepDownDelay(int delay);
+    void setStepUpDelay(int delay);
+
+    int getLevel() const;
+    VideoGovernorState getState() const;
+
+    static int getLevelCount();
+    static int getFrameratePercent(int level);
+    static int getResolutionPercent(int level);
+
+public Q_SLOTS:
+    /* Reports the percentage of frames a stream is failing to deliver. Reports are dropped whenever
+     * the level changes, as the streams restart, and expire if a stream stops reporting.
+     */
+    void reportFrameDeficit(int streamId, int percent);
+
+    /* Takes a sample and steps the level if needed, without waiting for the timer
+     */
+    void sample();
+
+Q_SIGNALS:
+    void sampled(const VideoGovernorState& state);
+    void levelChanged(int level);
+
+protected:
+    void timerEvent(QTimerEvent *e) Q_DECL_OVERRIDE;
+
+private:
+    struct FrameDeficit {
+        int percent;
+        qint64 time;
+    };
+
+    QString LOG_TAG;
+    int _sampleTimerId = TIMER_INACTIVE;
+    int _interval = 0;
+    QElapsedTimer _clock;
+    QString _thermalPath;
+    QString _cpuStatPath;
+    quint64 _lastCpuBusy = 0;
+    quint64 _lastCpuTotal = 0;
+    qint32 _throttleTemperature = 0;
+    qint32 _margin = 0;
+    qint32 _hysteresis = 0;
+    int _maxLoad = 0;
+    int _maxFrameDeficit = 0;
+    int _stepDownDelay = 0;
+    int _stepUpDelay = 0;
+    qint64 _lastLevelChange = -1;
+    qint64 _lastPressure = 0;
+    bool _warnedNoThermal = false;
+    QHash<int, FrameDeficit> _frameDeficits;
+    VideoGovernorState _state;
+
+    qint32 readTemperature(qint32 *throttleTemperature);
+    int readLoad();
+    int currentFrameDeficit(qint64 now);
+    void setLevel(int level, const QString& reason, qint64 now);
+};
+
+} // namespace Soro
+
+Q_DECLARE_METATYPE(Soro::VideoGovernorState)
+
+#endif // SORO_VIDEOGOVERNOR_H
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "virtualclock.h"
+
+//virtual timer IDs start well above anything Qt hands out, so the two can't be confused
+#define FIRST_TIMER_ID 0x40000000
+
+namespace Soro {
+
+VirtualClock::VirtualClock(qint64 start)
+{
+    _now = start;
+    _nextTimerId = FIRST_TIMER_ID;
+}
+
+VirtualClock::~VirtualClock() { }
+
+qint64 VirtualClock::msecsSinceEpoch() const
+{
+    return _now;
+}
+
+int VirtualClock::startTimer(QObject *receiver, int interval)
+{
+    return addTimer(receiver, interval, false, nullptr);
+}
+
+void VirtualClock::killTimer(QObject *receiver, int timerId)
+{
+    Q_UNUSED(receiver);
+    removeTimer(timerId);
+}
+
+void VirtualClock::singleShot(int msec, QObject *context, std::function<void()> functor)
+{
+    addTimer(context, msec, true, functor);
+}
+
+void VirtualClock::advance(qint64 msec)
+{
+    advanceTo(_now + qMax(msec, (qint64)0));
+}
+
+void VirtualClock::advanceTo(qint64 time)
+{
+    while (!_queue.empty() && (_queue.begin()->first <= time))
+    {
+        int timerId = _queue.begin()->second;
+        _queue.erase(_queue.begin());
+        Timer& timer = _timers[timerId];
+        _now = qMax(_now, timer.due);
+
+        QPointer<QObject> receiver = timer.receiver;
+        if (!receiver)
+        {
+            // Qt kills a destroyed object's timers, so do the same
+            _timers.remove(timerId);
+            continue;
+        }
+        if (timer.singleShot)
+        {
+            std::function<void()> functor = timer.functor;
+            _timers.remove(timerId);
+            functor();
+        }
+        else
+        {
+            // Rescheduled before delivery, so the receiver can kill it from timerEvent()
+            timer.due += qMax(timer.interval, 1);
+            _queue.insert(std::make_pair(timer.due, timerId));
+            QTimerEvent event(timerId);
+            QCoreApplication::sendEvent(receiver, &event);
+        }
+    }
+    _now = qMax(_now, time);
+}
+
+int VirtualClock::getPendingTimerCount() const
+{
+    return _timers.size();
+}
+
+qint64 VirtualClock::getNextDueTime() const
+{
+    return _queue.empty() ? -1 : _queue.begin()->first;
+}
+
+int VirtualClock::addTimer(QObject *receiver, int interval, bool singleShot, std::function<void()> functor)
+{
+    Timer timer;
+    timer.receiver = receiver;
+    timer.interval = qMax(interval, 0);
+    timer.due = _now + timer.interval;
+    timer.singleShot = singleShot;
+    timer.functor = functor;
+
+    int timerId = _nextTimerId++;
+    _timers.insert(timerId, timer);
+    _queue.insert(std::make_pair(timer.due, timerId));
+    return timerId;
+}
+
+void VirtualClock::removeTimer(int timerId)
+{
+    if (!_timers.contains(timerId)) return;
+    _queue.erase(std::make_pair(_timers.value(timerId).due, timerId));
+    _timers.remove(timerId);
+}
+
+} // namespace Soro
@@ -0,0 +1,67 @@
+#ifndef SORO_VIRTUALCLOCK_H
+#define SORO_VIRTUALCLOCK_H
+
+#include <QtCore>
+#include <set>
+
+#include "soro_core_global.h"
+#include "clock.h"
+
+namespace Soro {
+
+/* A clock where time only passes when it is told to, so code built on timeouts and intervals
+ * can be driven through minutes of its life in an instant, and the same way every time.
+ *
+ * Install it with Clock::setRoot() before creating what is being tested, then call advance().
+ * Every timer and single shot that comes due along the way is delivered in order of its due time,
+ * and timers started by those are delivered too if they fall within the same advance. Timer events
+ * are sent directly to the receiver's timerEvent(), so nothing needs to change in the receiver.
+ *
+ * advance() must be called on the thread the receivers live in. Sockets and other real I/O are
+ * not affected, only the time and the timers.
+ */
+class SORO_CORE_EXPORT VirtualClock: public Clock {
+public:
+    explicit VirtualClock(qint64 start=0);
+    ~VirtualClock();
+
+    qint64 msecsSinceEpoch() const Q_DECL_OVERRIDE;
+    int startTimer(QObject *receiver, int interval) Q_DECL_OVERRIDE;
+    void killTimer(QObject *receiver, int timerId) Q_DECL_OVERRIDE;
+    void singleShot(int msec, QObject *context, std::function<void()> functor) Q_DECL_OVERRIDE;
+
+    /* Moves time forward by msec milliseconds, delivering everything that comes due on the way
+     */
+    void advance(qint64 msec);
+    void advanceTo(qint64 time);
+
+    /* Gets the number of timers and single shots that haven't fired or been killed
+     */
+    int getPendingTimerCount() const;
+
+    /* Gets the time the next timer or single shot is due, or -1 if there are none
+     */
+    qint64 getNextDueTime() const;
+
+private:
+    struct Timer {
+        QPointer<QObject> receiver;
+        int interval;
+        qint64 due;
+        bool singleShot;
+        std::function<void()> functor;
+    };
+
+    qint64 _now;
+    int _nextTimerId;
+    QHash<int, Timer> _timers;
+    // Due time and then timer ID, so timers due at the same time fire in the order they were started
+    std::set<std::pair<qint64, int>> _queue;
+
+    int addTimer(QObject *receiver, int interval, bool singleShot, std::function<void()> functor);
+    void removeTimer(int timerId);
+};
+
+} // namespace Soro
+
+#endif // SORO_VIRTUALCLOCK_H
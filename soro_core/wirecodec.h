@@ -0,0 +1,306 @@
+/*********************************************************
+ * This code can be compiled on a Qt or mbed enviornment *
+ *********************************************************/
+
+#ifndef SORO_WIRECODEC_H
+#define SORO_WIRECODEC_H
+
+#include <stdint.h>
+#include <string.h>
+#include <stddef.h>
+
+/* Everything on the wire is big-endian (network order). This works out whether the
+ * host needs to swap, the LPC1768 and every PC we build for are little-endian.
+ */
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__)
+#   if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#       define SORO_WIRE_BIG_ENDIAN_HOST
+#   endif
+#elif defined(__BIG_ENDIAN) || defined(__ARMEB__) || defined(__BIG_ENDIAN__)
+#   define SORO_WIRE_BIG_ENDIAN_HOST
+#endif
+
+namespace Soro {
+
+/* Header-only codec for the binary message formats shared between Channel,
+ * MbedChannel and the mbed itself.
+ *
+ * Values are copied in and out with memcpy so they can sit at any alignment in
+ * a packet buffer, and byte swapping compiles down to a single bswap/rev instruction
+ * where the compiler has one. Floats and doubles are sent as their IEEE 754 bit
+ * patterns.
+ */
+namespace Wire {
+
+/* Maps a value size to the unsigned integer type that holds its bits
+ */
+template <int Size> struct Bits;
+template <> struct Bits<1> { typedef uint8_t Type; };
+template <> struct Bits<2> { typedef uint16_t Type; };
+template <> struct Bits<4> { typedef uint32_t Type; };
+template <> struct Bits<8> { typedef uint64_t Type; };
+
+inline uint8_t byteSwap(uint8_t value) {
+    return value;
+}
+
+inline uint16_t byteSwap(uint16_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap16(value);
+#else
+    return (uint16_t)((value << 8) | (value >> 8));
+#endif
+}
+
+inline uint32_t byteSwap(uint32_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap32(value);
+#else
+    return ((value & 0x000000FFu) << 24) | ((value & 0x0000FF00u) << 8)
+            | ((value & 0x00FF0000u) >> 8) | ((value & 0xFF000000u) >> 24);
+#endif
+}
+
+inline uint64_t byteSwap(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap64(value);
+#else
+    return ((uint64_t)byteSwap((uint32_t)value) << 32) | byteSwap((uint32_t)(value >> 32));
+#endif
+}
+
+/* Converts between host and network (big-endian) order, the conversion is
+ * the same in both directions
+ */
+template <typename U>
+inline U toNetworkOrder(U value) {
+#ifdef SORO_WIRE_BIG_ENDIAN_HOST
+    return value;
+#else
+    return byteSwap(value);
+#endif
+}
+
+/* Writes a value to any (possibly unaligned) address in network order.
+ * T can be any integer type, float, or double.
+ */
+template <typename T>
+inline void store(char *dest, T value) {
+    typename Bits<sizeof(T)>::Type bits;
+    memcpy(&bits, &value, sizeof(T));
+    bits = toNetworkOrder(bits);
+    memcpy(dest, &bits, sizeof(T));
+}
+
+/* Reads a value in network order from any (possibly unaligned) address.
+ * The caller is responsible for making sure sizeof(T) bytes are available,
+ * use Reader where that isn't already known.
+ */
+template <typename T>
+inline T load(const char *src) {
+    typename Bits<sizeof(T)>::Type bits;
+    memcpy(&bits, src, sizeof(T));
+    bits = toNetworkOrder(bits);
+    T value;
+    memcpy(&value, &bits, sizeof(T));
+    return value;
+}
+
+/* Largest number of bytes a varint can take up
+ */
+const int MaxVarintSize = 10;
+
+/* Writes an unsigned LEB128 varint (7 bits per byte, least significant group first,
+ * high bit set on every byte but the last). Returns the number of bytes written,
+ * dest must have room for MaxVarintSize bytes.
+ */
+inline int storeVarint(char *dest, uint64_t value) {
+    int i = 0;
+    while (value >= 0x80) {
+        dest[i++] = (char)((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    dest[i++] = (char)value;
+    return i;
+}
+
+/* Reads an unsigned LEB128 varint from at most length bytes. Returns the number
+ * of bytes read, or 0 if the varint was truncated or too long.
+ */
+inline int loadVarint(const char *src, size_t length, uint64_t *value) {
+    uint64_t result = 0;
+    int shift = 0;
+    for (size_t i = 0; (i < length) && (i < (size_t)MaxVarintSize); i++) {
+        uint8_t byte = (uint8_t)src[i];
+        if ((shift == 63) && (byte > 1)) return 0; // Would overflow 64 bits
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return (int)i + 1;
+        }
+        shift += 7;
+    }
+    return 0;
+}
+
+/* Zigzag encoding maps signed values to unsigned ones so that small negative
+ * numbers still make short varints (0, -1, 1, -2... become 0, 1, 2, 3...)
+ */
+inline uint64_t zigzagEncode(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+inline int64_t zigzagDecode(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+/* Writes values sequentially into a fixed size buffer.
+ *
+ * A write that doesn't fit writes nothing and puts the writer in a failed state,
+ * every later write will also fail. This means a whole message can be written and
+ * checked once with ok() at the end.
+ */
+class Writer {
+public:
+    Writer(char *data, size_t capacity)
+        : _data(data), _capacity(capacity), _position(0), _ok(true) { }
+
+    template <typename T>
+    bool write(T value) {
+        if (!reserve(sizeof(T))) return false;
+        store<T>(_data + _position, value);
+        _position += sizeof(T);
+        return true;
+    }
+
+    bool writeVarint(uint64_t value) {
+        char encoded[MaxVarintSize];
+        return writeBytes(encoded, storeVarint(encoded, value));
+    }
+
+    bool writeSignedVarint(int64_t value) {
+        return writeVarint(zigzagEncode(value));
+    }
+
+    bool writeBytes(const void *bytes, size_t length) {
+        if (!reserve(length)) return false;
+        memcpy(_data + _position, bytes, length);
+        _position += length;
+        return true;
+    }
+
+    /* Moves past bytes that will be filled in separately
+     */
+    bool skip(size_t length) {
+        if (!reserve(length)) return false;
+        _position += length;
+        return true;
+    }
+
+    bool ok() const { return _ok; }
+    size_t position() const { return _position; }
+    size_t remaining() const { return _capacity - _position; }
+    char *data() const { return _data; }
+
+private:
+    char *_data;
+    size_t _capacity;
+    size_t _position;
+    bool _ok;
+
+    bool reserve(size_t length) {
+        if (!_ok || (length > _capacity - _position)) {
+            _ok = false;
+            return false;
+        }
+        return true;
+    }
+};
+
+/* Reads values sequentially out of a received buffer.
+ *
+ * Like Writer, a read past the end of the buffer fails without moving the cursor,
+ * sets the output to zero, and puts the reader in a failed state.
+ */
+class Reader {
+public:
+    Reader(const char *data, size_t length)
+        : _data(data), _length(length), _position(0), _ok(true) { }
+
+    template <typename T>
+    bool read(T *value) {
+        if (!require(sizeof(T))) {
+            *value = T();
+            return false;
+        }
+        *value = load<T>(_data + _position);
+        _position += sizeof(T);
+        return true;
+    }
+
+    /* Reads a value, returning zero if it isn't there
+     */
+    template <typename T>
+    T read() {
+        T value;
+        read<T>(&value);
+        return value;
+    }
+
+    bool readVarint(uint64_t *value) {
+        int size = _ok ? loadVarint(_data + _position, _length - _position, value) : 0;
+        if (size == 0) {
+            _ok = false;
+            *value = 0;
+            return false;
+        }
+        _position += size;
+        return true;
+    }
+
+    bool readSignedVarint(int64_t *value) {
+        uint64_t encoded;
+        bool result = readVarint(&encoded);
+        *value = zigzagDecode(encoded);
+        return result;
+    }
+
+    bool readBytes(void *bytes, size_t length) {
+        if (!require(length)) return false;
+        memcpy(bytes, _data + _position, length);
+        _position += length;
+        return true;
+    }
+
+    bool skip(size_t length) {
+        if (!require(length)) return false;
+        _position += length;
+        return true;
+    }
+
+    bool ok() const { return _ok; }
+    size_t position() const { return _position; }
+    size_t remaining() const { return _length - _position; }
+    /* Gets a pointer to the next unread byte
+     */
+    const char *current() const { return _data + _position; }
+
+private:
+    const char *_data;
+    size_t _length;
+    size_t _position;
+    bool _ok;
+
+    bool require(size_t length) {
+        if (!_ok || (length > _length - _position)) {
+            _ok = false;
+            return false;
+        }
+        return true;
+    }
+};
+
+} // namespace Wire
+} // namespace Soro
+
+#endif // SORO_WIRECODEC_H
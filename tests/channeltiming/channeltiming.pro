@@ -0,0 +1,5 @@
+TARGET = tst_channeltiming
+include(../tests.pri)
+
+SOURCES += \
+    tst_channeltiming.cpp
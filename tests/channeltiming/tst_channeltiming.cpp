@@ -0,0 +1,208 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <QtTest>
+
+#include "soro_core/channel.h"
+#include "soro_core/virtualclock.h"
+#include "soro_core/logger.h"
+
+#define START_TIME 1500000000000LL
+
+using namespace Soro;
+
+/* Channel handshakes, heartbeats and timeouts, run on virtual time.
+ *
+ * Both ends are connected over a shared memory transport in this process. Its doorbell wakeups
+ * are delivered between steps of a millisecond, so everything the channels do happens at a known
+ * virtual time, and every run gives the same result.
+ */
+class TestChannelTiming: public QObject {
+    Q_OBJECT
+
+private:
+    VirtualClock *_clock = nullptr;
+    Channel *_server = nullptr;
+    Channel *_client = nullptr;
+    int _pairCount = 0;
+
+    /* Advances the clock a millisecond at a time, delivering the shared memory transport's
+     * doorbell wakeups in between
+     */
+    void advance(qint64 msec) {
+        for (qint64 i = 0; i < msec; i++) {
+            _clock->advance(1);
+            QCoreApplication::processEvents();
+        }
+    }
+
+    void createPair() {
+        QString address = "shm:tst_channeltiming_" + QString::number(QCoreApplication::applicationPid())
+                + "_" + QString::number(_pairCount++);
+        _server = Channel::createServer(nullptr, address, "TestChannel");
+        _client = Channel::createClient(nullptr, address, "TestChannel");
+        _server->open();
+        _client->open();
+    }
+
+    void destroyPair() {
+        delete _client;
+        delete _server;
+        _client = _server = nullptr;
+    }
+
+    bool connectPair() {
+        createPair();
+        for (int i = 0; i < 100; i++) {
+            advance(10);
+            if ((_server->getState() == Channel::ConnectedState) && (_client->getState() == Channel::ConnectedState)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private Q_SLOTS:
+    void initTestCase() {
+        Logger::rootLogger()->setMaxStdoutLevel(Logger::LogLevelError);
+    }
+
+    void init() {
+        _clock = new VirtualClock(START_TIME);
+        Clock::setRoot(_clock);
+    }
+
+    void cleanup() {
+        destroyPair();
+        Clock::setRoot(nullptr);
+        delete _clock;
+        _clock = nullptr;
+    }
+
+    void connectsOnFirstHandshake() {
+        createPair();
+        // The client's first handshake goes out after 250ms
+        advance(240);
+        QCOMPARE(_client->getState(), Channel::ConnectingState);
+        QCOMPARE(_server->getState(), Channel::ConnectingState);
+        advance(20);
+        QCOMPARE(_server->getState(), Channel::ConnectedState);
+        QCOMPARE(_client->getState(), Channel::ConnectedState);
+    }
+
+    void idleLinkIsKeptUpByHeartbeats() {
+        QVERIFY(connectPair());
+        QSignalSpy serverDegraded(_server, &Channel::degradedChanged);
+        QSignalSpy clientDegraded(_client, &Channel::degradedChanged);
+        quint64 messagesBefore = _server->getConnectionMessagesDown();
+
+        // A minute with no application traffic at all
+        advance(60000);
+
+        QCOMPARE(_server->getState(), Channel::ConnectedState);
+        QCOMPARE(_client->getState(), Channel::ConnectedState);
+        QCOMPARE(serverDegraded.count(), 0);
+        QCOMPARE(clientDegraded.count(), 0);
+        QVERIFY(_server->getSuspicionLevel() < 1);
+        // At least one heartbeat every 500ms
+        QVERIFY(_server->getConnectionMessagesDown() - messagesBefore >= 60000 / 500);
+        QVERIFY(_server->getConnectionUptime() >= 60);
+    }
+
+    void silentPeerIsDropped() {
+        QVERIFY(connectPair());
+        advance(5000);
+        QSignalSpy serverDegraded(_server, &Channel::degradedChanged);
+        QList<Channel::State> serverStates;
+        connect(_server, &Channel::stateChanged, [&serverStates](Channel::State state) {
+            serverStates.append(state);
+        });
+
+        _client->close();
+        // Never dropped before a second of silence, and the longest heartbeat interval is 500ms
+        advance(400);
+        QCOMPARE(_server->getState(), Channel::ConnectedState);
+
+        // The link has been regular, so a second of silence is plenty for the detector
+        advance(700);
+        QVERIFY(_server->getState() != Channel::ConnectedState);
+        QCOMPARE(serverStates, QList<Channel::State>() << Channel::ConnectingState);
+        // Reported degraded first, and cleared again when the connection was reset
+        QVERIFY(serverDegraded.count() >= 1);
+        QCOMPARE(serverDegraded.at(0).at(0).toBool(), true);
+        QCOMPARE(_server->isDegraded(), false);
+    }
+
+    void reconnectsAfterPeerReturns() {
+        QVERIFY(connectPair());
+        _client->close();
+        advance(6000);
+        QVERIFY(_server->getState() != Channel::ConnectedState);
+
+        _client->open();
+        advance(500);
+        QCOMPARE(_server->getState(), Channel::ConnectedState);
+        QCOMPARE(_client->getState(), Channel::ConnectedState);
+    }
+
+    void messagesArriveInVirtualTime() {
+        QVERIFY(connectPair());
+        QList<qint64> arrivals;
+        connect(_server, &Channel::messageReceived, [this, &arrivals](const char *message, Channel::MessageSize size) {
+            Q_UNUSED(message);
+            Q_UNUSED(size);
+            arrivals.append(_clock->msecsSinceEpoch());
+        });
+        qint64 sent = _clock->msecsSinceEpoch();
+        QVERIFY(_client->sendMessage(QByteArray("hello")));
+        advance(1);
+        QCOMPARE(arrivals, QList<qint64>() << sent + 1);
+
+        // The simulated delay holds the message for exactly that long
+        _client->setSimulatedDelay(200);
+        sent = _clock->msecsSinceEpoch();
+        QVERIFY(_client->sendMessage(QByteArray("hello")));
+        advance(199);
+        QCOMPARE(arrivals.size(), 1);
+        advance(2);
+        QCOMPARE(arrivals.size(), 2);
+        QCOMPARE(arrivals.last(), sent + 200);
+    }
+
+    void runsAreRepeatable() {
+        QVERIFY(connectPair());
+        advance(10000);
+        quint64 firstDown = _server->getConnectionMessagesDown();
+        quint64 firstUp = _server->getConnectionMessagesUp();
+        int firstRtt = _client->getLastRtt();
+        destroyPair();
+
+        Clock::setRoot(nullptr);
+        delete _clock;
+        _clock = new VirtualClock(START_TIME);
+        Clock::setRoot(_clock);
+
+        QVERIFY(connectPair());
+        advance(10000);
+        QCOMPARE(_server->getConnectionMessagesDown(), firstDown);
+        QCOMPARE(_server->getConnectionMessagesUp(), firstUp);
+        QCOMPARE(_client->getLastRtt(), firstRtt);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestChannelTiming)
+
+#include "tst_channeltiming.moc"
@@ -0,0 +1,16 @@
+TARGET = tst_controlbudget
+include(../tests.pri)
+
+QT += gui quick
+
+HEADERS += \
+    ../../research_control/hudlatencygraphimpl.h \
+    ../../research_control/gstreamerrecorder.h
+
+SOURCES += \
+    tst_controlbudget.cpp \
+    ../../research_control/hudlatencygraphimpl.cpp \
+    ../../research_control/gstreamerrecorder.cpp
+
+#Link Qt5GStreamer
+LIBS += -lQt5GStreamer-1.0 -lQt5GLib-2.0 -lQt5GStreamerUtils-1.0
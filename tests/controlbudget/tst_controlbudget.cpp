@@ -0,0 +1,124 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <QtTest>
+#include <QUdpSocket>
+
+#include <Qt5GStreamer/QGst/Init>
+#include <Qt5GStreamer/QGst/Parse>
+#include <Qt5GStreamer/QGst/Pipeline>
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <csignal>
+
+#include "research_control/hudlatencygraphimpl.h"
+#include "research_control/gstreamerrecorder.h"
+#include "soro_core/memorybudget.h"
+#include "soro_core/virtualclock.h"
+#include "soro_core/logger.h"
+
+#define START_TIME 1500000000000LL
+
+using namespace Soro;
+
+/* Mission control's own memory budgets, driven past their caps. The latency graph runs on
+ * virtual time; the recorder runs a real pipeline, and needs gstreamer with x264enc for the
+ * test stream. Needs a display, or -platform offscreen.
+ */
+class TestControlBudget: public QObject {
+    Q_OBJECT
+
+private:
+    MemoryBudgetRegistry::Usage usageOf(QString name) {
+        for (const MemoryBudgetRegistry::Usage& usage : MemoryBudgetRegistry::root()->getUsage()) {
+            if (usage.name == name) return usage;
+        }
+        return MemoryBudgetRegistry::Usage();
+    }
+
+    quint16 freeUdpPort() {
+        QUdpSocket socket;
+        socket.bind(QHostAddress::LocalHost, 0);
+        return socket.localPort();
+    }
+
+private Q_SLOTS:
+    void initTestCase() {
+        Logger::rootLogger()->setMaxStdoutLevel(Logger::LogLevelError);
+        QGst::init();
+        // Closing the recording's reader must fail the write, not end the test
+        signal(SIGPIPE, SIG_IGN);
+    }
+
+    void latencyHistoryDropsOldestPastItsBudget() {
+        VirtualClock clock(START_TIME);
+        Clock::setRoot(&clock);
+        MemoryBudgetRegistry::root()->setCap("latency_history", 1024);
+        {
+            HudLatencyGraphImpl graph;
+            // A minute of values every 20ms is far more than the cap
+            graph.setLatency(60000);
+            for (int i = 0; i < 500; i++) {
+                graph.setValue(i % 2);
+                clock.advance(20);
+            }
+            MemoryBudgetRegistry::Usage usage = usageOf("latency_history");
+            QVERIFY(usage.overflowCount > 0);
+            QVERIFY(usage.usage > 0);
+            QVERIFY(usage.usage <= 1024);
+        }
+        Clock::setRoot(nullptr);
+    }
+
+    void recordingQueueDropsOldestWhenTheFileBacksUp() {
+        MemoryBudgetRegistry::root()->setCap("video_recording:tst", 256 * 1024);
+        quint16 port = freeUdpPort();
+        GStreamerRecorder recorder(SocketAddress(QHostAddress::LocalHost, port), "tst");
+
+        // The recording goes into a pipe nobody reads from, so the file never keeps up
+        QDateTime start = QDateTime::fromMSecsSinceEpoch(START_TIME);
+        QString directory = QCoreApplication::applicationDirPath() + "/../research_media";
+        QString path = directory + "/" + start.toString("M-dd_h.mm.ss_AP") + ".avi";
+        QVERIFY(QDir().mkpath(directory));
+        QFile::remove(path);
+        QCOMPARE(mkfifo(path.toLocal8Bit().constData(), 0600), 0);
+        int reader = ::open(path.toLocal8Bit().constData(), O_RDONLY | O_NONBLOCK);
+        QVERIFY(reader >= 0);
+
+        QVERIFY(recorder.begin(VIDEO_CODEC_H264, start, false));
+        QGst::PipelinePtr sender = QGst::Parse::launch(QString(
+                "videotestsrc is-live=true ! video/x-raw,width=640,height=480,framerate=30/1"
+                " ! x264enc tune=zerolatency ! rtph264pay config-interval=1 pt=96"
+                " ! udpsink host=127.0.0.1 port=%1").arg(port)).dynamicCast<QGst::Pipeline>();
+        QVERIFY(!sender.isNull());
+        sender->setState(QGst::StatePlaying);
+
+        QTRY_VERIFY_WITH_TIMEOUT(usageOf("video_recording:tst").overflowCount > 0, 60000);
+        // Its level is polled once a second
+        QTRY_VERIFY_WITH_TIMEOUT(usageOf("video_recording:tst").usage > 0, 5000);
+
+        sender->setState(QGst::StateNull);
+        ::close(reader);
+        recorder.stop();
+        QFile::remove(path);
+    }
+};
+
+QTEST_MAIN(TestControlBudget)
+#include "tst_controlbudget.moc"
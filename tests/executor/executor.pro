@@ -0,0 +1,5 @@
+TARGET = tst_executor
+include(../tests.pri)
+
+SOURCES += \
+    tst_executor.cpp
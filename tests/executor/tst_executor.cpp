@@ -0,0 +1,179 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <QtTest>
+#include <atomic>
+
+#include "soro_core/executor.h"
+#include "soro_core/logger.h"
+
+#define WORKERS 4
+#define TASKS 10000
+#define POSTING_THREADS 4
+
+using namespace Soro;
+
+/* Posts its share of tasks from a thread that isn't one of the executor's workers
+ */
+class PostingThread: public QThread {
+public:
+    PostingThread(Executor *executor, QSemaphore *done, int count)
+        : _executor(executor), _done(done), _count(count) { }
+
+protected:
+    void run() {
+        QSemaphore *done = _done;
+        for (int i = 0; i < _count; i++) {
+            _executor->post([done]() { done->release(); });
+        }
+    }
+
+private:
+    Executor *_executor;
+    QSemaphore *_done;
+    int _count;
+};
+
+class TestExecutor: public QObject {
+    Q_OBJECT
+
+private:
+    Executor *_executor = nullptr;
+
+private Q_SLOTS:
+    void initTestCase() {
+        Logger::rootLogger()->setMaxStdoutLevel(Logger::LogLevelError);
+    }
+
+    void init() {
+        _executor = new Executor("TestExecutor", WORKERS);
+    }
+
+    void cleanup() {
+        delete _executor;
+        _executor = nullptr;
+    }
+
+    void everyPostedTaskRuns() {
+        std::atomic<int> count(0);
+        QSemaphore done;
+        for (int i = 0; i < TASKS; i++) {
+            _executor->post([&count, &done]() {
+                count.fetch_add(1);
+                done.release();
+            }, static_cast<Executor::Priority>(i % 3));
+        }
+        QVERIFY(done.tryAcquire(TASKS, 10000));
+        QCOMPARE(count.load(), TASKS);
+        QCOMPARE(_executor->getStats().queued, qint64(0));
+    }
+
+    void tasksPostedFromWorkersAreShared() {
+        QSemaphore done;
+        Executor *executor = _executor;
+        // Everything lands on one worker's queue, the others have to steal it
+        _executor->post([executor, &done]() {
+            for (int i = 0; i < TASKS; i++) {
+                executor->post([&done]() {
+                    QThread::usleep(10);
+                    done.release();
+                });
+            }
+        });
+        QVERIFY(done.tryAcquire(TASKS, 10000));
+        QVERIFY(_executor->getStats().stolen > 0);
+    }
+
+    void sleepingWorkersWakeForNewTasks() {
+        QSemaphore done;
+        for (int round = 0; round < 20; round++) {
+            // Long enough for every worker to have gone to sleep
+            QThread::msleep(5);
+            _executor->post([&done]() { done.release(); });
+            QVERIFY(done.tryAcquire(1, 1000));
+        }
+    }
+
+    void resultsAreDeliveredToTheContext() {
+        QThread *worker = nullptr;
+        QThread *delivered = nullptr;
+        int result = 0;
+        _executor->post([&worker]() {
+            worker = QThread::currentThread();
+            return 42;
+        }, this, [&delivered, &result](int value) {
+            delivered = QThread::currentThread();
+            result = value;
+        });
+        QTRY_COMPARE(result, 42);
+        QVERIFY(worker != QThread::currentThread());
+        QCOMPARE(delivered, QThread::currentThread());
+    }
+
+    void delayedTasksWaitAndCanBeCancelled() {
+        QElapsedTimer timer;
+        timer.start();
+        std::atomic<qint64> ranAfter(-1);
+        std::atomic<bool> cancelledRan(false);
+        _executor->postDelayed(100, [&ranAfter, &timer]() { ranAfter.store(timer.elapsed()); });
+        int cancelled = _executor->postDelayed(50, [&cancelledRan]() { cancelledRan.store(true); });
+        _executor->cancel(cancelled);
+        QTRY_VERIFY(ranAfter.load() >= 0);
+        QVERIFY(ranAfter.load() >= 100);
+        QVERIFY(!cancelledRan.load());
+    }
+
+    void benchmarkPostFromOneThread() {
+        QSemaphore done;
+        QBENCHMARK {
+            for (int i = 0; i < TASKS; i++) {
+                _executor->post([&done]() { done.release(); });
+            }
+            QVERIFY(done.tryAcquire(TASKS, 10000));
+        }
+    }
+
+    void benchmarkPostFromManyThreads() {
+        QSemaphore done;
+        QBENCHMARK {
+            QList<PostingThread*> threads;
+            for (int i = 0; i < POSTING_THREADS; i++) {
+                threads << new PostingThread(_executor, &done, TASKS / POSTING_THREADS);
+            }
+            for (PostingThread *thread : threads) thread->start();
+            QVERIFY(done.tryAcquire(TASKS, 10000));
+            for (PostingThread *thread : threads) thread->wait();
+            qDeleteAll(threads);
+        }
+    }
+
+    void benchmarkPostFromWorker() {
+        QSemaphore done;
+        Executor *executor = _executor;
+        QBENCHMARK {
+            _executor->post([executor, &done]() {
+                for (int i = 0; i < TASKS; i++) {
+                    executor->post([&done]() { done.release(); });
+                }
+            });
+            QVERIFY(done.tryAcquire(TASKS, 10000));
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(TestExecutor)
+
+#include "tst_executor.moc"
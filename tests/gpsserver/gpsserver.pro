@@ -0,0 +1,9 @@
+TARGET = tst_gpsserver
+include(../tests.pri)
+
+HEADERS += \
+    ../../rover/gpsserver.h
+
+SOURCES += \
+    tst_gpsserver.cpp \
+    ../../rover/gpsserver.cpp
@@ -0,0 +1,188 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <QtTest>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "rover/gpsserver.h"
+#include "soro_core/nmeaframer.h"
+#include "soro_core/logger.h"
+
+using namespace Soro;
+
+/* The GPS server reading a fake receiver on a pseudo terminal. The server opens the pty's slave
+ * side as if it were the receiver's serial port, and the test talks to it through the master side.
+ */
+class TestGpsServer: public QObject {
+    Q_OBJECT
+
+private:
+    int _master = -1;
+    QString _slavePath;
+    GpsServer *_server = nullptr;
+    QList<NmeaMessage> _fixes;
+
+    QByteArray gga(QByteArray fixQuality="1") {
+        return NmeaFramer::checksummed("$GPGGA,123519,3512.000,N,09724.000,W," + fixQuality + ",08,0.9,350.0,M,46.9,M,,");
+    }
+
+    QByteArray vtg() {
+        return NmeaFramer::checksummed("$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K");
+    }
+
+    void sendFromReceiver(const QByteArray& data) {
+        QCOMPARE(::write(_master, data.constData(), data.size()), (ssize_t)data.size());
+    }
+
+    /* Reads whatever the server wrote to the receiver, waiting until there is at least this much
+     */
+    QByteArray readFromReceiver(int atLeast) {
+        QByteArray received;
+        QElapsedTimer timer;
+        timer.start();
+        char buffer[256];
+        while ((received.size() < atLeast) && (timer.elapsed() < 5000)) {
+            ssize_t status = ::read(_master, buffer, sizeof(buffer));
+            if (status > 0) {
+                received.append(buffer, static_cast<int>(status));
+            }
+            else {
+                QTest::qWait(10);
+            }
+        }
+        return received;
+    }
+
+private Q_SLOTS:
+    void initTestCase() {
+        Logger::rootLogger()->setMaxStdoutLevel(Logger::LogLevelError);
+    }
+
+    void init() {
+        _master = posix_openpt(O_RDWR | O_NOCTTY);
+        QVERIFY(_master >= 0);
+        QVERIFY(grantpt(_master) == 0);
+        QVERIFY(unlockpt(_master) == 0);
+        _slavePath = QString::fromLatin1(ptsname(_master));
+        fcntl(_master, F_SETFL, fcntl(_master, F_GETFL) | O_NONBLOCK);
+
+        _fixes.clear();
+        _server = new GpsServer;
+        connect(_server, &GpsServer::gpsUpdate, [this](NmeaMessage fix) {
+            _fixes.append(fix);
+        });
+        _server->openSerial(_slavePath, 9600);
+    }
+
+    void cleanup() {
+        delete _server;
+        _server = nullptr;
+        if (_master >= 0) ::close(_master);
+        _master = -1;
+    }
+
+    void fixesArriveFromTheReceiver() {
+        sendFromReceiver(vtg() + gga());
+        QTRY_COMPARE(_fixes.size(), 1);
+        QVERIFY(qAbs(_fixes[0].Latitude - 35.2) < 1e-9);
+        QVERIFY(qAbs(_fixes[0].Longitude + 97.4) < 1e-9);
+        QCOMPARE(_fixes[0].Satellites, 8);
+        QCOMPARE(_fixes[0].Altitude, 350);
+        QCOMPARE(_fixes[0].Heading, 34);
+        QCOMPARE(_fixes[0].GroundSpeed, 10.0);
+
+        // The last course and speed go with fixes that come without one
+        sendFromReceiver(gga());
+        QTRY_COMPARE(_fixes.size(), 2);
+        QCOMPARE(_fixes[1].Heading, 34);
+    }
+
+    void sentencesSplitAcrossReadsAreFramed() {
+        QByteArray sentence = gga();
+        sendFromReceiver(sentence.left(20));
+        QTest::qWait(50);
+        QCOMPARE(_fixes.size(), 0);
+        sendFromReceiver(sentence.mid(20));
+        QTRY_COMPARE(_fixes.size(), 1);
+    }
+
+    void badSentencesAreDropped() {
+        QByteArray corrupted = gga();
+        corrupted[20] = corrupted[20] == '1' ? '2' : '1';
+        sendFromReceiver(corrupted + gga("0"));
+        QTRY_COMPARE(_server->getDroppedSentenceCount(), quint64(1));
+        QTest::qWait(50);
+        // The corrupted sentence was dropped, and the one after it framed but not a fix
+        QCOMPARE(_fixes.size(), 0);
+        sendFromReceiver(gga());
+        QTRY_COMPARE(_fixes.size(), 1);
+        QCOMPARE(_server->getDroppedSentenceCount(), quint64(1));
+    }
+
+    void mtkReceiverIsConfigured() {
+        _server->setReceiver(GpsServer::MtkReceiver, 5);
+        QByteArray expected = NmeaFramer::checksummed("$PMTK314,0,0,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0")
+                + NmeaFramer::checksummed("$PMTK220,200");
+        QCOMPARE(readFromReceiver(expected.size()), expected);
+    }
+
+    void ubloxReceiverIsConfigured() {
+        _server->setReceiver(GpsServer::UbloxReceiver, 10);
+        QByteArray expected;
+        for (const char *type : { "GLL", "GSA", "GSV", "RMC" }) {
+            expected += NmeaFramer::checksummed(QByteArray("$PUBX,40,") + type + ",0,0,0,0,0,0");
+        }
+        // CFG-RATE with a 100ms measurement interval, checksummed over class to the end of the payload
+        QByteArray rate = QByteArray::fromHex("0608060064000100" "0100");
+        quint8 a = 0, b = 0;
+        for (char byte : rate) {
+            a += static_cast<quint8>(byte);
+            b += a;
+        }
+        expected += QByteArray::fromHex("b562") + rate;
+        expected.append(static_cast<char>(a)).append(static_cast<char>(b));
+        QCOMPARE(readFromReceiver(expected.size()), expected);
+    }
+
+    void genericReceiverIsLeftAlone() {
+        _server->setReceiver(GpsServer::GenericReceiver, 10);
+        QTest::qWait(50);
+        char buffer[16];
+        QCOMPARE(::read(_master, buffer, sizeof(buffer)), (ssize_t)-1);
+        QCOMPARE(errno, EAGAIN);
+        // Still reading fixes
+        sendFromReceiver(gga());
+        QTRY_COMPARE(_fixes.size(), 1);
+    }
+
+    void unpluggedReceiverStopsFixes() {
+        sendFromReceiver(gga());
+        QTRY_COMPARE(_fixes.size(), 1);
+        // Hanging up the master is what the slave sees when a USB receiver is pulled
+        ::close(_master);
+        _master = -1;
+        QTest::qWait(100);
+        QCOMPARE(_fixes.size(), 1);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestGpsServer)
+
+#include "tst_gpsserver.moc"
@@ -0,0 +1,278 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <QtTest>
+
+#include "soro_core/memorybudget.h"
+#include "soro_core/csvrecorder.h"
+#include "soro_core/channel.h"
+#include "soro_core/virtualclock.h"
+#include "soro_core/logger.h"
+
+#define START_TIME 1500000000000LL
+
+using namespace Soro;
+
+class TestSeries: public CsvDataSeries {
+public:
+    QString getSeriesName() const { return "Test"; }
+    bool shouldKeepOldValues() const { return true; }
+    void set(QVariant value) { update(value); }
+};
+
+class TestMemoryBudget: public QObject {
+    Q_OBJECT
+
+private:
+    VirtualClock *_clock = nullptr;
+    Channel *_server = nullptr;
+    Channel *_client = nullptr;
+
+    /* Advances the clock a millisecond at a time, letting the channels' sockets read and write
+     * in between
+     */
+    void advance(qint64 msec) {
+        for (qint64 i = 0; i < msec; i++) {
+            _clock->advance(1);
+            QCoreApplication::processEvents();
+        }
+    }
+
+    /* Connects a channel pair over a unix stream socket. Until events are processed again, nothing
+     * written to it leaves the socket's buffer, which is as good as a link that is backed up.
+     */
+    bool connectPair(QString name) {
+        QString address = "unix:" + QDir::tempPath() + "/tst_memorybudget_"
+                + QString::number(QCoreApplication::applicationPid()) + "_" + name;
+        _server = Channel::createServer(nullptr, address, name);
+        _client = Channel::createClient(nullptr, address, name);
+        _server->open();
+        _client->open();
+        for (int i = 0; i < 100; i++) {
+            advance(10);
+            if ((_server->getState() == Channel::ConnectedState) && (_client->getState() == Channel::ConnectedState)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    QString csvPath(QString logName, QDateTime start) {
+        return QCoreApplication::applicationDirPath() + "/../research_data/" + logName + "_"
+                + start.toString("M-dd_h.mm.ss_AP") + ".csv";
+    }
+
+    MemoryBudgetRegistry::Usage usageOf(QString name) {
+        for (const MemoryBudgetRegistry::Usage& usage : MemoryBudgetRegistry::root()->getUsage()) {
+            if (usage.name == name) return usage;
+        }
+        return MemoryBudgetRegistry::Usage();
+    }
+
+private Q_SLOTS:
+    void initTestCase() {
+        Logger::rootLogger()->setMaxStdoutLevel(Logger::LogLevelError);
+    }
+
+    void init() {
+        _clock = new VirtualClock(START_TIME);
+        Clock::setRoot(_clock);
+    }
+
+    void cleanup() {
+        delete _client;
+        delete _server;
+        _client = _server = nullptr;
+        Clock::setRoot(nullptr);
+        delete _clock;
+        _clock = nullptr;
+    }
+
+    void overflowIsCountedAndReportedOnce() {
+        QSignalSpy capReached(MemoryBudgetRegistry::root(), &MemoryBudgetRegistry::capReached);
+        MemoryBudget budget("tst_overflow", 100, MemoryBudget::DropOldest);
+        budget.add(80);
+        QVERIFY(budget.fits(20));
+        QVERIFY(!budget.fits(21));
+        QCOMPARE(budget.excess(30), qint64(10));
+
+        budget.overflowed(30);
+        budget.overflowed(40);
+        QCOMPARE(budget.getOverflowCount(), quint64(2));
+        QCOMPARE(budget.getDroppedBytes(), quint64(70));
+        QVERIFY(capReached.wait(1000));
+        QCOMPARE(capReached.count(), 1);
+        QCOMPARE(capReached.at(0).at(0).toString(), QString("tst_overflow"));
+
+        // Unlimited budgets only keep count
+        budget.setCap(0);
+        QVERIFY(budget.fits(1LL << 40));
+        QCOMPARE(budget.getPeakUsage(), qint64(80));
+    }
+
+    void sendQueueDropsOldestPastItsBudget() {
+        // Both ends register the same name, the server's budget comes first
+        MemoryBudgetRegistry::root()->setCap("channel_send:tst_queue", 8192);
+        QVERIFY(connectPair("tst_queue"));
+        _server->setSendQueueWatermark(1024);
+
+        // 40KB into a socket that isn't being written out
+        QByteArray message(400, 'x');
+        for (int i = 0; i < 100; i++) {
+            QVERIFY(_server->sendMessage(message));
+        }
+        MemoryBudgetRegistry::Usage usage = usageOf("channel_send:tst_queue");
+        QVERIFY(usage.overflowCount > 0);
+        QVERIFY(usage.usage <= 8192);
+        QVERIFY(_server->getOverflowDroppedMessageCount() > 0);
+        QVERIFY(_server->getSendQueueDepth() > 0);
+
+        // The rest is sent once the socket drains
+        advance(200);
+        QCOMPARE(_server->getSendQueueDepth(), 0);
+        QCOMPARE(_server->getState(), Channel::ConnectedState);
+    }
+
+    void backedUpSocketRefusesMessagesButNotHeartbeats() {
+        MemoryBudgetRegistry::root()->setCap("channel_send:tst_backedup", 2048);
+        QVERIFY(connectPair("tst_backedup"));
+        // Without a send queue, messages past the budget are refused
+        _server->setSendQueueWatermark(0);
+
+        QByteArray message(400, 'x');
+        int refused = 0;
+        for (int i = 0; i < 20; i++) {
+            if (!_server->sendMessage(message)) refused++;
+        }
+        QVERIFY(refused > 0);
+        QVERIFY(usageOf("channel_send:tst_backedup").overflowCount > 0);
+
+        // Heartbeats still go out, at least one every 500ms
+        quint64 messagesUp = _server->getConnectionMessagesUp();
+        _clock->advance(550);
+        QVERIFY(_server->getConnectionMessagesUp() > messagesUp);
+
+        advance(200);
+        QCOMPARE(_server->getState(), Channel::ConnectedState);
+        QVERIFY(usageOf("channel_send:tst_backedup").usage < 2048);
+        QVERIFY(_server->sendMessage(message));
+    }
+
+    void delayedMessagesAreRefusedPastTheirBudget() {
+        MemoryBudgetRegistry::root()->setCap("channel_delay:tst_delay", 2048);
+        QVERIFY(connectPair("tst_delay"));
+        _server->setSimulatedDelay(300);
+
+        QByteArray message(400, 'x');
+        int refused = 0;
+        for (int i = 0; i < 20; i++) {
+            if (!_server->sendMessage(message)) refused++;
+        }
+        QVERIFY(refused > 0);
+        MemoryBudgetRegistry::Usage usage = usageOf("channel_delay:tst_delay");
+        QVERIFY(usage.overflowCount > 0);
+        QVERIFY(usage.usage <= 2048);
+
+        // Once the held messages are released there is room again
+        advance(350);
+        QCOMPARE(_server->getState(), Channel::ConnectedState);
+        QVERIFY(usageOf("channel_delay:tst_delay").usage < 2048);
+        QVERIFY(_server->sendMessage(message));
+    }
+
+    void csvRowsAreWrittenOutAtTheCapNotDropped() {
+        TestSeries series;
+        CsvRecorder recorder("tst_memorybudget_overflow");
+        recorder.addColumn(&series);
+        recorder.setUpdateInterval(10);
+        MemoryBudgetRegistry::root()->setCap("csv:tst_memorybudget_overflow", 1024);
+        QDateTime start = QDateTime::fromMSecsSinceEpoch(_clock->msecsSinceEpoch());
+        QString path = csvPath("tst_memorybudget_overflow", start);
+        QVERIFY(recorder.startLog(start, CsvRecorder::RECORDING_MODE_ON_INTERVAL));
+        qint64 headerSize = QFileInfo(path).size();
+
+        // Far more than the cap, a 100 byte value every 10ms for 10 seconds
+        series.set(QString(100, 'x'));
+        _clock->advance(10000);
+
+        // Rows went out to the file as the budget filled, and never more than the cap was held
+        QVERIFY(QFileInfo(path).size() > headerSize + 90 * 1024);
+        MemoryBudgetRegistry::Usage usage = usageOf("csv:tst_memorybudget_overflow");
+        QVERIFY(usage.peakUsage <= 1024);
+        QCOMPARE(usage.overflowCount, quint64(0));
+        recorder.stopLog();
+
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QStringList lines = QString::fromUtf8(file.readAll()).split("\n", QString::SkipEmptyParts);
+        file.close();
+        file.remove();
+        QCOMPARE(lines.size(), 3 + 1000);
+        for (int i = 0; i < 1000; i++) {
+            QVERIFY(lines[3 + i].startsWith(QString(100, 'x') + ","));
+        }
+    }
+
+    void csvBudgetCountsEncodedBytes() {
+        TestSeries series;
+        CsvRecorder recorder("tst_memorybudget_bytes");
+        recorder.addColumn(&series);
+        recorder.setUpdateInterval(100);
+        QDateTime start = QDateTime::fromMSecsSinceEpoch(_clock->msecsSinceEpoch());
+        QVERIFY(recorder.startLog(start, CsvRecorder::RECORDING_MODE_ON_INTERVAL));
+
+        // Two bytes each in UTF-8, but a single QChar
+        series.set(QString(10, QChar(0xe9)));
+        _clock->advance(100);
+        QString row = QString(10, QChar(0xe9)) + ",0,\n";
+        QCOMPARE(usageOf("csv:tst_memorybudget_bytes").usage, qint64(row.toUtf8().size()));
+        recorder.stopLog();
+        QCOMPARE(usageOf("csv:tst_memorybudget_bytes").usage, qint64(0));
+
+        QFile file(csvPath("tst_memorybudget_bytes", start));
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QVERIFY(file.readAll().endsWith(row.toUtf8()));
+        file.close();
+        file.remove();
+    }
+
+    void logIsNeverCutShort() {
+        QTemporaryDir directory;
+        QVERIFY(directory.isValid());
+        QString path = directory.path() + "/tst_memorybudget.log";
+        Logger logger;
+        logger.setMaxStdoutLevel(Logger::LogLevelDisabled);
+        QVERIFY(logger.setLogfile(path));
+        // Whatever the caps are set to, nothing budgets the log file any more
+        MemoryBudgetRegistry::root()->setCap("log", 1024);
+        for (int i = 0; i < 10000; i++) {
+            logger.i("TestMemoryBudget", "Line " + QString::number(i));
+        }
+        logger.closeLogfile();
+
+        QVERIFY(!QFile::exists(path + ".1"));
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QStringList lines = QString::fromUtf8(file.readAll()).split("\n", QString::SkipEmptyParts);
+        QCOMPARE(lines.size(), 10000);
+        QVERIFY(lines.first().endsWith("Line 0"));
+        QVERIFY(lines.last().endsWith("Line 9999"));
+    }
+};
+
+QTEST_GUILESS_MAIN(TestMemoryBudget)
+
+#include "tst_memorybudget.moc"
@@ -0,0 +1,5 @@
+TARGET = tst_multipath
+include(../tests.pri)
+
+SOURCES += \
+    tst_multipath.cpp
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <QtTest>
+#include <QUdpSocket>
+
+#include "soro_core/channel.h"
+#include "soro_core/logger.h"
+
+using namespace Soro;
+
+/* Forwards datagrams between a client and a server, standing in for one network interface.
+ * Cutting it drops everything in both directions, like a modem losing signal.
+ */
+class UdpRelay {
+public:
+    bool cut = false;
+
+    UdpRelay(const QHostAddress& address, const SocketAddress& server) {
+        _server = server;
+        _front.bind(address, 0);
+        _back.bind(QHostAddress::LocalHost, 0);
+        QObject::connect(&_front, &QUdpSocket::readyRead, [this]() {
+            while (_front.hasPendingDatagrams()) {
+                QByteArray datagram(_front.pendingDatagramSize(), 0);
+                _front.readDatagram(datagram.data(), datagram.size(), &_clientHost, &_clientPort);
+                if (!cut) _back.writeDatagram(datagram, _server.host, _server.port);
+            }
+        });
+        QObject::connect(&_back, &QUdpSocket::readyRead, [this]() {
+            while (_back.hasPendingDatagrams()) {
+                QByteArray datagram(_back.pendingDatagramSize(), 0);
+                _back.readDatagram(datagram.data(), datagram.size());
+                if (!cut && (_clientPort != 0)) _front.writeDatagram(datagram, _clientHost, _clientPort);
+            }
+        });
+    }
+
+    SocketAddress getAddress() const {
+        return SocketAddress(_front.localAddress(), _front.localPort());
+    }
+
+private:
+    QUdpSocket _front;
+    QUdpSocket _back;
+    SocketAddress _server;
+    QHostAddress _clientHost;
+    quint16 _clientPort = 0;
+};
+
+/* A multipath drive channel over the loopback interface, with each path going through its own
+ * loopback address and relay. Runs in real time, as the channel has real sockets.
+ */
+class TestMultipath: public QObject {
+    Q_OBJECT
+
+private:
+    quint16 _port;
+    Channel *_server = nullptr;
+    Channel *_client = nullptr;
+    UdpRelay *_relays[2] = { nullptr, nullptr };
+    int _received = 0;
+
+    bool bothPathsHealthy() const {
+        return (_client->getUdpPathCount() == 2) && _client->isUdpPathHealthy(0) && _client->isUdpPathHealthy(1);
+    }
+
+private Q_SLOTS:
+    void initTestCase() {
+        Logger::rootLogger()->setMaxStdoutLevel(Logger::LogLevelError);
+        _port = 40000 + QCoreApplication::applicationPid() % 20000;
+    }
+
+    void init() {
+        SocketAddress server(QHostAddress::LocalHost, _port);
+        _relays[0] = new UdpRelay(QHostAddress("127.0.0.2"), server);
+        _relays[1] = new UdpRelay(QHostAddress("127.0.0.3"), server);
+
+        _server = Channel::createServer(nullptr, _port, "TestDrive", Channel::UdpProtocol, QHostAddress::LocalHost);
+        _server->setUdpMultipath(true);
+        _server->setUdpDuplicateMessages(true);
+        _client = Channel::createClient(nullptr, _relays[0]->getAddress(), "TestDrive", Channel::UdpProtocol, QHostAddress::Any);
+        _client->addUdpPath(QHostAddress::Any, _relays[1]->getAddress());
+        _client->setUdpDuplicateMessages(true);
+        _received = 0;
+        connect(_server, &Channel::messageReceived, [this](const char *message, Channel::MessageSize size) {
+            Q_UNUSED(message);
+            Q_UNUSED(size);
+            _received++;
+        });
+        _server->open();
+        _client->open();
+        QTRY_VERIFY_WITH_TIMEOUT(_client->getState() == Channel::ConnectedState, 5000);
+        QTRY_VERIFY_WITH_TIMEOUT(bothPathsHealthy(), 5000);
+    }
+
+    void cleanup() {
+        delete _client;
+        delete _server;
+        delete _relays[0];
+        delete _relays[1];
+        _client = _server = nullptr;
+        _relays[0] = _relays[1] = nullptr;
+    }
+
+    void pathsAreMeasured() {
+        QCOMPARE(_server->getUdpPathCount(), 2);
+        QTRY_VERIFY_WITH_TIMEOUT((_client->getUdpPathRtt(0) >= 0) && (_client->getUdpPathRtt(1) >= 0), 2000);
+        QCOMPARE(_client->getUdpPathLossPercent(0), 0);
+        QCOMPARE(_client->getUdpPathLossPercent(1), 0);
+    }
+
+    void copiesAreDeliveredOnce() {
+        for (int i = 0; i < 50; i++) {
+            QVERIFY(_client->sendMessage(QByteArray("drive")));
+            QTest::qWait(10);
+        }
+        QTRY_COMPARE_WITH_TIMEOUT(_received, 50, 2000);
+        // Every message went over both paths
+        QTRY_VERIFY_WITH_TIMEOUT(_server->getUdpDuplicatePacketCount() >= 50, 2000);
+        QCOMPARE(_received, 50);
+    }
+
+    void primaryPathFailsOver() {
+        int primary = _client->getPrimaryUdpPath();
+        int other = 1 - primary;
+        // The relay order matches the path order, as both were given to the client in that order
+        _relays[primary]->cut = true;
+
+        // Drive commands keep arriving over the other path while the cut one times out
+        for (int i = 0; i < 150; i++) {
+            QVERIFY(_client->sendMessage(QByteArray("drive")));
+            QTest::qWait(20);
+        }
+        QTRY_COMPARE_WITH_TIMEOUT(_received, 150, 2000);
+        QCOMPARE(_client->getPrimaryUdpPath(), other);
+        QVERIFY(!_client->isUdpPathHealthy(primary));
+        QVERIFY(_client->isUdpPathHealthy(other));
+        QCOMPARE(_client->getState(), Channel::ConnectedState);
+        QCOMPARE(_server->getState(), Channel::ConnectedState);
+
+        // and the path is picked back up once it recovers
+        _relays[primary]->cut = false;
+        QTRY_VERIFY_WITH_TIMEOUT(bothPathsHealthy(), 5000);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestMultipath)
+
+#include "tst_multipath.moc"
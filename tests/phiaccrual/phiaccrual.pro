@@ -0,0 +1,5 @@
+TARGET = tst_phiaccrual
+include(../tests.pri)
+
+SOURCES += \
+    tst_phiaccrual.cpp
@@ -0,0 +1,205 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <QtTest>
+
+#include "soro_core/phiaccrualdetector.h"
+#include "soro_core/channel.h"
+#include "soro_core/virtualclock.h"
+#include "soro_core/logger.h"
+
+#define START_TIME 1500000000000LL
+
+using namespace Soro;
+
+/* Heartbeat jitter in milliseconds. These are synthetic, not captured: hand picked to look like
+ * a steady wifi link (CLEAN, within a few ms) and a cellular one (CELLULAR, up to 200ms either
+ * way).
+ */
+static const int CLEAN_JITTER[] = {
+    3, -2, 0, 5, -4, 1, 2, -1, 0, 7, -6, 2, 0, -3, 4, 1, -2, 0, 3, -5
+};
+static const int CELLULAR_JITTER[] = {
+    40, -120, 210, -35, 0, 160, -180, 75, -60, 190, -10, -150, 95, 30, -200, 120, -70, 55, -25, 140
+};
+#define JITTER_COUNT 20
+
+/* The failure detector fed with synthetic heartbeat arrivals, and a channel's use of it
+ */
+class TestPhiAccrual: public QObject {
+    Q_OBJECT
+
+private:
+    VirtualClock *_clock = nullptr;
+    Channel *_server = nullptr;
+    Channel *_client = nullptr;
+
+    /* Advances the clock a millisecond at a time, delivering the shared memory transport's
+     * doorbell wakeups in between
+     */
+    void advance(qint64 msec) {
+        for (qint64 i = 0; i < msec; i++) {
+            _clock->advance(1);
+            QCoreApplication::processEvents();
+        }
+    }
+
+    /* Feeds count heartbeats every interval ms, offset by the jitter pattern, and returns
+     * the time of the last one
+     */
+    static qint64 feed(PhiAccrualDetector *detector, qint64 start, int count, int interval, const int *jitter) {
+        qint64 time = start;
+        for (int i = 0; i < count; i++) {
+            time += interval + (jitter ? jitter[i % JITTER_COUNT] : 0);
+            detector->heartbeat(time);
+        }
+        return time;
+    }
+
+    bool connectPair(int clientDelay) {
+        QString address = "shm:tst_phiaccrual_" + QString::number(QCoreApplication::applicationPid());
+        _server = Channel::createServer(nullptr, address, "TestChannel");
+        _client = Channel::createClient(nullptr, address, "TestChannel");
+        _client->setSimulatedDelay(clientDelay);
+        _server->open();
+        _client->open();
+        for (int i = 0; i < 200; i++) {
+            advance(10);
+            if ((_server->getState() == Channel::ConnectedState) && (_client->getState() == Channel::ConnectedState)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private Q_SLOTS:
+    void initTestCase() {
+        Logger::rootLogger()->setMaxStdoutLevel(Logger::LogLevelError);
+    }
+
+    void init() {
+        _clock = new VirtualClock(START_TIME);
+        Clock::setRoot(_clock);
+    }
+
+    void cleanup() {
+        delete _client;
+        delete _server;
+        _client = _server = nullptr;
+        Clock::setRoot(nullptr);
+        delete _clock;
+        _clock = nullptr;
+    }
+
+    void regularHeartbeatsStayTrusted() {
+        PhiAccrualDetector detector;
+        detector.reset(0);
+        qint64 time = 0;
+        for (int i = 0; i < 200; i++) {
+            int interval = 500 + CLEAN_JITTER[i % JITTER_COUNT];
+            // Checked just before each heartbeat arrives
+            QVERIFY(detector.phi(time + interval - 1) < 1);
+            time += interval;
+            detector.heartbeat(time);
+        }
+    }
+
+    void silenceRaisesSuspicion() {
+        PhiAccrualDetector detector;
+        detector.reset(0);
+        qint64 last = feed(&detector, 0, 200, 500, CLEAN_JITTER);
+
+        double previous = 0;
+        for (int silence = 0; silence <= 2000; silence += 50) {
+            double phi = detector.phi(last + silence);
+            QVERIFY(phi >= previous);
+            previous = phi;
+        }
+        // A missed heartbeat is suspicious, two are a failure
+        QVERIFY(detector.phi(last + 600) < 3);
+        QVERIFY(detector.phi(last + 1000) >= 8);
+    }
+
+    void jitteryLinkIsGivenMoreSlack() {
+        PhiAccrualDetector clean, cellular;
+        clean.reset(0);
+        cellular.reset(0);
+        qint64 cleanLast = feed(&clean, 0, 200, 500, CLEAN_JITTER);
+        qint64 cellularLast = feed(&cellular, 0, 200, 500, CELLULAR_JITTER);
+
+        QVERIFY(cellular.getStdDeviation() > clean.getStdDeviation());
+        QVERIFY(clean.phi(cleanLast + 800) >= 8);
+        QVERIFY(cellular.phi(cellularLast + 800) < 3);
+    }
+
+    void resetFollowsNewCadence() {
+        PhiAccrualDetector detector;
+        detector.reset(0);
+        qint64 last = feed(&detector, 0, 100, 100, CLEAN_JITTER);
+        // Slowing to 500ms heartbeats would look like a dead link against the old history
+        QVERIFY(detector.phi(last + 500) >= 8);
+
+        detector.reset(last, 500);
+        QVERIFY(detector.phi(last + 500) < 1);
+        last = feed(&detector, last, 100, 500, CLEAN_JITTER);
+        QVERIFY(detector.phi(last + 500) < 1);
+        QVERIFY(qAbs(detector.getMeanInterval() - 500) < 10);
+    }
+
+    void driveTrafficStoppingIsNotDegradation() {
+        // A slow link keeps the client's heartbeats at their longest interval, while drive
+        // commands go out every 100ms as long as someone is driving
+        QVERIFY(connectPair(300));
+        advance(5000);
+        QSignalSpy serverDegraded(_server, &Channel::degradedChanged);
+        double maxPhi = 0;
+
+        for (int i = 0; i < 1000; i++) {
+            if (i < 500 && i % 10 == 0) {
+                QVERIFY(_client->sendMessage(QByteArray("drive")));
+            }
+            advance(10);
+            maxPhi = qMax(maxPhi, _server->getSuspicionLevel());
+        }
+
+        QCOMPARE(_server->getState(), Channel::ConnectedState);
+        QCOMPARE(serverDegraded.count(), 0);
+        QVERIFY(maxPhi < 1);
+    }
+
+    void missingHeartbeatsStillDegrade() {
+        QVERIFY(connectPair(0));
+        for (int i = 0; i < 100; i++) {
+            QVERIFY(_client->sendMessage(QByteArray("drive")));
+            advance(100);
+        }
+        QSignalSpy serverDegraded(_server, &Channel::degradedChanged);
+
+        // Still sending, but nothing gets through
+        _client->setSimulatedDelay(2000);
+        for (int i = 0; i < 8; i++) {
+            _client->sendMessage(QByteArray("drive"));
+            advance(100);
+        }
+        QVERIFY(_server->isDegraded());
+        QCOMPARE(serverDegraded.count(), 1);
+        QCOMPARE(_server->getState(), Channel::ConnectedState);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestPhiAccrual)
+
+#include "tst_phiaccrual.moc"
@@ -0,0 +1,5 @@
+TARGET = tst_poseestimator
+include(../tests.pri)
+
+SOURCES += \
+    tst_poseestimator.cpp
@@ -0,0 +1,312 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <QtTest>
+#include <cmath>
+
+#include "soro_core/poseestimator.h"
+#include "soro_core/drivemessage.h"
+#include "soro_core/virtualclock.h"
+#include "soro_core/logger.h"
+
+#define START_TIME 1500000000000LL
+#define ORIGIN_LATITUDE 35.0
+#define ORIGIN_LONGITUDE -97.0
+#define METERS_PER_DEGREE_LATITUDE 111320.0
+
+using namespace Soro;
+
+/* One leg of the synthetic drive replayed below: how long it lasts, which way the rover faces,
+ * and the wheel command
+ */
+struct DriveLeg {
+    int seconds;
+    int facing;
+    float command;
+};
+
+/* The pose estimator's GPS blending, resets, and what it learns from GPS, run on virtual time.
+ * Positions are in meters east and north of the first fix.
+ */
+class TestPoseEstimator: public QObject {
+    Q_OBJECT
+
+private:
+    VirtualClock *_clock = nullptr;
+
+    static double metersPerDegreeLongitude() {
+        return METERS_PER_DEGREE_LATITUDE * std::cos(qDegreesToRadians(ORIGIN_LATITUDE));
+    }
+
+    /* A fix this far from the origin, with a course in degrees and a ground speed in meters
+     * per second if the rover is moving
+     */
+    NmeaMessage fixAt(double east, double north, int course = -1, double speed = -1) {
+        NmeaMessage fix;
+        fix.Latitude = ORIGIN_LATITUDE + north / METERS_PER_DEGREE_LATITUDE;
+        fix.Longitude = ORIGIN_LONGITUDE + east / metersPerDegreeLongitude();
+        fix.Satellites = 8;
+        fix.Altitude = 350;
+        fix.Heading = course;
+        fix.GroundSpeed = speed >= 0 ? speed * 3.6 : -1;
+        return fix;
+    }
+
+    double metersEast(const PoseEstimate& pose) {
+        return (pose.longitudeDegrees() - ORIGIN_LONGITUDE) * metersPerDegreeLongitude();
+    }
+
+    double metersNorth(const PoseEstimate& pose) {
+        return (pose.latitudeDegrees() - ORIGIN_LATITUDE) * METERS_PER_DEGREE_LATITUDE;
+    }
+
+    double headingError(const PoseEstimate& pose, double heading) {
+        return qAbs(std::remainder(pose.headingDegrees() - heading, 360.0));
+    }
+
+    void drive(PoseEstimator *estimator, float command) {
+        char message[DriveMessage::RequiredSize];
+        message[DriveMessage::Index_LeftOuter] = GamepadUtil::axisFloatToAxisByte(command);
+        message[DriveMessage::Index_LeftMiddle] = GamepadUtil::axisFloatToAxisByte(command);
+        message[DriveMessage::Index_RightOuter] = GamepadUtil::axisFloatToAxisByte(command);
+        message[DriveMessage::Index_RightMiddle] = GamepadUtil::axisFloatToAxisByte(command);
+        estimator->driveCommand(message);
+    }
+
+    /* Drives one way for a minute with the IMU reading 10 degrees less than the real heading,
+     * sending the IMU yaw ten times a second and a fix every second at the true position
+     */
+    PoseEstimate driveWithYawError(PoseEstimator *estimator, float command, int course, double metersPerSecond) {
+        estimator->setMaxSpeed(2.0);
+        estimator->gpsUpdate(fixAt(0, 0));
+        drive(estimator, command);
+        double east = 0;
+        for (int second = 1; second <= 60; second++) {
+            for (int i = 0; i < 10; i++) {
+                estimator->yawUpdate(80);
+                _clock->advance(100);
+            }
+            east += metersPerSecond;
+            estimator->gpsUpdate(fixAt(east, 0, course, qAbs(metersPerSecond)));
+        }
+        estimator->update();
+        return estimator->getPose();
+    }
+
+private Q_SLOTS:
+    void initTestCase() {
+        Logger::rootLogger()->setMaxStdoutLevel(Logger::LogLevelError);
+    }
+
+    void init() {
+        _clock = new VirtualClock(START_TIME);
+        Clock::setRoot(_clock);
+    }
+
+    void cleanup() {
+        Clock::setRoot(nullptr);
+        delete _clock;
+        _clock = nullptr;
+    }
+
+    void fixesAreBlendedInByTheGpsGain() {
+        PoseEstimator estimator;
+        estimator.gpsUpdate(fixAt(0, 0));
+        QVERIFY(estimator.hasPose());
+
+        // Standing still, each fix pulls the estimate part of the way to it
+        _clock->advance(1000);
+        estimator.gpsUpdate(fixAt(10, 0));
+        estimator.update();
+        QVERIFY(qAbs(metersEast(estimator.getPose()) - 3.0) < 0.02);
+
+        estimator.setGpsGain(0.5);
+        _clock->advance(1000);
+        estimator.gpsUpdate(fixAt(10, 0));
+        estimator.update();
+        QVERIFY(qAbs(metersEast(estimator.getPose()) - 6.5) < 0.02);
+        QVERIFY(qAbs(estimator.getPose().accuracyMeters() - 3.0) < 0.01);
+
+        // A gain of one follows the GPS exactly
+        estimator.setGpsGain(1.0);
+        _clock->advance(1000);
+        estimator.gpsUpdate(fixAt(-4, 2));
+        estimator.update();
+        QVERIFY(qAbs(metersEast(estimator.getPose()) + 4.0) < 0.02);
+        QVERIFY(qAbs(metersNorth(estimator.getPose()) - 2.0) < 0.02);
+    }
+
+    void farFixReplacesTheEstimate() {
+        PoseEstimator estimator;
+        estimator.gpsUpdate(fixAt(0, 0));
+
+        // Just inside 25m is still blended in
+        _clock->advance(1000);
+        estimator.gpsUpdate(fixAt(24, 0));
+        estimator.update();
+        QVERIFY(qAbs(metersEast(estimator.getPose()) - 7.2) < 0.02);
+
+        // Farther than that is taken as is
+        _clock->advance(1000);
+        estimator.gpsUpdate(fixAt(33.2, 0));
+        estimator.update();
+        QVERIFY(qAbs(metersEast(estimator.getPose()) - 33.2) < 0.02);
+        QVERIFY(qAbs(estimator.getPose().accuracyMeters() - 3.0) < 0.01);
+    }
+
+    void fixAfterALongGapReplacesTheEstimate() {
+        PoseEstimator estimator;
+        estimator.gpsUpdate(fixAt(0, 0));
+
+        // Ten seconds apart is still blended in
+        _clock->advance(10000);
+        estimator.gpsUpdate(fixAt(10, 0));
+        estimator.update();
+        QVERIFY(qAbs(metersEast(estimator.getPose()) - 3.0) < 0.02);
+
+        // Any longer and the fix is taken as is
+        _clock->advance(10001);
+        estimator.gpsUpdate(fixAt(20, 0));
+        estimator.update();
+        QVERIFY(qAbs(metersEast(estimator.getPose()) - 20.0) < 0.02);
+        QCOMPARE(estimator.getPose().fixAge, (quint16)0);
+    }
+
+    void yawCorrectionIsLearnedFromTheGpsCourse_data() {
+        QTest::addColumn<float>("command");
+        QTest::addColumn<int>("course");
+        QTest::addColumn<double>("metersPerSecond");
+        // Facing east either way, so backing up the course is west
+        QTest::newRow("forward") << 1.0f << 90 << 2.0;
+        QTest::newRow("reversing") << -1.0f << 270 << -2.0;
+    }
+
+    void yawCorrectionIsLearnedFromTheGpsCourse() {
+        QFETCH(float, command);
+        QFETCH(int, course);
+        QFETCH(double, metersPerSecond);
+        PoseEstimator estimator;
+        PoseEstimate pose = driveWithYawError(&estimator, command, course, metersPerSecond);
+
+        // The 10 degrees the IMU is off by has been learned, and the estimate kept to the track
+        QVERIFY2(headingError(pose, 90) < 1, qPrintable(QString::number(pose.headingDegrees())));
+        QVERIFY(qAbs(metersEast(pose) - 60 * metersPerSecond) < 0.5);
+        QVERIFY(qAbs(metersNorth(pose)) < 0.5);
+    }
+
+    void speedPerCommandIsLearned() {
+        PoseEstimator estimator;
+        // Expected to go 2m/s at full command, but really going 1m/s
+        estimator.setMaxSpeed(2.0);
+        estimator.gpsUpdate(fixAt(0, 0));
+        drive(&estimator, 1.0);
+        for (int second = 1; second <= 60; second++) {
+            for (int i = 0; i < 10; i++) {
+                estimator.yawUpdate(90);
+                _clock->advance(100);
+            }
+            estimator.gpsUpdate(fixAt(second, 0, 90, 1.0));
+        }
+        estimator.update();
+        QVERIFY(qAbs(estimator.getPose().speedMetersPerSecond() - 1.0) < 0.02);
+        QVERIFY(qAbs(metersEast(estimator.getPose()) - 60.0) < 0.1);
+
+        // What it learned scales with the command
+        drive(&estimator, 0.5);
+        QVERIFY(qAbs(estimator.getPose().speedMetersPerSecond() - 0.5) < 0.01);
+    }
+
+    void gpsCourseIsUsedWhenYawIsStale() {
+        PoseEstimator estimator;
+        estimator.setMaxSpeed(2.0);
+        estimator.gpsUpdate(fixAt(0, 0));
+        estimator.yawUpdate(90);
+        drive(&estimator, 1.0);
+        _clock->advance(1000);
+        estimator.update();
+        QCOMPARE(estimator.getPose().headingDegrees(), 90.0);
+        QVERIFY(qAbs(metersEast(estimator.getPose()) - 2.0) < 0.02);
+
+        // Yaw more than a second old, and no course yet, so the rover could have gone anywhere
+        _clock->advance(500);
+        estimator.update();
+        QCOMPARE(estimator.getPose().headingDegrees(), 0.0);
+        QVERIFY(qAbs(metersEast(estimator.getPose()) - 2.0) < 0.02);
+        QVERIFY(qAbs(estimator.getPose().accuracyMeters() - 4.1) < 0.01);
+
+        // The GPS course is followed instead
+        _clock->advance(500);
+        estimator.gpsUpdate(fixAt(2, 0, 180, 2.0));
+        _clock->advance(1000);
+        estimator.update();
+        QCOMPARE(estimator.getPose().headingDegrees(), 180.0);
+        QVERIFY(qAbs(metersNorth(estimator.getPose()) + 2.0) < 0.02);
+    }
+
+    /* A synthetic drive, not a recording: 30m east, 30m north, a stop, then backing up 22.5m.
+     * The rover really goes 1.5m/s at full command but is expected to go 2m/s, the IMU reads 7
+     * degrees less than the real heading, and each fix is off by up to 0.8m in a fixed pattern.
+     */
+    void replaysASyntheticDriveAlongAKnownTrack() {
+        const DriveLeg legs[] = { { 20, 90, 1.0f }, { 20, 0, 1.0f }, { 5, 0, 0.0f }, { 15, 0, -1.0f } };
+        const double speed = 1.5;
+        const int imuError = -7;
+
+        PoseEstimator estimator;
+        estimator.setMaxSpeed(2.0);
+        double east = 0;
+        double north = 0;
+        double worstError = 0;
+        connect(&estimator, &PoseEstimator::poseUpdated, [&](const PoseEstimate& pose) {
+            // Give it ten seconds to learn the speed and yaw error
+            if (_clock->msecsSinceEpoch() - START_TIME < 10000) return;
+            worstError = qMax(worstError, std::hypot(metersEast(pose) - east, metersNorth(pose) - north));
+        });
+        estimator.gpsUpdate(fixAt(0, 0));
+        estimator.start(100);
+
+        int fixes = 0;
+        for (const DriveLeg& leg : legs) {
+            drive(&estimator, leg.command);
+            double step = leg.command * speed / 10;
+            for (int second = 0; second < leg.seconds; second++) {
+                for (int i = 0; i < 10; i++) {
+                    estimator.yawUpdate(leg.facing + imuError);
+                    east += step * std::sin(qDegreesToRadians((double)leg.facing));
+                    north += step * std::cos(qDegreesToRadians((double)leg.facing));
+                    _clock->advance(100);
+                }
+                fixes++;
+                int course = leg.command > 0 ? leg.facing : (leg.command < 0 ? (leg.facing + 180) % 360 : -1);
+                estimator.gpsUpdate(fixAt(east + 0.8 * std::sin(fixes * 1.3), north + 0.8 * std::cos(fixes * 0.7),
+                                          course, qAbs(leg.command) * speed));
+            }
+        }
+        estimator.stop();
+
+        PoseEstimate pose = estimator.getPose();
+        QVERIFY2(worstError < 1.5, qPrintable(QString::number(worstError)));
+        QVERIFY(std::hypot(metersEast(pose) - east, metersNorth(pose) - north) < 1.0);
+        QVERIFY(std::hypot(metersEast(pose) - east, metersNorth(pose) - north) < pose.accuracyMeters());
+        QVERIFY2(headingError(pose, 0) < 1, qPrintable(QString::number(pose.headingDegrees())));
+        QVERIFY(qAbs(pose.speedMetersPerSecond() + speed) < 0.05);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestPoseEstimator)
+
+#include "tst_poseestimator.moc"
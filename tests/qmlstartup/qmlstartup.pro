@@ -0,0 +1,25 @@
+TARGET = tst_qmlstartup
+include(../tests.pri)
+
+QT += gui qml quick quickcontrols2
+# Same as research_control, so the windows load the way they do there
+CONFIG += qtquickcompiler
+
+HEADERS += \
+    ../../research_control/hudlatencygraphimpl.h \
+    ../../research_control/hudpowerimpl.h \
+    ../../research_control/hudorientationsideimpl.h \
+    ../../research_control/hudorientationbackimpl.h \
+    ../../research_control/abstracthudorientationimpl.h
+
+SOURCES += \
+    tst_qmlstartup.cpp \
+    ../../research_control/hudlatencygraphimpl.cpp \
+    ../../research_control/hudpowerimpl.cpp \
+    ../../research_control/hudorientationsideimpl.cpp \
+    ../../research_control/hudorientationbackimpl.cpp \
+    ../../research_control/abstracthudorientationimpl.cpp
+
+RESOURCES += \
+    ../../research_control/qml.qrc \
+    ../../research_control/assets.qrc
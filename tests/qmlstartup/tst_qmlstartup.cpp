@@ -0,0 +1,133 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <QtTest>
+#include <QQmlEngine>
+#include <QQmlComponent>
+#include <QQuickWindow>
+#include <QQuickItem>
+#include <QQuickStyle>
+
+#include "research_control/hudlatencygraphimpl.h"
+#include "research_control/hudpowerimpl.h"
+#include "research_control/hudorientationsideimpl.h"
+#include "research_control/hudorientationbackimpl.h"
+
+using namespace Soro;
+
+/* Stands in for the video surface, which needs gstreamer and has nothing to do with how
+ * long the windows take to load
+ */
+class TestSurface: public QQuickItem { };
+
+/* How long mission control's main window takes to create and to put its first frame on
+ * screen, in mono and stereo. Needs a display, or -platform offscreen for the create
+ * times alone.
+ */
+class TestQmlStartup: public QObject {
+    Q_OBJECT
+
+private:
+    QQmlEngine *_engine = nullptr;
+
+    QQuickWindow* createMainWindow() {
+        QQmlComponent component(_engine, QUrl("qrc:/qml/MainWindow.qml"));
+        QQuickWindow *window = qobject_cast<QQuickWindow*>(component.create());
+        if (!window) {
+            qWarning() << component.errorString();
+        }
+        return window;
+    }
+
+private Q_SLOTS:
+    void initTestCase() {
+        qmlRegisterType<HudLatencyGraphImpl>("Soro", 1, 0, "HudLatencyGraphImpl");
+        qmlRegisterType<HudPowerImpl>("Soro", 1, 0, "HudPowerImpl");
+        qmlRegisterType<HudOrientationSideImpl>("Soro", 1, 0, "HudOrientationSideImpl");
+        qmlRegisterType<HudOrientationBackImpl>("Soro", 1, 0, "HudOrientationBackImpl");
+        qmlRegisterType<TestSurface>("Soro", 1, 0, "GStreamerSurface");
+        QQuickStyle::setStyle("Material");
+        _engine = new QQmlEngine(this);
+    }
+
+    void stereoHudIsOnlyBuiltInStereo() {
+        QQuickWindow *window = createMainWindow();
+        QVERIFY(window);
+        QQuickItem *loader = window->findChild<QQuickItem*>("stereoHudLoader");
+        QVERIFY(loader);
+        QVERIFY(!loader->property("item").value<QQuickItem*>());
+
+        // Built right away, so the right eye never goes without a HUD for a frame
+        window->setProperty("stereo", true);
+        QQuickItem *hud = loader->property("item").value<QQuickItem*>();
+        QVERIFY(hud);
+
+        // Hiding the HUD keeps it, it is only rebuilt when stereo is turned off and on again
+        window->setProperty("hudVisible", false);
+        QVERIFY(!loader->isVisible());
+        QCOMPARE(loader->property("item").value<QQuickItem*>(), hud);
+        window->setProperty("hudVisible", true);
+        QVERIFY(loader->isVisible());
+        QCOMPARE(loader->property("item").value<QQuickItem*>(), hud);
+
+        window->setProperty("stereo", false);
+        QVERIFY(!loader->property("item").value<QQuickItem*>());
+        delete window;
+    }
+
+    void benchmarkCreate_data() {
+        QTest::addColumn<bool>("stereo");
+        QTest::newRow("mono") << false;
+        QTest::newRow("stereo") << true;
+    }
+
+    void benchmarkCreate() {
+        QFETCH(bool, stereo);
+        QBENCHMARK {
+            QQuickWindow *window = createMainWindow();
+            QVERIFY(window);
+            window->setProperty("stereo", stereo);
+            delete window;
+        }
+    }
+
+    void benchmarkFirstFrame_data() {
+        benchmarkCreate_data();
+    }
+
+    void benchmarkFirstFrame() {
+        QFETCH(bool, stereo);
+        if (QGuiApplication::platformName() == "offscreen") {
+            QSKIP("Nothing is rendered without a display");
+        }
+        // From creating the window to its first frame on screen, as logged by research_control.
+        // A window only shows its first frame once, so this is a single measurement per row.
+        QElapsedTimer timer;
+        timer.start();
+        QQuickWindow *window = createMainWindow();
+        QVERIFY(window);
+        window->setProperty("stereo", stereo);
+        QSignalSpy frames(window, &QQuickWindow::frameSwapped);
+        window->show();
+        QVERIFY(frames.count() > 0 || frames.wait(5000));
+        QTest::setBenchmarkResult(timer.elapsed(), QTest::WalltimeMilliseconds);
+        delete window;
+    }
+};
+
+QTEST_MAIN(TestQmlStartup)
+
+#include "tst_qmlstartup.moc"
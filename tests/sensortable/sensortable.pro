@@ -0,0 +1,5 @@
+TARGET = tst_sensortable
+include(../tests.pri)
+
+SOURCES += \
+    tst_sensortable.cpp
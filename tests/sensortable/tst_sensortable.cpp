@@ -0,0 +1,290 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <QtTest>
+#include <cmath>
+
+#include "soro_core/sensortable.h"
+#include "soro_core/sensordataparser.h"
+#include "soro_core/csvrecorder.h"
+#include "soro_core/virtualclock.h"
+#include "soro_core/logger.h"
+
+#define START_TIME 1500000000000LL
+
+using namespace Soro;
+
+/* One of the hand written series the sensor parser used to have per tag
+ */
+class OldSensorSeries: public CsvDataSeries {
+public:
+    OldSensorSeries(QString name) : _name(name) { }
+    QString getSeriesName() const { return _name; }
+    bool shouldKeepOldValues() const { return true; }
+    void set(QVariant value) { update(value); }
+
+private:
+    QString _name;
+};
+
+/* The sensor parser as it was before the sensor table, with its series in the order the data
+ * recorder used to add them
+ */
+class OldSensorParser {
+public:
+    QList<QPair<char, int>> parsed;
+    QList<OldSensorSeries*> columns;
+
+    OldSensorParser() {
+        const char *tags = "ABCDEFLJKXYZPQR";
+        const char *names[] = {
+            "Wheel A Power", "Wheel B Power", "Wheel C Power", "Wheel D Power", "Wheel E Power", "Wheel F Power",
+            "Rear Yaw", "Rear Pitch", "Rear Roll", "Middle Yaw", "Middle Pitch", "Middle Roll",
+            "Front Yaw", "Front Pitch", "Front Roll"
+        };
+        for (int i = 0; i < 15; i++) {
+            OldSensorSeries *series = new OldSensorSeries(names[i]);
+            _series.insert(tags[i], series);
+            columns.append(series);
+        }
+    }
+
+    ~OldSensorParser() {
+        qDeleteAll(columns);
+    }
+
+    void newData(const char *data, int len) {
+        _buffer.append(data, len);
+        parseBuffer();
+    }
+
+private:
+    QByteArray _buffer;
+    QHash<char, OldSensorSeries*> _series;
+
+    void parseBuffer() {
+        if (_buffer.length() < 4) return;
+        char tag = _buffer.at(0);
+        bool ok;
+        float data = QString(_buffer.mid(1, 3)).toFloat(&ok);
+        if (ok && _series.contains(tag)) {
+            _series[tag]->set(QVariant(data));
+            parsed.append(qMakePair(tag, static_cast<int>(data)));
+            _buffer.remove(0, 4);
+        }
+        else {
+            _buffer.remove(0, 1);
+        }
+        parseBuffer();
+    }
+};
+
+/* What the main window controller used to set on the HUD for a reading, before the sensor table
+ */
+static bool oldHudUpdate(char tag, int value, QString *property, double *converted) {
+    static const QHash<char, QString> properties {
+        { 'A', "wheelMLPower" }, { 'B', "wheelFLPower" }, { 'C', "wheelFRPower" },
+        { 'D', "wheelMRPower" }, { 'E', "wheelBRPower" }, { 'F', "wheelBLPower" },
+        { 'J', "rearPitch" }, { 'K', "rearRoll" }, { 'Q', "frontPitch" }, { 'R', "frontRoll" },
+        { 'Y', "middlePitch" }, { 'Z', "middleRoll" }, { 'P', "compassHeading" }
+    };
+    if (!properties.contains(tag)) return false;
+    *property = properties[tag];
+    *converted = tag == 'P' ? ((100 - value) * 360.0f / 800.0f) - 130 : value;
+    return true;
+}
+
+/* Mbed output with readings for every tag, split at odd places and mixed with line noise
+ */
+static QList<QByteArray> mbedStream() {
+    const char *tags = "ABCDEFLJKXYZPQR";
+    quint32 seed = 12345;
+    auto random = [&seed](int bound) {
+        seed = seed * 1103515245 + 12345;
+        return static_cast<int>((seed >> 16) % bound);
+    };
+    QByteArray stream;
+    for (int i = 0; i < 600; i++) {
+        switch (random(10)) {
+        case 0:
+            // A tag nothing uses, or a reading cut short
+            stream += "?" + QByteArray::number(random(1000)).rightJustified(3, '0');
+            break;
+        case 1:
+            stream += QByteArray(1, tags[random(15)]) + "1x";
+            break;
+        default:
+            stream += QByteArray(1, tags[random(15)]) + QByteArray::number(random(1000)).rightJustified(3, '0');
+            break;
+        }
+    }
+    QList<QByteArray> chunks;
+    for (int pos = 0; pos < stream.size();) {
+        int length = 1 + random(23);
+        chunks.append(stream.mid(pos, length));
+        pos += length;
+    }
+    return chunks;
+}
+
+/* Sensor table conversions, checked offline against the rover's calibration, and raw mbed
+ * readings parsed into the units the rover feeds its pose estimator. The parser's recorded
+ * columns and HUD updates are compared with what it gave before the sensor table.
+ */
+class TestSensorTable: public QObject {
+    Q_OBJECT
+
+private:
+    VirtualClock *_clock = nullptr;
+
+private Q_SLOTS:
+    void initTestCase() {
+        Logger::rootLogger()->setMaxStdoutLevel(Logger::LogLevelError);
+    }
+
+    void init() {
+        _clock = new VirtualClock(START_TIME);
+        Clock::setRoot(_clock);
+    }
+
+    void cleanup() {
+        Clock::setRoot(nullptr);
+        delete _clock;
+        _clock = nullptr;
+    }
+
+    void frontYawMatchesCalibration() {
+        const SensorDefinition *front = SensorTable::find(SensorDataParser::DATATAG_IMUDATA_FRONT_YAW);
+        QVERIFY(front);
+        for (int raw = 0; raw < 800; raw++) {
+            double calibrated = ((100 - raw) * 360.0 / 800.0) - 130;
+            QVERIFY2(qAbs(front->toUnits(raw) - calibrated) < 1e-3, qPrintable(QString::number(raw)));
+        }
+    }
+
+    void middleYawIsDegrees() {
+        const SensorDefinition *middle = SensorTable::find(SensorDataParser::DATATAG_IMUDATA_MIDDLE_YAW);
+        QVERIFY(middle);
+        QCOMPARE(QString(middle->unit), QString("degrees"));
+        // 800 counts to a turn, counting the opposite way to a compass
+        QVERIFY(qAbs(middle->toUnits(800) - middle->toUnits(0) + 360) < 1e-3);
+        QVERIFY(qAbs(middle->toUnits(200) - middle->toUnits(0) + 90) < 1e-3);
+        // Same counts per turn as the calibrated front IMU
+        const SensorDefinition *front = SensorTable::find(SensorDataParser::DATATAG_IMUDATA_FRONT_YAW);
+        QCOMPARE(middle->scale, front->scale);
+    }
+
+    void rawYawParsesToItsHeading_data() {
+        QTest::addColumn<int>("rawYaw");
+        QTest::addColumn<double>("heading");
+        QTest::newRow("north") << 0 << 0.0;
+        QTest::newRow("west") << 200 << 270.0;
+        QTest::newRow("south") << 400 << 180.0;
+        QTest::newRow("east") << 600 << 90.0;
+    }
+
+    void rawYawParsesToItsHeading() {
+        QFETCH(int, rawYaw);
+        QFETCH(double, heading);
+        SensorDataParser parser;
+        const SensorDefinition *yaw = SensorTable::find(SensorDataParser::DATATAG_IMUDATA_MIDDLE_YAW);
+        QList<double> yaws;
+        connect(&parser, &SensorDataParser::dataParsed, [&yaws, yaw](char tag, int value) {
+            if (tag == yaw->tag) {
+                yaws.append(yaw->toUnits(value));
+            }
+        });
+        QByteArray reading = "X" + QByteArray::number(rawYaw).rightJustified(3, '0');
+        parser.newData(reading.constData(), reading.size());
+
+        QVERIFY(!yaws.isEmpty());
+        double degrees = std::fmod(yaws.first(), 360.0);
+        QVERIFY2(qAbs((degrees < 0 ? degrees + 360.0 : degrees) - heading) < 1e-3, qPrintable(QString::number(yaws.first())));
+    }
+
+    void parsesLikeTheOldParser() {
+        SensorDataParser parser;
+        OldSensorParser oldParser;
+        QList<QPair<char, int>> parsed;
+        connect(&parser, &SensorDataParser::dataParsed, [&parsed](char tag, int value) {
+            parsed.append(qMakePair(tag, value));
+        });
+        for (const QByteArray& chunk : mbedStream()) {
+            parser.newData(chunk.constData(), chunk.size());
+            oldParser.newData(chunk.constData(), chunk.size());
+        }
+        QVERIFY(oldParser.parsed.size() > 400);
+        QCOMPARE(parsed, oldParser.parsed);
+    }
+
+    void recordsLikeTheOldSeries() {
+        SensorDataParser parser;
+        OldSensorParser oldParser;
+        CsvRecorder recorder("tst_sensortable_new");
+        CsvRecorder oldRecorder("tst_sensortable_old");
+        parser.addColumns(&recorder);
+        for (OldSensorSeries *series : oldParser.columns) {
+            oldRecorder.addColumn(series);
+        }
+        recorder.setUpdateInterval(100);
+        oldRecorder.setUpdateInterval(100);
+        QDateTime start = QDateTime::fromMSecsSinceEpoch(_clock->msecsSinceEpoch());
+        QVERIFY(recorder.startLog(start, CsvRecorder::RECORDING_MODE_ON_INTERVAL));
+        QVERIFY(oldRecorder.startLog(start, CsvRecorder::RECORDING_MODE_ON_INTERVAL));
+
+        for (const QByteArray& chunk : mbedStream()) {
+            parser.newData(chunk.constData(), chunk.size());
+            oldParser.newData(chunk.constData(), chunk.size());
+            _clock->advance(37);
+        }
+        recorder.stopLog();
+        oldRecorder.stopLog();
+
+        QByteArray contents[2];
+        QString names[] = { "tst_sensortable_new", "tst_sensortable_old" };
+        for (int i = 0; i < 2; i++) {
+            QFile file(QCoreApplication::applicationDirPath() + "/../research_data/" + names[i] + "_"
+                       + start.toString("M-dd_h.mm.ss_AP") + ".csv");
+            QVERIFY(file.open(QIODevice::ReadOnly));
+            contents[i] = file.readAll();
+            file.close();
+            file.remove();
+        }
+        QVERIFY(contents[0].count('\n') > 100);
+        QCOMPARE(contents[0], contents[1]);
+    }
+
+    void hudUpdatesLikeBefore() {
+        for (char tag : QByteArray("ABCDEFLJKXYZPQR?")) {
+            for (int value = 0; value < 1000; value++) {
+                QString oldProperty;
+                double oldValue = 0;
+                bool oldUpdated = oldHudUpdate(tag, value, &oldProperty, &oldValue);
+                const SensorDefinition *sensor = SensorTable::find(tag);
+                bool updated = sensor && sensor->hudProperty;
+                QCOMPARE(updated, oldUpdated);
+                if (!updated) continue;
+                QCOMPARE(QString(sensor->hudProperty), oldProperty);
+                QVERIFY2(qAbs(sensor->toUnits(value) - oldValue) < 1e-3,
+                         qPrintable(QString(tag) + QString::number(value)));
+            }
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(TestSensorTable)
+
+#include "tst_sensortable.moc"
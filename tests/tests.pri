@@ -0,0 +1,25 @@
+# Common setup for every test, include this from each test's .pro after setting TARGET.
+# Run all of them with "make check" from the build directory.
+
+QT += core network testlib
+QT -= gui
+
+CONFIG += c++11 no_keywords
+CONFIG += console testcase
+CONFIG -= app_bundle
+TEMPLATE = app
+
+BUILD_DIR = ../../build/tests/$$TARGET
+DESTDIR = ../../bin/tests
+OBJECTS_DIR = $$BUILD_DIR
+MOC_DIR = $$BUILD_DIR
+RCC_DIR = $$BUILD_DIR
+UI_DIR = $$BUILD_DIR
+PRECOMPILED_DIR = $$BUILD_DIR
+
+# Include headers from other subprojects
+INCLUDEPATH += $$PWD/..
+
+LIBS += -L../../lib -lsoro_core
+# So "make check" finds soro_core without it being installed
+QMAKE_RPATHDIR += $$OUT_PWD/../../lib
@@ -0,0 +1,17 @@
+TEMPLATE = subdirs
+
+SUBDIRS =\
+    virtualclock \
+    channeltiming \
+    phiaccrual \
+    multipath \
+    wirecodec \
+    qmlstartup \
+    tracer \
+    memorybudget \
+    videogovernor \
+    executor \
+    gpsserver \
+    sensortable \
+    controlbudget \
+    poseestimator
@@ -0,0 +1,5 @@
+TARGET = tst_tracer
+include(../tests.pri)
+
+SOURCES += \
+    tst_tracer.cpp
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <QtTest>
+
+#include "soro_core/tracer.h"
+#include "soro_core/logger.h"
+
+using namespace Soro;
+
+/* Records a few events on a thread of its own, then exits
+ */
+class TracedThread: public QThread {
+protected:
+    void run() {
+        Tracer::setThreadName("traced");
+        for (int i = 0; i < 10; i++) {
+            TRACE_SPAN("test", "exitedThreadSpan");
+        }
+    }
+};
+
+/* Records an event, then stays alive until it is released
+ */
+class ReusingThread: public QThread {
+public:
+    QSemaphore recorded;
+    QSemaphore release;
+
+protected:
+    void run() {
+        Tracer::setThreadName("reused");
+        TRACE_INSTANT("test", "reusedThreadEvent");
+        recorded.release();
+        release.acquire();
+    }
+};
+
+class TestTracer: public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir _directory;
+
+    QString readTrace(QString path) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) return QString();
+        return QString::fromUtf8(file.readAll());
+    }
+
+    /* Dumps until an event is no longer in the dump. A thread hands its buffer back a little
+     * after QThread::wait() returns, so the first dump after that may still find it running.
+     */
+    bool dumpUntilGone(QString event) {
+        QString path = _directory.path() + "/gone.json";
+        for (int i = 0; i < 100; i++) {
+            if (!Tracer::root()->writeJson(path)) return false;
+            if (!readTrace(path).contains("\"" + event + "\"")) return true;
+            QThread::msleep(50);
+        }
+        return false;
+    }
+
+private Q_SLOTS:
+    void initTestCase() {
+        Logger::rootLogger()->setMaxStdoutLevel(Logger::LogLevelError);
+        QVERIFY(_directory.isValid());
+        Tracer::root()->setDumpDirectory(_directory.path(), "tst_tracer");
+    }
+
+    void dumpIsWrittenOffTheCallingThread() {
+        QSignalSpy dumped(Tracer::root(), &Tracer::dumped);
+        TRACE_INSTANT("test", "beforeDump");
+        Tracer::root()->dump("async");
+        // Nothing is emitted until the executor has written the file and the event loop gets it back
+        QCOMPARE(dumped.count(), 0);
+        QVERIFY(dumped.wait(5000));
+        QCOMPARE(dumped.at(0).at(1).toString(), QString("async"));
+        QString trace = readTrace(dumped.at(0).at(0).toString());
+        QVERIFY(trace.contains("\"beforeDump\""));
+        QVERIFY(trace.contains("\"tst_tracer\""));
+    }
+
+    void exitedThreadsAreDumpedBeforeBeingLetGo() {
+        TracedThread thread;
+        thread.start();
+        QVERIFY(thread.wait(5000));
+
+        QString path = _directory.path() + "/exited.json";
+        QVERIFY(Tracer::root()->writeJson(path));
+        QVERIFY(readTrace(path).contains("\"exitedThreadSpan\""));
+        QVERIFY(readTrace(path).contains("\"traced\""));
+
+        // Its buffer is let go once a dump has its events, rather than kept forever
+        QVERIFY(dumpUntilGone("exitedThreadSpan"));
+    }
+
+    void recycledBuffersStartEmpty() {
+        TracedThread first;
+        first.start();
+        QVERIFY(first.wait(5000));
+        QVERIFY(dumpUntilGone("exitedThreadSpan"));
+
+        // Gets the buffer the first thread left, without any of its events
+        ReusingThread second;
+        second.start();
+        QVERIFY(second.recorded.tryAcquire(1, 5000));
+        QString path = _directory.path() + "/reused.json";
+        QVERIFY(Tracer::root()->writeJson(path));
+        second.release.release();
+        QVERIFY(second.wait(5000));
+        QString trace = readTrace(path);
+        QVERIFY(trace.contains("\"reusedThreadEvent\""));
+        QVERIFY(!trace.contains("\"exitedThreadSpan\""));
+    }
+};
+
+QTEST_GUILESS_MAIN(TestTracer)
+
+#include "tst_tracer.moc"
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <QtTest>
+
+#include "soro_core/videogovernor.h"
+#include "soro_core/logger.h"
+
+using namespace Soro;
+
+/* The governor reading a synthetic /sys/class/thermal and /proc/stat, so every sample sees exactly
+ * the temperature and CPU time the test wrote.
+ */
+class TestVideoGovernor: public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir *_directory = nullptr;
+    VideoGovernor *_governor = nullptr;
+    quint64 _busyTicks = 0;
+    quint64 _idleTicks = 0;
+
+    QString statPath() {
+        return _directory->path() + "/stat";
+    }
+
+    void writeFile(QString path, QString contents) {
+        QDir().mkpath(QFileInfo(path).path());
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(contents.toLatin1());
+    }
+
+    void setTemperature(qint32 temperature) {
+        writeFile(_directory->path() + "/thermal/thermal_zone0/temp", QString::number(temperature) + "\n");
+    }
+
+    /* Moves the CPU time counters on by this many ticks, split between busy and idle
+     */
+    void runCpu(quint64 busy, quint64 idle) {
+        _busyTicks += busy;
+        _idleTicks += idle;
+        // Busy time is spread over user, system and irq, idle time over idle and iowait
+        writeFile(statPath(), QString("cpu  %1 0 %2 %3 %4 %5 0 0 0 0\ncpu0 0 0 0 0 0 0 0 0 0 0\nintr 0\n")
+                  .arg(_busyTicks / 2).arg(_busyTicks / 4).arg(_idleTicks - _idleTicks / 4)
+                  .arg(_idleTicks / 4).arg(_busyTicks - _busyTicks / 2 - _busyTicks / 4));
+    }
+
+private Q_SLOTS:
+    void initTestCase() {
+        Logger::rootLogger()->setMaxStdoutLevel(Logger::LogLevelError);
+    }
+
+    void init() {
+        _directory = new QTemporaryDir;
+        QVERIFY(_directory->isValid());
+        _busyTicks = _idleTicks = 0;
+        setTemperature(50000);
+        writeFile(_directory->path() + "/thermal/thermal_zone0/trip_point_0_type", "passive\n");
+        writeFile(_directory->path() + "/thermal/thermal_zone0/trip_point_0_temp", "85000\n");
+        writeFile(_directory->path() + "/thermal/thermal_zone0/trip_point_1_type", "critical\n");
+        writeFile(_directory->path() + "/thermal/thermal_zone0/trip_point_1_temp", "70000\n");
+        runCpu(100000, 100000);
+
+        _governor = new VideoGovernor;
+        _governor->setThermalPath(_directory->path() + "/thermal");
+        _governor->setCpuStatPath(statPath());
+        _governor->setMaxLoad(950);
+        _governor->setMaxFrameDeficit(0);
+        _governor->setStepDownDelay(0);
+        _governor->setStepUpDelay(0);
+        // The first sample only has counters to compare the next one to
+        _governor->sample();
+    }
+
+    void cleanup() {
+        delete _governor;
+        _governor = nullptr;
+        delete _directory;
+        _directory = nullptr;
+    }
+
+    void loadIsCpuUseSinceLastSample() {
+        QCOMPARE(_governor->getState().load, (quint16)0);
+        runCpu(300, 700);
+        _governor->sample();
+        QCOMPARE(_governor->getState().load, (quint16)300);
+        // A long busy history before the interval doesn't count
+        runCpu(100, 0);
+        _governor->sample();
+        QCOMPARE(_governor->getState().load, (quint16)1000);
+        // Counters that didn't move give no load rather than a division by zero
+        _governor->sample();
+        QCOMPARE(_governor->getState().load, (quint16)0);
+    }
+
+    void busyCpuStepsDownOnTheNextSample() {
+        runCpu(990, 10);
+        _governor->sample();
+        QCOMPARE(_governor->getLevel(), 1);
+        QVERIFY(_governor->getState().reason.startsWith("load"));
+
+        // Three quarters of the maximum is still too busy to step back up
+        runCpu(800, 200);
+        _governor->sample();
+        QCOMPARE(_governor->getLevel(), 1);
+        runCpu(100, 900);
+        _governor->sample();
+        QCOMPARE(_governor->getLevel(), 0);
+        QCOMPARE(_governor->getState().reason, QString("recovered"));
+    }
+
+    void stepDownDelayHoldsTheLevel() {
+        _governor->setStepDownDelay(60000);
+        for (int i = 0; i < 5; i++) {
+            runCpu(1000, 0);
+            _governor->sample();
+        }
+        QCOMPARE(_governor->getLevel(), 1);
+    }
+
+    void hotZoneStepsDownBeforeThePassiveTrip() {
+        _governor->setMargin(10000);
+        _governor->setHysteresis(5000);
+        setTemperature(74000);
+        runCpu(0, 1000);
+        _governor->sample();
+        QCOMPARE(_governor->getLevel(), 0);
+        // Throttling starts at the passive trip point, critical ones are ignored
+        QCOMPARE(_governor->getState().throttleTemperature, 85000);
+
+        setTemperature(75000);
+        runCpu(0, 1000);
+        _governor->sample();
+        QCOMPARE(_governor->getLevel(), 1);
+
+        // Under the margin but not past the hysteresis
+        setTemperature(72000);
+        runCpu(0, 1000);
+        _governor->sample();
+        QCOMPARE(_governor->getLevel(), 1);
+        setTemperature(69000);
+        runCpu(0, 1000);
+        _governor->sample();
+        QCOMPARE(_governor->getLevel(), 0);
+    }
+
+    void unreadableFilesAreIgnored() {
+        _governor->setThermalPath(_directory->path() + "/missing");
+        _governor->setCpuStatPath(_directory->path() + "/missing");
+        _governor->sample();
+        QCOMPARE(_governor->getState().temperature, VideoGovernorState::NoTemperature);
+        QCOMPARE(_governor->getState().load, (quint16)0);
+
+        writeFile(statPath(), "garbage\n");
+        _governor->setCpuStatPath(statPath());
+        _governor->sample();
+        QCOMPARE(_governor->getState().load, (quint16)0);
+        QCOMPARE(_governor->getLevel(), 0);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestVideoGovernor)
+
+#include "tst_videogovernor.moc"
@@ -0,0 +1,5 @@
+TARGET = tst_videogovernor
+include(../tests.pri)
+
+SOURCES += \
+    tst_videogovernor.cpp
@@ -0,0 +1,166 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <QtTest>
+
+#include "soro_core/virtualclock.h"
+#include "soro_core/csvrecorder.h"
+#include "soro_core/logger.h"
+
+#define START_TIME 1500000000000LL
+
+using namespace Soro;
+
+/* Counts timer events, and kills its timer after a set number of them
+ */
+class TimerCounter: public QObject {
+public:
+    QList<qint64> fireTimes;
+    int timerId = TIMER_INACTIVE;
+    int killAfter = -1;
+
+protected:
+    void timerEvent(QTimerEvent *e) {
+        if (e->timerId() != timerId) return;
+        fireTimes.append(Clock::root()->msecsSinceEpoch());
+        if (fireTimes.size() == killAfter) {
+            KILL_TIMER(timerId);
+        }
+    }
+};
+
+class TestSeries: public CsvDataSeries {
+public:
+    QString getSeriesName() const { return "Test"; }
+    bool shouldKeepOldValues() const { return false; }
+    void set(QVariant value) { update(value); }
+};
+
+class TestVirtualClock: public QObject {
+    Q_OBJECT
+
+private:
+    VirtualClock *_clock = nullptr;
+
+private Q_SLOTS:
+    void initTestCase() {
+        Logger::rootLogger()->setMaxStdoutLevel(Logger::LogLevelWarning);
+    }
+
+    void init() {
+        _clock = new VirtualClock(START_TIME);
+        Clock::setRoot(_clock);
+    }
+
+    void cleanup() {
+        Clock::setRoot(nullptr);
+        delete _clock;
+        _clock = nullptr;
+    }
+
+    void timersFireOnVirtualTimeOnly() {
+        TimerCounter counter;
+        counter.timerId = Clock::root()->startTimer(&counter, 100);
+
+        // Real time passing does nothing
+        QTest::qWait(150);
+        QCOMPARE(counter.fireTimes.size(), 0);
+
+        _clock->advance(350);
+        QCOMPARE(counter.fireTimes, QList<qint64>() << START_TIME + 100 << START_TIME + 200 << START_TIME + 300);
+        QCOMPARE(_clock->msecsSinceEpoch(), START_TIME + 350);
+        QCOMPARE(_clock->getNextDueTime(), START_TIME + 400);
+    }
+
+    void timersFireInDueOrder() {
+        QList<int> order;
+        Clock::root()->singleShot(30, this, [&order]() { order.append(30); });
+        Clock::root()->singleShot(10, this, [&order]() { order.append(10); });
+        Clock::root()->singleShot(20, this, [&order]() { order.append(20); });
+        // Same due time, fires after the one started first
+        Clock::root()->singleShot(10, this, [&order]() { order.append(11); });
+
+        _clock->advance(100);
+        QCOMPARE(order, QList<int>() << 10 << 11 << 20 << 30);
+        QCOMPARE(_clock->getPendingTimerCount(), 0);
+    }
+
+    void timerCanKillItselfWhileFiring() {
+        TimerCounter counter;
+        counter.killAfter = 2;
+        counter.timerId = Clock::root()->startTimer(&counter, 50);
+
+        _clock->advance(1000);
+        QCOMPARE(counter.fireTimes.size(), 2);
+        QCOMPARE(counter.timerId, TIMER_INACTIVE);
+        QCOMPARE(_clock->getPendingTimerCount(), 0);
+    }
+
+    void singleShotsStartedWhileAdvancingFire() {
+        QList<qint64> times;
+        Clock::root()->singleShot(100, this, [this, &times]() {
+            times.append(_clock->msecsSinceEpoch());
+            Clock::root()->singleShot(100, this, [this, &times]() {
+                times.append(_clock->msecsSinceEpoch());
+            });
+        });
+
+        _clock->advance(250);
+        QCOMPARE(times, QList<qint64>() << START_TIME + 100 << START_TIME + 200);
+    }
+
+    void destroyedReceiverIsSkipped() {
+        TimerCounter *counter = new TimerCounter;
+        counter->timerId = Clock::root()->startTimer(counter, 10);
+        delete counter;
+
+        _clock->advance(100);
+        QCOMPARE(_clock->getPendingTimerCount(), 0);
+    }
+
+    void recorderWritesOneRowPerInterval() {
+        TestSeries series;
+        CsvRecorder recorder("tst_virtualclock");
+        recorder.addColumn(&series);
+        recorder.setUpdateInterval(100);
+        QDateTime start = QDateTime::fromMSecsSinceEpoch(_clock->msecsSinceEpoch());
+        QVERIFY(recorder.startLog(start, CsvRecorder::RECORDING_MODE_ON_INTERVAL));
+
+        for (int i = 0; i < 10; i++) {
+            _clock->advance(50);
+            series.set(i);
+            _clock->advance(50);
+        }
+        recorder.stopLog();
+
+        QFile file(QCoreApplication::applicationDirPath() + "/../research_data/tst_virtualclock_"
+                   + start.toString("M-dd_h.mm.ss_AP") + ".csv");
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QStringList lines = QString::fromUtf8(file.readAll()).split("\n", QString::SkipEmptyParts);
+        file.close();
+        file.remove();
+
+        // Header lines, then one row per 100ms with the value set 50ms into the interval
+        QCOMPARE(lines.size(), 3 + 10);
+        for (int i = 0; i < 10; i++) {
+            QCOMPARE(lines[3 + i], QString::number(i) + "," + QString::number(i * 100 + 50) + ",");
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(TestVirtualClock)
+
+#include "tst_virtualclock.moc"
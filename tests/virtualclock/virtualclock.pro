@@ -0,0 +1,5 @@
+TARGET = tst_virtualclock
+include(../tests.pri)
+
+SOURCES += \
+    tst_virtualclock.cpp
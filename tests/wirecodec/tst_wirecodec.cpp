@@ -0,0 +1,278 @@
+/*
+ * Copyright 2017 The University of Oklahoma.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <QtTest>
+#include <cmath>
+#include <limits>
+
+#include "soro_core/wirecodec.h"
+
+using namespace Soro;
+
+/* Byte at a time big-endian serialization, the way it was done before the codec. Kept
+ * here as the reference the codec has to match on the wire, and to benchmark against.
+ */
+template <typename T>
+static void loopSerialize(char *dest, T value) {
+    for (size_t i = 0; i < sizeof(T); i++) {
+        dest[i] = (char)((quint64)value >> ((sizeof(T) - i - 1) * 8));
+    }
+}
+
+template <typename T>
+static T loopDeserialize(const char *src) {
+    T result = 0;
+    for (size_t i = 0; i < sizeof(T); i++) {
+        result = (T)(((quint64)result << 8) | (quint8)src[i]);
+    }
+    return result;
+}
+
+/* Every value with a single bit set, a single bit clear, and the extremes
+ */
+template <typename T>
+static QList<T> bitPatterns() {
+    typedef typename Wire::Bits<sizeof(T)>::Type U;
+    QList<T> values;
+    values << std::numeric_limits<T>::min() << std::numeric_limits<T>::max() << (T)0 << (T)-1;
+    for (size_t bit = 0; bit < sizeof(T) * 8; bit++) {
+        values << (T)((U)1 << bit) << (T)~((U)1 << bit);
+    }
+    return values;
+}
+
+class TestWireCodec: public QObject {
+    Q_OBJECT
+
+private:
+    template <typename T>
+    void roundTrip(const QList<T>& values) {
+        // One byte of offset so every value is unaligned
+        char buffer[sizeof(T) + 1];
+        char reference[sizeof(T)];
+        for (T value : values) {
+            Wire::store<T>(buffer + 1, value);
+            QCOMPARE(Wire::load<T>(buffer + 1), value);
+            // Network order, the same bytes the old loops put on the wire
+            loopSerialize<T>(reference, value);
+            QCOMPARE(memcmp(buffer + 1, reference, sizeof(T)), 0);
+            QCOMPARE(loopDeserialize<T>(buffer + 1), value);
+        }
+    }
+
+private Q_SLOTS:
+    void bytesAreInNetworkOrder() {
+        char buffer[8];
+        Wire::store<quint32>(buffer, 0x01020304);
+        QCOMPARE(QByteArray(buffer, 4), QByteArray("\x01\x02\x03\x04", 4));
+        Wire::store<qint16>(buffer, -2);
+        QCOMPARE(QByteArray(buffer, 2), QByteArray("\xFF\xFE", 2));
+        Wire::store<quint64>(buffer, Q_UINT64_C(0x0102030405060708));
+        QCOMPARE(QByteArray(buffer, 8), QByteArray("\x01\x02\x03\x04\x05\x06\x07\x08", 8));
+    }
+
+    void sixteenBitValuesRoundTrip() {
+        // Small enough to try every value
+        QList<quint16> unsignedValues;
+        QList<qint16> signedValues;
+        for (int i = 0; i <= 0xFFFF; i++) {
+            unsignedValues << (quint16)i;
+            signedValues << (qint16)i;
+        }
+        roundTrip(unsignedValues);
+        roundTrip(signedValues);
+    }
+
+    void integersRoundTrip() {
+        QList<quint8> bytes;
+        for (int i = 0; i <= 0xFF; i++) bytes << (quint8)i;
+        roundTrip(bytes);
+        roundTrip(bitPatterns<qint32>());
+        roundTrip(bitPatterns<quint32>());
+        roundTrip(bitPatterns<qint64>());
+        roundTrip(bitPatterns<quint64>());
+    }
+
+    void floatsRoundTrip() {
+        char buffer[9];
+        QList<float> floats;
+        floats << 0.0f << -0.0f << 1.5f << -273.15f << std::numeric_limits<float>::min()
+               << std::numeric_limits<float>::max() << std::numeric_limits<float>::denorm_min()
+               << std::numeric_limits<float>::infinity() << -std::numeric_limits<float>::infinity();
+        for (float value : floats) {
+            Wire::store<float>(buffer + 1, value);
+            float result = Wire::load<float>(buffer + 1);
+            // Compared bit for bit, so -0 and 0 are told apart
+            QCOMPARE(memcmp(&result, &value, sizeof(float)), 0);
+        }
+        QList<double> doubles;
+        doubles << 0.0 << -0.0 << 35.2058123 << -97.4457891 << std::numeric_limits<double>::min()
+                << std::numeric_limits<double>::max() << std::numeric_limits<double>::denorm_min()
+                << std::numeric_limits<double>::infinity();
+        for (double value : doubles) {
+            Wire::store<double>(buffer + 1, value);
+            double result = Wire::load<double>(buffer + 1);
+            QCOMPARE(memcmp(&result, &value, sizeof(double)), 0);
+        }
+        Wire::store<double>(buffer + 1, std::numeric_limits<double>::quiet_NaN());
+        QVERIFY(std::isnan(Wire::load<double>(buffer + 1)));
+    }
+
+    void varintsRoundTrip() {
+        char buffer[Wire::MaxVarintSize];
+        QList<quint64> values;
+        // Values either side of every length boundary
+        for (int bits = 0; bits <= 63; bits += 7) {
+            quint64 boundary = Q_UINT64_C(1) << bits;
+            values << boundary - 1 << boundary << boundary + 1;
+        }
+        values << std::numeric_limits<quint64>::max();
+        for (quint64 value : values) {
+            int size = Wire::storeVarint(buffer, value);
+            int expected = 1;
+            for (quint64 rest = value >> 7; rest != 0; rest >>= 7) expected++;
+            QCOMPARE(size, expected);
+            quint64 result;
+            QCOMPARE(Wire::loadVarint(buffer, size, &result), size);
+            QCOMPARE(result, value);
+            // One byte short is truncated
+            QCOMPARE(Wire::loadVarint(buffer, size - 1, &result), 0);
+        }
+        for (qint64 value : bitPatterns<qint64>()) {
+            QCOMPARE(Wire::zigzagDecode(Wire::zigzagEncode(value)), value);
+        }
+        QCOMPARE(Wire::zigzagEncode(-1), Q_UINT64_C(1));
+        QCOMPARE(Wire::zigzagEncode(1), Q_UINT64_C(2));
+    }
+
+    void overlongVarintIsRejected() {
+        char buffer[11];
+        memset(buffer, 0xFF, sizeof(buffer));
+        quint64 result;
+        QCOMPARE(Wire::loadVarint(buffer, sizeof(buffer), &result), 0);
+        // 10 bytes, but more than 64 bits
+        memset(buffer, 0x80, 9);
+        buffer[9] = 0x02;
+        QCOMPARE(Wire::loadVarint(buffer, 10, &result), 0);
+    }
+
+    void writerAndReaderRoundTrip() {
+        char buffer[64];
+        Wire::Writer writer(buffer, sizeof(buffer));
+        writer.write<quint16>(1200);
+        writer.write<quint8>(3);
+        writer.write<quint32>(0xDEADBEEF);
+        writer.write<double>(-97.4457891);
+        writer.writeVarint(300);
+        writer.writeSignedVarint(-300);
+        writer.writeBytes("drive", 5);
+        QVERIFY(writer.ok());
+
+        Wire::Reader reader(buffer, writer.position());
+        QCOMPARE(reader.read<quint16>(), (quint16)1200);
+        QCOMPARE(reader.read<quint8>(), (quint8)3);
+        QCOMPARE(reader.read<quint32>(), (quint32)0xDEADBEEF);
+        QCOMPARE(reader.read<double>(), -97.4457891);
+        quint64 varint;
+        QVERIFY(reader.readVarint(&varint));
+        QCOMPARE(varint, Q_UINT64_C(300));
+        qint64 signedVarint;
+        QVERIFY(reader.readSignedVarint(&signedVarint));
+        QCOMPARE(signedVarint, Q_INT64_C(-300));
+        char bytes[5];
+        QVERIFY(reader.readBytes(bytes, 5));
+        QCOMPARE(QByteArray(bytes, 5), QByteArray("drive"));
+        QVERIFY(reader.ok());
+        QCOMPARE(reader.remaining(), (size_t)0);
+    }
+
+    void writerFailureIsSticky() {
+        char buffer[6];
+        Wire::Writer writer(buffer, sizeof(buffer));
+        QVERIFY(writer.write<quint32>(1));
+        // Doesn't fit, and writes nothing
+        QVERIFY(!writer.write<quint32>(2));
+        QCOMPARE(writer.position(), (size_t)4);
+        // Would have fit, but the message is already broken
+        QVERIFY(!writer.write<quint8>(3));
+        QVERIFY(!writer.ok());
+        QCOMPARE(writer.position(), (size_t)4);
+    }
+
+    void truncatedReadFails() {
+        char buffer[3] = { 0x01, 0x02, 0x03 };
+        Wire::Reader reader(buffer, sizeof(buffer));
+        QCOMPARE(reader.read<quint16>(), (quint16)0x0102);
+        quint32 value = 1234;
+        QVERIFY(!reader.read(&value));
+        QCOMPARE(value, (quint32)0);
+        QCOMPARE(reader.position(), (size_t)2);
+        // Sticky like the writer
+        QCOMPARE(reader.read<quint8>(), (quint8)0);
+        QVERIFY(!reader.ok());
+    }
+
+    void benchmarkLoopHeader() {
+        // A UDP channel header, as the old loops wrote and read it
+        char buffer[16];
+        quint32 id = 0;
+        quint64 sum = 0;
+        QBENCHMARK {
+            for (int i = 0; i < 1000; i++) {
+                loopSerialize<quint8>(buffer, 1);
+                loopSerialize<quint32>(buffer + 1, id++);
+                sum += loopDeserialize<quint8>(buffer) + loopDeserialize<quint32>(buffer + 1);
+            }
+        }
+        QVERIFY(sum > 0);
+    }
+
+    void benchmarkCodecHeader() {
+        char buffer[16];
+        quint32 id = 0;
+        quint64 sum = 0;
+        QBENCHMARK {
+            for (int i = 0; i < 1000; i++) {
+                Wire::Writer writer(buffer, sizeof(buffer));
+                writer.write<quint8>(1);
+                writer.write<quint32>(id++);
+                Wire::Reader reader(buffer, writer.position());
+                sum += reader.read<quint8>() + reader.read<quint32>();
+            }
+        }
+        QVERIFY(sum > 0);
+    }
+
+    void benchmarkVarint() {
+        char buffer[Wire::MaxVarintSize];
+        quint64 value = 0;
+        quint64 sum = 0;
+        QBENCHMARK {
+            for (int i = 0; i < 1000; i++) {
+                int size = Wire::storeVarint(buffer, value);
+                quint64 result;
+                Wire::loadVarint(buffer, size, &result);
+                sum += result;
+                value = value * 3 + 1;
+            }
+        }
+        QVERIFY(sum > 0 || value > 0);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestWireCodec)
+
+#include "tst_wirecodec.moc"
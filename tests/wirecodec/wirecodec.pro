@@ -0,0 +1,5 @@
+TARGET = tst_wirecodec
+include(../tests.pri)
+
+SOURCES += \
+    tst_wirecodec.cpp
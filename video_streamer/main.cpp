@@ -26,6 +26,7 @@
 #include "soro_core/enums.h"
 #include "soro_core/constants.h"
 #include "soro_core/logger.h"
+#include "soro_core/channeltransport.h"
 
 #include "videostreamer.h"
 
@@ -56,7 +57,7 @@ int main(int argc, char *argv[]) {
     bool vaapi;
     SocketAddress address;
     quint16 bindPort;
-    quint16 ipcPort;
+    QString ipcAddress;
 
     /*
      * Parse device
@@ -105,15 +106,15 @@ int main(int argc, char *argv[]) {
     LOG_I(LOG_TAG, "Bind port: " + QString::number(bindPort));
 
     /*
-     * Parse IPC Port
+     * Parse IPC address
      */
-    ipcPort = QString(argv[8]).toInt(&ok);
-    if (!ok) {
-        // invalid IPC port
-        LOG_E(LOG_TAG, "Invalid IPC port '" + QString(argv[8]) + "'");
+    ipcAddress = QString(argv[8]);
+    if (!ChannelTransport::isLocalAddress(ipcAddress)) {
+        // invalid IPC address
+        LOG_E(LOG_TAG, "Invalid IPC address '" + ipcAddress + "'");
         return STREAMPROCESS_ERR_INVALID_ARGUMENT;
     }
-    LOG_I(LOG_TAG, "IPC Port: " + QString::number(ipcPort));
+    LOG_I(LOG_TAG, "IPC address: " + ipcAddress);
 
     a.setApplicationName("VideoStream for " + device + " to " + address.toString());
 
@@ -121,13 +122,13 @@ int main(int argc, char *argv[]) {
     if (isStereo)
     {
         // For stereo streams, the device field is two devices split with a comma
-        VideoStreamer stream(device.mid(0, device.indexOf(",")), device.mid(device.indexOf(",") + 1), profile, bindPort, address, ipcPort, vaapi, &a);
+        VideoStreamer stream(device.mid(0, device.indexOf(",")), device.mid(device.indexOf(",") + 1), profile, bindPort, address, ipcAddress, vaapi, &a);
         LOG_I(LOG_TAG, "Stream object created");
         return a.exec();
     }
     else
     {
-        VideoStreamer stream(device, profile, bindPort, address, ipcPort, vaapi, &a);
+        VideoStreamer stream(device, profile, bindPort, address, ipcAddress, vaapi, &a);
         LOG_I(LOG_TAG, "Stream object created");
         return a.exec();
     }
@@ -18,11 +18,14 @@
 #include "soro_core/logger.h"
 #include "soro_core/constants.h"
 
+//how often the number of frames streamed is sent to the parent
+#define FRAME_REPORT_INTERVAL 1000
+
 namespace Soro {
 
-VideoStreamer::VideoStreamer(QString deviceName, GStreamerUtil::VideoProfile profile, quint16 bindPort, SocketAddress address, quint16 ipcPort, bool vaapi, QObject *parent)
+VideoStreamer::VideoStreamer(QString deviceName, GStreamerUtil::VideoProfile profile, quint16 bindPort, SocketAddress address, QString ipcAddress, bool vaapi, QObject *parent)
         : MediaStreamer("VideoStreamer", parent) {
-    if (!connectToParent(ipcPort)) return;
+    if (!connectToParent(ipcAddress)) return;
 
      LOG_I(LOG_TAG, "Creating pipeline");
     _pipeline = createPipeline();
@@ -30,23 +33,24 @@ VideoStreamer::VideoStreamer(QString deviceName, GStreamerUtil::VideoProfile pro
     // create gstreamer command
     QString binStr = GStreamerUtil::createRtpV4L2EncodeString(deviceName, bindPort, address.host, address.port, profile, vaapi);
 
-    QGst::BinPtr encoder = QGst::Bin::fromDescription(binStr);
+    _encoder = QGst::Bin::fromDescription(binStr);
 
     LOG_I(LOG_TAG, "Created gstreamer bin " + binStr);
 
-    _pipeline->add(encoder);
+    _pipeline->add(_encoder);
 
     LOG_I(LOG_TAG, "Elements linked on pipeline");
 
     // play
     _pipeline->setState(QGst::StatePlaying);
+    START_TIMER(_frameReportTimerId, FRAME_REPORT_INTERVAL);
 
     LOG_I(LOG_TAG, "Stream started");
 }
 
-VideoStreamer::VideoStreamer(QString leftDeviceName, QString rightDeviceName, GStreamerUtil::VideoProfile profile, quint16 bindPort, SocketAddress address, quint16 ipcPort, bool vaapi, QObject *parent)
+VideoStreamer::VideoStreamer(QString leftDeviceName, QString rightDeviceName, GStreamerUtil::VideoProfile profile, quint16 bindPort, SocketAddress address, QString ipcAddress, bool vaapi, QObject *parent)
         : MediaStreamer("VideoStreamer", parent) {
-    if (!connectToParent(ipcPort)) return;
+    if (!connectToParent(ipcAddress)) return;
 
      LOG_I(LOG_TAG, "Creating pipeline");
     _pipeline = createPipeline();
@@ -54,18 +58,32 @@ VideoStreamer::VideoStreamer(QString leftDeviceName, QString rightDeviceName, GS
     // create gstreamer command
     QString binStr = GStreamerUtil::createRtpStereoV4L2EncodeString(leftDeviceName, rightDeviceName, bindPort, address.host, address.port, profile, vaapi);
 
-    QGst::BinPtr encoder = QGst::Bin::fromDescription(binStr);
+    _encoder = QGst::Bin::fromDescription(binStr);
 
     LOG_I(LOG_TAG, "Created gstreamer bin " + binStr);
 
-    _pipeline->add(encoder);
+    _pipeline->add(_encoder);
 
     LOG_I(LOG_TAG, "Elements linked on pipeline");
 
     // play
     _pipeline->setState(QGst::StatePlaying);
+    START_TIMER(_frameReportTimerId, FRAME_REPORT_INTERVAL);
 
     LOG_I(LOG_TAG, "Stream started");
 }
 
+void VideoStreamer::timerEvent(QTimerEvent *e) {
+    if (e->timerId() == _frameReportTimerId) {
+        if (!_pipeline || !_encoder) {
+            KILL_TIMER(_frameReportTimerId);
+            return;
+        }
+        QGst::ElementPtr rate = _encoder->getElementByName(VIDEO_RATE_ELEMENT_NAME);
+        if (rate) {
+            sendToParent("frames " + QString::number(rate->property("out").get<quint64>()));
+        }
+    }
+}
+
 } // namespace Soro
@@ -21,6 +21,7 @@
 #include "soro_core/socketaddress.h"
 #include "soro_core/gstreamerutil.h"
 #include "soro_core/mediastreamer.h"
+#include "soro_core/constants.h"
 
 namespace Soro {
 
@@ -28,10 +29,21 @@ class VideoStreamer : public MediaStreamer {
     Q_OBJECT
 public:
     // For mono video
-    VideoStreamer(QString deviceName, GStreamerUtil::VideoProfile profile, quint16 bindPort, SocketAddress address, quint16 ipcPort, bool vaapi, QObject *parent = 0);
+    VideoStreamer(QString deviceName, GStreamerUtil::VideoProfile profile, quint16 bindPort, SocketAddress address, QString ipcAddress, bool vaapi, QObject *parent = 0);
 
     // For stereo video
-    VideoStreamer(QString leftDeviceName, QString rightDeviceName, GStreamerUtil::VideoProfile profile, quint16 bindPort, SocketAddress address, quint16 ipcPort, bool vaapi, QObject *parent = 0);
+    VideoStreamer(QString leftDeviceName, QString rightDeviceName, GStreamerUtil::VideoProfile profile, quint16 bindPort, SocketAddress address, QString ipcAddress, bool vaapi, QObject *parent = 0);
+
+protected:
+    /**
+     * Periodically tells the parent how many frames have made it through the pipeline, so it can
+     * tell when the rover is not keeping up with the framerate
+     */
+    void timerEvent(QTimerEvent *e) Q_DECL_OVERRIDE;
+
+private:
+    QGst::BinPtr _encoder;
+    int _frameReportTimerId = TIMER_INACTIVE;
 };
 
 } // namespace Soro